@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wirebit/common/time.hpp>
+
+/// Minimal microbenchmark harness for wirebit_bench
+/// Each benchmark is a function running a given number of iterations. The runner calibrates the
+/// iteration count to --min-time-ms per repetition, runs --repetitions timed batches and reports
+/// the median, min and max time per iteration, so results are stable enough to compare runs.
+namespace wirebit::bench {
+
+    /// Keep a value alive without letting the optimizer see through it
+    template <typename T> inline void do_not_optimize(const T &value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+    /// Force pending writes to memory
+    inline void clobber_memory() { asm volatile("" : : : "memory"); }
+
+    /// Benchmark body: run the operation `iterations` times
+    using BenchFn = std::function<void(size_t iterations)>;
+
+    /// One registered benchmark
+    struct Benchmark {
+        std::string name;    ///< Unique name ("group/case/param")
+        size_t bytes_per_op; ///< Payload bytes processed per iteration (0 = no throughput column)
+        BenchFn fn;          ///< Body
+    };
+
+    /// Result of one benchmark
+    struct BenchResult {
+        std::string name;
+        size_t iterations = 0;  ///< Iterations per repetition
+        size_t repetitions = 0; ///< Timed repetitions
+        double median_ns = 0.0; ///< Median time per iteration
+        double min_ns = 0.0;    ///< Fastest repetition
+        double max_ns = 0.0;    ///< Slowest repetition
+        double mb_per_s = 0.0;  ///< Throughput at the median (0 if bytes_per_op is 0)
+    };
+
+    /// Output format
+    enum class Format : uint8_t { Text, Json, Csv };
+
+    /// Runs registered benchmarks and prints the results
+    class Runner {
+      public:
+        /// Parse command line options
+        /// --filter=<substring>, --min-time-ms=<ms>, --repetitions=<n>, --format=text|json|csv, --list
+        Runner(int argc, char **argv) {
+            for (int i = 1; i < argc; ++i) {
+                const char *arg = argv[i];
+                if (std::strncmp(arg, "--filter=", 9) == 0) {
+                    filter_ = arg + 9;
+                } else if (std::strncmp(arg, "--min-time-ms=", 14) == 0) {
+                    min_time_ns_ = static_cast<uint64_t>(std::atof(arg + 14) * 1e6);
+                } else if (std::strncmp(arg, "--repetitions=", 14) == 0) {
+                    repetitions_ = std::max<size_t>(1, static_cast<size_t>(std::atoi(arg + 14)));
+                } else if (std::strcmp(arg, "--format=json") == 0) {
+                    format_ = Format::Json;
+                } else if (std::strcmp(arg, "--format=csv") == 0) {
+                    format_ = Format::Csv;
+                } else if (std::strcmp(arg, "--format=text") == 0) {
+                    format_ = Format::Text;
+                } else if (std::strcmp(arg, "--list") == 0) {
+                    list_only_ = true;
+                } else {
+                    std::fprintf(stderr,
+                                 "usage: %s [--filter=<substring>] [--min-time-ms=<ms>] [--repetitions=<n>] "
+                                 "[--format=text|json|csv] [--list]\n",
+                                 argv[0]);
+                    std::exit(std::strcmp(arg, "--help") == 0 ? 0 : 2);
+                }
+            }
+        }
+
+        /// Register a benchmark
+        /// @param name Unique name
+        /// @param bytes_per_op Bytes processed per iteration (for MB/s), or 0
+        /// @param fn Body running the given number of iterations
+        inline void add(std::string name, size_t bytes_per_op, BenchFn fn) {
+            benchmarks_.push_back(Benchmark{std::move(name), bytes_per_op, std::move(fn)});
+        }
+
+        /// Run every benchmark matching the filter and print the results
+        /// @return Process exit code
+        inline int run() {
+            if (list_only_) {
+                for (const auto &b : benchmarks_) {
+                    if (matches(b)) {
+                        std::printf("%s\n", b.name.c_str());
+                    }
+                }
+                return 0;
+            }
+
+            print_header();
+            bool first = true;
+            for (const auto &b : benchmarks_) {
+                if (!matches(b)) {
+                    continue;
+                }
+                BenchResult r = measure(b);
+                print_result(r, first);
+                first = false;
+            }
+            print_footer();
+            return 0;
+        }
+
+      private:
+        std::vector<Benchmark> benchmarks_;
+        std::string filter_;
+        uint64_t min_time_ns_ = 200000000; ///< Per repetition
+        size_t repetitions_ = 5;
+        Format format_ = Format::Text;
+        bool list_only_ = false;
+
+        inline bool matches(const Benchmark &b) const {
+            return filter_.empty() || b.name.find(filter_) != std::string::npos;
+        }
+
+        static inline uint64_t time_batch(const Benchmark &b, size_t iterations) {
+            uint64_t start = now_ns();
+            b.fn(iterations);
+            clobber_memory();
+            return now_ns() - start;
+        }
+
+        inline BenchResult measure(const Benchmark &b) const {
+            // Calibrate: grow the batch until it takes a tenth of the target, then scale up
+            size_t iterations = 1;
+            uint64_t elapsed = time_batch(b, iterations);
+            while (elapsed < min_time_ns_ / 10 && iterations < (size_t(1) << 40)) {
+                iterations *= 10;
+                elapsed = time_batch(b, iterations);
+            }
+            if (elapsed > 0 && elapsed < min_time_ns_) {
+                double scale = static_cast<double>(min_time_ns_) / static_cast<double>(elapsed);
+                iterations = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(iterations) * scale));
+            }
+
+            std::vector<double> per_op;
+            for (size_t rep = 0; rep < repetitions_; ++rep) {
+                per_op.push_back(static_cast<double>(time_batch(b, iterations)) / static_cast<double>(iterations));
+            }
+            std::sort(per_op.begin(), per_op.end());
+
+            BenchResult r;
+            r.name = b.name;
+            r.iterations = iterations;
+            r.repetitions = repetitions_;
+            r.median_ns = per_op[per_op.size() / 2];
+            r.min_ns = per_op.front();
+            r.max_ns = per_op.back();
+            if (b.bytes_per_op > 0 && r.median_ns > 0.0) {
+                r.mb_per_s = static_cast<double>(b.bytes_per_op) / r.median_ns * 1e3;
+            }
+            return r;
+        }
+
+        inline void print_header() const {
+            switch (format_) {
+            case Format::Json:
+                std::printf("{\n  \"context\": {\"library\": \"wirebit\", \"compiler\": \"%s\", \"cpus\": %u, "
+                            "\"min_time_ms\": %.1f, \"repetitions\": %zu},\n  \"benchmarks\": [",
+                            compiler(), std::thread::hardware_concurrency(),
+                            static_cast<double>(min_time_ns_) / 1e6, repetitions_);
+                break;
+            case Format::Csv:
+                std::printf("name,iterations,repetitions,median_ns,min_ns,max_ns,mb_per_s\n");
+                break;
+            case Format::Text:
+                std::printf("%-44s %14s %12s %12s %12s %10s\n", "benchmark", "iterations", "median ns", "min ns",
+                            "max ns", "MB/s");
+                break;
+            }
+        }
+
+        inline void print_result(const BenchResult &r, bool first) const {
+            switch (format_) {
+            case Format::Json:
+                std::printf("%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"repetitions\": %zu, "
+                            "\"median_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, \"mb_per_s\": %.3f}",
+                            first ? "" : ",", r.name.c_str(), r.iterations, r.repetitions, r.median_ns, r.min_ns,
+                            r.max_ns, r.mb_per_s);
+                break;
+            case Format::Csv:
+                std::printf("%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f\n", r.name.c_str(), r.iterations, r.repetitions,
+                            r.median_ns, r.min_ns, r.max_ns, r.mb_per_s);
+                break;
+            case Format::Text:
+                std::printf("%-44s %14zu %12.1f %12.1f %12.1f %10.1f\n", r.name.c_str(), r.iterations, r.median_ns,
+                            r.min_ns, r.max_ns, r.mb_per_s);
+                break;
+            }
+            std::fflush(stdout);
+        }
+
+        inline void print_footer() const {
+            if (format_ == Format::Json) {
+                std::printf("\n  ]\n}\n");
+            }
+        }
+
+        static inline const char *compiler() {
+#if defined(__clang__)
+            return "clang " __clang_version__;
+#elif defined(__GNUC__)
+            return "gcc " __VERSION__;
+#else
+            return "unknown";
+#endif
+        }
+    };
+
+} // namespace wirebit::bench
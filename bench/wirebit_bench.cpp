@@ -0,0 +1,562 @@
+/// @file wirebit_bench.cpp
+/// @brief Microbenchmarks for the clock, frame, ring, model, endpoint and capture hot paths
+///
+/// Built with -DWIREBIT_BUILD_BENCH=ON (or `make bench`). Inputs are fixed and models use fixed
+/// seeds, so two runs on the same machine measure the same work.
+///
+/// Usage:
+///   ./wirebit_bench [--filter=<substring>] [--min-time-ms=<ms>] [--repetitions=<n>] [--format=text|json|csv]
+///
+/// Example:
+///   ./wirebit_bench --format=json > baseline.json
+///   ./wirebit_bench --filter=ring/ --repetitions=9
+
+#include "bench.hpp"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+using namespace wirebit::bench;
+
+namespace {
+    constexpr size_t PAYLOAD_SIZES[] = {8, 64, 512, 1500, 9000};
+
+    /// Payload with a fixed byte pattern
+    Bytes make_payload(size_t size) {
+        Bytes payload(size);
+        for (size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<Byte>(i * 31 + 7);
+        }
+        return payload;
+    }
+
+    /// Segment name unique to this process
+    String shm_name(const char *what) {
+        return String((std::string("wirebit_bench_") + what + "_" + std::to_string(getpid())).c_str());
+    }
+
+    /// Connected ShmLink pair (creator side first)
+    std::pair<std::shared_ptr<ShmLink>, std::shared_ptr<ShmLink>> make_link_pair(const char *what) {
+        String name = shm_name(what);
+        auto a = ShmLink::create(name, 1 << 20);
+        auto b = ShmLink::attach(name);
+        if (!a.is_ok() || !b.is_ok()) {
+            std::fprintf(stderr, "Failed to create ShmLink %s\n", name.c_str());
+            std::exit(1);
+        }
+        return {std::make_shared<ShmLink>(std::move(a.value())), std::make_shared<ShmLink>(std::move(b.value()))};
+    }
+
+    void add_clock_benchmarks(Runner &runner) {
+        runner.add("clock/now_ns", 0, [](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                do_not_optimize(now_ns());
+            }
+        });
+        runner.add("clock/wall_ns", 0, [](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                do_not_optimize(wall_ns());
+            }
+        });
+    }
+
+    void add_frame_benchmarks(Runner &runner) {
+        for (size_t size : PAYLOAD_SIZES) {
+            std::string suffix = "/" + std::to_string(size);
+            Frame frame = make_frame(FrameType::ETHERNET, make_payload(size), 1, 2);
+            runner.add("frame/encode" + suffix, size, [frame](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    Bytes encoded = encode_frame(frame);
+                    do_not_optimize(encoded.data());
+                }
+            });
+
+            Bytes encoded = encode_frame(frame);
+            runner.add("frame/decode" + suffix, size, [encoded](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    auto decoded = decode_frame(encoded);
+                    do_not_optimize(decoded);
+                }
+            });
+        }
+    }
+
+    void add_ring_benchmarks(Runner &runner) {
+        for (size_t size : PAYLOAD_SIZES) {
+            std::string suffix = "/" + std::to_string(size);
+            auto ring = std::make_shared<FrameRing>(FrameRing::create(1 << 20).value());
+            Frame frame = make_frame(FrameType::SERIAL, make_payload(size), 1, 2);
+
+            runner.add("ring/push_pop" + suffix, size, [ring, frame](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    ring->push_frame(frame);
+                    auto popped = ring->pop_frame();
+                    do_not_optimize(popped);
+                }
+            });
+
+            auto compact = std::make_shared<FrameRing>(FrameRing::create(1 << 20, FRAME_HEADER_V2).value());
+            runner.add("ring/push_pop_v2" + suffix, size, [compact, frame](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    compact->push_frame(frame);
+                    auto popped = compact->pop_frame();
+                    do_not_optimize(popped);
+                }
+            });
+
+            // Fill half the ring, then drain it: measures push and pop with the indices far apart
+            runner.add("ring/push_burst_pop_burst" + suffix, size, [ring, frame](size_t n) {
+                size_t burst = std::max<size_t>(1, (ring->capacity() / 2) / (frame.total_size() + 16));
+                for (size_t done = 0; done < n;) {
+                    size_t count = std::min(burst, n - done);
+                    for (size_t i = 0; i < count; ++i) {
+                        ring->push_frame(frame);
+                    }
+                    for (size_t i = 0; i < count; ++i) {
+                        auto popped = ring->pop_frame();
+                        do_not_optimize(popped);
+                    }
+                    done += count;
+                }
+            });
+        }
+    }
+
+    void add_model_benchmarks(Runner &runner) {
+        LinkModel model;
+        model.base_latency_ns = 100000;
+        model.jitter_ns = 20000;
+        model.bandwidth_bps = 100000000;
+        runner.add("model/compute_deliver_at_ns", 0, [model](size_t n) {
+            DeterministicRNG rng(42);
+            uint64_t next_send = 0;
+            uint64_t now = 1000000000;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t at = compute_deliver_at_ns(model, now, 64, next_send, rng);
+                do_not_optimize(at);
+                now += 1000;
+            }
+        });
+
+        // Every roll is taken but (almost) never fires, so no warnings are logged
+        LinkModel lossy;
+        lossy.drop_prob = 1e-12;
+        lossy.dup_prob = 1e-12;
+        lossy.corrupt_prob = 1e-12;
+        runner.add("model/determine_frame_action", 0, [lossy](size_t n) {
+            DeterministicRNG rng(42);
+            for (size_t i = 0; i < n; ++i) {
+                FrameAction action = determine_frame_action(lossy, rng);
+                do_not_optimize(action);
+            }
+        });
+
+        LinkModel clean;
+        runner.add("model/determine_frame_action/no_impairment", 0, [clean](size_t n) {
+            DeterministicRNG rng(42);
+            for (size_t i = 0; i < n; ++i) {
+                FrameAction action = determine_frame_action(clean, rng);
+                do_not_optimize(action);
+            }
+        });
+
+        // Faults rare enough that no run reaches one (the seed restarts every 2^20 frames), so only
+        // the per-frame sampling cost is measured
+        for (ModelSampling sampling : {ModelSampling::PerFrame, ModelSampling::EventSkip}) {
+            std::string mode = sampling == ModelSampling::PerFrame ? "per_frame" : "event_skip";
+            LinkModel rare(0, 20000, 1e-9, 1e-9, 1e-9, 0, 42);
+            rare.sampling = sampling;
+            runner.add("model/sampler/" + mode, 0, [rare](size_t n) {
+                DeterministicRNG rng(42);
+                FrameActionSampler sampler;
+                sampler.reset(rare, rng);
+                for (size_t i = 0; i < n; ++i) {
+                    if ((i & 0xFFFFF) == 0xFFFFF) {
+                        rng.seed(42);
+                        sampler.reset(rare, rng);
+                    }
+                    FrameAction action = sampler.next(rng);
+                    do_not_optimize(action);
+                }
+            });
+            runner.add("model/sampler_batch/" + mode, 0, [rare](size_t n) {
+                DeterministicRNG rng(42);
+                FrameActionSampler sampler;
+                sampler.reset(rare, rng);
+                FrameAction actions[256];
+                for (size_t done = 0; done < n;) {
+                    size_t count = std::min<size_t>(256, n - done);
+                    if ((done & 0xFFFFF) + count > 0xFFFFF) {
+                        rng.seed(42);
+                        sampler.reset(rare, rng);
+                    }
+                    sampler.next_batch(rng, std::span<FrameAction>(actions, count));
+                    do_not_optimize(actions[0]);
+                    done += count;
+                }
+            });
+            runner.add("model/compute_deliver_at_ns/" + mode, 0, [rare](size_t n) {
+                DeterministicRNG rng(42);
+                uint64_t next_send = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    uint64_t at = compute_deliver_at_ns(rare, 1000000000, 64, next_send, rng);
+                    do_not_optimize(at);
+                }
+            });
+        }
+
+        // ShmLink::send with and without a model; the receiver has none, so it reads the ring directly
+        Frame frame = make_frame(FrameType::CAN, make_payload(16), 1, 2);
+        for (const char *mode : {"none", "per_frame", "event_skip"}) {
+            String name = shm_name((std::string("model_") + mode).c_str());
+            auto tx = std::make_shared<ShmLink>(ShmLink::create(name, 1 << 20).value());
+            auto rx = std::make_shared<ShmLink>(ShmLink::attach(name).value());
+            if (std::strcmp(mode, "none") != 0) {
+                LinkModel lan(0, 0, 1e-9, 0.0, 1e-9, 0, 42);
+                bool skip = std::strcmp(mode, "event_skip") == 0;
+                lan.sampling = skip ? ModelSampling::EventSkip : ModelSampling::PerFrame;
+                tx->set_model(lan);
+            }
+            runner.add(std::string("shm_model/send_") + mode, frame.total_size(), [tx, rx, frame](size_t n) {
+                for (size_t done = 0; done < n;) {
+                    size_t count = std::min<size_t>(64, n - done);
+                    for (size_t i = 0; i < count; ++i) {
+                        tx->send(frame);
+                    }
+                    bench::clobber_memory();
+                    while (rx->recv_view().is_ok()) {
+                        rx->release_view();
+                    }
+                    done += count;
+                }
+            });
+        }
+    }
+
+    void add_can_benchmarks(Runner &runner) {
+        auto [a, b] = make_link_pair("can");
+        CanConfig config;
+        config.bitrate = 1000000;
+        auto tx = std::make_shared<CanEndpoint>(a, config, 1);
+        auto rx = std::make_shared<CanEndpoint>(b, config, 2);
+
+        runner.add("can/send_recv", 8, [tx, rx](size_t n) {
+            can_frame cf = {};
+            cf.can_id = 0x123;
+            cf.can_dlc = 8;
+            can_frame out = {};
+            for (size_t i = 0; i < n; ++i) {
+                cf.data[0] = static_cast<uint8_t>(i);
+                tx->send_can(cf);
+                rx->recv_can(out);
+                do_not_optimize(out);
+            }
+        });
+
+        runner.add("can/send_can", 8, [tx, rx](size_t n) {
+            can_frame cf = {};
+            cf.can_id = 0x123;
+            cf.can_dlc = 8;
+            can_frame out = {};
+            for (size_t done = 0; done < n;) {
+                size_t count = std::min<size_t>(64, n - done);
+                for (size_t i = 0; i < count; ++i) {
+                    tx->send_can(cf);
+                }
+                bench::clobber_memory();
+                while (rx->recv_can(out).is_ok()) {
+                }
+                done += count;
+            }
+        });
+
+        // A 2048-signal database: 256 messages with 8 signals each, alternating byte orders
+        Vector<CanSignal> signals;
+        for (uint32_t id = 0; id < 256; ++id) {
+            for (uint16_t s = 0; s < 8; ++s) {
+                CanSignal signal;
+                signal.name = String(("S" + std::to_string(id) + "_" + std::to_string(s)).c_str());
+                signal.can_id = 0x100 + id;
+                signal.byte_order = s % 2 == 0 ? CanByteOrder::Intel : CanByteOrder::Motorola;
+                signal.start_bit = static_cast<uint16_t>(s % 2 == 0 ? s * 8 : s * 8 + 7);
+                signal.length = s < 4 ? 8 : 6;
+                signal.is_signed = s % 3 == 0;
+                signal.factor = 0.5;
+                signals.push_back(signal);
+            }
+        }
+        auto db = std::make_shared<CanSignalDb>(CanSignalDb::compile(signals).value());
+        auto cache = std::make_shared<CanSignalCache>(db->size());
+        Vector<can_frame> frames;
+        for (uint32_t id = 0; id < 256; ++id) {
+            Bytes data = make_payload(8);
+            frames.push_back(CanEndpoint::make_std_frame(0x100 + id, data.data(), 8));
+        }
+
+        runner.add("can/signals_decode", 8, [db, cache, frames](size_t n) {
+            for (size_t done = 0; done < n;) {
+                size_t count = std::min<size_t>(frames.size(), n - done);
+                db->decode_batch(std::span<const can_frame>(frames.data(), count), *cache, done);
+                done += count;
+            }
+            do_not_optimize(cache->value(0));
+        });
+    }
+
+    void add_eth_benchmarks(Runner &runner) {
+        auto [a, b] = make_link_pair("eth");
+        EthConfig config;
+        config.bandwidth_bps = 400000000000ULL; // Keep shaping from holding frames back
+        MacAddr mac_a = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+        MacAddr mac_b = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+        auto tx = std::make_shared<EthEndpoint>(a, config, 1, mac_a);
+        auto rx = std::make_shared<EthEndpoint>(b, config, 2, mac_b);
+
+        for (size_t size : {64, 512, 1500}) {
+            Bytes payload = make_payload(size - ETH_HLEN);
+            Bytes eth = make_eth_frame(mac_b, mac_a, 0x0800, payload);
+            runner.add("eth/send_recv/" + std::to_string(size), size, [tx, rx, eth](size_t n) {
+                Bytes out;
+                for (size_t i = 0; i < n; ++i) {
+                    tx->send_eth(eth);
+                    rx->recv_eth_into(out);
+                    do_not_optimize(out.data());
+                }
+            });
+        }
+    }
+
+    void add_capture_benchmarks(Runner &runner) {
+        Frame frame = make_frame(FrameType::CAN, make_payload(16));
+        auto [a, b] = make_link_pair("capture");
+        runner.add("capture/send_recv", 16, [a, b, frame](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                a->send(frame);
+                auto received = b->recv_view();
+                do_not_optimize(received);
+            }
+        });
+
+        // Same traffic through a RecordingLink; the file is unlinked at once, the writer keeps its mapping
+        auto [c, d] = make_link_pair("capture_rec");
+        std::string path = "/tmp/wirebit_bench_capture_" + std::to_string(getpid()) + ".pcapng";
+        auto recording = RecordingLink::create(c, RecordingConfig{.path = String(path.c_str())});
+        if (!recording.is_ok()) {
+            std::fprintf(stderr, "Failed to create capture %s\n", path.c_str());
+            std::exit(1);
+        }
+        unlink(path.c_str());
+        auto rec = std::make_shared<RecordingLink>(std::move(recording.value()));
+        runner.add("capture/record_send_recv", 16, [rec, d, frame](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                rec->send(frame);
+                auto received = d->recv_view();
+                do_not_optimize(received);
+            }
+        });
+    }
+
+    void add_mpsc_benchmarks(Runner &runner) {
+        Frame frame = make_frame(FrameType::CAN, make_payload(16));
+        auto [a, b] = make_link_pair("mpsc");
+        auto mpsc = std::make_shared<MpscSendLink>(MpscSendLink::create(a).value());
+        // Uncontended cost of the queue in front of the ring (compare capture/send_recv)
+        runner.add("mpsc/send_recv", 16, [mpsc, b, frame](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                mpsc->send(frame);
+                auto received = b->recv_view();
+                do_not_optimize(received);
+            }
+        });
+    }
+
+    void add_bridge_benchmarks(Runner &runner) {
+        auto [a_near, a_far] = make_link_pair("bridge_a");
+        auto [b_near, b_far] = make_link_pair("bridge_b");
+        auto bridge = std::make_shared<Bridge>(Bridge::create(a_near, b_near).value());
+        Frame frame = make_frame(FrameType::CAN, make_payload(16));
+        // One frame through two rings and a zero-copy bridge turn
+        runner.add("bridge/forward", 16, [bridge, a_far, b_far, frame](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                a_far->send(frame);
+                bridge->pump(BridgeDirection::AToB);
+                auto received = b_far->recv_view();
+                do_not_optimize(received);
+            }
+        });
+    }
+
+    void add_eth_switch_benchmarks(Runner &runner) {
+        auto sw = std::make_shared<EthSwitch>(EthSwitch::create().value());
+        Vector<std::shared_ptr<Link>> nodes;
+        for (int i = 0; i < 8; ++i) {
+            auto [port, node] = make_link_pair(("switch_" + std::to_string(i)).c_str());
+            sw->add_port(port, EthPortConfig{.bandwidth_bps = 0});
+            nodes.push_back(node);
+        }
+        MacAddr src = {0x02, 0, 0, 0, 0, 1};
+        MacAddr dst = {0x02, 0, 0, 0, 0, 2};
+        Frame frame = make_frame(FrameType::ETHERNET, make_eth_frame(dst, src, ETH_P_IP, make_payload(64)));
+
+        // Teach the switch where dst is, so frames to it are unicast on one of 8 ports
+        nodes[1]->send(make_frame(FrameType::ETHERNET, make_eth_frame(MAC_BROADCAST, dst, ETH_P_IP, make_payload(64))));
+        sw->pump();
+        for (auto &node : nodes) {
+            while (node->recv_view().is_ok()) {
+            }
+        }
+        runner.add("eth_switch/unicast", 78, [sw, nodes, frame](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                nodes[0]->send(frame);
+                sw->pump();
+                auto received = nodes[1]->recv_view();
+                do_not_optimize(received);
+            }
+        });
+    }
+
+    void add_async_benchmarks(Runner &runner) {
+        auto loop = std::make_shared<AsyncLoop>(AsyncLoop::create().value());
+        // One suspension and resumption through the loop's ready queue
+        runner.add("async/yield", 0, [loop](size_t n) {
+            auto task = [](AsyncLoop &l, size_t count) -> Task<> {
+                for (size_t i = 0; i < count; ++i) {
+                    co_await l.yield();
+                }
+            };
+            loop->spawn(task(*loop, n));
+            while (loop->tasks() > 0) {
+                loop->run_once(0);
+            }
+        });
+
+        // Awaiting a frame that is already in the ring completes without suspending (compare capture/send_recv)
+        auto [a, b] = make_link_pair("async");
+        Frame frame = make_frame(FrameType::CAN, make_payload(16));
+        runner.add("async/send_recv", 16, [loop, a, b, frame](size_t n) {
+            auto task = [](AsyncLoop &l, Link &tx, Link &rx, const Frame &f, size_t count) -> Task<> {
+                for (size_t i = 0; i < count; ++i) {
+                    co_await l.send_async(tx, f);
+                    auto received = co_await l.recv_async(rx);
+                    do_not_optimize(received);
+                }
+            };
+            loop->spawn(task(*loop, *a, *b, frame, n));
+            while (loop->tasks() > 0) {
+                loop->run_once(0);
+            }
+        });
+    }
+
+    void add_shm_setup_benchmarks(Runner &runner) {
+        // One link per iteration: shm_open/ftruncate/mmap of two segments on each side
+        String name = shm_name("setup");
+        runner.add("shm/setup", 0, [name](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                auto a = ShmLink::create(name, 64 << 10);
+                auto b = ShmLink::attach(name);
+                do_not_optimize(b);
+            }
+        });
+
+        // Same link carved from an already mapped registry arena
+        ShmRegistryConfig config;
+        config.arena_bytes = 16 << 20;
+        config.wakeups = false;
+        String registry_name = String((std::string("/") + shm_name("registry").c_str()).c_str());
+        auto registry = std::make_shared<ShmRegistry>(ShmRegistry::open(registry_name, config).value());
+        ShmRegistry::unlink(registry_name);
+        runner.add("shm_registry/setup", 0, [registry](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                auto a = registry->create("setup", 64 << 10);
+                auto b = registry->attach("setup");
+                do_not_optimize(b);
+            }
+        });
+    }
+
+    void add_shm_slab_benchmarks(Runner &runner) {
+        // Large frames copied through the ring versus written once into the slab and read in place
+        for (size_t size : {size_t(64 << 10), size_t(1 << 20)}) {
+            std::string suffix = "/" + std::to_string(size);
+            Frame frame = make_frame(FrameType::ETHERNET, make_payload(size), 1, 2);
+            for (bool slab : {false, true}) {
+                String name = shm_name(slab ? "slab" : "noslab");
+                auto tx = std::make_shared<ShmLink>(ShmLink::create(name, 4 << 20).value());
+                auto rx = std::make_shared<ShmLink>(ShmLink::attach(name).value());
+                if (slab) {
+                    tx->enable_slab();
+                }
+                runner.add(std::string(slab ? "shm_slab" : "shm_ring") + "/send_recv_view" + suffix, size,
+                           [tx, rx, frame](size_t n) {
+                               for (size_t i = 0; i < n; ++i) {
+                                   tx->send(frame);
+                                   auto view = rx->recv_view();
+                                   do_not_optimize(view);
+                                   rx->release_view();
+                               }
+                           });
+            }
+        }
+    }
+
+    void add_scenario_benchmarks(Runner &runner) {
+        // 16 independent lossy-link simulations of 100 frames each, on one thread and on all of them
+        auto scenario = [](ScenarioContext &ctx) {
+            LinkModel model(ms_to_ns(1), us_to_ns(200), 0.05, 0.0, 0.0, 0, ctx.seed);
+            auto links = std::move(ShmLink::create_pair("bench", 16 << 10, &model).value());
+            links.second.set_model(LinkModel{});
+            uint64_t received = 0;
+            ctx.loop.add_link(links.second, [&]() {
+                bool ok = links.second.recv().is_ok();
+                received += ok ? 1 : 0;
+                return ok;
+            });
+            int sent = 0;
+            ctx.loop.schedule_every(ms_to_ns(1), [&]() {
+                links.first.send(make_frame(FrameType::CAN, Bytes(8, 0)));
+                return ++sent < 100;
+            });
+            ctx.loop.run_until_idle();
+            return received;
+        };
+        for (size_t threads : {size_t(1), size_t(0)}) {
+            ScenarioRunnerConfig config;
+            config.threads = threads;
+            auto pool = std::make_shared<ScenarioRunner>(config);
+            if (threads == 0 && pool->threads() == 1) {
+                break; // Single hardware thread: same as the run above
+            }
+            std::string name = "scenario/lossy_link_x16/threads=" + std::to_string(pool->threads());
+            runner.add(name, 0, [pool, scenario](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    auto results = pool->run(16, scenario);
+                    do_not_optimize(results);
+                }
+            });
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    Runner runner(argc, argv);
+    add_clock_benchmarks(runner);
+    add_frame_benchmarks(runner);
+    add_ring_benchmarks(runner);
+    add_model_benchmarks(runner);
+    add_can_benchmarks(runner);
+    add_eth_benchmarks(runner);
+    add_capture_benchmarks(runner);
+    add_mpsc_benchmarks(runner);
+    add_bridge_benchmarks(runner);
+    add_eth_switch_benchmarks(runner);
+    add_async_benchmarks(runner);
+    add_shm_setup_benchmarks(runner);
+    add_shm_slab_benchmarks(runner);
+    add_scenario_benchmarks(runner);
+    return runner.run();
+}
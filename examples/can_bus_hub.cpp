@@ -1,9 +1,9 @@
 /// @file can_bus_hub.cpp
 /// @brief CAN bus hub - standalone application for multi-node CAN bus simulation
 ///
-/// This program acts as a central hub that forwards CAN frames between multiple nodes.
+/// This program runs a BusHub with one bus and forwards CAN frames between multiple nodes.
 /// Each node connects via its own ShmLink, and the hub implements:
-/// - Frame arbitration (FIFO by timestamp)
+/// - Frame arbitration (lowest CAN ID wins)
 /// - Broadcast to all nodes except sender
 /// - Bitrate shaping
 /// - Optional error injection (drops, corruption)
@@ -14,6 +14,10 @@
 /// Example:
 ///   ./can_bus_hub 3 500000 0.01 0.005
 ///   (3 nodes, 500 kbps, 1% drop, 0.5% corruption)
+///
+/// Forwarding costs one ring write per receiving node for every frame. When no per-frame
+/// impairment is needed, nodes can instead share a single ShmBus segment, where each frame is
+/// written once and read by every other node.
 
 #include <algorithm>
 #include <csignal>
@@ -37,151 +41,76 @@ void signal_handler(int signal) {
     }
 }
 
-/// CAN bus hub that forwards frames between nodes
-class CanBusHub {
-  public:
-    /// Create a CAN bus hub
-    /// @param num_nodes Number of nodes on the bus
-    /// @param bitrate CAN bitrate in bps
-    /// @param drop_prob Frame drop probability [0.0, 1.0]
-    /// @param corrupt_prob Frame corruption probability [0.0, 1.0]
-    CanBusHub(size_t num_nodes, uint32_t bitrate = 500000, double drop_prob = 0.0, double corrupt_prob = 0.0)
-        : num_nodes_(num_nodes), bitrate_(bitrate) {
-
-        echo::info("CAN Bus Hub starting...").green().bold();
-        echo::info("  Nodes: ", num_nodes_);
-        echo::info("  Bitrate: ", bitrate_, " bps");
-        echo::info("  Drop probability: ", drop_prob * 100, "%");
-        echo::info("  Corrupt probability: ", corrupt_prob * 100, "%");
-
-        // Create link model if error injection is enabled
-        if (drop_prob > 0.0 || corrupt_prob > 0.0) {
-            model_.drop_prob = drop_prob;
-            model_.corrupt_prob = corrupt_prob;
-            model_.seed = 12345; // Deterministic for testing
-            use_model_ = true;
-            echo::info("  Error injection: ENABLED").yellow();
-        }
-
-        // Create ShmLinks for each node
-        for (size_t i = 0; i < num_nodes_; ++i) {
-            String node_name("can_node_");
-            char buf[32];
-            snprintf(buf, sizeof(buf), "%zu", i);
-            node_name = node_name + String(buf);
-
-            echo::debug("Creating ShmLink for node ", i, ": ", node_name.c_str());
+/// Create one ShmLink per node (optionally impaired) and attach them all to one BusHub bus
+/// @param hub Hub to populate
+/// @param num_nodes Number of nodes on the bus
+/// @param bitrate CAN bitrate in bps
+/// @param drop_prob Frame drop probability [0.0, 1.0]
+/// @param corrupt_prob Frame corruption probability [0.0, 1.0]
+/// @return Number of nodes attached
+size_t setup_bus(BusHub &hub, size_t num_nodes, uint32_t bitrate, double drop_prob, double corrupt_prob) {
+    echo::info("CAN Bus Hub starting...").green().bold();
+    echo::info("  Nodes: ", num_nodes);
+    echo::info("  Bitrate: ", bitrate, " bps");
+    echo::info("  Drop probability: ", drop_prob * 100, "%");
+    echo::info("  Corrupt probability: ", corrupt_prob * 100, "%");
+
+    // Create link model if error injection is enabled
+    LinkModel model;
+    bool use_model = false;
+    if (drop_prob > 0.0 || corrupt_prob > 0.0) {
+        model.drop_prob = drop_prob;
+        model.corrupt_prob = corrupt_prob;
+        model.seed = 12345; // Deterministic for testing
+        use_model = true;
+        echo::info("  Error injection: ENABLED").yellow();
+    }
 
-            auto result = ShmLink::create(node_name, 1024 * 64); // 64 KB per node
-            if (!result.is_ok()) {
-                echo::error("Failed to create ShmLink for node ", i, ": ", result.error().message.c_str()).red();
-                continue;
-            }
+    CanConfig config;
+    config.bitrate = bitrate;
+    size_t bus = hub.add_bus("can", config).value();
 
-            auto link = std::make_shared<ShmLink>(std::move(result.value()));
+    // Create ShmLinks for each node
+    for (size_t i = 0; i < num_nodes; ++i) {
+        String node_name("can_node_");
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%zu", i);
+        node_name = node_name + String(buf);
 
-            // Apply link model if enabled
-            if (use_model_) {
-                link->set_model(model_);
-            }
+        echo::debug("Creating ShmLink for node ", i, ": ", node_name.c_str());
 
-            nodes_.push_back(link);
+        auto result = ShmLink::create(node_name, 1024 * 64); // 64 KB per node
+        if (!result.is_ok()) {
+            echo::error("Failed to create ShmLink for node ", i, ": ", result.error().message.c_str()).red();
+            continue;
         }
 
-        echo::info("Hub initialized with ", nodes_.size(), " nodes").green();
-    }
+        auto link = std::make_shared<ShmLink>(std::move(result.value()));
 
-    /// Run the hub (blocking)
-    void run() {
-        echo::info("Hub running, forwarding CAN frames...").green().bold();
-        echo::info("Press Ctrl+C to stop").cyan();
-
-        uint64_t frames_forwarded = 0;
-        uint64_t frames_dropped = 0;
-
-        while (g_running) {
-            bool activity = false;
-
-            // Poll all nodes for outgoing frames
-            for (size_t src_node = 0; src_node < nodes_.size(); ++src_node) {
-                auto &src_link = nodes_[src_node];
-
-                // Try to receive a frame from this node
-                auto recv_result = src_link->recv();
-                if (!recv_result.is_ok()) {
-                    // No frame available from this node
-                    continue;
-                }
-
-                activity = true;
-                Frame frame = recv_result.value();
-
-                // Validate frame type
-                if (frame.header.frame_type != static_cast<uint16_t>(FrameType::CAN)) {
-                    echo::warn("Node ", src_node, " sent non-CAN frame, ignoring").yellow();
-                    continue;
-                }
-
-                // Parse CAN frame for logging
-                can_frame cf;
-                if (frame.payload.size() >= sizeof(can_frame)) {
-                    std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
-                    echo::trace("Node ", src_node, " -> CAN ID=0x", std::hex, std::setfill('0'), std::setw(3),
-                                (cf.can_id & CAN_EFF_MASK), std::dec, " DLC=", (int)cf.can_dlc);
-                }
-
-                // Broadcast to all other nodes
-                size_t broadcast_count = 0;
-                for (size_t dst_node = 0; dst_node < nodes_.size(); ++dst_node) {
-                    if (dst_node == src_node) {
-                        continue; // Don't send back to sender
-                    }
-
-                    auto &dst_link = nodes_[dst_node];
-
-                    // Forward the frame
-                    auto send_result = dst_link->send(frame);
-                    if (send_result.is_ok()) {
-                        broadcast_count++;
-                        echo::trace("  -> Node ", dst_node);
-                    } else {
-                        echo::warn("Failed to forward to node ", dst_node, ": ", send_result.error().message.c_str())
-                            .yellow();
-                        frames_dropped++;
-                    }
-                }
-
-                if (broadcast_count > 0) {
-                    frames_forwarded++;
-                    echo::debug("Forwarded frame from node ", src_node, " to ", broadcast_count, " nodes");
-                }
-            }
-
-            // If no activity, sleep briefly to avoid busy-waiting
-            if (!activity) {
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
-            }
+        // Apply link model if enabled (impairs frames the hub delivers to this node)
+        if (use_model) {
+            link->set_model(model);
         }
 
-        echo::info("Hub shutting down...").yellow();
-        echo::info("  Frames forwarded: ", frames_forwarded);
-        echo::info("  Frames dropped: ", frames_dropped);
+        hub.add_node(bus, link);
     }
 
-    /// Get statistics
-    void print_stats() const {
-        echo::info("=== CAN Bus Hub Statistics ===").cyan().bold();
-        echo::info("  Nodes: ", nodes_.size());
-        echo::info("  Bitrate: ", bitrate_, " bps");
-    }
+    echo::info("Hub initialized with ", hub.node_count(bus), " nodes").green();
+    return hub.node_count(bus);
+}
 
-  private:
-    size_t num_nodes_;
-    uint32_t bitrate_;
-    Vector<std::shared_ptr<ShmLink>> nodes_;
-    LinkModel model_;
-    bool use_model_ = false;
-};
+/// Print bus statistics
+void print_stats(const BusHub &hub) {
+    const BusHubStats &stats = hub.stats(0);
+    echo::info("=== CAN Bus Hub Statistics ===").cyan().bold();
+    echo::info("  Nodes: ", hub.node_count(0));
+    echo::info("  Frames received: ", stats.frames_received);
+    echo::info("  Frames forwarded: ", stats.frames_forwarded);
+    echo::info("  Deliveries: ", stats.deliveries);
+    echo::info("  Delivery errors: ", stats.send_errors);
+    echo::info("  Arbitration losses: ", stats.arbitration_losses);
+    echo::info("  Bus busy: ", stats.busy_ns / 1000, " us");
+}
 
 int main(int argc, char **argv) {
     // Parse command line arguments
@@ -226,15 +155,27 @@ int main(int argc, char **argv) {
     std::signal(SIGTERM, signal_handler);
 
     // Create and run the hub
-    try {
-        CanBusHub hub(num_nodes, bitrate, drop_prob, corrupt_prob);
-        hub.run();
-        hub.print_stats();
-    } catch (const std::exception &e) {
-        echo::error("Hub error: ", e.what()).red().bold();
+    auto hub_result = BusHub::create();
+    if (!hub_result.is_ok()) {
+        echo::error("Hub error: ", hub_result.error().message.c_str()).red().bold();
+        return 1;
+    }
+    BusHub hub = std::move(hub_result.value());
+    if (setup_bus(hub, num_nodes, bitrate, drop_prob, corrupt_prob) == 0 || !hub.start().is_ok()) {
+        echo::error("Hub error: no nodes attached").red().bold();
         return 1;
     }
 
+    echo::info("Hub running, forwarding CAN frames...").green().bold();
+    echo::info("Press Ctrl+C to stop").cyan();
+    while (g_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    echo::info("Hub shutting down...").yellow();
+    hub.stop();
+    print_stats(hub);
+
     echo::info("CAN Bus Hub stopped").green();
     return 0;
 }
@@ -0,0 +1,961 @@
+/// @file wirebit_perf.cpp
+/// @brief iperf-style throughput and latency test between two processes over any wirebit link
+///
+/// One process runs as the server (receiver and echo side), the other as the client (sender).
+/// In stream mode the client sends numbered frames at a given rate and batch size; both sides
+/// print per-second rates and the server reports received frames, drops, reordering and one-way
+/// latency. In ping mode the client sends one probe at a time and the server echoes it back,
+/// giving round-trip percentiles. Both sides report their CPU usage.
+///
+/// Backends and how the two ends meet:
+///   shm   server creates the ShmLink --name, client attaches to it (LinkModel options apply here)
+///   pty   server creates a PtyLink and prints its slave path, client opens it with --device
+///   tty   both sides open a TtyLink on their --device (null-modem cable), framed mode
+///   tap   each side opens its own --iface; put both TAPs on one bridge (frames are broadcast)
+///   tun   each side opens its own --iface; --src/--dst must route from one TUN to the other
+///   can   both sides open SocketCAN --iface (e.g. the same vcan0); probes are 8-byte CAN frames
+///
+/// One-way latency uses the sender's monotonic clock, so it is only meaningful on one host.
+///
+/// Usage:
+///   ./wirebit_perf <shm|pty|tty|tap|tun|can> <server|client> [options]
+///
+/// Example:
+///   ./wirebit_perf shm server
+///   ./wirebit_perf shm client --size=1500 --batch=32 --time=5
+///   ./wirebit_perf shm client --mode=ping --count=100000 --cpu=3
+///   ./wirebit_perf shm client --latency-us=500 --jitter-us=100 --drop=0.01 --json
+///   ./wirebit_perf can client --iface=vcan0 --rate=5000
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+volatile bool g_running = true;
+
+void signal_handler(int) { g_running = false; }
+
+namespace {
+
+    enum class Backend : uint8_t { Shm, Pty, Tty, Tap, Tun, Can };
+    enum class Mode : uint8_t { Stream, Ping };
+
+    /// Probe kinds (first payload byte)
+    enum class ProbeKind : uint8_t {
+        Data = 1,   ///< Stream frame
+        Ping = 2,   ///< Echo request
+        Pong = 3,   ///< Echo reply
+        End = 4,    ///< End of stream, seq = frames the client sent
+        Report = 5, ///< Server reply to End, seq = frames the server received
+    };
+
+    constexpr size_t PROBE_SHORT = 8;           ///< [kind:1][seq:7] (CAN)
+    constexpr size_t PROBE_FULL = 16;           ///< Short probe + [sent_ns:8]
+    constexpr uint16_t PERF_ETHERTYPE = 0x88B5; ///< IEEE local experimental ethertype
+    constexpr uint16_t PERF_UDP_PORT = 5201;
+    constexpr size_t IP_UDP_HLEN = 28;
+
+    struct Options {
+        Backend backend = Backend::Shm;
+        bool server = false;
+        Mode mode = Mode::Stream;
+        std::string name = "wirebit_perf"; ///< ShmLink name
+        std::string device;                ///< TTY device (pty client, tty)
+        std::string iface;                 ///< TAP/TUN/CAN interface
+        std::string src_ip = "10.201.0.1"; ///< TUN source address
+        std::string dst_ip = "10.201.1.1"; ///< TUN destination address
+        uint32_t can_id = 0x7A0;           ///< CAN identifier of the probes
+        uint32_t baud = 115200;            ///< TTY baud rate
+        size_t size = 64;                  ///< Frame size (see Codec::clamp_size)
+        double rate = 0.0;                 ///< Frames (stream) or pings per second, 0 = unlimited
+        size_t batch = 1;                  ///< Frames per send_batch()
+        double time_s = 10.0;              ///< Test duration
+        uint64_t count = 0;                ///< Stop after this many frames/pings (0 = use time_s)
+        uint64_t timeout_ms = 1000;        ///< Ping reply timeout
+        double interval_s = 1.0;           ///< Progress interval (0 = off)
+        int cpu = -1;                      ///< CPU to pin to
+        bool busy_poll = false;            ///< Spin instead of poll() when idle
+        bool json = false;                 ///< Print the final report as JSON
+        size_t capacity = 1 << 22;         ///< ShmLink ring capacity
+        LinkModel model;                   ///< ShmLink model for this side's frames
+        bool has_model = false;
+    };
+
+    [[noreturn]] void usage(const char *argv0, int code) {
+        std::fprintf(code == 0 ? stdout : stderr,
+                     "usage: %s <shm|pty|tty|tap|tun|can> <server|client> [options]\n"
+                     "  --mode=stream|ping   stream throughput (default) or ping-pong RTT\n"
+                     "  --size=<bytes>       frame size: payload (shm/pty/tty), Ethernet frame (tap), IP packet (tun)\n"
+                     "  --rate=<n>           frames or pings per second (default unlimited)\n"
+                     "  --batch=<n>          frames per send_batch() call (default 1)\n"
+                     "  --time=<s>           test duration (default 10)\n"
+                     "  --count=<n>          stop after n frames or pings\n"
+                     "  --timeout-ms=<ms>    ping reply timeout (default 1000)\n"
+                     "  --interval=<s>       progress interval, 0 = off (default 1)\n"
+                     "  --cpu=<n>            pin to a CPU\n"
+                     "  --busy-poll          spin when idle instead of poll()\n"
+                     "  --json               print the final report as JSON\n"
+                     "  --name=<name>        ShmLink name (shm, default wirebit_perf)\n"
+                     "  --capacity=<bytes>   ShmLink ring capacity (shm, default 4 MiB)\n"
+                     "  --latency-us=<us> --jitter-us=<us> --drop=<p> --dup=<p> --corrupt=<p>\n"
+                     "  --bandwidth=<bps> --seed=<n>\n"
+                     "                       LinkModel for the frames this side sends (shm)\n"
+                     "  --device=<path>      TTY device (pty client, tty)\n"
+                     "  --baud=<n>           TTY baud rate (tty, default 115200)\n"
+                     "  --iface=<name>       interface (tap, tun, can)\n"
+                     "  --src=<ip> --dst=<ip> --can-id=<id>\n"
+                     "                       TUN addresses, CAN identifier of the probes\n",
+                     argv0);
+        std::exit(code);
+    }
+
+    /// Match "--key=value" and return the value
+    const char *option_value(const char *arg, const char *key) {
+        size_t len = std::strlen(key);
+        return std::strncmp(arg, key, len) == 0 && arg[len] == '=' ? arg + len + 1 : nullptr;
+    }
+
+    Options parse_options(int argc, char **argv) {
+        Options o;
+        if (argc < 3) {
+            usage(argv[0], argc > 1 && std::strcmp(argv[1], "--help") == 0 ? 0 : 2);
+        }
+        std::string backend = argv[1];
+        if (backend == "shm") {
+            o.backend = Backend::Shm;
+        } else if (backend == "pty") {
+            o.backend = Backend::Pty;
+        } else if (backend == "tty") {
+            o.backend = Backend::Tty;
+        } else if (backend == "tap") {
+            o.backend = Backend::Tap;
+        } else if (backend == "tun") {
+            o.backend = Backend::Tun;
+        } else if (backend == "can") {
+            o.backend = Backend::Can;
+        } else {
+            usage(argv[0], 2);
+        }
+        std::string role = argv[2];
+        if (role != "server" && role != "client") {
+            usage(argv[0], 2);
+        }
+        o.server = role == "server";
+
+        for (int i = 3; i < argc; ++i) {
+            const char *arg = argv[i];
+            const char *v = nullptr;
+            if ((v = option_value(arg, "--mode"))) {
+                if (std::strcmp(v, "stream") != 0 && std::strcmp(v, "ping") != 0) {
+                    usage(argv[0], 2);
+                }
+                o.mode = std::strcmp(v, "ping") == 0 ? Mode::Ping : Mode::Stream;
+            } else if ((v = option_value(arg, "--size"))) {
+                o.size = std::strtoull(v, nullptr, 0);
+            } else if ((v = option_value(arg, "--rate"))) {
+                o.rate = std::atof(v);
+            } else if ((v = option_value(arg, "--batch"))) {
+                o.batch = std::max<size_t>(1, std::strtoull(v, nullptr, 0));
+            } else if ((v = option_value(arg, "--time"))) {
+                o.time_s = std::atof(v);
+            } else if ((v = option_value(arg, "--count"))) {
+                o.count = std::strtoull(v, nullptr, 0);
+            } else if ((v = option_value(arg, "--timeout-ms"))) {
+                o.timeout_ms = std::strtoull(v, nullptr, 0);
+            } else if ((v = option_value(arg, "--interval"))) {
+                o.interval_s = std::atof(v);
+            } else if ((v = option_value(arg, "--cpu"))) {
+                o.cpu = std::atoi(v);
+            } else if (std::strcmp(arg, "--busy-poll") == 0) {
+                o.busy_poll = true;
+            } else if (std::strcmp(arg, "--json") == 0) {
+                o.json = true;
+            } else if ((v = option_value(arg, "--name"))) {
+                o.name = v;
+            } else if ((v = option_value(arg, "--capacity"))) {
+                o.capacity = std::strtoull(v, nullptr, 0);
+            } else if ((v = option_value(arg, "--latency-us"))) {
+                o.model.base_latency_ns = static_cast<uint64_t>(std::atof(v) * 1e3);
+                o.has_model = true;
+            } else if ((v = option_value(arg, "--jitter-us"))) {
+                o.model.jitter_ns = static_cast<uint64_t>(std::atof(v) * 1e3);
+                o.has_model = true;
+            } else if ((v = option_value(arg, "--drop"))) {
+                o.model.drop_prob = std::atof(v);
+                o.has_model = true;
+            } else if ((v = option_value(arg, "--dup"))) {
+                o.model.dup_prob = std::atof(v);
+                o.has_model = true;
+            } else if ((v = option_value(arg, "--corrupt"))) {
+                o.model.corrupt_prob = std::atof(v);
+                o.has_model = true;
+            } else if ((v = option_value(arg, "--bandwidth"))) {
+                o.model.bandwidth_bps = std::strtoull(v, nullptr, 0);
+                o.has_model = true;
+            } else if ((v = option_value(arg, "--seed"))) {
+                o.model.seed = std::strtoull(v, nullptr, 0);
+            } else if ((v = option_value(arg, "--device"))) {
+                o.device = v;
+            } else if ((v = option_value(arg, "--baud"))) {
+                o.baud = static_cast<uint32_t>(std::strtoul(v, nullptr, 0));
+            } else if ((v = option_value(arg, "--iface"))) {
+                o.iface = v;
+            } else if ((v = option_value(arg, "--src"))) {
+                o.src_ip = v;
+            } else if ((v = option_value(arg, "--dst"))) {
+                o.dst_ip = v;
+            } else if ((v = option_value(arg, "--can-id"))) {
+                o.can_id = static_cast<uint32_t>(std::strtoul(v, nullptr, 0));
+            } else {
+                usage(argv[0], std::strcmp(arg, "--help") == 0 ? 0 : 2);
+            }
+        }
+        if (o.has_model && o.backend != Backend::Shm) {
+            std::fprintf(stderr, "LinkModel options only apply to the shm backend\n");
+            std::exit(2);
+        }
+        return o;
+    }
+
+    /// Probe carried at the start of every test frame's payload (little endian)
+    struct Probe {
+        ProbeKind kind = ProbeKind::Data;
+        uint64_t seq = 0;     ///< 56 bits
+        uint64_t sent_ns = 0; ///< Sender's clock_ns() (0 if the frame is too small to carry it)
+    };
+
+    /// Monotonic time in nanoseconds (now_ns() as unsigned, for the uint64_t deadlines below)
+    inline uint64_t clock_ns() { return static_cast<uint64_t>(now_ns()); }
+
+    inline void put_le(Byte *out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out[i] = static_cast<Byte>(value >> (8 * i));
+        }
+    }
+
+    inline uint64_t get_le(const Byte *in, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    inline void write_probe(Byte *out, size_t room, const Probe &p) {
+        out[0] = static_cast<Byte>(p.kind);
+        put_le(out + 1, p.seq, 7);
+        if (room >= PROBE_FULL) {
+            put_le(out + 8, p.sent_ns, 8);
+        }
+    }
+
+    inline bool read_probe(const Byte *in, size_t room, Probe &p) {
+        if (room < PROBE_SHORT || in[0] < static_cast<Byte>(ProbeKind::Data) ||
+            in[0] > static_cast<Byte>(ProbeKind::Report)) {
+            return false;
+        }
+        p.kind = static_cast<ProbeKind>(in[0]);
+        p.seq = get_le(in + 1, 7);
+        p.sent_ns = room >= PROBE_FULL ? get_le(in + 8, 8) : 0;
+        return true;
+    }
+
+    /// Wraps probes into the frames a backend carries, and finds them in received frames
+    /// Frames that are not probes (ARP, IPv6 ND, other CAN traffic...) are ignored by unwrap().
+    class Codec {
+      public:
+        explicit Codec(const Options &o) : backend_(o.backend), can_id_(o.can_id) {
+            src_mac_ = {0x02, 0x57, 0x42, 0x50, 0x00, static_cast<uint8_t>(o.server ? 1 : 2)};
+            parse_ip(o.server ? o.dst_ip : o.src_ip, src_ip_);
+            parse_ip(o.server ? o.src_ip : o.dst_ip, dst_ip_);
+        }
+
+        /// Clamp a requested frame size to what the backend can carry with a full probe
+        inline size_t clamp_size(size_t size) const {
+            switch (backend_) {
+            case Backend::Can:
+                return sizeof(can_frame);
+            case Backend::Tap:
+                return std::clamp<size_t>(size, ETH_HLEN + PROBE_FULL, 65535);
+            case Backend::Tun:
+                return std::clamp<size_t>(size, IP_UDP_HLEN + PROBE_FULL, 65535);
+            default:
+                return std::max(size, PROBE_FULL);
+            }
+        }
+
+        /// Bytes on the wire per frame used for throughput figures (probe payload for CAN)
+        inline size_t wire_bytes(size_t size) const { return backend_ == Backend::Can ? PROBE_SHORT : size; }
+
+        /// Build a frame of the given (clamped) size carrying a probe
+        inline Frame wrap(const Probe &p, size_t size) const {
+            Bytes payload(size, 0);
+            switch (backend_) {
+            case Backend::Can: {
+                can_frame cf = {};
+                cf.can_id = can_id_;
+                cf.can_dlc = PROBE_SHORT;
+                write_probe(cf.data, PROBE_SHORT, p);
+                std::memcpy(payload.data(), &cf, sizeof(cf));
+                return make_frame(FrameType::CAN, std::move(payload));
+            }
+            case Backend::Tap:
+                std::memcpy(payload.data(), MAC_BROADCAST.data(), ETH_ALEN);
+                std::memcpy(payload.data() + ETH_ALEN, src_mac_.data(), ETH_ALEN);
+                put_be16(payload.data() + 2 * ETH_ALEN, PERF_ETHERTYPE);
+                write_probe(payload.data() + ETH_HLEN, size - ETH_HLEN, p);
+                return make_frame(FrameType::ETHERNET, std::move(payload));
+            case Backend::Tun:
+                write_ip_udp(payload.data(), size);
+                write_probe(payload.data() + IP_UDP_HLEN, size - IP_UDP_HLEN, p);
+                return make_frame(FrameType::IP, std::move(payload));
+            default:
+                write_probe(payload.data(), size, p);
+                return make_frame(FrameType::SERIAL, std::move(payload));
+            }
+        }
+
+        /// Find the probe in a received frame
+        /// @return false if the frame is not a wirebit_perf probe
+        inline bool unwrap(const Frame &frame, Probe &p) const {
+            const Byte *data = frame.payload.data();
+            size_t size = frame.payload.size();
+            switch (backend_) {
+            case Backend::Can: {
+                if (size < sizeof(can_frame)) {
+                    return false;
+                }
+                can_frame cf = {};
+                std::memcpy(&cf, data, sizeof(cf));
+                return (cf.can_id & CAN_EFF_MASK) == (can_id_ & CAN_EFF_MASK) && read_probe(cf.data, cf.can_dlc, p);
+            }
+            case Backend::Tap:
+                if (size < ETH_HLEN || get_be16(data + 2 * ETH_ALEN) != PERF_ETHERTYPE ||
+                    std::memcmp(data + ETH_ALEN, src_mac_.data(), ETH_ALEN) == 0) {
+                    return false;
+                }
+                return read_probe(data + ETH_HLEN, size - ETH_HLEN, p);
+            case Backend::Tun: {
+                if (size < IP_UDP_HLEN || (data[0] >> 4) != 4 || data[9] != IPPROTO_UDP) {
+                    return false;
+                }
+                size_t ihl = static_cast<size_t>(data[0] & 0x0F) * 4;
+                if (size < ihl + 8 || get_be16(data + ihl + 2) != PERF_UDP_PORT) {
+                    return false;
+                }
+                return read_probe(data + ihl + 8, size - ihl - 8, p);
+            }
+            default:
+                return read_probe(data, size, p);
+            }
+        }
+
+      private:
+        Backend backend_;
+        uint32_t can_id_;
+        MacAddr src_mac_{};
+        uint8_t src_ip_[4] = {};
+        uint8_t dst_ip_[4] = {};
+
+        static inline void put_be16(Byte *out, uint16_t value) {
+            out[0] = static_cast<Byte>(value >> 8);
+            out[1] = static_cast<Byte>(value);
+        }
+
+        static inline uint16_t get_be16(const Byte *in) { return static_cast<uint16_t>((in[0] << 8) | in[1]); }
+
+        static inline void parse_ip(const std::string &text, uint8_t (&out)[4]) {
+            unsigned a = 0, b = 0, c = 0, d = 0;
+            if (std::sscanf(text.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d) != 4) {
+                std::fprintf(stderr, "Invalid IPv4 address: %s\n", text.c_str());
+                std::exit(2);
+            }
+            out[0] = static_cast<uint8_t>(a);
+            out[1] = static_cast<uint8_t>(b);
+            out[2] = static_cast<uint8_t>(c);
+            out[3] = static_cast<uint8_t>(d);
+        }
+
+        /// IPv4 + UDP header for a packet of the given size (UDP checksum left at 0)
+        inline void write_ip_udp(Byte *out, size_t size) const {
+            out[0] = 0x45;
+            put_be16(out + 2, static_cast<uint16_t>(size));
+            out[8] = 64;
+            out[9] = IPPROTO_UDP;
+            std::memcpy(out + 12, src_ip_, 4);
+            std::memcpy(out + 16, dst_ip_, 4);
+            uint32_t sum = 0;
+            for (size_t i = 0; i < 20; i += 2) {
+                sum += get_be16(out + i);
+            }
+            while (sum >> 16) {
+                sum = (sum & 0xFFFF) + (sum >> 16);
+            }
+            put_be16(out + 10, static_cast<uint16_t>(~sum));
+            put_be16(out + 20, PERF_UDP_PORT);
+            put_be16(out + 22, PERF_UDP_PORT);
+            put_be16(out + 24, static_cast<uint16_t>(size - 20));
+        }
+    };
+
+    /// Process CPU time in nanoseconds (user + system)
+    uint64_t cpu_time_ns() {
+        rusage usage = {};
+        getrusage(RUSAGE_SELF, &usage);
+        auto ns = [](const timeval &tv) {
+            return static_cast<uint64_t>(tv.tv_sec) * 1000000000ULL + static_cast<uint64_t>(tv.tv_usec) * 1000ULL;
+        };
+        return ns(usage.ru_utime) + ns(usage.ru_stime);
+    }
+
+    /// Wall and CPU time of one test
+    struct Session {
+        uint64_t start_ns = 0;
+        uint64_t start_cpu_ns = 0;
+
+        inline void begin() {
+            start_ns = clock_ns();
+            start_cpu_ns = cpu_time_ns();
+        }
+
+        inline double elapsed_s() const { return static_cast<double>(clock_ns() - start_ns) / 1e9; }
+
+        /// CPU usage in percent of one core since begin()
+        inline double cpu_percent() const {
+            uint64_t wall = clock_ns() - start_ns;
+            return wall == 0 ? 0.0 : static_cast<double>(cpu_time_ns() - start_cpu_ns) * 100.0 / wall;
+        }
+    };
+
+    /// Open the link for the chosen backend and role
+    Result<std::unique_ptr<Link>, Error> open_link(const Options &o) {
+        using R = Result<std::unique_ptr<Link>, Error>;
+        switch (o.backend) {
+        case Backend::Shm: {
+            const LinkModel *model = o.has_model ? &o.model : nullptr;
+            auto link = o.server ? ShmLink::create(String(o.name.c_str()), o.capacity, model)
+                                 : ShmLink::attach(String(o.name.c_str()), model);
+            if (!link.is_ok()) {
+                return R::err(link.error());
+            }
+            return R::ok(std::make_unique<ShmLink>(std::move(link.value())));
+        }
+#ifndef NO_HARDWARE
+        case Backend::Pty:
+            if (o.server) {
+                auto link = PtyLink::create();
+                if (!link.is_ok()) {
+                    return R::err(link.error());
+                }
+                std::printf("PTY slave: %s (run: wirebit_perf pty client --device=%s)\n",
+                            link.value().slave_path().c_str(), link.value().slave_path().c_str());
+                return R::ok(std::make_unique<PtyLink>(std::move(link.value())));
+            }
+            [[fallthrough]];
+        case Backend::Tty: {
+            if (o.device.empty()) {
+                return R::err(Error::invalid_argument("--device is required"));
+            }
+            TtyConfig config;
+            config.device = String(o.device.c_str());
+            config.baud = o.baud;
+            config.framed = true;
+            auto link = TtyLink::create(config);
+            if (!link.is_ok()) {
+                return R::err(link.error());
+            }
+            return R::ok(std::make_unique<TtyLink>(std::move(link.value())));
+        }
+        case Backend::Tap: {
+            TapConfig config;
+            config.interface_name = String((o.iface.empty() ? (o.server ? "tap1" : "tap0") : o.iface).c_str());
+            auto link = TapLink::create(config);
+            if (!link.is_ok()) {
+                return R::err(link.error());
+            }
+            return R::ok(std::make_unique<TapLink>(std::move(link.value())));
+        }
+        case Backend::Tun: {
+            TunConfig config;
+            config.interface_name = String((o.iface.empty() ? (o.server ? "tun1" : "tun0") : o.iface).c_str());
+            auto link = TunLink::create(config);
+            if (!link.is_ok()) {
+                return R::err(link.error());
+            }
+            return R::ok(std::make_unique<TunLink>(std::move(link.value())));
+        }
+        case Backend::Can: {
+            SocketCanConfig config;
+            config.interface_name = String((o.iface.empty() ? "vcan0" : o.iface).c_str());
+            auto link = SocketCanLink::create(config);
+            if (!link.is_ok()) {
+                return R::err(link.error());
+            }
+            return R::ok(std::make_unique<SocketCanLink>(std::move(link.value())));
+        }
+#else
+        default:
+            return R::err(Error::invalid_argument("Only the shm backend is available (built with NO_HARDWARE)"));
+#endif
+        }
+        return R::err(Error::invalid_argument("Unknown backend"));
+    }
+
+    /// Wait until the link may have input, or the timeout passes
+    void wait_input(Link &link, const Options &o, uint64_t timeout_ns) {
+        if (o.busy_poll || link.can_recv()) {
+            return;
+        }
+        int fd = link.poll_fd();
+        uint64_t deadline = link.next_deadline();
+        if (deadline != UINT64_MAX) {
+            uint64_t now = clock_ns();
+            timeout_ns = std::min(timeout_ns, deadline > now ? deadline - now : 0);
+        }
+        if (fd < 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<uint64_t>(timeout_ns, 50000)));
+            return;
+        }
+        if (link.prepare_wait()) {
+            pollfd pfd = {fd, POLLIN, 0};
+            ::poll(&pfd, 1, static_cast<int>(std::min<uint64_t>((timeout_ns + 999999) / 1000000, 100)));
+        }
+        link.finish_wait();
+    }
+
+    /// Send a frame, retrying while the link is full
+    /// @return false on a hard error or interruption
+    bool send_blocking(Link &link, const Frame &frame, uint64_t &stalls) {
+        while (g_running) {
+            auto result = link.send(frame);
+            if (result.is_ok()) {
+                return true;
+            }
+            if (result.error().code != Error::timeout("").code) {
+                std::fprintf(stderr, "send failed: %s\n", result.error().message.c_str());
+                return false;
+            }
+            ++stalls;
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    /// Drain received frames into probes (ignoring non-probe traffic)
+    size_t recv_probes(Link &link, const Codec &codec, size_t max_frames, Vector<Frame> &frames,
+                       Vector<std::pair<Probe, size_t>> &probes) {
+        frames.clear();
+        probes.clear();
+        auto result = link.recv_batch(frames, max_frames);
+        if (!result.is_ok()) {
+            return 0;
+        }
+        for (const Frame &frame : frames) {
+            Probe p;
+            if (codec.unwrap(frame, p)) {
+                probes.push_back({p, frame.payload.size()});
+            }
+        }
+        return frames.size();
+    }
+
+    void print_interval(const char *who, double t0, double t1, uint64_t frames, uint64_t bytes) {
+        double dt = t1 - t0;
+        if (dt <= 0.0) {
+            return;
+        }
+        std::printf("[%s] %6.1f-%6.1f s  %12.0f frames/s  %10.2f Mbit/s\n", who, t0, t1,
+                    static_cast<double>(frames) / dt, static_cast<double>(bytes) * 8.0 / dt / 1e6);
+        std::fflush(stdout);
+    }
+
+    void print_histogram(const char *label, const Histogram &h) {
+        if (h.count() == 0) {
+            return;
+        }
+        std::printf("  %-10s min %9.1f  p50 %9.1f  p90 %9.1f  p99 %9.1f  p99.9 %9.1f  max %9.1f  mean %9.1f us\n",
+                    label, h.min() / 1e3, h.percentile(50) / 1e3, h.percentile(90) / 1e3, h.percentile(99) / 1e3,
+                    h.percentile(99.9) / 1e3, h.max() / 1e3, h.mean() / 1e3);
+    }
+
+    void print_histogram_json(const char *label, const Histogram &h) {
+        std::printf(", \"%s\": {\"count\": %llu, \"min\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, "
+                    "\"p999\": %llu, \"max\": %llu, \"mean\": %.1f}",
+                    label, static_cast<unsigned long long>(h.count()), static_cast<unsigned long long>(h.min()),
+                    static_cast<unsigned long long>(h.percentile(50)),
+                    static_cast<unsigned long long>(h.percentile(90)),
+                    static_cast<unsigned long long>(h.percentile(99)),
+                    static_cast<unsigned long long>(h.percentile(99.9)), static_cast<unsigned long long>(h.max()),
+                    h.mean());
+    }
+
+    /// Receive side of one stream test
+    struct StreamReceiver {
+        Session session;
+        uint64_t received = 0;
+        uint64_t bytes = 0;
+        uint64_t reordered = 0;  ///< Frames with a lower seq than one already seen
+        uint64_t next_seq = 0;   ///< Highest seq seen + 1
+        uint64_t gap_frames = 0; ///< Seq numbers skipped (lost or late)
+        Histogram latency_ns;    ///< One-way latency (same host only)
+        bool active = false;
+
+        inline void on_data(const Probe &p, size_t wire_bytes) {
+            if (!active) {
+                *this = StreamReceiver();
+                session.begin();
+                active = true;
+            }
+            ++received;
+            bytes += wire_bytes;
+            if (p.seq < next_seq) {
+                ++reordered;
+                gap_frames -= gap_frames > 0 ? 1 : 0;
+            } else {
+                gap_frames += p.seq - next_seq;
+                next_seq = p.seq + 1;
+            }
+            if (p.sent_ns != 0) {
+                uint64_t now = clock_ns();
+                latency_ns.record(now > p.sent_ns ? now - p.sent_ns : 0);
+            }
+        }
+    };
+
+    void print_server_report(const Options &o, const StreamReceiver &rx, uint64_t sent) {
+        double elapsed = rx.session.elapsed_s();
+        uint64_t lost = sent > rx.received ? sent - rx.received : 0;
+        double loss_pct = sent == 0 ? 0.0 : static_cast<double>(lost) * 100.0 / static_cast<double>(sent);
+        double mbps = elapsed > 0.0 ? static_cast<double>(rx.bytes) * 8.0 / elapsed / 1e6 : 0.0;
+        double fps = elapsed > 0.0 ? static_cast<double>(rx.received) / elapsed : 0.0;
+        if (o.json) {
+            std::printf("{\"role\": \"server\", \"mode\": \"stream\", \"seconds\": %.3f, \"sent\": %llu, "
+                        "\"received\": %llu, \"lost\": %llu, \"reordered\": %llu, \"frames_per_s\": %.1f, "
+                        "\"mbit_per_s\": %.3f, \"cpu_percent\": %.1f",
+                        elapsed, static_cast<unsigned long long>(sent), static_cast<unsigned long long>(rx.received),
+                        static_cast<unsigned long long>(lost), static_cast<unsigned long long>(rx.reordered), fps,
+                        mbps, rx.session.cpu_percent());
+            print_histogram_json("latency_ns", rx.latency_ns);
+            std::printf("}\n");
+        } else {
+            std::printf("[server] %.2f s: %llu/%llu frames received, %llu lost (%.3f%%), %llu reordered\n", elapsed,
+                        static_cast<unsigned long long>(rx.received), static_cast<unsigned long long>(sent),
+                        static_cast<unsigned long long>(lost), loss_pct, static_cast<unsigned long long>(rx.reordered));
+            std::printf("[server] %.0f frames/s, %.2f Mbit/s, CPU %.1f%%\n", fps, mbps, rx.session.cpu_percent());
+            print_histogram("one-way", rx.latency_ns);
+        }
+        std::fflush(stdout);
+    }
+
+    /// Serve stream and ping tests until interrupted
+    int run_server(Link &link, const Options &o) {
+        Codec codec(o);
+        Vector<Frame> frames;
+        Vector<std::pair<Probe, size_t>> probes;
+        StreamReceiver rx;
+        uint64_t stalls = 0;
+        uint64_t pings = 0;
+        uint64_t last_report_received = 0;
+        double last_t = 0.0;
+        uint64_t last_frames = 0;
+        uint64_t last_bytes = 0;
+
+        std::printf("[server] listening on %s\n", link.name().c_str());
+        std::fflush(stdout);
+        while (g_running) {
+            if (recv_probes(link, codec, std::max<size_t>(o.batch, 64), frames, probes) == 0) {
+                wait_input(link, o, 10000000);
+            }
+            for (const auto &[p, size] : probes) {
+                switch (p.kind) {
+                case ProbeKind::Data:
+                    if (!rx.active) {
+                        last_t = 0.0;
+                        last_frames = 0;
+                        last_bytes = 0;
+                    }
+                    rx.on_data(p, codec.wire_bytes(size));
+                    break;
+                case ProbeKind::Ping: {
+                    Probe reply = p;
+                    reply.kind = ProbeKind::Pong;
+                    if (!send_blocking(link, codec.wrap(reply, size), stalls)) {
+                        return 1;
+                    }
+                    ++pings;
+                    break;
+                }
+                case ProbeKind::End: {
+                    // The client repeats End until it sees a Report; only the first one ends the test
+                    if (rx.active) {
+                        print_server_report(o, rx, p.seq);
+                        last_report_received = rx.received;
+                        rx.active = false;
+                    }
+                    Probe report{ProbeKind::Report, last_report_received, 0};
+                    send_blocking(link, codec.wrap(report, codec.clamp_size(PROBE_FULL)), stalls);
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+            if (rx.active && o.interval_s > 0.0) {
+                double t = rx.session.elapsed_s();
+                if (t - last_t >= o.interval_s) {
+                    print_interval("server", last_t, t, rx.received - last_frames, rx.bytes - last_bytes);
+                    last_t = t;
+                    last_frames = rx.received;
+                    last_bytes = rx.bytes;
+                }
+            }
+        }
+        std::printf("[server] %llu pings echoed\n", static_cast<unsigned long long>(pings));
+        return 0;
+    }
+
+    /// Pace sends to the requested rate
+    void pace(uint64_t &next_ns, double rate, size_t frames) {
+        if (rate <= 0.0) {
+            return;
+        }
+        uint64_t now = clock_ns();
+        if (next_ns > now + 100000) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(next_ns - now - 50000));
+        }
+        while (clock_ns() < next_ns) {
+        }
+        next_ns += static_cast<uint64_t>(static_cast<double>(frames) * 1e9 / rate);
+    }
+
+    /// Send End until the server replies with its received count
+    /// @return Frames the server received, or UINT64_MAX if it did not answer
+    uint64_t finish_stream(Link &link, const Codec &codec, const Options &o, uint64_t sent) {
+        Vector<Frame> frames;
+        Vector<std::pair<Probe, size_t>> probes;
+        uint64_t stalls = 0;
+        for (int attempt = 0; attempt < 20 && g_running; ++attempt) {
+            if (!send_blocking(link, codec.wrap(Probe{ProbeKind::End, sent, 0}, codec.clamp_size(PROBE_FULL)),
+                               stalls)) {
+                return UINT64_MAX;
+            }
+            uint64_t deadline = clock_ns() + 200000000;
+            while (clock_ns() < deadline && g_running) {
+                recv_probes(link, codec, 64, frames, probes);
+                for (const auto &[p, size] : probes) {
+                    if (p.kind == ProbeKind::Report) {
+                        return p.seq;
+                    }
+                }
+                wait_input(link, o, 10000000);
+            }
+        }
+        return UINT64_MAX;
+    }
+
+    int run_stream_client(Link &link, const Options &o) {
+        Codec codec(o);
+        size_t size = codec.clamp_size(o.size);
+        size_t wire = codec.wire_bytes(size);
+        Vector<Frame> batch;
+        uint64_t seq = 0;
+        uint64_t sent = 0;
+        uint64_t stalls = 0;
+        uint64_t deadline = clock_ns() + static_cast<uint64_t>(o.time_s * 1e9);
+        uint64_t next_ns = clock_ns();
+        double last_t = 0.0;
+        uint64_t last_sent = 0;
+
+        std::printf("[client] streaming %zu-byte frames over %s (batch %zu, rate %s)\n", size, link.name().c_str(),
+                    o.batch, o.rate > 0.0 ? std::to_string(static_cast<uint64_t>(o.rate)).c_str() : "unlimited");
+        std::fflush(stdout);
+
+        Session session;
+        session.begin();
+        while (g_running && (o.count > 0 ? sent < o.count : clock_ns() < deadline)) {
+            size_t n = o.count > 0 ? std::min<uint64_t>(o.batch, o.count - sent) : o.batch;
+            pace(next_ns, o.rate, n);
+            batch.clear();
+            uint64_t stamp = clock_ns();
+            for (size_t i = 0; i < n; ++i) {
+                batch.push_back(codec.wrap(Probe{ProbeKind::Data, seq++, stamp}, size));
+            }
+
+            std::span<const Frame> pending(batch.data(), batch.size());
+            while (!pending.empty() && g_running) {
+                auto result = link.send_batch(pending);
+                if (result.is_ok()) {
+                    sent += result.value();
+                    pending = pending.subspan(result.value());
+                    continue;
+                }
+                if (result.error().code != Error::timeout("").code) {
+                    std::fprintf(stderr, "send failed: %s\n", result.error().message.c_str());
+                    return 1;
+                }
+                ++stalls;
+                std::this_thread::yield();
+            }
+
+            if (o.interval_s > 0.0) {
+                double t = session.elapsed_s();
+                if (t - last_t >= o.interval_s) {
+                    print_interval("client", last_t, t, sent - last_sent, (sent - last_sent) * wire);
+                    last_t = t;
+                    last_sent = sent;
+                }
+            }
+        }
+        double elapsed = session.elapsed_s();
+        double cpu = session.cpu_percent();
+        uint64_t received = finish_stream(link, codec, o, sent);
+
+        double fps = elapsed > 0.0 ? static_cast<double>(sent) / elapsed : 0.0;
+        double mbps = fps * static_cast<double>(wire) * 8.0 / 1e6;
+        uint64_t lost = received == UINT64_MAX || received > sent ? 0 : sent - received;
+        if (o.json) {
+            std::printf("{\"role\": \"client\", \"mode\": \"stream\", \"backend\": \"%s\", \"frame_size\": %zu, "
+                        "\"batch\": %zu, \"seconds\": %.3f, \"sent\": %llu, \"received\": %lld, \"lost\": %llu, "
+                        "\"send_stalls\": %llu, \"frames_per_s\": %.1f, \"mbit_per_s\": %.3f, \"cpu_percent\": %.1f}\n",
+                        link.name().c_str(), size, o.batch, elapsed, static_cast<unsigned long long>(sent),
+                        received == UINT64_MAX ? -1LL : static_cast<long long>(received),
+                        static_cast<unsigned long long>(lost), static_cast<unsigned long long>(stalls), fps, mbps,
+                        cpu);
+        } else {
+            std::printf("[client] %.2f s: %llu frames sent, %.0f frames/s, %.2f Mbit/s, %llu send stalls, CPU %.1f%%\n",
+                        elapsed, static_cast<unsigned long long>(sent), fps, mbps,
+                        static_cast<unsigned long long>(stalls), cpu);
+            if (received == UINT64_MAX) {
+                std::printf("[client] no report from the server\n");
+            } else {
+                std::printf("[client] server received %llu, lost %llu (%.3f%%)\n",
+                            static_cast<unsigned long long>(received), static_cast<unsigned long long>(lost),
+                            sent == 0 ? 0.0 : static_cast<double>(lost) * 100.0 / static_cast<double>(sent));
+            }
+        }
+        return 0;
+    }
+
+    int run_ping_client(Link &link, const Options &o) {
+        Codec codec(o);
+        size_t size = codec.clamp_size(o.size);
+        Vector<Frame> frames;
+        Vector<std::pair<Probe, size_t>> probes;
+        Histogram rtt_ns;
+        uint64_t sent = 0;
+        uint64_t lost = 0;
+        uint64_t stalls = 0;
+        uint64_t deadline = clock_ns() + static_cast<uint64_t>(o.time_s * 1e9);
+        uint64_t next_ns = clock_ns();
+        double last_t = 0.0;
+        uint64_t last_count = 0;
+
+        std::printf("[client] pinging with %zu-byte frames over %s\n", size, link.name().c_str());
+        std::fflush(stdout);
+
+        Session session;
+        session.begin();
+        while (g_running && (o.count > 0 ? sent < o.count : clock_ns() < deadline)) {
+            pace(next_ns, o.rate, 1);
+            uint64_t seq = sent++;
+            uint64_t start = clock_ns();
+            if (!send_blocking(link, codec.wrap(Probe{ProbeKind::Ping, seq, start}, size), stalls)) {
+                return 1;
+            }
+
+            bool answered = false;
+            uint64_t timeout_at = start + o.timeout_ms * 1000000;
+            while (!answered && g_running && clock_ns() < timeout_at) {
+                if (recv_probes(link, codec, 16, frames, probes) == 0) {
+                    wait_input(link, o, 1000000);
+                }
+                // Late replies to earlier pings have a lower seq and are skipped
+                for (const auto &[p, psize] : probes) {
+                    if (p.kind == ProbeKind::Pong && p.seq == seq) {
+                        rtt_ns.record(clock_ns() - start);
+                        answered = true;
+                    }
+                }
+            }
+            lost += answered ? 0 : 1;
+
+            if (o.interval_s > 0.0) {
+                double t = session.elapsed_s();
+                if (t - last_t >= o.interval_s) {
+                    std::printf("[client] %6.1f-%6.1f s  %10.0f pings/s  p50 %9.1f us  max %9.1f us\n", last_t, t,
+                                static_cast<double>(rtt_ns.count() - last_count) / (t - last_t),
+                                rtt_ns.percentile(50) / 1e3, rtt_ns.max() / 1e3);
+                    std::fflush(stdout);
+                    last_t = t;
+                    last_count = rtt_ns.count();
+                }
+            }
+        }
+        double elapsed = session.elapsed_s();
+        if (o.json) {
+            std::printf("{\"role\": \"client\", \"mode\": \"ping\", \"backend\": \"%s\", \"frame_size\": %zu, "
+                        "\"seconds\": %.3f, \"sent\": %llu, \"lost\": %llu, \"cpu_percent\": %.1f",
+                        link.name().c_str(), size, elapsed, static_cast<unsigned long long>(sent),
+                        static_cast<unsigned long long>(lost), session.cpu_percent());
+            print_histogram_json("rtt_ns", rtt_ns);
+            std::printf("}\n");
+        } else {
+            std::printf("[client] %.2f s: %llu pings, %llu lost, CPU %.1f%%\n", elapsed,
+                        static_cast<unsigned long long>(sent), static_cast<unsigned long long>(lost),
+                        session.cpu_percent());
+            print_histogram("rtt", rtt_ns);
+        }
+        return 0;
+    }
+
+    void pin_cpu(int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int err = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            echo::warn("Failed to pin to CPU ", cpu, ": ", std::strerror(err)).yellow();
+        }
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options o = parse_options(argc, argv);
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+    if (o.cpu >= 0) {
+        pin_cpu(o.cpu);
+    }
+
+    auto link = open_link(o);
+    if (!link.is_ok()) {
+        std::fprintf(stderr, "Failed to open link: %s\n", link.error().message.c_str());
+        return 1;
+    }
+
+    int code = 0;
+    if (o.server) {
+        code = run_server(*link.value(), o);
+    } else if (o.mode == Mode::Ping) {
+        code = run_ping_client(*link.value(), o);
+    } else {
+        code = run_stream_client(*link.value(), o);
+    }
+    return code;
+}
@@ -0,0 +1,103 @@
+/// @file wirebit_stats.cpp
+/// @brief Print the counters of every link on this host that exports to a StatsRegistry
+///
+/// Links opt in with Link::export_stats(); this tool only maps the registry segment and reads it,
+/// so the processes being watched do no extra work.
+///
+/// Usage:
+///   ./wirebit_stats [interval_ms] [registry]
+///
+/// Example:
+///   ./wirebit_stats              (print once)
+///   ./wirebit_stats 1000         (print every second with per-second rates)
+///   ./wirebit_stats 0 /my_stats  (print once from a custom registry)
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+volatile bool g_running = true;
+
+void signal_handler(int) { g_running = false; }
+
+/// Key identifying one exported link across scrapes
+std::string key_of(const LinkStatsSnapshot &s) {
+    return std::to_string(s.pid) + "/" + s.name.c_str() + "/" + std::to_string(s.started_ns);
+}
+
+/// Print one table row per link
+/// @param links Current snapshot
+/// @param previous Snapshot of the last scrape (for rates), empty on the first one
+/// @param interval_s Seconds since the last scrape
+void print_table(const Vector<LinkStatsSnapshot> &links, const std::map<std::string, LinkStatsSnapshot> &previous,
+                 double interval_s) {
+    printf("%-8s %-10s %-24s %12s %12s %14s %14s %8s %8s %12s %12s\n", "PID", "KIND", "NAME", "TX_FRAMES", "RX_FRAMES",
+           "TX_BYTES", "RX_BYTES", "ERRORS", "DROPS", "RX_QUEUE", "TX_QUEUE");
+    for (const auto &s : links) {
+        uint64_t errors = s.get(LinkCounter::SendErrors) + s.get(LinkCounter::RecvErrors);
+        printf("%-8d %-10s %-24s %12llu %12llu %14llu %14llu %8llu %8llu %6llu/%-5llu %6llu/%-5llu\n", s.pid,
+               s.kind.c_str(), s.name.c_str(), static_cast<unsigned long long>(s.get(LinkCounter::FramesSent)),
+               static_cast<unsigned long long>(s.get(LinkCounter::FramesReceived)),
+               static_cast<unsigned long long>(s.get(LinkCounter::BytesSent)),
+               static_cast<unsigned long long>(s.get(LinkCounter::BytesReceived)),
+               static_cast<unsigned long long>(errors),
+               static_cast<unsigned long long>(s.get(LinkCounter::FramesDropped)),
+               static_cast<unsigned long long>(s.get(LinkCounter::RxQueuedBytes)),
+               static_cast<unsigned long long>(s.get(LinkCounter::RxCapacityBytes)),
+               static_cast<unsigned long long>(s.get(LinkCounter::TxQueuedBytes)),
+               static_cast<unsigned long long>(s.get(LinkCounter::TxCapacityBytes)));
+
+        auto it = previous.find(key_of(s));
+        if (it != previous.end() && interval_s > 0.0) {
+            const LinkStatsSnapshot &p = it->second;
+            printf("%-44s %10.0f/s %10.0f/s %12.0f/s %12.0f/s\n", "",
+                   static_cast<double>(s.get(LinkCounter::FramesSent) - p.get(LinkCounter::FramesSent)) / interval_s,
+                   static_cast<double>(s.get(LinkCounter::FramesReceived) - p.get(LinkCounter::FramesReceived)) /
+                       interval_s,
+                   static_cast<double>(s.get(LinkCounter::BytesSent) - p.get(LinkCounter::BytesSent)) / interval_s,
+                   static_cast<double>(s.get(LinkCounter::BytesReceived) - p.get(LinkCounter::BytesReceived)) /
+                       interval_s);
+        }
+    }
+    printf("%zu link(s)\n", links.size());
+}
+
+int main(int argc, char **argv) {
+    int interval_ms = argc > 1 ? std::atoi(argv[1]) : 0;
+    String name = argc > 2 ? String(argv[2]) : String(StatsRegistry::DEFAULT_NAME);
+
+    auto registry = StatsRegistry::open(name);
+    if (!registry.is_ok()) {
+        fprintf(stderr, "Cannot open stats registry %s: %s\n", name.c_str(), registry.error().message.c_str());
+        return 1;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    std::map<std::string, LinkStatsSnapshot> previous;
+    auto last = std::chrono::steady_clock::now();
+    do {
+        Vector<LinkStatsSnapshot> links = registry.value().snapshot();
+        auto now = std::chrono::steady_clock::now();
+        print_table(links, previous, std::chrono::duration<double>(now - last).count());
+        last = now;
+
+        previous.clear();
+        for (const auto &s : links) {
+            previous[key_of(s)] = s;
+        }
+        if (interval_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+            printf("\n");
+        }
+    } while (interval_ms > 0 && g_running);
+    return 0;
+}
@@ -0,0 +1,641 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/endpoint.hpp>
+#include <wirebit/frame.hpp>
+#include <wirebit/link.hpp>
+#include <wirebit/link_reactor.hpp>
+
+namespace wirebit {
+
+    /// AsyncLoop configuration
+    struct AsyncLoopConfig {
+        LinkReactorConfig reactor = {};       ///< Reactor waiting on the links tasks are parked on
+        uint64_t send_retry_ns = 100000;      ///< Retry period of sends parked on a full link
+        uint64_t idle_timeout_ns = 100000000; ///< Longest wait per run() round (bounds how quickly stop() is noticed)
+        size_t process_budget = 64;           ///< Endpoint process() calls per receive attempt
+    };
+
+    /// Statistics for AsyncLoop
+    struct AsyncLoopStats {
+        uint64_t tasks_spawned = 0;   ///< spawn() calls
+        uint64_t tasks_completed = 0; ///< Spawned tasks that ran to completion
+        uint64_t resumes = 0;         ///< Coroutines resumed by the loop
+        uint64_t recv_parks = 0;      ///< Receives that found no input and suspended
+        uint64_t send_parks = 0;      ///< Sends refused under backpressure that suspended
+        uint64_t timer_parks = 0;     ///< sleep_for()/sleep_until() calls that suspended
+
+        inline void reset() {
+            tasks_spawned = 0;
+            tasks_completed = 0;
+            resumes = 0;
+            recv_parks = 0;
+            send_parks = 0;
+            timer_parks = 0;
+        }
+    };
+
+    template <typename T = void> class Task;
+
+    namespace detail {
+        /// Promise parts shared by every Task: lazy start, resume the awaiting coroutine when done
+        struct TaskPromiseBase {
+            std::coroutine_handle<> continuation = std::noop_coroutine(); ///< Coroutine awaiting this task
+
+            struct FinalAwaiter {
+                inline bool await_ready() const noexcept { return false; }
+                template <typename P>
+                inline std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+                    return h.promise().continuation;
+                }
+                inline void await_resume() const noexcept {}
+            };
+
+            inline std::suspend_always initial_suspend() const noexcept { return {}; }
+            inline FinalAwaiter final_suspend() const noexcept { return {}; }
+            inline void unhandled_exception() const noexcept { std::terminate(); } // Errors travel as Result
+        };
+
+        template <typename T> struct TaskPromise : TaskPromiseBase {
+            std::optional<T> value;
+
+            inline Task<T> get_return_object();
+            inline void return_value(T v) { value.emplace(std::move(v)); }
+            inline T take() { return std::move(*value); }
+        };
+
+        template <> struct TaskPromise<void> : TaskPromiseBase {
+            inline Task<void> get_return_object();
+            inline void return_void() const noexcept {}
+            inline void take() const noexcept {}
+        };
+    } // namespace detail
+
+    /// Lazily started coroutine returning T
+    /// A Task runs when it is awaited (or spawned on an AsyncLoop); its caller resumes when it
+    /// finishes, without going through the loop. Tasks are move-only and destroy their frame.
+    ///
+    /// Example usage:
+    /// @code
+    /// Task<int> answer() { co_return 42; }
+    /// Task<> ecu(AsyncLoop &loop) { int v = co_await answer(); ... }
+    /// @endcode
+    template <typename T> class Task {
+      public:
+        using promise_type = detail::TaskPromise<T>;
+
+        Task() = default;
+        inline explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+        inline Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+        inline Task &operator=(Task &&other) noexcept {
+            if (this != &other) {
+                if (handle_) {
+                    handle_.destroy();
+                }
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+
+        inline ~Task() {
+            if (handle_) {
+                handle_.destroy();
+            }
+        }
+
+        /// Check if the task has run to completion
+        inline bool done() const { return !handle_ || handle_.done(); }
+
+        // Awaitable: start the task and resume the caller with its result
+        inline bool await_ready() const noexcept { return done(); }
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+            handle_.promise().continuation = caller;
+            return handle_;
+        }
+        inline T await_resume() { return handle_.promise().take(); }
+
+      private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    namespace detail {
+        template <typename T> inline Task<T> TaskPromise<T>::get_return_object() {
+            return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() {
+            return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+        }
+
+        /// Coroutine parked on a link until its operation can complete
+        struct AsyncWaiter {
+            std::coroutine_handle<> handle;           ///< Coroutine to resume
+            bool (*attempt)(AsyncWaiter &) = nullptr; ///< Retry the operation; true once it completed
+            const Endpoint *endpoint = nullptr;       ///< Endpoint whose held frames also wake the waiter
+            AsyncWaiter *next = nullptr;              ///< Next waiter on the same link
+        };
+
+        /// FIFO of parked waiters (intrusive, the waiters live in the coroutine frames)
+        struct AsyncWaitList {
+            AsyncWaiter *head = nullptr;
+            AsyncWaiter *tail = nullptr;
+
+            inline bool empty() const { return head == nullptr; }
+
+            inline void push(AsyncWaiter &waiter) {
+                waiter.next = nullptr;
+                if (tail != nullptr) {
+                    tail->next = &waiter;
+                } else {
+                    head = &waiter;
+                }
+                tail = &waiter;
+            }
+
+            inline AsyncWaiter *pop() {
+                AsyncWaiter *waiter = head;
+                head = waiter->next;
+                if (head == nullptr) {
+                    tail = nullptr;
+                }
+                return waiter;
+            }
+        };
+
+        /// Root of a spawned task: owns the Task and frees itself when it finishes
+        struct SpawnedTask {
+            struct promise_type {
+                std::unordered_set<void *> *roots = nullptr; ///< Loop's set of unfinished spawned tasks
+                AsyncLoopStats *stats = nullptr;             ///< Loop statistics
+
+                struct FinalAwaiter {
+                    inline bool await_ready() const noexcept { return false; }
+                    inline void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                        h.promise().roots->erase(h.address());
+                        h.promise().stats->tasks_completed++;
+                        h.destroy();
+                    }
+                    inline void await_resume() const noexcept {}
+                };
+
+                inline SpawnedTask get_return_object() {
+                    return SpawnedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+                inline std::suspend_always initial_suspend() const noexcept { return {}; }
+                inline FinalAwaiter final_suspend() const noexcept { return {}; }
+                inline void return_void() const noexcept {}
+                inline void unhandled_exception() const noexcept { std::terminate(); }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        inline bool is_would_block(const Error &error) { return error.code == Error::timeout("").code; }
+    } // namespace detail
+
+    /// Single-threaded executor for coroutine tasks over links and endpoints
+    ///
+    /// Tasks await link and endpoint operations instead of polling them: an operation that would
+    /// return Error::timeout (no input, or a full link) suspends the task, and the loop retries it
+    /// when the link becomes ready. Suspended tasks cost their coroutine frame only, so thousands of
+    /// simulated ECUs fit on one thread; run one AsyncLoop per thread to use several cores, each
+    /// with its own links.
+    ///
+    /// Waiting goes through a LinkReactor: a link is registered while tasks are parked on it, so the
+    /// loop sleeps on its poll_fd() (SocketCAN, TAP, PTY, ShmLink after enable_wakeups()) and polls
+    /// the links without one every reactor poll_interval_ns. Frames held by a link or endpoint wake
+    /// the parked tasks when due. There is no writable notification for links, so parked sends are
+    /// retried every send_retry_ns, or as soon as the link is serviced and can_send() holds.
+    ///
+    /// Timers (sleep_for()/sleep_until()) follow now_ns(), so they also run on a VirtualClock; drive
+    /// the loop with run_once(0) and advance the clock to next_deadline().
+    ///
+    /// Example usage:
+    /// @code
+    /// Task<> ecu(AsyncLoop &loop, CanEndpoint &ep) {
+    ///     while (true) {
+    ///         auto frame = co_await loop.recv_can_async(ep);
+    ///         if (!frame.is_ok()) co_return;
+    ///         co_await loop.send_can_async(ep, reply_to(frame.value()));
+    ///     }
+    /// }
+    /// auto loop = AsyncLoop::create().value();
+    /// loop.spawn(ecu(loop, ep));
+    /// loop.run();
+    /// @endcode
+    class AsyncLoop {
+      public:
+        /// Create a loop
+        /// @param config Loop configuration
+        /// @return Result containing AsyncLoop, or error if the reactor could not be created
+        static Result<AsyncLoop, Error> create(const AsyncLoopConfig &config = AsyncLoopConfig{}) {
+            auto reactor = LinkReactor::create(config.reactor);
+            if (!reactor.is_ok()) {
+                return Result<AsyncLoop, Error>::err(reactor.error());
+            }
+            auto core = std::make_unique<Core>(config, std::move(reactor.value()));
+            return Result<AsyncLoop, Error>::ok(AsyncLoop(std::move(core)));
+        }
+
+        /// Destructor - destroys the tasks that have not finished
+        ~AsyncLoop() {
+            if (core_) {
+                core_->shutdown();
+            }
+        }
+
+        AsyncLoop(AsyncLoop &&) noexcept = default;
+
+        AsyncLoop &operator=(AsyncLoop &&other) noexcept {
+            if (this != &other) {
+                if (core_) {
+                    core_->shutdown();
+                }
+                core_ = std::move(other.core_);
+            }
+            return *this;
+        }
+
+        AsyncLoop(const AsyncLoop &) = delete;
+        AsyncLoop &operator=(const AsyncLoop &) = delete;
+
+        /// Start a task on the loop; the loop owns it until it finishes
+        /// The task first runs on the next run_once(). Call from the loop's thread.
+        /// @param task Task to run
+        inline void spawn(Task<void> task) {
+            detail::SpawnedTask root = run_spawned(std::move(task));
+            root.handle.promise().roots = &core_->roots;
+            root.handle.promise().stats = &core_->stats;
+            core_->roots.insert(root.handle.address());
+            core_->ready.push_back(root.handle);
+            core_->stats.tasks_spawned++;
+        }
+
+        /// Resume ready tasks, wait up to timeout_ns for links or timers, then resume what woke up
+        /// Does not wait while tasks are ready to run.
+        /// @param timeout_ns Maximum time to wait in nanoseconds
+        /// @return Result containing the number of coroutines resumed, or error if the reactor failed
+        Result<size_t, Error> run_once(uint64_t timeout_ns) {
+            Core &core = *core_;
+            size_t resumed = core.resume_ready();
+            uint64_t now = now_ns();
+            core.fire_timers(now);
+
+            uint64_t wait = 0;
+            if (core.ready.empty()) {
+                uint64_t timer = core.next_timer();
+                wait = timer <= now ? 0 : std::min(timeout_ns, timer - now);
+            }
+            if (wait > 0 || core.reactor.size() > 0) { // Nothing to poll or sleep for: skip epoll_wait()
+                auto result = core.reactor.run_once(wait);
+                if (!result.is_ok()) {
+                    return Result<size_t, Error>::err(result.error());
+                }
+            }
+            core.fire_timers(now_ns());
+            resumed += core.resume_ready();
+            return Result<size_t, Error>::ok(resumed);
+        }
+
+        /// Run until every spawned task has finished or stop() is called
+        /// @return Result indicating clean exit, or error if the reactor failed
+        Result<Unit, Error> run() {
+            core_->stopping.store(false, std::memory_order_relaxed);
+            while (!core_->roots.empty() && !core_->stopping.load(std::memory_order_relaxed)) {
+                auto result = run_once(core_->config.idle_timeout_ns);
+                if (!result.is_ok()) {
+                    return Result<Unit, Error>::err(result.error());
+                }
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Make run() return after the current round (safe from any thread)
+        inline void stop() { core_->stopping.store(true, std::memory_order_relaxed); }
+
+        /// Awaitable: receive a frame, suspending until one arrives
+        /// @param link Link to receive from (the loop owns its receive side while tasks wait on it)
+        /// @return Awaitable yielding Result<Frame, Error> (errors other than "no input" are returned as is)
+        inline auto recv_async(Link &link) {
+            return make_op(link, true, nullptr, [&link]() { return link.recv(); });
+        }
+
+        /// Awaitable: send a frame, suspending while the link refuses it as full
+        /// The frame is borrowed: it must stay alive until the await completes, which holds for a
+        /// temporary in the co_await expression.
+        /// @param link Link to send through
+        /// @param frame Frame to send
+        /// @return Awaitable yielding Result<Unit, Error>
+        inline auto send_async(Link &link, const Frame &frame) {
+            return make_op(link, false, nullptr, [&link, &frame]() { return link.send(frame); });
+        }
+
+        /// Awaitable: receive from an endpoint, suspending until its link delivers data
+        /// The endpoint's process() is run for the waiting task, so nobody else needs to pump it.
+        /// @param endpoint Endpoint to receive from
+        /// @return Awaitable yielding the Result of Endpoint::recv()
+        inline auto recv_async(Endpoint &endpoint) {
+            Core *core = core_.get();
+            return make_op(*endpoint.link(), true, &endpoint, [core, &endpoint]() {
+                auto data = endpoint.recv();
+                if (data.is_ok() || !detail::is_would_block(data.error())) {
+                    return data;
+                }
+                core->process(endpoint);
+                return endpoint.recv();
+            });
+        }
+
+        /// Awaitable: send through an endpoint, suspending while its link is full
+        /// @param endpoint Endpoint to send through
+        /// @param data Data for Endpoint::send() (borrowed like the frame of send_async(Link &, const Frame &))
+        /// @return Awaitable yielding Result<Unit, Error>
+        inline auto send_async(Endpoint &endpoint, const Bytes &data) {
+            return make_op(*endpoint.link(), false, nullptr, [&endpoint, &data]() { return endpoint.send(data); });
+        }
+
+        /// Awaitable: receive a classic CAN frame, suspending until one arrives
+        /// @param endpoint CAN endpoint to receive from
+        /// @return Awaitable yielding Result<can_frame, Error>
+        inline auto recv_can_async(CanEndpoint &endpoint) {
+            return make_op(*endpoint.link(), true, &endpoint, [&endpoint]() {
+                can_frame cf = {};
+                auto result = endpoint.recv_can(cf);
+                if (!result.is_ok()) {
+                    return Result<can_frame, Error>::err(result.error());
+                }
+                return Result<can_frame, Error>::ok(cf);
+            });
+        }
+
+        /// Awaitable: send a classic CAN frame, suspending while the link is full
+        /// @param endpoint CAN endpoint to send through
+        /// @param cf Frame to send (copied into the awaitable)
+        /// @return Awaitable yielding Result<Unit, Error>
+        inline auto send_can_async(CanEndpoint &endpoint, const can_frame &cf) {
+            return make_op(*endpoint.link(), false, nullptr, [&endpoint, cf]() { return endpoint.send_can(cf); });
+        }
+
+        /// Awaitable: suspend until now_ns() reaches a deadline
+        /// @param deadline_ns Wake-up time in nanoseconds
+        inline auto sleep_until(uint64_t deadline_ns) { return TimerAwaiter{core_.get(), deadline_ns}; }
+
+        /// Awaitable: suspend for a duration
+        /// @param ns Duration in nanoseconds
+        inline auto sleep_for(uint64_t ns) { return TimerAwaiter{core_.get(), now_ns() + ns}; }
+
+        /// Awaitable: let the other ready tasks run first
+        inline auto yield() { return YieldAwaiter{core_.get()}; }
+
+        /// Get the earliest timer deadline
+        /// @return Deadline in nanoseconds, or UINT64_MAX without timers
+        inline uint64_t next_deadline() const { return core_->next_timer(); }
+
+        /// Get the number of spawned tasks that have not finished
+        inline size_t tasks() const { return core_->roots.size(); }
+
+        /// Get the underlying reactor (e.g. to add handlers of your own)
+        inline LinkReactor &reactor() { return core_->reactor; }
+
+        /// Get loop statistics
+        inline const AsyncLoopStats &stats() const { return core_->stats; }
+
+        /// Reset statistics
+        inline void reset_stats() { core_->stats.reset(); }
+
+      private:
+        /// Parked tasks of one link
+        struct Watch {
+            Link *link = nullptr;
+            detail::AsyncWaitList recv;     ///< Receives waiting for input
+            detail::AsyncWaitList send;     ///< Sends waiting for room
+            uint64_t retry_at = UINT64_MAX; ///< Next retry of the parked sends
+            bool registered = false;        ///< Registered with the reactor
+
+            /// Earliest time a parked operation must be retried without input
+            inline uint64_t next_deadline() const {
+                uint64_t due = send.empty() ? UINT64_MAX : retry_at;
+                for (const detail::AsyncWaiter *w = recv.head; w != nullptr; w = w->next) {
+                    if (w->endpoint != nullptr) {
+                        due = std::min(due, w->endpoint->next_deadline());
+                    }
+                }
+                return due;
+            }
+        };
+
+        struct Timer {
+            uint64_t deadline = 0;
+            uint64_t seq = 0; ///< Arming order (ties between equal deadlines)
+            std::coroutine_handle<> handle;
+        };
+
+        /// Loop state, kept behind a unique_ptr so awaitables and reactor handlers see a stable address
+        struct Core {
+            AsyncLoopConfig config;
+            LinkReactor reactor;
+            Vector<std::coroutine_handle<>> ready;   ///< Coroutines to resume next round
+            Vector<std::coroutine_handle<>> running; ///< Round being resumed (swapped with ready)
+            std::unordered_set<void *> roots;        ///< Frames of unfinished spawned tasks
+            std::unordered_map<Link *, std::unique_ptr<Watch>> watches;
+            Vector<Timer> timers; ///< Min-heap on (deadline, seq)
+            uint64_t timer_seq = 0;
+            std::atomic<bool> stopping{false};
+            AsyncLoopStats stats;
+
+            Core(const AsyncLoopConfig &c, LinkReactor &&r) : config(c), reactor(std::move(r)) {}
+
+            inline size_t resume_ready() {
+                running.swap(ready);
+                for (std::coroutine_handle<> handle : running) {
+                    handle.resume();
+                }
+                size_t resumed = running.size();
+                stats.resumes += resumed;
+                running.clear();
+                return resumed;
+            }
+
+            /// Helper: Park a waiter on its link, registering the link with the reactor if needed
+            inline Result<Unit, Error> park(Link &link, detail::AsyncWaiter &waiter, bool recv) {
+                auto &slot = watches[&link];
+                if (!slot) {
+                    slot = std::make_unique<Watch>();
+                    slot->link = &link;
+                }
+                Watch *watch = slot.get();
+                if (!watch->registered) {
+                    auto added = reactor.add(
+                        link, [this, watch]() { return service(*watch); }, 1,
+                        [watch]() { return watch->next_deadline(); });
+                    if (!added.is_ok()) {
+                        return added;
+                    }
+                    watch->registered = true;
+                }
+                if (recv) {
+                    watch->recv.push(waiter);
+                    stats.recv_parks++;
+                } else {
+                    watch->send.push(waiter);
+                    watch->retry_at = now_ns() + config.send_retry_ns;
+                    stats.send_parks++;
+                }
+                return Result<Unit, Error>::ok(Unit{});
+            }
+
+            /// Reactor handler: retry the parked operations of a link in order; unregister once none are left
+            inline bool service(Watch &watch) {
+                uint64_t now = now_ns();
+                if (!watch.send.empty() && (now >= watch.retry_at || watch.link->can_send())) {
+                    wake(watch.send);
+                    watch.retry_at = now + config.send_retry_ns;
+                }
+                wake(watch.recv);
+                if (watch.recv.empty() && watch.send.empty()) {
+                    reactor.remove(*watch.link);
+                    watch.registered = false;
+                }
+                return false;
+            }
+
+            /// Helper: Complete waiters from the front of a list until one still cannot proceed
+            inline void wake(detail::AsyncWaitList &list) {
+                while (!list.empty() && list.head->attempt(*list.head)) {
+                    ready.push_back(list.pop()->handle);
+                }
+            }
+
+            /// Helper: Move an endpoint's input from its link into its receive buffer
+            inline void process(Endpoint &endpoint) {
+                for (size_t i = 0; i < config.process_budget; ++i) {
+                    auto result = endpoint.process();
+                    if (!result.is_ok() && detail::is_would_block(result.error())) {
+                        break;
+                    }
+                }
+            }
+
+            inline void arm(uint64_t deadline, std::coroutine_handle<> handle) {
+                timers.push_back(Timer{deadline, timer_seq++, handle});
+                std::push_heap(timers.begin(), timers.end(), later);
+                stats.timer_parks++;
+            }
+
+            inline void fire_timers(uint64_t now) {
+                while (!timers.empty() && timers.front().deadline <= now) {
+                    std::pop_heap(timers.begin(), timers.end(), later);
+                    ready.push_back(timers.back().handle);
+                    timers.pop_back();
+                }
+            }
+
+            inline uint64_t next_timer() const { return timers.empty() ? UINT64_MAX : timers.front().deadline; }
+
+            /// Helper: Destroy unfinished tasks (their parked waiters and timers go with them)
+            inline void shutdown() {
+                for (auto &[link, watch] : watches) {
+                    if (watch->registered) {
+                        reactor.remove(*link);
+                    }
+                }
+                watches.clear();
+                timers.clear();
+                ready.clear();
+                for (void *root : roots) {
+                    std::coroutine_handle<>::from_address(root).destroy();
+                }
+                roots.clear();
+            }
+
+            static inline bool later(const Timer &a, const Timer &b) {
+                return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+            }
+        };
+
+        /// Awaitable link/endpoint operation: completes at once if it can, otherwise parks on the link
+        template <typename Op> class OpAwaiter : public detail::AsyncWaiter {
+          public:
+            using ResultType = std::invoke_result_t<Op &>;
+
+            OpAwaiter(Core *core, Link &link, bool recv, const Endpoint *ep, Op op)
+                : core_(core), link_(link), recv_(recv), op_(std::move(op)) {
+                endpoint = ep;
+                attempt = &OpAwaiter::retry;
+            }
+
+            inline bool await_ready() { return retry(*this); }
+
+            inline bool await_suspend(std::coroutine_handle<> caller) {
+                handle = caller;
+                auto parked = core_->park(link_, *this, recv_);
+                if (!parked.is_ok()) {
+                    result_.emplace(ResultType::err(parked.error()));
+                    return false; // Could not wait on the link: resume at once with the error
+                }
+                return true;
+            }
+
+            inline ResultType await_resume() { return std::move(*result_); }
+
+          private:
+            Core *core_;
+            Link &link_;
+            bool recv_;
+            Op op_;
+            std::optional<ResultType> result_;
+
+            static inline bool retry(detail::AsyncWaiter &waiter) {
+                auto &self = static_cast<OpAwaiter &>(waiter);
+                auto result = self.op_();
+                if (!result.is_ok() && detail::is_would_block(result.error())) {
+                    return false;
+                }
+                self.result_.emplace(std::move(result));
+                return true;
+            }
+        };
+
+        struct TimerAwaiter {
+            Core *core;
+            uint64_t deadline;
+
+            inline bool await_ready() const { return deadline <= static_cast<uint64_t>(now_ns()); }
+            inline void await_suspend(std::coroutine_handle<> caller) { core->arm(deadline, caller); }
+            inline void await_resume() const noexcept {}
+        };
+
+        struct YieldAwaiter {
+            Core *core;
+
+            inline bool await_ready() const noexcept { return false; }
+            inline void await_suspend(std::coroutine_handle<> caller) { core->ready.push_back(caller); }
+            inline void await_resume() const noexcept {}
+        };
+
+        std::unique_ptr<Core> core_;
+
+        explicit AsyncLoop(std::unique_ptr<Core> core) : core_(std::move(core)) {}
+
+        template <typename Op> inline OpAwaiter<Op> make_op(Link &link, bool recv, const Endpoint *ep, Op op) {
+            return OpAwaiter<Op>(core_.get(), link, recv, ep, std::move(op));
+        }
+
+        static inline detail::SpawnedTask run_spawned(Task<void> task) { co_await task; }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,570 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <echo/echo.hpp>
+#include <memory>
+#include <thread>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/delay_line.hpp>
+#include <wirebit/frame_pool.hpp>
+#include <wirebit/link.hpp>
+#include <wirebit/link_reactor.hpp>
+#include <wirebit/model.hpp>
+
+namespace wirebit {
+
+    /// Bit of a frame type in BridgeConfig::a_to_b_types / b_to_a_types
+    constexpr uint32_t frame_type_bit(FrameType type) { return 1u << static_cast<uint16_t>(type); }
+
+    /// Type mask that forwards every frame type
+    constexpr uint32_t BRIDGE_ALL_TYPES = 0xFFFFFFFFu;
+
+    /// Direction through a Bridge
+    enum class BridgeDirection : uint8_t {
+        AToB = 0, ///< Received on link A, sent on link B
+        BToA = 1, ///< Received on link B, sent on link A
+    };
+
+    /// Configuration for Bridge
+    struct BridgeConfig {
+        size_t batch = 32;                       ///< Frames taken from each source per turn
+        uint32_t a_to_b_types = BRIDGE_ALL_TYPES; ///< Frame types forwarded from A to B (frame_type_bit())
+        uint32_t b_to_a_types = BRIDGE_ALL_TYPES; ///< Frame types forwarded from B to A
+        size_t max_held = 4096;                  ///< Frames held by the link model per direction before
+                                                 ///< the source is left unread
+        uint64_t retry_ns = 100000;              ///< Retry delay after the destination refused a frame
+        uint64_t idle_sleep_ns = 50000;          ///< Bridge thread back-off when nothing moved (start())
+    };
+
+    /// Statistics for one direction of a Bridge
+    struct BridgeDirectionStats {
+        uint64_t frames_forwarded = 0;  ///< Frames accepted by the destination
+        uint64_t bytes_forwarded = 0;   ///< Bytes accepted by the destination (header + payload + meta)
+        uint64_t frames_filtered = 0;   ///< Frames of a type not forwarded in this direction
+        uint64_t frames_dropped = 0;    ///< Frames dropped by the link model
+        uint64_t frames_duplicated = 0; ///< Frames duplicated by the link model
+        uint64_t frames_corrupted = 0;  ///< Frames corrupted by the link model
+        uint64_t send_errors = 0;       ///< Frames the destination rejected (wrong type, size, I/O error)
+        uint64_t backpressure = 0;      ///< Turns stopped because the destination was full
+        uint64_t held = 0;              ///< Frames waiting in the bridge (model delay or full destination)
+
+        inline void reset() {
+            frames_forwarded = 0;
+            bytes_forwarded = 0;
+            frames_filtered = 0;
+            frames_dropped = 0;
+            frames_duplicated = 0;
+            frames_corrupted = 0;
+            send_errors = 0;
+            backpressure = 0;
+            held = 0;
+        }
+    };
+
+    /// Statistics for Bridge
+    struct BridgeStats {
+        BridgeDirectionStats a_to_b; ///< Frames received on A and sent on B
+        BridgeDirectionStats b_to_a; ///< Frames received on B and sent on A
+
+        inline void reset() {
+            a_to_b.reset();
+            b_to_a.reset();
+        }
+    };
+
+    namespace detail {
+        /// One direction of a Bridge: source, destination and the frames in between
+        struct BridgePath {
+            Link *src = nullptr;
+            Link *dst = nullptr;
+            uint32_t types = BRIDGE_ALL_TYPES;
+            DeterministicRNG rng;           ///< Link model rolls (seeded per direction)
+            FrameActionSampler sampler;     ///< Drop/duplicate/corrupt draws from rng
+            uint64_t next_send_time = 0;    ///< Link model bandwidth pacing
+            DelayLine<Frame> held;          ///< Modelled frames waiting for their deliver_at_ns
+            Vector<Frame> out;              ///< Due frames waiting for room in the destination
+            size_t out_head = 0;            ///< First frame of `out` not yet sent
+            FrameView parked;               ///< Source view the destination refused (still owned by src)
+            bool has_parked = false;        ///< `parked` is valid
+            uint64_t retry_at = UINT64_MAX; ///< When to retry after backpressure
+
+            // Counters (see BridgeDirectionStats), written by the pumping thread only
+            std::atomic<uint64_t> frames_forwarded{0};
+            std::atomic<uint64_t> bytes_forwarded{0};
+            std::atomic<uint64_t> frames_filtered{0};
+            std::atomic<uint64_t> frames_dropped{0};
+            std::atomic<uint64_t> frames_duplicated{0};
+            std::atomic<uint64_t> frames_corrupted{0};
+            std::atomic<uint64_t> send_errors{0};
+            std::atomic<uint64_t> backpressure{0};
+            std::atomic<uint64_t> held_frames{0};
+
+            /// Earliest time this direction needs a turn without new input
+            inline uint64_t next_deadline() const { return std::min(retry_at, held.next_deadline()); }
+
+            inline BridgeDirectionStats snapshot() const {
+                BridgeDirectionStats stats;
+                stats.frames_forwarded = frames_forwarded.load(std::memory_order_relaxed);
+                stats.bytes_forwarded = bytes_forwarded.load(std::memory_order_relaxed);
+                stats.frames_filtered = frames_filtered.load(std::memory_order_relaxed);
+                stats.frames_dropped = frames_dropped.load(std::memory_order_relaxed);
+                stats.frames_duplicated = frames_duplicated.load(std::memory_order_relaxed);
+                stats.frames_corrupted = frames_corrupted.load(std::memory_order_relaxed);
+                stats.send_errors = send_errors.load(std::memory_order_relaxed);
+                stats.backpressure = backpressure.load(std::memory_order_relaxed);
+                stats.held = held_frames.load(std::memory_order_relaxed);
+                return stats;
+            }
+
+            inline void reset_counters() {
+                for (auto *counter : {&frames_forwarded, &bytes_forwarded, &frames_filtered, &frames_dropped,
+                                      &frames_duplicated, &frames_corrupted, &send_errors, &backpressure}) {
+                    counter->store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        /// Forwarding engine of a Bridge (on the heap so the bridge can move while its thread runs)
+        struct BridgeCore {
+            /// Outcome of handing one frame to a destination
+            enum class Send : uint8_t { Sent, Refused, Failed };
+
+            std::shared_ptr<Link> a;
+            std::shared_ptr<Link> b;
+            BridgeConfig config;
+            bool has_model = false;
+            LinkModel model;
+            BridgePath paths[2];           ///< Indexed by BridgeDirection
+            FramePool pool;                ///< Buffers of held frames (used by the pumping thread only)
+            std::atomic<bool> running{false};
+            LinkReactor *reactor = nullptr; ///< Reactor the links are registered with, if any
+            std::thread thread;
+
+            /// Give one direction a turn
+            /// @param p Direction
+            /// @param more Set when the source may still have input (the batch was used up)
+            /// @return Frames accepted by the destination
+            inline size_t forward(BridgePath &p, bool &more) {
+                more = false;
+                uint64_t now = now_ns();
+                p.retry_at = UINT64_MAX;
+                size_t sent = 0;
+                if (!send_pending(p, now, sent)) {
+                    return stall(p, now, sent);
+                }
+
+                size_t taken = 0;
+                while (taken < config.batch) {
+                    if (has_model && p.held.size() >= config.max_held) {
+                        break; // Leave the input in the source until modelled frames drain
+                    }
+                    FrameView view;
+                    if (p.has_parked) {
+                        view = p.parked;
+                        p.has_parked = false;
+                    } else {
+                        auto received = p.src->recv_view();
+                        if (!received.is_ok()) {
+                            break;
+                        }
+                        view = received.value();
+                        ++taken;
+                        if ((p.types & frame_type_bit(view.type())) == 0) {
+                            bump(p.frames_filtered);
+                            continue;
+                        }
+                    }
+
+                    if (!has_model) {
+                        // Zero-copy: the view goes from the source's buffer straight to the destination
+                        Send outcome = send_one(p, view);
+                        if (outcome == Send::Refused) {
+                            p.parked = view;
+                            p.has_parked = true;
+                            return stall(p, now, sent);
+                        }
+                        sent += outcome == Send::Sent ? 1 : 0;
+                        continue;
+                    }
+                    if (!apply_model(p, view, now, sent)) {
+                        return stall(p, now, sent);
+                    }
+                }
+
+                if (!send_pending(p, now, sent)) {
+                    return stall(p, now, sent);
+                }
+                more = taken == config.batch;
+                p.held_frames.store(held_count(p), std::memory_order_relaxed);
+                return sent;
+            }
+
+            /// Give both directions a turn
+            inline size_t pump(bool &more) {
+                bool more_a = false;
+                bool more_b = false;
+                size_t sent = forward(paths[0], more_a) + forward(paths[1], more_b);
+                more = more_a || more_b;
+                return sent;
+            }
+
+            /// Earliest time either direction needs a turn without new input
+            inline uint64_t next_deadline() const {
+                return std::min(paths[0].next_deadline(), paths[1].next_deadline());
+            }
+
+            /// Helper: Roll the link model once for a received frame, then send or hold it
+            /// @return false if the destination refused a frame (the rest is queued in `out`)
+            inline bool apply_model(BridgePath &p, const FrameView &view, uint64_t now, size_t &sent) {
+                FrameAction action = p.sampler.next(p.rng);
+                if (action == FrameAction::DROP) {
+                    bump(p.frames_dropped);
+                    return true;
+                }
+                size_t copies = 1;
+                if (action == FrameAction::DUPLICATE) {
+                    bump(p.frames_duplicated);
+                    copies = 2;
+                } else if (action == FrameAction::CORRUPT) {
+                    bump(p.frames_corrupted);
+                }
+
+                FrameView stamped = view;
+                stamped.header.deliver_at_ns = compute_deliver_at_ns(
+                    model, now, static_cast<uint32_t>(view.payload.size()), p.next_send_time, p.rng);
+                bool due = stamped.header.deliver_at_ns <= now && p.held.empty() && p.out_head == p.out.size();
+
+                // Due, untouched frames go out from the source's buffer; the rest are copied and held
+                while (copies > 0 && due && action != FrameAction::CORRUPT) {
+                    Send outcome = send_one(p, stamped);
+                    if (outcome == Send::Refused) {
+                        for (; copies > 0; --copies) {
+                            p.out.push_back(pool.to_frame(stamped));
+                        }
+                        return false;
+                    }
+                    sent += outcome == Send::Sent ? 1 : 0;
+                    --copies;
+                }
+                for (; copies > 0; --copies) {
+                    Frame frame = pool.to_frame(stamped);
+                    if (action == FrameAction::CORRUPT) {
+                        corrupt_payload(frame.payload, p.rng, model.sampling);
+                    }
+                    p.held.push(frame.header.deliver_at_ns, std::move(frame));
+                }
+                return true;
+            }
+
+            /// Helper: Send queued due frames, topping the queue up from the delay line
+            /// @return false if the destination refused a frame
+            inline bool send_pending(BridgePath &p, uint64_t now, size_t &sent) {
+                while (true) {
+                    while (p.out_head < p.out.size()) {
+                        std::span<const Frame> rest(p.out.data() + p.out_head, p.out.size() - p.out_head);
+                        auto result = p.dst->send_batch(rest);
+                        if (result.is_ok() && result.value() > 0) {
+                            for (size_t i = 0; i < result.value(); ++i) {
+                                bump(p.frames_forwarded);
+                                add(p.bytes_forwarded, rest[i].total_size());
+                            }
+                            p.out_head += result.value();
+                            sent += result.value();
+                            continue;
+                        }
+                        if (result.is_ok() || is_refusal(result.error())) {
+                            return false;
+                        }
+                        // The destination cannot take this frame at all: drop it rather than stall the direction
+                        bump(p.send_errors);
+                        WIREBIT_DEBUG("Bridge: ", p.dst->name().c_str(), " rejected frame: ",
+                                      result.error().message.c_str());
+                        p.out_head++;
+                    }
+                    for (Frame &frame : p.out) {
+                        pool.release(frame);
+                    }
+                    p.out.clear();
+                    p.out_head = 0;
+
+                    if (!p.held.ready(now)) {
+                        return true;
+                    }
+                    while (p.out.size() < config.batch && p.held.ready(now)) {
+                        p.out.push_back(std::move(p.held.pop_ready(now).value()));
+                    }
+                }
+            }
+
+            /// Helper: Hand one view to the destination and account for it
+            inline Send send_one(BridgePath &p, const FrameView &view) {
+                auto result = p.dst->send_view(view);
+                if (result.is_ok()) {
+                    bump(p.frames_forwarded);
+                    add(p.bytes_forwarded, view.total_size());
+                    return Send::Sent;
+                }
+                if (is_refusal(result.error())) {
+                    return Send::Refused;
+                }
+                bump(p.send_errors);
+                WIREBIT_DEBUG("Bridge: ", p.dst->name().c_str(), " rejected frame: ", result.error().message.c_str());
+                return Send::Failed;
+            }
+
+            /// Helper: Record a refused send and schedule the retry
+            inline size_t stall(BridgePath &p, uint64_t now, size_t sent) {
+                bump(p.backpressure);
+                p.retry_at = now + config.retry_ns;
+                p.held_frames.store(held_count(p), std::memory_order_relaxed);
+                return sent;
+            }
+
+            static inline size_t held_count(const BridgePath &p) {
+                return p.held.size() + (p.out.size() - p.out_head) + (p.has_parked ? 1 : 0);
+            }
+
+            /// Helper: Links report a full queue or socket buffer as timeout
+            static inline bool is_refusal(const Error &error) { return error.code == Error::timeout("").code; }
+
+            /// Helper: Increment a counter that only the pumping thread writes
+            static inline void bump(std::atomic<uint64_t> &counter) { add(counter, 1); }
+
+            static inline void add(std::atomic<uint64_t> &counter, uint64_t n) {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+        };
+    } // namespace detail
+
+    /// Bidirectional forwarder between two links, e.g. a SocketCanLink or TapLink and a ShmLink
+    ///
+    /// Each turn takes up to `batch` frames from each link with recv_view() and sends them on the
+    /// other with send_view(): the frame goes from the source's receive buffer (socket buffer, ring
+    /// record) to the destination without being decoded or copied into a Frame. Frames of a type
+    /// not enabled for a direction (a_to_b_types, b_to_a_types) are dropped before they reach the
+    /// destination; frames the destination rejects outright (wrong type or size) are counted in
+    /// send_errors and dropped.
+    ///
+    /// Backpressure: when the destination reports it is full (timeout), the refused view is kept and
+    /// the source is not read again until the frame is taken, so a full ring or socket buffer stalls
+    /// the source instead of losing frames. The direction is retried after retry_ns.
+    ///
+    /// A LinkModel given to create() is applied here, once per forwarded frame: drop, duplicate and
+    /// corrupt are rolled in the bridge and the frames are held until their deliver_at_ns, then sent
+    /// in batches with send_batch(). Leave the ShmLink itself without a model, or the frames are
+    /// modelled twice. Held frames are copied into buffers of the bridge's FramePool.
+    ///
+    /// Drive the bridge with start() (own thread), attach() (a LinkReactor), or pump() from a loop
+    /// of your own. The bridge owns the receive side of both links: nothing else may recv() from
+    /// them while it runs.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto can = std::make_shared<SocketCanLink>(SocketCanLink::create({.interface_name = "vcan0"}).value());
+    /// auto shm = std::make_shared<ShmLink>(ShmLink::create("can_bus", 1 << 20).value());
+    /// auto bridge = Bridge::create(can, shm).value();
+    /// bridge.start();
+    /// @endcode
+    class Bridge {
+      public:
+        /// Create a bridge between two links
+        /// @param a First link
+        /// @param b Second link
+        /// @param config Bridge configuration
+        /// @param model Optional link model applied in both directions (nullptr = forward as received)
+        /// @return Result containing bridge, or invalid_argument (null or identical links, zero batch)
+        static Result<Bridge, Error> create(std::shared_ptr<Link> a, std::shared_ptr<Link> b,
+                                            const BridgeConfig &config = {}, const LinkModel *model = nullptr) {
+            if (!a || !b) {
+                return Result<Bridge, Error>::err(Error::invalid_argument("Null bridge link"));
+            }
+            if (a == b) {
+                return Result<Bridge, Error>::err(Error::invalid_argument("Bridge links must differ"));
+            }
+            if (config.batch == 0) {
+                return Result<Bridge, Error>::err(Error::invalid_argument("Bridge batch must be non-zero"));
+            }
+
+            auto core = std::make_unique<detail::BridgeCore>();
+            core->a = std::move(a);
+            core->b = std::move(b);
+            core->config = config;
+            core->paths[0].src = core->a.get();
+            core->paths[0].dst = core->b.get();
+            core->paths[0].types = config.a_to_b_types;
+            core->paths[1].src = core->b.get();
+            core->paths[1].dst = core->a.get();
+            core->paths[1].types = config.b_to_a_types;
+            if (model != nullptr) {
+                core->has_model = true;
+                core->model = *model;
+                core->paths[0].rng.seed(model->seed);
+                core->paths[1].rng.seed(model->seed + 1); // Independent rolls per direction
+                for (auto &path : core->paths) {
+                    path.sampler.reset(*model, path.rng);
+                }
+            }
+
+            Bridge bridge(std::move(core));
+            WIREBIT_DEBUG("Bridge created: ", bridge.name().c_str(), model != nullptr ? " (modelled)" : "");
+            return Result<Bridge, Error>::ok(std::move(bridge));
+        }
+
+        /// Destructor - stops the thread and unregisters from the reactor
+        ~Bridge() { release(); }
+
+        Bridge(Bridge &&) noexcept = default;
+
+        Bridge &operator=(Bridge &&other) noexcept {
+            if (this != &other) {
+                release();
+                core_ = std::move(other.core_);
+            }
+            return *this;
+        }
+
+        Bridge(const Bridge &) = delete;
+        Bridge &operator=(const Bridge &) = delete;
+
+        /// Give both directions one turn (when driven by your own loop)
+        /// @return Frames forwarded in this turn
+        inline size_t pump() {
+            bool more = false;
+            return core_->pump(more);
+        }
+
+        /// Give one direction a turn
+        /// @param direction Direction to forward
+        /// @return Frames forwarded in this turn
+        inline size_t pump(BridgeDirection direction) {
+            bool more = false;
+            return core_->forward(core_->paths[static_cast<size_t>(direction)], more);
+        }
+
+        /// Forward on a dedicated thread until stop()
+        /// The thread sleeps up to idle_sleep_ns when nothing moved, less when a held frame is due sooner.
+        /// @return Result indicating success, or invalid_argument if already running or attached
+        Result<Unit, Error> start() {
+            if (core_->running.load() || core_->reactor != nullptr) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Bridge already driven"));
+            }
+            core_->running.store(true, std::memory_order_release);
+            detail::BridgeCore *core = core_.get();
+            core->thread = std::thread([core]() {
+                while (core->running.load(std::memory_order_acquire)) {
+                    bool more = false;
+                    if (core->pump(more) > 0 || more) {
+                        continue;
+                    }
+                    uint64_t now = now_ns();
+                    uint64_t wake_at = std::min(now + core->config.idle_sleep_ns, core->next_deadline());
+                    if (wake_at > now) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(wake_at - now));
+                    }
+                }
+            });
+            echo::info("Bridge running: ", name().c_str()).green();
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Stop the bridge thread (held frames stay in the bridge)
+        inline void stop() {
+            if (!core_ || !core_->thread.joinable()) {
+                return;
+            }
+            core_->running.store(false, std::memory_order_release);
+            core_->thread.join();
+            WIREBIT_DEBUG("Bridge stopped: ", name().c_str());
+        }
+
+        /// Check whether the bridge thread runs
+        inline bool running() const { return core_ && core_->running.load(std::memory_order_acquire); }
+
+        /// Register both links with a reactor; each link's readiness forwards its direction
+        /// Held frames and backpressure retries wake the reactor through their deadlines.
+        /// @param reactor Reactor to drive the bridge (must outlive the registration)
+        /// @return Result indicating success, or error (already driven, link already registered)
+        Result<Unit, Error> attach(LinkReactor &reactor) {
+            if (core_->running.load() || core_->reactor != nullptr) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Bridge already driven"));
+            }
+            for (size_t i = 0; i < 2; ++i) {
+                detail::BridgeCore *core = core_.get();
+                detail::BridgePath *path = &core->paths[i];
+                auto added = reactor.add(
+                    *path->src,
+                    [core, path]() {
+                        bool more = false;
+                        core->forward(*path, more);
+                        return more;
+                    },
+                    0, [path]() { return path->next_deadline(); });
+                if (!added.is_ok()) {
+                    if (i == 1) {
+                        reactor.remove(*core->paths[0].src);
+                    }
+                    return added;
+                }
+            }
+            core_->reactor = &reactor;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Unregister both links from the reactor given to attach()
+        inline void detach() {
+            if (!core_ || core_->reactor == nullptr) {
+                return;
+            }
+            core_->reactor->remove(*core_->a);
+            core_->reactor->remove(*core_->b);
+            core_->reactor = nullptr;
+        }
+
+        /// Get the time at which a held frame becomes due or a refused frame is retried
+        /// @return Deadline in nanoseconds, or UINT64_MAX if the bridge holds nothing
+        inline uint64_t next_deadline() const { return core_->next_deadline(); }
+
+        /// Get the number of frames waiting in the bridge for one direction
+        inline size_t held(BridgeDirection direction) const {
+            return core_->paths[static_cast<size_t>(direction)].held_frames.load(std::memory_order_relaxed);
+        }
+
+        /// Get the first link
+        inline Link &a() { return *core_->a; }
+
+        /// Get the second link
+        inline Link &b() { return *core_->b; }
+
+        /// Get bridge name ("<a> <-> <b>")
+        inline String name() const { return core_->a->name() + " <-> " + core_->b->name(); }
+
+        /// Get a snapshot of the statistics of both directions
+        inline BridgeStats stats() const {
+            BridgeStats stats;
+            stats.a_to_b = core_->paths[0].snapshot();
+            stats.b_to_a = core_->paths[1].snapshot();
+            return stats;
+        }
+
+        /// Reset statistics (the held gauges are kept)
+        inline void reset_stats() {
+            core_->paths[0].reset_counters();
+            core_->paths[1].reset_counters();
+        }
+
+      private:
+        std::unique_ptr<detail::BridgeCore> core_; ///< Engine (stable address for the thread and reactor)
+
+        explicit Bridge(std::unique_ptr<detail::BridgeCore> core) : core_(std::move(core)) {}
+
+        inline void release() {
+            stop();
+            detach();
+        }
+    };
+
+} // namespace wirebit
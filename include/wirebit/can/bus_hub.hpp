@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <memory>
+#include <thread>
+#include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame_pool.hpp>
+#include <wirebit/link.hpp>
+#include <wirebit/link_reactor.hpp>
+
+namespace wirebit {
+
+    /// BusHub configuration
+    struct BusHubConfig {
+        size_t workers = 1;                   ///< Worker threads; buses are sharded across them round-robin
+        size_t batch = 32;                    ///< Frames taken from a node link per recv_batch()
+        uint64_t poll_interval_ns = 100000;   ///< Poll period for node links without a poll_fd()
+        uint64_t idle_timeout_ns = 100000000; ///< Longest wait per round (bounds how quickly stop() is noticed)
+    };
+
+    /// Statistics for one bus of a BusHub
+    struct BusHubStats {
+        uint64_t frames_received = 0;    ///< CAN frames taken from node links
+        uint64_t frames_forwarded = 0;   ///< Frames that won arbitration and went on the bus
+        uint64_t deliveries = 0;         ///< Frames handed to receiving nodes
+        uint64_t send_errors = 0;        ///< Deliveries the receiving node link refused
+        uint64_t frames_ignored = 0;     ///< Non-CAN or malformed frames discarded
+        uint64_t arbitration_losses = 0; ///< Pending frames that lost an arbitration round
+        uint64_t busy_ns = 0;            ///< Total bus time occupied by forwarded frames
+
+        inline void reset() {
+            frames_received = 0;
+            frames_forwarded = 0;
+            deliveries = 0;
+            send_errors = 0;
+            frames_ignored = 0;
+            arbitration_losses = 0;
+            busy_ns = 0;
+        }
+    };
+
+    /// Multi-node CAN bus simulator
+    ///
+    /// Each bus connects any number of node links (ShmLink, SocketCanLink, ...). Frames sent by a
+    /// node are collected into a pending set and, whenever the bus becomes idle, the one with the
+    /// lowest arbitration key (can_arbitration_key(), i.e. the lowest identifier, standard before
+    /// extended) wins and is forwarded to every other node. The winner occupies the bus for its
+    /// frame time (can_frame_time_ns()/canfd_frame_time_ns() at the bus's CanConfig bitrates);
+    /// frames that lost, and frames arriving meanwhile, contend again when it ends. Forwarded frames
+    /// carry the end of their bus slot in deliver_at_ns, so receivers with enforce_timing see them
+    /// at bus speed.
+    ///
+    /// Node links are watched with a LinkReactor: links with a poll_fd() (SocketCAN, PTY, ShmLink
+    /// after enable_wakeups()) wake the hub, the others are polled every poll_interval_ns, and the
+    /// hub sleeps until the next bus slot ends. Buses are independent, so they are sharded across
+    /// BusHubConfig::workers threads; a worker owns its buses' links outright and needs no locking.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto hub = BusHub::create({.workers = 4}).value();
+    /// size_t bus = hub.add_bus("powertrain", CanConfig{.bitrate = 500000}).value();
+    /// hub.add_node(bus, std::make_shared<ShmLink>(ShmLink::create("ecu1", 65536).value()));
+    /// hub.add_node(bus, std::make_shared<ShmLink>(ShmLink::create("ecu2", 65536).value()));
+    /// hub.start();
+    /// ...
+    /// hub.stop();
+    /// @endcode
+    class BusHub {
+      public:
+        /// Create a hub
+        /// @param config Hub configuration
+        /// @return Result containing BusHub, or error if a worker's reactor could not be created
+        static Result<BusHub, Error> create(const BusHubConfig &config = BusHubConfig{}) {
+            BusHub hub(config);
+            size_t workers = std::max<size_t>(config.workers, 1);
+            LinkReactorConfig reactor_config;
+            reactor_config.poll_interval_ns = config.poll_interval_ns;
+            for (size_t i = 0; i < workers; ++i) {
+                auto reactor = LinkReactor::create(reactor_config);
+                if (!reactor.is_ok()) {
+                    return Result<BusHub, Error>::err(reactor.error());
+                }
+                auto shard = std::make_unique<Shard>(std::move(reactor.value()));
+                shard->batch_size = std::max<size_t>(config.batch, 1);
+                shard->poll_interval_ns = config.poll_interval_ns;
+                hub.shards_.push_back(std::move(shard));
+            }
+            WIREBIT_DEBUG("BusHub created with ", workers, " workers").green();
+            return Result<BusHub, Error>::ok(std::move(hub));
+        }
+
+        /// Destructor - stops the workers
+        ~BusHub() { stop(); }
+
+        /// Move constructor (the source must not be running)
+        BusHub(BusHub &&other) noexcept
+            : config_(other.config_), shards_(std::move(other.shards_)), buses_(std::move(other.buses_)),
+              threads_(std::move(other.threads_)) {}
+
+        /// Move assignment (neither side may be running)
+        BusHub &operator=(BusHub &&other) noexcept {
+            if (this != &other) {
+                stop();
+                config_ = other.config_;
+                shards_ = std::move(other.shards_);
+                buses_ = std::move(other.buses_);
+                threads_ = std::move(other.threads_);
+            }
+            return *this;
+        }
+
+        // Disable copy
+        BusHub(const BusHub &) = delete;
+        BusHub &operator=(const BusHub &) = delete;
+
+        /// Add a bus
+        /// @param name Bus name (for logging)
+        /// @param config Bus bitrates (bitrate, data_bitrate); the other fields are unused
+        /// @return Result containing the bus ID for add_node()/stats(), or invalid_argument while running
+        Result<size_t, Error> add_bus(const String &name, const CanConfig &config = CanConfig{}) {
+            if (running_.load(std::memory_order_relaxed)) {
+                return Result<size_t, Error>::err(Error::invalid_argument("Cannot add buses while running"));
+            }
+            size_t id = buses_.size();
+            Shard &shard = *shards_[id % shards_.size()];
+            auto bus = std::make_unique<Bus>();
+            bus->name = name;
+            bus->bitrate = config.bitrate;
+            bus->data_bitrate = config.data_bitrate;
+            buses_.push_back(bus.get());
+            shard.buses.push_back(std::move(bus));
+            WIREBIT_DEBUG("BusHub: added bus ", name.c_str(), " (", config.bitrate, " bps) to worker ",
+                          id % shards_.size());
+            return Result<size_t, Error>::ok(id);
+        }
+
+        /// Attach a node link to a bus
+        /// The link is driven by the bus's worker from then on and fills received frames from that
+        /// worker's FramePool; do not use it from other threads while the hub runs.
+        /// @param bus Bus ID from add_bus()
+        /// @param link Node link
+        /// @return Result containing the node index on the bus, or invalid_argument
+        Result<size_t, Error> add_node(size_t bus, std::shared_ptr<Link> link) {
+            if (running_.load(std::memory_order_relaxed)) {
+                return Result<size_t, Error>::err(Error::invalid_argument("Cannot add nodes while running"));
+            }
+            if (bus >= buses_.size() || !link) {
+                return Result<size_t, Error>::err(Error::invalid_argument("Unknown bus or null link"));
+            }
+
+            Shard *shard = shards_[bus % shards_.size()].get();
+            Bus *b = buses_[bus];
+            size_t node = b->nodes.size();
+            auto added = shard->reactor.add(
+                *link, [shard, b, node]() { return shard->collect(*b, node); }, 1);
+            if (!added.is_ok()) {
+                return Result<size_t, Error>::err(added.error());
+            }
+            link->set_frame_pool(&shard->pool);
+            shard->polled = shard->polled || link->poll_fd() < 0;
+            b->nodes.push_back(std::move(link));
+            return Result<size_t, Error>::ok(node);
+        }
+
+        /// Start one thread per worker (shards without buses are skipped)
+        /// @return Result indicating success, or invalid_argument if already running or empty
+        Result<Unit, Error> start() {
+            if (buses_.empty()) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Hub has no buses"));
+            }
+            if (running_.exchange(true)) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Hub already running"));
+            }
+            for (auto &shard : shards_) {
+                if (shard->buses.empty()) {
+                    continue;
+                }
+                Shard *s = shard.get();
+                threads_.push_back(std::thread([this, s]() {
+                    while (running_.load(std::memory_order_relaxed)) {
+                        s->step(config_.idle_timeout_ns);
+                    }
+                }));
+            }
+            WIREBIT_DEBUG("BusHub started ", threads_.size(), " workers for ", buses_.size(), " buses").green();
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Signal the workers to stop and join them (no-op if not running)
+        void stop() {
+            if (!running_.exchange(false)) {
+                return;
+            }
+            for (auto &thread : threads_) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+            threads_.clear();
+            WIREBIT_DEBUG("BusHub stopped");
+        }
+
+        /// Drive the hub from the calling thread instead of start()
+        /// Only the first worker waits (up to timeout_ns); the others are serviced without waiting,
+        /// so this suits single-worker hubs and tests.
+        /// @param timeout_ns Maximum time to wait for input or the end of a bus slot
+        /// @return Number of frames forwarded
+        size_t run_once(uint64_t timeout_ns) {
+            size_t forwarded = 0;
+            for (size_t i = 0; i < shards_.size(); ++i) {
+                forwarded += shards_[i]->step(i == 0 ? timeout_ns : 0);
+            }
+            return forwarded;
+        }
+
+        /// Check whether worker threads are running
+        inline bool running() const { return running_.load(std::memory_order_relaxed); }
+
+        /// Get number of buses
+        inline size_t bus_count() const { return buses_.size(); }
+
+        /// Get number of nodes on a bus
+        inline size_t node_count(size_t bus) const { return bus < buses_.size() ? buses_[bus]->nodes.size() : 0; }
+
+        /// Get number of frames waiting for arbitration on a bus
+        inline size_t pending(size_t bus) const { return bus < buses_.size() ? buses_[bus]->pending.size() : 0; }
+
+        /// Get bus statistics (read while stopped or from the driving thread)
+        inline const BusHubStats &stats(size_t bus) const { return buses_[bus]->stats; }
+
+        /// Reset statistics of every bus
+        inline void reset_stats() {
+            for (Bus *bus : buses_) {
+                bus->stats.reset();
+            }
+        }
+
+      private:
+        /// Frame waiting for arbitration
+        struct Pending {
+            uint32_t key = 0;           ///< can_arbitration_key() of the frame
+            uint64_t seq = 0;           ///< Arrival order (ties between equal keys)
+            uint64_t arrived_ns = 0;    ///< When the hub took the frame from its node
+            uint64_t frame_time_ns = 0; ///< Bus time the frame occupies
+            size_t src = 0;             ///< Sending node index
+            Frame frame;                ///< Frame as received
+        };
+
+        /// One simulated bus
+        struct Bus {
+            String name;
+            uint32_t bitrate = 500000;
+            uint32_t data_bitrate = 2000000;
+            Vector<std::shared_ptr<Link>> nodes; ///< Node links (index = node)
+            Vector<Pending> pending;             ///< Min-heap on (key, seq)
+            uint64_t next_seq = 0;               ///< Next arrival sequence number
+            uint64_t free_at_ns = 0;             ///< End of the current bus slot
+            BusHubStats stats;
+        };
+
+        /// Worker state: a reactor over its buses' node links
+        struct Shard {
+            LinkReactor reactor;
+            Vector<std::unique_ptr<Bus>> buses;
+            FramePool pool;                     ///< Buffers for frames received by this worker's links
+            Vector<Frame> batch;                ///< Scratch vector for recv_batch()
+            size_t batch_size = 32;             ///< BusHubConfig::batch
+            uint64_t poll_interval_ns = 100000; ///< BusHubConfig::poll_interval_ns
+            bool polled = false;                ///< A node link has no poll_fd() and must be polled
+
+            explicit Shard(LinkReactor &&r) : reactor(std::move(r)) {}
+
+            /// Wait for input or the end of a bus slot, then run arbitration
+            size_t step(uint64_t timeout_ns) {
+                uint64_t now = now_ns();
+                uint64_t wake_at = std::min(now + timeout_ns, next_slot());
+                if (polled) {
+                    wake_at = std::min(wake_at, now + poll_interval_ns);
+                }
+                uint64_t wait = wake_at > now ? wake_at - now : 0;
+
+                // The reactor waits in whole milliseconds: sleep the sub-millisecond rest, then
+                // collect whatever arrived meanwhile without waiting
+                uint64_t coarse = (wait / 1000000) * 1000000;
+                reactor.run_once(coarse);
+                if (coarse < wait) {
+                    uint64_t t = now_ns();
+                    if (wake_at > t) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(wake_at - t));
+                    }
+                    reactor.run_once(0);
+                }
+
+                size_t forwarded = 0;
+                now = now_ns();
+                for (auto &bus : buses) {
+                    forwarded += arbitrate(*bus, now);
+                }
+                return forwarded;
+            }
+
+            /// Reactor handler: move frames from one node link into its bus's pending set
+            bool collect(Bus &bus, size_t node) {
+                batch.clear();
+                auto result = bus.nodes[node]->recv_batch(batch, batch_size);
+                if (!result.is_ok()) {
+                    return false;
+                }
+                uint64_t now = now_ns();
+                for (Frame &frame : batch) {
+                    admit(bus, node, std::move(frame), now);
+                }
+                return result.value() == batch_size;
+            }
+
+            /// Helper: Queue one received frame for arbitration
+            void admit(Bus &bus, size_t node, Frame &&frame, uint64_t now) {
+                canfd_frame cf = {};
+                if (frame.header.frame_type != static_cast<uint16_t>(FrameType::CAN) ||
+                    frame.payload.size() < sizeof(can_frame)) {
+                    bus.stats.frames_ignored++;
+                    pool.release(frame);
+                    return;
+                }
+                std::memcpy(&cf, frame.payload.data(), std::min(frame.payload.size(), sizeof(canfd_frame)));
+
+                Pending entry;
+                entry.key = can_arbitration_key(cf.can_id);
+                entry.seq = bus.next_seq++;
+                entry.arrived_ns = now;
+                if (frame.payload.size() >= sizeof(canfd_frame) && (cf.flags & CANFD_FDF)) {
+                    entry.frame_time_ns = canfd_frame_time_ns(cf, bus.bitrate, bus.data_bitrate);
+                } else {
+                    can_frame classic;
+                    std::memcpy(&classic, &cf, sizeof(classic));
+                    entry.frame_time_ns = can_frame_time_ns(classic, bus.bitrate);
+                }
+                entry.src = node;
+                entry.frame = std::move(frame);
+                bus.pending.push_back(std::move(entry));
+                std::push_heap(bus.pending.begin(), bus.pending.end(), lower_priority);
+                bus.stats.frames_received++;
+            }
+
+            /// Helper: Hand the bus to the highest-priority pending frames while it is idle
+            size_t arbitrate(Bus &bus, uint64_t now) {
+                size_t forwarded = 0;
+                while (!bus.pending.empty() && bus.free_at_ns <= now) {
+                    std::pop_heap(bus.pending.begin(), bus.pending.end(), lower_priority);
+                    Pending winner = std::move(bus.pending.back());
+                    bus.pending.pop_back();
+                    bus.stats.arbitration_losses += bus.pending.size();
+
+                    uint64_t start = std::max(bus.free_at_ns, winner.arrived_ns);
+                    bus.free_at_ns = start + winner.frame_time_ns;
+                    bus.stats.busy_ns += winner.frame_time_ns;
+                    bus.stats.frames_forwarded++;
+
+                    FrameView view = make_view(winner.frame);
+                    view.header.deliver_at_ns = bus.free_at_ns;
+                    for (size_t node = 0; node < bus.nodes.size(); ++node) {
+                        if (node == winner.src) {
+                            continue;
+                        }
+                        if (bus.nodes[node]->send_view(view).is_ok()) {
+                            bus.stats.deliveries++;
+                        } else {
+                            bus.stats.send_errors++;
+                        }
+                    }
+                    WIREBIT_TRACE("BusHub ", bus.name.c_str(), ": node ", winner.src, " won arbitration (key 0x",
+                                  std::hex, winner.key, std::dec, ")");
+                    pool.release(winner.frame);
+                    ++forwarded;
+                }
+                return forwarded;
+            }
+
+            /// Helper: Earliest end of a bus slot that has frames waiting behind it
+            uint64_t next_slot() const {
+                uint64_t deadline = UINT64_MAX;
+                for (const auto &bus : buses) {
+                    if (!bus->pending.empty()) {
+                        deadline = std::min(deadline, bus->free_at_ns);
+                    }
+                }
+                return deadline;
+            }
+
+            /// Heap order: higher key, then later arrival, is lower priority
+            static bool lower_priority(const Pending &a, const Pending &b) {
+                return a.key != b.key ? a.key > b.key : a.seq > b.seq;
+            }
+        };
+
+        BusHubConfig config_;
+        Vector<std::unique_ptr<Shard>> shards_;
+        Vector<Bus *> buses_; ///< Buses by ID (owned by their shard)
+        Vector<std::thread> threads_;
+        std::atomic<bool> running_{false};
+
+        explicit BusHub(const BusHubConfig &config) : config_(config) {}
+    };
+
+} // namespace wirebit
@@ -1,15 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <echo/echo.hpp>
 #include <iomanip>
 #include <memory>
-#include <sstream>
+#include <unordered_set>
+#include <wirebit/can/can_signals.hpp>
+#include <wirebit/common/crc.hpp>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
+#include <wirebit/delay_line.hpp>
 #include <wirebit/endpoint.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/rx_queue.hpp>
+#include <wirebit/typed_frame.hpp>
 
 #ifndef NO_HARDWARE
 // Use actual Linux SocketCAN headers when hardware support is enabled
@@ -26,13 +34,38 @@ struct can_frame {
     uint8_t data[8]; ///< CAN data bytes
 } __attribute__((packed));
 
+// Matches the layout of struct canfd_frame from <linux/can.h>
+struct canfd_frame {
+    uint32_t can_id;  ///< CAN ID + EFF/RTR/ERR flags
+    uint8_t len;      ///< Payload length (0-8, 12, 16, 20, 24, 32, 48, 64)
+    uint8_t flags;    ///< CANFD_BRS/CANFD_ESI/CANFD_FDF
+    uint8_t __res0;   ///< Reserved
+    uint8_t __res1;   ///< Reserved
+    uint8_t data[64]; ///< CAN FD data bytes
+} __attribute__((packed));
+
+// Matches struct can_filter from <linux/can.h>
+struct can_filter {
+    uint32_t can_id;   ///< ID (+ flags) to match; CAN_INV_FILTER inverts the match
+    uint32_t can_mask; ///< Bits of the received ID (+ flags) that must equal can_id
+};
+
 // CAN ID flags (compatible with Linux SocketCAN)
 // Using inline constexpr when NO_HARDWARE is defined
-inline constexpr uint32_t CAN_EFF_FLAG = 0x80000000U; ///< Extended frame format (29-bit ID)
-inline constexpr uint32_t CAN_RTR_FLAG = 0x40000000U; ///< Remote transmission request
-inline constexpr uint32_t CAN_ERR_FLAG = 0x20000000U; ///< Error frame
-inline constexpr uint32_t CAN_SFF_MASK = 0x000007FFU; ///< Standard frame format mask (11-bit)
-inline constexpr uint32_t CAN_EFF_MASK = 0x1FFFFFFFU; ///< Extended frame format mask (29-bit)
+inline constexpr uint32_t CAN_EFF_FLAG = 0x80000000U;   ///< Extended frame format (29-bit ID)
+inline constexpr uint32_t CAN_RTR_FLAG = 0x40000000U;   ///< Remote transmission request
+inline constexpr uint32_t CAN_ERR_FLAG = 0x20000000U;   ///< Error frame
+inline constexpr uint32_t CAN_SFF_MASK = 0x000007FFU;   ///< Standard frame format mask (11-bit)
+inline constexpr uint32_t CAN_EFF_MASK = 0x1FFFFFFFU;   ///< Extended frame format mask (29-bit)
+inline constexpr uint8_t CANFD_BRS = 0x01;              ///< Bit rate switch (data phase at data bitrate)
+inline constexpr uint8_t CANFD_ESI = 0x02;              ///< Error state indicator
+inline constexpr uint8_t CANFD_FDF = 0x04;              ///< Marks a CAN FD frame in struct canfd_frame
+inline constexpr size_t CANFD_MAX_DLEN = 64;            ///< Maximum CAN FD payload
+inline constexpr uint32_t CAN_INV_FILTER = 0x20000000U; ///< can_filter flag: accept non-matching IDs
+#endif
+
+#ifndef CANFD_FDF
+#define CANFD_FDF 0x04 // Older uapi headers predate the FD frame marker
 #endif
 
 namespace wirebit {
@@ -47,12 +80,244 @@ namespace wirebit {
     inline constexpr uint32_t CAN_SFF_MASK_V = CAN_SFF_MASK;
     inline constexpr uint32_t CAN_EFF_MASK_V = CAN_EFF_MASK;
 
+    // Import canfd_frame into wirebit namespace for convenience
+    using ::canfd_frame;
+
+    /// Classic CAN frame carried inline (no heap payload)
+    using CanTypedFrame = TypedFrame<FrameType::CAN, sizeof(can_frame)>;
+
+    /// CAN FD frame carried inline (no heap payload)
+    using CanFdTypedFrame = TypedFrame<FrameType::CAN, sizeof(canfd_frame)>;
+
+    /// Check if a length is a valid CAN FD payload length (0-8, 12, 16, 20, 24, 32, 48, 64)
+    inline constexpr bool canfd_valid_len(uint8_t len) {
+        return len <= 8 || len == 12 || len == 16 || len == 20 || len == 24 || len == 32 || len == 48 || len == 64;
+    }
+
+    /// Compute the CRC-15 a controller sends for a classic CAN frame
+    /// Covers the unstuffed bits from SOF through the data field: SOF, ID, RTR, IDE, r0 and DLC
+    /// (standard), or SOF, base ID, SRR, IDE, extended ID, RTR, r1, r0 and DLC (extended),
+    /// followed by the data bytes (none for remote frames).
+    /// @param cf CAN frame
+    /// @return 15-bit CRC sequence
+    inline uint16_t can_crc15(const can_frame &cf) {
+        bool rtr = (cf.can_id & CAN_RTR_FLAG) != 0;
+        uint64_t dlc = std::min<uint8_t>(cf.can_dlc, 15);
+        uint16_t crc = 0;
+        if (cf.can_id & CAN_EFF_FLAG) {
+            uint64_t id = cf.can_id & CAN_EFF_MASK;
+            // SOF(0) base(11) SRR(1) IDE(1) ext(18) RTR r1(0) r0(0) DLC(4)
+            uint64_t bits = ((id >> 18) << 27) | (1ULL << 26) | (1ULL << 25) | ((id & 0x3FFFF) << 7) |
+                            (uint64_t(rtr) << 6) | dlc;
+            crc = can_crc15_update(crc, bits, 39);
+        } else {
+            // SOF(0) ID(11) RTR IDE(0) r0(0) DLC(4)
+            uint64_t bits = (uint64_t(cf.can_id & CAN_SFF_MASK) << 7) | (uint64_t(rtr) << 6) | dlc;
+            crc = can_crc15_update(crc, bits, 19);
+        }
+        if (!rtr) {
+            for (uint8_t i = 0; i < std::min<uint8_t>(cf.can_dlc, 8); ++i) {
+                crc = can_crc15_update(crc, cf.data[i], 8);
+            }
+        }
+        return crc;
+    }
+
+    /// Time a classic CAN frame occupies the bus at the nominal bitrate
+    /// Overhead: SOF(1) + ID(11/29) + RTR(1) + IDE(1) + r0(1) + DLC(4) + CRC(15) + ACK(2) + EOF(7) + IFS(3),
+    /// i.e. ~47 bits (standard) or ~67 bits (extended), plus 20% worst-case bit stuffing.
+    /// @param cf CAN frame
+    /// @param bitrate Nominal bitrate in bps
+    /// @return Frame time in nanoseconds
+    inline uint64_t can_frame_time_ns(const can_frame &cf, uint32_t bitrate) {
+        uint32_t overhead_bits = (cf.can_id & CAN_EFF_FLAG) ? 67 : 47;
+        uint32_t total_bits = overhead_bits + cf.can_dlc * 8;
+        total_bits = total_bits + (total_bits / 5);
+        return (total_bits * 1000000000ULL) / bitrate;
+    }
+
+    /// Time a CAN FD frame occupies the bus
+    /// The arbitration phase (SOF, ID, RRS/IDE, FDF, res, BRS) and the tail (ACK, EOF, IFS) run at the
+    /// nominal bitrate. The data phase (ESI, DLC, data, stuff count, CRC17/21, CRC delimiter) runs at
+    /// data_bitrate when CANFD_BRS is set, otherwise at the nominal bitrate.
+    /// @param cf CAN FD frame
+    /// @param bitrate Nominal bitrate in bps
+    /// @param data_bitrate Data phase bitrate in bps
+    /// @return Frame time in nanoseconds
+    inline uint64_t canfd_frame_time_ns(const canfd_frame &cf, uint32_t bitrate, uint32_t data_bitrate) {
+        uint64_t arb_bits = (cf.can_id & CAN_EFF_FLAG) ? 36 : 17;
+        arb_bits = arb_bits + (arb_bits / 5);
+        uint64_t tail_bits = 2 + 7 + 3;
+        uint64_t data_bits = 1 + 4 + cf.len * 8 + 4 + (cf.len <= 16 ? 17 : 21) + 1;
+        data_bits = data_bits + (data_bits / 5);
+
+        uint32_t data_rate = (cf.flags & CANFD_BRS) ? data_bitrate : bitrate;
+        return ((arb_bits + tail_bits) * 1000000000ULL) / bitrate + (data_bits * 1000000000ULL) / data_rate;
+    }
+
+    /// Arbitration priority of a CAN identifier (lower wins the bus)
+    /// Orders the arbitration field as it appears on the wire, where a dominant 0 beats a recessive 1:
+    /// base ID(11), RTR (standard) or SRR (extended, always 1), IDE, extended ID(18), RTR (extended).
+    /// A standard frame therefore wins against an extended frame with the same base ID, and a data
+    /// frame against a remote frame with the same ID.
+    /// @param can_id Identifier with CAN_EFF_FLAG/CAN_RTR_FLAG
+    /// @return 32-bit arbitration key
+    inline constexpr uint32_t can_arbitration_key(uint32_t can_id) {
+        uint32_t rtr = (can_id & CAN_RTR_FLAG) ? 1 : 0;
+        if (can_id & CAN_EFF_FLAG) {
+            uint32_t id = can_id & CAN_EFF_MASK;
+            return ((id >> 18) << 21) | (1u << 20) | (1u << 19) | ((id & 0x3FFFF) << 1) | rtr;
+        }
+        return ((can_id & CAN_SFF_MASK) << 21) | (rtr << 20);
+    }
+
+    using ::can_filter;
+
+    /// Acceptance filter with SocketCAN (CAN_RAW_FILTER) semantics and O(1) lookup for standard IDs
+    ///
+    /// A frame is accepted if any filter matches: (frame_id & can_mask) == (can_id & can_mask), where
+    /// frame_id includes CAN_EFF_FLAG/CAN_RTR_FLAG, and CAN_INV_FILTER in can_id inverts the test.
+    /// An empty filter list accepts everything; error frames always pass.
+    ///
+    /// The filters are compiled once: every standard ID (data and RTR) is evaluated into a 4096-bit
+    /// bitmap. Extended filters that name one ID go into a hash set, prefix masks into a range table,
+    /// and only the remaining (inverted or non-prefix) masks are evaluated per frame.
+    class CanAcceptanceFilter {
+      public:
+        CanAcceptanceFilter() = default;
+
+        /// Compile a filter list
+        /// @param filters SocketCAN-style filters (the same list SocketCanConfig::filters takes)
+        inline explicit CanAcceptanceFilter(const Vector<can_filter> &filters) : accept_all_(filters.empty()) {
+            if (accept_all_) {
+                return;
+            }
+            for (uint32_t i = 0; i < 2 * SFF_IDS; ++i) {
+                uint32_t id = (i & CAN_SFF_MASK) | (i >= SFF_IDS ? CAN_RTR_FLAG : 0);
+                for (const can_filter &f : filters) {
+                    if (matches(f, id)) {
+                        sff_bits_[i / 64] |= 1ULL << (i % 64);
+                        break;
+                    }
+                }
+            }
+            for (const can_filter &f : filters) {
+                add_extended(f);
+            }
+            std::sort(ranges_.begin(), ranges_.end(), [](const Range &a, const Range &b) { return a.lo < b.lo; });
+        }
+
+        /// Check if a frame ID passes the filter
+        /// @param can_id Received ID including CAN_EFF_FLAG/CAN_RTR_FLAG/CAN_ERR_FLAG
+        /// @return true if the frame should be buffered
+        inline bool accept(uint32_t can_id) const {
+            if (accept_all_ || (can_id & CAN_ERR_FLAG)) {
+                return true;
+            }
+            bool rtr = (can_id & CAN_RTR_FLAG) != 0;
+            if (!(can_id & CAN_EFF_FLAG)) {
+                uint32_t i = (can_id & CAN_SFF_MASK) | (rtr ? SFF_IDS : 0);
+                return (sff_bits_[i / 64] >> (i % 64)) & 1;
+            }
+
+            uint32_t eid = can_id & CAN_EFF_MASK;
+            if (exact_.count(eid | (rtr ? CAN_RTR_FLAG : 0))) {
+                return true;
+            }
+            for (const Range &r : ranges_) {
+                if (r.lo > eid) {
+                    break;
+                }
+                if (eid <= r.hi && rtr_ok(r.rtr, rtr)) {
+                    return true;
+                }
+            }
+            for (const can_filter &f : generic_) {
+                if (matches(f, can_id)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Check if the filter accepts everything (no filters configured)
+        inline bool accepts_all() const { return accept_all_; }
+
+        /// Evaluate one filter on a frame ID, exactly as the kernel does
+        /// @param f Filter
+        /// @param can_id Received ID including flags
+        /// @return true if the filter matches
+        static inline bool matches(const can_filter &f, uint32_t can_id) {
+            bool hit = (can_id & f.can_mask) == (f.can_id & ~CAN_INV_FILTER & f.can_mask);
+            return (f.can_id & CAN_INV_FILTER) ? !hit : hit;
+        }
+
+      private:
+        static constexpr uint32_t SFF_IDS = CAN_SFF_MASK + 1;
+
+        /// RTR requirement of a compiled extended filter
+        enum class Rtr : uint8_t { Any, DataOnly, RtrOnly };
+
+        /// Contiguous extended ID range [lo, hi] from a prefix mask
+        struct Range {
+            uint32_t lo; ///< First matching ID
+            uint32_t hi; ///< Last matching ID
+            Rtr rtr;     ///< RTR requirement
+        };
+
+        bool accept_all_ = true;
+        std::array<uint64_t, 2 * SFF_IDS / 64> sff_bits_{}; ///< [0, 2048) data frames, [2048, 4096) RTR
+        std::unordered_set<uint32_t> exact_;                ///< Extended ID (| CAN_RTR_FLAG for RTR frames)
+        Vector<Range> ranges_;                              ///< Prefix-mask filters, sorted by lo
+        Vector<can_filter> generic_;                        ///< Filters evaluated per frame
+
+        static inline bool rtr_ok(Rtr want, bool rtr) {
+            return want == Rtr::Any || (want == Rtr::RtrOnly) == rtr;
+        }
+
+        /// Helper: File a filter into the extended-ID tables
+        inline void add_extended(const can_filter &f) {
+            if (f.can_id & CAN_INV_FILTER) {
+                generic_.push_back(f);
+                return;
+            }
+            if ((f.can_mask & CAN_EFF_FLAG) && !(f.can_id & CAN_EFF_FLAG)) {
+                return; // Standard frames only
+            }
+            Rtr rtr = Rtr::Any;
+            if (f.can_mask & CAN_RTR_FLAG) {
+                rtr = (f.can_id & CAN_RTR_FLAG) ? Rtr::RtrOnly : Rtr::DataOnly;
+            }
+
+            uint32_t mask = f.can_mask & CAN_EFF_MASK;
+            uint32_t id = f.can_id & mask;
+            if (mask == CAN_EFF_MASK) {
+                if (rtr != Rtr::RtrOnly) {
+                    exact_.insert(id);
+                }
+                if (rtr != Rtr::DataOnly) {
+                    exact_.insert(id | CAN_RTR_FLAG);
+                }
+                return;
+            }
+            uint32_t span = ~mask & CAN_EFF_MASK;
+            if ((span & (span + 1)) == 0) {
+                ranges_.push_back(Range{id, id | span, rtr});
+                return;
+            }
+            generic_.push_back(f);
+        }
+    };
+
     /// CAN bus configuration
     struct CanConfig {
-        uint32_t bitrate = 500000;   ///< CAN bitrate in bits/second (default: 500 kbps)
-        bool loopback = false;       ///< Enable loopback mode
-        bool listen_only = false;    ///< Enable listen-only mode
-        size_t rx_buffer_size = 100; ///< Receive buffer size (number of frames)
+        uint32_t bitrate = 500000;       ///< CAN bitrate in bits/second (default: 500 kbps)
+        bool loopback = false;           ///< Enable loopback mode
+        bool listen_only = false;        ///< Enable listen-only mode
+        size_t rx_buffer_size = 100;     ///< Receive buffer size (number of frames)
+        bool enforce_timing = false;     ///< Hold received frames until their deliver_at_ns
+        uint32_t data_bitrate = 2000000; ///< CAN FD data-phase bitrate for BRS frames (default: 2 Mbps)
+        Vector<can_filter> filters = {}; ///< Acceptance filters (SocketCAN semantics); empty = accept all
     };
 
     /// CAN endpoint for CAN bus communication
@@ -64,8 +329,9 @@ namespace wirebit {
         /// @param config CAN bus configuration
         /// @param endpoint_id Unique endpoint identifier
         inline CanEndpoint(std::shared_ptr<Link> link, const CanConfig &config, uint32_t endpoint_id)
-            : link_(link), config_(config), endpoint_id_(endpoint_id) {
-            echo::trace("CanEndpoint created: id=", endpoint_id_, " bitrate=", config_.bitrate, " bps");
+            : link_(link), config_(config), rx_buffer_(config.rx_buffer_size), filter_(config.filters),
+              endpoint_id_(endpoint_id) {
+            WIREBIT_TRACE("CanEndpoint created: id=", endpoint_id_, " bitrate=", config_.bitrate, " bps");
         }
 
         /// Send a CAN frame
@@ -79,91 +345,106 @@ namespace wirebit {
             }
 
             // Log CAN frame details
-            echo::trace("CAN send: ID=0x", std::hex, std::setfill('0'), std::setw(cf.can_id & CAN_EFF_FLAG ? 8 : 3),
-                        (cf.can_id & CAN_EFF_MASK), std::dec, " DLC=", (int)cf.can_dlc);
+            WIREBIT_TRACE("CAN send: ID=0x", std::hex, std::setfill('0'), std::setw(cf.can_id & CAN_EFF_FLAG ? 8 : 3),
+                          (cf.can_id & CAN_EFF_MASK), std::dec, " DLC=", (int)cf.can_dlc);
 
             // Log data bytes
             if (cf.can_dlc > 0) {
-                std::stringstream ss;
-                ss << "CAN data: ";
-                for (int i = 0; i < cf.can_dlc; ++i) {
-                    ss << std::hex << std::setfill('0') << std::setw(2) << (int)cf.data[i];
-                    if (i < cf.can_dlc - 1)
-                        ss << " ";
-                }
-                echo::debug(ss.str().c_str());
+                WIREBIT_DEBUG("CAN data: ", HexFormat{std::span<const Byte>(cf.data, cf.can_dlc)});
             }
 
-            // Serialize CAN frame to payload
-            Bytes payload(sizeof(can_frame));
-            std::memcpy(payload.data(), &cf, sizeof(can_frame));
-
-            // Create wirebit frame
-            Frame frame = make_frame(FrameType::CAN, payload, endpoint_id_, 0); // 0 = broadcast
-
-            // Calculate transmission time based on bitrate
-            // CAN frame overhead: SOF(1) + ID(11/29) + RTR(1) + IDE(1) + r0(1) + DLC(4) + CRC(15) + ACK(2) + EOF(7) +
-            // IFS(3) Standard frame: ~47 bits overhead + data bits Extended frame: ~67 bits overhead + data bits
-            uint32_t overhead_bits = (cf.can_id & CAN_EFF_FLAG) ? 67 : 47;
-            uint32_t data_bits = cf.can_dlc * 8;
-            uint32_t total_bits = overhead_bits + data_bits;
-
-            // Add bit stuffing overhead (worst case: 20% more bits)
-            total_bits = total_bits + (total_bits / 5);
-
-            uint64_t frame_time_ns = (total_bits * 1000000000ULL) / config_.bitrate;
-
-            echo::debug("CAN frame time: ", frame_time_ns, "ns (", total_bits, " bits at ", config_.bitrate, " bps)");
-
-            // Set delivery time for bandwidth shaping
-            uint64_t now = now_ns();
-            last_tx_deliver_at_ns_ = std::max(now, last_tx_deliver_at_ns_) + frame_time_ns;
-            frame.header.deliver_at_ns = last_tx_deliver_at_ns_;
+            // The frame travels inline and goes to the link as a view (no allocation)
+            CanTypedFrame frame = CanTypedFrame::of(cf, endpoint_id_); // dst 0 = broadcast
+            return transmit(frame, frame_time_ns(cf));
+        }
 
-            // Send frame through link
-            auto result = link_->send(frame);
-            if (!result.is_ok()) {
-                echo::error("CAN send failed: ", result.error().message.c_str()).red();
-                return result;
+        /// Send a CAN FD frame
+        /// Frames with CANFD_BRS are paced with the data phase at CanConfig::data_bitrate.
+        /// @param cf CAN FD frame to send
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send_canfd(const canfd_frame &cf) {
+            if (!canfd_valid_len(cf.len)) {
+                echo::error("Invalid CAN FD length: ", (int)cf.len, " (0-8, 12, 16, 20, 24, 32, 48, 64)").red();
+                return Result<Unit, Error>::err(Error::invalid_argument("Invalid CAN FD payload length"));
             }
 
-            echo::trace("CAN frame sent successfully");
-            return Result<Unit, Error>::ok(Unit{});
+            WIREBIT_TRACE("CAN FD send: ID=0x", std::hex, (cf.can_id & CAN_EFF_MASK), std::dec, " len=", (int)cf.len,
+                          (cf.flags & CANFD_BRS) ? " BRS" : "");
+
+            canfd_frame out = cf;
+            out.flags |= CANFD_FDF;
+            CanFdTypedFrame frame = CanFdTypedFrame::of(out, endpoint_id_);
+            return transmit(frame, frame_time_ns(out));
         }
 
         /// Receive a CAN frame (non-blocking)
         /// @param cf Output CAN frame
         /// @return Result indicating success or error
+        /// CAN FD frames cannot be represented as can_frame; they are dropped (use recv_canfd()).
         inline Result<Unit, Error> recv_can(can_frame &cf) {
-            echo::trace("CanEndpoint::recv_can called");
+            WIREBIT_TRACE("CanEndpoint::recv_can called");
 
             // Process incoming frames first
             auto process_result = process();
             if (!process_result.is_ok()) {
-                echo::trace("Process returned: ", process_result.error().message.c_str());
+                WIREBIT_TRACE("Process returned: ", process_result.error().message.c_str());
             }
 
             // Return buffered frame if available
-            if (!rx_buffer_.empty()) {
-                cf = rx_buffer_[0];
-                rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + 1);
+            while (!rx_buffer_.empty()) {
+                canfd_frame fd = rx_buffer_.front();
+                rx_buffer_.pop();
+                if (fd.flags & CANFD_FDF) {
+                    echo::warn("CAN FD frame ID=0x", std::hex, (fd.can_id & CAN_EFF_MASK), std::dec,
+                               " dropped by recv_can(), use recv_canfd()");
+                    continue;
+                }
 
-                echo::debug("CAN recv: ID=0x", std::hex, (cf.can_id & CAN_EFF_MASK), std::dec, " DLC=", (int)cf.can_dlc,
-                            " (", rx_buffer_.size(), " frames remaining)");
+                cf = {};
+                cf.can_id = fd.can_id;
+                cf.can_dlc = fd.len;
+                std::memcpy(cf.data, fd.data, sizeof(cf.data));
+
+                WIREBIT_DEBUG("CAN recv: ID=0x", std::hex, (cf.can_id & CAN_EFF_MASK), std::dec, " DLC=",
+                              (int)cf.can_dlc, " (", rx_buffer_.size(), " frames remaining)");
                 return Result<Unit, Error>::ok(Unit{});
             }
 
             // No frames available
-            echo::trace("CAN recv: no frames available");
+            WIREBIT_TRACE("CAN recv: no frames available");
             return Result<Unit, Error>::err(Error::timeout("No CAN frames available"));
         }
 
+        /// Receive a CAN or CAN FD frame (non-blocking)
+        /// Classic frames are returned with flags == 0; CAN FD frames have CANFD_FDF set.
+        /// @param cf Output CAN FD frame
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> recv_canfd(canfd_frame &cf) {
+            process();
+            if (rx_buffer_.empty()) {
+                return Result<Unit, Error>::err(Error::timeout("No CAN frames available"));
+            }
+
+            cf = rx_buffer_.front();
+            rx_buffer_.pop();
+            WIREBIT_DEBUG("CAN recv: ID=0x", std::hex, (cf.can_id & CAN_EFF_MASK), std::dec, " len=", (int)cf.len,
+                          (cf.flags & CANFD_FDF) ? " FD" : "", " (", rx_buffer_.size(), " frames remaining)");
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
         /// Send data through the endpoint (Endpoint interface)
-        /// @param data Serialized CAN frame
+        /// @param data Serialized can_frame or canfd_frame
         /// @return Result indicating success or error
         inline Result<Unit, Error> send(const Bytes &data) override {
+            if (data.size() == sizeof(canfd_frame)) {
+                canfd_frame cf;
+                std::memcpy(&cf, data.data(), sizeof(canfd_frame));
+                return send_canfd(cf);
+            }
             if (data.size() != sizeof(can_frame)) {
-                echo::error("Invalid CAN frame size: ", data.size(), " (expected ", sizeof(can_frame), ")").red();
+                echo::error("Invalid CAN frame size: ", data.size(), " (expected ", sizeof(can_frame), " or ",
+                            sizeof(canfd_frame), ")")
+                    .red();
                 return Result<Unit, Error>::err(Error::invalid_argument("Invalid CAN frame size"));
             }
 
@@ -173,66 +454,93 @@ namespace wirebit {
         }
 
         /// Receive data from the endpoint (Endpoint interface)
-        /// @return Result containing serialized CAN frame or error
+        /// @return Result containing a serialized can_frame (classic) or canfd_frame (CAN FD), or error
         inline Result<Bytes, Error> recv() override {
-            can_frame cf;
-            auto result = recv_can(cf);
+            canfd_frame cf;
+            auto result = recv_canfd(cf);
             if (!result.is_ok()) {
                 return Result<Bytes, Error>::err(result.error());
             }
 
-            Bytes data(sizeof(can_frame));
-            std::memcpy(data.data(), &cf, sizeof(can_frame));
+            size_t size = (cf.flags & CANFD_FDF) ? sizeof(canfd_frame) : sizeof(can_frame);
+            Bytes data(size);
+            std::memcpy(data.data(), &cf, size);
             return Result<Bytes, Error>::ok(std::move(data));
         }
 
         /// Process incoming frames from the link
         /// @return Result indicating success or error
         inline Result<Unit, Error> process() override {
-            echo::trace("CanEndpoint::process");
-
-            // Try to receive frames from the link
-            while (rx_buffer_.size() < config_.rx_buffer_size) {
-                auto frame_result = link_->recv();
-                if (!frame_result.is_ok()) {
+            WIREBIT_TRACE("CanEndpoint::process");
+
+            // Try to receive frames from the link, a batch at a time
+            while (rx_buffer_.size() + rx_delay_.size() < config_.rx_buffer_size) {
+                rx_batch_.clear();
+                size_t room = config_.rx_buffer_size - rx_buffer_.size() - rx_delay_.size();
+                auto batch_result = link_->recv_batch(rx_batch_, room);
+                if (!batch_result.is_ok()) {
                     // No more frames available
-                    if (rx_buffer_.empty()) {
-                        return Result<Unit, Error>::err(Error::timeout("No frames available"));
-                    }
-                    return Result<Unit, Error>::ok(Unit{});
+                    break;
                 }
 
-                Frame frame = std::move(frame_result.value());
+                for (const Frame &frame : rx_batch_) {
+                    record_rx(frame.header);
 
-                // Verify frame type
-                if (frame.type() != FrameType::CAN) {
-                    echo::warn("Received non-CAN frame, ignoring");
-                    continue;
-                }
+                    // Verify frame type
+                    if (frame.type() != FrameType::CAN) {
+                        echo::warn("Received non-CAN frame, ignoring");
+                        continue;
+                    }
 
-                // Verify payload size
-                if (frame.payload.size() != sizeof(can_frame)) {
-                    echo::warn("Invalid CAN frame payload size: ", frame.payload.size());
-                    continue;
+                    // Drop unwanted IDs before copying the frame (can_id leads both frame layouts)
+                    uint32_t can_id;
+                    if (frame.payload.size() < sizeof(can_id)) {
+                        echo::warn("Invalid CAN frame payload size: ", frame.payload.size());
+                        continue;
+                    }
+                    std::memcpy(&can_id, frame.payload.data(), sizeof(can_id));
+                    if (!filter_.accept(can_id)) {
+                        rx_filtered_++;
+                        continue;
+                    }
+
+                    // Deserialize CAN frame (classic frames are widened, flags == 0)
+                    canfd_frame cf = {};
+                    if (frame.payload.size() == sizeof(canfd_frame)) {
+                        std::memcpy(&cf, frame.payload.data(), sizeof(canfd_frame));
+                        cf.flags |= CANFD_FDF;
+                    } else if (frame.payload.size() == sizeof(can_frame)) {
+                        std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+                        cf.flags = 0;
+                    } else {
+                        echo::warn("Invalid CAN frame payload size: ", frame.payload.size());
+                        continue;
+                    }
+
+                    // Enforce delivery timing: hold the frame until it is due
+                    if (config_.enforce_timing) {
+                        rx_delay_.push(frame.header.deliver_at_ns, cf);
+                        continue;
+                    }
+
+                    // Add to receive buffer
+                    deliver(cf);
                 }
 
-                // Enforce delivery timing
-                uint64_t now = now_ns();
-                if (frame.header.deliver_at_ns > 0 && now < frame.header.deliver_at_ns) {
-                    uint64_t delay_ns = frame.header.deliver_at_ns - now;
-                    echo::trace("Delaying CAN frame delivery by ", delay_ns, "ns");
+                // The frames were copied out; hand pooled buffers back (see Link::set_frame_pool())
+                if (FramePool *pool = link_->frame_pool()) {
+                    for (Frame &frame : rx_batch_) {
+                        pool->release(frame);
+                    }
                 }
+            }
 
-                // Deserialize CAN frame
-                can_frame cf;
-                std::memcpy(&cf, frame.payload.data(), sizeof(can_frame));
+            // Release held frames that are due
+            rx_delay_.drain_ready(now_ns(), [this](canfd_frame &&cf) { deliver(cf); });
 
-                // Add to receive buffer
-                rx_buffer_.push_back(cf);
-                echo::trace("CAN frame buffered: ID=0x", std::hex, (cf.can_id & CAN_EFF_MASK), std::dec,
-                            " (buffer size: ", rx_buffer_.size(), ")");
+            if (rx_buffer_.empty()) {
+                return Result<Unit, Error>::err(Error::timeout("No frames available"));
             }
-
             return Result<Unit, Error>::ok(Unit{});
         }
 
@@ -260,10 +568,47 @@ namespace wirebit {
         /// @return Number of buffered frames
         inline size_t rx_buffer_size() const { return rx_buffer_.size(); }
 
-        /// Clear receive buffer
+        /// Get number of received frames rejected by the acceptance filter
+        /// @return Number of filtered frames
+        inline uint64_t filtered_count() const { return rx_filtered_; }
+
+        /// Get the compiled acceptance filter
+        /// @return Acceptance filter
+        inline const CanAcceptanceFilter &filter() const { return filter_; }
+
+        /// Get number of received frames held until their delivery time (enforce_timing)
+        /// @return Number of held frames
+        inline size_t delayed_count() const { return rx_delay_.size(); }
+
+        /// Get delivery time of the earliest held frame
+        /// @return Deadline in nanoseconds, or DelayLine<canfd_frame>::NO_DEADLINE if nothing is held
+        inline uint64_t next_deadline() const override { return rx_delay_.next_deadline(); }
+
+        /// Decode received frames into a signal cache
+        /// Every accepted frame is decoded as it enters the receive buffer (after enforce_timing holds it),
+        /// updating signals() with the latest physical values.
+        /// @param db Compiled signal database (nullptr = stop decoding)
+        /// @param buffer_decoded Also buffer frames that carry signals; false keeps only other IDs for
+        ///                       recv_can()/recv_canfd(), so reading signals needs just process()
+        inline void set_signal_db(std::shared_ptr<const CanSignalDb> db, bool buffer_decoded = true) {
+            signal_db_ = std::move(db);
+            signal_cache_ = CanSignalCache(signal_db_ ? signal_db_->size() : 0);
+            buffer_decoded_ = buffer_decoded;
+        }
+
+        /// Get the signal database set with set_signal_db()
+        /// @return Signal database, or nullptr
+        inline const CanSignalDb *signal_db() const { return signal_db_.get(); }
+
+        /// Get the latest decoded signal values (indexed like signal_db())
+        /// @return Signal cache
+        inline const CanSignalCache &signals() const { return signal_cache_; }
+
+        /// Clear receive buffer (including frames held for delayed delivery)
         inline void clear_rx_buffer() {
-            echo::debug("Clearing CAN RX buffer: ", rx_buffer_.size(), " frames discarded");
+            WIREBIT_DEBUG("Clearing CAN RX buffer: ", rx_buffer_.size() + rx_delay_.size(), " frames discarded");
             rx_buffer_.clear();
+            rx_delay_.clear();
         }
 
         /// Create a standard CAN frame (11-bit ID)
@@ -311,12 +656,88 @@ namespace wirebit {
             return cf;
         }
 
+        /// Create a CAN FD frame
+        /// @param id CAN identifier
+        /// @param data Data bytes
+        /// @param len Payload length (rounded up to the next valid CAN FD length, max 64)
+        /// @param brs Switch to the data bitrate for the data phase
+        /// @param extended Use extended frame format
+        /// @return CAN FD frame
+        static inline canfd_frame make_fd_frame(uint32_t id, const uint8_t *data, uint8_t len, bool brs = true,
+                                                bool extended = false) {
+            canfd_frame cf = {};
+            cf.can_id = extended ? ((id & CAN_EFF_MASK) | CAN_EFF_FLAG) : (id & CAN_SFF_MASK);
+            uint8_t copy = len > CANFD_MAX_DLEN ? CANFD_MAX_DLEN : len;
+            cf.len = copy;
+            while (!canfd_valid_len(cf.len)) {
+                cf.len++; // Padding bytes stay zero
+            }
+            cf.flags = CANFD_FDF | (brs ? CANFD_BRS : 0);
+            if (data && copy > 0) {
+                std::memcpy(cf.data, data, copy);
+            }
+            return cf;
+        }
+
+        /// Time a classic CAN frame occupies the bus at the nominal bitrate (see can_frame_time_ns())
+        /// @param cf CAN frame
+        /// @return Frame time in nanoseconds
+        inline uint64_t frame_time_ns(const can_frame &cf) const { return can_frame_time_ns(cf, config_.bitrate); }
+
+        /// Time a CAN FD frame occupies the bus (see canfd_frame_time_ns())
+        /// @param cf CAN FD frame
+        /// @return Frame time in nanoseconds
+        inline uint64_t frame_time_ns(const canfd_frame &cf) const {
+            return canfd_frame_time_ns(cf, config_.bitrate, config_.data_bitrate);
+        }
+
       private:
-        std::shared_ptr<Link> link_;         ///< Underlying communication link
-        CanConfig config_;                   ///< CAN bus configuration
-        Vector<can_frame> rx_buffer_;        ///< Receive buffer for incoming frames
-        uint64_t last_tx_deliver_at_ns_ = 0; ///< Last transmission delivery time (for pacing)
-        uint32_t endpoint_id_;               ///< Unique endpoint identifier
+        std::shared_ptr<Link> link_;                   ///< Underlying communication link
+        CanConfig config_;                             ///< CAN bus configuration
+        RxQueue<canfd_frame> rx_buffer_;               ///< Receive buffer (classic frames widened, CANFD_FDF marks FD)
+        CanAcceptanceFilter filter_;                   ///< Compiled acceptance filter
+        uint64_t rx_filtered_ = 0;                     ///< Frames rejected by filter_
+        Vector<Frame> rx_batch_;                       ///< Scratch vector for link recv_batch()
+        DelayLine<canfd_frame> rx_delay_;              ///< Frames held until deliver_at_ns (enforce_timing)
+        uint64_t last_tx_deliver_at_ns_ = 0;           ///< Last transmission delivery time (for pacing)
+        uint32_t endpoint_id_;                         ///< Unique endpoint identifier
+        std::shared_ptr<const CanSignalDb> signal_db_; ///< Signals decoded on receive (optional)
+        CanSignalCache signal_cache_;                  ///< Latest values of signal_db_'s signals
+        bool buffer_decoded_ = true;                   ///< Buffer frames that carry signals too
+
+        /// Helper: Decode a received frame's signals and buffer it
+        inline void deliver(const canfd_frame &cf) {
+            if (signal_db_) {
+                signal_db_->decode(cf, signal_cache_, static_cast<uint64_t>(now_ns()));
+                if (!buffer_decoded_ && signal_db_->has_message(cf.can_id)) {
+                    return;
+                }
+            }
+            rx_buffer_.push(cf);
+            WIREBIT_TRACE("CAN frame buffered: ID=0x", std::hex, (cf.can_id & CAN_EFF_MASK), std::dec,
+                          " (buffer size: ", rx_buffer_.size(), ")");
+        }
+
+        /// Helper: Pace and send a CAN/CAN FD frame
+        template <size_t N>
+        inline Result<Unit, Error> transmit(TypedFrame<FrameType::CAN, N> &frame, uint64_t frame_time) {
+            WIREBIT_DEBUG("CAN frame time: ", frame_time, "ns");
+
+            // Set delivery time for bandwidth shaping
+            uint64_t now = now_ns();
+            last_tx_deliver_at_ns_ = std::max(now, last_tx_deliver_at_ns_) + frame_time;
+            frame.header.deliver_at_ns = last_tx_deliver_at_ns_;
+
+            // Send frame through link
+            auto result = link_->send_view(frame.view());
+            if (!result.is_ok()) {
+                echo::error("CAN send failed: ", result.error().message.c_str()).red();
+                return result;
+            }
+
+            WIREBIT_TRACE("CAN frame sent successfully");
+            return Result<Unit, Error>::ok(Unit{});
+        }
     };
 
 } // namespace wirebit
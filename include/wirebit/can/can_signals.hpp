@@ -0,0 +1,472 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <span>
+#include <string>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Bit numbering of a CAN signal (DBC "@1" / "@0")
+    enum class CanByteOrder : uint8_t {
+        Motorola = 0, ///< Big endian; start_bit is the most significant bit
+        Intel = 1,    ///< Little endian; start_bit is the least significant bit
+    };
+
+    /// One signal of a CAN message, as described in a DBC file
+    /// Bits are numbered DBC-style: bit 0 is the least significant bit of data byte 0.
+    struct CanSignal {
+        String name;                                   ///< Signal name
+        uint32_t can_id = 0;                           ///< Message ID (| CAN_EFF_FLAG for 29-bit IDs, as in DBC)
+        uint16_t start_bit = 0;                        ///< DBC start bit
+        uint16_t length = 1;                           ///< Width in bits (1-64)
+        CanByteOrder byte_order = CanByteOrder::Intel; ///< Bit numbering
+        bool is_signed = false;                        ///< Two's complement raw value
+        double factor = 1.0;                           ///< physical = raw * factor + offset
+        double offset = 0.0;                           ///< physical = raw * factor + offset
+        double minimum = 0.0;                          ///< Physical minimum (informational)
+        double maximum = 0.0;                          ///< Physical maximum (informational)
+        String unit;                                   ///< Physical unit (informational)
+        bool multiplexor = false;                      ///< Selects which multiplexed signals the message carries
+        int32_t mux_value = -1;                        ///< Present only when the multiplexor equals this (-1 = always)
+    };
+
+    namespace detail {
+        constexpr uint32_t SIGNAL_EFF_FLAG = 0x80000000U; ///< CAN_EFF_FLAG
+        constexpr uint32_t SIGNAL_RTR_FLAG = 0x40000000U; ///< CAN_RTR_FLAG
+        constexpr uint32_t SIGNAL_ERR_FLAG = 0x20000000U; ///< CAN_ERR_FLAG
+        constexpr uint32_t SIGNAL_ID_MASK = 0x9FFFFFFFU;  ///< Lookup key: ID plus CAN_EFF_FLAG
+        constexpr uint32_t SIGNAL_SFF_IDS = 2048;         ///< Standard IDs with a direct lookup slot
+        constexpr uint32_t SIGNAL_NO_PLAN = UINT32_MAX;   ///< Empty lookup slot
+
+        /// Precomputed extraction of one signal: a 64-bit window load, shift, mask, sign extension, scale
+        struct CanSignalOp {
+            uint64_t mask;      ///< Raw value bits after the shift
+            double factor;      ///< Scale
+            double offset;      ///< Offset
+            uint32_t signal;    ///< Index of the signal in the database
+            int32_t mux_value;  ///< Multiplexor value the signal needs (-1 = always present)
+            uint8_t base;       ///< First data byte of the window
+            uint8_t shift;      ///< Window bits below the signal
+            uint8_t sign_shift; ///< 64 - length for signed signals, 0 otherwise
+            uint8_t big_endian; ///< Load the window big endian (Motorola)
+            uint8_t min_len;    ///< Data bytes the frame needs to carry the signal
+        };
+
+        /// Load 8 data bytes from `base`, zero-filling what lies beyond the buffer
+        inline uint64_t load_signal_window(const uint8_t *data, size_t capacity, size_t base, bool big_endian) {
+            uint64_t word = 0;
+            if (base + sizeof(word) <= capacity) {
+                std::memcpy(&word, data + base, sizeof(word));
+            } else if (base < capacity) {
+                std::memcpy(&word, data + base, capacity - base);
+            }
+            return big_endian ? __builtin_bswap64(word) : word;
+        }
+
+        /// Extract a signal's raw value (sign-extended for signed signals)
+        inline int64_t extract_raw(const CanSignalOp &op, const uint8_t *data, size_t capacity) {
+            uint64_t raw = (load_signal_window(data, capacity, op.base, op.big_endian) >> op.shift) & op.mask;
+            return static_cast<int64_t>(raw << op.sign_shift) >> op.sign_shift;
+        }
+    } // namespace detail
+
+    /// Latest decoded value of every signal of a CanSignalDb
+    class CanSignalCache {
+      public:
+        CanSignalCache() = default;
+
+        /// Create a cache for a database with `signals` signals
+        inline explicit CanSignalCache(size_t signals) : values_(signals), updated_ns_(signals), updates_(signals) {}
+
+        /// Store a decoded value
+        inline void store(size_t signal, double value, uint64_t time_ns) {
+            values_[signal] = value;
+            updated_ns_[signal] = time_ns;
+            updates_[signal]++;
+        }
+
+        /// Get the latest physical value (0 until the signal was first received)
+        inline double value(size_t signal) const { return values_[signal]; }
+
+        /// Check if the signal has been received
+        inline bool has_value(size_t signal) const { return updates_[signal] != 0; }
+
+        /// Get the time of the latest update (the time passed to CanSignalDb::decode())
+        inline uint64_t updated_ns(size_t signal) const { return updated_ns_[signal]; }
+
+        /// Get how often the signal was decoded
+        inline uint64_t update_count(size_t signal) const { return updates_[signal]; }
+
+        /// Get the number of signals
+        inline size_t size() const { return values_.size(); }
+
+        /// Forget all values
+        inline void clear() {
+            std::fill(values_.begin(), values_.end(), 0.0);
+            std::fill(updated_ns_.begin(), updated_ns_.end(), 0);
+            std::fill(updates_.begin(), updates_.end(), 0);
+        }
+
+      private:
+        Vector<double> values_;       ///< Latest physical values
+        Vector<uint64_t> updated_ns_; ///< Time of the latest update
+        Vector<uint64_t> updates_;    ///< Decode count per signal
+    };
+
+    /// Signal database compiled into per-message extraction plans
+    ///
+    /// Each signal becomes a fixed op: load the 8 data bytes around it as one little- or big-endian
+    /// word, shift, mask, sign-extend and scale, with no per-bit loop. The ops of one message are
+    /// stored together, multiplexor first, and found through a direct table for standard IDs and a
+    /// sorted table for extended IDs. Signals that lie beyond a frame's length are skipped, as are
+    /// multiplexed signals whose multiplexor value does not match.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto db = CanSignalDb::parse_dbc(dbc_text).value();
+    /// CanSignalCache cache(db.size());
+    /// db.decode(frame, cache, now_ns());
+    /// double rpm = cache.value(db.find("EngineSpeed").value());
+    /// @endcode
+    class CanSignalDb {
+      public:
+        CanSignalDb() : sff_lookup_(detail::SIGNAL_SFF_IDS) {
+            std::fill(sff_lookup_.begin(), sff_lookup_.end(), detail::SIGNAL_NO_PLAN);
+        }
+
+        /// Compile a signal list
+        /// @param signals Signals of all messages, in any order
+        /// @return Result containing the database, or invalid_argument for a signal that cannot be decoded
+        ///         (bad length, outside 64 data bytes, wider than one 8-byte window, or two multiplexors)
+        static Result<CanSignalDb, Error> compile(const Vector<CanSignal> &signals) {
+            CanSignalDb db;
+            db.signals_ = signals;
+
+            // Group by message; the multiplexor goes first so it is known before its signals
+            Vector<uint32_t> order(signals.size());
+            for (uint32_t i = 0; i < signals.size(); ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                uint32_t ida = signals[a].can_id & detail::SIGNAL_ID_MASK;
+                uint32_t idb = signals[b].can_id & detail::SIGNAL_ID_MASK;
+                return ida != idb ? ida < idb : signals[a].multiplexor > signals[b].multiplexor;
+            });
+
+            for (uint32_t i : order) {
+                const CanSignal &s = signals[i];
+                uint32_t id = s.can_id & detail::SIGNAL_ID_MASK;
+                if (db.plans_.empty() || db.plans_.back().can_id != id) {
+                    db.plans_.push_back(CanMessagePlan{id, static_cast<uint32_t>(db.ops_.size()), 0, false});
+                }
+                CanMessagePlan &plan = db.plans_.back();
+                if (s.multiplexor && plan.multiplexed) {
+                    return Result<CanSignalDb, Error>::err(Error::invalid_argument("Message has two multiplexors"));
+                }
+                if (!s.multiplexor && s.mux_value >= 0 && !plan.multiplexed) {
+                    return Result<CanSignalDb, Error>::err(
+                        Error::invalid_argument("Multiplexed signal without multiplexor"));
+                }
+                auto op = compile_op(s, i);
+                if (!op.is_ok()) {
+                    echo::error("Cannot decode CAN signal ", s.name.c_str(), ": ", op.error().message.c_str()).red();
+                    return Result<CanSignalDb, Error>::err(op.error());
+                }
+                db.ops_.push_back(op.value());
+                plan.multiplexed = plan.multiplexed || s.multiplexor;
+                plan.op_count++;
+            }
+
+            for (uint32_t p = 0; p < db.plans_.size(); ++p) {
+                uint32_t id = db.plans_[p].can_id;
+                if (!(id & detail::SIGNAL_EFF_FLAG) && id < detail::SIGNAL_SFF_IDS) {
+                    db.sff_lookup_[id] = p;
+                } else {
+                    db.eff_lookup_.push_back(EffEntry{id, p});
+                }
+            }
+            WIREBIT_DEBUG("CanSignalDb: ", db.signals_.size(), " signals in ", db.plans_.size(), " messages");
+            return Result<CanSignalDb, Error>::ok(std::move(db));
+        }
+
+        /// Compile the messages and signals of a DBC file
+        /// BO_ and SG_ lines are read (including M/mN multiplexing); everything else is ignored.
+        /// @param text DBC file contents
+        /// @return Result containing the database, or invalid_argument for a malformed SG_ line
+        static Result<CanSignalDb, Error> parse_dbc(const String &text) {
+            Vector<CanSignal> signals;
+            uint32_t message_id = 0;
+            bool in_message = false;
+            std::string all(text.c_str());
+            size_t pos = 0;
+            size_t line_no = 0;
+            while (pos < all.size()) {
+                size_t end = all.find('\n', pos);
+                std::string line = all.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+                pos = end == std::string::npos ? all.size() : end + 1;
+                ++line_no;
+                size_t first = line.find_first_not_of(" \t\r");
+                if (first == std::string::npos) {
+                    in_message = false;
+                    continue;
+                }
+                line.erase(0, first);
+
+                if (line.rfind("BO_ ", 0) == 0) {
+                    unsigned long id = 0;
+                    in_message = std::sscanf(line.c_str(), "BO_ %lu", &id) == 1;
+                    message_id = static_cast<uint32_t>(id);
+                    continue;
+                }
+                if (line.rfind("SG_ ", 0) != 0) {
+                    in_message = in_message && line.rfind("SG_", 0) == 0;
+                    continue;
+                }
+                auto signal = parse_sg_line(line);
+                if (!in_message || !signal.is_ok()) {
+                    echo::error("Malformed DBC signal on line ", line_no, ": ", line.c_str()).red();
+                    return Result<CanSignalDb, Error>::err(Error::invalid_argument("Malformed DBC signal"));
+                }
+                signal.value().can_id = message_id;
+                signals.push_back(std::move(signal.value()));
+            }
+            return compile(signals);
+        }
+
+        /// Decode every signal of a message into a cache
+        /// @param can_id Received ID (CAN_EFF_FLAG for 29-bit IDs; RTR and error frames carry no signals)
+        /// @param data Data bytes
+        /// @param len Data length of the frame (signals beyond it are skipped)
+        /// @param capacity Readable bytes at data (>= len; 8 for can_frame, 64 for canfd_frame data)
+        /// @param cache Cache of this database's size
+        /// @param time_ns Time stored with the values
+        /// @return Number of signals decoded
+        inline size_t decode(uint32_t can_id, const uint8_t *data, size_t len, size_t capacity, CanSignalCache &cache,
+                             uint64_t time_ns) const {
+            return decode_with(can_id, data, len, capacity,
+                               [&](uint32_t signal, double value) { cache.store(signal, value, time_ns); });
+        }
+
+        /// Decode every signal of a can_frame or canfd_frame into a cache
+        template <typename CanFrameT>
+        inline size_t decode(const CanFrameT &cf, CanSignalCache &cache, uint64_t time_ns) const {
+            return decode(cf.can_id, cf.data, frame_len(cf), sizeof(cf.data), cache, time_ns);
+        }
+
+        /// Decode a batch of frames into a cache (frames of unknown IDs are skipped)
+        /// @return Number of signals decoded
+        template <typename CanFrameT>
+        inline size_t decode_batch(std::span<const CanFrameT> frames, CanSignalCache &cache, uint64_t time_ns) const {
+            size_t decoded = 0;
+            for (const CanFrameT &cf : frames) {
+                decoded += decode(cf, cache, time_ns);
+            }
+            return decoded;
+        }
+
+        /// Decode every signal of a message, passing (signal index, physical value) to a callback
+        /// @return Number of signals decoded
+        template <typename Sink>
+        inline size_t decode_with(uint32_t can_id, const uint8_t *data, size_t len, size_t capacity,
+                                  Sink &&sink) const {
+            const CanMessagePlan *p = plan(can_id);
+            if (p == nullptr || (can_id & (detail::SIGNAL_RTR_FLAG | detail::SIGNAL_ERR_FLAG))) {
+                return 0;
+            }
+            const detail::CanSignalOp *op = ops_.data() + p->first_op;
+            const detail::CanSignalOp *end = op + p->op_count;
+            int64_t mux = -1;
+            if (p->multiplexed) {
+                if (len < op->min_len) {
+                    return 0; // Without the multiplexor only the plain signals could be decoded
+                }
+                mux = detail::extract_raw(*op, data, capacity);
+            }
+            size_t decoded = 0;
+            for (; op != end; ++op) {
+                if (len < op->min_len || (op->mux_value >= 0 && op->mux_value != mux)) {
+                    continue;
+                }
+                int64_t raw = detail::extract_raw(*op, data, capacity);
+                sink(op->signal, static_cast<double>(raw) * op->factor + op->offset);
+                ++decoded;
+            }
+            return decoded;
+        }
+
+        /// Find a signal by name
+        /// @return Result containing the signal index, or not_found
+        inline Result<size_t, Error> find(const char *name) const {
+            for (size_t i = 0; i < signals_.size(); ++i) {
+                if (std::strcmp(signals_[i].name.c_str(), name) == 0) {
+                    return Result<size_t, Error>::ok(i);
+                }
+            }
+            return Result<size_t, Error>::err(Error::not_found("Unknown CAN signal"));
+        }
+
+        /// Find a signal by message ID and name (for names used in several messages)
+        /// @return Result containing the signal index, or not_found
+        inline Result<size_t, Error> find(uint32_t can_id, const char *name) const {
+            uint32_t id = can_id & detail::SIGNAL_ID_MASK;
+            for (size_t i = 0; i < signals_.size(); ++i) {
+                if ((signals_[i].can_id & detail::SIGNAL_ID_MASK) == id &&
+                    std::strcmp(signals_[i].name.c_str(), name) == 0) {
+                    return Result<size_t, Error>::ok(i);
+                }
+            }
+            return Result<size_t, Error>::err(Error::not_found("Unknown CAN signal"));
+        }
+
+        /// Check if frames with this ID carry any signal
+        inline bool has_message(uint32_t can_id) const { return plan(can_id) != nullptr; }
+
+        /// Get a signal's description
+        inline const CanSignal &signal(size_t index) const { return signals_[index]; }
+
+        /// Get the number of signals
+        inline size_t size() const { return signals_.size(); }
+
+        /// Get the number of messages with signals
+        inline size_t message_count() const { return plans_.size(); }
+
+      private:
+        /// Ops of one message ID
+        struct CanMessagePlan {
+            uint32_t can_id;   ///< ID plus CAN_EFF_FLAG
+            uint32_t first_op; ///< First op in ops_
+            uint32_t op_count; ///< Ops of this message
+            bool multiplexed;  ///< First op is the multiplexor
+        };
+
+        /// Extended (or out of range) ID lookup entry
+        struct EffEntry {
+            uint32_t can_id; ///< ID plus CAN_EFF_FLAG
+            uint32_t plan;   ///< Index into plans_
+        };
+
+        Vector<CanSignal> signals_;       ///< Signal descriptions, indexed like the cache
+        Vector<detail::CanSignalOp> ops_; ///< Extraction ops grouped by message
+        Vector<CanMessagePlan> plans_;    ///< Per-message op ranges, sorted by ID
+        Vector<uint32_t> sff_lookup_;     ///< Standard ID -> plan index (SIGNAL_NO_PLAN = none)
+        Vector<EffEntry> eff_lookup_;     ///< Other IDs, sorted (plans_ is sorted)
+
+        /// Helper: Find the plan of a received ID
+        inline const CanMessagePlan *plan(uint32_t can_id) const {
+            uint32_t id = can_id & detail::SIGNAL_ID_MASK;
+            if (!(id & detail::SIGNAL_EFF_FLAG)) {
+                uint32_t p = id < detail::SIGNAL_SFF_IDS ? sff_lookup_[id] : detail::SIGNAL_NO_PLAN;
+                return p == detail::SIGNAL_NO_PLAN ? nullptr : &plans_[p];
+            }
+            auto it = std::lower_bound(eff_lookup_.begin(), eff_lookup_.end(), id,
+                                       [](const EffEntry &e, uint32_t key) { return e.can_id < key; });
+            return it != eff_lookup_.end() && it->can_id == id ? &plans_[it->plan] : nullptr;
+        }
+
+        /// Helper: Data length of a can_frame (can_dlc) or canfd_frame (len)
+        template <typename CanFrameT> static inline size_t frame_len(const CanFrameT &cf) {
+            if constexpr (requires { cf.can_dlc; }) {
+                return cf.can_dlc;
+            } else {
+                return cf.len;
+            }
+        }
+
+        /// Helper: Turn a signal description into an extraction op
+        static inline Result<detail::CanSignalOp, Error> compile_op(const CanSignal &s, uint32_t index) {
+            using OpResult = Result<detail::CanSignalOp, Error>;
+            if (s.length == 0 || s.length > 64 || s.start_bit >= 512) {
+                return OpResult::err(Error::invalid_argument("Signal length or start bit out of range"));
+            }
+            size_t first_byte = s.start_bit / 8;
+            size_t last_byte;
+            if (s.byte_order == CanByteOrder::Intel) {
+                last_byte = (s.start_bit + s.length - 1) / 8;
+            } else {
+                last_byte = first_byte + (7 - s.start_bit % 8 + s.length - 1) / 8; // MSB first, towards byte 7
+            }
+            if (last_byte >= 64) {
+                return OpResult::err(Error::invalid_argument("Signal extends past 64 data bytes"));
+            }
+
+            // Classic frames always load bytes 0-7, so an 8-byte buffer is read without the slow path
+            size_t base = last_byte < 8 ? 0 : std::min<size_t>(first_byte, 56);
+            size_t low_bit; // Position of the signal's LSB within the window word
+            if (s.byte_order == CanByteOrder::Intel) {
+                low_bit = s.start_bit - base * 8;
+            } else {
+                size_t msb_from_top = (first_byte - base) * 8 + (7 - s.start_bit % 8);
+                if (msb_from_top + s.length > 64) {
+                    return OpResult::err(Error::invalid_argument("Signal wider than an 8-byte window"));
+                }
+                low_bit = 64 - msb_from_top - s.length;
+            }
+            if (low_bit + s.length > 64) {
+                return OpResult::err(Error::invalid_argument("Signal wider than an 8-byte window"));
+            }
+
+            detail::CanSignalOp op;
+            op.mask = s.length == 64 ? ~uint64_t(0) : (uint64_t(1) << s.length) - 1;
+            op.factor = s.factor;
+            op.offset = s.offset;
+            op.signal = index;
+            op.mux_value = s.multiplexor ? -1 : s.mux_value;
+            op.base = static_cast<uint8_t>(base);
+            op.shift = static_cast<uint8_t>(low_bit);
+            op.sign_shift = static_cast<uint8_t>(s.is_signed ? 64 - s.length : 0);
+            op.big_endian = s.byte_order == CanByteOrder::Motorola ? 1 : 0;
+            op.min_len = static_cast<uint8_t>(last_byte + 1);
+            return OpResult::ok(op);
+        }
+
+        /// Helper: Parse ` SG_ name [M|mN] : start|length@order sign (factor,offset) [min|max] "unit" receivers`
+        static inline Result<CanSignal, Error> parse_sg_line(const std::string &line) {
+            using SignalResult = Result<CanSignal, Error>;
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                return SignalResult::err(Error::invalid_argument("Missing ':'"));
+            }
+            char name[128] = {};
+            char mux[16] = {};
+            int fields = std::sscanf(line.substr(0, colon).c_str(), "SG_ %127s %15s", name, mux);
+            if (fields < 1) {
+                return SignalResult::err(Error::invalid_argument("Missing signal name"));
+            }
+
+            CanSignal s;
+            s.name = String(name);
+            if (fields == 2) {
+                if (std::strcmp(mux, "M") == 0) {
+                    s.multiplexor = true;
+                } else if (mux[0] == 'm' && std::sscanf(mux + 1, "%d", &s.mux_value) == 1 && s.mux_value >= 0) {
+                    // mN: present when the multiplexor is N (mNM, nested multiplexing, is read as mN)
+                } else {
+                    return SignalResult::err(Error::invalid_argument("Bad multiplexer indicator"));
+                }
+            }
+
+            unsigned start = 0;
+            unsigned length = 0;
+            char order = 0;
+            char sign = 0;
+            char unit[64] = {};
+            int parsed = std::sscanf(line.c_str() + colon + 1, " %u|%u@%c%c (%lf,%lf) [%lf|%lf] \"%63[^\"]\"", &start,
+                                     &length, &order, &sign, &s.factor, &s.offset, &s.minimum, &s.maximum, unit);
+            if (parsed < 8 || (order != '0' && order != '1') || (sign != '+' && sign != '-')) {
+                return SignalResult::err(Error::invalid_argument("Bad signal layout"));
+            }
+            s.start_bit = static_cast<uint16_t>(std::min(start, 65535u));
+            s.length = static_cast<uint16_t>(std::min(length, 65535u));
+            s.byte_order = order == '1' ? CanByteOrder::Intel : CanByteOrder::Motorola;
+            s.is_signed = sign == '-';
+            s.unit = String(unit);
+            return SignalResult::ok(std::move(s));
+        }
+    };
+
+} // namespace wirebit
@@ -6,6 +6,7 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-truncation"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <echo/echo.hpp>
@@ -15,19 +16,33 @@
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <wirebit/common/io_uring.hpp>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
+#include <wirebit/common/timestamping.hpp>
 #include <wirebit/common/types.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
 
 namespace wirebit {
+    namespace detail {
+        constexpr unsigned int SOCKETCAN_MMSG_BATCH = 32; ///< Frames per sendmmsg/recvmmsg call
+    } // namespace detail
 
     /// Configuration for SocketCAN link
     struct SocketCanConfig {
         String interface_name = "vcan0"; ///< CAN interface name (vcan0, can0, etc.)
         bool create_if_missing = true;   ///< Create interface if it doesn't exist (requires sudo)
         bool destroy_on_close = false;   ///< Destroy interface when link is closed
+        bool use_io_uring = false;       ///< Use io_uring for frame I/O (falls back to read/write)
+        uint32_t io_uring_entries = 256; ///< io_uring queue depth (RX buffers and TX slots)
+        uint32_t io_uring_batch = 1;     ///< Queued sends that trigger an io_uring submit (see flush())
+        bool fd_frames = false;          ///< Enable CAN FD (CAN_RAW_FD_FRAMES): canfd_frame payloads are accepted
+        Vector<can_filter> filters = {}; ///< Kernel acceptance filters (CAN_RAW_FILTER); empty = receive all
+        bool kernel_timestamps = false;  ///< Stamp received frames in the kernel (SO_TIMESTAMPING), not after read()
+        bool hw_timestamps = false;      ///< Prefer controller hardware timestamps (implies kernel_timestamps)
     };
 
     /// Statistics for SocketCanLink
@@ -38,6 +53,8 @@ namespace wirebit {
         uint64_t bytes_received = 0;
         uint64_t send_errors = 0;
         uint64_t recv_errors = 0;
+        uint64_t sw_timestamps = 0;
+        uint64_t hw_timestamps = 0;
 
         inline void reset() {
             frames_sent = 0;
@@ -46,6 +63,8 @@ namespace wirebit {
             bytes_received = 0;
             send_errors = 0;
             recv_errors = 0;
+            sw_timestamps = 0;
+            hw_timestamps = 0;
         }
     };
 
@@ -67,7 +86,7 @@ namespace wirebit {
         /// @param config SocketCAN configuration
         /// @return Result containing SocketCanLink or error
         static inline Result<SocketCanLink, Error> create(const SocketCanConfig &config = {}) {
-            echo::trace("Creating SocketCanLink for interface: ", config.interface_name.c_str());
+            WIREBIT_TRACE("Creating SocketCanLink for interface: ", config.interface_name.c_str());
 
             // Check if interface exists
             bool interface_exists = check_interface_exists(config.interface_name);
@@ -105,7 +124,7 @@ namespace wirebit {
             }
 
             int if_index = ifr.ifr_ifindex;
-            echo::debug("Interface ", config.interface_name.c_str(), " index: ", if_index);
+            WIREBIT_DEBUG("Interface ", config.interface_name.c_str(), " index: ", if_index);
 
             // Bind socket to interface
             struct sockaddr_can addr;
@@ -119,6 +138,38 @@ namespace wirebit {
                 return Result<SocketCanLink, Error>::err(Error::io_error("Failed to bind CAN socket"));
             }
 
+            // Enable CAN FD frames (the interface MTU must be CANFD_MTU, e.g. vcan or an FD controller)
+            if (config.fd_frames) {
+                int enable = 1;
+                if (setsockopt(sock_fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) < 0) {
+                    echo::error("Failed to enable CAN FD frames: ", strerror(errno)).red();
+                    close(sock_fd);
+                    return Result<SocketCanLink, Error>::err(Error::io_error("Failed to enable CAN FD frames"));
+                }
+            }
+
+            // Install acceptance filters so unwanted IDs are dropped in the kernel
+            if (!config.filters.empty()) {
+                socklen_t len = static_cast<socklen_t>(config.filters.size() * sizeof(struct can_filter));
+                if (setsockopt(sock_fd, SOL_CAN_RAW, CAN_RAW_FILTER, config.filters.data(), len) < 0) {
+                    echo::error("Failed to set CAN filters: ", strerror(errno)).red();
+                    close(sock_fd);
+                    return Result<SocketCanLink, Error>::err(Error::io_error("Failed to set CAN filters"));
+                }
+                WIREBIT_DEBUG("Installed ", config.filters.size(), " CAN filters");
+            }
+
+            // Kernel timestamps replace the user-space clock read after each receive
+            TimestampSource ts_source = TimestampSource::None;
+            if (config.kernel_timestamps || config.hw_timestamps) {
+                auto ts_result = detail::enable_timestamping(sock_fd, config.interface_name, config.hw_timestamps);
+                if (!ts_result.is_ok()) {
+                    close(sock_fd);
+                    return Result<SocketCanLink, Error>::err(ts_result.error());
+                }
+                ts_source = ts_result.value();
+            }
+
             // Set non-blocking mode
             int flags = fcntl(sock_fd, F_GETFL, 0);
             if (flags < 0 || fcntl(sock_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
@@ -127,9 +178,33 @@ namespace wirebit {
                 return Result<SocketCanLink, Error>::err(Error::io_error("Failed to set non-blocking mode"));
             }
 
-            echo::trace("SocketCanLink created: interface=", config.interface_name.c_str(), " fd=", sock_fd).green();
+            WIREBIT_TRACE("SocketCanLink created: interface=", config.interface_name.c_str(), " fd=", sock_fd).green();
 
-            return Result<SocketCanLink, Error>::ok(SocketCanLink(sock_fd, config, !interface_exists));
+            SocketCanLink link(sock_fd, config, !interface_exists);
+            link.ts_source_ = ts_source;
+            if (config.use_io_uring) {
+                if (ts_source != TimestampSource::None) {
+                    echo::warn("SocketCanLink: io_uring receive carries no control data, kernel timestamps unused")
+                        .yellow();
+                }
+                UringPortConfig uring_config;
+                uring_config.entries = config.io_uring_entries;
+                uring_config.rx_buffers = config.io_uring_entries;
+                uring_config.rx_buffer_size = config.fd_frames ? CANFD_MTU : CAN_MTU;
+                uring_config.tx_slots = config.io_uring_entries;
+                uring_config.tx_slot_size = config.fd_frames ? CANFD_MTU : CAN_MTU;
+                uring_config.socket = true;
+                uring_config.submit_batch = config.io_uring_batch;
+                auto port = UringPort::create(sock_fd, uring_config);
+                if (port.is_ok()) {
+                    link.uring_ = std::move(port.value());
+                } else {
+                    echo::warn("SocketCanLink: io_uring unavailable, using read/write: ",
+                               port.error().message.c_str())
+                        .yellow();
+                }
+            }
+            return Result<SocketCanLink, Error>::ok(std::move(link));
         }
 
         /// Attach to an existing SocketCAN interface (does not create if missing)
@@ -141,14 +216,15 @@ namespace wirebit {
 
         /// Destructor - closes socket and optionally destroys interface
         inline ~SocketCanLink() {
+            uring_.reset();
             if (sock_fd_ >= 0) {
-                echo::debug("Closing SocketCAN fd: ", sock_fd_);
+                WIREBIT_DEBUG("Closing SocketCAN fd: ", sock_fd_);
                 close(sock_fd_);
                 sock_fd_ = -1;
             }
 
             if (config_.destroy_on_close && we_created_interface_) {
-                echo::trace("Destroying CAN interface: ", config_.interface_name.c_str());
+                WIREBIT_TRACE("Destroying CAN interface: ", config_.interface_name.c_str());
                 destroy_vcan_interface(config_.interface_name);
             }
         }
@@ -156,7 +232,8 @@ namespace wirebit {
         /// Move constructor
         inline SocketCanLink(SocketCanLink &&other) noexcept
             : sock_fd_(other.sock_fd_), config_(other.config_), stats_(other.stats_),
-              we_created_interface_(other.we_created_interface_) {
+              we_created_interface_(other.we_created_interface_), ts_source_(other.ts_source_),
+              uring_(std::move(other.uring_)) {
             other.sock_fd_ = -1;
             other.we_created_interface_ = false;
         }
@@ -164,6 +241,7 @@ namespace wirebit {
         /// Move assignment
         inline SocketCanLink &operator=(SocketCanLink &&other) noexcept {
             if (this != &other) {
+                uring_.reset();
                 if (sock_fd_ >= 0) {
                     close(sock_fd_);
                 }
@@ -174,6 +252,8 @@ namespace wirebit {
                 config_ = other.config_;
                 stats_ = other.stats_;
                 we_created_interface_ = other.we_created_interface_;
+                ts_source_ = other.ts_source_;
+                uring_ = std::move(other.uring_);
                 other.sock_fd_ = -1;
                 other.we_created_interface_ = false;
             }
@@ -185,9 +265,14 @@ namespace wirebit {
         SocketCanLink &operator=(const SocketCanLink &) = delete;
 
         /// Send a frame through the SocketCAN interface
-        /// @param frame Frame to send (payload must be a can_frame)
+        /// @param frame Frame to send (payload must be a can_frame, or a canfd_frame with fd_frames)
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Send a borrowed frame through the SocketCAN interface
+        /// @param frame Frame view to send (payload must be a can_frame, or a canfd_frame with fd_frames)
         /// @return Result indicating success or error
-        inline Result<Unit, Error> send(const Frame &frame) override {
+        inline Result<Unit, Error> send_view(const FrameView &frame) override {
             if (sock_fd_ < 0) {
                 return Result<Unit, Error>::err(Error::io_error("SocketCAN not open"));
             }
@@ -198,20 +283,33 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::invalid_argument("Expected CAN frame type"));
             }
 
-            // Verify payload size matches can_frame
-            if (frame.payload.size() != sizeof(struct can_frame)) {
-                echo::error("Invalid CAN frame payload size: ", frame.payload.size(), " (expected ",
-                            sizeof(struct can_frame), ")")
+            // Verify payload size matches can_frame (or canfd_frame in FD mode)
+            size_t size = frame.payload.size();
+            if (!valid_mtu(size)) {
+                echo::error("Invalid CAN frame payload size: ", size, " (expected ", CAN_MTU, ", or ", CANFD_MTU,
+                            " with fd_frames)")
                     .red();
                 return Result<Unit, Error>::err(Error::invalid_argument("Invalid CAN frame payload size"));
             }
 
-            // Extract can_frame from payload
-            struct can_frame cf;
-            std::memcpy(&cf, frame.payload.data(), sizeof(struct can_frame));
+            // Extract the frame from payload (classic frames share the canfd_frame prefix layout)
+            struct canfd_frame cf;
+            std::memcpy(&cf, frame.payload.data(), size);
+
+            if (uring_) {
+                // Write errors complete asynchronously and are counted in io_uring_stats().tx_errors
+                auto queued = uring_->send(frame.payload);
+                if (!queued.is_ok()) {
+                    return queued;
+                }
+                stats_.frames_sent++;
+                stats_.bytes_sent += size;
+                stats_export_.sent(size);
+                return Result<Unit, Error>::ok(Unit{});
+            }
 
             // Write to socket
-            ssize_t written = write(sock_fd_, &cf, sizeof(struct can_frame));
+            ssize_t written = write(sock_fd_, &cf, size);
             if (written < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
                     echo::warn("SocketCAN write would block").yellow();
@@ -219,62 +317,257 @@ namespace wirebit {
                 }
                 echo::error("SocketCAN write failed: ", strerror(errno)).red();
                 stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
                 return Result<Unit, Error>::err(Error::io_error("SocketCAN write failed"));
             }
 
-            if (written != sizeof(struct can_frame)) {
-                echo::warn("SocketCAN partial write: ", written, " of ", sizeof(struct can_frame), " bytes").yellow();
+            if (static_cast<size_t>(written) != size) {
+                echo::warn("SocketCAN partial write: ", written, " of ", size, " bytes").yellow();
                 stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
                 return Result<Unit, Error>::err(Error::io_error("SocketCAN partial write"));
             }
 
             stats_.frames_sent++;
             stats_.bytes_sent += written;
+            stats_export_.sent(written);
 
-            echo::debug("SocketCanLink sent: CAN ID=0x", std::hex, (cf.can_id & 0x1FFFFFFF), std::dec,
-                        " DLC=", static_cast<int>(cf.can_dlc));
+            WIREBIT_DEBUG("SocketCanLink sent: CAN ID=0x", std::hex, (cf.can_id & 0x1FFFFFFF), std::dec,
+                          " DLC=", static_cast<int>(cf.len), size == CANFD_MTU ? " FD" : "");
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Receive a frame from the SocketCAN interface (non-blocking)
         /// @return Result containing frame if available, or error
         inline Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive a frame from the SocketCAN interface without allocating (non-blocking)
+        /// The view points into the link's receive buffer and stays valid until the next recv call
+        /// @return Result containing frame view if available, or error
+        inline Result<FrameView, Error> recv_view() override {
             if (sock_fd_ < 0) {
-                return Result<Frame, Error>::err(Error::io_error("SocketCAN not open"));
+                return Result<FrameView, Error>::err(Error::io_error("SocketCAN not open"));
             }
 
-            // Read can_frame from socket
-            struct can_frame cf;
-            ssize_t bytes_read = read(sock_fd_, &cf, sizeof(struct can_frame));
+            // Read can_frame (or canfd_frame in FD mode) from socket
+            struct canfd_frame &cf = rx_frame_;
+            ssize_t bytes_read;
+            KernelTimestamp stamp;
+            if (ts_source_ != TimestampSource::None && !uring_) {
+                // recvmsg() so the kernel timestamp arrives with the frame
+                struct iovec iov = {&cf, config_.fd_frames ? CANFD_MTU : CAN_MTU};
+                alignas(struct cmsghdr) char control[detail::TIMESTAMP_CONTROL_LEN];
+                struct msghdr msg;
+                std::memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+                bytes_read = recvmsg(sock_fd_, &msg, MSG_DONTWAIT);
+                if (bytes_read >= 0) {
+                    stamp = detail::cmsg_timestamp(msg);
+                }
+            } else if (uring_) {
+                auto received = uring_->recv();
+                if (!received.is_ok()) {
+                    return Result<FrameView, Error>::err(Error::timeout("No CAN frames available"));
+                }
+                bytes_read = static_cast<ssize_t>(received.value().size());
+                std::memcpy(&cf, received.value().data(), std::min(received.value().size(), sizeof(cf)));
+            } else {
+                bytes_read = read(sock_fd_, &cf, config_.fd_frames ? CANFD_MTU : CAN_MTU);
+            }
 
             if (bytes_read < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    return Result<Frame, Error>::err(Error::timeout("No CAN frames available"));
+                    return Result<FrameView, Error>::err(Error::timeout("No CAN frames available"));
                 }
                 echo::error("SocketCAN read failed: ", strerror(errno)).red();
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("SocketCAN read failed"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("SocketCAN read failed"));
             }
 
-            if (bytes_read != sizeof(struct can_frame)) {
-                echo::warn("SocketCAN partial read: ", bytes_read, " of ", sizeof(struct can_frame), " bytes").yellow();
+            size_t size = static_cast<size_t>(bytes_read);
+            if (!valid_mtu(size)) {
+                echo::warn("SocketCAN partial read: ", bytes_read, " bytes").yellow();
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("SocketCAN partial read"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("SocketCAN partial read"));
             }
 
             stats_.frames_received++;
             stats_.bytes_received += bytes_read;
+            stats_export_.received(bytes_read);
+
+            // Wrap can_frame/canfd_frame in wirebit Frame
+            FrameView frame = make_view_with_timestamp(
+                FrameType::CAN, std::span<const Byte>(reinterpret_cast<const Byte *>(&cf), size), rx_timestamp(stamp));
+
+            WIREBIT_DEBUG("SocketCanLink recv: CAN ID=0x", std::hex, (cf.can_id & 0x1FFFFFFF), std::dec,
+                          " DLC=", static_cast<int>(cf.len), size == CANFD_MTU ? " FD" : "");
+
+            return Result<FrameView, Error>::ok(frame);
+        }
+
+        /// Send several CAN frames with sendmmsg (one syscall per SOCKETCAN_MMSG_BATCH frames, or a single
+        /// io_uring submit for the whole batch in io_uring mode)
+        /// @param frames Frames to send (payloads must be can_frames, or canfd_frames with fd_frames)
+        /// @return Result containing number of frames sent, or error if none could be sent
+        inline Result<size_t, Error> send_batch(std::span<const Frame> frames) override {
+            if (sock_fd_ < 0) {
+                return Result<size_t, Error>::err(Error::io_error("SocketCAN not open"));
+            }
+            if (uring_) {
+                return send_batch_uring(frames);
+            }
+
+            struct iovec iov[detail::SOCKETCAN_MMSG_BATCH];
+            struct mmsghdr msgs[detail::SOCKETCAN_MMSG_BATCH];
+
+            size_t sent = 0;
+            while (sent < frames.size()) {
+                // Collect the next run of valid CAN frames
+                unsigned int count = 0;
+                while (count < detail::SOCKETCAN_MMSG_BATCH && sent + count < frames.size()) {
+                    const Frame &frame = frames[sent + count];
+                    if (frame.type() != FrameType::CAN || !valid_mtu(frame.payload.size())) {
+                        break;
+                    }
+                    iov[count].iov_base = const_cast<Byte *>(frame.payload.data());
+                    iov[count].iov_len = frame.payload.size();
+                    std::memset(&msgs[count], 0, sizeof(struct mmsghdr));
+                    msgs[count].msg_hdr.msg_iov = &iov[count];
+                    msgs[count].msg_hdr.msg_iovlen = 1;
+                    ++count;
+                }
+
+                if (count == 0) {
+                    echo::error("Invalid CAN frame in batch at index ", sent).red();
+                    if (sent == 0) {
+                        return Result<size_t, Error>::err(Error::invalid_argument("Invalid CAN frame in batch"));
+                    }
+                    break;
+                }
+
+                int n = sendmmsg(sock_fd_, msgs, count, MSG_DONTWAIT);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        echo::error("SocketCAN sendmmsg failed: ", strerror(errno)).red();
+                        stats_.send_errors++;
+                        stats_export_.add(LinkCounter::SendErrors);
+                        if (sent == 0) {
+                            return Result<size_t, Error>::err(Error::io_error("SocketCAN sendmmsg failed"));
+                        }
+                    } else if (sent == 0) {
+                        echo::warn("SocketCAN write would block").yellow();
+                        return Result<size_t, Error>::err(Error::timeout("SocketCAN write would block"));
+                    }
+                    break;
+                }
+
+                for (int i = 0; i < n; ++i) {
+                    stats_.bytes_sent += iov[i].iov_len;
+                    stats_export_.sent(iov[i].iov_len);
+                }
+                sent += static_cast<size_t>(n);
+                stats_.frames_sent += static_cast<uint64_t>(n);
+
+                if (static_cast<unsigned int>(n) < count) {
+                    break; // Socket queue full
+                }
+            }
+
+            WIREBIT_DEBUG("SocketCanLink sent batch: ", sent, " of ", frames.size(), " frames");
+            return Result<size_t, Error>::ok(sent);
+        }
 
-            // Wrap can_frame in wirebit Frame
-            Bytes payload(sizeof(struct can_frame));
-            std::memcpy(payload.data(), &cf, sizeof(struct can_frame));
+        /// Receive up to max_frames CAN frames with recvmmsg (non-blocking)
+        /// @param frames Vector the received frames are appended to
+        /// @param max_frames Maximum number of frames to receive
+        /// @return Result containing number of frames received, or error if none were available
+        inline Result<size_t, Error> recv_batch(Vector<Frame> &frames, size_t max_frames) override {
+            if (sock_fd_ < 0) {
+                return Result<size_t, Error>::err(Error::io_error("SocketCAN not open"));
+            }
+            if (uring_) {
+                // Completions are reaped from the shared ring, so per-frame recv costs no syscall
+                return Link::recv_batch(frames, max_frames);
+            }
 
-            Frame frame = make_frame(FrameType::CAN, std::move(payload), 0, 0);
+            struct canfd_frame cfs[detail::SOCKETCAN_MMSG_BATCH];
+            struct iovec iov[detail::SOCKETCAN_MMSG_BATCH];
+            struct mmsghdr msgs[detail::SOCKETCAN_MMSG_BATCH];
+            alignas(struct cmsghdr) char control[detail::SOCKETCAN_MMSG_BATCH][detail::TIMESTAMP_CONTROL_LEN];
+            bool stamped = ts_source_ != TimestampSource::None;
+
+            size_t received = 0;
+            while (received < max_frames) {
+                unsigned int want = static_cast<unsigned int>(
+                    std::min<size_t>(max_frames - received, detail::SOCKETCAN_MMSG_BATCH));
+                for (unsigned int i = 0; i < want; ++i) {
+                    iov[i].iov_base = &cfs[i];
+                    iov[i].iov_len = config_.fd_frames ? CANFD_MTU : CAN_MTU;
+                    std::memset(&msgs[i], 0, sizeof(struct mmsghdr));
+                    msgs[i].msg_hdr.msg_iov = &iov[i];
+                    msgs[i].msg_hdr.msg_iovlen = 1;
+                    if (stamped) {
+                        msgs[i].msg_hdr.msg_control = control[i];
+                        msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+                    }
+                }
+
+                int n = recvmmsg(sock_fd_, msgs, want, MSG_DONTWAIT, nullptr);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        echo::error("SocketCAN recvmmsg failed: ", strerror(errno)).red();
+                        stats_.recv_errors++;
+                        stats_export_.add(LinkCounter::RecvErrors);
+                        if (received == 0) {
+                            return Result<size_t, Error>::err(Error::io_error("SocketCAN recvmmsg failed"));
+                        }
+                    }
+                    break;
+                }
+
+                for (int i = 0; i < n; ++i) {
+                    size_t size = msgs[i].msg_len;
+                    if (!valid_mtu(size)) {
+                        echo::warn("SocketCAN partial read: ", size, " bytes").yellow();
+                        stats_.recv_errors++;
+                        stats_export_.add(LinkCounter::RecvErrors);
+                        continue;
+                    }
+                    const auto *bytes = reinterpret_cast<const Byte *>(&cfs[i]);
+                    KernelTimestamp stamp;
+                    if (stamped) {
+                        stamp = detail::cmsg_timestamp(msgs[i].msg_hdr);
+                    }
+                    frames.push_back(owned_frame(make_view_with_timestamp(
+                        FrameType::CAN, std::span<const Byte>(bytes, size), rx_timestamp(stamp))));
+                    stats_.frames_received++;
+                    stats_.bytes_received += size;
+                    stats_export_.received(size);
+                    ++received;
+                }
+
+                if (static_cast<unsigned int>(n) < want) {
+                    break; // Socket drained
+                }
+            }
 
-            echo::debug("SocketCanLink recv: CAN ID=0x", std::hex, (cf.can_id & 0x1FFFFFFF), std::dec,
-                        " DLC=", static_cast<int>(cf.can_dlc));
+            if (received == 0) {
+                return Result<size_t, Error>::err(Error::timeout("No CAN frames available"));
+            }
 
-            return Result<Frame, Error>::ok(std::move(frame));
+            WIREBIT_DEBUG("SocketCanLink recv batch: ", received, " frames");
+            return Result<size_t, Error>::ok(received);
         }
 
         /// Check if link is ready for sending
@@ -297,6 +590,70 @@ namespace wirebit {
         /// @return Socket file descriptor
         inline int socket_fd() const { return sock_fd_; }
 
+        /// Get file descriptor for readiness polling (see Link::poll_fd())
+        /// @return File descriptor
+        inline int poll_fd() const override { return uring_ ? uring_->ring_fd() : sock_fd_; }
+
+        /// Submit queued io_uring work before blocking (see Link::prepare_wait())
+        /// @return false if a received frame is already waiting
+        inline bool prepare_wait() override {
+            if (!uring_) {
+                return true;
+            }
+            uring_->flush();
+            return !uring_->has_rx();
+        }
+
+        /// Check if frame I/O goes through io_uring
+        /// @return true if io_uring was requested and set up successfully
+        inline bool io_uring_enabled() const { return uring_ != nullptr; }
+
+        /// Submit sends queued by io_uring_batch and re-arm receive with one io_uring_enter()
+        /// Call once per event loop iteration; no-op without io_uring.
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> flush() {
+            if (uring_) {
+                auto result = uring_->flush();
+                if (!result.is_ok()) {
+                    return Result<Unit, Error>::err(result.error());
+                }
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Get io_uring statistics (all zero without io_uring)
+        /// @return Statistics
+        inline UringPortStats io_uring_stats() const { return uring_ ? uring_->stats() : UringPortStats{}; }
+
+        /// Get the timestamp source negotiated for received frames
+        /// @return TimestampSource::None unless kernel_timestamps/hw_timestamps were enabled
+        inline TimestampSource timestamp_source() const { return ts_source_; }
+
+        /// Read the kernel timestamp of a sent frame from the socket error queue (non-blocking)
+        /// Only available with kernel_timestamps; the CAN driver must stamp transmitted frames.
+        /// @return Result containing the TX timestamp in nanoseconds, or timeout if none is queued
+        inline Result<uint64_t, Error> recv_tx_timestamp() {
+            if (ts_source_ == TimestampSource::None) {
+                return Result<uint64_t, Error>::err(Error::invalid_argument("Kernel timestamps not enabled"));
+            }
+            alignas(struct cmsghdr) char control[detail::TIMESTAMP_CONTROL_LEN];
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (recvmsg(sock_fd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return Result<uint64_t, Error>::err(Error::timeout("No TX timestamp queued"));
+                }
+                return Result<uint64_t, Error>::err(Error::io_error("SocketCAN error queue read failed"));
+            }
+            KernelTimestamp stamp = detail::cmsg_timestamp(msg);
+            if (stamp.ns == 0) {
+                return Result<uint64_t, Error>::err(Error::timeout("No TX timestamp queued"));
+            }
+            return Result<uint64_t, Error>::ok(stamp.ns);
+        }
+
         /// Get link statistics
         /// @return Statistics reference
         inline const SocketCanLinkStats &stats() const { return stats_; }
@@ -305,14 +662,66 @@ namespace wirebit {
         inline void reset_stats() { stats_.reset(); }
 
       private:
-        int sock_fd_;               ///< SocketCAN socket file descriptor
-        SocketCanConfig config_;    ///< Configuration
-        SocketCanLinkStats stats_;  ///< Statistics
-        bool we_created_interface_; ///< True if we created the interface (for cleanup)
+        int sock_fd_;                      ///< SocketCAN socket file descriptor
+        SocketCanConfig config_;           ///< Configuration
+        SocketCanLinkStats stats_;         ///< Statistics
+        bool we_created_interface_;        ///< True if we created the interface (for cleanup)
+        TimestampSource ts_source_;        ///< Kernel timestamp source for received frames
+        canfd_frame rx_frame_{};           ///< Receive buffer backing recv_view() (large enough for FD)
+        std::unique_ptr<UringPort> uring_; ///< io_uring backend (null = read/write)
 
         /// Private constructor
         inline SocketCanLink(int sock_fd, const SocketCanConfig &config, bool we_created)
-            : sock_fd_(sock_fd), config_(config), we_created_interface_(we_created) {}
+            : sock_fd_(sock_fd), config_(config), we_created_interface_(we_created),
+              ts_source_(TimestampSource::None) {}
+
+        /// Helper: Pick a received frame's timestamp (kernel stamp if present, else the current time)
+        inline uint64_t rx_timestamp(const KernelTimestamp &stamp) {
+            if (stamp.source == TimestampSource::Hardware) {
+                stats_.hw_timestamps++;
+                return stamp.ns;
+            }
+            if (stamp.source == TimestampSource::Software) {
+                stats_.sw_timestamps++;
+                return stamp.ns;
+            }
+            return now_ns();
+        }
+
+        /// Helper: Check if a payload size is a frame this socket carries (CAN_MTU, or CANFD_MTU in FD mode)
+        inline bool valid_mtu(size_t size) const {
+            return size == CAN_MTU || (config_.fd_frames && size == CANFD_MTU);
+        }
+
+        /// Helper: Queue a batch of CAN frames on io_uring and submit them with one io_uring_enter()
+        inline Result<size_t, Error> send_batch_uring(std::span<const Frame> frames) {
+            size_t sent = 0;
+            Result<Unit, Error> failed = Result<Unit, Error>::ok(Unit{});
+            for (const Frame &frame : frames) {
+                if (frame.type() != FrameType::CAN || !valid_mtu(frame.payload.size())) {
+                    echo::error("Invalid CAN frame in batch at index ", sent).red();
+                    failed = Result<Unit, Error>::err(Error::invalid_argument("Invalid CAN frame in batch"));
+                    break;
+                }
+                failed = uring_->queue_send(std::span<const Byte>(frame.payload.data(), frame.payload.size()));
+                if (!failed.is_ok()) {
+                    break;
+                }
+                stats_.frames_sent++;
+                stats_.bytes_sent += frame.payload.size();
+                stats_export_.sent(frame.payload.size());
+                ++sent;
+            }
+            auto flushed = uring_->flush();
+            if (sent == 0 && !failed.is_ok()) {
+                return Result<size_t, Error>::err(failed.error());
+            }
+            if (!flushed.is_ok()) {
+                return Result<size_t, Error>::err(flushed.error());
+            }
+            WIREBIT_DEBUG("SocketCanLink queued batch: ", sent, " of ", frames.size(), " frames");
+            return Result<size_t, Error>::ok(sent);
+        }
 
         /// Check if a CAN interface exists
         /// @param iface_name Interface name to check
@@ -330,7 +739,7 @@ namespace wirebit {
             bool exists = (ioctl(sock, SIOCGIFINDEX, &ifr) >= 0);
             close(sock);
 
-            echo::debug("Interface ", iface_name.c_str(), " exists: ", exists ? "yes" : "no");
+            WIREBIT_DEBUG("Interface ", iface_name.c_str(), " exists: ", exists ? "yes" : "no");
             return exists;
         }
 
@@ -338,7 +747,7 @@ namespace wirebit {
         /// @param iface_name Interface name to create
         /// @return Result indicating success or error
         static inline Result<Unit, Error> create_vcan_interface(const String &iface_name) {
-            echo::trace("Creating virtual CAN interface: ", iface_name.c_str());
+            WIREBIT_TRACE("Creating virtual CAN interface: ", iface_name.c_str());
 
             // Load vcan module (ignore if already loaded)
             int ret = system("sudo modprobe vcan 2>/dev/null");
@@ -367,14 +776,14 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::io_error("Failed to create CAN interface"));
             }
 
-            echo::trace("Virtual CAN interface ", iface_name.c_str(), " created and up").green();
+            WIREBIT_TRACE("Virtual CAN interface ", iface_name.c_str(), " created and up").green();
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Destroy a virtual CAN interface
         /// @param iface_name Interface name to destroy
         static inline void destroy_vcan_interface(const String &iface_name) {
-            echo::trace("Destroying virtual CAN interface: ", iface_name.c_str());
+            WIREBIT_TRACE("Destroying virtual CAN interface: ", iface_name.c_str());
             char cmd[256];
             snprintf(cmd, sizeof(cmd), "sudo ip link delete %s 2>/dev/null", iface_name.c_str());
             int ret = system(cmd);
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+#include <wirebit/shm/ring.hpp>
+
+namespace wirebit {
+
+    /// Direction of an observed or captured frame (values match pcapng epb_flags bits 0-1)
+    enum class CaptureDirection : uint8_t {
+        Unknown = 0,
+        Inbound = 1,  ///< Received by the link
+        Outbound = 2, ///< Sent through the link
+    };
+
+    /// Configuration for an ObserverQueue
+    struct ObserverConfig {
+        String name = "observer";     ///< Shown in logs
+        size_t queue_bytes = 1 << 20; ///< Queue capacity per direction
+        bool tx = true;               ///< Observe frames sent through the link
+        bool rx = true;               ///< Observe frames received from the link
+    };
+
+    /// Statistics for an ObserverQueue
+    struct ObserverStats {
+        uint64_t frames_queued = 0;  ///< Frames copied into the queue
+        uint64_t frames_dropped = 0; ///< Frames lost because the queue was full
+
+        inline void reset() {
+            frames_queued = 0;
+            frames_dropped = 0;
+        }
+    };
+
+    /// Frame taken from an ObserverQueue
+    struct ObservedFrame {
+        FrameView frame;                                        ///< Frame; spans point into the queue
+        TimeNs capture_ns = 0;                                  ///< When the link sent or received it
+        CaptureDirection direction = CaptureDirection::Unknown; ///< Which way it went
+    };
+
+    /// Bounded queue of frames copied off a link for an observer (TeeLink, RecordingLink)
+    ///
+    /// Two heap FrameRings, one per direction, so the thread that sends and the thread that
+    /// receives each own one producer index and push() needs no lock or atomic read-modify-write.
+    /// push() never waits: when the ring of that direction is full the frame is counted in
+    /// frames_dropped and the caller carries on. The observer thread takes frames in capture order
+    /// across both directions with peek()/consume() or drain().
+    ///
+    /// Queue record: [FrameHeader (meta_len includes the capture time)][payload][capture ns][meta]
+    class ObserverQueue {
+      public:
+        /// Create a queue
+        /// @param config Queue configuration
+        /// @return Result containing queue, or invalid_argument if queue_bytes is too small
+        static Result<ObserverQueue, Error> create(const ObserverConfig &config = {}) {
+            auto tx = FrameRing::create(config.queue_bytes);
+            if (!tx.is_ok()) {
+                return Result<ObserverQueue, Error>::err(tx.error());
+            }
+            auto rx = FrameRing::create(config.queue_bytes);
+            if (!rx.is_ok()) {
+                return Result<ObserverQueue, Error>::err(rx.error());
+            }
+            ObserverQueue queue(config, std::move(tx.value()), std::move(rx.value()));
+            return Result<ObserverQueue, Error>::ok(std::move(queue));
+        }
+
+        /// Move constructor (neither queue may be in use)
+        ObserverQueue(ObserverQueue &&other) noexcept
+            : config_(std::move(other.config_)), rings_{std::move(other.rings_[0]), std::move(other.rings_[1])},
+              closed_(other.closed_.load()), peeked_(other.peeked_) {
+            for (size_t i = 0; i < 2; ++i) {
+                queued_[i].store(other.queued_[i].load());
+                dropped_[i].store(other.dropped_[i].load());
+            }
+        }
+
+        ObserverQueue &operator=(ObserverQueue &&) = delete;
+        ObserverQueue(const ObserverQueue &) = delete;
+        ObserverQueue &operator=(const ObserverQueue &) = delete;
+
+        /// Copy a frame into the queue of its direction (producer side, never blocks)
+        /// Call from at most one thread per direction.
+        /// @param view Frame (payload_len/meta_len are taken from the spans)
+        /// @param direction Inbound or Outbound
+        /// @param capture_ns Capture time
+        /// @return false if the frame was dropped (queue full) or not wanted (direction, closed)
+        inline bool push(const FrameView &view, CaptureDirection direction, TimeNs capture_ns) {
+            if (!wants(direction)) {
+                return false;
+            }
+            size_t side = index(direction);
+            FrameRing &ring = rings_[side];
+            size_t frame_size = sizeof(FrameHeader) + view.payload.size() + sizeof(TimeNs) + view.meta.size();
+            size_t record_size = (sizeof(uint32_t) + frame_size + 7) & ~size_t(7);
+            // Twice the record covers a wrap-around skip; checked first so a full queue is a silent drop
+            if (ring.available() < 2 * record_size) {
+                bump(dropped_[side]);
+                return false;
+            }
+            auto span = ring.reserve(frame_size);
+            if (!span.is_ok()) {
+                bump(dropped_[side]);
+                return false;
+            }
+
+            FrameHeader header = view.header;
+            header.payload_len = static_cast<uint32_t>(view.payload.size());
+            header.meta_len = static_cast<uint32_t>(sizeof(TimeNs) + view.meta.size());
+            Byte *p = span.value().data();
+            std::memcpy(p, &header, sizeof(header));
+            p += sizeof(header);
+            if (!view.payload.empty()) {
+                std::memcpy(p, view.payload.data(), view.payload.size());
+            }
+            p += view.payload.size();
+            std::memcpy(p, &capture_ns, sizeof(capture_ns));
+            if (!view.meta.empty()) {
+                std::memcpy(p + sizeof(capture_ns), view.meta.data(), view.meta.size());
+            }
+            ring.commit();
+            bump(queued_[side]);
+            return true;
+        }
+
+        /// Look at the oldest queued frame of either direction (observer side)
+        /// The view stays valid until consume().
+        /// @return Result containing frame, or timeout if both directions are empty
+        inline Result<ObservedFrame, Error> peek() {
+            auto tx = rings_[0].peek();
+            auto rx = rings_[1].peek();
+            if (!tx.is_ok() && !rx.is_ok()) {
+                return Result<ObservedFrame, Error>::err(Error::timeout("Observer queue empty"));
+            }
+            ObservedFrame out_frame = tx.is_ok() ? unwrap(tx.value(), CaptureDirection::Outbound) : ObservedFrame{};
+            ObservedFrame in_frame = rx.is_ok() ? unwrap(rx.value(), CaptureDirection::Inbound) : ObservedFrame{};
+            bool take_tx = tx.is_ok() && (!rx.is_ok() || out_frame.capture_ns <= in_frame.capture_ns);
+            peeked_ = take_tx ? 0 : 1;
+            return Result<ObservedFrame, Error>::ok(take_tx ? out_frame : in_frame);
+        }
+
+        /// Release the frame returned by the last peek()
+        inline void consume() {
+            if (peeked_ >= 0) {
+                rings_[peeked_].consume();
+                peeked_ = -1;
+            }
+        }
+
+        /// Hand queued frames to a callback in capture order
+        /// @param fn Called as fn(const ObservedFrame &) for each frame
+        /// @param max_frames Most frames to take
+        /// @return Number of frames handed out
+        template <typename Fn> inline size_t drain(Fn &&fn, size_t max_frames = SIZE_MAX) {
+            size_t taken = 0;
+            while (taken < max_frames) {
+                auto frame = peek();
+                if (!frame.is_ok()) {
+                    break;
+                }
+                fn(static_cast<const ObservedFrame &>(frame.value()));
+                consume();
+                ++taken;
+            }
+            return taken;
+        }
+
+        /// Check whether a frame would be taken for a direction (configured and not closed)
+        inline bool wants(CaptureDirection direction) const {
+            if (closed_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            return direction == CaptureDirection::Outbound ? config_.tx : config_.rx;
+        }
+
+        /// Stop taking frames; those already queued can still be read
+        inline void close() { closed_.store(true, std::memory_order_release); }
+
+        /// Check whether close() was called
+        inline bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+        /// Check whether both directions are empty
+        inline bool empty() const { return rings_[0].empty() && rings_[1].empty(); }
+
+        /// Get the observer name
+        inline const String &name() const { return config_.name; }
+
+        /// Get a snapshot of the statistics of both directions
+        inline ObserverStats stats() const {
+            ObserverStats stats;
+            for (size_t i = 0; i < 2; ++i) {
+                stats.frames_queued += queued_[i].load(std::memory_order_relaxed);
+                stats.frames_dropped += dropped_[i].load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+        /// Reset the statistics; call while no frames are pushed (the producers own the counters)
+        inline void reset_stats() {
+            for (size_t i = 0; i < 2; ++i) {
+                queued_[i].store(0, std::memory_order_relaxed);
+                dropped_[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+      private:
+        ObserverConfig config_;
+        FrameRing rings_[2];                  ///< [0] outbound, [1] inbound
+        std::atomic<bool> closed_{false};
+        std::atomic<uint64_t> queued_[2] = {}; ///< Per direction, written by its producer only
+        std::atomic<uint64_t> dropped_[2] = {};
+        int peeked_ = -1;                     ///< Ring of the last peek() (-1 = none)
+
+        ObserverQueue(const ObserverConfig &config, FrameRing &&tx, FrameRing &&rx)
+            : config_(config), rings_{std::move(tx), std::move(rx)} {}
+
+        static inline size_t index(CaptureDirection direction) {
+            return direction == CaptureDirection::Outbound ? 0 : 1;
+        }
+
+        /// Helper: Increment a counter that only one thread writes (no read-modify-write needed)
+        static inline void bump(std::atomic<uint64_t> &counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /// Helper: Split a queue record into the observed frame and its capture time
+        static inline ObservedFrame unwrap(FrameView view, CaptureDirection direction) {
+            ObservedFrame frame;
+            std::memcpy(&frame.capture_ns, view.meta.data(), sizeof(frame.capture_ns));
+            view.meta = view.meta.subspan(sizeof(frame.capture_ns));
+            view.header.meta_len = static_cast<uint32_t>(view.meta.size());
+            frame.frame = view;
+            frame.direction = direction;
+            return frame;
+        }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,614 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wirebit/capture/observer_queue.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+
+namespace wirebit {
+
+    /// pcapng block types
+    constexpr uint32_t PCAPNG_SECTION_HEADER = 0x0A0D0D0A;
+    constexpr uint32_t PCAPNG_INTERFACE_DESCRIPTION = 0x00000001;
+    constexpr uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;
+    constexpr uint32_t PCAPNG_CUSTOM = 0x00000BAD; ///< Custom block, may be copied by editors
+
+    /// Section header byte-order magic as written by a host of the same endianness
+    constexpr uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+
+    /// pcap link types used for wirebit frames
+    constexpr uint16_t PCAP_LINKTYPE_ETHERNET = 1;       ///< FrameType::ETHERNET
+    constexpr uint16_t PCAP_LINKTYPE_RAW = 101;          ///< FrameType::IP (IPv4 or IPv6, no link header)
+    constexpr uint16_t PCAP_LINKTYPE_CAN_SOCKETCAN = 227; ///< FrameType::CAN (can_id in network byte order)
+
+    /// Enterprise number tagging wirebit custom blocks and options ('WBIT', not IANA-assigned; the frame
+    /// magic inside the data identifies them as well)
+    constexpr uint32_t PCAPNG_WIREBIT_PEN = 0x57424954;
+
+    /// pcapng option codes
+    constexpr uint16_t PCAPNG_OPT_END = 0;
+    constexpr uint16_t PCAPNG_OPT_CUSTOM_BINARY = 2989; ///< Custom binary option, may be copied
+    constexpr uint16_t PCAPNG_IF_TSRESOL = 9;
+    constexpr uint16_t PCAPNG_EPB_FLAGS = 2;
+
+    /// Get the pcap link type a frame type is captured as
+    /// @return Link type, or 0 if the frame goes into a wirebit custom block (SERIAL, unknown types)
+    inline uint16_t pcap_linktype(FrameType type) {
+        switch (type) {
+        case FrameType::CAN:
+            return PCAP_LINKTYPE_CAN_SOCKETCAN;
+        case FrameType::ETHERNET:
+            return PCAP_LINKTYPE_ETHERNET;
+        case FrameType::IP:
+            return PCAP_LINKTYPE_RAW;
+        default:
+            return 0;
+        }
+    }
+
+    namespace detail {
+        inline constexpr size_t pcapng_pad(size_t n) { return (n + 3) & ~size_t(3); }
+
+        inline Byte *pcapng_put32(Byte *p, uint32_t v) {
+            std::memcpy(p, &v, sizeof(v));
+            return p + sizeof(v);
+        }
+
+        inline Byte *pcapng_put16(Byte *p, uint16_t v) {
+            std::memcpy(p, &v, sizeof(v));
+            return p + sizeof(v);
+        }
+
+        inline uint32_t pcapng_get32(const Byte *p) {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint16_t pcapng_get16(const Byte *p) {
+            uint16_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        /// Copy bytes and zero-fill up to the next 32-bit boundary
+        inline Byte *pcapng_put_padded(Byte *p, const Byte *data, size_t n) {
+            if (n > 0) {
+                std::memcpy(p, data, n);
+            }
+            std::memset(p + n, 0, pcapng_pad(n) - n);
+            return p + pcapng_pad(n);
+        }
+
+        /// SocketCAN pcaps store can_id big-endian; wirebit CAN payloads hold it in host order
+        inline void swap_can_id(Byte *payload, size_t size) {
+            if (size >= sizeof(uint32_t)) {
+                uint32_t id = pcapng_get32(payload);
+                pcapng_put32(payload, __builtin_bswap32(id));
+            }
+        }
+
+        /// Convert a pcapng timestamp to nanoseconds
+        /// @param ts Timestamp in units of if_tsresol
+        /// @param tsresol if_tsresol value (bit 7 set: negative power of 2, else of 10)
+        inline TimeNs pcapng_ts_to_ns(uint64_t ts, uint8_t tsresol) {
+            unsigned exp = tsresol & 0x7F;
+            if (tsresol & 0x80) {
+                auto ns = (static_cast<detail::uint128>(ts) * 1000000000u) >> (exp > 127 ? 127 : exp);
+                return static_cast<TimeNs>(ns);
+            }
+            uint64_t scale = 1;
+            for (unsigned i = exp; i < 9; ++i) {
+                scale *= 10;
+            }
+            for (unsigned i = 9; i < exp && ts != 0; ++i) {
+                ts /= 10;
+            }
+            return static_cast<TimeNs>(ts * scale);
+        }
+    } // namespace detail
+
+    /// Append-only pcapng file writer
+    ///
+    /// Blocks are written straight into a shared mapping of the file, which is grown (ftruncate
+    /// plus mremap) grow_bytes at a time, so a frame costs no syscall most of the time. CAN,
+    /// Ethernet and IP frames become Enhanced Packet Blocks on an interface of the matching link
+    /// type (readable by Wireshark and tcpdump), carrying the direction in epb_flags and the
+    /// wirebit header (FRAME_HEADER_V2) plus metadata in a custom option. Serial and other frame
+    /// types go into wirebit custom blocks. Timestamps have nanosecond resolution.
+    ///
+    /// close() trims the file to the written size. A capture cut short by a crash is readable up
+    /// to the last complete block (the zero-filled tail ends the file).
+    class PcapngWriter {
+      public:
+        static constexpr size_t DEFAULT_GROW_BYTES = 16 << 20; ///< File growth step
+
+        /// Create (or truncate) a capture file and write its section header
+        /// @param path File path
+        /// @param grow_bytes File growth step
+        /// @return Result containing writer or io_error
+        static Result<PcapngWriter, Error> create(const String &path, size_t grow_bytes = DEFAULT_GROW_BYTES) {
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                echo::error("Failed to create capture file ", path.c_str(), ": ", strerror(errno)).red();
+                return Result<PcapngWriter, Error>::err(Error::io_error("Failed to create capture file"));
+            }
+            PcapngWriter writer(fd, grow_bytes < 4096 ? 4096 : grow_bytes);
+
+            Byte *p = writer.claim(28);
+            if (p == nullptr) {
+                return Result<PcapngWriter, Error>::err(Error::io_error("Failed to map capture file"));
+            }
+            p = detail::pcapng_put32(p, PCAPNG_SECTION_HEADER);
+            p = detail::pcapng_put32(p, 28);
+            p = detail::pcapng_put32(p, PCAPNG_BYTE_ORDER_MAGIC);
+            p = detail::pcapng_put16(p, 1); // Version 1.0
+            p = detail::pcapng_put16(p, 0);
+            p = detail::pcapng_put32(p, 0xFFFFFFFF); // Section length unknown (-1)
+            p = detail::pcapng_put32(p, 0xFFFFFFFF);
+            detail::pcapng_put32(p, 28);
+
+            WIREBIT_DEBUG("Capture file created: ", path.c_str());
+            return Result<PcapngWriter, Error>::ok(std::move(writer));
+        }
+
+        ~PcapngWriter() { close(); }
+
+        PcapngWriter(PcapngWriter &&other) noexcept
+            : fd_(other.fd_), map_(other.map_), mapped_(other.mapped_), size_(other.size_),
+              grow_bytes_(other.grow_bytes_), interfaces_(std::move(other.interfaces_)) {
+            other.fd_ = -1;
+            other.map_ = nullptr;
+        }
+
+        PcapngWriter &operator=(PcapngWriter &&other) noexcept {
+            if (this != &other) {
+                close();
+                fd_ = other.fd_;
+                map_ = other.map_;
+                mapped_ = other.mapped_;
+                size_ = other.size_;
+                grow_bytes_ = other.grow_bytes_;
+                interfaces_ = std::move(other.interfaces_);
+                other.fd_ = -1;
+                other.map_ = nullptr;
+            }
+            return *this;
+        }
+
+        PcapngWriter(const PcapngWriter &) = delete;
+        PcapngWriter &operator=(const PcapngWriter &) = delete;
+
+        /// Append one frame
+        /// @param frame Frame to record (header, payload and metadata)
+        /// @param capture_ns Capture time (the block timestamp)
+        /// @param direction Direction recorded in epb_flags
+        /// @return Result indicating success, or io_error if the file cannot grow
+        Result<Unit, Error> write(const FrameView &frame, TimeNs capture_ns, CaptureDirection direction) {
+            FrameHeader header = frame.header;
+            header.payload_len = static_cast<uint32_t>(frame.payload.size());
+            header.meta_len = static_cast<uint32_t>(frame.meta.size());
+            Byte compact[FRAME_HEADER_V2_MAX];
+            size_t compact_len = encode_frame_header(header, 0, compact);
+            uint64_t ts = static_cast<uint64_t>(capture_ns);
+
+            uint16_t linktype = pcap_linktype(frame.type());
+            if (linktype == 0) {
+                // [PEN][capture ns:8][epb_flags:4][v2 header][payload][meta]
+                size_t data_len = 16 + compact_len + frame.payload.size() + frame.meta.size();
+                uint32_t total = static_cast<uint32_t>(12 + detail::pcapng_pad(data_len));
+                Byte *p = claim(total);
+                if (p == nullptr) {
+                    return Result<Unit, Error>::err(Error::io_error("Capture file full"));
+                }
+                p = detail::pcapng_put32(p, PCAPNG_CUSTOM);
+                p = detail::pcapng_put32(p, total);
+                Byte *data = p;
+                p = detail::pcapng_put32(p, PCAPNG_WIREBIT_PEN);
+                std::memcpy(p, &ts, sizeof(ts));
+                p = detail::pcapng_put32(p + sizeof(ts), static_cast<uint32_t>(direction));
+                std::memcpy(p, compact, compact_len);
+                p += compact_len;
+                if (!frame.payload.empty()) {
+                    std::memcpy(p, frame.payload.data(), frame.payload.size());
+                }
+                p += frame.payload.size();
+                p = detail::pcapng_put_padded(p, frame.meta.data(), frame.meta.size());
+                p = data + detail::pcapng_pad(data_len);
+                detail::pcapng_put32(p, total);
+                return Result<Unit, Error>::ok(Unit{});
+            }
+
+            int64_t interface = interface_for(linktype);
+            if (interface < 0) {
+                return Result<Unit, Error>::err(Error::io_error("Capture file full"));
+            }
+
+            size_t caplen = frame.payload.size();
+            size_t custom_len = sizeof(uint32_t) + compact_len + frame.meta.size();
+            uint32_t total =
+                static_cast<uint32_t>(32 + detail::pcapng_pad(caplen) + 8 + 4 + detail::pcapng_pad(custom_len) + 4);
+            Byte *p = claim(total);
+            if (p == nullptr) {
+                return Result<Unit, Error>::err(Error::io_error("Capture file full"));
+            }
+            p = detail::pcapng_put32(p, PCAPNG_ENHANCED_PACKET);
+            p = detail::pcapng_put32(p, total);
+            p = detail::pcapng_put32(p, static_cast<uint32_t>(interface));
+            p = detail::pcapng_put32(p, static_cast<uint32_t>(ts >> 32));
+            p = detail::pcapng_put32(p, static_cast<uint32_t>(ts));
+            p = detail::pcapng_put32(p, static_cast<uint32_t>(caplen));
+            p = detail::pcapng_put32(p, static_cast<uint32_t>(caplen));
+            Byte *packet = p;
+            p = detail::pcapng_put_padded(p, frame.payload.data(), caplen);
+            if (linktype == PCAP_LINKTYPE_CAN_SOCKETCAN) {
+                detail::swap_can_id(packet, caplen);
+            }
+
+            p = detail::pcapng_put16(p, PCAPNG_EPB_FLAGS);
+            p = detail::pcapng_put16(p, 4);
+            p = detail::pcapng_put32(p, static_cast<uint32_t>(direction));
+            p = detail::pcapng_put16(p, PCAPNG_OPT_CUSTOM_BINARY);
+            p = detail::pcapng_put16(p, static_cast<uint16_t>(custom_len));
+            Byte *custom = p;
+            p = detail::pcapng_put32(p, PCAPNG_WIREBIT_PEN);
+            std::memcpy(p, compact, compact_len);
+            p = detail::pcapng_put_padded(p + compact_len, frame.meta.data(), frame.meta.size());
+            p = custom + detail::pcapng_pad(custom_len);
+            std::memset(custom + custom_len, 0, detail::pcapng_pad(custom_len) - custom_len);
+            p = detail::pcapng_put32(p, 0); // opt_endofopt
+            detail::pcapng_put32(p, total);
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Trim the file to its contents and close it (also done by the destructor)
+        inline void close() {
+            if (fd_ < 0) {
+                return;
+            }
+            if (map_ != nullptr) {
+                munmap(map_, mapped_);
+                map_ = nullptr;
+            }
+            if (ftruncate(fd_, static_cast<off_t>(size_)) < 0) {
+                echo::warn("Failed to trim capture file: ", strerror(errno)).yellow();
+            }
+            ::close(fd_);
+            fd_ = -1;
+        }
+
+        /// Check whether the file is open
+        inline bool is_open() const { return fd_ >= 0; }
+
+        /// Get the number of bytes written so far
+        inline size_t size() const { return size_; }
+
+      private:
+        int fd_ = -1;
+        Byte *map_ = nullptr;        ///< Shared mapping of [0, mapped_)
+        size_t mapped_ = 0;          ///< Mapped (and allocated) file size
+        size_t size_ = 0;            ///< Bytes written
+        size_t grow_bytes_;          ///< File growth step
+        Vector<uint16_t> interfaces_; ///< Link type of each interface description written
+
+        PcapngWriter(int fd, size_t grow_bytes) : fd_(fd), grow_bytes_(grow_bytes) {}
+
+        /// Helper: Reserve n bytes at the end of the file, growing the mapping if needed
+        /// @return Pointer to the bytes, or nullptr if the file cannot grow
+        inline Byte *claim(size_t n) {
+            if (fd_ < 0) {
+                return nullptr;
+            }
+            if (size_ + n > mapped_) {
+                size_t want = ((size_ + n + grow_bytes_ - 1) / grow_bytes_) * grow_bytes_;
+                if (ftruncate(fd_, static_cast<off_t>(want)) < 0) {
+                    echo::error("Failed to grow capture file: ", strerror(errno)).red();
+                    return nullptr;
+                }
+                void *mem = map_ == nullptr ? mmap(nullptr, want, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)
+                                            : mremap(map_, mapped_, want, MREMAP_MAYMOVE);
+                if (mem == MAP_FAILED) {
+                    echo::error("Failed to map capture file: ", strerror(errno)).red();
+                    return nullptr;
+                }
+                map_ = static_cast<Byte *>(mem);
+                mapped_ = want;
+            }
+            Byte *p = map_ + size_;
+            size_ += n;
+            return p;
+        }
+
+        /// Helper: Get the interface of a link type, writing its description on first use
+        /// @return Interface ID, or -1 if the file cannot grow
+        inline int64_t interface_for(uint16_t linktype) {
+            for (size_t i = 0; i < interfaces_.size(); ++i) {
+                if (interfaces_[i] == linktype) {
+                    return static_cast<int64_t>(i);
+                }
+            }
+            Byte *p = claim(32);
+            if (p == nullptr) {
+                return -1;
+            }
+            p = detail::pcapng_put32(p, PCAPNG_INTERFACE_DESCRIPTION);
+            p = detail::pcapng_put32(p, 32);
+            p = detail::pcapng_put16(p, linktype);
+            p = detail::pcapng_put16(p, 0);
+            p = detail::pcapng_put32(p, 0); // No snap length limit
+            p = detail::pcapng_put16(p, PCAPNG_IF_TSRESOL);
+            p = detail::pcapng_put16(p, 1);
+            p = detail::pcapng_put32(p, 9); // Nanoseconds (value byte, then padding)
+            p = detail::pcapng_put32(p, 0); // opt_endofopt
+            detail::pcapng_put32(p, 32);
+            interfaces_.push_back(linktype);
+            return static_cast<int64_t>(interfaces_.size() - 1);
+        }
+    };
+
+    /// One frame read back from a capture
+    struct PcapngRecord {
+        FrameView frame;                                   ///< Frame; spans point into the reader
+        TimeNs capture_ns = 0;                             ///< Block timestamp
+        CaptureDirection direction = CaptureDirection::Unknown; ///< From epb_flags
+        bool wirebit_header = false; ///< frame.header came from the file (else only type and tx time are set)
+    };
+
+    /// Sequential pcapng reader over a read-only mapping of the file
+    ///
+    /// Reads what PcapngWriter writes, plus captures from other tools on Ethernet, raw IP and
+    /// SocketCAN interfaces (those frames get a header holding only the type, with tx_timestamp_ns
+    /// set to the capture time). Blocks of other types and packets on other link types are skipped.
+    /// Only captures written on a host of the same byte order are supported.
+    class PcapngReader {
+      public:
+        /// Map a capture file
+        /// @param path File path
+        /// @return Result containing reader, not_found, or invalid_argument if it is not pcapng
+        static Result<PcapngReader, Error> create(const String &path) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                echo::error("Failed to open capture file ", path.c_str(), ": ", strerror(errno)).red();
+                return Result<PcapngReader, Error>::err(Error::not_found("Capture file does not exist"));
+            }
+            struct stat st;
+            if (fstat(fd, &st) < 0 || st.st_size < 28) {
+                ::close(fd);
+                return Result<PcapngReader, Error>::err(Error::invalid_argument("Capture file too small"));
+            }
+            size_t size = static_cast<size_t>(st.st_size);
+            void *mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map capture file ", path.c_str(), ": ", strerror(errno)).red();
+                return Result<PcapngReader, Error>::err(Error::io_error("mmap() failed"));
+            }
+
+            PcapngReader reader(static_cast<const Byte *>(mem), size);
+            if (detail::pcapng_get32(reader.map_) != PCAPNG_SECTION_HEADER ||
+                detail::pcapng_get32(reader.map_ + 8) != PCAPNG_BYTE_ORDER_MAGIC) {
+                echo::error("Not a pcapng capture in host byte order: ", path.c_str()).red();
+                return Result<PcapngReader, Error>::err(Error::invalid_argument("Not a pcapng file"));
+            }
+            madvise(mem, size, MADV_SEQUENTIAL);
+            return Result<PcapngReader, Error>::ok(std::move(reader));
+        }
+
+        ~PcapngReader() { release(); }
+
+        PcapngReader(PcapngReader &&other) noexcept
+            : map_(other.map_), size_(other.size_), offset_(other.offset_), interfaces_(std::move(other.interfaces_)),
+              scratch_(std::move(other.scratch_)), skipped_(other.skipped_) {
+            other.map_ = nullptr;
+        }
+
+        PcapngReader &operator=(PcapngReader &&other) noexcept {
+            if (this != &other) {
+                release();
+                map_ = other.map_;
+                size_ = other.size_;
+                offset_ = other.offset_;
+                interfaces_ = std::move(other.interfaces_);
+                scratch_ = std::move(other.scratch_);
+                skipped_ = other.skipped_;
+                other.map_ = nullptr;
+            }
+            return *this;
+        }
+
+        PcapngReader(const PcapngReader &) = delete;
+        PcapngReader &operator=(const PcapngReader &) = delete;
+
+        /// Read the next frame
+        /// The record's spans stay valid until the next call (CAN payloads are byte-swapped into a
+        /// scratch buffer, everything else points into the mapping).
+        /// @param record Output record
+        /// @return false at the end of the capture (or at a truncated block)
+        inline bool next(PcapngRecord &record) {
+            while (size_ - offset_ >= 12) {
+                const Byte *block = map_ + offset_;
+                uint32_t type = detail::pcapng_get32(block);
+                uint32_t len = detail::pcapng_get32(block + 4);
+                if (len < 12 || (len & 3) != 0 || len > size_ - offset_) {
+                    return false; // Zero-filled tail of an unfinished capture, or corruption
+                }
+                offset_ += len;
+
+                bool ok = false;
+                if (type == PCAPNG_SECTION_HEADER) {
+                    interfaces_.clear();
+                } else if (type == PCAPNG_INTERFACE_DESCRIPTION) {
+                    read_interface(block, len);
+                } else if (type == PCAPNG_ENHANCED_PACKET) {
+                    ok = read_packet(block, len, record);
+                } else if (type == PCAPNG_CUSTOM) {
+                    ok = read_custom(block, len, record);
+                } else {
+                    skipped_++;
+                }
+                if (ok) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Start over from the first block
+        inline void rewind() {
+            offset_ = 0;
+            interfaces_.clear();
+        }
+
+        /// Get the file size
+        inline size_t size() const { return size_; }
+
+        /// Get the number of blocks skipped (unsupported types or link types, malformed packets)
+        inline uint64_t skipped() const { return skipped_; }
+
+      private:
+        /// Interface description: link type and timestamp resolution
+        struct Interface {
+            uint16_t linktype;
+            uint8_t tsresol;
+        };
+
+        const Byte *map_ = nullptr;
+        size_t size_ = 0;
+        size_t offset_ = 0;             ///< Next block
+        Vector<Interface> interfaces_;  ///< Interfaces of the current section
+        Bytes scratch_;                 ///< Byte-swapped CAN payload
+        uint64_t skipped_ = 0;
+
+        PcapngReader(const Byte *map, size_t size) : map_(map), size_(size) {}
+
+        inline void release() {
+            if (map_ != nullptr) {
+                munmap(const_cast<Byte *>(map_), size_);
+                map_ = nullptr;
+            }
+        }
+
+        inline void read_interface(const Byte *block, uint32_t len) {
+            Interface iface{len >= 20 ? detail::pcapng_get16(block + 8) : uint16_t(0), 6};
+            for (size_t off = 16; off + 4 <= len - 4;) {
+                uint16_t code = detail::pcapng_get16(block + off);
+                uint16_t opt_len = detail::pcapng_get16(block + off + 2);
+                if (code == PCAPNG_OPT_END || off + 4 + opt_len > len - 4) {
+                    break;
+                }
+                if (code == PCAPNG_IF_TSRESOL && opt_len >= 1) {
+                    iface.tsresol = block[off + 4];
+                }
+                off += 4 + detail::pcapng_pad(opt_len);
+            }
+            interfaces_.push_back(iface);
+        }
+
+        /// Helper: Parse a wirebit [v2 header][meta] (after the PEN); payload comes from the packet
+        static inline bool read_wirebit_header(const Byte *data, size_t size, size_t payload_size,
+                                               PcapngRecord &record) {
+            FrameHeader header;
+            size_t header_len = 0;
+            if (detail::parse_frame_header(data, size, header, header_len, 0) != detail::HeaderParse::Ok ||
+                header.payload_len != payload_size || header_len + header.meta_len > size) {
+                return false;
+            }
+            record.frame.header = header;
+            record.frame.meta = std::span<const Byte>(data + header_len, header.meta_len);
+            record.wirebit_header = true;
+            return true;
+        }
+
+        inline bool read_packet(const Byte *block, uint32_t len, PcapngRecord &record) {
+            uint32_t interface = len >= 32 ? detail::pcapng_get32(block + 8) : UINT32_MAX;
+            uint32_t caplen = len >= 32 ? detail::pcapng_get32(block + 20) : 0;
+            if (interface >= interfaces_.size() || 32 + detail::pcapng_pad(caplen) > len) {
+                skipped_++;
+                return false;
+            }
+            const Interface &iface = interfaces_[interface];
+            FrameType type;
+            if (iface.linktype == PCAP_LINKTYPE_CAN_SOCKETCAN) {
+                type = FrameType::CAN;
+            } else if (iface.linktype == PCAP_LINKTYPE_ETHERNET) {
+                type = FrameType::ETHERNET;
+            } else if (iface.linktype == PCAP_LINKTYPE_RAW) {
+                type = FrameType::IP;
+            } else {
+                skipped_++;
+                return false;
+            }
+
+            uint64_t ts = (static_cast<uint64_t>(detail::pcapng_get32(block + 12)) << 32) |
+                          detail::pcapng_get32(block + 16);
+            record = PcapngRecord{};
+            record.capture_ns = detail::pcapng_ts_to_ns(ts, iface.tsresol);
+            const Byte *payload = block + 28;
+            if (type == FrameType::CAN) {
+                scratch_.assign(payload, payload + caplen);
+                detail::swap_can_id(scratch_.data(), caplen);
+                payload = scratch_.data();
+            }
+            record.frame.payload = std::span<const Byte>(payload, caplen);
+
+            for (size_t off = 28 + detail::pcapng_pad(caplen); off + 4 <= len - 4;) {
+                uint16_t code = detail::pcapng_get16(block + off);
+                uint16_t opt_len = detail::pcapng_get16(block + off + 2);
+                if (code == PCAPNG_OPT_END || off + 4 + opt_len > len - 4) {
+                    break;
+                }
+                const Byte *value = block + off + 4;
+                if (code == PCAPNG_EPB_FLAGS && opt_len >= 4) {
+                    record.direction = static_cast<CaptureDirection>(detail::pcapng_get32(value) & 3);
+                } else if (code == PCAPNG_OPT_CUSTOM_BINARY && opt_len >= 4 &&
+                           detail::pcapng_get32(value) == PCAPNG_WIREBIT_PEN) {
+                    read_wirebit_header(value + 4, opt_len - 4, caplen, record);
+                }
+                off += 4 + detail::pcapng_pad(opt_len);
+            }
+            if (!record.wirebit_header) {
+                record.frame.header = FrameHeader();
+                record.frame.header.frame_type = static_cast<uint16_t>(type);
+                record.frame.header.tx_timestamp_ns = static_cast<uint64_t>(record.capture_ns);
+                record.frame.header.payload_len = caplen;
+            }
+            return true;
+        }
+
+        inline bool read_custom(const Byte *block, uint32_t len, PcapngRecord &record) {
+            // [type][len][PEN][capture ns:8][flags:4][v2 header][payload][meta]...[len]
+            if (len < 12 + 16 || detail::pcapng_get32(block + 8) != PCAPNG_WIREBIT_PEN) {
+                skipped_++;
+                return false;
+            }
+            const Byte *data = block + 24;
+            size_t size = len - 28;
+            FrameHeader header;
+            size_t header_len = 0;
+            if (detail::parse_frame_header(data, size, header, header_len, 0) != detail::HeaderParse::Ok ||
+                header_len + static_cast<size_t>(header.payload_len) + header.meta_len > size) {
+                skipped_++;
+                return false;
+            }
+            uint64_t ts;
+            std::memcpy(&ts, block + 12, sizeof(ts));
+            record = PcapngRecord{};
+            record.capture_ns = static_cast<TimeNs>(ts);
+            record.direction = static_cast<CaptureDirection>(detail::pcapng_get32(block + 20) & 3);
+            record.frame.header = header;
+            record.frame.payload = std::span<const Byte>(data + header_len, header.payload_len);
+            record.frame.meta = std::span<const Byte>(data + header_len + header.payload_len, header.meta_len);
+            record.wirebit_header = true;
+            return true;
+        }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <echo/echo.hpp>
+#include <memory>
+#include <thread>
+#include <wirebit/capture/observer_queue.hpp>
+#include <wirebit/capture/pcapng.hpp>
+#include <wirebit/capture/tee_link.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Configuration for RecordingLink
+    struct RecordingConfig {
+        String path;                                                ///< Capture file (created or truncated)
+        size_t queue_bytes = 4 << 20;                               ///< Queue capacity per direction
+        size_t file_grow_bytes = PcapngWriter::DEFAULT_GROW_BYTES;  ///< Capture file growth step
+        uint64_t idle_sleep_ns = 100000;                            ///< Writer back-off while the queue is empty
+        bool record_tx = true;                                      ///< Record frames sent through the link
+        bool record_rx = true;                                      ///< Record frames received from the link
+    };
+
+    /// Statistics for RecordingLink
+    struct RecordingLinkStats {
+        uint64_t frames_recorded = 0; ///< Frames written to the capture file
+        uint64_t frames_dropped = 0;  ///< Frames not recorded because the queue was full
+        uint64_t write_errors = 0;    ///< Frames lost because the file could not grow
+        uint64_t bytes_written = 0;   ///< Capture file size
+
+        inline void reset() {
+            frames_recorded = 0;
+            frames_dropped = 0;
+            write_errors = 0;
+            bytes_written = 0;
+        }
+    };
+
+    namespace detail {
+        /// Queue and writer thread of a RecordingLink (on the heap so the link can move while recording)
+        struct RecordingState {
+            std::shared_ptr<ObserverQueue> queue; ///< Observer slot of the link
+            PcapngWriter writer;                  ///< Owned by the writer thread while it runs
+            std::atomic<bool> running{true};
+            std::atomic<uint64_t> frames_recorded{0};
+            std::atomic<uint64_t> write_errors{0};
+            std::atomic<uint64_t> bytes_written{0};
+            std::thread thread;
+
+            RecordingState(std::shared_ptr<ObserverQueue> observer, PcapngWriter &&file)
+                : queue(std::move(observer)), writer(std::move(file)) {}
+        };
+    } // namespace detail
+
+    /// Link decorator that records the traffic of another link into a pcapng capture
+    ///
+    /// A TeeLink whose first observer is drained by a background thread into a PcapngWriter: the
+    /// data path copies each frame sent or received successfully into the observer queue with its
+    /// capture time and never waits on the file. When the queue is full the frame is counted in
+    /// frames_dropped and is not recorded; the traffic itself is unaffected. More observers can be
+    /// added with add_observer() as on any TeeLink.
+    ///
+    /// The capture keeps the wirebit header and metadata of every frame (see PcapngWriter) and CAN,
+    /// Ethernet and IP traffic opens directly in Wireshark. Replay it with ReplayLink.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto link = RecordingLink::create(inner, {.path = "/tmp/bus.pcapng"}).value();
+    /// link.send(frame); // forwarded to inner and recorded as outbound
+    /// ...
+    /// link.close(); // drain the queue and trim the file
+    /// @endcode
+    class RecordingLink : public TeeLink {
+      public:
+        /// Start recording a link
+        /// @param inner Link to forward to
+        /// @param config Recording configuration
+        /// @return Result containing link, invalid_argument, or io_error if the file cannot be created
+        static Result<RecordingLink, Error> create(std::shared_ptr<Link> inner, const RecordingConfig &config) {
+            if (!inner) {
+                return Result<RecordingLink, Error>::err(Error::invalid_argument("Null inner link"));
+            }
+            RecordingLink link(std::move(inner), config);
+            ObserverConfig observer;
+            observer.name = "recording";
+            observer.queue_bytes = config.queue_bytes;
+            observer.tx = config.record_tx;
+            observer.rx = config.record_rx;
+            auto queue = link.add_observer(observer);
+            if (!queue.is_ok()) {
+                return Result<RecordingLink, Error>::err(queue.error());
+            }
+            auto writer = PcapngWriter::create(config.path, config.file_grow_bytes);
+            if (!writer.is_ok()) {
+                return Result<RecordingLink, Error>::err(writer.error());
+            }
+
+            link.state_ = std::make_unique<detail::RecordingState>(queue.value(), std::move(writer.value()));
+            detail::RecordingState *s = link.state_.get();
+            uint64_t idle_sleep_ns = config.idle_sleep_ns;
+            s->thread = std::thread([s, idle_sleep_ns]() { write_loop(*s, idle_sleep_ns); });
+
+            echo::info("Recording ", link.name().c_str(), " to ", config.path.c_str()).green();
+            return Result<RecordingLink, Error>::ok(std::move(link));
+        }
+
+        /// Destructor - drains the queue and closes the capture
+        ~RecordingLink() override { close(); }
+
+        RecordingLink(RecordingLink &&) noexcept = default;
+
+        RecordingLink &operator=(RecordingLink &&other) noexcept {
+            if (this != &other) {
+                close();
+                TeeLink::operator=(std::move(other));
+                config_ = std::move(other.config_);
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
+
+        RecordingLink(const RecordingLink &) = delete;
+        RecordingLink &operator=(const RecordingLink &) = delete;
+
+        /// Wait until every frame queued so far is in the capture file
+        inline void flush() const {
+            if (!recording()) {
+                return;
+            }
+            while (!state_->queue->empty()) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(config_.idle_sleep_ns));
+            }
+        }
+
+        /// Stop recording: drain the queue, join the writer and trim the file
+        /// Traffic keeps flowing through the link (and to other observers) afterwards.
+        inline void close() {
+            if (!recording()) {
+                return;
+            }
+            state_->queue->close();
+            state_->running.store(false, std::memory_order_release);
+            if (state_->thread.joinable()) {
+                state_->thread.join();
+            }
+            state_->writer.close();
+            WIREBIT_DEBUG("Recording closed: ", state_->frames_recorded.load(), " frames, ",
+                          state_->bytes_written.load(), " bytes");
+        }
+
+        /// Check whether frames are still being recorded
+        inline bool recording() const { return state_ && state_->running.load(std::memory_order_acquire); }
+
+        /// Get the capture file path
+        inline const String &path() const { return config_.path; }
+
+        /// Get a snapshot of the statistics (updated by the writer thread)
+        inline RecordingLinkStats stats() const {
+            RecordingLinkStats stats;
+            if (state_) {
+                stats.frames_recorded = state_->frames_recorded.load(std::memory_order_relaxed);
+                stats.frames_dropped = state_->queue->stats().frames_dropped;
+                stats.write_errors = state_->write_errors.load(std::memory_order_relaxed);
+                stats.bytes_written = state_->bytes_written.load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+        /// Reset the counters (the file size is kept); call while no frames pass
+        inline void reset_stats() {
+            if (state_) {
+                state_->queue->reset_stats();
+                state_->frames_recorded.store(0, std::memory_order_relaxed);
+                state_->write_errors.store(0, std::memory_order_relaxed);
+            }
+        }
+
+      private:
+        RecordingConfig config_;                        ///< Configuration
+        std::unique_ptr<detail::RecordingState> state_; ///< Queue and writer thread
+
+        RecordingLink(std::shared_ptr<Link> inner, const RecordingConfig &config)
+            : TeeLink(std::move(inner)), config_(config) {}
+
+        /// Writer thread: move queued frames into the file until stopped and drained
+        static void write_loop(detail::RecordingState &state, uint64_t idle_sleep_ns) {
+            while (true) {
+                bool stopping = !state.running.load(std::memory_order_acquire);
+                auto observed = state.queue->peek();
+                if (!observed.is_ok()) {
+                    if (stopping) {
+                        return;
+                    }
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(idle_sleep_ns));
+                    continue;
+                }
+
+                const ObservedFrame &frame = observed.value();
+                auto written = state.writer.write(frame.frame, frame.capture_ns, frame.direction);
+                state.queue->consume();
+                if (written.is_ok()) {
+                    state.frames_recorded.fetch_add(1, std::memory_order_relaxed);
+                    state.bytes_written.store(state.writer.size(), std::memory_order_relaxed);
+                } else {
+                    state.write_errors.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+} // namespace wirebit
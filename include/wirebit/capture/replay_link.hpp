@@ -0,0 +1,206 @@
+#pragma once
+
+#include <echo/echo.hpp>
+#include <wirebit/capture/pcapng.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/link.hpp>
+
+namespace wirebit {
+
+    /// Configuration for ReplayLink
+    struct ReplayConfig {
+        String path;            ///< Capture file
+        double speed = 1.0;     ///< Playback rate (2.0 = twice as fast); 0 = flat out, ignoring capture times
+        bool inbound = true;    ///< Replay frames recorded as received
+        bool outbound = false;  ///< Replay frames recorded as sent
+        bool restamp = true;    ///< Move tx_timestamp_ns (and deliver_at_ns) to the replay time
+        bool loop = false;      ///< Start over at the end of the capture
+    };
+
+    /// Statistics for ReplayLink
+    struct ReplayLinkStats {
+        uint64_t frames_replayed = 0;  ///< Frames returned by recv()
+        uint64_t frames_filtered = 0;  ///< Captured frames skipped by direction
+        uint64_t frames_discarded = 0; ///< Frames passed to send() (a replay has no peer)
+        uint64_t loops = 0;            ///< Times the capture was restarted
+
+        inline void reset() {
+            frames_replayed = 0;
+            frames_filtered = 0;
+            frames_discarded = 0;
+            loops = 0;
+        }
+    };
+
+    /// Link that plays back a pcapng capture (from RecordingLink, or Ethernet/IP/SocketCAN captures
+    /// from other tools)
+    ///
+    /// The file is memory-mapped and frames are handed out as views into the mapping: a frame
+    /// captured at time t becomes receivable at start + (t - t_first) / speed, where start is the
+    /// time the link was created (or restart() was called) on now_ns(). Held frames are reported by
+    /// next_deadline(), so under a VirtualTimeLoop an hour-long capture replays with its original
+    /// timing in as long as it takes to move the frames. With speed 0 every frame is receivable
+    /// immediately.
+    ///
+    /// Frames recorded by RecordingLink come back with their original wirebit header and metadata;
+    /// with restamp (default) tx_timestamp_ns is moved to the replay time and deliver_at_ns keeps its
+    /// distance to it, so latency statistics and link-model timing on the replaying side stay
+    /// meaningful. send() discards frames, so the link can stand in for a peer that only talks.
+    class ReplayLink : public Link {
+      public:
+        /// Open a capture for replay
+        /// @param config Replay configuration
+        /// @return Result containing link, not_found, or invalid_argument (not pcapng, negative speed)
+        static Result<ReplayLink, Error> create(const ReplayConfig &config) {
+            if (!(config.speed >= 0.0)) {
+                return Result<ReplayLink, Error>::err(Error::invalid_argument("Replay speed must not be negative"));
+            }
+            auto reader = PcapngReader::create(config.path);
+            if (!reader.is_ok()) {
+                return Result<ReplayLink, Error>::err(reader.error());
+            }
+            ReplayLink link(config, std::move(reader.value()));
+            link.restart();
+            WIREBIT_DEBUG("Replaying ", config.path.c_str(), " at speed ", config.speed);
+            return Result<ReplayLink, Error>::ok(std::move(link));
+        }
+
+        ReplayLink(ReplayLink &&) noexcept = default;
+        ReplayLink &operator=(ReplayLink &&) noexcept = default;
+
+        ReplayLink(const ReplayLink &) = delete;
+        ReplayLink &operator=(const ReplayLink &) = delete;
+
+        Result<Unit, Error> send(const Frame &) override {
+            stats_.frames_discarded++;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        Result<Unit, Error> send_view(const FrameView &) override {
+            stats_.frames_discarded++;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        Result<Frame, Error> recv() override {
+            auto view = recv_view();
+            if (!view.is_ok()) {
+                return Result<Frame, Error>::err(view.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(view.value()));
+        }
+
+        /// Receive the next captured frame once it is due
+        /// The view stays valid until the next recv()/recv_view() call.
+        /// @return Result containing frame view, or timeout if the next frame is not due or the capture ended
+        Result<FrameView, Error> recv_view() override {
+            if (!pending_) {
+                load_next();
+            }
+            if (!pending_) {
+                return Result<FrameView, Error>::err(Error::timeout("Replay finished"));
+            }
+            TimeNs now = now_ns();
+            if (due_ns_ > now) {
+                return Result<FrameView, Error>::err(Error::timeout("No frame due yet"));
+            }
+
+            FrameView view = record_.frame;
+            if (record_.frame.type() == FrameType::CAN) {
+                // The reader swaps CAN IDs into a scratch buffer that the look-ahead below reuses
+                current_.assign(view.payload.begin(), view.payload.end());
+                view.payload = std::span<const Byte>(current_.data(), current_.size());
+            }
+            if (config_.restamp) {
+                TimeNs stamp = config_.speed > 0.0 ? due_ns_ : now;
+                uint64_t original = view.header.tx_timestamp_ns;
+                view.header.tx_timestamp_ns = static_cast<uint64_t>(stamp);
+                if (view.header.deliver_at_ns != 0 && original != 0) {
+                    view.header.deliver_at_ns += static_cast<uint64_t>(stamp) - original;
+                }
+            }
+            stats_.frames_replayed++;
+            record_rx(view.header);
+
+            pending_ = false;
+            load_next(); // Look ahead so next_deadline() knows when the following frame is due
+            return Result<FrameView, Error>::ok(view);
+        }
+
+        bool can_send() const override { return true; }
+
+        bool can_recv() const override { return pending_ && due_ns_ <= now_ns(); }
+
+        String name() const override { return "replay:" + config_.path; }
+
+        uint64_t next_deadline() const override { return pending_ ? static_cast<uint64_t>(due_ns_) : UINT64_MAX; }
+
+        /// Replay from the first frame, with timing starting now
+        inline void restart() {
+            reader_.rewind();
+            pending_ = false;
+            first_ns_ = -1;
+            start_ns_ = now_ns();
+            load_next();
+        }
+
+        /// Check whether every frame has been replayed (never true with loop)
+        inline bool finished() const { return !pending_; }
+
+        /// Get the underlying capture reader
+        inline const PcapngReader &reader() const { return reader_; }
+
+        /// Get replay statistics
+        inline const ReplayLinkStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        ReplayConfig config_;
+        PcapngReader reader_;
+        PcapngRecord record_;   ///< Next frame to hand out (valid while pending_)
+        Bytes current_;         ///< Payload of the last CAN frame handed out
+        bool pending_ = false;  ///< record_ holds a frame
+        TimeNs due_ns_ = 0;     ///< When record_ becomes receivable
+        TimeNs first_ns_ = -1;  ///< Capture time of the first frame of this pass (-1 = none yet)
+        TimeNs start_ns_ = 0;   ///< Replay time of the first frame of this pass
+        ReplayLinkStats stats_;
+
+        ReplayLink(const ReplayConfig &config, PcapngReader &&reader) : config_(config), reader_(std::move(reader)) {}
+
+        /// Helper: Read ahead to the next frame passing the direction filter and compute its due time
+        inline void load_next() {
+            while (!pending_) {
+                if (!reader_.next(record_)) {
+                    if (!config_.loop || first_ns_ < 0) {
+                        return;
+                    }
+                    // Next pass continues right where this one ended
+                    reader_.rewind();
+                    start_ns_ = due_ns_;
+                    first_ns_ = -1;
+                    stats_.loops++;
+                    continue;
+                }
+                bool wanted = record_.direction == CaptureDirection::Unknown ||
+                              (record_.direction == CaptureDirection::Inbound ? config_.inbound : config_.outbound);
+                if (!wanted) {
+                    stats_.frames_filtered++;
+                    continue;
+                }
+                if (first_ns_ < 0) {
+                    first_ns_ = record_.capture_ns;
+                }
+                due_ns_ = start_ns_;
+                if (config_.speed > 0.0) {
+                    double offset = static_cast<double>(record_.capture_ns - first_ns_) / config_.speed;
+                    due_ns_ += static_cast<TimeNs>(offset);
+                }
+                pending_ = true;
+            }
+        }
+    };
+
+} // namespace wirebit
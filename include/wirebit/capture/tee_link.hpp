@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <echo/echo.hpp>
+#include <memory>
+#include <wirebit/capture/observer_queue.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/link.hpp>
+
+namespace wirebit {
+
+    /// Link decorator that copies every frame it passes to observer queues
+    ///
+    /// Frames are forwarded to the inner link unchanged. Each frame sent or received successfully is
+    /// then pushed into every ObserverQueue that wants its direction; a full queue drops the copy
+    /// and counts it in that observer's stats, so a slow monitor never holds up send()/recv() or the
+    /// other observers. Observers read their queue from their own thread (one reader per queue).
+    ///
+    /// Observers can be added while traffic flows (from one thread at a time) and are retired with
+    /// ObserverQueue::close(); their slot is not reused.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto tee = TeeLink::create(link).value();
+    /// auto monitor = tee.add_observer({.name = "decoder", .tx = false}).value();
+    /// std::thread([monitor]() { while (true) { monitor->drain(decode); } }).detach();
+    /// tee.recv(); // forwarded, and a copy is queued for the monitor
+    /// @endcode
+    class TeeLink : public Link {
+      public:
+        static constexpr size_t MAX_OBSERVERS = 16; ///< Observer slots per link
+
+        /// Wrap a link
+        /// @param inner Link to forward to
+        /// @return Result containing link, or invalid_argument if inner is null
+        static Result<TeeLink, Error> create(std::shared_ptr<Link> inner) {
+            if (!inner) {
+                return Result<TeeLink, Error>::err(Error::invalid_argument("Null inner link"));
+            }
+            return Result<TeeLink, Error>::ok(TeeLink(std::move(inner)));
+        }
+
+        /// Move constructor (the source must not be in use)
+        TeeLink(TeeLink &&other) noexcept
+            : Link(std::move(other)), inner_(std::move(other.inner_)), observers_(std::move(other.observers_)),
+              observer_count_(other.observer_count_.load()) {
+            other.observer_count_.store(0);
+        }
+
+        /// Move assignment (neither side may be in use)
+        TeeLink &operator=(TeeLink &&other) noexcept {
+            if (this != &other) {
+                Link::operator=(std::move(other));
+                inner_ = std::move(other.inner_);
+                observers_ = std::move(other.observers_);
+                observer_count_.store(other.observer_count_.load());
+                other.observer_count_.store(0);
+            }
+            return *this;
+        }
+
+        TeeLink(const TeeLink &) = delete;
+        TeeLink &operator=(const TeeLink &) = delete;
+
+        /// Create an observer queue and start copying frames into it
+        /// @param config Observer configuration
+        /// @return Result containing the queue to read from, or invalid_argument if all slots are taken
+        Result<std::shared_ptr<ObserverQueue>, Error> add_observer(const ObserverConfig &config = {}) {
+            size_t count = observer_count_.load(std::memory_order_relaxed);
+            if (count >= MAX_OBSERVERS) {
+                echo::error("TeeLink ", name().c_str(), ": all ", MAX_OBSERVERS, " observer slots taken").red();
+                return Result<std::shared_ptr<ObserverQueue>, Error>::err(
+                    Error::invalid_argument("Too many observers"));
+            }
+            auto queue = ObserverQueue::create(config);
+            if (!queue.is_ok()) {
+                return Result<std::shared_ptr<ObserverQueue>, Error>::err(queue.error());
+            }
+            observers_[count] = std::make_shared<ObserverQueue>(std::move(queue.value()));
+            // Publish the slot after it is filled: the data path reads the count with acquire
+            observer_count_.store(count + 1, std::memory_order_release);
+            WIREBIT_DEBUG("TeeLink ", name().c_str(), ": observer ", config.name.c_str(), " added");
+            return Result<std::shared_ptr<ObserverQueue>, Error>::ok(observers_[count]);
+        }
+
+        /// Get the number of observers added (closed ones included)
+        inline size_t observer_count() const { return observer_count_.load(std::memory_order_acquire); }
+
+        /// Get an observer by index (< observer_count())
+        inline const std::shared_ptr<ObserverQueue> &observer(size_t index) const { return observers_[index]; }
+
+        Result<Unit, Error> send(const Frame &frame) override {
+            auto result = inner_->send(frame);
+            if (result.is_ok()) {
+                publish(make_view(frame), CaptureDirection::Outbound);
+            }
+            return result;
+        }
+
+        Result<Unit, Error> send_view(const FrameView &view) override {
+            auto result = inner_->send_view(view);
+            if (result.is_ok()) {
+                publish(view, CaptureDirection::Outbound);
+            }
+            return result;
+        }
+
+        Result<size_t, Error> send_batch(std::span<const Frame> frames) override {
+            auto result = inner_->send_batch(frames);
+            if (result.is_ok()) {
+                for (size_t i = 0; i < result.value(); ++i) {
+                    publish(make_view(frames[i]), CaptureDirection::Outbound);
+                }
+            }
+            return result;
+        }
+
+        Result<Frame, Error> recv() override {
+            auto result = inner_->recv();
+            if (result.is_ok()) {
+                publish(make_view(result.value()), CaptureDirection::Inbound);
+            }
+            return result;
+        }
+
+        Result<FrameView, Error> recv_view() override {
+            auto result = inner_->recv_view();
+            if (result.is_ok()) {
+                publish(result.value(), CaptureDirection::Inbound);
+            }
+            return result;
+        }
+
+        Result<size_t, Error> recv_batch(Vector<Frame> &frames, size_t max_frames) override {
+            size_t first = frames.size();
+            auto result = inner_->recv_batch(frames, max_frames);
+            if (result.is_ok()) {
+                for (size_t i = first; i < frames.size(); ++i) {
+                    publish(make_view(frames[i]), CaptureDirection::Inbound);
+                }
+            }
+            return result;
+        }
+
+        bool can_send() const override { return inner_->can_send(); }
+
+        bool can_recv() const override { return inner_->can_recv(); }
+
+        String name() const override { return inner_->name(); }
+
+        int poll_fd() const override { return inner_->poll_fd(); }
+
+        bool prepare_wait() override { return inner_->prepare_wait(); }
+
+        void finish_wait() override { inner_->finish_wait(); }
+
+        uint64_t next_deadline() const override { return inner_->next_deadline(); }
+
+        /// Get the wrapped link
+        inline Link &inner() { return *inner_; }
+
+        /// Get the frames dropped by all observers together
+        inline uint64_t frames_dropped() const {
+            uint64_t dropped = 0;
+            size_t count = observer_count();
+            for (size_t i = 0; i < count; ++i) {
+                dropped += observers_[i]->stats().frames_dropped;
+            }
+            return dropped;
+        }
+
+      protected:
+        std::shared_ptr<Link> inner_; ///< Forwarded link
+
+        explicit TeeLink(std::shared_ptr<Link> inner) : inner_(std::move(inner)) {}
+
+        /// Helper: Copy a frame into every observer that wants it (one clock read for all)
+        inline void publish(const FrameView &view, CaptureDirection direction) {
+            size_t count = observer_count_.load(std::memory_order_acquire);
+            TimeNs capture_ns = 0;
+            for (size_t i = 0; i < count; ++i) {
+                ObserverQueue &queue = *observers_[i];
+                if (!queue.wants(direction)) {
+                    continue;
+                }
+                if (capture_ns == 0) {
+                    capture_ns = now_ns();
+                }
+                queue.push(view, direction, capture_ns);
+            }
+        }
+
+      private:
+        std::array<std::shared_ptr<ObserverQueue>, MAX_OBSERVERS> observers_; ///< Slots [0, observer_count_)
+        std::atomic<size_t> observer_count_{0};                              ///< Published slots
+    };
+
+} // namespace wirebit
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <wirebit/common/types.hpp>
+
+#if !defined(WIREBIT_SIMD_DISABLED) && defined(__x86_64__)
+#define WIREBIT_CRC_X86 1
+#include <immintrin.h>
+#elif !defined(WIREBIT_SIMD_DISABLED) && defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define WIREBIT_CRC_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace wirebit {
+
+    namespace detail {
+        using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+        /// Build slicing-by-8 tables for a reflected 32-bit polynomial
+        constexpr CrcTables make_crc_tables(uint32_t poly) {
+            CrcTables t{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+                }
+                t[0][i] = crc;
+            }
+            for (size_t k = 1; k < 8; ++k) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+                }
+            }
+            return t;
+        }
+
+        inline constexpr CrcTables CRC32_TABLES = make_crc_tables(0xEDB88320);  ///< IEEE 802.3 (reflected)
+        inline constexpr CrcTables CRC32C_TABLES = make_crc_tables(0x82F63B78); ///< Castagnoli (reflected)
+
+        /// Portable table-driven update (8 bytes per step on little-endian hosts)
+        /// @param t Tables from make_crc_tables()
+        /// @param crc Raw CRC register (not inverted)
+        /// @return Updated register
+        inline uint32_t crc_slice8(const CrcTables &t, uint32_t crc, const Byte *p, size_t n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            while (n >= 8) {
+                uint32_t lo, hi;
+                std::memcpy(&lo, p, 4);
+                std::memcpy(&hi, p + 4, 4);
+                lo ^= crc;
+                crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                      t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+                p += 8;
+                n -= 8;
+            }
+#endif
+            while (n-- > 0) {
+                crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+#if defined(WIREBIT_CRC_X86)
+        /// CPU features checked once at first use
+        struct CrcCpu {
+            bool sse42;  ///< SSE4.2 crc32 instruction (CRC32C)
+            bool pclmul; ///< Carry-less multiply (CRC32 folding)
+        };
+
+        inline const CrcCpu &crc_cpu() {
+            static const CrcCpu cpu = {__builtin_cpu_supports("sse4.2") != 0,
+                                       __builtin_cpu_supports("pclmul") != 0 && __builtin_cpu_supports("sse4.1") != 0};
+            return cpu;
+        }
+
+        /// CRC32C with the SSE4.2 crc32 instruction (8 bytes per instruction)
+        __attribute__((target("sse4.2"))) inline uint32_t crc32c_sse42(uint32_t crc, const Byte *p, size_t n) {
+            uint64_t c = crc;
+            while (n >= 8) {
+                uint64_t v;
+                std::memcpy(&v, p, 8);
+                c = _mm_crc32_u64(c, v);
+                p += 8;
+                n -= 8;
+            }
+            uint32_t c32 = static_cast<uint32_t>(c);
+            while (n-- > 0) {
+                c32 = _mm_crc32_u8(c32, *p++);
+            }
+            return c32;
+        }
+
+        /// Fold one 128-bit lane forward over 2x64 bits and add the next block
+        __attribute__((target("pclmul,sse4.1"))) inline __m128i crc_fold(__m128i x, __m128i next, __m128i k) {
+            return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)),
+                                 next);
+        }
+
+        /// IEEE CRC32 by carry-less multiply folding, 64 bytes per iteration
+        /// (Gopal et al., "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ"; constants for the
+        /// reflected 0x04C11DB7 polynomial). Requires n >= 64; the tail below 16 bytes goes through the tables.
+        __attribute__((target("pclmul,sse4.1"))) inline uint32_t crc32_pclmul(uint32_t crc, const Byte *p, size_t n) {
+            const __m128i k1k2 = _mm_set_epi64x(0x1C6E41596, 0x154442BD4);
+            const __m128i k3k4 = _mm_set_epi64x(0x0CCAA009E, 0x1751997D0);
+            const __m128i k5 = _mm_set_epi64x(0, 0x163CD6124);
+            const __m128i poly_mu = _mm_set_epi64x(0x1F7011641, 0x1DB710641);
+            const __m128i mask32 = _mm_set_epi32(0, 0, 0, -1);
+
+            auto load = [](const Byte *at) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(at)); };
+            __m128i x0 = _mm_xor_si128(load(p), _mm_cvtsi32_si128(static_cast<int>(crc)));
+            __m128i x1 = load(p + 16);
+            __m128i x2 = load(p + 32);
+            __m128i x3 = load(p + 48);
+            p += 64;
+            n -= 64;
+
+            while (n >= 64) {
+                x0 = crc_fold(x0, load(p), k1k2);
+                x1 = crc_fold(x1, load(p + 16), k1k2);
+                x2 = crc_fold(x2, load(p + 32), k1k2);
+                x3 = crc_fold(x3, load(p + 48), k1k2);
+                p += 64;
+                n -= 64;
+            }
+
+            // Four lanes down to one, then any remaining whole blocks
+            __m128i x = crc_fold(x0, x1, k3k4);
+            x = crc_fold(x, x2, k3k4);
+            x = crc_fold(x, x3, k3k4);
+            while (n >= 16) {
+                x = crc_fold(x, load(p), k3k4);
+                p += 16;
+                n -= 16;
+            }
+
+            // 128 -> 64 -> 32 bits, then Barrett reduction
+            x = _mm_xor_si128(_mm_clmulepi64_si128(x, k3k4, 0x10), _mm_srli_si128(x, 8));
+            x = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x, mask32), k5, 0x00), _mm_srli_si128(x, 4));
+            __m128i t = _mm_clmulepi64_si128(_mm_and_si128(x, mask32), poly_mu, 0x10);
+            t = _mm_clmulepi64_si128(_mm_and_si128(t, mask32), poly_mu, 0x00);
+            crc = static_cast<uint32_t>(_mm_extract_epi32(_mm_xor_si128(x, t), 1));
+
+            return crc_slice8(CRC32_TABLES, crc, p, n);
+        }
+#endif
+
+#if defined(WIREBIT_CRC_ARM)
+        /// CRC32 / CRC32C with the ARMv8 CRC instructions (8 bytes per instruction)
+        template <bool Castagnoli> inline uint32_t crc_armv8(uint32_t crc, const Byte *p, size_t n) {
+            while (n >= 8) {
+                uint64_t v;
+                std::memcpy(&v, p, 8);
+                crc = Castagnoli ? __crc32cd(crc, v) : __crc32d(crc, v);
+                p += 8;
+                n -= 8;
+            }
+            while (n-- > 0) {
+                crc = Castagnoli ? __crc32cb(crc, *p) : __crc32b(crc, *p);
+                ++p;
+            }
+            return crc;
+        }
+#endif
+    } // namespace detail
+
+    /// Compute (or continue) an IEEE 802.3 CRC32, as used by the Ethernet FCS, zlib and PNG
+    /// Uses PCLMULQDQ folding on x86-64 or the ARMv8 CRC instructions when the CPU has them
+    /// (unless built with WIREBIT_ENABLE_SIMD=OFF), otherwise slicing-by-8 tables.
+    /// @param data Bytes to checksum
+    /// @param n Number of bytes
+    /// @param crc Result of a previous call to continue from (0 to start)
+    /// @return CRC32 of all bytes so far (check value for "123456789": 0xCBF43926)
+    inline uint32_t crc32(const Byte *data, size_t n, uint32_t crc = 0) {
+        crc = ~crc;
+#if defined(WIREBIT_CRC_X86)
+        if (n >= 64 && detail::crc_cpu().pclmul) {
+            return ~detail::crc32_pclmul(crc, data, n);
+        }
+#elif defined(WIREBIT_CRC_ARM)
+        return ~detail::crc_armv8<false>(crc, data, n);
+#endif
+        return ~detail::crc_slice8(detail::CRC32_TABLES, crc, data, n);
+    }
+
+    /// Compute (or continue) an IEEE 802.3 CRC32
+    /// @param data Bytes to checksum
+    /// @param crc Result of a previous call to continue from (0 to start)
+    /// @return CRC32 of all bytes so far
+    inline uint32_t crc32(std::span<const Byte> data, uint32_t crc = 0) { return crc32(data.data(), data.size(), crc); }
+
+    /// Compute (or continue) a CRC32C (Castagnoli), as used by iSCSI, SCTP and ext4
+    /// Uses the SSE4.2 or ARMv8 CRC32C instruction when the CPU has it, otherwise slicing-by-8 tables.
+    /// @param data Bytes to checksum
+    /// @param n Number of bytes
+    /// @param crc Result of a previous call to continue from (0 to start)
+    /// @return CRC32C of all bytes so far (check value for "123456789": 0xE3069283)
+    inline uint32_t crc32c(const Byte *data, size_t n, uint32_t crc = 0) {
+        crc = ~crc;
+#if defined(WIREBIT_CRC_X86)
+        if (detail::crc_cpu().sse42) {
+            return ~detail::crc32c_sse42(crc, data, n);
+        }
+#elif defined(WIREBIT_CRC_ARM)
+        return ~detail::crc_armv8<true>(crc, data, n);
+#endif
+        return ~detail::crc_slice8(detail::CRC32C_TABLES, crc, data, n);
+    }
+
+    /// Compute (or continue) a CRC32C (Castagnoli)
+    /// @param data Bytes to checksum
+    /// @param crc Result of a previous call to continue from (0 to start)
+    /// @return CRC32C of all bytes so far
+    inline uint32_t crc32c(std::span<const Byte> data, uint32_t crc = 0) {
+        return crc32c(data.data(), data.size(), crc);
+    }
+
+    /// Name of the CRC32 implementation selected for this CPU ("pclmul", "armv8" or "slice8")
+    inline const char *crc32_engine() {
+#if defined(WIREBIT_CRC_X86)
+        return detail::crc_cpu().pclmul ? "pclmul" : "slice8";
+#elif defined(WIREBIT_CRC_ARM)
+        return "armv8";
+#else
+        return "slice8";
+#endif
+    }
+
+    /// Name of the CRC32C implementation selected for this CPU ("sse4.2", "armv8" or "slice8")
+    inline const char *crc32c_engine() {
+#if defined(WIREBIT_CRC_X86)
+        return detail::crc_cpu().sse42 ? "sse4.2" : "slice8";
+#elif defined(WIREBIT_CRC_ARM)
+        return "armv8";
+#else
+        return "slice8";
+#endif
+    }
+
+    /// Shift bits into a CAN CRC-15 register (x^15 + x^14 + x^10 + x^8 + x^7 + x^4 + x^3 + 1)
+    /// Bits are taken most significant first, as they appear on the bus (unstuffed, SOF through the
+    /// end of the data field). Feeding the 15 CRC bits after the frame leaves the register at 0.
+    /// @param crc Register from a previous call (0 to start)
+    /// @param bits Bits to shift in, right-aligned
+    /// @param nbits Number of bits (at most 64)
+    /// @return Updated 15-bit register
+    inline uint16_t can_crc15_update(uint16_t crc, uint64_t bits, unsigned nbits) {
+        for (unsigned i = nbits; i-- > 0;) {
+            bool next = ((bits >> i) & 1) ^ ((crc >> 14) & 1);
+            crc = static_cast<uint16_t>((crc << 1) & 0x7FFF);
+            if (next) {
+                crc ^= 0x4599;
+            }
+        }
+        return crc;
+    }
+
+} // namespace wirebit
@@ -0,0 +1,526 @@
+#pragma once
+
+#ifndef NO_HARDWARE
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <echo/echo.hpp>
+#include <linux/io_uring.h>
+#include <memory>
+#include <span>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    namespace detail {
+        /// IORING_OP_READ_MULTISHOT (Linux 6.7); older uapi headers do not define it
+        constexpr uint8_t URING_OP_READ_MULTISHOT = 49;
+        constexpr uint16_t URING_RX_GROUP = 0;            ///< Provided buffer group used for RX
+        constexpr uint64_t URING_TAG_RX = 1ULL << 63;     ///< user_data tag for RX completions
+        constexpr uint64_t URING_TAG_MASK = URING_TAG_RX; ///< user_data tag bits
+    } // namespace detail
+
+    /// io_uring port configuration
+    struct UringPortConfig {
+        uint32_t entries = 256;       ///< Submission queue entries
+        uint32_t rx_buffers = 256;    ///< Provided RX buffers (rounded up to a power of two)
+        size_t rx_buffer_size = 2048; ///< Size of each RX buffer (max packet size)
+        uint32_t tx_slots = 128;      ///< Registered TX buffers (max writes in flight)
+        size_t tx_slot_size = 2048;   ///< Size of each TX buffer (max packet size)
+        bool socket = false;          ///< fd is a socket (multishot recv) rather than a char device
+        uint32_t submit_batch = 1;    ///< Queued writes that trigger a submit (1 = submit every send)
+    };
+
+    /// Statistics for UringPort
+    struct UringPortStats {
+        uint64_t enters = 0;       ///< io_uring_enter() syscalls
+        uint64_t tx_submitted = 0; ///< Writes queued
+        uint64_t tx_completed = 0; ///< Writes completed successfully
+        uint64_t tx_errors = 0;    ///< Writes completed with an error
+        uint64_t rx_completed = 0; ///< Packets received
+        uint64_t rx_errors = 0;    ///< Receive completions with an error
+        uint64_t rx_rearms = 0;    ///< Times the receive request had to be re-armed
+
+        inline void reset() {
+            enters = 0;
+            tx_submitted = 0;
+            tx_completed = 0;
+            tx_errors = 0;
+            rx_completed = 0;
+            rx_errors = 0;
+            rx_rearms = 0;
+        }
+    };
+
+    /// Packet I/O on one fd through io_uring (no liburing dependency)
+    ///
+    /// RX uses a multishot read/recv into a ring of provided buffers, so a steady stream of packets
+    /// costs no syscalls: completions are reaped straight from the shared CQ ring. Kernels without
+    /// multishot read fall back to re-arming a single-shot buffer-select read after each packet.
+    /// TX copies each packet into a registered buffer and queues a WRITE_FIXED; queued writes and any
+    /// RX re-arm go to the kernel together in one io_uring_enter() per flush().
+    class UringPort {
+      public:
+        /// Create a port for an fd (the fd is not owned and must outlive the port)
+        /// @param fd Non-blocking packet fd (TAP/TUN char device or socket)
+        /// @param config Port configuration
+        /// @return Result containing the port, or io_error if io_uring is unavailable
+        static Result<std::unique_ptr<UringPort>, Error> create(int fd, const UringPortConfig &config) {
+            using R = Result<std::unique_ptr<UringPort>, Error>;
+            if (config.rx_buffers == 0 || config.tx_slots == 0 || config.rx_buffer_size == 0 ||
+                config.tx_slot_size == 0 || config.rx_buffers > 32768 || config.tx_slots > 32768) {
+                return R::err(Error::invalid_argument("Invalid io_uring port configuration"));
+            }
+
+            std::unique_ptr<UringPort> port(new UringPort(fd, config));
+            auto result = port->init();
+            if (!result.is_ok()) {
+                return R::err(result.error());
+            }
+            WIREBIT_DEBUG("UringPort created: fd=", fd, " ring fd=", port->ring_fd_).green();
+            return R::ok(std::move(port));
+        }
+
+        ~UringPort() { release(); }
+
+        UringPort(const UringPort &) = delete;
+        UringPort &operator=(const UringPort &) = delete;
+
+        /// Queue a packet for transmission without submitting it
+        /// @param data Packet bytes (copied into a registered buffer)
+        /// @return Result indicating success, timeout if all TX buffers are in flight
+        Result<Unit, Error> queue_send(std::span<const Byte> data) { return queue_send({}, data); }
+
+        /// Queue a packet made of a prefix (e.g. a vnet header) followed by data
+        /// @param prefix Bytes written before data
+        /// @param data Packet bytes
+        /// @return Result indicating success, timeout if all TX buffers are in flight
+        Result<Unit, Error> queue_send(std::span<const Byte> prefix, std::span<const Byte> data) {
+            if (prefix.size() + data.size() > config_.tx_slot_size) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Packet larger than io_uring TX buffer"));
+            }
+            if (tx_free_.empty()) {
+                reap();
+            }
+            if (tx_free_.empty()) {
+                flush();
+            }
+            if (tx_free_.empty()) {
+                return Result<Unit, Error>::err(Error::timeout("io_uring TX queue full"));
+            }
+
+            struct io_uring_sqe *sqe = get_sqe();
+            if (sqe == nullptr) {
+                return Result<Unit, Error>::err(Error::timeout("io_uring submission queue full"));
+            }
+
+            uint16_t slot = tx_free_.back();
+            tx_free_.pop_back();
+            Byte *buf = tx_pool_.data() + static_cast<size_t>(slot) * config_.tx_slot_size;
+            if (!prefix.empty()) {
+                std::memcpy(buf, prefix.data(), prefix.size());
+            }
+            if (!data.empty()) {
+                std::memcpy(buf + prefix.size(), data.data(), data.size());
+            }
+
+            sqe->opcode = IORING_OP_WRITE_FIXED;
+            sqe->fd = fd_;
+            sqe->addr = reinterpret_cast<uint64_t>(buf);
+            sqe->len = static_cast<uint32_t>(prefix.size() + data.size());
+            sqe->buf_index = slot;
+            sqe->user_data = slot;
+            queued_tx_++;
+            stats_.tx_submitted++;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Queue a packet and submit once submit_batch writes are pending
+        /// Write errors are reported asynchronously through stats().tx_errors.
+        /// @param data Packet bytes
+        /// @return Result indicating success or error
+        Result<Unit, Error> send(std::span<const Byte> data) { return send({}, data); }
+
+        /// Queue a prefixed packet and submit once submit_batch writes are pending
+        /// @param prefix Bytes written before data
+        /// @param data Packet bytes
+        /// @return Result indicating success or error
+        Result<Unit, Error> send(std::span<const Byte> prefix, std::span<const Byte> data) {
+            auto result = queue_send(prefix, data);
+            if (result.is_ok() && queued_tx_ >= config_.submit_batch) {
+                auto flushed = flush();
+                if (!flushed.is_ok()) {
+                    return Result<Unit, Error>::err(flushed.error());
+                }
+            }
+            return result;
+        }
+
+        /// Receive the next packet
+        /// The span points into a provided buffer that is handed back to the kernel on the next recv().
+        /// Only enters the kernel when requests are waiting to be submitted.
+        /// @return Result containing packet bytes, or timeout if nothing was received
+        Result<std::span<const Byte>, Error> recv() {
+            recycle_held();
+
+            if (rx_ready_.empty()) {
+                reap();
+            }
+            if (rx_ready_.empty() && (!rx_armed_ || sq_tail_ != sq_submitted_)) {
+                flush();
+            }
+            if (rx_ready_.empty()) {
+                return Result<std::span<const Byte>, Error>::err(Error::timeout("No frames available"));
+            }
+
+            RxPacket packet = rx_ready_.front();
+            rx_ready_.pop_front();
+            held_bid_ = packet.bid;
+            const Byte *buf = rx_pool_.data() + static_cast<size_t>(packet.bid) * config_.rx_buffer_size;
+            return Result<std::span<const Byte>, Error>::ok(std::span<const Byte>(buf, packet.len));
+        }
+
+        /// Submit everything queued (writes and RX re-arm) with one io_uring_enter(), then reap completions
+        /// @return Result containing the number of requests submitted, or io_error
+        Result<size_t, Error> flush() {
+            if (!rx_armed_) {
+                arm_rx();
+            }
+
+            uint32_t to_submit = sq_tail_ - sq_submitted_;
+            if (to_submit > 0) {
+                __atomic_store_n(sq_tail_ptr_, sq_tail_, __ATOMIC_RELEASE);
+                long ret = ::syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0);
+                stats_.enters++;
+                if (ret < 0) {
+                    if (errno != EAGAIN && errno != EBUSY && errno != EINTR) {
+                        echo::error("io_uring_enter failed: ", strerror(errno)).red();
+                        return Result<size_t, Error>::err(Error::io_error("io_uring_enter() failed"));
+                    }
+                    ret = 0;
+                }
+                sq_submitted_ += static_cast<uint32_t>(ret);
+                queued_tx_ = 0;
+            }
+            reap();
+            return Result<size_t, Error>::ok(static_cast<size_t>(to_submit));
+        }
+
+        /// Check if a received packet is ready without entering the kernel
+        inline bool has_rx() {
+            if (rx_ready_.empty()) {
+                reap();
+            }
+            return !rx_ready_.empty();
+        }
+
+        /// Get the io_uring fd (readable when completions are pending; usable with epoll)
+        inline int ring_fd() const { return ring_fd_; }
+
+        /// Check if RX uses multishot requests (false after falling back to single-shot)
+        inline bool multishot() const { return multishot_; }
+
+        /// Get port statistics
+        inline const UringPortStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        /// Completed RX buffer waiting to be returned by recv()
+        struct RxPacket {
+            uint16_t bid; ///< Provided buffer ID
+            uint32_t len; ///< Received bytes
+        };
+
+        int fd_;
+        UringPortConfig config_;
+        int ring_fd_ = -1;
+
+        // Mapped rings
+        void *sq_map_ = nullptr;
+        size_t sq_map_size_ = 0;
+        void *cq_map_ = nullptr;
+        size_t cq_map_size_ = 0;
+        struct io_uring_sqe *sqes_ = nullptr;
+        size_t sqes_size_ = 0;
+        uint32_t *sq_head_ptr_ = nullptr;
+        uint32_t *sq_tail_ptr_ = nullptr;
+        uint32_t *sq_array_ = nullptr;
+        uint32_t sq_mask_ = 0;
+        uint32_t sq_entries_ = 0;
+        uint32_t *cq_head_ptr_ = nullptr;
+        uint32_t *cq_tail_ptr_ = nullptr;
+        struct io_uring_cqe *cqes_ = nullptr;
+        uint32_t cq_mask_ = 0;
+        uint32_t sq_tail_ = 0;      ///< Local SQ tail (published on flush)
+        uint32_t sq_submitted_ = 0; ///< SQ tail already handed to the kernel
+
+        // Buffers
+        struct io_uring_buf_ring *buf_ring_ = nullptr;
+        size_t buf_ring_size_ = 0;
+        uint32_t rx_count_ = 0;         ///< Provided RX buffers (power of two)
+        uint16_t buf_tail_ = 0;         ///< Local provided-buffer ring tail
+        Bytes rx_pool_;                 ///< RX buffer memory
+        Bytes tx_pool_;                 ///< Registered TX buffer memory
+        Vector<uint16_t> tx_free_;      ///< Free TX slots
+        std::deque<RxPacket> rx_ready_; ///< Completed RX buffers not yet returned by recv()
+        int32_t held_bid_ = -1;         ///< RX buffer lent out by the last recv()
+
+        bool rx_armed_ = false;  ///< Receive request outstanding in the kernel
+        bool multishot_ = true;  ///< Use multishot receive
+        uint32_t queued_tx_ = 0; ///< Writes queued since the last flush
+        UringPortStats stats_;
+
+        UringPort(int fd, const UringPortConfig &config) : fd_(fd), config_(config) {}
+
+        /// Helper: Set up the rings and register buffers
+        Result<Unit, Error> init() {
+            struct io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            config_.entries = std::max<uint32_t>(config_.entries, 8);
+            ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, config_.entries, &params));
+            if (ring_fd_ < 0) {
+                echo::warn("io_uring_setup failed: ", strerror(errno)).yellow();
+                return Result<Unit, Error>::err(Error::io_error("io_uring_setup() failed"));
+            }
+
+            sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+            bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap) {
+                sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+            }
+
+            sq_map_ = ::mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                             IORING_OFF_SQ_RING);
+            if (sq_map_ == MAP_FAILED) {
+                sq_map_ = nullptr;
+                return Result<Unit, Error>::err(Error::io_error("Failed to map io_uring SQ ring"));
+            }
+            if (single_mmap) {
+                cq_map_ = sq_map_;
+            } else {
+                cq_map_ = ::mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                 IORING_OFF_CQ_RING);
+                if (cq_map_ == MAP_FAILED) {
+                    cq_map_ = nullptr;
+                    return Result<Unit, Error>::err(Error::io_error("Failed to map io_uring CQ ring"));
+                }
+            }
+            sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+            void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) {
+                return Result<Unit, Error>::err(Error::io_error("Failed to map io_uring SQEs"));
+            }
+            sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+            auto *sq = static_cast<uint8_t *>(sq_map_);
+            auto *cq = static_cast<uint8_t *>(cq_map_);
+            sq_head_ptr_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+            sq_tail_ptr_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+            sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+            sq_mask_ = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+            sq_entries_ = params.sq_entries;
+            cq_head_ptr_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+            cq_tail_ptr_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+            cq_mask_ = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+            sq_tail_ = sq_submitted_ = *sq_tail_ptr_;
+
+            // Registered TX buffers
+            tx_pool_ = Bytes(static_cast<size_t>(config_.tx_slots) * config_.tx_slot_size);
+            Vector<struct iovec> iovs;
+            for (uint32_t i = 0; i < config_.tx_slots; ++i) {
+                iovs.push_back({tx_pool_.data() + static_cast<size_t>(i) * config_.tx_slot_size, config_.tx_slot_size});
+                tx_free_.push_back(static_cast<uint16_t>(config_.tx_slots - 1 - i));
+            }
+            if (::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, iovs.data(), config_.tx_slots) <
+                0) {
+                echo::warn("io_uring buffer registration failed: ", strerror(errno)).yellow();
+                return Result<Unit, Error>::err(Error::io_error("IORING_REGISTER_BUFFERS failed"));
+            }
+
+            // Provided RX buffer ring
+            rx_count_ = 1;
+            while (rx_count_ < config_.rx_buffers) {
+                rx_count_ <<= 1;
+            }
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            buf_ring_size_ = (rx_count_ * sizeof(struct io_uring_buf) + page - 1) & ~(page - 1);
+            void *ring = ::mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ring == MAP_FAILED) {
+                return Result<Unit, Error>::err(Error::io_error("Failed to allocate io_uring buffer ring"));
+            }
+            buf_ring_ = static_cast<struct io_uring_buf_ring *>(ring);
+
+            struct io_uring_buf_reg reg;
+            std::memset(&reg, 0, sizeof(reg));
+            reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+            reg.ring_entries = rx_count_;
+            reg.bgid = detail::URING_RX_GROUP;
+            if (::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+                echo::warn("io_uring buffer ring registration failed: ", strerror(errno)).yellow();
+                return Result<Unit, Error>::err(Error::io_error("IORING_REGISTER_PBUF_RING failed"));
+            }
+
+            rx_pool_ = Bytes(static_cast<size_t>(rx_count_) * config_.rx_buffer_size);
+            for (uint32_t bid = 0; bid < rx_count_; ++bid) {
+                provide_buffer(static_cast<uint16_t>(bid));
+            }
+            publish_buffers();
+
+            auto armed = flush();
+            if (!armed.is_ok()) {
+                return Result<Unit, Error>::err(armed.error());
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Get a free SQE (nullptr if the SQ is full)
+        inline struct io_uring_sqe *get_sqe() {
+            uint32_t head = __atomic_load_n(sq_head_ptr_, __ATOMIC_ACQUIRE);
+            if (sq_tail_ - head >= sq_entries_) {
+                flush();
+                head = __atomic_load_n(sq_head_ptr_, __ATOMIC_ACQUIRE);
+                if (sq_tail_ - head >= sq_entries_) {
+                    return nullptr;
+                }
+            }
+            uint32_t index = sq_tail_ & sq_mask_;
+            struct io_uring_sqe *sqe = &sqes_[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sq_array_[index] = index;
+            sq_tail_++;
+            return sqe;
+        }
+
+        /// Helper: Queue the receive request (multishot when available)
+        inline void arm_rx() {
+            struct io_uring_sqe *sqe = get_sqe();
+            if (sqe == nullptr) {
+                return;
+            }
+            sqe->fd = fd_;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = detail::URING_RX_GROUP;
+            sqe->user_data = detail::URING_TAG_RX;
+            if (config_.socket) {
+                sqe->opcode = IORING_OP_RECV;
+                sqe->ioprio = multishot_ ? static_cast<uint16_t>(IORING_RECV_MULTISHOT) : uint16_t(0);
+            } else {
+                sqe->opcode = multishot_ ? detail::URING_OP_READ_MULTISHOT : static_cast<uint8_t>(IORING_OP_READ);
+                sqe->len = multishot_ ? 0 : static_cast<uint32_t>(config_.rx_buffer_size);
+                sqe->off = static_cast<uint64_t>(-1);
+            }
+            rx_armed_ = true;
+        }
+
+        /// Helper: Consume completions from the CQ ring (no syscall)
+        inline void reap() {
+            uint32_t head = *cq_head_ptr_;
+            uint32_t tail = __atomic_load_n(cq_tail_ptr_, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                const struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+                if ((cqe.user_data & detail::URING_TAG_MASK) == detail::URING_TAG_RX) {
+                    handle_rx(cqe);
+                } else {
+                    if (cqe.res < 0) {
+                        stats_.tx_errors++;
+                        echo::warn("io_uring write failed: ", strerror(-cqe.res)).yellow();
+                    } else {
+                        stats_.tx_completed++;
+                    }
+                    tx_free_.push_back(static_cast<uint16_t>(cqe.user_data));
+                }
+                ++head;
+            }
+            __atomic_store_n(cq_head_ptr_, head, __ATOMIC_RELEASE);
+        }
+
+        /// Helper: Handle one RX completion
+        inline void handle_rx(const struct io_uring_cqe &cqe) {
+            bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+            if (!more) {
+                rx_armed_ = false;
+            }
+
+            if (cqe.res >= 0 && (cqe.flags & IORING_CQE_F_BUFFER) != 0) {
+                uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                rx_ready_.push_back({bid, static_cast<uint32_t>(cqe.res)});
+                stats_.rx_completed++;
+            } else if (cqe.res == -EINVAL && multishot_) {
+                // Kernel without multishot read: fall back to re-arming single-shot reads
+                WIREBIT_DEBUG("io_uring multishot receive unsupported, using single-shot");
+                multishot_ = false;
+            } else if (cqe.res < 0 && cqe.res != -ENOBUFS) {
+                stats_.rx_errors++;
+                echo::warn("io_uring receive failed: ", strerror(-cqe.res)).yellow();
+            }
+
+            if (!rx_armed_) {
+                stats_.rx_rearms++;
+            }
+        }
+
+        /// Helper: Return the buffer lent out by recv() to the kernel
+        inline void recycle_held() {
+            if (held_bid_ >= 0) {
+                provide_buffer(static_cast<uint16_t>(held_bid_));
+                publish_buffers();
+                held_bid_ = -1;
+            }
+        }
+
+        /// Helper: Add a buffer to the provided-buffer ring (published by publish_buffers())
+        inline void provide_buffer(uint16_t bid) {
+            // Index the ring memory directly: in C++ the uapi flex-array wrapper puts bufs at offset 8
+            auto *bufs = reinterpret_cast<struct io_uring_buf *>(buf_ring_);
+            struct io_uring_buf *buf = &bufs[buf_tail_ & (rx_count_ - 1)];
+            Byte *data = rx_pool_.data() + static_cast<size_t>(bid) * config_.rx_buffer_size;
+            buf->addr = reinterpret_cast<uint64_t>(data);
+            buf->len = static_cast<uint32_t>(config_.rx_buffer_size);
+            buf->bid = bid;
+            buf_tail_++;
+        }
+
+        /// Helper: Make provided buffers visible to the kernel
+        inline void publish_buffers() { __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE); }
+
+        /// Helper: Unmap rings and close the io_uring fd
+        inline void release() {
+            if (ring_fd_ >= 0) {
+                ::close(ring_fd_);
+                ring_fd_ = -1;
+            }
+            if (sqes_ != nullptr) {
+                ::munmap(sqes_, sqes_size_);
+                sqes_ = nullptr;
+            }
+            if (cq_map_ != nullptr && cq_map_ != sq_map_) {
+                ::munmap(cq_map_, cq_map_size_);
+            }
+            cq_map_ = nullptr;
+            if (sq_map_ != nullptr) {
+                ::munmap(sq_map_, sq_map_size_);
+                sq_map_ = nullptr;
+            }
+            if (buf_ring_ != nullptr) {
+                ::munmap(buf_ring_, buf_ring_size_);
+                buf_ring_ = nullptr;
+            }
+        }
+    };
+
+} // namespace wirebit
+
+#endif // NO_HARDWARE
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <echo/echo.hpp>
+#include <ostream>
+#include <span>
+#include <wirebit/common/types.hpp>
+
+/// Compile-time log thresholds (lowest level that is compiled in)
+#define WIREBIT_LOG_LEVEL_TRACE 0 ///< Keep trace and debug calls (default)
+#define WIREBIT_LOG_LEVEL_DEBUG 1 ///< Compile out trace calls
+#define WIREBIT_LOG_LEVEL_INFO 2  ///< Compile out trace and debug calls
+
+/// Lowest log level compiled into wirebit (set with -DWIREBIT_LOG_LEVEL=... or the CMake option of the same name)
+/// Calls below the threshold are removed at compile time, arguments included, so nothing is
+/// formatted or evaluated for them. echo's runtime level still filters whatever is compiled in.
+/// Warnings and errors are never compiled out.
+#ifndef WIREBIT_LOG_LEVEL
+#define WIREBIT_LOG_LEVEL WIREBIT_LOG_LEVEL_TRACE
+#endif
+
+/// Check if calls at a level are compiled in
+#define WIREBIT_LOG_ENABLED(level) (WIREBIT_LOG_LEVEL <= (level))
+
+/// Log at trace level; compiled out when WIREBIT_LOG_LEVEL > WIREBIT_LOG_LEVEL_TRACE
+/// Expands to an if/else so colour calls can still be chained (WIREBIT_TRACE("up").green();)
+/// and so it is safe in an unbraced if/else. The discarded branch is still type-checked.
+#define WIREBIT_TRACE(...)                                                                                             \
+    if constexpr (!WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_TRACE)) {                                                     \
+    } else                                                                                                             \
+        echo::trace(__VA_ARGS__)
+
+/// Log at debug level; compiled out when WIREBIT_LOG_LEVEL > WIREBIT_LOG_LEVEL_DEBUG
+#define WIREBIT_DEBUG(...)                                                                                             \
+    if constexpr (!WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_DEBUG)) {                                                     \
+    } else                                                                                                             \
+        echo::debug(__VA_ARGS__)
+
+namespace wirebit {
+
+    /// Stream adaptor that prints a byte run as space-separated hex
+    /// Formatting happens only when a log line that holds it is emitted, so passing one to a
+    /// filtered-out call costs nothing (unlike building a std::stringstream up front).
+    struct HexFormat {
+        std::span<const Byte> bytes; ///< Bytes to print
+
+        friend inline std::ostream &operator<<(std::ostream &os, const HexFormat &f) {
+            static constexpr char hex[] = "0123456789abcdef";
+            for (size_t i = 0; i < f.bytes.size(); ++i) {
+                char buf[3] = {hex[f.bytes[i] >> 4], hex[f.bytes[i] & 0x0F], ' '};
+                os.write(buf, i + 1 < f.bytes.size() ? 3 : 2);
+            }
+            return os;
+        }
+    };
+
+} // namespace wirebit
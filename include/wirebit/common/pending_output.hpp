@@ -0,0 +1,213 @@
+#pragma once
+
+#ifndef NO_HARDWARE
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Ordered output queue for a non-blocking stream fd (PTY master, TTY)
+    ///
+    /// write() gathers a record (e.g. FrameHeader + payload + meta) straight from the caller's
+    /// iovecs with one writev(). Whatever the fd does not take is copied into the queue and written
+    /// by later write()/flush() calls, so a record is either rejected whole or delivered whole and
+    /// the byte stream is never cut mid-record. Queued bytes always go out before new ones.
+    ///
+    /// Example usage:
+    /// @code
+    /// PendingOutput out(65536);
+    /// struct iovec iov[2] = {{&header, sizeof(header)}, {payload, len}};
+    /// out.write(fd, iov, 2);
+    /// while (!out.empty()) { out.flush(fd, ms_to_ns(10)); }
+    /// @endcode
+    class PendingOutput {
+      public:
+        PendingOutput() = default;
+
+        /// Create a queue
+        /// @param max_bytes Queue size above which new records are rejected
+        inline explicit PendingOutput(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+        /// Write a record, queueing the part the fd does not accept
+        /// A record that does not fit in the queue is only rejected while nothing of it has been
+        /// written; once its first byte is out, the remainder is queued regardless of max_bytes().
+        /// @param fd Non-blocking stream fd
+        /// @param iov Record pieces
+        /// @param iovcnt Number of pieces
+        /// @return Result containing bytes written directly (the rest is queued), timeout if the record
+        ///         was rejected because the queue is full, or io_error if the fd failed
+        inline Result<size_t, Error> write(int fd, const struct iovec *iov, int iovcnt) {
+            size_t total = 0;
+            for (int i = 0; i < iovcnt; ++i) {
+                total += iov[i].iov_len;
+            }
+
+            // Older bytes go first
+            if (!empty()) {
+                auto flushed = flush(fd);
+                if (!flushed.is_ok()) {
+                    return Result<size_t, Error>::err(flushed.error());
+                }
+                if (!empty()) {
+                    if (size() + total > max_bytes_) {
+                        return Result<size_t, Error>::err(Error::timeout("Output queue full"));
+                    }
+                    append(iov, iovcnt, 0);
+                    return Result<size_t, Error>::ok(0);
+                }
+            }
+
+            ssize_t written;
+            do {
+                written = ::writev(fd, iov, iovcnt);
+            } while (written < 0 && errno == EINTR);
+
+            if (written < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    echo::error("writev failed: ", strerror(errno)).red();
+                    return Result<size_t, Error>::err(Error::io_error("Stream write failed"));
+                }
+                if (total > max_bytes_) {
+                    return Result<size_t, Error>::err(Error::timeout("Output queue full"));
+                }
+                written = 0;
+            }
+
+            written_ += static_cast<uint64_t>(written);
+            if (static_cast<size_t>(written) < total) {
+                WIREBIT_TRACE("Stream write: ", written, " of ", total, " bytes, queueing ", total - written);
+                append(iov, iovcnt, static_cast<size_t>(written));
+            }
+            return Result<size_t, Error>::ok(static_cast<size_t>(written));
+        }
+
+        /// Write queued bytes
+        /// @param fd Non-blocking stream fd
+        /// @param timeout_ns How long to wait for the fd to become writable (0 = don't wait)
+        /// @return Result containing bytes written (the queue may still hold data), or io_error
+        inline Result<size_t, Error> flush(int fd, uint64_t timeout_ns = 0) {
+            size_t flushed = 0;
+            uint64_t deadline = timeout_ns > 0 ? wall_ns() + timeout_ns : 0;
+            while (!empty()) {
+                ssize_t n = ::write(fd, buffer_.data() + head_, size());
+                if (n > 0) {
+                    head_ += static_cast<size_t>(n);
+                    flushed += static_cast<size_t>(n);
+                    written_ += static_cast<uint64_t>(n);
+                    continue;
+                }
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    echo::error("Stream flush failed: ", strerror(errno)).red();
+                    return Result<size_t, Error>::err(Error::io_error("Stream write failed"));
+                }
+
+                // Would block: wait for POLLOUT until the deadline
+                uint64_t now = wall_ns();
+                if (now >= deadline) {
+                    break;
+                }
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                int wait_ms = static_cast<int>((deadline - now + 999999) / 1000000);
+                int ready = ::poll(&pfd, 1, wait_ms);
+                if (ready == 0) {
+                    break; // Timed out
+                }
+                if (ready < 0 && errno != EINTR) {
+                    break;
+                }
+            }
+
+            if (empty()) {
+                clear();
+            } else if (head_ > buffer_.size() / 2) {
+                // Compact so the queue does not creep forward forever
+                std::memmove(buffer_.data(), buffer_.data() + head_, size());
+                buffer_.resize(size());
+                auto started = std::lower_bound(record_starts_.begin(), record_starts_.end(), head_);
+                record_starts_.erase(record_starts_.begin(), started);
+                for (size_t &start : record_starts_) {
+                    start -= head_;
+                }
+                head_ = 0;
+            }
+            return Result<size_t, Error>::ok(flushed);
+        }
+
+        /// Drop queued records that have not started going out
+        /// The rest of a record whose first bytes were already written stays queued, so discarding
+        /// output never leaves a truncated record on the stream.
+        /// @return Number of bytes dropped
+        inline size_t discard() {
+            auto next = std::lower_bound(record_starts_.begin(), record_starts_.end(), head_);
+            if (next == record_starts_.end()) {
+                return 0; // Only the tail of a started record is queued
+            }
+            size_t dropped = buffer_.size() - *next;
+            buffer_.resize(*next);
+            record_starts_.erase(next, record_starts_.end());
+            if (empty()) {
+                clear();
+            }
+            return dropped;
+        }
+
+        /// Drop all queued bytes (storage is kept)
+        /// Unlike discard(), this may cut a record that has partly been written.
+        inline void clear() {
+            buffer_.clear();
+            record_starts_.clear();
+            head_ = 0;
+        }
+
+        /// Get number of queued bytes
+        inline size_t size() const { return buffer_.size() - head_; }
+
+        /// Check if nothing is queued
+        inline bool empty() const { return head_ == buffer_.size(); }
+
+        /// Get the queue size above which new records are rejected
+        inline size_t max_bytes() const { return max_bytes_; }
+
+        /// Get total bytes handed to the fd (direct writes and flushes)
+        inline uint64_t bytes_written() const { return written_; }
+
+      private:
+        Bytes buffer_;                 ///< Queued bytes (from head_ to end)
+        Vector<size_t> record_starts_; ///< Offsets in buffer_ of records queued whole (ascending)
+        size_t head_ = 0;              ///< Offset of the oldest queued byte
+        size_t max_bytes_ = 65536;     ///< Rejection threshold for new records
+        uint64_t written_ = 0;         ///< Total bytes handed to the fd
+
+        /// Helper: Queue a record, skipping its first skip bytes (already written)
+        inline void append(const struct iovec *iov, int iovcnt, size_t skip) {
+            if (skip == 0) {
+                record_starts_.push_back(buffer_.size());
+            }
+            for (int i = 0; i < iovcnt; ++i) {
+                const auto *data = static_cast<const Byte *>(iov[i].iov_base);
+                size_t len = iov[i].iov_len;
+                if (skip >= len) {
+                    skip -= len;
+                    continue;
+                }
+                buffer_.insert(buffer_.end(), data + skip, data + len);
+                skip = 0;
+            }
+        }
+    };
+
+} // namespace wirebit
+
+#endif // NO_HARDWARE
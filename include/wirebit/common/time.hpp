@@ -1,12 +1,95 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <datapod/pods/temporal/stamp.hpp>
+#include <thread>
+#include <wirebit/common/tsc_clock.hpp>
 #include <wirebit/common/types.hpp>
 
 namespace wirebit {
 
-    /// Get current time in nanoseconds since Unix epoch (uses datapod::Stamp::now())
-    inline TimeNs now_ns() { return datapod::Stamp<int>::now(); }
+    /// Get current wall-clock time in nanoseconds since Unix epoch (uses datapod::Stamp::now())
+    /// Unaffected by set_clock_source(); use it for timeouts of real OS waits (poll, eventfd).
+    inline TimeNs wall_ns() { return datapod::Stamp<int>::now(); }
+
+    /// Alternative time source behind now_ns() (e.g. VirtualClock)
+    class ClockSource {
+      public:
+        virtual ~ClockSource() = default;
+
+        /// Get current time in nanoseconds
+        virtual TimeNs now() const = 0;
+
+        /// Wait until now() reaches a time
+        /// @param t Time to wait for
+        virtual void sleep_until(TimeNs t) = 0;
+    };
+
+    namespace detail {
+        inline std::atomic<ClockSource *> clock_source{nullptr};        ///< nullptr = wall clock
+        inline thread_local ClockSource *thread_clock_source = nullptr; ///< Overrides clock_source on this thread
+    } // namespace detail
+
+    /// Install the time source used by now_ns() for the whole process (except threads with their own,
+    /// see set_thread_clock_source())
+    /// Install it before links and endpoints start stamping frames; frames exchanged with other
+    /// processes carry this process's times.
+    /// @param clock Clock to use (must stay alive while installed), or nullptr for the wall clock
+    /// @return Previously installed clock, or nullptr
+    inline ClockSource *set_clock_source(ClockSource *clock) {
+        return detail::clock_source.exchange(clock, std::memory_order_acq_rel);
+    }
+
+    /// Install the time source used by now_ns() on the calling thread only
+    /// Takes precedence over set_clock_source(), so threads running independent simulations (e.g.
+    /// ScenarioRunner workers) each follow their own VirtualClock.
+    /// @param clock Clock to use (must stay alive while installed), or nullptr for the process clock
+    /// @return Clock previously installed on this thread, or nullptr
+    inline ClockSource *set_thread_clock_source(ClockSource *clock) {
+        ClockSource *previous = detail::thread_clock_source;
+        detail::thread_clock_source = clock;
+        return previous;
+    }
+
+    /// Get the time source of the calling thread
+    /// @return Clock, or nullptr if now_ns() is the wall clock
+    inline ClockSource *clock_source() {
+        ClockSource *clock = detail::thread_clock_source;
+        return clock != nullptr ? clock : detail::clock_source.load(std::memory_order_acquire);
+    }
+
+    /// Get current time in nanoseconds (wall clock since Unix epoch unless a ClockSource is installed)
+    /// The wall clock is read from the calibrated cycle counter (TscClock) when the CPU has an invariant
+    /// one, and from wall_ns() otherwise or when built with WIREBIT_NO_TSC_CLOCK.
+    inline TimeNs now_ns() {
+        ClockSource *clock = clock_source();
+        if (clock != nullptr) {
+            return clock->now();
+        }
+#ifndef WIREBIT_NO_TSC_CLOCK
+        static TscClock *tsc = TscClock::global();
+        if (tsc != nullptr) {
+            return tsc->now();
+        }
+#endif
+        return wall_ns();
+    }
+
+    /// Wait until now_ns() reaches a time
+    /// Sleeps on the wall clock; an installed ClockSource decides itself (a VirtualClock jumps there).
+    /// @param t Time to wait for
+    inline void sleep_until_ns(TimeNs t) {
+        ClockSource *clock = clock_source();
+        if (clock != nullptr) {
+            clock->sleep_until(t);
+            return;
+        }
+        TimeNs now = wall_ns();
+        if (t > now) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(t - now));
+        }
+    }
 
     /// Convert nanoseconds to microseconds
     inline int64_t ns_to_us(TimeNs ns) { return ns / 1000; }
@@ -0,0 +1,136 @@
+#pragma once
+
+#ifndef NO_HARDWARE
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <echo/echo.hpp>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Where a socket's frame timestamps come from
+    enum class TimestampSource : uint8_t {
+        None = 0,     ///< Timestamps taken in user space after the read returns
+        Software = 1, ///< Kernel software timestamps (CLOCK_REALTIME, taken when the frame enters the stack)
+        Hardware = 2, ///< NIC/controller hardware timestamps (device clock, e.g. a PTP hardware clock)
+    };
+
+    /// Timestamp extracted from recvmsg() control data
+    struct KernelTimestamp {
+        uint64_t ns = 0;                                ///< Timestamp in nanoseconds (0 = none)
+        TimestampSource source = TimestampSource::None; ///< Clock the timestamp was taken on
+    };
+
+    namespace detail {
+        /// Payload of an SCM_TIMESTAMPING control message: [0] software, [1] legacy, [2] raw hardware
+        struct ScmTimestamping {
+            struct timespec ts[3];
+        };
+
+        /// Control buffer size for one message carrying SCM_TIMESTAMPING or SCM_TIMESTAMPNS
+        constexpr size_t TIMESTAMP_CONTROL_LEN = CMSG_SPACE(sizeof(ScmTimestamping)) + CMSG_SPACE(sizeof(timespec));
+
+        /// Helper: Convert a timespec to nanoseconds
+        inline uint64_t timespec_ns(const struct timespec &ts) {
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        }
+
+        /// Helper: Switch an interface's hardware timestamping on (SIOCSHWTSTAMP, all RX frames and TX)
+        /// Failure is logged; callers fall back to software timestamps.
+        /// @param fd Any socket fd
+        /// @param interface_name Interface to configure
+        /// @return true if the device accepted the configuration
+        inline bool enable_hw_timestamping(int fd, const String &interface_name) {
+            struct hwtstamp_config hw_config;
+            std::memset(&hw_config, 0, sizeof(hw_config));
+            hw_config.tx_type = HWTSTAMP_TX_ON;
+            hw_config.rx_filter = HWTSTAMP_FILTER_ALL;
+
+            struct ifreq ifr;
+            std::memset(&ifr, 0, sizeof(ifr));
+            std::snprintf(ifr.ifr_name, IFNAMSIZ, "%s", interface_name.c_str());
+            ifr.ifr_data = reinterpret_cast<char *>(&hw_config);
+            if (::ioctl(fd, SIOCSHWTSTAMP, &ifr) == 0) {
+                return true;
+            }
+            echo::warn("Hardware timestamps unavailable on ", interface_name.c_str(), ": ", strerror(errno),
+                       " (using software timestamps)")
+                .yellow();
+            return false;
+        }
+
+        /// Helper: Enable kernel timestamps on a socket
+        /// Tries SO_TIMESTAMPING (RX and TX, plus hardware if requested and the device accepts
+        /// SIOCSHWTSTAMP), then falls back to SO_TIMESTAMPNS (RX software only).
+        /// @param fd Socket fd
+        /// @param interface_name Interface to enable hardware timestamping on
+        /// @param hardware Request hardware timestamps
+        /// @return Result containing the best source enabled, or io_error if the socket supports none
+        inline Result<TimestampSource, Error> enable_timestamping(int fd, const String &interface_name,
+                                                                  bool hardware) {
+            bool hw_enabled = hardware && enable_hw_timestamping(fd, interface_name);
+
+            int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                        SOF_TIMESTAMPING_OPT_TSONLY;
+            if (hw_enabled) {
+                flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+            }
+            if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+                WIREBIT_DEBUG("SO_TIMESTAMPING enabled (flags=0x", std::hex, flags, std::dec, ")");
+                return Result<TimestampSource, Error>::ok(hw_enabled ? TimestampSource::Hardware
+                                                                     : TimestampSource::Software);
+            }
+
+            int enable = 1;
+            if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0) {
+                WIREBIT_DEBUG("SO_TIMESTAMPING unsupported, using SO_TIMESTAMPNS");
+                return Result<TimestampSource, Error>::ok(TimestampSource::Software);
+            }
+
+            echo::error("Failed to enable kernel timestamps: ", strerror(errno)).red();
+            return Result<TimestampSource, Error>::err(Error::io_error("Kernel timestamps not supported"));
+        }
+
+        /// Helper: Extract the kernel timestamp from a received message's control data
+        /// A raw hardware timestamp is preferred over the software one when both are present.
+        /// @param msg Message filled in by recvmsg()/recvmmsg()
+        /// @return Timestamp, or ns == 0 if the message carries none
+        inline KernelTimestamp cmsg_timestamp(struct msghdr &msg) {
+            KernelTimestamp out;
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET) {
+                    continue;
+                }
+                if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                    ScmTimestamping stamps;
+                    std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                    uint64_t hw = timespec_ns(stamps.ts[2]);
+                    if (hw != 0) {
+                        return KernelTimestamp{hw, TimestampSource::Hardware};
+                    }
+                    uint64_t sw = timespec_ns(stamps.ts[0]);
+                    if (sw != 0) {
+                        out = KernelTimestamp{sw, TimestampSource::Software};
+                    }
+                } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    struct timespec ts;
+                    std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    out = KernelTimestamp{timespec_ns(ts), TimestampSource::Software};
+                }
+            }
+            return out;
+        }
+    } // namespace detail
+
+} // namespace wirebit
+
+#endif // NO_HARDWARE
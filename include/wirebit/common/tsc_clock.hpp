@@ -0,0 +1,278 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace wirebit {
+
+    namespace detail {
+        __extension__ typedef unsigned __int128 uint128; ///< Fixed-point intermediate (GCC/Clang)
+        __extension__ typedef __int128 int128;
+
+        /// Read the CPU cycle counter (TSC on x86, CNTVCT_EL0 on AArch64)
+        /// @return Counter value, or 0 if the architecture has none
+        inline uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#elif defined(__aarch64__)
+            uint64_t value;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+            return value;
+#else
+            return 0;
+#endif
+        }
+
+        /// Check for a cycle counter that ticks at a constant rate on every core, in every P- and C-state
+        /// x86 reports this as "invariant TSC" (CPUID 0x80000007, EDX bit 8); the AArch64 generic timer
+        /// always is.
+        inline bool has_invariant_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+            unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+            if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+                return false;
+            }
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+            return (edx & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /// Read CLOCK_REALTIME in nanoseconds
+        inline int64_t realtime_ns() {
+            timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+        }
+    } // namespace detail
+
+    /// Wall clock read from the CPU cycle counter
+    ///
+    /// Returns nanoseconds since the Unix epoch like CLOCK_REALTIME, for the cost of one cycle
+    /// counter read and a multiply instead of a clock_gettime() call. The counter rate is calibrated
+    /// against CLOCK_REALTIME at startup and re-measured at every resync (after 10 ms, then doubling up
+    /// to resync_ns): small offsets are slewed away over the next period so the clock never goes
+    /// backwards, while offsets above STEP_THRESHOLD_NS (the wall clock was set) are stepped.
+    ///
+    /// Only usable on an invariant counter (see valid()); the global() instance backs now_ns() unless
+    /// WIREBIT_NO_TSC_CLOCK is defined. Thread-safe: readers never block, one of them does the resync.
+    class TscClock {
+      public:
+        static constexpr int64_t DEFAULT_RESYNC_NS = 1000000000;   ///< Steady-state resync period
+        static constexpr int64_t FIRST_RESYNC_NS = 10000000;       ///< First resync after calibration
+        static constexpr int64_t CALIBRATION_NS = 200000;          ///< Initial calibration window
+        static constexpr int64_t STEP_THRESHOLD_NS = 1000000;      ///< Offsets above this are stepped
+        static constexpr unsigned SHIFT = 32;                      ///< Fixed-point bits of mult
+
+        /// Calibrate a clock (busy-waits for CALIBRATION_NS)
+        /// @param resync_ns Steady-state resync period
+        explicit TscClock(int64_t resync_ns = DEFAULT_RESYNC_NS) : max_period_ns_(resync_ns) {
+            if (!detail::has_invariant_cycles()) {
+                return;
+            }
+            Sample start = sample();
+            Sample end = start;
+            while (end.wall - start.wall < CALIBRATION_NS) {
+                end = sample();
+            }
+            if (end.cycles <= start.cycles) {
+                return;
+            }
+            origin_ = start;
+            uint64_t mult = rate_mult(start, end);
+            period_ns_ = FIRST_RESYNC_NS;
+            publish(end.cycles, end.wall, mult, cycles_for(period_ns_, mult));
+            rate_mult_ = mult;
+            valid_ = true;
+        }
+
+        TscClock(const TscClock &) = delete;
+        TscClock &operator=(const TscClock &) = delete;
+
+        /// Get the process-wide clock, calibrated on first use
+        /// @return Clock, or nullptr if there is no invariant cycle counter
+        static inline TscClock *global() {
+            static TscClock clock;
+            return clock.valid_ ? &clock : nullptr;
+        }
+
+        /// Check if the clock is calibrated on an invariant counter
+        inline bool valid() const { return valid_; }
+
+        /// Get current time in nanoseconds since the Unix epoch
+        inline int64_t now() {
+            uint64_t cycles = detail::read_cycles();
+            Params p = load();
+            if (cycles > p.base_cycles && cycles - p.base_cycles >= p.resync_cycles) {
+                try_resync();
+                cycles = detail::read_cycles();
+                p = load();
+            }
+            return to_ns(p, cycles);
+        }
+
+        /// Re-measure the counter rate and correct the offset against CLOCK_REALTIME now
+        inline void resync() {
+            if (!valid_) {
+                return;
+            }
+            bool expected = false;
+            while (!resyncing_.compare_exchange_weak(expected, true, std::memory_order_acquire)) {
+                expected = false;
+            }
+            do_resync();
+            resyncing_.store(false, std::memory_order_release);
+        }
+
+        /// Get the measured counter frequency
+        /// @return Frequency in Hz (0 if not valid)
+        inline double frequency_hz() const {
+            return rate_mult_ == 0 ? 0.0 : 1e9 * static_cast<double>(uint64_t(1) << SHIFT) / rate_mult_;
+        }
+
+        /// Get number of resyncs so far
+        inline uint64_t resyncs() const { return resyncs_.load(std::memory_order_relaxed); }
+
+        /// Get number of resyncs that stepped the clock instead of slewing it
+        inline uint64_t steps() const { return steps_.load(std::memory_order_relaxed); }
+
+        /// Get offset to CLOCK_REALTIME found at the last resync
+        /// @return CLOCK_REALTIME minus this clock, in nanoseconds
+        inline int64_t last_offset_ns() const { return last_offset_ns_.load(std::memory_order_relaxed); }
+
+      private:
+        /// Cycle counter read bracketing a CLOCK_REALTIME read
+        struct Sample {
+            uint64_t cycles = 0; ///< Midpoint of the two counter reads
+            int64_t wall = 0;    ///< CLOCK_REALTIME
+        };
+
+        /// Conversion published to readers
+        struct Params {
+            uint64_t base_cycles;   ///< Counter value at base_ns
+            int64_t base_ns;        ///< Time at base_cycles
+            uint64_t mult;          ///< Nanoseconds per cycle << SHIFT
+            uint64_t resync_cycles; ///< Cycles after base_cycles at which to resync
+        };
+
+        // Seqlock: odd while the writer updates the fields
+        std::atomic<uint32_t> seq_{0};
+        std::atomic<uint64_t> base_cycles_{0};
+        std::atomic<int64_t> base_ns_{0};
+        std::atomic<uint64_t> mult_{0};
+        std::atomic<uint64_t> resync_cycles_{UINT64_MAX};
+
+        std::atomic<bool> resyncing_{false};
+        std::atomic<uint64_t> resyncs_{0};
+        std::atomic<uint64_t> steps_{0};
+        std::atomic<int64_t> last_offset_ns_{0};
+        Sample origin_;             ///< Calibration start (rate baseline)
+        uint64_t rate_mult_ = 0;    ///< Measured rate, without slew
+        int64_t period_ns_ = 0;     ///< Current resync period
+        int64_t max_period_ns_;     ///< Resync period once settled
+        bool valid_ = false;
+
+        static inline int64_t to_ns(const Params &p, uint64_t cycles) {
+            // Signed: another thread may have published parameters based after our counter read
+            auto delta = static_cast<detail::int128>(static_cast<int64_t>(cycles - p.base_cycles));
+            return p.base_ns + static_cast<int64_t>((delta * static_cast<detail::int128>(p.mult)) >> SHIFT);
+        }
+
+        static inline uint64_t cycles_for(int64_t ns, uint64_t mult) {
+            return static_cast<uint64_t>((static_cast<detail::uint128>(ns) << SHIFT) / mult);
+        }
+
+        /// Ratio of elapsed wall time to elapsed cycles, in fixed point
+        static inline uint64_t rate_mult(const Sample &from, const Sample &to) {
+            auto ns = static_cast<detail::uint128>(to.wall - from.wall) << SHIFT;
+            return static_cast<uint64_t>(ns / (to.cycles - from.cycles));
+        }
+
+        /// Take the tightest of a few counter/CLOCK_REALTIME pairs
+        static inline Sample sample() {
+            Sample best;
+            uint64_t best_gap = UINT64_MAX;
+            for (int i = 0; i < 5; ++i) {
+                uint64_t before = detail::read_cycles();
+                int64_t wall = detail::realtime_ns();
+                uint64_t after = detail::read_cycles();
+                if (after - before < best_gap) {
+                    best_gap = after - before;
+                    best.cycles = before + (after - before) / 2;
+                    best.wall = wall;
+                }
+            }
+            return best;
+        }
+
+        inline Params load() const {
+            while (true) {
+                uint32_t before = seq_.load(std::memory_order_acquire);
+                Params p{base_cycles_.load(std::memory_order_relaxed), base_ns_.load(std::memory_order_relaxed),
+                         mult_.load(std::memory_order_relaxed), resync_cycles_.load(std::memory_order_relaxed)};
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((before & 1) == 0 && seq_.load(std::memory_order_relaxed) == before) {
+                    return p;
+                }
+            }
+        }
+
+        inline void publish(uint64_t base_cycles, int64_t base_ns, uint64_t mult, uint64_t resync_cycles) {
+            uint32_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            base_cycles_.store(base_cycles, std::memory_order_relaxed);
+            base_ns_.store(base_ns, std::memory_order_relaxed);
+            mult_.store(mult, std::memory_order_relaxed);
+            resync_cycles_.store(resync_cycles, std::memory_order_relaxed);
+            seq_.store(seq + 2, std::memory_order_release);
+        }
+
+        /// Resync unless another thread already is (readers keep using the current parameters)
+        inline void try_resync() {
+            if (resyncing_.exchange(true, std::memory_order_acquire)) {
+                return;
+            }
+            do_resync();
+            resyncing_.store(false, std::memory_order_release);
+        }
+
+        inline void do_resync() {
+            Sample s = sample();
+            Params p = load();
+            int64_t estimate = to_ns(p, s.cycles);
+            int64_t offset = s.wall - estimate;
+            last_offset_ns_.store(offset, std::memory_order_relaxed);
+            resyncs_.fetch_add(1, std::memory_order_relaxed);
+
+            if (s.cycles > origin_.cycles && s.wall > origin_.wall) {
+                rate_mult_ = rate_mult(origin_, s);
+            }
+            period_ns_ = period_ns_ * 2 > max_period_ns_ ? max_period_ns_ : period_ns_ * 2;
+            uint64_t period_cycles = cycles_for(period_ns_, rate_mult_);
+
+            if (offset > STEP_THRESHOLD_NS || offset < -STEP_THRESHOLD_NS) {
+                // The wall clock was set (or we were descheduled for long): start over from here
+                steps_.fetch_add(1, std::memory_order_relaxed);
+                origin_ = s;
+                publish(s.cycles, s.wall, rate_mult_, period_cycles);
+                return;
+            }
+
+            // Slew: continue from the current estimate and meet the wall clock one period later
+            auto target = static_cast<detail::uint128>(period_ns_ + offset) << SHIFT;
+            auto slewed = static_cast<uint64_t>(target / period_cycles);
+            publish(s.cycles, estimate, slewed, period_cycles);
+        }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <echo/echo.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Ordered holding queue for items with a delivery deadline (e.g. Frame::header.deliver_at_ns)
+    ///
+    /// Items come out in deadline order; items with equal deadlines keep insertion order.
+    /// Deadlines produced by pacing (bitrate/baud shaping) are mostly non-decreasing, so those
+    /// go to a FIFO in O(1). Only items that arrive out of order (jitter) pay for the min-heap.
+    ///
+    /// Example usage:
+    /// @code
+    /// DelayLine<Frame> line;
+    /// line.push(frame.header.deliver_at_ns, std::move(frame));
+    /// while (auto ready = line.pop_ready(now_ns()); ready.is_ok()) { deliver(ready.value()); }
+    /// uint64_t wake_at = line.next_deadline();
+    /// @endcode
+    template <typename T> class DelayLine {
+      public:
+        /// Returned by next_deadline() when the line is empty
+        static constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+        DelayLine() = default;
+
+        /// Hold an item until its deadline
+        /// @param deadline_ns Time at which the item becomes ready (0 = immediately)
+        /// @param item Item to hold
+        inline void push(uint64_t deadline_ns, T item) {
+            Entry entry{deadline_ns, next_seq_++, std::move(item)};
+            if (fifo_.empty() || deadline_ns >= fifo_.back().deadline_ns) {
+                fifo_.push_back(std::move(entry));
+            } else {
+                heap_.push_back(std::move(entry));
+                std::push_heap(heap_.begin(), heap_.end(), later);
+            }
+        }
+
+        /// Check if the earliest item is due
+        /// @param now_ns Current time
+        /// @return true if pop_ready() would return an item
+        inline bool ready(uint64_t now_ns) const { return !empty() && next_deadline() <= now_ns; }
+
+        /// Remove the earliest item if it is due
+        /// @param now_ns Current time
+        /// @return Result containing the item, or timeout if nothing is due yet
+        inline Result<T, Error> pop_ready(uint64_t now_ns) {
+            if (!ready(now_ns)) {
+                return Result<T, Error>::err(Error::timeout(empty() ? "Delay line empty" : "Item not due yet"));
+            }
+
+            if (from_heap()) {
+                std::pop_heap(heap_.begin(), heap_.end(), later);
+                T item = std::move(heap_.back().item);
+                heap_.pop_back();
+                return Result<T, Error>::ok(std::move(item));
+            }
+
+            T item = std::move(fifo_.front().item);
+            fifo_.pop_front();
+            return Result<T, Error>::ok(std::move(item));
+        }
+
+        /// Remove all due items, oldest deadline first
+        /// @param now_ns Current time
+        /// @param fn Callback invoked with each due item (T&&)
+        /// @return Number of items delivered
+        template <typename Fn> inline size_t drain_ready(uint64_t now_ns, Fn &&fn) {
+            size_t count = 0;
+            while (ready(now_ns)) {
+                auto result = pop_ready(now_ns);
+                fn(std::move(result.value()));
+                ++count;
+            }
+            return count;
+        }
+
+        /// Get the earliest deadline held
+        /// @return Deadline in nanoseconds, or NO_DEADLINE if empty
+        inline uint64_t next_deadline() const {
+            if (empty()) {
+                return NO_DEADLINE;
+            }
+            return from_heap() ? heap_.front().deadline_ns : fifo_.front().deadline_ns;
+        }
+
+        /// Check if no items are held
+        inline bool empty() const { return fifo_.empty() && heap_.empty(); }
+
+        /// Get number of items held
+        inline size_t size() const { return fifo_.size() + heap_.size(); }
+
+        /// Discard all held items
+        inline void clear() {
+            fifo_.clear();
+            heap_.clear();
+        }
+
+      private:
+        struct Entry {
+            uint64_t deadline_ns; ///< Delivery deadline
+            uint64_t seq;         ///< Insertion order (tie-break for equal deadlines)
+            T item;               ///< Held item
+        };
+
+        std::deque<Entry> fifo_; ///< In-order arrivals (non-decreasing deadlines)
+        Vector<Entry> heap_;     ///< Out-of-order arrivals (min-heap on deadline, seq)
+        uint64_t next_seq_ = 0;  ///< Next insertion sequence number
+
+        /// Heap comparator: true if a comes out after b
+        static inline bool later(const Entry &a, const Entry &b) {
+            return a.deadline_ns != b.deadline_ns ? a.deadline_ns > b.deadline_ns : a.seq > b.seq;
+        }
+
+        /// Helper: True if the earliest item is at the heap top rather than the FIFO front
+        inline bool from_heap() const {
+            if (heap_.empty()) {
+                return false;
+            }
+            return fifo_.empty() || later(fifo_.front(), heap_.front());
+        }
+    };
+
+} // namespace wirebit
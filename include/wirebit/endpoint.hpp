@@ -31,6 +31,31 @@ namespace wirebit {
         /// Get the underlying link
         /// @return Pointer to the link
         virtual Link *link() = 0;
+
+        /// Get the time at which input held by the endpoint becomes receivable (enforce_timing)
+        /// Lets an event loop (LinkReactor, VirtualTimeLoop) wake up for held frames without fd activity.
+        /// @return Deadline in nanoseconds, or UINT64_MAX if nothing is held
+        virtual uint64_t next_deadline() const { return UINT64_MAX; }
+
+        /// Record latency histograms for frames this endpoint takes from its link
+        /// Recorded in process() as frames are pulled from the link, before filtering or delivery
+        /// timing; see Link::set_histograms() for what each histogram holds.
+        /// @param histograms Histograms to record into (must outlive the endpoint), or nullptr to stop
+        inline void set_histograms(LinkHistograms *histograms) { histograms_ = histograms; }
+
+        /// Get the histograms set with set_histograms()
+        /// @return Histograms, or nullptr if not recording
+        inline LinkHistograms *histograms() const { return histograms_; }
+
+      protected:
+        LinkHistograms *histograms_ = nullptr; ///< Latency histograms (optional)
+
+        /// Helper: Record a frame taken from the link into the histograms, if any
+        inline void record_rx(const FrameHeader &header) {
+            if (histograms_ != nullptr) {
+                histograms_->record_rx(header, now_ns());
+            }
+        }
     };
 
 } // namespace wirebit
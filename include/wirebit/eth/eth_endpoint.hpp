@@ -5,12 +5,17 @@
 #include <echo/echo.hpp>
 #include <iomanip>
 #include <memory>
+#include <ostream>
 #include <sstream>
+#include <unordered_set>
+#include <wirebit/common/crc.hpp>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
 #include <wirebit/endpoint.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/rx_queue.hpp>
 
 // Undefine system macros that conflict with our constants
 // (from linux/if_ether.h when NO_HARDWARE is not defined)
@@ -69,10 +74,13 @@ namespace wirebit {
 
     /// Ethernet configuration
     struct EthConfig {
-        uint64_t bandwidth_bps = 1000000000; ///< Bandwidth in bits/second (default: 1 Gbps)
-        bool promiscuous = false;            ///< Promiscuous mode (receive all frames)
-        size_t rx_buffer_size = 100;         ///< Receive buffer size (number of frames)
-        bool calculate_fcs = false;          ///< Calculate and append FCS (normally done by hardware)
+        uint64_t bandwidth_bps = 1000000000;             ///< Bandwidth in bits/second (default: 1 Gbps)
+        bool promiscuous = false;                        ///< Promiscuous mode (receive all frames)
+        size_t rx_buffer_size = 100;                     ///< Receive buffer size (number of frames)
+        bool calculate_fcs = false;                      ///< Append FCS on send, check and strip it on receive
+        RxOverflow rx_overflow = RxOverflow::DropOldest; ///< What a full receive buffer drops
+        Vector<MacAddr> accept_macs{};                   ///< Extra unicast/multicast addresses to receive
+        bool all_multicast = false;                      ///< Receive every multicast frame (like IFF_ALLMULTI)
     };
 
     /// Ethernet L2 frame header
@@ -82,6 +90,97 @@ namespace wirebit {
         uint16_t ethertype; ///< EtherType (network byte order)
     } __attribute__((packed));
 
+    /// Check if a MAC address is a group (multicast or broadcast) address
+    /// @param mac MAC address
+    /// @return true if the I/G bit is set
+    inline bool is_multicast_mac(const MacAddr &mac) { return (mac[0] & 0x01) != 0; }
+
+    /// Hash for MacAddr (for unordered containers)
+    struct MacAddrHash {
+        inline size_t operator()(const MacAddr &mac) const noexcept {
+            uint64_t v = 0;
+            std::memcpy(&v, mac.data(), ETH_ALEN);
+            // 64-bit mix so addresses differing only in the low bytes spread over the buckets
+            v ^= v >> 33;
+            v *= 0xff51afd7ed558ccdULL;
+            v ^= v >> 33;
+            return static_cast<size_t>(v);
+        }
+    };
+
+    /// Non-owning view of the header of an Ethernet frame
+    /// Reads dst/src/ethertype straight out of the frame buffer, so inspecting a frame costs no
+    /// copy or allocation. The view is only valid while the underlying buffer is.
+    class EthHeaderView {
+      public:
+        /// Create a view over a frame buffer
+        /// @param data Frame bytes (starting at the destination MAC)
+        /// @param size Frame length in bytes
+        inline EthHeaderView(const Byte *data, size_t size) : data_(data), size_(size) {}
+
+        /// Create a view over a frame buffer
+        /// @param frame Frame bytes (starting at the destination MAC)
+        inline explicit EthHeaderView(std::span<const Byte> frame) : EthHeaderView(frame.data(), frame.size()) {}
+
+        /// Create a view over a frame buffer
+        /// @param frame Frame bytes (starting at the destination MAC)
+        inline explicit EthHeaderView(const Bytes &frame) : EthHeaderView(frame.data(), frame.size()) {}
+
+        /// Check if the buffer is large enough to hold an Ethernet header
+        inline bool valid() const { return data_ != nullptr && size_ >= ETH_HLEN; }
+
+        /// Get the destination MAC address (view must be valid)
+        inline MacAddr dst_mac() const { return mac_at(0); }
+
+        /// Get the source MAC address (view must be valid)
+        inline MacAddr src_mac() const { return mac_at(ETH_ALEN); }
+
+        /// Get the EtherType in host byte order (view must be valid)
+        inline uint16_t ethertype() const { return static_cast<uint16_t>((data_[12] << 8) | data_[13]); }
+
+        /// Check if the destination is a group (multicast or broadcast) address (view must be valid)
+        inline bool dst_is_multicast() const { return (data_[0] & 0x01) != 0; }
+
+        /// Get the bytes following the header (empty if the view is invalid)
+        inline std::span<const Byte> payload() const {
+            if (!valid()) {
+                return {};
+            }
+            return std::span<const Byte>(data_ + ETH_HLEN, size_ - ETH_HLEN);
+        }
+
+        /// Get the whole frame
+        inline std::span<const Byte> frame() const { return std::span<const Byte>(data_, size_); }
+
+      private:
+        const Byte *data_; ///< Frame bytes
+        size_t size_;      ///< Frame length
+
+        /// Helper: Read a MAC address at a header offset
+        inline MacAddr mac_at(size_t offset) const {
+            MacAddr mac;
+            std::memcpy(mac.data(), data_ + offset, ETH_ALEN);
+            return mac;
+        }
+    };
+
+    /// Stream adaptor that prints a MAC address as aa:bb:cc:dd:ee:ff
+    /// Unlike mac_to_string() nothing is formatted (or allocated) unless the log line is emitted.
+    struct MacFormat {
+        MacAddr mac; ///< Address to print
+
+        friend inline std::ostream &operator<<(std::ostream &os, const MacFormat &f) {
+            static constexpr char hex[] = "0123456789abcdef";
+            char buf[ETH_ALEN * 3];
+            for (size_t i = 0; i < ETH_ALEN; ++i) {
+                buf[i * 3] = hex[f.mac[i] >> 4];
+                buf[i * 3 + 1] = hex[f.mac[i] & 0x0F];
+                buf[i * 3 + 2] = ':';
+            }
+            return os.write(buf, sizeof(buf) - 1);
+        }
+    };
+
     /// Helper function to format MAC address as string
     inline String mac_to_string(const MacAddr &mac) {
         std::stringstream ss;
@@ -112,9 +211,16 @@ namespace wirebit {
         return Result<MacAddr, Error>::ok(mac);
     }
 
-    /// Helper function to create an Ethernet frame
-    inline Bytes make_eth_frame(const MacAddr &dst_mac, const MacAddr &src_mac, uint16_t ethertype,
-                                const Bytes &payload) {
+    /// Helper function to build an Ethernet frame into a caller-owned buffer
+    /// frame is resized in place, so reusing one buffer across calls does not allocate once its
+    /// capacity has grown to the largest frame.
+    /// @param frame Output buffer (previous contents are overwritten)
+    /// @param dst_mac Destination MAC address
+    /// @param src_mac Source MAC address
+    /// @param ethertype EtherType (host byte order)
+    /// @param payload Payload bytes
+    inline void make_eth_frame_into(Bytes &frame, const MacAddr &dst_mac, const MacAddr &src_mac, uint16_t ethertype,
+                                    std::span<const Byte> payload) {
         // Calculate total frame size (header + payload, padded to minimum)
         size_t payload_size = payload.size();
         size_t frame_size = ETH_HLEN + payload_size;
@@ -124,7 +230,7 @@ namespace wirebit {
             frame_size = ETH_ZLEN;
         }
 
-        Bytes frame(frame_size);
+        frame.resize(frame_size);
 
         // Copy destination MAC
         std::memcpy(frame.data(), dst_mac.data(), ETH_ALEN);
@@ -145,36 +251,81 @@ namespace wirebit {
         if (frame_size > ETH_HLEN + payload_size) {
             std::memset(frame.data() + ETH_HLEN + payload_size, 0, frame_size - ETH_HLEN - payload_size);
         }
+    }
+
+    /// Append the Ethernet FCS (CRC32 of the whole frame, least significant byte first as on the wire)
+    /// @param frame Frame from dst MAC through the (padded) payload
+    inline void append_eth_fcs(Bytes &frame) {
+        uint32_t fcs = crc32(frame.data(), frame.size());
+        size_t n = frame.size();
+        frame.resize(n + ETH_FCS_LEN);
+        for (size_t i = 0; i < ETH_FCS_LEN; ++i) {
+            frame[n + i] = static_cast<Byte>(fcs >> (8 * i));
+        }
+    }
+
+    /// Check the FCS at the end of a frame
+    /// @param frame Frame including its trailing 4-byte FCS
+    /// @return true if the FCS matches the rest of the frame
+    inline bool eth_fcs_valid(std::span<const Byte> frame) {
+        if (frame.size() < ETH_HLEN + ETH_FCS_LEN) {
+            return false;
+        }
+        size_t n = frame.size() - ETH_FCS_LEN;
+        uint32_t fcs = crc32(frame.data(), n);
+        for (size_t i = 0; i < ETH_FCS_LEN; ++i) {
+            if (frame[n + i] != static_cast<Byte>(fcs >> (8 * i))) {
+                return false;
+            }
+        }
+        return true;
+    }
 
+    /// Helper function to create an Ethernet frame
+    inline Bytes make_eth_frame(const MacAddr &dst_mac, const MacAddr &src_mac, uint16_t ethertype,
+                                const Bytes &payload) {
+        Bytes frame;
+        make_eth_frame_into(frame, dst_mac, src_mac, ethertype, std::span<const Byte>(payload.data(), payload.size()));
         return frame;
     }
 
-    /// Helper function to parse an Ethernet frame
+    /// Helper function to parse an Ethernet frame (copies the payload out)
     inline Result<Unit, Error> parse_eth_frame(const Bytes &frame, MacAddr &dst_mac, MacAddr &src_mac,
                                                uint16_t &ethertype, Bytes &payload) {
-        if (frame.size() < ETH_HLEN) {
+        EthHeaderView hdr(frame);
+        if (!hdr.valid()) {
+            // Outputs are still written, so callers never read stale or uninitialized values
+            dst_mac = MacAddr{};
+            src_mac = MacAddr{};
+            ethertype = 0;
+            payload.clear();
             return Result<Unit, Error>::err(Error::invalid_argument("Frame too small for Ethernet header"));
         }
 
-        // Extract destination MAC
-        std::memcpy(dst_mac.data(), frame.data(), ETH_ALEN);
-
-        // Extract source MAC
-        std::memcpy(src_mac.data(), frame.data() + ETH_ALEN, ETH_ALEN);
+        dst_mac = hdr.dst_mac();
+        src_mac = hdr.src_mac();
+        ethertype = hdr.ethertype();
 
-        // Extract EtherType (network byte order)
-        ethertype = (static_cast<uint16_t>(frame[12]) << 8) | frame[13];
-
-        // Extract payload (everything after header)
-        size_t payload_size = frame.size() - ETH_HLEN;
-        payload.resize(payload_size);
-        if (payload_size > 0) {
-            std::memcpy(payload.data(), frame.data() + ETH_HLEN, payload_size);
+        // Copy payload (everything after header); use EthHeaderView to inspect without copying
+        std::span<const Byte> body = hdr.payload();
+        payload.resize(body.size());
+        if (!body.empty()) {
+            std::memcpy(payload.data(), body.data(), body.size());
         }
 
         return Result<Unit, Error>::ok(Unit{});
     }
 
+    /// Time a frame occupies the wire at a given bandwidth
+    /// Counts the preamble (8 bytes) and inter-frame gap (12 bytes) on top of the frame itself.
+    /// @param frame_size Frame length in bytes (header + payload, without preamble)
+    /// @param bandwidth_bps Line rate in bits/second (must be non-zero)
+    /// @return Transmission time in nanoseconds
+    inline uint64_t eth_frame_time_ns(size_t frame_size, uint64_t bandwidth_bps) {
+        uint64_t wire_bits = (frame_size + 20) * 8;
+        return (wire_bits * 1000000000ULL) / bandwidth_bps;
+    }
+
     /// Ethernet endpoint for L2 frame communication
     /// TAP-ready design for easy bridging to real network interfaces
     class EthEndpoint : public Endpoint {
@@ -186,17 +337,32 @@ namespace wirebit {
         /// @param mac_addr MAC address for this endpoint
         inline EthEndpoint(std::shared_ptr<Link> link, const EthConfig &config, uint32_t endpoint_id,
                            const MacAddr &mac_addr)
-            : link_(link), config_(config), endpoint_id_(endpoint_id), mac_addr_(mac_addr) {
-            echo::trace("EthEndpoint created: id=", endpoint_id_, " MAC=", mac_to_string(mac_addr_).c_str(),
-                        " bandwidth=", config_.bandwidth_bps / 1000000, " Mbps");
+            : link_(link), config_(config), endpoint_id_(endpoint_id), mac_addr_(mac_addr),
+              rx_buffer_(config.rx_buffer_size, config.rx_overflow) {
+            accept_macs_.insert(mac_addr_);
+            accept_macs_.insert(MAC_BROADCAST);
+            for (const MacAddr &mac : config_.accept_macs) {
+                accept_macs_.insert(mac);
+            }
+            WIREBIT_TRACE("EthEndpoint created: id=", endpoint_id_, " MAC=", MacFormat{mac_addr_}, " bandwidth=",
+                          config_.bandwidth_bps / 1000000, " Mbps");
         }
 
         /// Send an Ethernet frame
         /// @param eth_frame Complete L2 Ethernet frame (dst MAC + src MAC + ethertype + payload)
         /// @return Result indicating success or error
         inline Result<Unit, Error> send_eth(const Bytes &eth_frame) {
+            return send_eth(std::span<const Byte>(eth_frame.data(), eth_frame.size()));
+        }
+
+        /// Send an Ethernet frame from a borrowed buffer
+        /// The frame goes to the link as a FrameView, so it is not copied on the way.
+        /// @param eth_frame Complete L2 Ethernet frame (dst MAC + src MAC + ethertype + payload)
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send_eth(std::span<const Byte> eth_frame) {
             // Validate frame size
-            if (eth_frame.size() < ETH_HLEN) {
+            EthHeaderView hdr(eth_frame);
+            if (!hdr.valid()) {
                 echo::error("Frame too small for Ethernet header: ", eth_frame.size(), " bytes").red();
                 return Result<Unit, Error>::err(Error::invalid_argument("Frame too small"));
             }
@@ -205,56 +371,48 @@ namespace wirebit {
                 echo::warn("Frame exceeds MTU: ", eth_frame.size(), " bytes (max ", ETH_FRAME_LEN, ")").yellow();
             }
 
-            // Parse frame for logging
-            MacAddr dst_mac, src_mac;
-            uint16_t ethertype;
-            Bytes payload;
-            auto parse_result = parse_eth_frame(eth_frame, dst_mac, src_mac, ethertype, payload);
-            if (!parse_result.is_ok()) {
-                echo::error("Failed to parse Ethernet frame: ", parse_result.error().message.c_str()).red();
-                return Result<Unit, Error>::err(parse_result.error());
+            // Append the FCS (in place when the frame was built by send())
+            if (config_.calculate_fcs) {
+                if (eth_frame.data() != tx_frame_.data()) {
+                    tx_frame_.assign(eth_frame.data(), eth_frame.data() + eth_frame.size());
+                }
+                append_eth_fcs(tx_frame_);
+                eth_frame = std::span<const Byte>(tx_frame_.data(), tx_frame_.size());
+                // The append may have reallocated the buffer the view pointed into
+                hdr = EthHeaderView(eth_frame.first(eth_frame.size() - ETH_FCS_LEN));
             }
 
-            echo::trace("Ethernet send: ", eth_frame.size(), " bytes, dst=", mac_to_string(dst_mac).c_str(),
-                        " src=", mac_to_string(src_mac).c_str(), " type=0x", std::hex, std::setfill('0'), std::setw(4),
-                        ethertype, std::dec);
+            WIREBIT_TRACE("Ethernet send: ", eth_frame.size(), " bytes, dst=", MacFormat{hdr.dst_mac()},
+                          " src=", MacFormat{hdr.src_mac()}, " type=0x", std::hex, std::setfill('0'), std::setw(4),
+                          hdr.ethertype(), std::dec);
 
             // Log payload details
-            if (payload.size() > 0) {
-                echo::debug("Payload: ", payload.size(), " bytes");
+            std::span<const Byte> payload = hdr.payload();
+            if (!payload.empty()) {
+                WIREBIT_DEBUG("Payload: ", payload.size(), " bytes");
                 if (payload.size() <= 32) {
-                    std::stringstream ss;
-                    ss << "Data: ";
-                    for (size_t i = 0; i < payload.size(); ++i) {
-                        ss << std::hex << std::setfill('0') << std::setw(2) << (int)payload[i];
-                        if (i < payload.size() - 1)
-                            ss << " ";
-                    }
-                    echo::trace(ss.str().c_str());
+                    WIREBIT_TRACE("Data: ", HexFormat{payload});
                 }
             }
 
-            // Create wirebit frame
-            Frame frame = make_frame(FrameType::ETHERNET, eth_frame, endpoint_id_, 0); // 0 = broadcast
+            // Borrow the frame for the link (0 = broadcast)
+            FrameView frame = make_view(FrameType::ETHERNET, eth_frame, endpoint_id_, 0);
 
-            // Calculate transmission time based on bandwidth
-            // Ethernet frame on wire: preamble(8) + frame + IFG(12) = 20 bytes overhead
-            uint64_t wire_bytes = eth_frame.size() + 20;
-            uint64_t wire_bits = wire_bytes * 8;
-            uint64_t frame_time_ns = (wire_bits * 1000000000ULL) / config_.bandwidth_bps;
+            // Calculate transmission time based on bandwidth (preamble and IFG included)
+            uint64_t frame_time_ns = eth_frame_time_ns(eth_frame.size(), config_.bandwidth_bps);
 
-            echo::debug("Ethernet frame time: ", frame_time_ns, "ns (", wire_bits, " bits at ",
-                        config_.bandwidth_bps / 1000000, " Mbps)");
+            WIREBIT_DEBUG("Ethernet frame time: ", frame_time_ns, "ns (", (eth_frame.size() + 20) * 8, " bits at ",
+                          config_.bandwidth_bps / 1000000, " Mbps)");
 
             // Apply bandwidth shaping
             uint64_t now = now_ns();
             last_tx_deliver_at_ns_ = std::max(now, last_tx_deliver_at_ns_) + frame_time_ns;
             frame.header.deliver_at_ns = last_tx_deliver_at_ns_;
 
-            echo::trace("Frame deliver_at: ", frame.header.deliver_at_ns, "ns");
+            WIREBIT_TRACE("Frame deliver_at: ", frame.header.deliver_at_ns, "ns");
 
             // Send frame through link
-            auto result = link_->send(frame);
+            auto result = link_->send_view(frame);
             if (!result.is_ok()) {
                 echo::error("Failed to send frame: ", result.error().message.c_str()).red();
                 return result;
@@ -269,40 +427,47 @@ namespace wirebit {
         /// @return Result indicating success or error
         inline Result<Unit, Error> send(const Bytes &data) override {
             // Create Ethernet frame with broadcast destination and IPv4 ethertype
-            Bytes eth_frame = make_eth_frame(MAC_BROADCAST, mac_addr_, ETH_P_IP, data);
-            return send_eth(eth_frame);
+            make_eth_frame_into(tx_frame_, MAC_BROADCAST, mac_addr_, ETH_P_IP,
+                                std::span<const Byte>(data.data(), data.size()));
+            return send_eth(tx_frame_);
         }
 
         /// Receive an Ethernet frame (non-blocking)
         /// @return Result containing received Ethernet frame or error
         inline Result<Bytes, Error> recv_eth() {
-            echo::trace("EthEndpoint::recv_eth called");
+            Bytes frame;
+            auto result = recv_eth_into(frame);
+            if (!result.is_ok()) {
+                return Result<Bytes, Error>::err(result.error());
+            }
+            return Result<Bytes, Error>::ok(std::move(frame));
+        }
+
+        /// Receive an Ethernet frame into a caller-owned buffer (non-blocking)
+        /// The frame is swapped out of the receive queue and frame's old storage is recycled for a
+        /// later frame, so a loop that reuses one buffer does not allocate per frame.
+        /// @param frame Output Ethernet frame
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> recv_eth_into(Bytes &frame) {
+            WIREBIT_TRACE("EthEndpoint::recv_eth called");
 
             // Process incoming frames first
             auto process_result = process();
             if (!process_result.is_ok()) {
-                echo::trace("Process returned: ", process_result.error().message.c_str());
+                WIREBIT_TRACE("Process returned: ", process_result.error().message.c_str());
             }
 
             // Return buffered frame if available
-            if (!rx_buffer_.empty()) {
-                Bytes frame = rx_buffer_[0];
-                rx_buffer_.erase(rx_buffer_.begin());
+            if (rx_buffer_.pop_swap(frame)) {
+                EthHeaderView hdr(frame);
+                WIREBIT_TRACE("Ethernet recv: ", frame.size(), " bytes, dst=", MacFormat{hdr.dst_mac()},
+                              " src=", MacFormat{hdr.src_mac()}, " type=0x", std::hex, std::setfill('0'), std::setw(4),
+                              hdr.ethertype(), std::dec);
 
-                // Parse frame for logging
-                MacAddr dst_mac, src_mac;
-                uint16_t ethertype;
-                Bytes payload;
-                parse_eth_frame(frame, dst_mac, src_mac, ethertype, payload);
-
-                echo::trace("Ethernet recv: ", frame.size(), " bytes, dst=", mac_to_string(dst_mac).c_str(),
-                            " src=", mac_to_string(src_mac).c_str(), " type=0x", std::hex, std::setfill('0'),
-                            std::setw(4), ethertype, std::dec);
-
-                return Result<Bytes, Error>::ok(frame);
+                return Result<Unit, Error>::ok(Unit{});
             }
 
-            return Result<Bytes, Error>::err(Error::timeout("No frames available"));
+            return Result<Unit, Error>::err(Error::timeout("No frames available"));
         }
 
         /// Receive data using the generic Endpoint interface
@@ -312,15 +477,16 @@ namespace wirebit {
         /// Process incoming frames from the link
         /// @return Result indicating success or error
         inline Result<Unit, Error> process() override {
-            echo::trace("EthEndpoint::process called");
+            WIREBIT_TRACE("EthEndpoint::process called");
 
-            // Receive frame from link
-            auto result = link_->recv();
+            // Receive frame from link (borrowed until the next recv on the link)
+            auto result = link_->recv_view();
             if (!result.is_ok()) {
                 return Result<Unit, Error>::err(result.error());
             }
 
-            Frame frame = result.value();
+            const FrameView &frame = result.value();
+            record_rx(frame.header);
 
             // Validate frame type
             if (frame.header.frame_type != static_cast<uint16_t>(FrameType::ETHERNET)) {
@@ -328,54 +494,49 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::invalid_argument("Wrong frame type"));
             }
 
-            // Wait until frame is ready to be delivered
-            uint64_t now = now_ns();
-            if (now < frame.header.deliver_at_ns) {
-                int64_t wait_ns = frame.header.deliver_at_ns - now;
-                echo::trace("Waiting ", wait_ns, "ns for frame delivery");
-                usleep(wait_ns / 1000);
-            }
-
-            // Extract Ethernet frame from payload
-            Bytes eth_frame = frame.payload;
-
-            // Parse frame for filtering
-            MacAddr dst_mac, src_mac;
-            uint16_t ethertype;
-            Bytes payload;
-            auto parse_result = parse_eth_frame(eth_frame, dst_mac, src_mac, ethertype, payload);
-            if (!parse_result.is_ok()) {
-                echo::warn("Failed to parse received frame: ", parse_result.error().message.c_str()).yellow();
-                return Result<Unit, Error>::err(parse_result.error());
-            }
-
-            // Filter frames unless in promiscuous mode
-            bool is_for_us = false;
-            if (config_.promiscuous) {
-                is_for_us = true;
-                echo::trace("Promiscuous mode: accepting all frames");
-            } else {
-                // Accept if destination is our MAC or broadcast
-                if (dst_mac == mac_addr_ || dst_mac == MAC_BROADCAST) {
-                    is_for_us = true;
-                    echo::trace("Frame is for us (dst=", mac_to_string(dst_mac).c_str(), ")");
-                } else {
-                    echo::trace("Frame not for us (dst=", mac_to_string(dst_mac).c_str(), "), dropping");
+            // Ethernet frame is the payload (minus its FCS when the link carries one)
+            std::span<const Byte> eth_frame = frame.payload;
+            if (config_.calculate_fcs) {
+                if (!eth_fcs_valid(eth_frame)) {
+                    rx_fcs_errors_++;
+                    echo::warn("Dropping Ethernet frame with bad FCS: ", eth_frame.size(), " bytes").yellow();
+                    return Result<Unit, Error>::err(Error::invalid_argument("Bad Ethernet FCS"));
                 }
+                eth_frame = eth_frame.first(eth_frame.size() - ETH_FCS_LEN);
+            }
+            EthHeaderView hdr(eth_frame);
+            if (!hdr.valid()) {
+                echo::warn("Failed to parse received frame: ", eth_frame.size(), " bytes").yellow();
+                return Result<Unit, Error>::err(Error::invalid_argument("Frame too small for Ethernet header"));
             }
 
-            if (!is_for_us) {
+            // Filter frames unless in promiscuous mode (before waiting or buffering)
+            if (!config_.promiscuous && !accepts_mac(hdr.dst_mac())) {
+                rx_filtered_++;
+                WIREBIT_TRACE("Frame not for us (dst=", MacFormat{hdr.dst_mac()}, "), dropping");
                 return Result<Unit, Error>::err(Error::invalid_argument("Frame not for this endpoint"));
             }
 
-            // Buffer the frame
-            if (rx_buffer_.size() >= config_.rx_buffer_size) {
-                echo::warn("RX buffer full, dropping oldest frame").yellow();
-                rx_buffer_.erase(rx_buffer_.begin());
+            // Wait until frame is ready to be delivered
+            uint64_t now = now_ns();
+            if (now < frame.header.deliver_at_ns) {
+                WIREBIT_TRACE("Waiting ", frame.header.deliver_at_ns - now, "ns for frame delivery");
+                sleep_until_ns(static_cast<TimeNs>(frame.header.deliver_at_ns));
             }
 
-            rx_buffer_.push_back(eth_frame);
-            echo::debug("Frame buffered, rx_buffer size: ", rx_buffer_.size());
+            // Buffer the frame (copied into a preallocated slot, reusing its storage)
+            if (rx_buffer_.full()) {
+                echo::warn("RX buffer full, dropping ",
+                           config_.rx_overflow == RxOverflow::DropOldest ? "oldest" : "newest", " frame")
+                    .yellow();
+            }
+            Bytes *slot = rx_buffer_.push_slot();
+            if (slot == nullptr) {
+                return Result<Unit, Error>::err(Error::timeout("RX buffer full"));
+            }
+            slot->resize(eth_frame.size());
+            std::memcpy(slot->data(), eth_frame.data(), eth_frame.size());
+            WIREBIT_DEBUG("Frame buffered, rx_buffer size: ", rx_buffer_.size());
 
             return Result<Unit, Error>::ok(Unit{});
         }
@@ -388,6 +549,42 @@ namespace wirebit {
         /// @return Ethernet configuration
         inline const EthConfig &get_config() const { return config_; }
 
+        /// Receive frames sent to an extra unicast or multicast address
+        /// @param mac Address to accept
+        inline void add_accept_mac(const MacAddr &mac) { accept_macs_.insert(mac); }
+
+        /// Stop receiving frames sent to an address added with add_accept_mac()
+        /// The endpoint's own MAC and broadcast are always accepted and cannot be removed.
+        /// @param mac Address to remove
+        /// @return true if the address was in the table
+        inline bool remove_accept_mac(const MacAddr &mac) {
+            if (mac == mac_addr_ || mac == MAC_BROADCAST) {
+                return false;
+            }
+            return accept_macs_.erase(mac) > 0;
+        }
+
+        /// Check if a non-promiscuous endpoint receives frames for a destination
+        /// @param dst_mac Destination MAC address
+        /// @return true if dst_mac is our MAC, broadcast, in the accept table, or any multicast with all_multicast
+        inline bool accepts_mac(const MacAddr &dst_mac) const {
+            if (dst_mac == mac_addr_) {
+                return true;
+            }
+            if (config_.all_multicast && is_multicast_mac(dst_mac)) {
+                return true;
+            }
+            return accept_macs_.count(dst_mac) > 0;
+        }
+
+        /// Get number of frames dropped by the MAC accept table
+        /// @return Number of filtered frames
+        inline uint64_t filtered_count() const { return rx_filtered_; }
+
+        /// Get number of frames dropped for a bad FCS (calculate_fcs)
+        /// @return Number of FCS errors
+        inline uint64_t fcs_error_count() const { return rx_fcs_errors_; }
+
         /// Get endpoint name
         /// @return Endpoint name
         inline String name() const override {
@@ -408,19 +605,27 @@ namespace wirebit {
         /// @return Number of buffered frames
         inline size_t rx_buffer_size() const { return rx_buffer_.size(); }
 
+        /// Get number of frames lost because the receive buffer was full
+        /// @return Number of dropped frames
+        inline uint64_t rx_dropped() const { return rx_buffer_.dropped(); }
+
         /// Clear receive buffer
         inline void clear_rx_buffer() {
-            echo::debug("Clearing RX buffer: ", rx_buffer_.size(), " frames discarded");
+            WIREBIT_DEBUG("Clearing RX buffer: ", rx_buffer_.size(), " frames discarded");
             rx_buffer_.clear();
         }
 
       private:
-        std::shared_ptr<Link> link_;        ///< Underlying link
-        EthConfig config_;                  ///< Ethernet configuration
-        uint32_t endpoint_id_;              ///< Endpoint identifier
-        MacAddr mac_addr_;                  ///< MAC address
-        Vector<Bytes> rx_buffer_;           ///< Receive buffer
-        uint64_t last_tx_deliver_at_ns_{0}; ///< Last transmission delivery time
+        std::shared_ptr<Link> link_;                           ///< Underlying link
+        EthConfig config_;                                     ///< Ethernet configuration
+        uint32_t endpoint_id_;                                 ///< Endpoint identifier
+        MacAddr mac_addr_;                                     ///< MAC address
+        RxQueue<Bytes> rx_buffer_;                             ///< Receive buffer
+        uint64_t last_tx_deliver_at_ns_{0};                    ///< Last transmission delivery time
+        std::unordered_set<MacAddr, MacAddrHash> accept_macs_; ///< Destinations received without promiscuous mode
+        uint64_t rx_filtered_ = 0;                             ///< Frames rejected by accept_macs_
+        uint64_t rx_fcs_errors_ = 0;                           ///< Frames rejected by their FCS
+        Bytes tx_frame_;                                       ///< Reused buffer for send() and FCS framing
     };
 
     /// Helper function to create a standard Ethernet endpoint with auto-generated MAC
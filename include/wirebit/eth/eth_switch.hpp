@@ -0,0 +1,769 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <memory>
+#include <thread>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/eth/eth_endpoint.hpp>
+#include <wirebit/frame.hpp>
+#include <wirebit/link.hpp>
+#include <wirebit/link_reactor.hpp>
+#include <wirebit/rx_queue.hpp>
+
+namespace wirebit {
+
+    /// Number of 802.1Q VLAN IDs (VID 0 and 4095 are reserved)
+    constexpr size_t ETH_VLAN_COUNT = 4096;
+
+    /// Port returned by MacTable::lookup() for unknown or aged-out addresses
+    constexpr uint32_t MAC_TABLE_MISS = UINT32_MAX;
+
+    /// Outcome of MacTable::learn()
+    enum class MacLearn : uint8_t {
+        Refreshed, ///< Known on the same port, age reset
+        Learned,   ///< New entry
+        Moved,     ///< Known on another port (the station moved), entry updated
+        Full,      ///< Table full, address not learned
+    };
+
+    /// Flat open-addressing MAC address table with aging
+    /// Keys are (VLAN, MAC) pairs packed into one 64-bit word. Slots are a power-of-two array probed
+    /// linearly and kept at most 3/4 full; removal shifts the following entries back instead of
+    /// leaving tombstones, so a lookup stops at the first empty slot. An entry not refreshed for
+    /// aging_ns is treated as absent by lookup() and reclaimed by age().
+    class MacTable {
+      public:
+        /// Create a table
+        /// @param max_entries Entries the table must hold (slots are rounded up to a power of two)
+        /// @param aging_ns Forget an entry after this long without learn() (0 = never)
+        inline explicit MacTable(size_t max_entries = 4096, uint64_t aging_ns = 300000000000ULL)
+            : aging_ns_(aging_ns) {
+            size_t slots = 16;
+            while (slots * 3 / 4 < max_entries) {
+                slots <<= 1;
+            }
+            slots_.resize(slots);
+            mask_ = slots - 1;
+        }
+
+        /// Learn (or refresh) the port a source address was seen on
+        /// @param mac Source MAC address
+        /// @param vlan VLAN the frame belongs to (0 without VLAN separation)
+        /// @param port Ingress port
+        /// @param now Current time in nanoseconds
+        /// @return What changed in the table
+        inline MacLearn learn(const MacAddr &mac, uint16_t vlan, uint32_t port, uint64_t now) {
+            uint64_t key = key_of(mac, vlan);
+            for (size_t i = home(key);; i = (i + 1) & mask_) {
+                Slot &slot = slots_[i];
+                if (slot.key == key) {
+                    MacLearn result = slot.port == port ? MacLearn::Refreshed : MacLearn::Moved;
+                    slot.port = port;
+                    slot.seen_ns = now;
+                    return result;
+                }
+                if (slot.key == EMPTY) {
+                    if (count_ >= max_entries()) {
+                        return MacLearn::Full;
+                    }
+                    slot.key = key;
+                    slot.port = port;
+                    slot.seen_ns = now;
+                    ++count_;
+                    return MacLearn::Learned;
+                }
+            }
+        }
+
+        /// Find the port an address was learned on
+        /// @param mac Destination MAC address
+        /// @param vlan VLAN the frame belongs to
+        /// @param now Current time in nanoseconds
+        /// @return Port, or MAC_TABLE_MISS if unknown or aged out
+        inline uint32_t lookup(const MacAddr &mac, uint16_t vlan, uint64_t now) const {
+            size_t i = find(key_of(mac, vlan));
+            if (i == SIZE_MAX || expired(slots_[i], now)) {
+                return MAC_TABLE_MISS;
+            }
+            return slots_[i].port;
+        }
+
+        /// Forget one address
+        /// @return true if it was in the table
+        inline bool remove(const MacAddr &mac, uint16_t vlan) {
+            size_t i = find(key_of(mac, vlan));
+            if (i == SIZE_MAX) {
+                return false;
+            }
+            erase_at(i);
+            return true;
+        }
+
+        /// Forget every address learned on a port (e.g. after its link went down)
+        /// @return Number of entries removed
+        inline size_t remove_port(uint32_t port) {
+            return erase_if([port](const Slot &slot) { return slot.port == port; });
+        }
+
+        /// Remove the entries older than aging_ns
+        /// @param now Current time in nanoseconds
+        /// @return Number of entries removed
+        inline size_t age(uint64_t now) {
+            if (aging_ns_ == 0) {
+                return 0;
+            }
+            return erase_if([this, now](const Slot &slot) { return expired(slot, now); });
+        }
+
+        /// Remove every entry
+        inline void clear() {
+            std::fill(slots_.begin(), slots_.end(), Slot{});
+            count_ = 0;
+        }
+
+        /// Get number of entries (including aged ones age() has not removed yet)
+        inline size_t size() const { return count_; }
+
+        /// Get the number of entries the table holds before learn() reports Full
+        inline size_t max_entries() const { return slots_.size() * 3 / 4; }
+
+        /// Get the aging time in nanoseconds
+        inline uint64_t aging_ns() const { return aging_ns_; }
+
+      private:
+        static constexpr uint64_t EMPTY = UINT64_MAX; ///< Key of a free slot (VLAN bits never reach it)
+
+        struct Slot {
+            uint64_t key = EMPTY; ///< VLAN << 48 | MAC
+            uint64_t seen_ns = 0; ///< Last learn()
+            uint32_t port = 0;    ///< Port the address was seen on
+        };
+
+        Vector<Slot> slots_;
+        size_t mask_ = 0;
+        size_t count_ = 0;
+        uint64_t aging_ns_ = 0;
+
+        static inline uint64_t key_of(const MacAddr &mac, uint16_t vlan) {
+            uint64_t key = 0;
+            std::memcpy(&key, mac.data(), ETH_ALEN);
+            return key | (static_cast<uint64_t>(vlan & 0x0FFF) << 48);
+        }
+
+        /// Helper: Preferred slot of a key (same 64-bit mix as MacAddrHash)
+        inline size_t home(uint64_t key) const {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<size_t>(key) & mask_;
+        }
+
+        inline bool expired(const Slot &slot, uint64_t now) const {
+            return aging_ns_ != 0 && now > slot.seen_ns && now - slot.seen_ns > aging_ns_;
+        }
+
+        inline size_t find(uint64_t key) const {
+            for (size_t i = home(key);; i = (i + 1) & mask_) {
+                if (slots_[i].key == key) {
+                    return i;
+                }
+                if (slots_[i].key == EMPTY) {
+                    return SIZE_MAX;
+                }
+            }
+        }
+
+        /// Helper: Empty a slot and shift the rest of its probe run back into the gap
+        inline void erase_at(size_t gap) {
+            for (size_t i = (gap + 1) & mask_; slots_[i].key != EMPTY; i = (i + 1) & mask_) {
+                // The entry may fill the gap if the gap lies between its home slot and where it sits
+                size_t h = home(slots_[i].key);
+                if (((i - h) & mask_) >= ((i - gap) & mask_)) {
+                    slots_[gap] = slots_[i];
+                    gap = i;
+                }
+            }
+            slots_[gap] = Slot{};
+            --count_;
+        }
+
+        /// Helper: Remove every entry matching a predicate
+        /// An entry shifted into the slot just emptied is checked again before moving on.
+        template <typename Pred> inline size_t erase_if(Pred &&pred) {
+            size_t removed = 0;
+            for (size_t i = 0; i < slots_.size(); ++i) {
+                while (slots_[i].key != EMPTY && pred(slots_[i])) {
+                    erase_at(i);
+                    ++removed;
+                }
+            }
+            return removed;
+        }
+    };
+
+    /// EthSwitch configuration
+    struct EthSwitchConfig {
+        size_t mac_table_size = 4096;        ///< MAC table entries (all VLANs together)
+        uint64_t aging_ns = 300000000000ULL; ///< Forget a station after this long without traffic (0 = never)
+        bool vlans = false;                  ///< Separate traffic by 802.1Q VLAN (see EthPortConfig)
+        size_t batch = 32;                   ///< Frames taken from a port per turn
+        uint64_t retry_ns = 100000;          ///< Wait before resending to a port link that was full
+        uint64_t idle_sleep_ns = 50000;      ///< Longest sleep of the start() thread when nothing moved
+    };
+
+    /// Configuration of one EthSwitch port
+    struct EthPortConfig {
+        uint64_t bandwidth_bps = 1000000000; ///< Egress line rate, shaped like EthConfig::bandwidth_bps (0 = unshaped)
+        size_t queue_frames = 256;           ///< Egress queue depth (frames beyond it are tail-dropped)
+        uint16_t pvid = 1;                   ///< VLAN of untagged frames, sent untagged (0 = tagged frames only)
+        Vector<uint16_t> tagged_vlans = {};  ///< VLANs carried with their 802.1Q tag (trunk port)
+    };
+
+    /// Statistics for one EthSwitch port
+    struct EthPortStats {
+        uint64_t frames_received = 0; ///< Frames taken from the port link
+        uint64_t bytes_received = 0;
+        uint64_t frames_sent = 0;     ///< Frames handed to the port link
+        uint64_t bytes_sent = 0;
+        uint64_t queue_drops = 0;     ///< Frames tail-dropped on a full egress queue
+        uint64_t send_errors = 0;     ///< Frames the port link rejected with an error (dropped)
+        uint64_t backpressure = 0;    ///< Sends the port link refused as full (retried after retry_ns)
+        uint64_t vlan_filtered = 0;   ///< Received frames of a VLAN the port is not a member of
+        uint64_t frames_ignored = 0;  ///< Non-Ethernet or malformed frames discarded
+
+        inline void reset() {
+            frames_received = 0;
+            bytes_received = 0;
+            frames_sent = 0;
+            bytes_sent = 0;
+            queue_drops = 0;
+            send_errors = 0;
+            backpressure = 0;
+            vlan_filtered = 0;
+            frames_ignored = 0;
+        }
+    };
+
+    /// Statistics for an EthSwitch
+    struct EthSwitchStats {
+        uint64_t frames_received = 0; ///< Valid frames taken from all ports
+        uint64_t unicast = 0;         ///< Frames forwarded to their learned port only
+        uint64_t flooded = 0;         ///< Broadcast, multicast and unknown unicast frames sent to every other port
+        uint64_t filtered = 0;        ///< Frames whose destination was learned on the ingress port (not forwarded)
+        uint64_t mac_learned = 0;     ///< MAC table entries added
+        uint64_t mac_moved = 0;       ///< Stations seen on a new port
+        uint64_t mac_aged = 0;        ///< Entries removed by aging
+        uint64_t table_full = 0;      ///< Source addresses not learned because the table was full
+
+        inline void reset() {
+            frames_received = 0;
+            unicast = 0;
+            flooded = 0;
+            filtered = 0;
+            mac_learned = 0;
+            mac_moved = 0;
+            mac_aged = 0;
+            table_full = 0;
+        }
+    };
+
+    namespace detail {
+        /// One switch port: its link, VLAN membership and shaped egress queue
+        struct EthSwitchPort {
+            std::shared_ptr<Link> link;
+            EthPortConfig config;
+            uint32_t index = 0;                  ///< Port index (the value learned in the MAC table)
+            std::bitset<ETH_VLAN_COUNT> members; ///< VLANs the port belongs to (pvid and tagged_vlans)
+            RxQueue<Frame> queue;                ///< Egress frames; deliver_at_ns holds when a frame may leave
+            uint64_t free_at_ns = 0;             ///< End of the frame last sent (line busy until then)
+            uint64_t retry_at_ns = 0;            ///< No sends before this after backpressure
+            EthPortStats stats;
+
+            /// Earliest time the egress queue can send again
+            inline uint64_t next_deadline() const {
+                if (queue.empty()) {
+                    return UINT64_MAX;
+                }
+                uint64_t ready = std::max(queue.front().header.deliver_at_ns, retry_at_ns);
+                return config.bandwidth_bps > 0 ? std::max(ready, free_at_ns) : ready;
+            }
+        };
+
+        /// Switch engine, kept behind a unique_ptr so the thread and reactor handlers see a stable address
+        struct EthSwitchCore {
+            EthSwitchConfig config;
+            MacTable table;
+            Vector<std::unique_ptr<EthSwitchPort>> ports;
+            EthSwitchStats stats;
+            uint64_t next_age_ns = 0; ///< Next MAC table sweep
+
+            LinkReactor *reactor = nullptr; ///< Reactor given to attach(), if any
+            std::atomic<bool> running{false};
+            std::thread thread;
+
+            /// Take input from every port and send what is due
+            /// @param more Set if a port still had input when its batch ran out
+            /// @return Frames sent to ports
+            inline size_t pump(bool &more) {
+                for (auto &port : ports) {
+                    more = collect(*port) || more;
+                }
+                return drain_all();
+            }
+
+            /// Take up to one batch of frames from a port and queue them on their egress ports
+            /// @return true if the batch ran out before the port did
+            inline bool collect(EthSwitchPort &in) {
+                uint64_t now = now_ns();
+                if (now >= next_age_ns) {
+                    age(now);
+                }
+                for (size_t n = 0; n < config.batch; ++n) {
+                    auto frame = in.link->recv_view();
+                    if (!frame.is_ok()) {
+                        return false;
+                    }
+                    switch_frame(in, frame.value(), now);
+                }
+                return true;
+            }
+
+            /// Send what is due on every egress queue
+            inline size_t drain_all() {
+                uint64_t now = now_ns();
+                size_t sent = 0;
+                for (auto &port : ports) {
+                    sent += drain(*port, now);
+                }
+                return sent;
+            }
+
+            /// Earliest egress deadline of all ports
+            inline uint64_t next_deadline() const {
+                uint64_t deadline = UINT64_MAX;
+                for (const auto &port : ports) {
+                    deadline = std::min(deadline, port->next_deadline());
+                }
+                return deadline;
+            }
+
+            /// Helper: Learn the source of one received frame and queue it where it has to go
+            inline void switch_frame(EthSwitchPort &in, const FrameView &frame, uint64_t now) {
+                uint32_t src = in.index;
+                EthHeaderView hdr(frame.payload);
+                if (frame.type() != FrameType::ETHERNET || !hdr.valid()) {
+                    in.stats.frames_ignored++;
+                    return;
+                }
+                in.stats.frames_received++;
+                in.stats.bytes_received += frame.payload.size();
+
+                // Classify: untagged and priority-tagged frames belong to the port's PVID
+                uint16_t vlan = 0;
+                uint16_t tci = 0;
+                bool tagged = false;
+                if (config.vlans) {
+                    if (hdr.ethertype() == ETH_P_8021Q && frame.payload.size() >= ETH_HLEN + 4) {
+                        tci = static_cast<uint16_t>((frame.payload[14] << 8) | frame.payload[15]);
+                        tagged = true;
+                    }
+                    vlan = (tci & 0x0FFF) != 0 ? (tci & 0x0FFF) : in.config.pvid;
+                    if (vlan == 0 || !in.members.test(vlan)) {
+                        in.stats.vlan_filtered++;
+                        WIREBIT_TRACE("EthSwitch: port ", src, " is not in VLAN ", vlan, ", dropping");
+                        return;
+                    }
+                    tci = static_cast<uint16_t>((tci & 0xF000) | vlan);
+                }
+                stats.frames_received++;
+
+                MacAddr src_mac = hdr.src_mac();
+                if (!is_multicast_mac(src_mac)) {
+                    switch (table.learn(src_mac, vlan, src, now)) {
+                    case MacLearn::Learned:
+                        stats.mac_learned++;
+                        WIREBIT_TRACE("EthSwitch: learned ", MacFormat{src_mac}, " on port ", src, " (VLAN ", vlan,
+                                      ")");
+                        break;
+                    case MacLearn::Moved:
+                        stats.mac_moved++;
+                        break;
+                    case MacLearn::Full:
+                        stats.table_full++;
+                        break;
+                    case MacLearn::Refreshed:
+                        break;
+                    }
+                }
+
+                uint32_t dst = hdr.dst_is_multicast() ? MAC_TABLE_MISS : table.lookup(hdr.dst_mac(), vlan, now);
+                if (dst == src) {
+                    stats.filtered++;
+                    return;
+                }
+                if (dst != MAC_TABLE_MISS) {
+                    stats.unicast++;
+                    enqueue(*ports[dst], frame, vlan, tci, tagged, now);
+                    return;
+                }
+                stats.flooded++;
+                for (auto &out : ports) {
+                    if (out.get() != &in && (!config.vlans || out->members.test(vlan))) {
+                        enqueue(*out, frame, vlan, tci, tagged, now);
+                    }
+                }
+            }
+
+            /// Helper: Copy a frame into an egress queue, adding or removing its 802.1Q tag for that port
+            inline void enqueue(EthSwitchPort &out, const FrameView &frame, uint16_t vlan, uint16_t tci, bool tagged,
+                                uint64_t now) {
+                Frame *slot = out.queue.push_slot();
+                if (slot == nullptr) {
+                    out.stats.queue_drops++;
+                    return;
+                }
+                slot->header = frame.header;
+                slot->meta.assign(frame.meta.data(), frame.meta.data() + frame.meta.size());
+
+                // Store-and-forward: the frame may leave once it has fully arrived
+                slot->header.deliver_at_ns = std::max(frame.header.deliver_at_ns, now);
+
+                bool tag_out = config.vlans && vlan != out.config.pvid;
+                const Byte *data = frame.payload.data();
+                size_t size = frame.payload.size();
+                if (tag_out == tagged) {
+                    slot->payload.assign(data, data + size);
+                    if (!tag_out) {
+                        return;
+                    }
+                    // Tagged in and out: the VID may still be 0 (priority tag)
+                    slot->payload[14] = static_cast<Byte>(tci >> 8);
+                    slot->payload[15] = static_cast<Byte>(tci & 0xFF);
+                } else if (tag_out) {
+                    slot->payload.resize(size + 4);
+                    std::memcpy(slot->payload.data(), data, 12);
+                    slot->payload[12] = static_cast<Byte>(ETH_P_8021Q >> 8);
+                    slot->payload[13] = static_cast<Byte>(ETH_P_8021Q & 0xFF);
+                    slot->payload[14] = static_cast<Byte>(tci >> 8);
+                    slot->payload[15] = static_cast<Byte>(tci & 0xFF);
+                    std::memcpy(slot->payload.data() + 16, data + 12, size - 12);
+                } else {
+                    slot->payload.resize(size - 4);
+                    std::memcpy(slot->payload.data(), data, 12);
+                    std::memcpy(slot->payload.data() + 12, data + 16, size - 16);
+                }
+                slot->header.payload_len = static_cast<uint32_t>(slot->payload.size());
+                if ((slot->header.flags & FRAME_FLAG_CHECKSUM) && slot->meta.size() >= FRAME_CHECKSUM_LEN) {
+                    // The payload changed: recompute the trailer over the retagged frame
+                    size_t meta_len = slot->meta.size() - FRAME_CHECKSUM_LEN;
+                    uint32_t crc = frame_checksum(std::span<const Byte>(slot->payload.data(), slot->payload.size()),
+                                                  std::span<const Byte>(slot->meta.data(), meta_len));
+                    std::memcpy(slot->meta.data() + meta_len, &crc, FRAME_CHECKSUM_LEN);
+                }
+            }
+
+            /// Helper: Send the frames of an egress queue whose turn on the line has come
+            inline size_t drain(EthSwitchPort &out, uint64_t now) {
+                size_t sent = 0;
+                while (!out.queue.empty() && out.next_deadline() <= now) {
+                    Frame &frame = out.queue.front();
+                    FrameView view = make_view(frame);
+                    if (out.config.bandwidth_bps > 0) {
+                        // Back to back at line rate, stamped with the end of the frame on the wire
+                        uint64_t start = std::max(frame.header.deliver_at_ns, out.free_at_ns);
+                        view.header.deliver_at_ns =
+                            start + eth_frame_time_ns(frame.payload.size(), out.config.bandwidth_bps);
+                    }
+
+                    auto result = out.link->send_view(view);
+                    if (!result.is_ok()) {
+                        if (result.error().code == Error::timeout("").code) {
+                            out.stats.backpressure++;
+                            out.retry_at_ns = now + config.retry_ns;
+                            break;
+                        }
+                        out.stats.send_errors++;
+                        out.queue.pop();
+                        continue;
+                    }
+                    if (out.config.bandwidth_bps > 0) {
+                        out.free_at_ns = view.header.deliver_at_ns;
+                    }
+                    out.stats.frames_sent++;
+                    out.stats.bytes_sent += frame.payload.size();
+                    out.queue.pop();
+                    ++sent;
+                }
+                return sent;
+            }
+
+            /// Helper: Remove aged MAC table entries; sweeps run every 1/16 of the aging time
+            inline void age(uint64_t now) {
+                if (config.aging_ns == 0) {
+                    next_age_ns = UINT64_MAX;
+                    return;
+                }
+                stats.mac_aged += table.age(now);
+                next_age_ns = now + std::max<uint64_t>(config.aging_ns / 16, 1);
+            }
+        };
+    } // namespace detail
+
+    /// MAC-learning L2 switch between Ethernet links
+    ///
+    /// Every port is a link to one node (the ShmLink of an EthEndpoint, a TapLink, ...). The switch
+    /// learns which port each source MAC was seen on and sends a unicast frame only to the port its
+    /// destination was learned on; broadcast, multicast and unknown destinations are flooded to every
+    /// other port. Endpoints then only see frames meant for them, instead of every frame on the
+    /// network. Learned entries age out after EthSwitchConfig::aging_ns without traffic.
+    ///
+    /// Each port has a bounded egress queue. With a port bandwidth_bps set, frames leave it back to
+    /// back at that rate, with the same wire overhead as EthConfig::bandwidth_bps shaping
+    /// (eth_frame_time_ns()), and carry the end of their transmission in deliver_at_ns. A frame may
+    /// leave once it has fully arrived (its incoming deliver_at_ns). A full queue drops new frames
+    /// (EthPortStats::queue_drops). A port link that refuses a frame as full keeps it queued, and the
+    /// send is retried after retry_ns.
+    ///
+    /// With EthSwitchConfig::vlans, ports belong to VLANs: untagged frames are in the port's pvid,
+    /// and tagged frames must carry one of its VLANs. Frames are switched and flooded within
+    /// their VLAN only. They leave untagged on ports whose pvid is that VLAN, and with the 802.1Q tag
+    /// (ETH_P_8021Q) on ports that carry it in tagged_vlans.
+    ///
+    /// Drive the switch with start() (own thread), attach() (a LinkReactor), or pump() from a loop of
+    /// your own. The switch owns the receive side of every port link while it runs. Statistics are
+    /// plain counters: read them while stopped or from the driving thread.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto sw = EthSwitch::create().value();
+    /// for (int i = 0; i < 50; ++i) {
+    ///     auto ecu = ShmLink::create("ecu" + std::to_string(i), 1 << 20).value();
+    ///     sw.add_port(std::make_shared<ShmLink>(std::move(ecu)), {.bandwidth_bps = 100000000});
+    /// }
+    /// sw.start();
+    /// @endcode
+    class EthSwitch {
+      public:
+        /// Create a switch without ports
+        /// @param config Switch configuration
+        /// @return Result containing EthSwitch, or invalid_argument (zero batch or table size)
+        static Result<EthSwitch, Error> create(const EthSwitchConfig &config = {}) {
+            if (config.batch == 0 || config.mac_table_size == 0) {
+                return Result<EthSwitch, Error>::err(
+                    Error::invalid_argument("EthSwitch batch and MAC table size must be non-zero"));
+            }
+            auto core = std::make_unique<detail::EthSwitchCore>();
+            core->config = config;
+            core->table = MacTable(config.mac_table_size, config.aging_ns);
+            WIREBIT_DEBUG("EthSwitch created: ", core->table.max_entries(), " MAC entries",
+                          config.vlans ? ", VLANs" : "");
+            return Result<EthSwitch, Error>::ok(EthSwitch(std::move(core)));
+        }
+
+        /// Destructor - stops the thread and unregisters from the reactor
+        ~EthSwitch() { release(); }
+
+        EthSwitch(EthSwitch &&) noexcept = default;
+
+        EthSwitch &operator=(EthSwitch &&other) noexcept {
+            if (this != &other) {
+                release();
+                core_ = std::move(other.core_);
+            }
+            return *this;
+        }
+
+        EthSwitch(const EthSwitch &) = delete;
+        EthSwitch &operator=(const EthSwitch &) = delete;
+
+        /// Add a port
+        /// @param link Link to the node on this port
+        /// @param config Port configuration
+        /// @return Result containing the port index, or invalid_argument (null link, bad VLAN, zero queue,
+        ///         or the switch is already driven)
+        Result<size_t, Error> add_port(std::shared_ptr<Link> link, const EthPortConfig &config = {}) {
+            if (driven()) {
+                return Result<size_t, Error>::err(Error::invalid_argument("Cannot add ports while the switch runs"));
+            }
+            if (!link || config.queue_frames == 0) {
+                return Result<size_t, Error>::err(Error::invalid_argument("Null port link or zero queue"));
+            }
+            auto port = std::make_unique<detail::EthSwitchPort>();
+            if (core_->config.vlans) {
+                if (config.pvid >= ETH_VLAN_COUNT - 1) {
+                    return Result<size_t, Error>::err(Error::invalid_argument("Invalid port VLAN"));
+                }
+                if (config.pvid != 0) {
+                    port->members.set(config.pvid);
+                }
+                for (uint16_t vlan : config.tagged_vlans) {
+                    if (vlan == 0 || vlan >= ETH_VLAN_COUNT - 1 || vlan == config.pvid) {
+                        return Result<size_t, Error>::err(Error::invalid_argument("Invalid tagged VLAN"));
+                    }
+                    port->members.set(vlan);
+                }
+            }
+            port->link = std::move(link);
+            port->config = config;
+            port->queue = RxQueue<Frame>(config.queue_frames, RxOverflow::DropNewest);
+            size_t index = core_->ports.size();
+            port->index = static_cast<uint32_t>(index);
+            core_->ports.push_back(std::move(port));
+            WIREBIT_DEBUG("EthSwitch: port ", index, " = ", core_->ports[index]->link->name().c_str());
+            return Result<size_t, Error>::ok(index);
+        }
+
+        /// Give every port one turn (when driven by your own loop)
+        /// @return Frames sent to ports in this turn
+        inline size_t pump() {
+            bool more = false;
+            return core_->pump(more);
+        }
+
+        /// Switch on a dedicated thread until stop()
+        /// The thread sleeps up to idle_sleep_ns when nothing moved, less when an egress queue is due sooner.
+        /// @return Result indicating success, or invalid_argument if already driven or without ports
+        Result<Unit, Error> start() {
+            if (driven() || core_->ports.empty()) {
+                return Result<Unit, Error>::err(Error::invalid_argument("EthSwitch already driven or has no ports"));
+            }
+            core_->running.store(true, std::memory_order_release);
+            detail::EthSwitchCore *core = core_.get();
+            core->thread = std::thread([core]() {
+                while (core->running.load(std::memory_order_acquire)) {
+                    bool more = false;
+                    if (core->pump(more) > 0 || more) {
+                        continue;
+                    }
+                    uint64_t now = now_ns();
+                    uint64_t wake_at = std::min(now + core->config.idle_sleep_ns, core->next_deadline());
+                    if (wake_at > now) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(wake_at - now));
+                    }
+                }
+            });
+            echo::info("EthSwitch running with ", core_->ports.size(), " ports").green();
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Stop the switch thread (queued frames stay in the switch)
+        inline void stop() {
+            if (!core_ || !core_->thread.joinable()) {
+                return;
+            }
+            core_->running.store(false, std::memory_order_release);
+            core_->thread.join();
+            WIREBIT_DEBUG("EthSwitch stopped");
+        }
+
+        /// Check whether the switch thread runs
+        inline bool running() const { return core_ && core_->running.load(std::memory_order_acquire); }
+
+        /// Register every port link with a reactor
+        /// A readable port is switched, then every due egress queue is sent; egress deadlines wake the
+        /// reactor through the port entries.
+        /// @param reactor Reactor to drive the switch (must outlive the registration)
+        /// @return Result indicating success, or error (already driven, link already registered)
+        Result<Unit, Error> attach(LinkReactor &reactor) {
+            if (driven()) {
+                return Result<Unit, Error>::err(Error::invalid_argument("EthSwitch already driven"));
+            }
+            detail::EthSwitchCore *core = core_.get();
+            for (size_t i = 0; i < core->ports.size(); ++i) {
+                detail::EthSwitchPort *port = core->ports[i].get();
+                auto added = reactor.add(
+                    *port->link,
+                    [core, port]() {
+                        bool more = core->collect(*port);
+                        core->drain_all();
+                        return more;
+                    },
+                    0, [port]() { return port->next_deadline(); });
+                if (!added.is_ok()) {
+                    for (size_t j = 0; j < i; ++j) {
+                        reactor.remove(*core->ports[j]->link);
+                    }
+                    return added;
+                }
+            }
+            core->reactor = &reactor;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Unregister every port link from the reactor given to attach()
+        inline void detach() {
+            if (!core_ || core_->reactor == nullptr) {
+                return;
+            }
+            for (auto &port : core_->ports) {
+                core_->reactor->remove(*port->link);
+            }
+            core_->reactor = nullptr;
+        }
+
+        /// Get the time at which an egress queue can send next
+        /// @return Deadline in nanoseconds, or UINT64_MAX if every egress queue is empty
+        inline uint64_t next_deadline() const { return core_->next_deadline(); }
+
+        /// Get the port a station was learned on
+        /// @param mac Station MAC address
+        /// @param vlan VLAN (0 without VLAN separation)
+        /// @return Result containing the port index, or not_found
+        inline Result<size_t, Error> learned_port(const MacAddr &mac, uint16_t vlan = 0) const {
+            uint32_t port = core_->table.lookup(mac, vlan, now_ns());
+            if (port == MAC_TABLE_MISS) {
+                return Result<size_t, Error>::err(Error::not_found("MAC address not learned"));
+            }
+            return Result<size_t, Error>::ok(port);
+        }
+
+        /// Forget every station learned on a port (e.g. after replacing its node)
+        /// @return Number of entries removed
+        inline size_t flush_port(size_t port) { return core_->table.remove_port(static_cast<uint32_t>(port)); }
+
+        /// Get the MAC address table
+        inline const MacTable &mac_table() const { return core_->table; }
+
+        /// Get number of ports
+        inline size_t port_count() const { return core_->ports.size(); }
+
+        /// Get a port's link
+        inline Link &port_link(size_t port) { return *core_->ports[port]->link; }
+
+        /// Get the number of frames waiting in a port's egress queue
+        inline size_t queued(size_t port) const { return core_->ports[port]->queue.size(); }
+
+        /// Get switch statistics
+        inline const EthSwitchStats &stats() const { return core_->stats; }
+
+        /// Get statistics of one port
+        inline const EthPortStats &port_stats(size_t port) const { return core_->ports[port]->stats; }
+
+        /// Reset switch and port statistics
+        inline void reset_stats() {
+            core_->stats.reset();
+            for (auto &port : core_->ports) {
+                port->stats.reset();
+            }
+        }
+
+      private:
+        std::unique_ptr<detail::EthSwitchCore> core_; ///< Engine (stable address for the thread and reactor)
+
+        explicit EthSwitch(std::unique_ptr<detail::EthSwitchCore> core) : core_(std::move(core)) {}
+
+        inline bool driven() const { return core_->running.load() || core_->reactor != nullptr; }
+
+        inline void release() {
+            stop();
+            detach();
+        }
+    };
+
+} // namespace wirebit
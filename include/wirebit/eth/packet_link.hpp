@@ -0,0 +1,699 @@
+#pragma once
+
+#ifndef NO_HARDWARE
+
+// System headers first (they may define ETH_* macros)
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
+#include <memory>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Wirebit headers after system headers
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/timestamping.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+#include <wirebit/link.hpp>
+#include <wirebit/link_queue_set.hpp>
+
+namespace wirebit {
+    namespace detail {
+        constexpr size_t PACKET_ETH_HLEN = 14;  ///< Ethernet header length
+        constexpr size_t PACKET_VLAN_HLEN = 4;  ///< 802.1Q tag length
+        constexpr uint16_t PACKET_TPID_8021Q = 0x8100;
+
+        /// Offset of the frame data in a TX ring slot (TPACKET_V3 without PACKET_TX_HAS_OFF)
+        constexpr size_t PACKET_TX_DATA_OFFSET = TPACKET3_HDRLEN - sizeof(struct sockaddr_ll);
+    } // namespace detail
+
+    /// How the kernel spreads received frames across the sockets of a fanout group
+    enum class PacketFanout : uint8_t {
+        Hash = PACKET_FANOUT_HASH,         ///< By flow hash (frames of one flow stay on one socket)
+        LoadBalance = PACKET_FANOUT_LB,    ///< Round robin
+        Cpu = PACKET_FANOUT_CPU,           ///< By the CPU the frame arrived on
+        Rollover = PACKET_FANOUT_ROLLOVER, ///< Fill one socket, then move to the next
+        Random = PACKET_FANOUT_RND,        ///< Random socket
+        QueueMapping = PACKET_FANOUT_QM,   ///< By the NIC receive queue
+    };
+
+    /// Configuration for PacketLink
+    struct PacketConfig {
+        String interface_name = "eth0";                ///< Interface to capture from and inject into
+        uint16_t protocol = ETH_P_ALL;                 ///< EtherType received (ETH_P_ALL = every frame)
+        uint32_t block_size = 1 << 20;                 ///< RX ring block size (multiple of the page size)
+        uint32_t block_count = 8;                      ///< RX ring blocks
+        uint32_t block_timeout_ms = 1;                 ///< Hand a partly filled RX block to user space after this long
+        bool tx_ring = true;                           ///< Send through a PACKET_TX_RING (false = one send() per frame)
+        uint32_t tx_frame_size = 2048;                 ///< TX ring slot size (largest frame + 48-byte slot header)
+        uint32_t tx_frame_count = 512;                 ///< TX ring slots
+        uint32_t tx_batch = 1;                         ///< Queued TX slots that trigger a kernel kick (see flush())
+        bool promiscuous = false;                      ///< Receive frames not addressed to the interface
+        bool ignore_outgoing = true;                   ///< Skip frames sent by this host (including this link)
+        bool qdisc_bypass = false;                     ///< Send straight to the driver, skipping traffic control
+        int fanout_group = -1;                         ///< PACKET_FANOUT group (-1 = none, create_queues() picks one)
+        PacketFanout fanout_mode = PacketFanout::Hash; ///< Fanout distribution
+        uint32_t queues = 1;                           ///< Sockets opened by create_queues()
+        Vector<int> queue_cpus = {};                   ///< CPU to pin each queue's worker to (missing/-1 = no affinity)
+        bool kernel_timestamps = false;                ///< Use the ring timestamp instead of the read time
+        bool hw_timestamps = false;                    ///< Prefer NIC hardware timestamps (implies kernel_timestamps)
+    };
+
+    /// Statistics for PacketLink
+    struct PacketLinkStats {
+        uint64_t frames_sent = 0;
+        uint64_t frames_received = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t bytes_received = 0;
+        uint64_t send_errors = 0;      ///< Frames the kernel rejected (or failed sends without TX ring)
+        uint64_t recv_errors = 0;
+        uint64_t blocks_received = 0;  ///< RX ring blocks handed to user space
+        uint64_t frames_truncated = 0; ///< Frames larger than fit in an RX block (delivered cut short)
+        uint64_t kernel_drops = 0;     ///< Frames dropped on a full RX ring (refresh_kernel_stats())
+        uint64_t tx_kicks = 0;         ///< sendto() calls that started transmission of queued slots
+        uint64_t sw_timestamps = 0;
+        uint64_t hw_timestamps = 0;
+
+        inline void reset() {
+            frames_sent = 0;
+            frames_received = 0;
+            bytes_sent = 0;
+            bytes_received = 0;
+            send_errors = 0;
+            recv_errors = 0;
+            blocks_received = 0;
+            frames_truncated = 0;
+            kernel_drops = 0;
+            tx_kicks = 0;
+            sw_timestamps = 0;
+            hw_timestamps = 0;
+        }
+    };
+
+    /// AF_PACKET link on a real (or veth) network interface, with memory-mapped TPACKET_V3 rings
+    /// Same interface as TapLink: FrameType::ETHERNET frames carrying the raw L2 frame
+    ///
+    /// Received frames are read in place from PACKET_RX_RING blocks: the kernel fills a block with
+    /// many frames and hands it over as a whole, so recv_view() costs no syscall and no copy, and the
+    /// block goes back to the kernel once its last frame has been read. Frames whose 802.1Q tag the
+    /// kernel stripped are rebuilt with the tag in a scratch buffer, the only copy on the receive side.
+    /// Sent frames are written into PACKET_TX_RING slots and handed to the kernel with one sendto()
+    /// per tx_batch slots (or per send_batch() call, or flush()).
+    ///
+    /// For multi-core receive, create_queues() opens `queues` sockets in one PACKET_FANOUT group;
+    /// the kernel spreads frames across them by fanout_mode, and each is served by its own thread.
+    ///
+    /// @note Disabled when NO_HARDWARE is defined
+    /// @note Requires CAP_NET_RAW; the interface must exist (it is never created or destroyed)
+    ///
+    /// Example usage:
+    /// @code
+    /// auto nic = std::make_shared<PacketLink>(PacketLink::create({.interface_name = "veth0"}).value());
+    /// auto bridge = Bridge::create(nic, shm_link).value();
+    /// @endcode
+    class PacketLink : public Link {
+      public:
+        /// Open a packet socket on an interface
+        /// @param config Packet link configuration
+        /// @return Result containing PacketLink, or error (not_found if the interface does not exist)
+        static inline Result<PacketLink, Error> create(const PacketConfig &config = {}) {
+            WIREBIT_TRACE("Creating PacketLink for interface: ", config.interface_name.c_str());
+            return open_socket(config, config.fanout_group);
+        }
+
+        /// Open `config.queues` packet sockets on an interface, joined in one fanout group
+        /// Queue i's worker is pinned to config.queue_cpus[i] when that entry exists.
+        /// @param config Packet link configuration (fanout_group < 0 picks a group from the process id)
+        /// @return Result containing the queue set (one PacketLink per socket), or error
+        static inline Result<LinkQueueSet, Error> create_queues(const PacketConfig &config) {
+            if (config.queues == 0) {
+                return Result<LinkQueueSet, Error>::err(Error::invalid_argument("Packet queue count must be > 0"));
+            }
+            int group = config.fanout_group >= 0 ? config.fanout_group : static_cast<int>(::getpid() & 0xFFFF);
+
+            LinkQueueSet set;
+            for (uint32_t q = 0; q < config.queues; ++q) {
+                auto link = open_socket(config, group);
+                if (!link.is_ok()) {
+                    return Result<LinkQueueSet, Error>::err(link.error());
+                }
+                int cpu = q < config.queue_cpus.size() ? config.queue_cpus[q] : -1;
+                set.add(std::make_unique<PacketLink>(std::move(link.value())), cpu);
+            }
+            WIREBIT_TRACE("Packet queues created: interface=", config.interface_name.c_str(), " queues=", set.size(),
+                          " fanout group=", group)
+                .green();
+            return Result<LinkQueueSet, Error>::ok(std::move(set));
+        }
+
+        /// Destructor - sends queued TX slots, unmaps the rings and closes the socket
+        inline ~PacketLink() { close_socket(); }
+
+        /// Move constructor
+        inline PacketLink(PacketLink &&other) noexcept
+            : sock_fd_(other.sock_fd_), config_(other.config_), stats_(other.stats_), ring_(other.ring_),
+              ring_size_(other.ring_size_), rx_block_(other.rx_block_), rx_left_(other.rx_left_),
+              rx_offset_(other.rx_offset_), rx_release_(other.rx_release_), tx_slot_(other.tx_slot_),
+              tx_queued_(other.tx_queued_), tx_block_size_(other.tx_block_size_), tx_per_block_(other.tx_per_block_),
+              ts_source_(other.ts_source_), rx_scratch_(std::move(other.rx_scratch_)) {
+            other.sock_fd_ = -1;
+            other.ring_ = nullptr;
+            other.ring_size_ = 0;
+        }
+
+        /// Move assignment
+        inline PacketLink &operator=(PacketLink &&other) noexcept {
+            if (this != &other) {
+                close_socket();
+                sock_fd_ = other.sock_fd_;
+                config_ = other.config_;
+                stats_ = other.stats_;
+                ring_ = other.ring_;
+                ring_size_ = other.ring_size_;
+                rx_block_ = other.rx_block_;
+                rx_left_ = other.rx_left_;
+                rx_offset_ = other.rx_offset_;
+                rx_release_ = other.rx_release_;
+                tx_slot_ = other.tx_slot_;
+                tx_queued_ = other.tx_queued_;
+                tx_block_size_ = other.tx_block_size_;
+                tx_per_block_ = other.tx_per_block_;
+                ts_source_ = other.ts_source_;
+                rx_scratch_ = std::move(other.rx_scratch_);
+                other.sock_fd_ = -1;
+                other.ring_ = nullptr;
+                other.ring_size_ = 0;
+            }
+            return *this;
+        }
+
+        // Disable copy
+        PacketLink(const PacketLink &) = delete;
+        PacketLink &operator=(const PacketLink &) = delete;
+
+        /// Send a frame through the interface
+        /// @param frame Frame to send (payload must be a raw L2 Ethernet frame)
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Send a borrowed frame (copied into a TX ring slot, or sent straight from the span without TX ring)
+        /// @param frame Frame view to send
+        /// @return Result indicating success, timeout if the TX ring or socket buffer is full, or error
+        inline Result<Unit, Error> send_view(const FrameView &frame) override {
+            auto queued = queue_frame(frame);
+            if (!queued.is_ok()) {
+                return queued;
+            }
+            if (tx_queued_ >= config_.tx_batch) {
+                kick();
+            }
+            return queued;
+        }
+
+        /// Receive a frame from the interface
+        /// @return Result containing frame if available, or error
+        inline Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive a frame straight out of the RX ring (non-blocking)
+        /// The view points into the ring block and stays valid until the next recv call, which may hand
+        /// the block back to the kernel.
+        /// @return Result containing frame view if available, or error
+        inline Result<FrameView, Error> recv_view() override {
+            if (sock_fd_ < 0) {
+                return Result<FrameView, Error>::err(Error::io_error("Packet socket not open"));
+            }
+            if (rx_release_) {
+                release_block();
+            }
+            if (rx_left_ == 0) {
+                struct tpacket_block_desc *block = block_desc(rx_block_);
+                if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+                    return Result<FrameView, Error>::err(Error::timeout("No frames available"));
+                }
+                stats_.blocks_received++;
+                rx_left_ = block->hdr.bh1.num_pkts;
+                rx_offset_ = block->hdr.bh1.offset_to_first_pkt;
+                if (rx_left_ == 0) {
+                    release_block(); // Retired by the block timeout without frames
+                    return Result<FrameView, Error>::err(Error::timeout("No frames available"));
+                }
+            }
+
+            Byte *block_base = ring_ + rx_block_ * config_.block_size;
+            auto *hdr = reinterpret_cast<struct tpacket3_hdr *>(block_base + rx_offset_);
+            rx_offset_ += hdr->tp_next_offset;
+            if (--rx_left_ == 0) {
+                rx_release_ = true;
+            }
+
+            std::span<const Byte> packet(reinterpret_cast<Byte *>(hdr) + hdr->tp_mac, hdr->tp_snaplen);
+            if (hdr->tp_snaplen < hdr->tp_len) {
+                stats_.frames_truncated++;
+            }
+            if ((hdr->tp_status & TP_STATUS_VLAN_VALID) != 0 && packet.size() >= detail::PACKET_ETH_HLEN) {
+                packet = with_vlan_tag(packet, *hdr);
+            }
+            if (packet.size() < detail::PACKET_ETH_HLEN) {
+                echo::warn("Packet frame too small: ", packet.size(), " bytes").yellow();
+                stats_.recv_errors++;
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("Packet frame too small"));
+            }
+
+            stats_.frames_received++;
+            stats_.bytes_received += packet.size();
+            stats_export_.received(packet.size());
+
+            WIREBIT_DEBUG("PacketLink recv: ", packet.size(), " bytes");
+            return Result<FrameView, Error>::ok(
+                make_view_with_timestamp(FrameType::ETHERNET, packet, rx_timestamp(*hdr)));
+        }
+
+        /// Queue several frames in the TX ring and hand them to the kernel with one sendto()
+        /// @param frames Frames to send
+        /// @return Result containing number of frames sent, or error if none could be sent
+        inline Result<size_t, Error> send_batch(std::span<const Frame> frames) override {
+            if (!config_.tx_ring) {
+                return Link::send_batch(frames);
+            }
+            size_t sent = 0;
+            Result<Unit, Error> failed = Result<Unit, Error>::ok(Unit{});
+            for (const Frame &frame : frames) {
+                failed = queue_frame(make_view(frame));
+                if (!failed.is_ok()) {
+                    break;
+                }
+                ++sent;
+            }
+            kick();
+            if (sent == 0 && !failed.is_ok()) {
+                return Result<size_t, Error>::err(failed.error());
+            }
+            return Result<size_t, Error>::ok(sent);
+        }
+
+        /// Check if link is ready for sending
+        /// @return true if the next TX slot is free (always true without TX ring)
+        inline bool can_send() const override {
+            if (sock_fd_ < 0) {
+                return false;
+            }
+            return !config_.tx_ring || slot_free(tx_header(tx_slot_)->tp_status);
+        }
+
+        /// Check if a received frame is waiting in the RX ring
+        /// @return true if recv_view() would return a frame
+        inline bool can_recv() const override { return sock_fd_ >= 0 && rx_ready(); }
+
+        /// Get link name/identifier
+        /// @return Link name
+        inline String name() const override { return String("packet:") + config_.interface_name; }
+
+        /// Get the interface name
+        /// @return Interface name (e.g., "eth0")
+        inline const String &interface_name() const { return config_.interface_name; }
+
+        /// Get the packet socket file descriptor
+        /// @return Socket file descriptor
+        inline int socket_fd() const { return sock_fd_; }
+
+        /// Get file descriptor for readiness polling (readable when an RX block is ready)
+        /// @return File descriptor
+        inline int poll_fd() const override { return sock_fd_; }
+
+        /// Send queued TX slots before blocking (see Link::prepare_wait())
+        /// @return false if a received frame is already waiting
+        inline bool prepare_wait() override {
+            kick();
+            return !rx_ready();
+        }
+
+        /// Hand TX slots queued by tx_batch to the kernel
+        /// Call once per event loop iteration when tx_batch > 1; no-op if nothing is queued.
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> flush() { return kick(); }
+
+        /// Get the timestamp source for received frames
+        /// @return TimestampSource::None unless kernel_timestamps/hw_timestamps were enabled
+        inline TimestampSource timestamp_source() const { return ts_source_; }
+
+        /// Add the kernel's RX ring counters (PACKET_STATISTICS) to stats().kernel_drops
+        /// The kernel resets its counters on every read, so call this periodically.
+        /// @return Result containing the frames dropped since the last call, or io_error
+        inline Result<uint64_t, Error> refresh_kernel_stats() {
+            struct tpacket_stats_v3 kstats;
+            std::memset(&kstats, 0, sizeof(kstats));
+            socklen_t len = sizeof(kstats);
+            if (::getsockopt(sock_fd_, SOL_PACKET, PACKET_STATISTICS, &kstats, &len) < 0) {
+                return Result<uint64_t, Error>::err(Error::io_error("PACKET_STATISTICS failed"));
+            }
+            stats_.kernel_drops += kstats.tp_drops;
+            if (kstats.tp_drops > 0) {
+                stats_export_.add(LinkCounter::FramesDropped, kstats.tp_drops);
+            }
+            return Result<uint64_t, Error>::ok(kstats.tp_drops);
+        }
+
+        /// Get link statistics
+        /// @return Statistics reference
+        inline const PacketLinkStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        int sock_fd_ = -1;                                  ///< AF_PACKET socket
+        PacketConfig config_;                               ///< Configuration
+        PacketLinkStats stats_;                             ///< Statistics
+        Byte *ring_ = nullptr;                              ///< RX ring blocks followed by TX ring slots (one mapping)
+        size_t ring_size_ = 0;                              ///< Size of the mapping
+        size_t rx_block_ = 0;                               ///< RX block being read
+        uint32_t rx_left_ = 0;                              ///< Frames of the RX block not read yet
+        size_t rx_offset_ = 0;                              ///< Offset of the next frame in the RX block
+        bool rx_release_ = false;                           ///< Block fully read; release on the next recv
+        size_t tx_slot_ = 0;                                ///< Next TX slot to fill
+        uint32_t tx_queued_ = 0;                            ///< Slots filled since the last kick
+        size_t tx_block_size_ = 0;                          ///< TX ring block size
+        size_t tx_per_block_ = 1;                           ///< TX slots per block
+        TimestampSource ts_source_ = TimestampSource::None; ///< Timestamp source for received frames
+        Bytes rx_scratch_;                                  ///< Frame rebuilt with its VLAN tag
+
+        /// Private constructor
+        inline PacketLink(int sock_fd, const PacketConfig &config) : sock_fd_(sock_fd), config_(config) {}
+
+        /// Helper: Open, configure and map one packet socket
+        static inline Result<PacketLink, Error> open_socket(const PacketConfig &config, int fanout_group) {
+            auto fail = [](const char *what, int fd) {
+                echo::error("PacketLink: ", what, ": ", strerror(errno)).red();
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+                return Result<PacketLink, Error>::err(Error::io_error(what));
+            };
+
+            unsigned int ifindex = ::if_nametoindex(config.interface_name.c_str());
+            if (ifindex == 0) {
+                echo::error("Network interface does not exist: ", config.interface_name.c_str()).red();
+                return Result<PacketLink, Error>::err(Error::not_found("Network interface does not exist"));
+            }
+            if (config.block_size == 0 || config.block_count == 0 || config.block_size % ::getpagesize() != 0) {
+                return Result<PacketLink, Error>::err(
+                    Error::invalid_argument("RX block size must be a non-zero multiple of the page size"));
+            }
+            if (config.tx_ring && (config.tx_frame_size <= detail::PACKET_TX_DATA_OFFSET + detail::PACKET_ETH_HLEN ||
+                                   config.tx_frame_size % TPACKET_ALIGNMENT != 0 || config.tx_frame_count == 0)) {
+                return Result<PacketLink, Error>::err(Error::invalid_argument("Invalid TX ring slot configuration"));
+            }
+
+            int fd = ::socket(AF_PACKET, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, htons(config.protocol));
+            if (fd < 0) {
+                return fail("Failed to open packet socket", -1);
+            }
+
+            int version = TPACKET_V3;
+            if (::setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+                return fail("TPACKET_V3 not supported", fd);
+            }
+
+            PacketLink link(fd, config);
+            if (config.kernel_timestamps || config.hw_timestamps) {
+                link.ts_source_ = TimestampSource::Software; // The ring always carries the kernel stamp
+                if (config.hw_timestamps && detail::enable_hw_timestamping(fd, config.interface_name)) {
+                    int flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+                    if (::setsockopt(fd, SOL_PACKET, PACKET_TIMESTAMP, &flags, sizeof(flags)) == 0) {
+                        link.ts_source_ = TimestampSource::Hardware;
+                    }
+                }
+            }
+            if (config.ignore_outgoing) {
+                int one = 1;
+                if (::setsockopt(fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one)) < 0) {
+                    echo::warn("PacketLink: PACKET_IGNORE_OUTGOING unsupported, own frames will be received")
+                        .yellow();
+                }
+            }
+            if (config.qdisc_bypass) {
+                int one = 1;
+                if (::setsockopt(fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one)) < 0) {
+                    echo::warn("PacketLink: PACKET_QDISC_BYPASS unsupported").yellow();
+                }
+            }
+
+            // Rings: RX blocks first, TX slots after them in the same mapping
+            struct tpacket_req3 rx_req;
+            std::memset(&rx_req, 0, sizeof(rx_req));
+            rx_req.tp_block_size = config.block_size;
+            rx_req.tp_block_nr = config.block_count;
+            rx_req.tp_frame_size = TPACKET_ALIGNMENT << 7; // Only used for the kernel's sanity checks in V3
+            rx_req.tp_frame_nr = (config.block_size / rx_req.tp_frame_size) * config.block_count;
+            rx_req.tp_retire_blk_tov = config.block_timeout_ms;
+            rx_req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+            if (::setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &rx_req, sizeof(rx_req)) < 0) {
+                return fail("Failed to set up PACKET_RX_RING", -1);
+            }
+            link.ring_size_ = static_cast<size_t>(config.block_size) * config.block_count;
+
+            if (config.tx_ring) {
+                // Whole slots per block, so the slot count is rounded up to fill the blocks
+                size_t page = static_cast<size_t>(::getpagesize());
+                size_t block = std::max(page, (static_cast<size_t>(config.tx_frame_size) + page - 1) / page * page);
+                size_t per_block = block / config.tx_frame_size;
+                size_t blocks = (config.tx_frame_count + per_block - 1) / per_block;
+
+                struct tpacket_req3 tx_req;
+                std::memset(&tx_req, 0, sizeof(tx_req));
+                tx_req.tp_block_size = static_cast<unsigned int>(block);
+                tx_req.tp_block_nr = static_cast<unsigned int>(blocks);
+                tx_req.tp_frame_size = config.tx_frame_size;
+                tx_req.tp_frame_nr = static_cast<unsigned int>(blocks * per_block);
+                if (::setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &tx_req, sizeof(tx_req)) < 0) {
+                    return fail("Failed to set up PACKET_TX_RING", -1);
+                }
+                int loss = 1; // Skip malformed slots (marked TP_STATUS_WRONG_FORMAT) instead of stalling the ring
+                ::setsockopt(fd, SOL_PACKET, PACKET_LOSS, &loss, sizeof(loss));
+                link.config_.tx_frame_count = tx_req.tp_frame_nr;
+                link.tx_block_size_ = block;
+                link.tx_per_block_ = per_block;
+                link.ring_size_ += block * blocks;
+            }
+
+            void *ring = ::mmap(nullptr, link.ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+            if (ring == MAP_FAILED) {
+                link.ring_size_ = 0;
+                return fail("Failed to map packet rings", -1);
+            }
+            link.ring_ = static_cast<Byte *>(ring);
+
+            struct sockaddr_ll addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sll_family = AF_PACKET;
+            addr.sll_protocol = htons(config.protocol);
+            addr.sll_ifindex = static_cast<int>(ifindex);
+            if (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+                return fail("Failed to bind packet socket", -1);
+            }
+
+            if (config.promiscuous) {
+                struct packet_mreq mreq;
+                std::memset(&mreq, 0, sizeof(mreq));
+                mreq.mr_ifindex = static_cast<int>(ifindex);
+                mreq.mr_type = PACKET_MR_PROMISC;
+                if (::setsockopt(fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+                    return fail("Failed to enable promiscuous mode", -1);
+                }
+            }
+
+            if (fanout_group >= 0) {
+                int fanout = (fanout_group & 0xFFFF) | (static_cast<int>(config.fanout_mode) << 16);
+                if (::setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0) {
+                    return fail("Failed to join packet fanout group", -1);
+                }
+            }
+
+            WIREBIT_TRACE("PacketLink created: interface=", config.interface_name.c_str(), " fd=", fd,
+                          " rx=", config.block_count, "x", config.block_size,
+                          " tx=", config.tx_ring ? link.config_.tx_frame_count : 0, " slots")
+                .green();
+            return Result<PacketLink, Error>::ok(std::move(link));
+        }
+
+        /// Helper: Write a frame into the next TX slot (or send it directly without TX ring)
+        inline Result<Unit, Error> queue_frame(const FrameView &frame) {
+            if (sock_fd_ < 0) {
+                return Result<Unit, Error>::err(Error::io_error("Packet socket not open"));
+            }
+            if (frame.type() != FrameType::ETHERNET) {
+                echo::warn("PacketLink: Non-Ethernet frame type, ignoring");
+                return Result<Unit, Error>::err(Error::invalid_argument("Expected Ethernet frame type"));
+            }
+            size_t size = frame.payload.size();
+            if (size < detail::PACKET_ETH_HLEN) {
+                echo::error("Invalid Ethernet frame size: ", size, " (minimum ", detail::PACKET_ETH_HLEN, ")").red();
+                return Result<Unit, Error>::err(Error::invalid_argument("Ethernet frame too small"));
+            }
+
+            if (!config_.tx_ring) {
+                ssize_t written = ::send(sock_fd_, frame.payload.data(), size, MSG_DONTWAIT);
+                if (written < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                        return Result<Unit, Error>::err(Error::timeout("Packet socket send would block"));
+                    }
+                    echo::error("Packet send failed: ", strerror(errno)).red();
+                    stats_.send_errors++;
+                    stats_export_.add(LinkCounter::SendErrors);
+                    return Result<Unit, Error>::err(Error::io_error("Packet send failed"));
+                }
+                account_sent(size);
+                return Result<Unit, Error>::ok(Unit{});
+            }
+
+            if (size > config_.tx_frame_size - detail::PACKET_TX_DATA_OFFSET) {
+                echo::error("Ethernet frame too large for TX slot: ", size, " bytes").red();
+                return Result<Unit, Error>::err(Error::invalid_argument("Ethernet frame too large for TX slot"));
+            }
+
+            struct tpacket3_hdr *hdr = tx_header(tx_slot_);
+            uint32_t status = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE);
+            if (!slot_free(status)) {
+                kick(); // Slots may only be waiting for their kick
+                status = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE);
+                if (!slot_free(status)) {
+                    return Result<Unit, Error>::err(Error::timeout("Packet TX ring full"));
+                }
+            }
+            if (status == TP_STATUS_WRONG_FORMAT) {
+                stats_.send_errors++; // The kernel skipped the frame sent from this slot one lap ago
+                stats_export_.add(LinkCounter::SendErrors);
+            }
+
+            std::memcpy(reinterpret_cast<Byte *>(hdr) + detail::PACKET_TX_DATA_OFFSET, frame.payload.data(), size);
+            hdr->tp_len = static_cast<uint32_t>(size);
+            hdr->tp_snaplen = static_cast<uint32_t>(size);
+            hdr->tp_next_offset = 0;
+            __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+            tx_slot_ = (tx_slot_ + 1) % config_.tx_frame_count;
+            tx_queued_++;
+            account_sent(size);
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Ask the kernel to transmit the slots marked TP_STATUS_SEND_REQUEST
+        inline Result<Unit, Error> kick() {
+            if (tx_queued_ == 0 || sock_fd_ < 0) {
+                return Result<Unit, Error>::ok(Unit{});
+            }
+            stats_.tx_kicks++;
+            if (::sendto(sock_fd_, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0 && errno != EAGAIN &&
+                errno != EWOULDBLOCK && errno != ENOBUFS) {
+                echo::error("Packet TX ring kick failed: ", strerror(errno)).red();
+                stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
+                return Result<Unit, Error>::err(Error::io_error("Packet TX ring kick failed"));
+            }
+            // Slots the kernel could not take yet stay marked and go out with the next kick
+            tx_queued_ = 0;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Return the current RX block to the kernel and move to the next
+        inline void release_block() {
+            __atomic_store_n(&block_desc(rx_block_)->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+            rx_block_ = (rx_block_ + 1) % config_.block_count;
+            rx_left_ = 0;
+            rx_release_ = false;
+        }
+
+        /// Helper: Check whether recv_view() would return a frame
+        inline bool rx_ready() const {
+            if (rx_left_ > 0) {
+                return true;
+            }
+            size_t next = rx_release_ ? (rx_block_ + 1) % config_.block_count : rx_block_;
+            return (__atomic_load_n(&block_desc(next)->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) != 0;
+        }
+
+        inline struct tpacket_block_desc *block_desc(size_t index) const {
+            return reinterpret_cast<struct tpacket_block_desc *>(ring_ + index * config_.block_size);
+        }
+
+        inline struct tpacket3_hdr *tx_header(size_t slot) const {
+            Byte *tx = ring_ + static_cast<size_t>(config_.block_size) * config_.block_count;
+            Byte *block = tx + (slot / tx_per_block_) * tx_block_size_;
+            return reinterpret_cast<struct tpacket3_hdr *>(block + (slot % tx_per_block_) * config_.tx_frame_size);
+        }
+
+        static inline bool slot_free(uint32_t status) {
+            return status == TP_STATUS_AVAILABLE || status == TP_STATUS_WRONG_FORMAT;
+        }
+
+        inline void account_sent(size_t size) {
+            stats_.frames_sent++;
+            stats_.bytes_sent += size;
+            stats_export_.sent(size);
+        }
+
+        /// Helper: Pick a received frame's timestamp (ring stamp if enabled, else the current time)
+        inline uint64_t rx_timestamp(const struct tpacket3_hdr &hdr) {
+            if (ts_source_ == TimestampSource::None) {
+                return now_ns();
+            }
+            if ((hdr.tp_status & TP_STATUS_TS_RAW_HARDWARE) != 0) {
+                stats_.hw_timestamps++;
+            } else {
+                stats_.sw_timestamps++;
+            }
+            return static_cast<uint64_t>(hdr.tp_sec) * 1000000000ULL + hdr.tp_nsec;
+        }
+
+        /// Helper: Rebuild a frame with the 802.1Q tag the kernel moved into the ring header
+        inline std::span<const Byte> with_vlan_tag(std::span<const Byte> packet, const struct tpacket3_hdr &hdr) {
+            uint16_t tpid = (hdr.tp_status & TP_STATUS_VLAN_TPID_VALID) != 0 ? hdr.hv1.tp_vlan_tpid
+                                                                              : detail::PACKET_TPID_8021Q;
+            uint16_t tci = static_cast<uint16_t>(hdr.hv1.tp_vlan_tci);
+            rx_scratch_.resize(packet.size() + detail::PACKET_VLAN_HLEN);
+            Byte *out = rx_scratch_.data();
+            std::memcpy(out, packet.data(), 12); // Destination and source MAC
+            out[12] = static_cast<Byte>(tpid >> 8);
+            out[13] = static_cast<Byte>(tpid);
+            out[14] = static_cast<Byte>(tci >> 8);
+            out[15] = static_cast<Byte>(tci);
+            std::memcpy(out + 16, packet.data() + 12, packet.size() - 12);
+            return std::span<const Byte>(rx_scratch_.data(), rx_scratch_.size());
+        }
+
+        /// Helper: Send what is queued, unmap the rings and close the socket
+        inline void close_socket() {
+            if (sock_fd_ >= 0) {
+                kick();
+            }
+            if (ring_ != nullptr) {
+                ::munmap(ring_, ring_size_);
+                ring_ = nullptr;
+                ring_size_ = 0;
+            }
+            if (sock_fd_ >= 0) {
+                WIREBIT_DEBUG("Closing packet socket: ", sock_fd_);
+                ::close(sock_fd_);
+                sock_fd_ = -1;
+            }
+        }
+    };
+
+} // namespace wirebit
+
+#endif // NO_HARDWARE
@@ -7,20 +7,27 @@
 #pragma GCC diagnostic ignored "-Wformat-truncation"
 
 // System headers first (they may define ETH_* macros)
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <echo/echo.hpp>
 #include <fcntl.h>
 #include <linux/if_tun.h>
+#include <memory>
 #include <net/if.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 // Wirebit headers after system headers
+#include <wirebit/common/io_uring.hpp>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
+#include <wirebit/eth/vnet_hdr.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/link_queue_set.hpp>
 
 // Local constants for TAP frame handling
 // (we use raw values to avoid dependency on eth_endpoint.hpp include order)
@@ -35,10 +42,18 @@ namespace wirebit {
 
     /// Configuration for TAP link
     struct TapConfig {
-        String interface_name = "tap0"; ///< TAP interface name
-        bool create_if_missing = true;  ///< Create interface if it doesn't exist (requires sudo)
-        bool destroy_on_close = false;  ///< Destroy interface when link is closed
-        bool set_up_on_create = true;   ///< Bring interface up after creation
+        String interface_name = "tap0";            ///< TAP interface name
+        bool create_if_missing = true;             ///< Create interface if it doesn't exist (requires sudo)
+        bool destroy_on_close = false;             ///< Destroy interface when link is closed
+        bool set_up_on_create = true;              ///< Bring interface up after creation
+        bool use_io_uring = false;                 ///< Use io_uring for frame I/O (falls back to read/write)
+        uint32_t io_uring_entries = 256;           ///< io_uring queue depth (and RX buffers/TX slots without vnet_hdr)
+        uint32_t io_uring_batch = 1;               ///< Queued sends that trigger an io_uring submit (see flush())
+        uint32_t queues = 1;                       ///< Queue fds for create_queues() (> 1 enables IFF_MULTI_QUEUE)
+        Vector<int> queue_cpus = {};               ///< CPU to pin each queue's worker to (missing/-1 = no affinity)
+        bool vnet_hdr = false;                     ///< IFF_VNET_HDR mode: offload metadata in Frame::meta, GSO frames
+        uint32_t offloads = VNET_DEFAULT_OFFLOADS; ///< TUNSETOFFLOAD flags for vnet_hdr mode
+        uint32_t io_uring_vnet_buffers = 16;       ///< io_uring RX buffers and TX slots in vnet_hdr mode (64 KB each)
     };
 
     /// Statistics for TapLink
@@ -76,53 +91,64 @@ namespace wirebit {
     class TapLink : public Link {
       public:
         /// Create a new TAP link
+        /// With config.queues > 1 this opens a single queue of a multi-queue interface; use
+        /// create_queues() to open all of them.
         /// @param config TAP configuration
         /// @return Result containing TapLink or error
         static inline Result<TapLink, Error> create(const TapConfig &config = {}) {
-            echo::trace("Creating TapLink for interface: ", config.interface_name.c_str());
+            WIREBIT_TRACE("Creating TapLink for interface: ", config.interface_name.c_str());
 
-            // Check if interface exists
-            bool interface_exists = check_interface_exists(config.interface_name);
+            auto prepared = prepare_interface(config);
+            if (!prepared.is_ok()) {
+                return Result<TapLink, Error>::err(prepared.error());
+            }
+            bool interface_exists = prepared.value();
 
-            if (!interface_exists && config.create_if_missing) {
-                // Create TAP interface
-                auto create_result = create_tap_interface(config.interface_name);
-                if (!create_result.is_ok()) {
-                    return Result<TapLink, Error>::err(create_result.error());
-                }
+            auto link = open_queue(config, !interface_exists && config.create_if_missing);
+            if (link.is_ok() && config.set_up_on_create && !interface_exists) {
+                bring_up(config);
             }
+            return link;
+        }
 
-            // Open TUN/TAP device
-            int tap_fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
-            if (tap_fd < 0) {
-                echo::error("Failed to open /dev/net/tun: ", strerror(errno)).red();
-                return Result<TapLink, Error>::err(Error::io_error("Failed to open /dev/net/tun"));
+        /// Open every queue of a multi-queue TAP interface (IFF_MULTI_QUEUE)
+        /// The kernel spreads received flows across the queue fds, so each queue can be served by its
+        /// own thread; queue i's worker is pinned to config.queue_cpus[i] when that entry exists.
+        /// @param config TAP configuration (config.queues = number of queue fds)
+        /// @return Result containing the queue set (one TapLink per queue), or error
+        static inline Result<LinkQueueSet, Error> create_queues(const TapConfig &config) {
+            if (config.queues == 0) {
+                return Result<LinkQueueSet, Error>::err(Error::invalid_argument("TAP queue count must be > 0"));
             }
+            WIREBIT_TRACE("Creating ", config.queues, " TAP queues for interface: ", config.interface_name.c_str());
 
-            // Configure TAP interface
-            struct ifreq ifr;
-            std::memset(&ifr, 0, sizeof(ifr));
-            ifr.ifr_flags = IFF_TAP | IFF_NO_PI; // TAP device, no packet info header
-            snprintf(ifr.ifr_name, IFNAMSIZ, "%s", config.interface_name.c_str());
+            TapConfig queue_config = config;
+            queue_config.queues = std::max<uint32_t>(config.queues, 2); // Always open with IFF_MULTI_QUEUE
 
-            if (ioctl(tap_fd, TUNSETIFF, &ifr) < 0) {
-                echo::error("Failed to configure TAP interface: ", strerror(errno)).red();
-                close(tap_fd);
-                return Result<TapLink, Error>::err(Error::io_error("Failed to configure TAP interface"));
+            auto prepared = prepare_interface(queue_config);
+            if (!prepared.is_ok()) {
+                return Result<LinkQueueSet, Error>::err(prepared.error());
             }
-
-            // Bring interface up if requested
-            if (config.set_up_on_create && !interface_exists) {
-                auto up_result = bring_interface_up(config.interface_name);
-                if (!up_result.is_ok()) {
-                    echo::warn("Failed to bring interface up: ", up_result.error().message.c_str()).yellow();
-                    // Continue anyway - user can bring it up manually
+            bool interface_exists = prepared.value();
+
+            LinkQueueSet set;
+            for (uint32_t q = 0; q < config.queues; ++q) {
+                // Only the first queue owns interface cleanup
+                bool owner = q == 0 && !interface_exists && config.create_if_missing;
+                auto link = open_queue(queue_config, owner);
+                if (!link.is_ok()) {
+                    return Result<LinkQueueSet, Error>::err(link.error());
                 }
+                int cpu = q < config.queue_cpus.size() ? config.queue_cpus[q] : -1;
+                set.add(std::make_unique<TapLink>(std::move(link.value())), cpu);
+            }
+            if (config.set_up_on_create && !interface_exists) {
+                bring_up(config);
             }
 
-            echo::trace("TapLink created: interface=", config.interface_name.c_str(), " fd=", tap_fd).green();
-
-            return Result<TapLink, Error>::ok(TapLink(tap_fd, config, !interface_exists && config.create_if_missing));
+            WIREBIT_TRACE("TAP queues created: interface=", config.interface_name.c_str(), " queues=", set.size())
+                .green();
+            return Result<LinkQueueSet, Error>::ok(std::move(set));
         }
 
         /// Attach to an existing TAP interface (does not create if missing)
@@ -137,14 +163,15 @@ namespace wirebit {
 
         /// Destructor - closes fd and optionally destroys interface
         inline ~TapLink() {
+            uring_.reset();
             if (tap_fd_ >= 0) {
-                echo::debug("Closing TAP fd: ", tap_fd_);
+                WIREBIT_DEBUG("Closing TAP fd: ", tap_fd_);
                 close(tap_fd_);
                 tap_fd_ = -1;
             }
 
             if (config_.destroy_on_close && we_created_interface_) {
-                echo::trace("Destroying TAP interface: ", config_.interface_name.c_str());
+                WIREBIT_TRACE("Destroying TAP interface: ", config_.interface_name.c_str());
                 destroy_tap_interface(config_.interface_name);
             }
         }
@@ -152,7 +179,8 @@ namespace wirebit {
         /// Move constructor
         inline TapLink(TapLink &&other) noexcept
             : tap_fd_(other.tap_fd_), config_(other.config_), stats_(other.stats_),
-              we_created_interface_(other.we_created_interface_) {
+              we_created_interface_(other.we_created_interface_), rx_scratch_(std::move(other.rx_scratch_)),
+              uring_(std::move(other.uring_)) {
             other.tap_fd_ = -1;
             other.we_created_interface_ = false;
         }
@@ -160,6 +188,7 @@ namespace wirebit {
         /// Move assignment
         inline TapLink &operator=(TapLink &&other) noexcept {
             if (this != &other) {
+                uring_.reset();
                 if (tap_fd_ >= 0) {
                     close(tap_fd_);
                 }
@@ -170,6 +199,8 @@ namespace wirebit {
                 config_ = other.config_;
                 stats_ = other.stats_;
                 we_created_interface_ = other.we_created_interface_;
+                rx_scratch_ = std::move(other.rx_scratch_);
+                uring_ = std::move(other.uring_);
                 other.tap_fd_ = -1;
                 other.we_created_interface_ = false;
             }
@@ -183,7 +214,12 @@ namespace wirebit {
         /// Send a frame through the TAP interface
         /// @param frame Frame to send (payload must be a raw L2 Ethernet frame)
         /// @return Result indicating success or error
-        inline Result<Unit, Error> send(const Frame &frame) override {
+        inline Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Send a borrowed frame through the TAP interface (written straight from the payload span)
+        /// @param frame Frame view to send
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send_view(const FrameView &frame) override {
             if (tap_fd_ < 0) {
                 return Result<Unit, Error>::err(Error::io_error("TAP not open"));
             }
@@ -202,8 +238,33 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::invalid_argument("Ethernet frame too small"));
             }
 
+            // In vnet header mode every frame is preceded by its offload metadata
+            std::span<const Byte> vnet;
+            if (config_.vnet_hdr) {
+                vnet = vnet_prefix(frame.meta);
+            }
+
+            if (uring_) {
+                // Write errors complete asynchronously and are counted in io_uring_stats().tx_errors
+                auto queued = uring_->send(vnet, frame.payload);
+                if (!queued.is_ok()) {
+                    return queued;
+                }
+                stats_.frames_sent++;
+                stats_.bytes_sent += frame.payload.size();
+                stats_export_.sent(frame.payload.size());
+                return Result<Unit, Error>::ok(Unit{});
+            }
+
             // Write raw L2 frame to TAP (IFF_NO_PI means no extra header needed)
-            ssize_t written = write(tap_fd_, frame.payload.data(), frame.payload.size());
+            ssize_t written;
+            if (vnet.empty()) {
+                written = write(tap_fd_, frame.payload.data(), frame.payload.size());
+            } else {
+                struct iovec iov[2] = {{const_cast<Byte *>(vnet.data()), vnet.size()},
+                                       {const_cast<Byte *>(frame.payload.data()), frame.payload.size()}};
+                written = writev(tap_fd_, iov, 2);
+            }
             if (written < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
                     echo::warn("TAP write would block").yellow();
@@ -211,59 +272,135 @@ namespace wirebit {
                 }
                 echo::error("TAP write failed: ", strerror(errno)).red();
                 stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
                 return Result<Unit, Error>::err(Error::io_error("TAP write failed"));
             }
 
-            if (static_cast<size_t>(written) != frame.payload.size()) {
-                echo::warn("TAP partial write: ", written, " of ", frame.payload.size(), " bytes").yellow();
+            size_t expected = vnet.size() + frame.payload.size();
+            if (static_cast<size_t>(written) != expected) {
+                echo::warn("TAP partial write: ", written, " of ", expected, " bytes").yellow();
                 stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
                 return Result<Unit, Error>::err(Error::io_error("TAP partial write"));
             }
 
             stats_.frames_sent++;
-            stats_.bytes_sent += written;
+            stats_.bytes_sent += frame.payload.size();
+            stats_export_.sent(frame.payload.size());
 
-            echo::debug("TapLink sent: ", written, " bytes");
+            WIREBIT_DEBUG("TapLink sent: ", written, " bytes");
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Receive a frame from the TAP interface (non-blocking)
         /// @return Result containing frame if available, or error
         inline Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive a frame from the TAP interface without allocating (non-blocking)
+        /// The view points into the link's receive buffer and stays valid until the next recv call
+        /// @return Result containing frame view if available, or error
+        inline Result<FrameView, Error> recv_view() override {
             if (tap_fd_ < 0) {
-                return Result<Frame, Error>::err(Error::io_error("TAP not open"));
+                return Result<FrameView, Error>::err(Error::io_error("TAP not open"));
             }
 
-            // Read raw L2 frame from TAP
-            // Maximum Ethernet frame size + some padding
-            uint8_t buf[detail::TAP_ETH_FRAME_LEN + 64];
-            ssize_t bytes_read = read(tap_fd_, buf, sizeof(buf));
+            std::span<const Byte> packet;
+            ssize_t bytes_read;
+            if (uring_) {
+                auto received = uring_->recv();
+                if (!received.is_ok()) {
+                    return Result<FrameView, Error>::err(received.error());
+                }
+                packet = received.value();
+                bytes_read = static_cast<ssize_t>(packet.size());
+            } else {
+                // Read raw L2 frame from TAP
+                // Maximum Ethernet frame size + some padding
+                bytes_read = read(tap_fd_, rx_scratch_.data(), rx_scratch_.size());
+                size_t len = bytes_read > 0 ? static_cast<size_t>(bytes_read) : 0;
+                packet = std::span<const Byte>(rx_scratch_.data(), len);
+            }
 
             if (bytes_read < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    return Result<Frame, Error>::err(Error::timeout("No frames available"));
+                    return Result<FrameView, Error>::err(Error::timeout("No frames available"));
                 }
                 echo::error("TAP read failed: ", strerror(errno)).red();
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("TAP read failed"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("TAP read failed"));
+            }
+
+            // Split off the vnet header (kept as frame metadata)
+            std::span<const Byte> vnet;
+            if (config_.vnet_hdr && packet.size() >= VNET_HDR_LEN) {
+                vnet = packet.first(VNET_HDR_LEN);
+                packet = packet.subspan(VNET_HDR_LEN);
+                bytes_read = static_cast<ssize_t>(packet.size());
             }
 
             if (bytes_read < static_cast<ssize_t>(detail::TAP_ETH_HLEN)) {
                 echo::warn("TAP read too small: ", bytes_read, " bytes (minimum ", detail::TAP_ETH_HLEN, ")").yellow();
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("TAP frame too small"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("TAP frame too small"));
             }
 
             stats_.frames_received++;
             stats_.bytes_received += bytes_read;
+            stats_export_.received(bytes_read);
 
             // Wrap raw L2 frame in wirebit Frame
-            Bytes payload(buf, buf + bytes_read);
-            Frame frame = make_frame(FrameType::ETHERNET, std::move(payload), 0, 0);
+            FrameView frame = make_view(FrameType::ETHERNET, packet);
+            frame.meta = vnet;
+            frame.header.meta_len = static_cast<uint32_t>(vnet.size());
 
-            echo::debug("TapLink recv: ", bytes_read, " bytes");
+            WIREBIT_DEBUG("TapLink recv: ", bytes_read, " bytes");
 
-            return Result<Frame, Error>::ok(std::move(frame));
+            return Result<FrameView, Error>::ok(frame);
+        }
+
+        /// Send several frames with a single io_uring submit (one write per frame without io_uring)
+        /// @param frames Frames to send
+        /// @return Result containing number of frames sent, or error if none could be sent
+        inline Result<size_t, Error> send_batch(std::span<const Frame> frames) override {
+            if (!uring_) {
+                return Link::send_batch(frames);
+            }
+            size_t sent = 0;
+            Result<Unit, Error> failed = Result<Unit, Error>::ok(Unit{});
+            for (const Frame &frame : frames) {
+                if (frame.type() != FrameType::ETHERNET || frame.payload.size() < detail::TAP_ETH_HLEN) {
+                    failed = Result<Unit, Error>::err(Error::invalid_argument("Expected Ethernet frame"));
+                    break;
+                }
+                std::span<const Byte> vnet;
+                if (config_.vnet_hdr) {
+                    vnet = vnet_prefix(std::span<const Byte>(frame.meta.data(), frame.meta.size()));
+                }
+                failed = uring_->queue_send(vnet, std::span<const Byte>(frame.payload.data(), frame.payload.size()));
+                if (!failed.is_ok()) {
+                    break;
+                }
+                stats_.frames_sent++;
+                stats_.bytes_sent += frame.payload.size();
+                stats_export_.sent(frame.payload.size());
+                ++sent;
+            }
+            auto flushed = uring_->flush();
+            if (sent == 0 && !failed.is_ok()) {
+                return Result<size_t, Error>::err(failed.error());
+            }
+            if (!flushed.is_ok()) {
+                return Result<size_t, Error>::err(flushed.error());
+            }
+            return Result<size_t, Error>::ok(sent);
         }
 
         /// Check if link is ready for sending
@@ -286,6 +423,41 @@ namespace wirebit {
         /// @return TAP file descriptor
         inline int tap_fd() const { return tap_fd_; }
 
+        /// Get file descriptor for readiness polling (see Link::poll_fd())
+        /// @return File descriptor
+        inline int poll_fd() const override { return uring_ ? uring_->ring_fd() : tap_fd_; }
+
+        /// Submit queued io_uring work before blocking (see Link::prepare_wait())
+        /// @return false if a received frame is already waiting
+        inline bool prepare_wait() override {
+            if (!uring_) {
+                return true;
+            }
+            uring_->flush();
+            return !uring_->has_rx();
+        }
+
+        /// Check if frame I/O goes through io_uring
+        /// @return true if io_uring was requested and set up successfully
+        inline bool io_uring_enabled() const { return uring_ != nullptr; }
+
+        /// Submit sends queued by io_uring_batch and re-arm receive with one io_uring_enter()
+        /// Call once per event loop iteration; no-op without io_uring.
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> flush() {
+            if (uring_) {
+                auto result = uring_->flush();
+                if (!result.is_ok()) {
+                    return Result<Unit, Error>::err(result.error());
+                }
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Get io_uring statistics (all zero without io_uring)
+        /// @return Statistics
+        inline UringPortStats io_uring_stats() const { return uring_ ? uring_->stats() : UringPortStats{}; }
+
         /// Get link statistics
         /// @return Statistics reference
         inline const TapLinkStats &stats() const { return stats_; }
@@ -294,14 +466,110 @@ namespace wirebit {
         inline void reset_stats() { stats_.reset(); }
 
       private:
-        int tap_fd_;                ///< TAP file descriptor
-        TapConfig config_;          ///< Configuration
-        TapLinkStats stats_;        ///< Statistics
-        bool we_created_interface_; ///< True if we created the interface (for cleanup)
+        int tap_fd_;                       ///< TAP file descriptor
+        TapConfig config_;                 ///< Configuration
+        TapLinkStats stats_;               ///< Statistics
+        bool we_created_interface_;        ///< True if we created the interface (for cleanup)
+        Bytes rx_scratch_;                 ///< Receive buffer backing recv_view()
+        std::unique_ptr<UringPort> uring_; ///< io_uring backend (null = read/write)
 
         /// Private constructor
         inline TapLink(int tap_fd, const TapConfig &config, bool we_created)
-            : tap_fd_(tap_fd), config_(config), we_created_interface_(we_created) {}
+            : tap_fd_(tap_fd), config_(config), we_created_interface_(we_created),
+              rx_scratch_(max_frame_size(config)) {}
+
+        /// Helper: Largest read/write on the fd (a 64 KB GSO frame plus vnet header in vnet_hdr mode)
+        static inline size_t max_frame_size(const TapConfig &config) {
+            return config.vnet_hdr ? VNET_HDR_LEN + VNET_MAX_PACKET : detail::TAP_ETH_FRAME_LEN + 64;
+        }
+
+        /// Helper: Create the interface if it is missing and allowed
+        /// @return Result containing whether the interface already existed, or error
+        static inline Result<bool, Error> prepare_interface(const TapConfig &config) {
+            // Check if interface exists
+            bool interface_exists = check_interface_exists(config.interface_name);
+
+            if (!interface_exists && config.create_if_missing) {
+                // Create TAP interface
+                auto create_result = create_tap_interface(config.interface_name, config.queues > 1);
+                if (!create_result.is_ok()) {
+                    return Result<bool, Error>::err(create_result.error());
+                }
+            }
+            return Result<bool, Error>::ok(interface_exists);
+        }
+
+        /// Helper: Open one queue fd on the interface and wrap it in a link
+        /// @param config TAP configuration (queues > 1 selects IFF_MULTI_QUEUE)
+        /// @param we_created True if this link owns interface cleanup
+        /// @return Result containing TapLink or error
+        static inline Result<TapLink, Error> open_queue(const TapConfig &config, bool we_created) {
+            // Open TUN/TAP device
+            int tap_fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+            if (tap_fd < 0) {
+                echo::error("Failed to open /dev/net/tun: ", strerror(errno)).red();
+                return Result<TapLink, Error>::err(Error::io_error("Failed to open /dev/net/tun"));
+            }
+
+            // Configure TAP interface
+            struct ifreq ifr;
+            std::memset(&ifr, 0, sizeof(ifr));
+            ifr.ifr_flags = IFF_TAP | IFF_NO_PI; // TAP device, no packet info header
+            if (config.queues > 1) {
+                ifr.ifr_flags |= IFF_MULTI_QUEUE;
+            }
+            if (config.vnet_hdr) {
+                ifr.ifr_flags |= IFF_VNET_HDR;
+            }
+            snprintf(ifr.ifr_name, IFNAMSIZ, "%s", config.interface_name.c_str());
+
+            if (ioctl(tap_fd, TUNSETIFF, &ifr) < 0) {
+                echo::error("Failed to configure TAP interface: ", strerror(errno)).red();
+                close(tap_fd);
+                return Result<TapLink, Error>::err(Error::io_error("Failed to configure TAP interface"));
+            }
+
+            if (config.vnet_hdr) {
+                auto offload_result = detail::enable_vnet_offload(tap_fd, config.offloads);
+                if (!offload_result.is_ok()) {
+                    close(tap_fd);
+                    return Result<TapLink, Error>::err(offload_result.error());
+                }
+            }
+
+            WIREBIT_TRACE("TapLink created: interface=", config.interface_name.c_str(), " fd=", tap_fd).green();
+
+            TapLink link(tap_fd, config, we_created);
+            if (config.use_io_uring) {
+                UringPortConfig uring_config;
+                uring_config.entries = config.io_uring_entries;
+                // Each buffer holds a 64 KB GSO frame in vnet_hdr mode, so fewer of them are kept per link
+                uint32_t buffers = config.vnet_hdr ? std::max<uint32_t>(config.io_uring_vnet_buffers, 1)
+                                                   : config.io_uring_entries;
+                uring_config.rx_buffers = buffers;
+                uring_config.rx_buffer_size = max_frame_size(config);
+                uring_config.tx_slots = buffers;
+                uring_config.tx_slot_size = max_frame_size(config);
+                uring_config.submit_batch = config.io_uring_batch;
+                auto port = UringPort::create(tap_fd, uring_config);
+                if (port.is_ok()) {
+                    link.uring_ = std::move(port.value());
+                } else {
+                    echo::warn("TapLink: io_uring unavailable, using read/write: ", port.error().message.c_str())
+                        .yellow();
+                }
+            }
+            return Result<TapLink, Error>::ok(std::move(link));
+        }
+
+        /// Helper: Bring a newly created interface up (failure is only logged)
+        static inline void bring_up(const TapConfig &config) {
+            auto up_result = bring_interface_up(config.interface_name);
+            if (!up_result.is_ok()) {
+                echo::warn("Failed to bring interface up: ", up_result.error().message.c_str()).yellow();
+                // Continue anyway - user can bring it up manually
+            }
+        }
 
         /// Check if a network interface exists
         /// @param iface_name Interface name to check
@@ -319,15 +587,16 @@ namespace wirebit {
             bool exists = (ioctl(sock, SIOCGIFINDEX, &ifr) >= 0);
             close(sock);
 
-            echo::debug("Interface ", iface_name.c_str(), " exists: ", exists ? "yes" : "no");
+            WIREBIT_DEBUG("Interface ", iface_name.c_str(), " exists: ", exists ? "yes" : "no");
             return exists;
         }
 
         /// Create a TAP interface using ip commands
         /// @param iface_name Interface name to create
+        /// @param multi_queue Create the interface with IFF_MULTI_QUEUE
         /// @return Result indicating success or error
-        static inline Result<Unit, Error> create_tap_interface(const String &iface_name) {
-            echo::trace("Creating TAP interface: ", iface_name.c_str());
+        static inline Result<Unit, Error> create_tap_interface(const String &iface_name, bool multi_queue) {
+            WIREBIT_TRACE("Creating TAP interface: ", iface_name.c_str());
 
             // Get current user for ownership
             const char *user = getenv("USER");
@@ -336,7 +605,8 @@ namespace wirebit {
             }
 
             // Create TAP interface
-            String cmd = String("sudo ip tuntap add dev ") + iface_name + " mode tap user " + user + " 2>/dev/null";
+            String cmd = String("sudo ip tuntap add dev ") + iface_name + " mode tap user " + user +
+                         (multi_queue ? " multi_queue" : "") + " 2>/dev/null";
             int ret = system(cmd.c_str());
             if (ret != 0) {
                 // May already exist, check
@@ -348,7 +618,7 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::io_error("Failed to create TAP interface"));
             }
 
-            echo::trace("TAP interface ", iface_name.c_str(), " created").green();
+            WIREBIT_TRACE("TAP interface ", iface_name.c_str(), " created").green();
             return Result<Unit, Error>::ok(Unit{});
         }
 
@@ -362,14 +632,14 @@ namespace wirebit {
                 echo::error("Failed to bring up interface ", iface_name.c_str()).red();
                 return Result<Unit, Error>::err(Error::io_error("Failed to bring up interface"));
             }
-            echo::trace("Interface ", iface_name.c_str(), " is up").green();
+            WIREBIT_TRACE("Interface ", iface_name.c_str(), " is up").green();
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Destroy a TAP interface
         /// @param iface_name Interface name to destroy
         static inline void destroy_tap_interface(const String &iface_name) {
-            echo::trace("Destroying TAP interface: ", iface_name.c_str());
+            WIREBIT_TRACE("Destroying TAP interface: ", iface_name.c_str());
             String cmd = String("sudo ip link delete ") + iface_name + " 2>/dev/null";
             int ret = system(cmd.c_str());
             if (ret != 0) {
@@ -7,20 +7,27 @@
 #pragma GCC diagnostic ignored "-Wformat-truncation"
 
 // System headers first
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <echo/echo.hpp>
 #include <fcntl.h>
 #include <linux/if_tun.h>
+#include <memory>
 #include <net/if.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 // Wirebit headers after system headers
+#include <wirebit/common/io_uring.hpp>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
+#include <wirebit/eth/vnet_hdr.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/link_queue_set.hpp>
 
 // Local constants for TUN packet handling
 namespace wirebit {
@@ -35,11 +42,20 @@ namespace wirebit {
 
     /// Configuration for TUN link
     struct TunConfig {
-        String interface_name = "tun0"; ///< TUN interface name
-        bool create_if_missing = true;  ///< Create interface if it doesn't exist (requires sudo)
-        bool destroy_on_close = false;  ///< Destroy interface when link is closed
-        bool set_up_on_create = true;   ///< Bring interface up after creation
-        String ip_address = "";         ///< IP address to assign (e.g., "10.0.0.1/24"), empty = no assignment
+        String interface_name = "tun0";            ///< TUN interface name
+        bool create_if_missing = true;             ///< Create interface if it doesn't exist (requires sudo)
+        bool destroy_on_close = false;             ///< Destroy interface when link is closed
+        bool set_up_on_create = true;              ///< Bring interface up after creation
+        String ip_address = "";                    ///< IP address to assign (e.g., "10.0.0.1/24"), empty = none
+        bool use_io_uring = false;                 ///< Use io_uring for packet I/O (falls back to read/write)
+        uint32_t io_uring_entries = 256;           ///< io_uring queue depth (and RX buffers/TX slots without vnet_hdr)
+        uint32_t io_uring_batch = 1;               ///< Queued sends that trigger an io_uring submit (see flush())
+        size_t io_uring_buffer_size = 2048;        ///< Largest packet in io_uring mode (raise together with the MTU)
+        uint32_t queues = 1;                       ///< Queue fds for create_queues() (> 1 enables IFF_MULTI_QUEUE)
+        Vector<int> queue_cpus = {};               ///< CPU to pin each queue's worker to (missing/-1 = no affinity)
+        bool vnet_hdr = false;                     ///< IFF_VNET_HDR mode: offload metadata in Frame::meta, GSO packets
+        uint32_t offloads = VNET_DEFAULT_OFFLOADS; ///< TUNSETOFFLOAD flags for vnet_hdr mode
+        uint32_t io_uring_vnet_buffers = 16;       ///< io_uring RX buffers and TX slots in vnet_hdr mode (64 KB each)
     };
 
     /// Statistics for TunLink
@@ -78,62 +94,64 @@ namespace wirebit {
     class TunLink : public Link {
       public:
         /// Create a new TUN link
+        /// With config.queues > 1 this opens a single queue of a multi-queue interface; use
+        /// create_queues() to open all of them.
         /// @param config TUN configuration
         /// @return Result containing TunLink or error
         static inline Result<TunLink, Error> create(const TunConfig &config = {}) {
-            echo::trace("Creating TunLink for interface: ", config.interface_name.c_str());
+            WIREBIT_TRACE("Creating TunLink for interface: ", config.interface_name.c_str());
 
-            // Check if interface exists
-            bool interface_exists = check_interface_exists(config.interface_name);
+            auto prepared = prepare_interface(config);
+            if (!prepared.is_ok()) {
+                return Result<TunLink, Error>::err(prepared.error());
+            }
+            bool interface_exists = prepared.value();
 
-            if (!interface_exists && config.create_if_missing) {
-                // Create TUN interface
-                auto create_result = create_tun_interface(config.interface_name);
-                if (!create_result.is_ok()) {
-                    return Result<TunLink, Error>::err(create_result.error());
-                }
+            auto link = open_queue(config, !interface_exists && config.create_if_missing);
+            if (link.is_ok() && !interface_exists) {
+                configure_new_interface(config);
             }
+            return link;
+        }
 
-            // Open TUN/TAP device
-            int tun_fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
-            if (tun_fd < 0) {
-                echo::error("Failed to open /dev/net/tun: ", strerror(errno)).red();
-                return Result<TunLink, Error>::err(Error::io_error("Failed to open /dev/net/tun"));
+        /// Open every queue of a multi-queue TUN interface (IFF_MULTI_QUEUE)
+        /// The kernel spreads received flows across the queue fds, so each queue can be served by its
+        /// own thread; queue i's worker is pinned to config.queue_cpus[i] when that entry exists.
+        /// @param config TUN configuration (config.queues = number of queue fds)
+        /// @return Result containing the queue set (one TunLink per queue), or error
+        static inline Result<LinkQueueSet, Error> create_queues(const TunConfig &config) {
+            if (config.queues == 0) {
+                return Result<LinkQueueSet, Error>::err(Error::invalid_argument("TUN queue count must be > 0"));
             }
+            WIREBIT_TRACE("Creating ", config.queues, " TUN queues for interface: ", config.interface_name.c_str());
 
-            // Configure TUN interface
-            struct ifreq ifr;
-            std::memset(&ifr, 0, sizeof(ifr));
-            ifr.ifr_flags = IFF_TUN | IFF_NO_PI; // TUN device (L3), no packet info header
-            snprintf(ifr.ifr_name, IFNAMSIZ, "%s", config.interface_name.c_str());
+            TunConfig queue_config = config;
+            queue_config.queues = std::max<uint32_t>(config.queues, 2); // Always open with IFF_MULTI_QUEUE
 
-            if (ioctl(tun_fd, TUNSETIFF, &ifr) < 0) {
-                echo::error("Failed to configure TUN interface: ", strerror(errno)).red();
-                close(tun_fd);
-                return Result<TunLink, Error>::err(Error::io_error("Failed to configure TUN interface"));
+            auto prepared = prepare_interface(queue_config);
+            if (!prepared.is_ok()) {
+                return Result<LinkQueueSet, Error>::err(prepared.error());
             }
-
-            // Assign IP address if specified
-            if (!config.ip_address.empty() && !interface_exists) {
-                auto ip_result = assign_ip_address(config.interface_name, config.ip_address);
-                if (!ip_result.is_ok()) {
-                    echo::warn("Failed to assign IP address: ", ip_result.error().message.c_str()).yellow();
-                    // Continue anyway - user can assign manually
+            bool interface_exists = prepared.value();
+
+            LinkQueueSet set;
+            for (uint32_t q = 0; q < config.queues; ++q) {
+                // Only the first queue owns interface cleanup
+                bool owner = q == 0 && !interface_exists && config.create_if_missing;
+                auto link = open_queue(queue_config, owner);
+                if (!link.is_ok()) {
+                    return Result<LinkQueueSet, Error>::err(link.error());
                 }
+                int cpu = q < config.queue_cpus.size() ? config.queue_cpus[q] : -1;
+                set.add(std::make_unique<TunLink>(std::move(link.value())), cpu);
             }
-
-            // Bring interface up if requested
-            if (config.set_up_on_create && !interface_exists) {
-                auto up_result = bring_interface_up(config.interface_name);
-                if (!up_result.is_ok()) {
-                    echo::warn("Failed to bring interface up: ", up_result.error().message.c_str()).yellow();
-                    // Continue anyway - user can bring it up manually
-                }
+            if (!interface_exists) {
+                configure_new_interface(config);
             }
 
-            echo::trace("TunLink created: interface=", config.interface_name.c_str(), " fd=", tun_fd).green();
-
-            return Result<TunLink, Error>::ok(TunLink(tun_fd, config, !interface_exists && config.create_if_missing));
+            WIREBIT_TRACE("TUN queues created: interface=", config.interface_name.c_str(), " queues=", set.size())
+                .green();
+            return Result<LinkQueueSet, Error>::ok(std::move(set));
         }
 
         /// Attach to an existing TUN interface (does not create if missing)
@@ -149,14 +167,15 @@ namespace wirebit {
 
         /// Destructor - closes fd and optionally destroys interface
         inline ~TunLink() {
+            uring_.reset();
             if (tun_fd_ >= 0) {
-                echo::debug("Closing TUN fd: ", tun_fd_);
+                WIREBIT_DEBUG("Closing TUN fd: ", tun_fd_);
                 close(tun_fd_);
                 tun_fd_ = -1;
             }
 
             if (config_.destroy_on_close && we_created_interface_) {
-                echo::trace("Destroying TUN interface: ", config_.interface_name.c_str());
+                WIREBIT_TRACE("Destroying TUN interface: ", config_.interface_name.c_str());
                 destroy_tun_interface(config_.interface_name);
             }
         }
@@ -164,7 +183,8 @@ namespace wirebit {
         /// Move constructor
         inline TunLink(TunLink &&other) noexcept
             : tun_fd_(other.tun_fd_), config_(other.config_), stats_(other.stats_),
-              we_created_interface_(other.we_created_interface_) {
+              we_created_interface_(other.we_created_interface_), rx_scratch_(std::move(other.rx_scratch_)),
+              uring_(std::move(other.uring_)) {
             other.tun_fd_ = -1;
             other.we_created_interface_ = false;
         }
@@ -172,6 +192,7 @@ namespace wirebit {
         /// Move assignment
         inline TunLink &operator=(TunLink &&other) noexcept {
             if (this != &other) {
+                uring_.reset();
                 if (tun_fd_ >= 0) {
                     close(tun_fd_);
                 }
@@ -182,6 +203,8 @@ namespace wirebit {
                 config_ = other.config_;
                 stats_ = other.stats_;
                 we_created_interface_ = other.we_created_interface_;
+                rx_scratch_ = std::move(other.rx_scratch_);
+                uring_ = std::move(other.uring_);
                 other.tun_fd_ = -1;
                 other.we_created_interface_ = false;
             }
@@ -195,7 +218,12 @@ namespace wirebit {
         /// Send a frame through the TUN interface
         /// @param frame Frame to send (payload must be a raw IP packet)
         /// @return Result indicating success or error
-        inline Result<Unit, Error> send(const Frame &frame) override {
+        inline Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Send a borrowed frame through the TUN interface (written straight from the payload span)
+        /// @param frame Frame view to send
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send_view(const FrameView &frame) override {
             if (tun_fd_ < 0) {
                 return Result<Unit, Error>::err(Error::io_error("TUN not open"));
             }
@@ -213,8 +241,33 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::invalid_argument("IP packet too small"));
             }
 
+            // In vnet header mode every packet is preceded by its offload metadata
+            std::span<const Byte> vnet;
+            if (config_.vnet_hdr) {
+                vnet = vnet_prefix(frame.meta);
+            }
+
+            if (uring_) {
+                // Write errors complete asynchronously and are counted in io_uring_stats().tx_errors
+                auto queued = uring_->send(vnet, frame.payload);
+                if (!queued.is_ok()) {
+                    return queued;
+                }
+                stats_.packets_sent++;
+                stats_.bytes_sent += frame.payload.size();
+                stats_export_.sent(frame.payload.size());
+                return Result<Unit, Error>::ok(Unit{});
+            }
+
             // Write raw IP packet to TUN (IFF_NO_PI means no extra header needed)
-            ssize_t written = write(tun_fd_, frame.payload.data(), frame.payload.size());
+            ssize_t written;
+            if (vnet.empty()) {
+                written = write(tun_fd_, frame.payload.data(), frame.payload.size());
+            } else {
+                struct iovec iov[2] = {{const_cast<Byte *>(vnet.data()), vnet.size()},
+                                       {const_cast<Byte *>(frame.payload.data()), frame.payload.size()}};
+                written = writev(tun_fd_, iov, 2);
+            }
             if (written < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
                     echo::warn("TUN write would block").yellow();
@@ -222,58 +275,134 @@ namespace wirebit {
                 }
                 echo::error("TUN write failed: ", strerror(errno)).red();
                 stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
                 return Result<Unit, Error>::err(Error::io_error("TUN write failed"));
             }
 
-            if (static_cast<size_t>(written) != frame.payload.size()) {
-                echo::warn("TUN partial write: ", written, " of ", frame.payload.size(), " bytes").yellow();
+            size_t expected = vnet.size() + frame.payload.size();
+            if (static_cast<size_t>(written) != expected) {
+                echo::warn("TUN partial write: ", written, " of ", expected, " bytes").yellow();
                 stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
                 return Result<Unit, Error>::err(Error::io_error("TUN partial write"));
             }
 
             stats_.packets_sent++;
-            stats_.bytes_sent += written;
+            stats_.bytes_sent += frame.payload.size();
+            stats_export_.sent(frame.payload.size());
 
-            echo::debug("TunLink sent: ", written, " bytes");
+            WIREBIT_DEBUG("TunLink sent: ", written, " bytes");
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Receive a frame from the TUN interface (non-blocking)
         /// @return Result containing frame if available, or error
         inline Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive a frame from the TUN interface without allocating (non-blocking)
+        /// The view points into the link's receive buffer and stays valid until the next recv call
+        /// @return Result containing frame view if available, or error
+        inline Result<FrameView, Error> recv_view() override {
             if (tun_fd_ < 0) {
-                return Result<Frame, Error>::err(Error::io_error("TUN not open"));
+                return Result<FrameView, Error>::err(Error::io_error("TUN not open"));
             }
 
-            // Read raw IP packet from TUN
-            uint8_t buf[detail::TUN_MAX_PACKET];
-            ssize_t bytes_read = read(tun_fd_, buf, sizeof(buf));
+            std::span<const Byte> packet;
+            ssize_t bytes_read;
+            if (uring_) {
+                auto received = uring_->recv();
+                if (!received.is_ok()) {
+                    return Result<FrameView, Error>::err(received.error());
+                }
+                packet = received.value();
+                bytes_read = static_cast<ssize_t>(packet.size());
+            } else {
+                // Read raw IP packet from TUN
+                bytes_read = read(tun_fd_, rx_scratch_.data(), rx_scratch_.size());
+                size_t len = bytes_read > 0 ? static_cast<size_t>(bytes_read) : 0;
+                packet = std::span<const Byte>(rx_scratch_.data(), len);
+            }
 
             if (bytes_read < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    return Result<Frame, Error>::err(Error::timeout("No packets available"));
+                    return Result<FrameView, Error>::err(Error::timeout("No packets available"));
                 }
                 echo::error("TUN read failed: ", strerror(errno)).red();
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("TUN read failed"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("TUN read failed"));
+            }
+
+            // Split off the vnet header (kept as frame metadata)
+            std::span<const Byte> vnet;
+            if (config_.vnet_hdr && packet.size() >= VNET_HDR_LEN) {
+                vnet = packet.first(VNET_HDR_LEN);
+                packet = packet.subspan(VNET_HDR_LEN);
+                bytes_read = static_cast<ssize_t>(packet.size());
             }
 
             if (bytes_read < static_cast<ssize_t>(detail::TUN_IP_HLEN)) {
                 echo::warn("TUN read too small: ", bytes_read, " bytes (minimum ", detail::TUN_IP_HLEN, ")").yellow();
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("TUN packet too small"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("TUN packet too small"));
             }
 
             stats_.packets_received++;
             stats_.bytes_received += bytes_read;
+            stats_export_.received(bytes_read);
 
             // Wrap raw IP packet in wirebit Frame
-            Bytes payload(buf, buf + bytes_read);
-            Frame frame = make_frame(FrameType::IP, std::move(payload), 0, 0);
+            FrameView frame = make_view(FrameType::IP, packet);
+            frame.meta = vnet;
+            frame.header.meta_len = static_cast<uint32_t>(vnet.size());
+
+            WIREBIT_DEBUG("TunLink recv: ", bytes_read, " bytes");
 
-            echo::debug("TunLink recv: ", bytes_read, " bytes");
+            return Result<FrameView, Error>::ok(frame);
+        }
 
-            return Result<Frame, Error>::ok(std::move(frame));
+        /// Send several packets with a single io_uring submit (one write per packet without io_uring)
+        /// @param frames Frames to send
+        /// @return Result containing number of packets sent, or error if none could be sent
+        inline Result<size_t, Error> send_batch(std::span<const Frame> frames) override {
+            if (!uring_) {
+                return Link::send_batch(frames);
+            }
+            size_t sent = 0;
+            Result<Unit, Error> failed = Result<Unit, Error>::ok(Unit{});
+            for (const Frame &frame : frames) {
+                if (frame.type() != FrameType::IP || frame.payload.size() < detail::TUN_IP_HLEN) {
+                    failed = Result<Unit, Error>::err(Error::invalid_argument("Expected IP packet"));
+                    break;
+                }
+                std::span<const Byte> vnet;
+                if (config_.vnet_hdr) {
+                    vnet = vnet_prefix(std::span<const Byte>(frame.meta.data(), frame.meta.size()));
+                }
+                failed = uring_->queue_send(vnet, std::span<const Byte>(frame.payload.data(), frame.payload.size()));
+                if (!failed.is_ok()) {
+                    break;
+                }
+                stats_.packets_sent++;
+                stats_.bytes_sent += frame.payload.size();
+                stats_export_.sent(frame.payload.size());
+                ++sent;
+            }
+            auto flushed = uring_->flush();
+            if (sent == 0 && !failed.is_ok()) {
+                return Result<size_t, Error>::err(failed.error());
+            }
+            if (!flushed.is_ok()) {
+                return Result<size_t, Error>::err(flushed.error());
+            }
+            return Result<size_t, Error>::ok(sent);
         }
 
         /// Check if link is ready for sending
@@ -296,6 +425,41 @@ namespace wirebit {
         /// @return TUN file descriptor
         inline int tun_fd() const { return tun_fd_; }
 
+        /// Get file descriptor for readiness polling (see Link::poll_fd())
+        /// @return File descriptor
+        inline int poll_fd() const override { return uring_ ? uring_->ring_fd() : tun_fd_; }
+
+        /// Submit queued io_uring work before blocking (see Link::prepare_wait())
+        /// @return false if a received packet is already waiting
+        inline bool prepare_wait() override {
+            if (!uring_) {
+                return true;
+            }
+            uring_->flush();
+            return !uring_->has_rx();
+        }
+
+        /// Check if packet I/O goes through io_uring
+        /// @return true if io_uring was requested and set up successfully
+        inline bool io_uring_enabled() const { return uring_ != nullptr; }
+
+        /// Submit sends queued by io_uring_batch and re-arm receive with one io_uring_enter()
+        /// Call once per event loop iteration; no-op without io_uring.
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> flush() {
+            if (uring_) {
+                auto result = uring_->flush();
+                if (!result.is_ok()) {
+                    return Result<Unit, Error>::err(result.error());
+                }
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Get io_uring statistics (all zero without io_uring)
+        /// @return Statistics
+        inline UringPortStats io_uring_stats() const { return uring_ ? uring_->stats() : UringPortStats{}; }
+
         /// Get link statistics
         /// @return Statistics reference
         inline const TunLinkStats &stats() const { return stats_; }
@@ -304,14 +468,120 @@ namespace wirebit {
         inline void reset_stats() { stats_.reset(); }
 
       private:
-        int tun_fd_;                ///< TUN file descriptor
-        TunConfig config_;          ///< Configuration
-        TunLinkStats stats_;        ///< Statistics
-        bool we_created_interface_; ///< True if we created the interface (for cleanup)
+        int tun_fd_;                       ///< TUN file descriptor
+        TunConfig config_;                 ///< Configuration
+        TunLinkStats stats_;               ///< Statistics
+        bool we_created_interface_;        ///< True if we created the interface (for cleanup)
+        Bytes rx_scratch_;                 ///< Receive buffer backing recv_view()
+        std::unique_ptr<UringPort> uring_; ///< io_uring backend (null = read/write)
 
         /// Private constructor
         inline TunLink(int tun_fd, const TunConfig &config, bool we_created)
-            : tun_fd_(tun_fd), config_(config), we_created_interface_(we_created) {}
+            : tun_fd_(tun_fd), config_(config), we_created_interface_(we_created),
+              rx_scratch_(config.vnet_hdr ? VNET_HDR_LEN + VNET_MAX_PACKET : detail::TUN_MAX_PACKET) {}
+
+        /// Helper: Create the interface if it is missing and allowed
+        /// @return Result containing whether the interface already existed, or error
+        static inline Result<bool, Error> prepare_interface(const TunConfig &config) {
+            // Check if interface exists
+            bool interface_exists = check_interface_exists(config.interface_name);
+
+            if (!interface_exists && config.create_if_missing) {
+                // Create TUN interface
+                auto create_result = create_tun_interface(config.interface_name, config.queues > 1);
+                if (!create_result.is_ok()) {
+                    return Result<bool, Error>::err(create_result.error());
+                }
+            }
+            return Result<bool, Error>::ok(interface_exists);
+        }
+
+        /// Helper: Open one queue fd on the interface and wrap it in a link
+        /// @param config TUN configuration (queues > 1 selects IFF_MULTI_QUEUE)
+        /// @param we_created True if this link owns interface cleanup
+        /// @return Result containing TunLink or error
+        static inline Result<TunLink, Error> open_queue(const TunConfig &config, bool we_created) {
+            // Open TUN/TAP device
+            int tun_fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+            if (tun_fd < 0) {
+                echo::error("Failed to open /dev/net/tun: ", strerror(errno)).red();
+                return Result<TunLink, Error>::err(Error::io_error("Failed to open /dev/net/tun"));
+            }
+
+            // Configure TUN interface
+            struct ifreq ifr;
+            std::memset(&ifr, 0, sizeof(ifr));
+            ifr.ifr_flags = IFF_TUN | IFF_NO_PI; // TUN device (L3), no packet info header
+            if (config.queues > 1) {
+                ifr.ifr_flags |= IFF_MULTI_QUEUE;
+            }
+            if (config.vnet_hdr) {
+                ifr.ifr_flags |= IFF_VNET_HDR;
+            }
+            snprintf(ifr.ifr_name, IFNAMSIZ, "%s", config.interface_name.c_str());
+
+            if (ioctl(tun_fd, TUNSETIFF, &ifr) < 0) {
+                echo::error("Failed to configure TUN interface: ", strerror(errno)).red();
+                close(tun_fd);
+                return Result<TunLink, Error>::err(Error::io_error("Failed to configure TUN interface"));
+            }
+
+            if (config.vnet_hdr) {
+                auto offload_result = detail::enable_vnet_offload(tun_fd, config.offloads);
+                if (!offload_result.is_ok()) {
+                    close(tun_fd);
+                    return Result<TunLink, Error>::err(offload_result.error());
+                }
+            }
+
+            WIREBIT_TRACE("TunLink created: interface=", config.interface_name.c_str(), " fd=", tun_fd).green();
+
+            TunLink link(tun_fd, config, we_created);
+            if (config.use_io_uring) {
+                UringPortConfig uring_config;
+                uring_config.entries = config.io_uring_entries;
+                // Each buffer holds a 64 KB GSO frame in vnet_hdr mode, so fewer of them are kept per link
+                uint32_t buffers = config.vnet_hdr ? std::max<uint32_t>(config.io_uring_vnet_buffers, 1)
+                                                   : config.io_uring_entries;
+                uring_config.rx_buffers = buffers;
+                // GSO packets need the full 64 KB plus vnet header per buffer
+                size_t buffer_size =
+                    config.vnet_hdr ? VNET_HDR_LEN + VNET_MAX_PACKET : config.io_uring_buffer_size;
+                uring_config.rx_buffer_size = buffer_size;
+                uring_config.tx_slots = buffers;
+                uring_config.tx_slot_size = buffer_size;
+                uring_config.submit_batch = config.io_uring_batch;
+                auto port = UringPort::create(tun_fd, uring_config);
+                if (port.is_ok()) {
+                    link.uring_ = std::move(port.value());
+                } else {
+                    echo::warn("TunLink: io_uring unavailable, using read/write: ", port.error().message.c_str())
+                        .yellow();
+                }
+            }
+            return Result<TunLink, Error>::ok(std::move(link));
+        }
+
+        /// Helper: Assign the address and bring a newly created interface up (failures are only logged)
+        static inline void configure_new_interface(const TunConfig &config) {
+            // Assign IP address if specified
+            if (!config.ip_address.empty()) {
+                auto ip_result = assign_ip_address(config.interface_name, config.ip_address);
+                if (!ip_result.is_ok()) {
+                    echo::warn("Failed to assign IP address: ", ip_result.error().message.c_str()).yellow();
+                    // Continue anyway - user can assign manually
+                }
+            }
+
+            // Bring interface up if requested
+            if (config.set_up_on_create) {
+                auto up_result = bring_interface_up(config.interface_name);
+                if (!up_result.is_ok()) {
+                    echo::warn("Failed to bring interface up: ", up_result.error().message.c_str()).yellow();
+                    // Continue anyway - user can bring it up manually
+                }
+            }
+        }
 
         /// Check if a network interface exists
         /// @param iface_name Interface name to check
@@ -329,15 +599,16 @@ namespace wirebit {
             bool exists = (ioctl(sock, SIOCGIFINDEX, &ifr) >= 0);
             close(sock);
 
-            echo::debug("Interface ", iface_name.c_str(), " exists: ", exists ? "yes" : "no");
+            WIREBIT_DEBUG("Interface ", iface_name.c_str(), " exists: ", exists ? "yes" : "no");
             return exists;
         }
 
         /// Create a TUN interface using ip commands
         /// @param iface_name Interface name to create
+        /// @param multi_queue Create the interface with IFF_MULTI_QUEUE
         /// @return Result indicating success or error
-        static inline Result<Unit, Error> create_tun_interface(const String &iface_name) {
-            echo::trace("Creating TUN interface: ", iface_name.c_str());
+        static inline Result<Unit, Error> create_tun_interface(const String &iface_name, bool multi_queue) {
+            WIREBIT_TRACE("Creating TUN interface: ", iface_name.c_str());
 
             // Get current user for ownership
             const char *user = getenv("USER");
@@ -346,7 +617,8 @@ namespace wirebit {
             }
 
             // Create TUN interface
-            String cmd = String("sudo ip tuntap add dev ") + iface_name + " mode tun user " + user + " 2>/dev/null";
+            String cmd = String("sudo ip tuntap add dev ") + iface_name + " mode tun user " + user +
+                         (multi_queue ? " multi_queue" : "") + " 2>/dev/null";
             int ret = system(cmd.c_str());
             if (ret != 0) {
                 // May already exist, check
@@ -358,7 +630,7 @@ namespace wirebit {
                 return Result<Unit, Error>::err(Error::io_error("Failed to create TUN interface"));
             }
 
-            echo::trace("TUN interface ", iface_name.c_str(), " created").green();
+            WIREBIT_TRACE("TUN interface ", iface_name.c_str(), " created").green();
             return Result<Unit, Error>::ok(Unit{});
         }
 
@@ -367,14 +639,14 @@ namespace wirebit {
         /// @param ip_addr IP address with CIDR (e.g., "10.0.0.1/24")
         /// @return Result indicating success or error
         static inline Result<Unit, Error> assign_ip_address(const String &iface_name, const String &ip_addr) {
-            echo::trace("Assigning IP address ", ip_addr.c_str(), " to ", iface_name.c_str());
+            WIREBIT_TRACE("Assigning IP address ", ip_addr.c_str(), " to ", iface_name.c_str());
             String cmd = String("sudo ip addr add ") + ip_addr + " dev " + iface_name + " 2>/dev/null";
             int ret = system(cmd.c_str());
             if (ret != 0) {
                 echo::error("Failed to assign IP address to ", iface_name.c_str()).red();
                 return Result<Unit, Error>::err(Error::io_error("Failed to assign IP address"));
             }
-            echo::trace("IP address assigned").green();
+            WIREBIT_TRACE("IP address assigned").green();
             return Result<Unit, Error>::ok(Unit{});
         }
 
@@ -388,14 +660,14 @@ namespace wirebit {
                 echo::error("Failed to bring up interface ", iface_name.c_str()).red();
                 return Result<Unit, Error>::err(Error::io_error("Failed to bring up interface"));
             }
-            echo::trace("Interface ", iface_name.c_str(), " is up").green();
+            WIREBIT_TRACE("Interface ", iface_name.c_str(), " is up").green();
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Destroy a TUN interface
         /// @param iface_name Interface name to destroy
         static inline void destroy_tun_interface(const String &iface_name) {
-            echo::trace("Destroying TUN interface: ", iface_name.c_str());
+            WIREBIT_TRACE("Destroying TUN interface: ", iface_name.c_str());
             String cmd = String("sudo ip link delete ") + iface_name + " 2>/dev/null";
             int ret = system(cmd.c_str());
             if (ret != 0) {
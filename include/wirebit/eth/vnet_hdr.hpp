@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <span>
+#include <wirebit/common/types.hpp>
+
+#ifndef NO_HARDWARE
+#include <linux/if_tun.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace wirebit {
+
+    /// Offload metadata exchanged with TAP/TUN devices opened with IFF_VNET_HDR
+    /// Same layout as struct virtio_net_hdr (linux/virtio_net.h, which does not compile as C++).
+    /// Links in vnet header mode carry it in Frame::meta; fields are in host byte order.
+    struct VnetHeader {
+        uint8_t flags = 0;        ///< VNET_HDR_F_* flags
+        uint8_t gso_type = 0;     ///< VNET_HDR_GSO_* type
+        uint16_t hdr_len = 0;     ///< Ethernet + IP + TCP/UDP header bytes
+        uint16_t gso_size = 0;    ///< Payload bytes per segment
+        uint16_t csum_start = 0;  ///< Offset to start checksumming from
+        uint16_t csum_offset = 0; ///< Offset after csum_start to store the checksum
+    };
+    static_assert(sizeof(VnetHeader) == 10, "VnetHeader must match struct virtio_net_hdr");
+
+    constexpr uint8_t VNET_HDR_F_NEEDS_CSUM = 1; ///< Checksum from csum_start must be filled in
+    constexpr uint8_t VNET_HDR_F_DATA_VALID = 2; ///< Checksum already validated
+    constexpr uint8_t VNET_HDR_GSO_NONE = 0;     ///< Not a GSO frame
+    constexpr uint8_t VNET_HDR_GSO_TCPV4 = 1;    ///< TCPv4 segmentation offload
+    constexpr uint8_t VNET_HDR_GSO_UDP = 3;      ///< UDP fragmentation offload
+    constexpr uint8_t VNET_HDR_GSO_TCPV6 = 4;    ///< TCPv6 segmentation offload
+    constexpr uint8_t VNET_HDR_GSO_ECN = 0x80;   ///< TCP ECN bit set on the super-frame
+
+    constexpr size_t VNET_HDR_LEN = sizeof(VnetHeader); ///< Bytes of vnet header in Frame::meta
+    constexpr size_t VNET_MAX_PACKET = 65536 + 64;      ///< Largest GSO super-frame (64 KB + L2 headers)
+
+    /// Encode a vnet header as frame metadata
+    /// @param hdr Header to encode
+    /// @return Metadata bytes (VNET_HDR_LEN long)
+    inline Bytes vnet_meta(const VnetHeader &hdr) {
+        Bytes meta(VNET_HDR_LEN);
+        std::memcpy(meta.data(), &hdr, VNET_HDR_LEN);
+        return meta;
+    }
+
+    /// Decode a vnet header from frame metadata
+    /// @param meta Frame metadata
+    /// @return Result containing the header, or invalid_argument if meta is not a vnet header
+    inline Result<VnetHeader, Error> vnet_header(std::span<const Byte> meta) {
+        if (meta.size() != VNET_HDR_LEN) {
+            return Result<VnetHeader, Error>::err(Error::invalid_argument("Metadata is not a vnet header"));
+        }
+        VnetHeader hdr;
+        std::memcpy(&hdr, meta.data(), VNET_HDR_LEN);
+        return Result<VnetHeader, Error>::ok(hdr);
+    }
+
+    /// Get the vnet header bytes to write in front of a packet
+    /// @param meta Frame metadata
+    /// @return meta if it holds a vnet header, otherwise an all-zero header (no offload requested)
+    inline std::span<const Byte> vnet_prefix(std::span<const Byte> meta) {
+        static constexpr Byte NO_OFFLOAD[VNET_HDR_LEN] = {};
+        if (meta.size() == VNET_HDR_LEN) {
+            return meta;
+        }
+        return std::span<const Byte>(NO_OFFLOAD, VNET_HDR_LEN);
+    }
+
+    /// Check if a vnet header describes a GSO super-frame that the receiver must segment
+    /// @param hdr Header to check
+    /// @return true for TCPv4/TCPv6/UDP GSO
+    inline bool vnet_is_gso(const VnetHeader &hdr) {
+        return (hdr.gso_type & ~VNET_HDR_GSO_ECN) != VNET_HDR_GSO_NONE;
+    }
+
+#ifndef NO_HARDWARE
+    /// Offloads requested by default in vnet header mode (checksum plus TCPv4/TCPv6 segmentation)
+    constexpr uint32_t VNET_DEFAULT_OFFLOADS = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+
+    namespace detail {
+        /// Helper: Set the vnet header size and negotiate offloads on a TAP/TUN fd opened with IFF_VNET_HDR
+        /// Offloads the kernel refuses are only logged; the device then sends unsegmented frames.
+        /// @param fd TAP/TUN fd
+        /// @param offloads TUN_F_* flags
+        /// @return Result indicating success, or io_error if the header size cannot be set
+        inline Result<Unit, Error> enable_vnet_offload(int fd, uint32_t offloads) {
+            int hdr_len = static_cast<int>(VNET_HDR_LEN);
+            if (::ioctl(fd, TUNSETVNETHDRSZ, &hdr_len) < 0) {
+                echo::error("Failed to set vnet header size: ", strerror(errno)).red();
+                return Result<Unit, Error>::err(Error::io_error("TUNSETVNETHDRSZ failed"));
+            }
+            if (::ioctl(fd, TUNSETOFFLOAD, static_cast<unsigned long>(offloads)) < 0) {
+                echo::warn("Failed to enable offloads 0x", std::hex, offloads, std::dec, ": ", strerror(errno))
+                    .yellow();
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+    } // namespace detail
+#endif // NO_HARDWARE
+
+} // namespace wirebit
@@ -2,6 +2,9 @@
 
 #include <cstring>
 #include <echo/echo.hpp>
+#include <span>
+#include <wirebit/common/crc.hpp>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
 
@@ -15,12 +18,38 @@ namespace wirebit {
         IP = 4,       ///< IP L3 packet (TUN)
     };
 
+    /// Frame flag: the last 4 bytes of meta are a CRC32C of the payload and the rest of meta
+    /// (header fields are not covered, links may rewrite deliver_at_ns on the way)
+    constexpr uint32_t FRAME_FLAG_CHECKSUM = 1u << 0;
+
+    /// Frame flag: the payload is an ShmSlabHandle to the real payload (internal to ShmLink, never
+    /// seen by callers)
+    constexpr uint32_t FRAME_FLAG_SLAB = 1u << 1;
+
+    /// Size of the checksum trailer added by FRAME_FLAG_CHECKSUM
+    constexpr size_t FRAME_CHECKSUM_LEN = 4;
+
+    /// Magic number starting every encoded frame ('WBIT')
+    constexpr uint32_t FRAME_MAGIC = 0x57424954;
+
+    /// Encoded header versions (FrameHeader::version on the wire)
+    constexpr uint16_t FRAME_HEADER_V1 = 1; ///< The FrameHeader struct as is (44 bytes)
+    constexpr uint16_t FRAME_HEADER_V2 = 2; ///< Compact: varint fields, zero fields omitted (see encode_frame_header())
+
+    /// Smallest v2 header: magic, version, presence bits, type and payload length
+    constexpr size_t FRAME_HEADER_V2_MIN = 9;
+
+    /// Largest v2 header (every field present at its widest varint)
+    constexpr size_t FRAME_HEADER_V2_MAX = 55;
+
     /// Frame header structure (packed for stable wire format)
+    /// This is the in-memory form and the v1 wire format. Decoding a v2 header yields the same
+    /// struct with version reset to FRAME_HEADER_V1, so frames can be forwarded in either format.
     struct FrameHeader {
         uint32_t magic = 0x57424954; ///< Magic number 'WBIT'
         uint16_t version = 1;        ///< Protocol version
         uint16_t frame_type;         ///< FrameType enum value
-        uint32_t flags = 0;          ///< Frame flags (reserved)
+        uint32_t flags = 0;          ///< FRAME_FLAG_* bits
         uint64_t tx_timestamp_ns;    ///< Transmission timestamp (nanoseconds)
         uint64_t deliver_at_ns;      ///< Delivery timestamp for simulation (0 = immediate)
         uint32_t src_endpoint_id;    ///< Source endpoint ID
@@ -89,6 +118,314 @@ namespace wirebit {
         }
     };
 
+    /// Non-owning view of a frame: header plus payload/metadata spans
+    /// The referenced bytes are borrowed and must outlive the view
+    /// (e.g. ring memory stays valid until FrameRing::consume())
+    struct FrameView {
+        FrameHeader header;            ///< Frame header (copied, fixed size)
+        std::span<const Byte> payload; ///< Borrowed payload bytes
+        std::span<const Byte> meta;    ///< Borrowed metadata bytes (optional)
+
+        /// Get frame type
+        inline FrameType type() const { return static_cast<FrameType>(header.frame_type); }
+
+        /// Get total frame size (header + payload + meta)
+        inline size_t total_size() const { return sizeof(FrameHeader) + payload.size() + meta.size(); }
+
+        /// Check if frame is broadcast
+        inline bool is_broadcast() const { return header.dst_endpoint_id == 0; }
+    };
+
+    namespace detail {
+        /// v2 header presence bits: which optional fields follow the payload length
+        constexpr Byte FRAME_V2_TX = 1u << 0;      ///< zigzag(tx_timestamp_ns - time base)
+        constexpr Byte FRAME_V2_DELIVER = 1u << 1; ///< zigzag(deliver_at_ns - tx_timestamp_ns)
+        constexpr Byte FRAME_V2_SRC = 1u << 2;     ///< src_endpoint_id
+        constexpr Byte FRAME_V2_DST = 1u << 3;     ///< dst_endpoint_id
+        constexpr Byte FRAME_V2_FLAGS = 1u << 4;   ///< flags
+        constexpr Byte FRAME_V2_META = 1u << 5;    ///< meta_len
+
+        /// Append an LEB128 varint
+        inline Byte *put_varint(Byte *out, uint64_t value) {
+            while (value >= 0x80) {
+                *out++ = static_cast<Byte>(value | 0x80);
+                value >>= 7;
+            }
+            *out++ = static_cast<Byte>(value);
+            return out;
+        }
+
+        /// Read an LEB128 varint of at most max_bits
+        /// @return Pointer past the varint, or nullptr if it is truncated or too wide
+        inline const Byte *get_varint(const Byte *in, const Byte *end, uint64_t &value, unsigned max_bits = 64) {
+            value = 0;
+            for (unsigned shift = 0; shift < max_bits; shift += 7) {
+                if (in == end) {
+                    return nullptr;
+                }
+                Byte b = *in++;
+                value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) {
+                    return (max_bits < 64 && (value >> max_bits) != 0) ? nullptr : in;
+                }
+            }
+            return nullptr;
+        }
+
+        inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+        inline int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+        /// Outcome of parse_frame_header()
+        enum class HeaderParse : uint8_t {
+            Ok,      ///< Header decoded
+            Short,   ///< Valid so far, more bytes needed
+            Invalid, ///< Bad magic, unknown version or malformed field
+        };
+
+        /// Decode a v1 or v2 header from the start of data
+        /// @param data Encoded bytes
+        /// @param size Number of bytes available
+        /// @param header Output header (always version FRAME_HEADER_V1)
+        /// @param header_len Encoded header size
+        /// @param time_base Time base the v2 tx timestamp is relative to
+        inline HeaderParse parse_frame_header(const Byte *data, size_t size, FrameHeader &header, size_t &header_len,
+                                              uint64_t time_base) {
+            uint32_t magic = 0;
+            uint16_t version = 0;
+            if (size < sizeof(magic) + sizeof(version)) {
+                return size >= sizeof(magic) && std::memcmp(data, &FRAME_MAGIC, sizeof(magic)) != 0
+                           ? HeaderParse::Invalid
+                           : HeaderParse::Short;
+            }
+            std::memcpy(&magic, data, sizeof(magic));
+            std::memcpy(&version, data + sizeof(magic), sizeof(version));
+            if (magic != FRAME_MAGIC) {
+                return HeaderParse::Invalid;
+            }
+
+            if (version == FRAME_HEADER_V1) {
+                if (size < sizeof(FrameHeader)) {
+                    return HeaderParse::Short;
+                }
+                std::memcpy(&header, data, sizeof(FrameHeader));
+                header_len = sizeof(FrameHeader);
+                return HeaderParse::Ok;
+            }
+            if (version != FRAME_HEADER_V2) {
+                return HeaderParse::Invalid;
+            }
+
+            // A truncated varint is Short unless the header could not be that long anyway
+            const Byte *end = data + size;
+            const HeaderParse truncated = size < FRAME_HEADER_V2_MAX ? HeaderParse::Short : HeaderParse::Invalid;
+            const Byte *p = data + sizeof(magic) + sizeof(version);
+            if (p == end) {
+                return truncated;
+            }
+            Byte present = *p++;
+            if (present & ~(FRAME_V2_TX | FRAME_V2_DELIVER | FRAME_V2_SRC | FRAME_V2_DST | FRAME_V2_FLAGS |
+                            FRAME_V2_META)) {
+                return HeaderParse::Invalid;
+            }
+
+            uint64_t type = 0, payload_len = 0, tx = 0, deliver = 0, src = 0, dst = 0, flags = 0, meta_len = 0;
+            if ((p = get_varint(p, end, type, 16)) == nullptr || (p = get_varint(p, end, payload_len, 32)) == nullptr ||
+                ((present & FRAME_V2_TX) && (p = get_varint(p, end, tx)) == nullptr) ||
+                ((present & FRAME_V2_DELIVER) && (p = get_varint(p, end, deliver)) == nullptr) ||
+                ((present & FRAME_V2_SRC) && (p = get_varint(p, end, src, 32)) == nullptr) ||
+                ((present & FRAME_V2_DST) && (p = get_varint(p, end, dst, 32)) == nullptr) ||
+                ((present & FRAME_V2_FLAGS) && (p = get_varint(p, end, flags, 32)) == nullptr) ||
+                ((present & FRAME_V2_META) && (p = get_varint(p, end, meta_len, 32)) == nullptr)) {
+                return truncated;
+            }
+
+            header = FrameHeader();
+            header.frame_type = static_cast<uint16_t>(type);
+            header.payload_len = static_cast<uint32_t>(payload_len);
+            if (present & FRAME_V2_TX) {
+                header.tx_timestamp_ns = time_base + static_cast<uint64_t>(unzigzag(tx));
+            }
+            if (present & FRAME_V2_DELIVER) {
+                header.deliver_at_ns = header.tx_timestamp_ns + static_cast<uint64_t>(unzigzag(deliver));
+            }
+            header.src_endpoint_id = static_cast<uint32_t>(src);
+            header.dst_endpoint_id = static_cast<uint32_t>(dst);
+            header.flags = static_cast<uint32_t>(flags);
+            header.meta_len = static_cast<uint32_t>(meta_len);
+            header_len = static_cast<size_t>(p - data);
+            return HeaderParse::Ok;
+        }
+    } // namespace detail
+
+    /// Encode a header in the compact v2 format
+    ///
+    /// Layout: [magic:4][version:2 = 2][presence bits:1][frame_type][payload_len], then whichever of
+    /// tx_timestamp_ns, deliver_at_ns, src/dst_endpoint_id, flags and meta_len are non-zero, all as
+    /// varints. tx_timestamp_ns is stored relative to time_base and deliver_at_ns relative to
+    /// tx_timestamp_ns (zigzag, so either may be earlier), which keeps both to a few bytes when
+    /// time_base is close to the frame times (FrameRing uses its creation time).
+    /// A CAN frame from an endpoint to the bus takes 15-17 bytes instead of 44.
+    ///
+    /// @param header Header to encode (version is ignored)
+    /// @param time_base Time base the decoder will use (0 = absolute timestamps)
+    /// @param out Buffer of at least FRAME_HEADER_V2_MAX bytes
+    /// @return Encoded size
+    inline size_t encode_frame_header(const FrameHeader &header, uint64_t time_base, Byte *out) {
+        const uint16_t version = FRAME_HEADER_V2;
+        std::memcpy(out, &FRAME_MAGIC, sizeof(FRAME_MAGIC));
+        std::memcpy(out + sizeof(FRAME_MAGIC), &version, sizeof(version));
+        Byte &present = out[sizeof(FRAME_MAGIC) + sizeof(version)];
+        present = 0;
+        Byte *p = &present + 1;
+        p = detail::put_varint(p, header.frame_type);
+        p = detail::put_varint(p, header.payload_len);
+        if (header.tx_timestamp_ns != 0) {
+            present |= detail::FRAME_V2_TX;
+            p = detail::put_varint(p, detail::zigzag(static_cast<int64_t>(header.tx_timestamp_ns - time_base)));
+        }
+        if (header.deliver_at_ns != 0) {
+            present |= detail::FRAME_V2_DELIVER;
+            p = detail::put_varint(
+                p, detail::zigzag(static_cast<int64_t>(header.deliver_at_ns - header.tx_timestamp_ns)));
+        }
+        if (header.src_endpoint_id != 0) {
+            present |= detail::FRAME_V2_SRC;
+            p = detail::put_varint(p, header.src_endpoint_id);
+        }
+        if (header.dst_endpoint_id != 0) {
+            present |= detail::FRAME_V2_DST;
+            p = detail::put_varint(p, header.dst_endpoint_id);
+        }
+        if (header.flags != 0) {
+            present |= detail::FRAME_V2_FLAGS;
+            p = detail::put_varint(p, header.flags);
+        }
+        if (header.meta_len != 0) {
+            present |= detail::FRAME_V2_META;
+            p = detail::put_varint(p, header.meta_len);
+        }
+        return static_cast<size_t>(p - out);
+    }
+
+    /// Decode a v1 or v2 header from the start of encoded frame bytes
+    /// @param data Encoded frame (at least the whole header)
+    /// @param header Output header, always in the fixed (v1) form
+    /// @param time_base Time base the v2 header was encoded against
+    /// @return Result containing the encoded header size, or invalid_argument
+    inline Result<size_t, Error> decode_frame_header(std::span<const Byte> data, FrameHeader &header,
+                                                     uint64_t time_base = 0) {
+        size_t header_len = 0;
+        switch (detail::parse_frame_header(data.data(), data.size(), header, header_len, time_base)) {
+        case detail::HeaderParse::Ok:
+            return Result<size_t, Error>::ok(header_len);
+        case detail::HeaderParse::Short:
+            return Result<size_t, Error>::err(Error::invalid_argument("Data too small for frame header"));
+        default:
+            break;
+        }
+        bool bad_magic = std::memcmp(data.data(), &FRAME_MAGIC, sizeof(FRAME_MAGIC)) != 0;
+        return Result<size_t, Error>::err(
+            Error::invalid_argument(bad_magic ? "Invalid frame magic number" : "Unsupported frame version"));
+    }
+
+    /// Helper: Borrow a view of an owning frame
+    inline FrameView make_view(const Frame &frame) {
+        FrameView view;
+        view.header = frame.header;
+        view.payload = std::span<const Byte>(frame.payload.data(), frame.payload.size());
+        view.meta = std::span<const Byte>(frame.meta.data(), frame.meta.size());
+        return view;
+    }
+
+    /// Helper: Create a frame view over borrowed payload bytes with current timestamp
+    inline FrameView make_view(FrameType type, std::span<const Byte> payload, uint32_t src_id = 0,
+                               uint32_t dst_id = 0) {
+        FrameView view;
+        view.header.frame_type = static_cast<uint16_t>(type);
+        view.header.src_endpoint_id = src_id;
+        view.header.dst_endpoint_id = dst_id;
+        view.header.tx_timestamp_ns = now_ns();
+        view.header.payload_len = static_cast<uint32_t>(payload.size());
+        view.payload = payload;
+        return view;
+    }
+
+    /// Helper: Create a frame view over borrowed payload bytes with an explicit timestamp
+    /// (e.g. a kernel receive timestamp, saving the clock read of make_view())
+    inline FrameView make_view_with_timestamp(FrameType type, std::span<const Byte> payload, uint64_t tx_timestamp_ns,
+                                              uint32_t src_id = 0, uint32_t dst_id = 0) {
+        FrameView view;
+        view.header.frame_type = static_cast<uint16_t>(type);
+        view.header.src_endpoint_id = src_id;
+        view.header.dst_endpoint_id = dst_id;
+        view.header.tx_timestamp_ns = tx_timestamp_ns;
+        view.header.payload_len = static_cast<uint32_t>(payload.size());
+        view.payload = payload;
+        return view;
+    }
+
+    /// Compute the checksum stored by FRAME_FLAG_CHECKSUM
+    /// @param payload Payload bytes
+    /// @param meta Metadata bytes without the checksum trailer
+    /// @return CRC32C of payload followed by meta
+    inline uint32_t frame_checksum(std::span<const Byte> payload, std::span<const Byte> meta) {
+        return crc32c(meta, crc32c(payload));
+    }
+
+    /// Append a payload checksum to a frame and set FRAME_FLAG_CHECKSUM
+    /// Does nothing if the frame already carries one.
+    /// @param frame Frame to protect
+    inline void add_frame_checksum(Frame &frame) {
+        if (frame.header.flags & FRAME_FLAG_CHECKSUM) {
+            return;
+        }
+        uint32_t crc = frame_checksum(std::span<const Byte>(frame.payload.data(), frame.payload.size()),
+                                      std::span<const Byte>(frame.meta.data(), frame.meta.size()));
+        const auto *crc_bytes = reinterpret_cast<const Byte *>(&crc);
+        frame.meta.insert(frame.meta.end(), crc_bytes, crc_bytes + FRAME_CHECKSUM_LEN);
+        frame.header.meta_len = static_cast<uint32_t>(frame.meta.size());
+        frame.header.flags |= FRAME_FLAG_CHECKSUM;
+    }
+
+    /// Check and strip the checksum of a frame view
+    /// Frames without FRAME_FLAG_CHECKSUM pass unchanged. On success the trailer is removed from
+    /// view.meta/meta_len and the flag is cleared, so the view looks as it did before add_frame_checksum().
+    /// @param view Frame view to verify (modified in place)
+    /// @return true if the frame has no checksum or the checksum matches
+    inline bool verify_frame_checksum(FrameView &view) {
+        if (!(view.header.flags & FRAME_FLAG_CHECKSUM)) {
+            return true;
+        }
+        if (view.meta.size() < FRAME_CHECKSUM_LEN) {
+            return false;
+        }
+        std::span<const Byte> meta = view.meta.first(view.meta.size() - FRAME_CHECKSUM_LEN);
+        uint32_t stored;
+        std::memcpy(&stored, view.meta.data() + meta.size(), FRAME_CHECKSUM_LEN);
+        if (stored != frame_checksum(view.payload, meta)) {
+            return false;
+        }
+        view.meta = meta;
+        view.header.meta_len = static_cast<uint32_t>(meta.size());
+        view.header.flags &= ~FRAME_FLAG_CHECKSUM;
+        return true;
+    }
+
+    /// Helper: Copy a frame view into an owning frame
+    inline Frame to_frame(const FrameView &view) {
+        Frame frame;
+        frame.header = view.header;
+        frame.header.payload_len = static_cast<uint32_t>(view.payload.size());
+        frame.header.meta_len = static_cast<uint32_t>(view.meta.size());
+        if (!view.payload.empty()) {
+            frame.payload.assign(view.payload.data(), view.payload.data() + view.payload.size());
+        }
+        if (!view.meta.empty()) {
+            frame.meta.assign(view.meta.data(), view.meta.data() + view.meta.size());
+        }
+        return frame;
+    }
+
     /// Helper: Create a frame with current timestamp
     inline Frame make_frame(FrameType type, const Bytes &payload, uint32_t src_id = 0, uint32_t dst_id = 0) {
         uint64_t ts = now_ns();
@@ -109,17 +446,30 @@ namespace wirebit {
 
     /// Encode frame to bytes
     /// Format: [FrameHeader][payload bytes][meta bytes]
-    inline Bytes encode_frame(const Frame &frame) {
-        echo::trace("Encoding frame: type=", frame.header.frame_type, " payload=", frame.header.payload_len,
-                    " meta=", frame.header.meta_len);
+    /// @param frame Frame to encode
+    /// @param version FRAME_HEADER_V1 (fixed 44-byte header) or FRAME_HEADER_V2 (compact)
+    /// @param time_base Time base of a v2 header (see encode_frame_header())
+    inline Bytes encode_frame(const Frame &frame, uint16_t version = FRAME_HEADER_V1, uint64_t time_base = 0) {
+        WIREBIT_TRACE("Encoding frame: type=", frame.header.frame_type, " payload=", frame.header.payload_len,
+                      " meta=", frame.header.meta_len, " version=", version);
 
         Bytes result;
         size_t total_size = sizeof(FrameHeader) + frame.payload.size() + frame.meta.size();
         result.reserve(total_size);
 
         // Encode header
-        const auto *header_bytes = reinterpret_cast<const Byte *>(&frame.header);
-        result.insert(result.end(), header_bytes, header_bytes + sizeof(FrameHeader));
+        if (version == FRAME_HEADER_V2) {
+            FrameHeader header = frame.header;
+            header.payload_len = static_cast<uint32_t>(frame.payload.size());
+            header.meta_len = static_cast<uint32_t>(frame.meta.size());
+            Byte compact[FRAME_HEADER_V2_MAX];
+            result.insert(result.end(), compact, compact + encode_frame_header(header, time_base, compact));
+        } else {
+            FrameHeader header = frame.header;
+            header.version = FRAME_HEADER_V1;
+            const auto *header_bytes = reinterpret_cast<const Byte *>(&header);
+            result.insert(result.end(), header_bytes, header_bytes + sizeof(FrameHeader));
+        }
 
         // Encode payload
         result.insert(result.end(), frame.payload.begin(), frame.payload.end());
@@ -129,45 +479,50 @@ namespace wirebit {
             result.insert(result.end(), frame.meta.begin(), frame.meta.end());
         }
 
-        echo::trace("Frame encoded: ", result.size(), " bytes");
+        WIREBIT_TRACE("Frame encoded: ", result.size(), " bytes");
         return result;
     }
 
     /// Decode frame from bytes
-    inline Result<Frame, Error> decode_frame(const Bytes &data) {
-        echo::trace("Decoding frame, size: ", data.size());
-
-        // Check minimum size
-        if (data.size() < sizeof(FrameHeader)) {
-            echo::error("Frame too small: ", data.size(), " < ", sizeof(FrameHeader)).red();
-            return Result<Frame, Error>::err(Error::invalid_argument("Frame data too small for header"));
-        }
-
-        // Decode header
+    /// Accepts v1 and v2 headers; the decoded header is always in the fixed (v1) form.
+    /// A FRAME_FLAG_CHECKSUM trailer is verified and removed (invalid_argument on mismatch).
+    /// @param data Encoded frame
+    /// @param time_base Time base of a v2 header (see encode_frame_header())
+    inline Result<Frame, Error> decode_frame(const Bytes &data, uint64_t time_base = 0) {
+        WIREBIT_TRACE("Decoding frame, size: ", data.size());
+
+        // Decode and validate header (magic, version, size)
         Frame frame;
-        std::memcpy(&frame.header, data.data(), sizeof(FrameHeader));
-
-        // Validate magic number
-        if (frame.header.magic != 0x57424954) {
-            echo::error("Invalid frame magic: 0x", std::hex, frame.header.magic).red();
-            return Result<Frame, Error>::err(Error::invalid_argument("Invalid frame magic number"));
-        }
-
-        // Validate version
-        if (frame.header.version != 1) {
-            echo::error("Unsupported frame version: ", frame.header.version).red();
-            return Result<Frame, Error>::err(Error::invalid_argument("Unsupported frame version"));
+        auto header_len = decode_frame_header(std::span<const Byte>(data.data(), data.size()), frame.header, time_base);
+        if (!header_len.is_ok()) {
+            echo::error("Invalid frame header: ", header_len.error().message, " (", data.size(), " bytes)").red();
+            return Result<Frame, Error>::err(header_len.error());
         }
 
         // Check total size
-        size_t expected_size = sizeof(FrameHeader) + frame.header.payload_len + frame.header.meta_len;
+        size_t expected_size = header_len.value() + frame.header.payload_len + frame.header.meta_len;
         if (data.size() < expected_size) {
             echo::error("Frame data incomplete: ", data.size(), " < ", expected_size).red();
             return Result<Frame, Error>::err(Error::invalid_argument("Frame data incomplete"));
         }
 
+        // Verify the optional payload checksum and drop its trailer
+        size_t offset = header_len.value();
+        if (frame.header.flags & FRAME_FLAG_CHECKSUM) {
+            FrameView view;
+            view.header = frame.header;
+            view.payload = std::span<const Byte>(data.data() + offset, frame.header.payload_len);
+            view.meta = std::span<const Byte>(data.data() + offset + frame.header.payload_len, frame.header.meta_len);
+            if (!verify_frame_checksum(view)) {
+                echo::error("Frame checksum mismatch: src=", frame.header.src_endpoint_id,
+                            " payload=", frame.header.payload_len)
+                    .red();
+                return Result<Frame, Error>::err(Error::invalid_argument("Frame checksum mismatch"));
+            }
+            frame.header = view.header;
+        }
+
         // Decode payload
-        size_t offset = sizeof(FrameHeader);
         if (frame.header.payload_len > 0) {
             frame.payload.assign(data.begin() + offset, data.begin() + offset + frame.header.payload_len);
             offset += frame.header.payload_len;
@@ -178,42 +533,31 @@ namespace wirebit {
             frame.meta.assign(data.begin() + offset, data.begin() + offset + frame.header.meta_len);
         }
 
-        echo::debug("Frame decoded: type=", frame.header.frame_type, " src=", frame.header.src_endpoint_id,
-                    " dst=", frame.header.dst_endpoint_id, " payload=", frame.header.payload_len,
-                    " meta=", frame.header.meta_len);
+        WIREBIT_DEBUG("Frame decoded: type=", frame.header.frame_type, " src=", frame.header.src_endpoint_id,
+                      " dst=", frame.header.dst_endpoint_id, " payload=", frame.header.payload_len,
+                      " meta=", frame.header.meta_len);
 
         return Result<Frame, Error>::ok(std::move(frame));
     }
 
     /// Validate frame header (without decoding payload)
+    /// Accepts v1 and v2 headers.
     inline Result<Unit, Error> validate_frame_header(const Bytes &data) {
-        if (data.size() < sizeof(FrameHeader)) {
-            return Result<Unit, Error>::err(Error::invalid_argument("Data too small for frame header"));
-        }
-
         FrameHeader header;
-        std::memcpy(&header, data.data(), sizeof(FrameHeader));
-
-        if (header.magic != 0x57424954) {
-            return Result<Unit, Error>::err(Error::invalid_argument("Invalid frame magic number"));
+        auto header_len = decode_frame_header(std::span<const Byte>(data.data(), data.size()), header);
+        if (!header_len.is_ok()) {
+            return Result<Unit, Error>::err(header_len.error());
         }
-
-        if (header.version != 1) {
-            return Result<Unit, Error>::err(Error::invalid_argument("Unsupported frame version"));
-        }
-
         return Result<Unit, Error>::ok(Unit{});
     }
 
     /// Get frame type from encoded data (without full decode)
     inline Result<FrameType, Error> peek_frame_type(const Bytes &data) {
-        if (data.size() < sizeof(FrameHeader)) {
-            return Result<FrameType, Error>::err(Error::invalid_argument("Data too small for frame header"));
-        }
-
         FrameHeader header;
-        std::memcpy(&header, data.data(), sizeof(FrameHeader));
-
+        auto header_len = decode_frame_header(std::span<const Byte>(data.data(), data.size()), header);
+        if (!header_len.is_ok()) {
+            return Result<FrameType, Error>::err(header_len.error());
+        }
         return Result<FrameType, Error>::ok(static_cast<FrameType>(header.frame_type));
     }
 
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+
+namespace wirebit {
+
+    /// Statistics for FramePool
+    struct FramePoolStats {
+        uint64_t hits = 0;      ///< Buffers served from a free list
+        uint64_t misses = 0;    ///< Buffers that had to be allocated
+        uint64_t recycled = 0;  ///< Buffers returned to a free list
+        uint64_t discarded = 0; ///< Returned buffers freed (list full, too small or too large)
+
+        inline void reset() {
+            hits = 0;
+            misses = 0;
+            recycled = 0;
+            discarded = 0;
+        }
+    };
+
+    /// Recycling pool for Frame payload/meta buffers
+    ///
+    /// Buffers are kept in free lists per size class - CAN (16), CAN FD and small serial chunks (128),
+    /// serial bursts (512), Ethernet MTU (2048) and jumbo frames (9216) - so a steady stream of
+    /// frames reuses the same few allocations instead of going through the heap for every
+    /// payload. Larger requests are allocated normally and not cached.
+    ///
+    /// A pool is not thread-safe. FramePool::local() gives each thread its own, which is how the
+    /// free lists stay uncontended: a frame handed to another thread and released there with
+    /// FramePool::local().release() (or a PooledFrame using the thread-local pools) joins that
+    /// thread's lists. Links take a pool with Link::set_frame_pool() and fill the frames they return
+    /// from it.
+    ///
+    /// Example usage:
+    /// @code
+    /// FramePool &pool = FramePool::local();
+    /// link->set_frame_pool(&pool);
+    /// auto result = link->recv();
+    /// if (result.is_ok()) {
+    ///     PooledFrame frame(std::move(result.value()), pool); // buffers go back on scope exit
+    ///     handle(frame.get());
+    /// }
+    /// @endcode
+    class FramePool {
+      public:
+        /// Buffer capacities handed out, smallest first
+        static constexpr std::array<size_t, 5> SIZE_CLASSES = {16, 128, 512, 2048, 9216};
+
+        /// Create a pool
+        /// @param max_per_class Most buffers kept in each free list
+        inline explicit FramePool(size_t max_per_class = 256) : max_per_class_(max_per_class) {}
+
+        FramePool(const FramePool &) = delete;
+        FramePool &operator=(const FramePool &) = delete;
+
+        /// Get the calling thread's pool
+        static inline FramePool &local() {
+            thread_local FramePool pool;
+            return pool;
+        }
+
+        /// Get a buffer of n bytes (contents unspecified)
+        /// @param n Buffer size
+        /// @return Buffer with size() == n and the capacity of n's size class
+        inline Bytes acquire(size_t n) {
+            size_t cls = class_for(n);
+            if (cls == SIZE_CLASSES.size()) {
+                stats_.misses++;
+                return Bytes(n);
+            }
+
+            Bytes buffer;
+            Vector<Bytes> &list = free_[cls];
+            if (!list.empty()) {
+                buffer = std::move(list.back());
+                list.pop_back();
+                stats_.hits++;
+            } else {
+                buffer.reserve(SIZE_CLASSES[cls]);
+                stats_.misses++;
+            }
+            buffer.resize(n);
+            return buffer;
+        }
+
+        /// Get a buffer holding a copy of bytes
+        /// @param bytes Bytes to copy
+        /// @return Buffer from acquire(bytes.size())
+        inline Bytes acquire_copy(std::span<const Byte> bytes) {
+            Bytes buffer = acquire(bytes.size());
+            if (!bytes.empty()) {
+                std::memcpy(buffer.data(), bytes.data(), bytes.size());
+            }
+            return buffer;
+        }
+
+        /// Return a buffer's storage to the pool
+        /// Any buffer can be returned, not only ones from acquire(); it is filed under the largest
+        /// size class its capacity covers.
+        /// @param buffer Buffer to recycle (left empty)
+        inline void release(Bytes &buffer) {
+            size_t capacity = buffer.capacity();
+            if (capacity < SIZE_CLASSES.front() || capacity > 2 * SIZE_CLASSES.back()) {
+                if (capacity > 0) {
+                    stats_.discarded++;
+                }
+                buffer = Bytes();
+                return;
+            }
+
+            size_t cls = SIZE_CLASSES.size() - 1;
+            while (SIZE_CLASSES[cls] > capacity) {
+                --cls;
+            }
+            if (free_[cls].size() >= max_per_class_) {
+                stats_.discarded++;
+                buffer = Bytes();
+                return;
+            }
+            buffer.clear();
+            free_[cls].push_back(std::move(buffer));
+            buffer = Bytes();
+            stats_.recycled++;
+        }
+
+        /// Return a frame's payload and meta storage to the pool
+        /// @param frame Frame to recycle (left with empty payload and meta)
+        inline void release(Frame &frame) {
+            release(frame.payload);
+            release(frame.meta);
+        }
+
+        /// Copy a frame view into an owning frame whose buffers come from the pool
+        /// @param view Frame view
+        /// @return Owning frame (same as wirebit::to_frame())
+        inline Frame to_frame(const FrameView &view) {
+            Frame frame;
+            frame.header = view.header;
+            frame.header.payload_len = static_cast<uint32_t>(view.payload.size());
+            frame.header.meta_len = static_cast<uint32_t>(view.meta.size());
+            frame.payload = acquire_copy(view.payload);
+            if (!view.meta.empty()) {
+                frame.meta = acquire_copy(view.meta);
+            }
+            return frame;
+        }
+
+        /// Create a frame with current timestamp whose payload comes from the pool
+        /// @param type Frame type
+        /// @param payload Payload bytes to copy
+        /// @param src_id Source endpoint ID
+        /// @param dst_id Destination endpoint ID
+        /// @return Owning frame
+        inline Frame make_frame(FrameType type, std::span<const Byte> payload, uint32_t src_id = 0,
+                                uint32_t dst_id = 0) {
+            return to_frame(make_view(type, payload, src_id, dst_id));
+        }
+
+        /// Get number of cached buffers in a size class
+        /// @param cls Index into SIZE_CLASSES
+        inline size_t cached(size_t cls) const { return cls < free_.size() ? free_[cls].size() : 0; }
+
+        /// Free every cached buffer
+        inline void trim() {
+            for (Vector<Bytes> &list : free_) {
+                list.clear();
+            }
+        }
+
+        /// Get pool statistics
+        inline const FramePoolStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        std::array<Vector<Bytes>, SIZE_CLASSES.size()> free_; ///< Free lists per size class
+        size_t max_per_class_;                                ///< Free list length limit
+        FramePoolStats stats_;                                ///< Pool statistics
+
+        /// Helper: Smallest size class that holds n bytes (SIZE_CLASSES.size() if none)
+        static inline size_t class_for(size_t n) {
+            size_t cls = 0;
+            while (cls < SIZE_CLASSES.size() && SIZE_CLASSES[cls] < n) {
+                ++cls;
+            }
+            return cls;
+        }
+    };
+
+    /// Owning frame that returns its buffers to a FramePool when destroyed (move-only)
+    ///
+    /// A frame wrapped with the thread-local pools (the one-argument constructor, or FramePool::local()
+    /// of the constructing thread) goes back to FramePool::local() of whichever thread destroys it, so
+    /// it may be moved to and released on another thread. A frame wrapped with any other pool must be
+    /// destroyed on the thread that uses that pool.
+    class PooledFrame {
+      public:
+        /// Wrap a frame whose buffers go back to the destroying thread's FramePool::local()
+        /// @param frame Frame to own
+        inline explicit PooledFrame(Frame &&frame) : frame_(std::move(frame)), pool_(nullptr), local_(true) {}
+
+        /// Wrap a frame
+        /// @param frame Frame to own
+        /// @param pool Pool that receives the buffers (must outlive this object)
+        inline PooledFrame(Frame &&frame, FramePool &pool)
+            : frame_(std::move(frame)), pool_(&pool == &FramePool::local() ? nullptr : &pool),
+              local_(pool_ == nullptr) {}
+
+        inline ~PooledFrame() { recycle(); }
+
+        inline PooledFrame(PooledFrame &&other) noexcept
+            : frame_(std::move(other.frame_)), pool_(other.pool_), local_(other.local_) {
+            other.pool_ = nullptr;
+            other.local_ = false;
+        }
+
+        inline PooledFrame &operator=(PooledFrame &&other) noexcept {
+            if (this != &other) {
+                recycle();
+                frame_ = std::move(other.frame_);
+                pool_ = other.pool_;
+                local_ = other.local_;
+                other.pool_ = nullptr;
+                other.local_ = false;
+            }
+            return *this;
+        }
+
+        PooledFrame(const PooledFrame &) = delete;
+        PooledFrame &operator=(const PooledFrame &) = delete;
+
+        /// Get the frame
+        inline Frame &get() { return frame_; }
+        inline const Frame &get() const { return frame_; }
+
+        inline Frame *operator->() { return &frame_; }
+        inline const Frame *operator->() const { return &frame_; }
+
+        /// Give up the frame without recycling it
+        /// @return The frame
+        inline Frame take() {
+            pool_ = nullptr;
+            local_ = false;
+            return std::move(frame_);
+        }
+
+      private:
+        Frame frame_;     ///< Owned frame
+        FramePool *pool_; ///< Destination for the buffers (nullptr for the thread-local pools)
+        bool local_;      ///< Release into the destroying thread's FramePool::local()
+
+        /// Helper: Hand the buffers back (nothing after a move or take())
+        inline void recycle() {
+            if (local_) {
+                FramePool::local().release(frame_);
+            } else if (pool_ != nullptr) {
+                pool_->release(frame_);
+            }
+        }
+    };
+
+} // namespace wirebit
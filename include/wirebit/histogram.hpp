@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <span>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+
+namespace wirebit {
+
+    /// Log-linear histogram of non-negative integer values (HDR style)
+    ///
+    /// Values below 2^SUB_BUCKET_BITS are counted exactly; above that every power of two is split
+    /// into 2^(SUB_BUCKET_BITS-1) equal buckets, so a recorded value is known to within 1/32 (about
+    /// 3%) of itself at any magnitude. Memory is fixed (BUCKET_COUNT counters), record() is a
+    /// couple of shifts and an increment, and two histograms merge by adding their counters.
+    /// Values of 2^MAX_VALUE_BITS and above (about 4.9 hours in nanoseconds) share the top bucket;
+    /// max() still reports them exactly.
+    ///
+    /// Not synchronized: record from one thread, and copy or merge() for snapshots.
+    class Histogram {
+      public:
+        static constexpr unsigned SUB_BUCKET_BITS = 6;                           ///< Precision bits
+        static constexpr unsigned MAX_VALUE_BITS = 44;                           ///< Tracked range
+        static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS; ///< Exact buckets
+        static constexpr size_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;          ///< Buckets per octave
+        /// Number of counters (1280, about 10 KiB)
+        static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKET_HALF + SUB_BUCKET_COUNT;
+
+        /// Record a value
+        /// @param value Value to record
+        /// @param count Number of occurrences
+        inline void record(uint64_t value, uint64_t count = 1) {
+            counts_[bucket_index(value)] += count;
+            total_ += count;
+            sum_ += value * count;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        /// Add all values of another histogram
+        inline void merge(const Histogram &other) {
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                counts_[i] += other.counts_[i];
+            }
+            total_ += other.total_;
+            sum_ += other.sum_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+
+        /// Clear all values
+        inline void reset() { *this = Histogram(); }
+
+        /// Get number of recorded values
+        inline uint64_t count() const { return total_; }
+
+        /// Get smallest recorded value (0 if empty)
+        inline uint64_t min() const { return total_ == 0 ? 0 : min_; }
+
+        /// Get largest recorded value
+        inline uint64_t max() const { return max_; }
+
+        /// Get mean of recorded values (0 if empty)
+        inline double mean() const {
+            return total_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(total_);
+        }
+
+        /// Get the value below or at which a given share of the recorded values fall
+        /// Reported as the highest value of the matching bucket, clamped to [min(), max()].
+        /// @param percent Percentile in [0, 100] (e.g. 99.9)
+        /// @return Value, or 0 if empty
+        inline uint64_t percentile(double percent) const {
+            if (total_ == 0) {
+                return 0;
+            }
+            if (percent <= 0.0) {
+                return min_;
+            }
+            double clamped = std::clamp(percent, 0.0, 100.0);
+            uint64_t target = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total_)));
+            target = std::max<uint64_t>(target, 1);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                seen += counts_[i];
+                if (seen >= target) {
+                    return std::clamp(bucket_highest(i), min_, max_);
+                }
+            }
+            return max_;
+        }
+
+        /// Get the count of one bucket
+        inline uint64_t bucket_count(size_t index) const { return index < BUCKET_COUNT ? counts_[index] : 0; }
+
+        /// Get the bucket a value is counted in
+        static constexpr size_t bucket_index(uint64_t value) {
+            if (value < SUB_BUCKET_COUNT) {
+                return static_cast<size_t>(value);
+            }
+            unsigned top = static_cast<unsigned>(std::bit_width(value)) - 1;
+            if (top >= MAX_VALUE_BITS) {
+                return BUCKET_COUNT - 1;
+            }
+            unsigned shift = top - SUB_BUCKET_BITS + 1;
+            return shift * SUB_BUCKET_HALF + static_cast<size_t>(value >> shift);
+        }
+
+        /// Get the smallest value counted in a bucket
+        static constexpr uint64_t bucket_lowest(size_t index) {
+            if (index < SUB_BUCKET_COUNT) {
+                return index;
+            }
+            size_t shift = index / SUB_BUCKET_HALF - 1;
+            uint64_t sub = index - shift * SUB_BUCKET_HALF;
+            return sub << shift;
+        }
+
+        /// Get the largest value counted in a bucket
+        static constexpr uint64_t bucket_highest(size_t index) {
+            if (index + 1 >= BUCKET_COUNT) {
+                return UINT64_MAX;
+            }
+            return bucket_lowest(index + 1) - 1;
+        }
+
+        /// Encode into a compact byte string (varints of the non-empty buckets)
+        /// @return Encoded histogram, typically a few hundred bytes
+        inline Bytes encode() const {
+            Bytes out;
+            out.push_back(ENCODING_VERSION);
+            put_varint(out, total_);
+            put_varint(out, sum_);
+            put_varint(out, min());
+            put_varint(out, max_);
+            size_t last = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                if (counts_[i] != 0) {
+                    put_varint(out, i - last);
+                    put_varint(out, counts_[i]);
+                    last = i;
+                }
+            }
+            return out;
+        }
+
+        /// Decode a histogram produced by encode()
+        /// @param data Encoded bytes
+        /// @return Result containing histogram, or invalid_argument if the data is malformed
+        static inline Result<Histogram, Error> decode(std::span<const Byte> data) {
+            Histogram h;
+            size_t pos = 0;
+            if (data.empty() || data[pos++] != ENCODING_VERSION) {
+                return Result<Histogram, Error>::err(Error::invalid_argument("Unknown histogram encoding"));
+            }
+            uint64_t min_value = 0;
+            if (!get_varint(data, pos, h.total_) || !get_varint(data, pos, h.sum_) ||
+                !get_varint(data, pos, min_value) || !get_varint(data, pos, h.max_)) {
+                return Result<Histogram, Error>::err(Error::invalid_argument("Truncated histogram"));
+            }
+            h.min_ = h.total_ == 0 ? UINT64_MAX : min_value;
+
+            uint64_t index = 0;
+            uint64_t counted = 0;
+            while (pos < data.size()) {
+                uint64_t delta = 0;
+                uint64_t count = 0;
+                if (!get_varint(data, pos, delta) || !get_varint(data, pos, count)) {
+                    return Result<Histogram, Error>::err(Error::invalid_argument("Truncated histogram"));
+                }
+                index += delta;
+                if (index >= BUCKET_COUNT) {
+                    return Result<Histogram, Error>::err(Error::invalid_argument("Histogram bucket out of range"));
+                }
+                h.counts_[index] += count;
+                counted += count;
+            }
+            if (counted != h.total_) {
+                return Result<Histogram, Error>::err(Error::invalid_argument("Histogram counts do not add up"));
+            }
+            return Result<Histogram, Error>::ok(std::move(h));
+        }
+
+      private:
+        static constexpr Byte ENCODING_VERSION = 1;
+
+        std::array<uint64_t, BUCKET_COUNT> counts_{};
+        uint64_t total_ = 0;
+        uint64_t sum_ = 0;
+        uint64_t min_ = UINT64_MAX;
+        uint64_t max_ = 0;
+
+        static inline void put_varint(Bytes &out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<Byte>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<Byte>(value));
+        }
+
+        static inline bool get_varint(std::span<const Byte> data, size_t &pos, uint64_t &value) {
+            value = 0;
+            for (unsigned shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+                Byte b = data[pos++];
+                value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /// Latency and occupancy histograms for one link or endpoint
+    /// Attach with Link::set_histograms() or Endpoint::set_histograms(); recording happens on the
+    /// receive path (and, for ShmLink, at every TX ring push). Frames without a tx_timestamp_ns are
+    /// not recorded; deliver_at_ns is only used when a model set it.
+    struct LinkHistograms {
+        Histogram latency_ns;     ///< Receive time - tx_timestamp_ns (send to recv)
+        Histogram model_delay_ns; ///< deliver_at_ns - tx_timestamp_ns (delay the link model asked for)
+        Histogram lateness_ns;    ///< Receive time - deliver_at_ns (actual minus modelled, 0 if early)
+        Histogram ring_usage_pct; ///< TX ring fill in percent at each push (ShmLink)
+
+        /// Record a received frame
+        /// @param header Header of the received frame
+        /// @param now Receive time (same clock as tx_timestamp_ns)
+        inline void record_rx(const FrameHeader &header, uint64_t now) {
+            if (header.tx_timestamp_ns == 0) {
+                return;
+            }
+            latency_ns.record(now > header.tx_timestamp_ns ? now - header.tx_timestamp_ns : 0);
+            if (header.deliver_at_ns != 0) {
+                model_delay_ns.record(header.deliver_at_ns > header.tx_timestamp_ns
+                                          ? header.deliver_at_ns - header.tx_timestamp_ns
+                                          : 0);
+                lateness_ns.record(now > header.deliver_at_ns ? now - header.deliver_at_ns : 0);
+            }
+        }
+
+        /// Add another set of histograms (e.g. to aggregate links)
+        inline void merge(const LinkHistograms &other) {
+            latency_ns.merge(other.latency_ns);
+            model_delay_ns.merge(other.model_delay_ns);
+            lateness_ns.merge(other.lateness_ns);
+            ring_usage_pct.merge(other.ring_usage_pct);
+        }
+
+        /// Clear all histograms
+        inline void reset() {
+            latency_ns.reset();
+            model_delay_ns.reset();
+            lateness_ns.reset();
+            ring_usage_pct.reset();
+        }
+    };
+
+} // namespace wirebit
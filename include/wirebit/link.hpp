@@ -1,14 +1,22 @@
 #pragma once
 
 #include <wirebit/frame.hpp>
+#include <wirebit/frame_pool.hpp>
+#include <wirebit/histogram.hpp>
+#include <wirebit/stats_registry.hpp>
 
 namespace wirebit {
 
     /// Abstract interface for bidirectional communication links
     class Link {
       public:
+        Link() = default;
         virtual ~Link() = default;
 
+        // Movable, not copyable
+        Link(Link &&) = default;
+        Link &operator=(Link &&) = default;
+
         /// Send a frame through the link
         /// @param frame Frame to send
         /// @return Result indicating success or error
@@ -18,6 +26,70 @@ namespace wirebit {
         /// @return Result containing frame if available, or error
         virtual Result<Frame, Error> recv() = 0;
 
+        /// Send a borrowed frame through the link
+        /// The default copies into an owning Frame; backends override it to send straight from the spans.
+        /// @param view Frame view to send (payload_len/meta_len are taken from the spans)
+        /// @return Result indicating success or error
+        virtual Result<Unit, Error> send_view(const FrameView &view) { return send(to_frame(view)); }
+
+        /// Receive a frame without taking ownership (non-blocking)
+        /// The returned view stays valid until the next recv()/recv_view() call on this link.
+        /// The default keeps the last received Frame inside the link; backends override it to
+        /// return views into their own receive buffers.
+        /// @return Result containing frame view if available, or error
+        virtual Result<FrameView, Error> recv_view() {
+            auto result = recv();
+            if (!result.is_ok()) {
+                return Result<FrameView, Error>::err(result.error());
+            }
+            if (frame_pool_ != nullptr) {
+                frame_pool_->release(view_frame_);
+            }
+            view_frame_ = std::move(result.value());
+            return Result<FrameView, Error>::ok(make_view(view_frame_));
+        }
+
+        /// Send several frames in one call
+        /// Frames are sent in order; the batch stops at the first frame that cannot be sent.
+        /// The default sends them one by one; backends override it to amortize syscalls or index updates.
+        /// @param frames Frames to send
+        /// @return Result containing number of frames sent, or error if none could be sent
+        virtual Result<size_t, Error> send_batch(std::span<const Frame> frames) {
+            size_t sent = 0;
+            for (const Frame &frame : frames) {
+                auto result = send(frame);
+                if (!result.is_ok()) {
+                    if (sent == 0) {
+                        return Result<size_t, Error>::err(result.error());
+                    }
+                    break;
+                }
+                ++sent;
+            }
+            return Result<size_t, Error>::ok(sent);
+        }
+
+        /// Receive up to max_frames frames in one call (non-blocking)
+        /// The default drains recv() until it fails or the budget is reached.
+        /// @param frames Vector the received frames are appended to
+        /// @param max_frames Maximum number of frames to receive
+        /// @return Result containing number of frames received, or error if none were available
+        virtual Result<size_t, Error> recv_batch(Vector<Frame> &frames, size_t max_frames) {
+            size_t received = 0;
+            while (received < max_frames) {
+                auto result = recv();
+                if (!result.is_ok()) {
+                    if (received == 0) {
+                        return Result<size_t, Error>::err(result.error());
+                    }
+                    break;
+                }
+                frames.push_back(std::move(result.value()));
+                ++received;
+            }
+            return Result<size_t, Error>::ok(received);
+        }
+
         /// Check if link is ready for sending
         /// @return true if link can accept more frames
         virtual bool can_send() const = 0;
@@ -29,6 +101,88 @@ namespace wirebit {
         /// Get link name/identifier
         /// @return Link name
         virtual String name() const = 0;
+
+        /// Get a file descriptor that becomes readable when recv() may succeed
+        /// Used by LinkReactor to multiplex many links on one epoll set.
+        /// @return File descriptor, or -1 if the link has to be polled
+        virtual int poll_fd() const { return -1; }
+
+        /// Prepare to block on poll_fd()
+        /// Links whose fd is only signalled on request (e.g. ShmLink wakeups) arm the signal here.
+        /// @return false if input is already pending and the caller should not block
+        virtual bool prepare_wait() { return true; }
+
+        /// Undo prepare_wait() after waking up
+        virtual void finish_wait() {}
+
+        /// Get the time at which held input becomes receivable without any fd activity
+        /// @return Deadline in nanoseconds, or UINT64_MAX if nothing is held
+        virtual uint64_t next_deadline() const { return UINT64_MAX; }
+
+        /// Fill the payload/meta of frames returned by recv()/recv_batch() from a pool
+        /// The pool is used by the thread that calls recv(), so give a link the pool of the thread
+        /// that drives it (e.g. FramePool::local()), and set it once the link is in its final place
+        /// (it is not carried over when a link is moved). Callers return the buffers with
+        /// FramePool::release() or by wrapping the frames in PooledFrame.
+        /// @param pool Pool to use (must outlive the link), or nullptr for plain allocation
+        inline void set_frame_pool(FramePool *pool) { frame_pool_ = pool; }
+
+        /// Get the pool set with set_frame_pool()
+        /// @return Pool, or nullptr if frames are allocated normally
+        inline FramePool *frame_pool() const { return frame_pool_; }
+
+        /// Record latency histograms for frames received by this link
+        /// Every received frame carrying a tx_timestamp_ns is recorded into latency_ns (and, when a
+        /// link model set deliver_at_ns, into model_delay_ns/lateness_ns); ShmLink also records its
+        /// TX ring fill at each push into ring_usage_pct. Like the frame pool, set it once the link is
+        /// in its final place.
+        /// @param histograms Histograms to record into (must outlive the link), or nullptr to stop
+        virtual void set_histograms(LinkHistograms *histograms) { histograms_ = histograms; }
+
+        /// Get the histograms set with set_histograms()
+        /// @return Histograms, or nullptr if not recording
+        inline LinkHistograms *histograms() const { return histograms_; }
+
+        /// Publish this link's counters in a host-wide StatsRegistry
+        /// From then on the link updates its slot next to its own stats(): frames, bytes, errors,
+        /// drops and queue occupancy. Export once the link is in its final place (like the frame pool,
+        /// the slot is not reliably carried over when a link is moved); it is freed with the link.
+        /// @param registry Registry to publish in (must outlive the link)
+        /// @param kind Link type shown to monitors
+        /// @return Result indicating success or error (registry full)
+        inline Result<Unit, Error> export_stats(StatsRegistry &registry, const char *kind = "link") {
+            auto slot = registry.claim(name(), kind);
+            if (!slot.is_ok()) {
+                return Result<Unit, Error>::err(slot.error());
+            }
+            stats_export_ = std::move(slot.value());
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Stop publishing counters and free the registry slot
+        inline void stop_export_stats() { stats_export_.release(); }
+
+        /// Check whether counters are published
+        /// @return true after a successful export_stats()
+        inline bool stats_exported() const { return stats_export_.active(); }
+
+      protected:
+        Frame view_frame_;                     ///< Backing storage for the default recv_view()
+        FramePool *frame_pool_ = nullptr;      ///< Buffer source for received frames (optional)
+        StatsSlot stats_export_;               ///< Registry slot mirrored by the data path (inactive by default)
+        LinkHistograms *histograms_ = nullptr; ///< Latency histograms (optional)
+
+        /// Helper: Record a received frame into the histograms, if any
+        inline void record_rx(const FrameHeader &header) {
+            if (histograms_ != nullptr) {
+                histograms_->record_rx(header, now_ns());
+            }
+        }
+
+        /// Helper: Copy a received view into an owning frame, from the pool if one is set
+        inline Frame owned_frame(const FrameView &view) const {
+            return frame_pool_ != nullptr ? frame_pool_->to_frame(view) : to_frame(view);
+        }
     };
 
 } // namespace wirebit
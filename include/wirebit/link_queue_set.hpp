@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <functional>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <utility>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/link.hpp>
+
+namespace wirebit {
+
+    /// Statistics for LinkQueueSet
+    struct LinkQueueSetStats {
+        uint64_t workers_started = 0; ///< Worker threads started
+        uint64_t pinned = 0;          ///< Workers pinned to their CPU
+        uint64_t pin_failures = 0;    ///< Workers whose CPU affinity could not be set
+
+        inline void reset() {
+            workers_started = 0;
+            pinned = 0;
+            pin_failures = 0;
+        }
+    };
+
+    /// Set of links that are queues of one device, served by one worker thread each
+    ///
+    /// Multi-queue TAP/TUN devices (TapLink::create_queues(), TunLink::create_queues()) spread
+    /// received flows across their queue fds, so each queue can be drained on its own core without
+    /// any locking. Transmit traffic is sharded with queue_for(): frames of one flow must always
+    /// leave through the same queue to stay in order.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto queues = TapLink::create_queues({.interface_name = "tap0", .queues = 4}).value();
+    /// queues.start([](Link &link, size_t queue, const std::atomic<bool> &running) {
+    ///     while (running) { forward(link.recv()); }
+    /// });
+    /// ...
+    /// queues.stop();
+    /// @endcode
+    class LinkQueueSet {
+      public:
+        /// Worker body: serve one queue until `running` becomes false
+        using Worker = std::function<void(Link &link, size_t queue, const std::atomic<bool> &running)>;
+
+        LinkQueueSet() = default;
+
+        /// Destructor - stops the workers, then closes the queues
+        ~LinkQueueSet() { stop(); }
+
+        /// Move constructor (running workers move with the set; the source is left stopped and empty)
+        LinkQueueSet(LinkQueueSet &&other) noexcept
+            : queues_(std::move(other.queues_)), threads_(std::move(other.threads_)),
+              running_(std::exchange(other.running_, std::make_unique<std::atomic<bool>>(false))),
+              stats_(other.stats_) {}
+
+        /// Move assignment (stops this set's workers first; running workers of `other` move over)
+        LinkQueueSet &operator=(LinkQueueSet &&other) noexcept {
+            if (this != &other) {
+                stop();
+                queues_ = std::move(other.queues_);
+                threads_ = std::move(other.threads_);
+                running_ = std::exchange(other.running_, std::make_unique<std::atomic<bool>>(false));
+                stats_ = other.stats_;
+            }
+            return *this;
+        }
+
+        // Disable copy
+        LinkQueueSet(const LinkQueueSet &) = delete;
+        LinkQueueSet &operator=(const LinkQueueSet &) = delete;
+
+        /// Add a queue
+        /// @param link Queue link (owned by the set)
+        /// @param cpu CPU to pin the queue's worker to (-1 = no affinity)
+        /// @return Result indicating success, or invalid_argument while workers are running
+        Result<Unit, Error> add(std::unique_ptr<Link> link, int cpu = -1) {
+            if (running()) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Cannot add queues while running"));
+            }
+            if (!link) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Null queue link"));
+            }
+            queues_.push_back(Queue{std::move(link), cpu});
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Start one worker thread per queue, pinned to the queue's CPU if one was given
+        /// A failed pin is logged and counted; the worker still runs unpinned.
+        /// @param worker Worker body
+        /// @return Result indicating success, or invalid_argument if already running or empty
+        Result<Unit, Error> start(Worker worker) {
+            if (queues_.empty()) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Queue set is empty"));
+            }
+            if (running_->exchange(true)) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Queue set already running"));
+            }
+
+            // Workers hold the flag and links, not `this`, so a running set can be moved
+            auto shared = std::make_shared<Worker>(std::move(worker));
+            std::atomic<bool> *running = running_.get();
+            for (size_t i = 0; i < queues_.size(); ++i) {
+                Link *link = queues_[i].link.get();
+                threads_.push_back(std::thread([shared, link, i, running]() { (*shared)(*link, i, *running); }));
+                stats_.workers_started++;
+                if (queues_[i].cpu >= 0) {
+                    pin(threads_.back(), i, queues_[i].cpu);
+                }
+            }
+            WIREBIT_DEBUG("LinkQueueSet started ", queues_.size(), " workers").green();
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Signal the workers to stop and join them (no-op if not running)
+        void stop() {
+            if (!running_->exchange(false)) {
+                return;
+            }
+            for (auto &thread : threads_) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+            threads_.clear();
+            WIREBIT_DEBUG("LinkQueueSet stopped");
+        }
+
+        /// Pick the queue for a flow so all of its frames leave in order
+        /// @param flow_hash Hash of the flow (e.g. addresses and ports)
+        /// @return Queue link
+        inline Link &queue_for(uint64_t flow_hash) { return *queues_[flow_hash % queues_.size()].link; }
+
+        /// Get a queue by index
+        /// @param index Queue index (< size())
+        /// @return Queue link
+        inline Link &queue(size_t index) { return *queues_[index].link; }
+
+        /// Get the CPU a queue's worker is pinned to
+        /// @param index Queue index (< size())
+        /// @return CPU number, or -1 for no affinity
+        inline int cpu(size_t index) const { return queues_[index].cpu; }
+
+        /// Get number of queues
+        inline size_t size() const { return queues_.size(); }
+
+        /// Check if workers are running
+        inline bool running() const { return running_->load(std::memory_order_relaxed); }
+
+        /// Get statistics
+        inline const LinkQueueSetStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        /// One queue and its worker placement
+        struct Queue {
+            std::unique_ptr<Link> link; ///< Queue link
+            int cpu;                    ///< Worker CPU (-1 = no affinity)
+        };
+
+        Vector<Queue> queues_;
+        Vector<std::thread> threads_;
+        std::unique_ptr<std::atomic<bool>> running_ = std::make_unique<std::atomic<bool>>(false);
+        LinkQueueSetStats stats_;
+
+        /// Helper: Pin a worker thread to one CPU
+        inline void pin(std::thread &thread, size_t index, int cpu) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            int err = ::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+            if (err != 0) {
+                echo::warn("Failed to pin queue ", index, " to CPU ", cpu, ": ", strerror(err)).yellow();
+                stats_.pin_failures++;
+                return;
+            }
+            stats_.pinned++;
+        }
+    };
+
+} // namespace wirebit
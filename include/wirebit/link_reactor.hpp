@@ -0,0 +1,361 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <functional>
+#include <memory>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/endpoint.hpp>
+#include <wirebit/link.hpp>
+
+namespace wirebit {
+
+    /// LinkReactor configuration
+    struct LinkReactorConfig {
+        size_t max_events = 64;              ///< epoll events fetched per run_once()
+        size_t default_budget = 32;          ///< Handler calls per link per round (fairness)
+        uint64_t poll_interval_ns = 1000000; ///< Wait cap while links without a poll_fd() are registered
+    };
+
+    /// Statistics for LinkReactor
+    struct LinkReactorStats {
+        uint64_t rounds = 0;           ///< run_once() calls
+        uint64_t wakeups = 0;          ///< epoll events received
+        uint64_t dispatches = 0;       ///< Handler invocations
+        uint64_t budget_exhausted = 0; ///< Times a link used its whole budget and was carried over
+
+        inline void reset() {
+            rounds = 0;
+            wakeups = 0;
+            dispatches = 0;
+            budget_exhausted = 0;
+        }
+    };
+
+    /// Single-threaded event loop that multiplexes many links on one epoll set
+    ///
+    /// Links are registered by their Link::poll_fd() (socket_fd(), tap_fd(), tun_fd(), master_fd(), fd(),
+    /// or the ShmLink wakeup eventfd). Raw links are edge-triggered: on readiness the handler is called
+    /// until it reports no more input, but at most `budget` times per round so one busy link cannot
+    /// starve the others; a link that runs out of budget is carried over to the next round without
+    /// waiting. Links without a poll_fd() are polled every round, and held frames (Link::next_deadline())
+    /// wake the loop when they become due.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto reactor = LinkReactor::create().value();
+    /// reactor.add_endpoint(can_endpoint);
+    /// reactor.add(*tap_link, [&]() { return forward(tap_link->recv()); });
+    /// while (running) { reactor.run_once(ms_to_ns(100)); }
+    /// @endcode
+    class LinkReactor {
+      public:
+        /// Readiness handler: consume some input, return true if more may be pending
+        using Handler = std::function<bool()>;
+
+        /// Deadline of a handler: time at which it must run even without fd activity (UINT64_MAX = none)
+        using Deadline = std::function<uint64_t()>;
+
+        /// Create a reactor
+        /// @param config Reactor configuration
+        /// @return Result containing LinkReactor or error
+        static Result<LinkReactor, Error> create(const LinkReactorConfig &config = LinkReactorConfig{}) {
+            int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd < 0) {
+                echo::error("Failed to create epoll instance: ", strerror(errno)).red();
+                return Result<LinkReactor, Error>::err(Error::io_error("epoll_create1() failed"));
+            }
+            WIREBIT_DEBUG("LinkReactor created (epoll fd: ", epoll_fd, ")").green();
+            return Result<LinkReactor, Error>::ok(LinkReactor(epoll_fd, config));
+        }
+
+        /// Destructor - closes the epoll instance (registered links are not owned)
+        ~LinkReactor() {
+            if (epoll_fd_ >= 0) {
+                ::close(epoll_fd_);
+            }
+        }
+
+        /// Move constructor
+        LinkReactor(LinkReactor &&other) noexcept
+            : epoll_fd_(other.epoll_fd_), config_(other.config_), entries_(std::move(other.entries_)),
+              events_(std::move(other.events_)), stats_(other.stats_) {
+            other.epoll_fd_ = -1;
+        }
+
+        /// Move assignment
+        LinkReactor &operator=(LinkReactor &&other) noexcept {
+            if (this != &other) {
+                if (epoll_fd_ >= 0) {
+                    ::close(epoll_fd_);
+                }
+                epoll_fd_ = other.epoll_fd_;
+                config_ = other.config_;
+                entries_ = std::move(other.entries_);
+                events_ = std::move(other.events_);
+                stats_ = other.stats_;
+                other.epoll_fd_ = -1;
+            }
+            return *this;
+        }
+
+        // Disable copy
+        LinkReactor(const LinkReactor &) = delete;
+        LinkReactor &operator=(const LinkReactor &) = delete;
+
+        /// Register a link with a readiness handler (edge-triggered)
+        /// The handler is called until it returns false; it should drain the link, e.g. with one
+        /// recv()/recv_batch() per call, returning false once recv reports no data.
+        /// @param link Link to watch (must outlive its registration)
+        /// @param handler Readiness handler
+        /// @param budget Maximum handler calls per round (0 = config default)
+        /// @param deadline Optional extra deadline, e.g. input the handler holds back (Bridge)
+        /// @return Result indicating success or error
+        Result<Unit, Error> add(Link &link, Handler handler, size_t budget = 0, Deadline deadline = {}) {
+            auto result = add_entry(link, std::move(handler), budget, true);
+            if (result.is_ok()) {
+                entries_.back()->deadline = std::move(deadline);
+            }
+            return result;
+        }
+
+        /// Register an endpoint; its process() is called when its link becomes readable
+        /// Endpoints drain their link up to their own buffer limits, so the link is watched
+        /// level-triggered and process() runs once per round while input remains. Frames the
+        /// endpoint holds (Endpoint::next_deadline()) wake the loop like held link frames.
+        /// @param endpoint Endpoint to drive (must outlive its registration)
+        /// @return Result indicating success or error
+        Result<Unit, Error> add_endpoint(Endpoint &endpoint) {
+            Link *link = endpoint.link();
+            if (link == nullptr) {
+                return Result<Unit, Error>::err(Error::invalid_argument("Endpoint has no link"));
+            }
+            Endpoint *ep = &endpoint;
+            auto result = add_entry(
+                *link,
+                [ep]() {
+                    ep->process();
+                    return false;
+                },
+                1, false);
+            if (result.is_ok()) {
+                entries_.back()->endpoint = ep;
+            }
+            return result;
+        }
+
+        /// Unregister a link (safe to call from inside a handler)
+        /// @param link Previously registered link
+        /// @return Result indicating success, or not_found
+        Result<Unit, Error> remove(Link &link) {
+            for (auto &entry : entries_) {
+                if (entry->link == &link && !entry->removed) {
+                    if (entry->fd >= 0) {
+                        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, entry->fd, nullptr);
+                    }
+                    entry->removed = true;
+                    WIREBIT_TRACE("LinkReactor: removed ", link.name());
+                    return Result<Unit, Error>::ok(Unit{});
+                }
+            }
+            return Result<Unit, Error>::err(Error::not_found("Link not registered"));
+        }
+
+        /// Wait for readiness and dispatch handlers once
+        /// Does not block if a link was carried over from the previous round.
+        /// @param timeout_ns Maximum time to wait for readiness in nanoseconds
+        /// @return Result containing number of handler calls, or error if epoll failed
+        Result<size_t, Error> run_once(uint64_t timeout_ns) {
+            stats_.rounds++;
+            uint64_t now = now_ns();
+
+            // Arm links and find out how long we may sleep
+            bool pending = false;
+            bool polled = false;
+            uint64_t wake_at = now + timeout_ns;
+            for (auto &entry : entries_) {
+                if (entry->removed) {
+                    continue;
+                }
+                if (entry->fd < 0) {
+                    polled = true;
+                } else if (!entry->ready && !entry->link->prepare_wait()) {
+                    entry->ready = true;
+                }
+                entry->armed = entry->fd >= 0;
+                pending = pending || entry->ready;
+                wake_at = std::min(wake_at, entry->next_deadline());
+            }
+            if (polled) {
+                wake_at = std::min(wake_at, now + config_.poll_interval_ns);
+            }
+
+            int wait_ms = 0;
+            if (!pending && wake_at > now) {
+                wait_ms = static_cast<int>(std::min<uint64_t>((wake_at - now + 999999) / 1000000, INT32_MAX));
+            }
+
+            int n = ::epoll_wait(epoll_fd_, events_.data(), static_cast<int>(events_.size()), wait_ms);
+            if (n < 0 && errno != EINTR) {
+                echo::error("epoll_wait() failed: ", strerror(errno)).red();
+                disarm();
+                return Result<size_t, Error>::err(Error::io_error("epoll_wait() failed"));
+            }
+            for (int i = 0; i < n; ++i) {
+                static_cast<Entry *>(events_[i].data.ptr)->ready = true;
+            }
+            stats_.wakeups += n > 0 ? static_cast<uint64_t>(n) : 0;
+            disarm();
+
+            // Dispatch in registration order, each link limited to its budget
+            now = now_ns();
+            size_t dispatched = 0;
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                Entry *entry = entries_[i].get();
+                if (entry->removed) {
+                    continue;
+                }
+                if (entry->fd < 0 || entry->next_deadline() <= now) {
+                    entry->ready = true;
+                }
+                if (!entry->ready) {
+                    continue;
+                }
+
+                bool more = true;
+                size_t calls = 0;
+                while (more && calls < entry->budget && !entry->removed) {
+                    more = entry->handler();
+                    ++calls;
+                }
+                dispatched += calls;
+
+                // Edge-triggered links that still have input get no new edge: carry them over
+                entry->ready = more && entry->edge && !entry->removed;
+                if (entry->ready) {
+                    stats_.budget_exhausted++;
+                }
+            }
+            stats_.dispatches += dispatched;
+
+            // Drop entries removed during this round
+            entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                          [](const std::unique_ptr<Entry> &entry) { return entry->removed; }),
+                           entries_.end());
+
+            return Result<size_t, Error>::ok(dispatched);
+        }
+
+        /// Run until the flag is cleared
+        /// @param running Loop condition (checked every round)
+        /// @param round_timeout_ns Maximum wait per round, bounds how quickly a cleared flag is noticed
+        /// @return Result indicating clean exit, or error if epoll failed
+        Result<Unit, Error> run(const std::atomic<bool> &running, uint64_t round_timeout_ns = 100000000) {
+            WIREBIT_DEBUG("LinkReactor running with ", size(), " links");
+            while (running.load(std::memory_order_relaxed)) {
+                auto result = run_once(round_timeout_ns);
+                if (!result.is_ok()) {
+                    return Result<Unit, Error>::err(result.error());
+                }
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Get number of registered links
+        inline size_t size() const {
+            return static_cast<size_t>(std::count_if(entries_.begin(), entries_.end(),
+                                                     [](const std::unique_ptr<Entry> &e) { return !e->removed; }));
+        }
+
+        /// Get reactor statistics
+        inline const LinkReactorStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        /// Registered link
+        struct Entry {
+            Link *link = nullptr;         ///< Watched link (not owned)
+            Endpoint *endpoint = nullptr; ///< Endpoint driven by the handler (add_endpoint()), if any
+            Handler handler;              ///< Readiness handler
+            Deadline deadline;            ///< Extra deadline of the handler (add()), if any
+            int fd = -1;                  ///< Registered poll_fd() (-1 = polled every round)
+            size_t budget = 1;            ///< Handler calls per round
+            bool edge = true;             ///< Edge-triggered (carry over when budget runs out)
+            bool ready = false;           ///< Input pending for the next dispatch
+            bool armed = false;           ///< prepare_wait() called this round
+            bool removed = false;         ///< Unregistered, freed at the end of the round
+
+            /// Earliest time held input (in the link, the endpoint or the handler) becomes due
+            inline uint64_t next_deadline() const {
+                uint64_t due = link->next_deadline();
+                if (endpoint != nullptr) {
+                    due = std::min(due, endpoint->next_deadline());
+                }
+                return deadline ? std::min(due, deadline()) : due;
+            }
+        };
+
+        int epoll_fd_ = -1;
+        LinkReactorConfig config_;
+        Vector<std::unique_ptr<Entry>> entries_;
+        Vector<struct epoll_event> events_;
+        LinkReactorStats stats_;
+
+        LinkReactor(int epoll_fd, const LinkReactorConfig &config)
+            : epoll_fd_(epoll_fd), config_(config), events_(std::max<size_t>(config.max_events, 1)) {}
+
+        /// Helper: Register a link entry with epoll
+        Result<Unit, Error> add_entry(Link &link, Handler handler, size_t budget, bool edge) {
+            for (auto &entry : entries_) {
+                if (entry->link == &link && !entry->removed) {
+                    return Result<Unit, Error>::err(Error::invalid_argument("Link already registered"));
+                }
+            }
+
+            auto entry = std::make_unique<Entry>();
+            entry->link = &link;
+            entry->handler = std::move(handler);
+            entry->fd = link.poll_fd();
+            entry->budget = budget != 0 ? budget : std::max<size_t>(config_.default_budget, 1);
+            entry->edge = edge;
+            entry->ready = true; // Drain anything that arrived before registration
+
+            if (entry->fd >= 0) {
+                struct epoll_event ev = {};
+                ev.events = EPOLLIN;
+                if (edge) {
+                    ev.events |= EPOLLET;
+                }
+                ev.data.ptr = entry.get();
+                if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, entry->fd, &ev) < 0) {
+                    echo::error("Failed to register ", link.name(), " with epoll: ", strerror(errno)).red();
+                    return Result<Unit, Error>::err(Error::io_error("epoll_ctl() failed"));
+                }
+            }
+
+            WIREBIT_TRACE("LinkReactor: added ", link.name(), " (fd: ", entry->fd, ", budget: ", entry->budget, ")");
+            entries_.push_back(std::move(entry));
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Undo prepare_wait() on every armed link
+        inline void disarm() {
+            for (auto &entry : entries_) {
+                if (entry->armed && !entry->removed) {
+                    entry->link->finish_wait();
+                }
+                entry->armed = false;
+            }
+        }
+    };
+
+} // namespace wirebit
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <cmath>
 #include <echo/echo.hpp>
+#include <span>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
 
@@ -17,7 +19,7 @@ namespace wirebit {
         /// Construct with seed
         inline explicit DeterministicRNG(uint64_t seed = 0) : state_(seed) {
             if (seed != 0) {
-                echo::trace("DeterministicRNG initialized with seed: ", seed);
+                WIREBIT_TRACE("DeterministicRNG initialized with seed: ", seed);
             }
         }
 
@@ -37,25 +39,51 @@ namespace wirebit {
             return next() % max;
         }
 
+        /// Get random uint64_t in range [0, max) without a division
+        /// Multiply-shift with rejection (Lemire): unbiased, and built from the high bits of the
+        /// LCG output, which are far better distributed than the low bits range() keeps.
+        inline uint64_t bounded(uint64_t max) {
+            if (max == 0)
+                return 0;
+            detail::uint128 product = static_cast<detail::uint128>(next()) * max;
+            uint64_t low = static_cast<uint64_t>(product);
+            if (low < max) {
+                uint64_t threshold = (0 - max) % max; // 2^64 mod max, only needed in rare cases
+                while (low < threshold) {
+                    product = static_cast<detail::uint128>(next()) * max;
+                    low = static_cast<uint64_t>(product);
+                }
+            }
+            return static_cast<uint64_t>(product >> 64);
+        }
+
         /// Reset to specific seed
         inline void seed(uint64_t new_seed) {
             state_ = new_seed;
-            echo::trace("DeterministicRNG reseeded: ", new_seed);
+            WIREBIT_TRACE("DeterministicRNG reseeded: ", new_seed);
         }
 
         /// Get current state
         inline uint64_t state() const { return state_; }
     };
 
+    /// How a LinkModel turns its seed into impairments
+    /// Both modes follow the same probabilities; a given seed produces different draws in each.
+    enum class ModelSampling : uint8_t {
+        PerFrame = 0,  ///< One roll per fault type and frame, jitter by modulo (the original sequence)
+        EventSkip = 1, ///< Geometric gaps between faults, division-free jitter (no draws on clean frames)
+    };
+
     /// Link model parameters for simulating realistic communication behavior
     struct LinkModel {
-        uint64_t base_latency_ns = 0; ///< Base latency in nanoseconds
-        uint64_t jitter_ns = 0;       ///< Jitter range in nanoseconds (uniform random)
-        double drop_prob = 0.0;       ///< Frame drop probability [0.0, 1.0]
-        double dup_prob = 0.0;        ///< Frame duplication probability [0.0, 1.0]
-        double corrupt_prob = 0.0;    ///< Frame corruption probability [0.0, 1.0]
-        uint64_t bandwidth_bps = 0;   ///< Bandwidth in bits per second (0 = unlimited)
-        uint64_t seed = 0;            ///< PRNG seed for deterministic simulation
+        uint64_t base_latency_ns = 0;                     ///< Base latency in nanoseconds
+        uint64_t jitter_ns = 0;                           ///< Jitter range in nanoseconds (uniform random)
+        double drop_prob = 0.0;                           ///< Frame drop probability [0.0, 1.0]
+        double dup_prob = 0.0;                            ///< Frame duplication probability [0.0, 1.0]
+        double corrupt_prob = 0.0;                        ///< Frame corruption probability [0.0, 1.0]
+        uint64_t bandwidth_bps = 0;                       ///< Bandwidth in bits per second (0 = unlimited)
+        uint64_t seed = 0;                                ///< PRNG seed for deterministic simulation
+        ModelSampling sampling = ModelSampling::PerFrame; ///< Draw scheme (PerFrame keeps existing seeds' results)
 
         LinkModel() = default;
 
@@ -63,8 +91,8 @@ namespace wirebit {
                   uint64_t bandwidth = 0, uint64_t prng_seed = 0)
             : base_latency_ns(latency), jitter_ns(jitter), drop_prob(drop), dup_prob(dup), corrupt_prob(corrupt),
               bandwidth_bps(bandwidth), seed(prng_seed) {
-            echo::trace("LinkModel created: latency=", latency, "ns jitter=", jitter, "ns drop=", drop, " dup=", dup,
-                        " corrupt=", corrupt, " bw=", bandwidth, "bps");
+            WIREBIT_TRACE("LinkModel created: latency=", latency, "ns jitter=", jitter, "ns drop=", drop, " dup=", dup,
+                          " corrupt=", corrupt, " bw=", bandwidth, "bps");
         }
 
         /// Check if model is deterministic (no randomness)
@@ -102,14 +130,15 @@ namespace wirebit {
     /// @return Delivery timestamp in nanoseconds
     inline uint64_t compute_deliver_at_ns(const LinkModel &model, uint64_t now_ns, uint32_t payload_len,
                                           uint64_t &next_send_time_ns, DeterministicRNG &rng) {
-        echo::trace("Computing delivery time: now=", now_ns, " payload=", payload_len, "B");
+        WIREBIT_TRACE("Computing delivery time: now=", now_ns, " payload=", payload_len, "B");
 
         // Compute latency with jitter
         uint64_t latency = model.base_latency_ns;
         if (model.jitter_ns > 0) {
-            uint64_t jitter = rng.range(model.jitter_ns);
+            uint64_t jitter =
+                model.sampling == ModelSampling::EventSkip ? rng.bounded(model.jitter_ns) : rng.range(model.jitter_ns);
             latency += jitter;
-            echo::trace("Added jitter: ", jitter, "ns (total latency: ", latency, "ns)");
+            WIREBIT_TRACE("Added jitter: ", jitter, "ns (total latency: ", latency, "ns)");
         }
 
         // Compute transmission time based on bandwidth
@@ -117,7 +146,7 @@ namespace wirebit {
         if (model.bandwidth_bps > 0) {
             // transmit_time = (payload_len * 8 bits/byte) / (bandwidth bits/sec) * 1e9 ns/sec
             transmit_time_ns = (static_cast<uint64_t>(payload_len) * 8ULL * 1000000000ULL) / model.bandwidth_bps;
-            echo::trace("Transmission time: ", transmit_time_ns, "ns (bandwidth: ", model.bandwidth_bps, "bps)");
+            WIREBIT_TRACE("Transmission time: ", transmit_time_ns, "ns (bandwidth: ", model.bandwidth_bps, "bps)");
         }
 
         // Enforce bandwidth limit: can't send before previous transmission finishes
@@ -125,7 +154,7 @@ namespace wirebit {
         next_send_time_ns = send_time + transmit_time_ns;
 
         uint64_t deliver_at = send_time + latency;
-        echo::debug("Delivery scheduled at: ", deliver_at, "ns (send: ", send_time, "ns + latency: ", latency, "ns)");
+        WIREBIT_DEBUG("Delivery scheduled at: ", deliver_at, "ns (send: ", send_time, "ns + latency: ", latency, "ns)");
 
         return deliver_at;
     }
@@ -166,26 +195,151 @@ namespace wirebit {
         return FrameAction::DELIVER;
     }
 
+    /// Draws the FrameAction of each frame in a stream, as determine_frame_action() does
+    ///
+    /// With ModelSampling::EventSkip, the number of clean frames before the next drop, duplicate and
+    /// corruption is drawn once per event from a geometric distribution. Frames in between only
+    /// decrement the counters, so a link with rare faults spends no RNG draws on most frames. The
+    /// duplicate counter only advances on frames that were not dropped, and the corrupt counter on
+    /// frames that were neither dropped nor duplicated, which gives the same distribution as
+    /// rolling the three checks in order for every frame.
+    /// With ModelSampling::PerFrame every frame calls determine_frame_action(), so existing seeds
+    /// reproduce their earlier results.
+    class FrameActionSampler {
+      public:
+        FrameActionSampler() = default;
+
+        /// Start sampling for a model (call after seeding the RNG)
+        /// @param model Link model parameters
+        /// @param rng Deterministic RNG (EventSkip draws the first gaps from it)
+        inline void reset(const LinkModel &model, DeterministicRNG &rng) {
+            model_ = model;
+            double probs[FAULTS] = {model.drop_prob, model.dup_prob, model.corrupt_prob};
+            for (size_t i = 0; i < FAULTS; ++i) {
+                double p = std::clamp(probs[i], 0.0, 1.0);
+                log_keep_[i] = p >= 1.0 ? -INFINITY : std::log1p(-p);
+                until_[i] = model.sampling == ModelSampling::EventSkip ? draw_gap(log_keep_[i], rng) : NEVER;
+            }
+        }
+
+        /// Draw the action of the next frame
+        /// @param rng Deterministic RNG (the one passed to reset())
+        /// @return Frame action to take
+        inline FrameAction next(DeterministicRNG &rng) {
+            if (model_.sampling != ModelSampling::EventSkip) {
+                return determine_frame_action(model_, rng);
+            }
+            if (until_[DROP]-- == 0) {
+                until_[DROP] = draw_gap(log_keep_[DROP], rng);
+                echo::warn("Frame DROPPED by LinkModel (drop_prob=", model_.drop_prob, ")").yellow();
+                return FrameAction::DROP;
+            }
+            if (until_[DUPLICATE]-- == 0) {
+                until_[DUPLICATE] = draw_gap(log_keep_[DUPLICATE], rng);
+                echo::warn("Frame DUPLICATED by LinkModel (dup_prob=", model_.dup_prob, ")").yellow();
+                return FrameAction::DUPLICATE;
+            }
+            if (until_[CORRUPT]-- == 0) {
+                until_[CORRUPT] = draw_gap(log_keep_[CORRUPT], rng);
+                echo::warn("Frame CORRUPTED by LinkModel (corrupt_prob=", model_.corrupt_prob, ")").yellow();
+                return FrameAction::CORRUPT;
+            }
+            return FrameAction::DELIVER;
+        }
+
+        /// Draw the actions of the next actions.size() frames
+        /// Produces the same actions as calling next() for each frame; with EventSkip, runs of clean
+        /// frames are filled in one step.
+        /// @param rng Deterministic RNG (the one passed to reset())
+        /// @param actions Output, one action per frame
+        /// @return Number of frames that are not FrameAction::DELIVER
+        inline size_t next_batch(DeterministicRNG &rng, std::span<FrameAction> actions) {
+            size_t events = 0;
+            size_t i = 0;
+            while (i < actions.size()) {
+                if (model_.sampling == ModelSampling::EventSkip) {
+                    uint64_t clean = std::min<uint64_t>(frames_until_event(), actions.size() - i);
+                    std::fill_n(actions.begin() + i, clean, FrameAction::DELIVER);
+                    for (uint64_t &until : until_) {
+                        until -= clean;
+                    }
+                    i += clean;
+                    if (i == actions.size()) {
+                        break;
+                    }
+                }
+                actions[i] = next(rng);
+                events += actions[i] != FrameAction::DELIVER ? 1 : 0;
+                ++i;
+            }
+            return events;
+        }
+
+        /// Get the number of frames that will be delivered before the next fault (EventSkip only)
+        /// @return Clean frames ahead (UINT64_MAX for a model without faults or in PerFrame mode)
+        inline uint64_t frames_until_event() const {
+            return std::min({until_[DROP], until_[DUPLICATE], until_[CORRUPT]});
+        }
+
+        /// Get the model being sampled
+        inline const LinkModel &model() const { return model_; }
+
+      private:
+        static constexpr size_t DROP = 0;
+        static constexpr size_t DUPLICATE = 1;
+        static constexpr size_t CORRUPT = 2;
+        static constexpr size_t FAULTS = 3;
+        static constexpr uint64_t NEVER = UINT64_MAX;
+
+        LinkModel model_;
+        double log_keep_[FAULTS] = {0.0, 0.0, 0.0};      ///< ln(1 - p) per fault type
+        uint64_t until_[FAULTS] = {NEVER, NEVER, NEVER}; ///< Clean trials before the next fault
+
+        /// Helper: Draw the number of clean trials before the next fault: floor(ln(U) / ln(1 - p))
+        static inline uint64_t draw_gap(double log_keep, DeterministicRNG &rng) {
+            if (log_keep == 0.0) {
+                return NEVER; // p == 0 (no draw, so disabled faults do not shift the sequence)
+            }
+            if (std::isinf(log_keep)) {
+                return 0; // p == 1
+            }
+            double gap = std::floor(std::log(1.0 - rng.uniform()) / log_keep); // 1 - U is in (0, 1]
+            return gap >= 1.8e19 ? NEVER : static_cast<uint64_t>(gap);
+        }
+    };
+
     /// Corrupt frame payload by flipping random bits
     /// @param payload Frame payload to corrupt
     /// @param rng Deterministic RNG
-    inline void corrupt_payload(Bytes &payload, DeterministicRNG &rng) {
+    /// @param sampling Draw scheme of the model (EventSkip draws each flipped bit at once)
+    inline void corrupt_payload(Bytes &payload, DeterministicRNG &rng,
+                                ModelSampling sampling = ModelSampling::PerFrame) {
         if (payload.empty()) {
-            echo::trace("Cannot corrupt empty payload");
+            WIREBIT_TRACE("Cannot corrupt empty payload");
+            return;
+        }
+
+        if (sampling == ModelSampling::EventSkip) {
+            uint64_t num_flips = 1 + rng.bounded(3);
+            for (uint64_t i = 0; i < num_flips; ++i) {
+                uint64_t bit = rng.bounded(payload.size() * 8);
+                payload[bit / 8] ^= static_cast<Byte>(1u << (bit % 8));
+            }
+            WIREBIT_TRACE("Corrupted payload: flipped ", num_flips, " bits");
             return;
         }
 
         // Flip 1-3 random bits
         uint64_t num_flips = 1 + rng.range(3);
-        echo::trace("Corrupting payload: flipping ", num_flips, " bits");
+        WIREBIT_TRACE("Corrupting payload: flipping ", num_flips, " bits");
 
         for (uint64_t i = 0; i < num_flips; ++i) {
             size_t byte_idx = rng.range(payload.size());
             uint8_t bit_idx = rng.range(8);
             uint8_t old_val = payload[byte_idx];
             payload[byte_idx] ^= (1 << bit_idx);
-            echo::trace("Flipped bit ", static_cast<int>(bit_idx), " in byte ", byte_idx, ": 0x", std::hex,
-                        static_cast<int>(old_val), " -> 0x", static_cast<int>(payload[byte_idx]));
+            WIREBIT_TRACE("Flipped bit ", static_cast<int>(bit_idx), " in byte ", byte_idx, ": 0x", std::hex,
+                          static_cast<int>(old_val), " -> 0x", static_cast<int>(payload[byte_idx]));
         }
     }
 
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <echo/echo.hpp>
+#include <memory>
+#include <thread>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/link.hpp>
+
+namespace wirebit {
+
+    /// Who moves frames from the MpscSendLink queue into the inner link
+    enum class MpscDrain : uint8_t {
+        Combining, ///< The producer that finds no drain in progress sends everything queued
+        Flusher,   ///< A background thread drains the queue (producers help only when it is full)
+        Manual,    ///< The owner calls flush(), e.g. from the thread that also receives
+    };
+
+    /// Configuration for MpscSendLink
+    struct MpscSendConfig {
+        size_t queue_frames = 1024;             ///< Queue slots (rounded up to a power of two)
+        size_t batch = 64;                      ///< Most frames handed to the inner send_batch() at once
+        MpscDrain drain = MpscDrain::Combining; ///< Draining strategy
+        uint64_t idle_sleep_ns = 20000;         ///< Flusher back-off while the queue is empty
+    };
+
+    /// Statistics for MpscSendLink
+    struct MpscSendStats {
+        uint64_t frames_sent = 0;  ///< Frames accepted by the inner link
+        uint64_t drains = 0;       ///< Drain passes that sent at least one frame
+        uint64_t handoffs = 0;     ///< Producers that left their frame to a drain already running
+        uint64_t cas_retries = 0;  ///< Slot claims lost to another producer
+        uint64_t queue_full = 0;   ///< send() calls rejected because the queue stayed full
+        uint64_t backpressure = 0; ///< Drains stopped early because the inner link refused a frame
+
+        inline void reset() {
+            frames_sent = 0;
+            drains = 0;
+            handoffs = 0;
+            cas_retries = 0;
+            queue_full = 0;
+            backpressure = 0;
+        }
+    };
+
+    namespace detail {
+        /// Bounded MPSC frame queue with a single drainer at a time (see MpscSendLink)
+        ///
+        /// Slot i is free for the producer claiming position p when seq[i] == p, and holds a frame
+        /// ready for the drainer when seq[i] == p + 1 (D. Vyukov's bounded queue, with the consumer
+        /// side serialized by the `draining` flag). Frames live in their own array so that a run of
+        /// ready slots is one std::span<const Frame> for the inner send_batch().
+        struct MpscQueue {
+            MpscSendConfig config;
+            size_t capacity = 1;
+            size_t mask = 0;
+            Vector<Frame> frames;                                  ///< Slot frames (buffers keep their capacity)
+            std::unique_ptr<std::atomic<uint64_t>[]> seq;          ///< Slot sequence numbers
+            alignas(64) std::atomic<uint64_t> enqueue_pos{0};      ///< Next position to claim (producers)
+            alignas(64) std::atomic<bool> draining{false};         ///< Held by the thread sending
+            std::atomic<uint64_t> head{0};                         ///< Next position to send
+            std::atomic<uint64_t> frames_sent{0};                  ///< Counters (see MpscSendStats)
+            std::atomic<uint64_t> drains{0};
+            std::atomic<uint64_t> backpressure{0};
+            alignas(64) std::atomic<uint64_t> handoffs{0};
+            std::atomic<uint64_t> cas_retries{0};
+            std::atomic<uint64_t> queue_full{0};
+            std::atomic<bool> running{true};                       ///< Cleared to stop the flusher
+            std::thread flusher;
+
+            explicit MpscQueue(const MpscSendConfig &cfg) : config(cfg) {
+                while (capacity < cfg.queue_frames) {
+                    capacity <<= 1;
+                }
+                mask = capacity - 1;
+                frames.resize(capacity);
+                seq.reset(new std::atomic<uint64_t>[capacity]);
+                for (size_t i = 0; i < capacity; ++i) {
+                    seq[i].store(i, std::memory_order_relaxed);
+                }
+            }
+
+            /// Claim a slot and copy a frame into it (any thread)
+            /// @return false if the queue is full
+            inline bool push(const FrameView &view) {
+                uint64_t pos = enqueue_pos.load(std::memory_order_relaxed);
+                while (true) {
+                    std::atomic<uint64_t> &slot = seq[pos & mask];
+                    uint64_t s = slot.load(std::memory_order_acquire);
+                    if (s == pos) {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            Frame &frame = frames[pos & mask];
+                            frame.header = view.header;
+                            frame.payload.assign(view.payload.begin(), view.payload.end());
+                            frame.meta.assign(view.meta.begin(), view.meta.end());
+                            frame.header.payload_len = static_cast<uint32_t>(frame.payload.size());
+                            frame.header.meta_len = static_cast<uint32_t>(frame.meta.size());
+                            // seq_cst: ordered before this producer's attempt on `draining` (see combine())
+                            slot.store(pos + 1, std::memory_order_seq_cst);
+                            return true;
+                        }
+                        cas_retries.fetch_add(1, std::memory_order_relaxed);
+                    } else if (s < pos) {
+                        return false; // Slot still holds the frame from one lap ago
+                    } else {
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /// Check whether a producer would find a free slot right now
+            inline bool has_room() const {
+                uint64_t pos = enqueue_pos.load(std::memory_order_relaxed);
+                return seq[pos & mask].load(std::memory_order_acquire) == pos;
+            }
+
+            /// Get the number of claimed slots not yet sent (approximate while producers run)
+            inline size_t pending() const {
+                uint64_t sent = head.load(std::memory_order_acquire);
+                uint64_t claimed = enqueue_pos.load(std::memory_order_acquire);
+                return claimed > sent ? static_cast<size_t>(claimed - sent) : 0;
+            }
+
+            /// Check whether the head slot holds a frame
+            inline bool ready() const {
+                uint64_t pos = head.load(std::memory_order_seq_cst);
+                return seq[pos & mask].load(std::memory_order_seq_cst) == pos + 1;
+            }
+
+            /// Drain as a producer, or leave the frame to the thread already draining
+            /// A producer whose attempt fails published its slot before it, and the drainer checks
+            /// ready() after letting go, so every frame is either sent by that drainer or picked up
+            /// by a producer winning the flag later.
+            inline void combine(Link &inner) {
+                while (true) {
+                    if (draining.exchange(true, std::memory_order_seq_cst)) {
+                        handoffs.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    bool accepted = send_ready(inner);
+                    draining.store(false, std::memory_order_seq_cst);
+                    if (!accepted || !ready()) {
+                        return;
+                    }
+                }
+            }
+
+            /// Send everything queued, unless another thread is already draining
+            /// @return Number of frames sent
+            inline size_t drain(Link &inner) {
+                if (draining.exchange(true, std::memory_order_seq_cst)) {
+                    return 0;
+                }
+                uint64_t before = head.load(std::memory_order_relaxed);
+                send_ready(inner);
+                uint64_t after = head.load(std::memory_order_relaxed);
+                draining.store(false, std::memory_order_seq_cst);
+                return static_cast<size_t>(after - before);
+            }
+
+            /// Send ready runs of slots in order (caller holds `draining`)
+            /// @return false if the inner link refused a frame
+            inline bool send_ready(Link &inner) {
+                uint64_t pos = head.load(std::memory_order_relaxed);
+                uint64_t first = pos;
+                bool accepted = true;
+                while (true) {
+                    size_t start = static_cast<size_t>(pos & mask);
+                    size_t limit = std::min(config.batch, capacity - start); // Spans do not wrap
+                    size_t run = 0;
+                    while (run < limit && seq[start + run].load(std::memory_order_acquire) == pos + run + 1) {
+                        ++run;
+                    }
+                    if (run == 0) {
+                        break;
+                    }
+                    auto result = inner.send_batch(std::span<const Frame>(frames.data() + start, run));
+                    size_t sent = result.is_ok() ? result.value() : 0;
+                    for (size_t i = 0; i < sent; ++i) {
+                        seq[start + i].store(pos + i + capacity, std::memory_order_release);
+                    }
+                    pos += sent;
+                    if (sent < run) {
+                        backpressure.fetch_add(1, std::memory_order_relaxed);
+                        accepted = false;
+                        break;
+                    }
+                }
+                if (pos != first) {
+                    head.store(pos, std::memory_order_seq_cst);
+                    frames_sent.fetch_add(pos - first, std::memory_order_relaxed);
+                    drains.fetch_add(1, std::memory_order_relaxed);
+                }
+                return accepted;
+            }
+
+            inline MpscSendStats snapshot() const {
+                MpscSendStats stats;
+                stats.frames_sent = frames_sent.load(std::memory_order_relaxed);
+                stats.drains = drains.load(std::memory_order_relaxed);
+                stats.handoffs = handoffs.load(std::memory_order_relaxed);
+                stats.cas_retries = cas_retries.load(std::memory_order_relaxed);
+                stats.queue_full = queue_full.load(std::memory_order_relaxed);
+                stats.backpressure = backpressure.load(std::memory_order_relaxed);
+                return stats;
+            }
+
+            inline void reset_counters() {
+                for (auto *counter : {&frames_sent, &drains, &handoffs, &cas_retries, &queue_full, &backpressure}) {
+                    counter->store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+    } // namespace detail
+
+    /// Multi-producer send stage in front of a single-producer link
+    ///
+    /// ShmLink's TX ring, the fd-backed links and their stats expect one sending thread. Instead of
+    /// a mutex around the link, any number of threads call send()/send_view() here: the frame is
+    /// copied into a slot of a bounded lock-free MPSC queue (per-slot sequence numbers; a slot's
+    /// payload buffer keeps its capacity, so steady traffic does not allocate) and one thread at a
+    /// time moves contiguous runs of slots into the inner link with send_batch().
+    ///
+    /// With MpscDrain::Combining (default) that thread is whichever producer finds no drain in
+    /// progress; the others return as soon as their frame is queued, and the drainer re-checks the
+    /// queue after letting go so no frame is left behind. MpscDrain::Flusher drains on a background
+    /// thread, MpscDrain::Manual leaves it to flush().
+    ///
+    /// Frames leave in queue order, so the frames of each producer keep their order. A frame the
+    /// inner link refuses (e.g. its ring is full) stays at the head and is retried by the next
+    /// drain; send() reports timeout only when the queue itself is full. Inner send errors are
+    /// therefore not returned to the producer: watch the inner link's stats and backpressure here.
+    /// recv() and the other calls go straight to the inner link (still one receiving thread).
+    ///
+    /// Example usage (eight publisher threads, one CanEndpoint each, sharing a bus link):
+    /// @code
+    /// auto shared = std::make_shared<MpscSendLink>(MpscSendLink::create(shm_link).value());
+    /// CanEndpoint publisher(shared, config, id); // one per thread, send_can() only
+    /// @endcode
+    class MpscSendLink : public Link {
+      public:
+        /// Put a send queue in front of a link
+        /// @param inner Link to send through
+        /// @param config Queue configuration
+        /// @return Result containing link, or invalid_argument (null link, empty queue)
+        static Result<MpscSendLink, Error> create(std::shared_ptr<Link> inner, const MpscSendConfig &config = {}) {
+            if (!inner) {
+                return Result<MpscSendLink, Error>::err(Error::invalid_argument("Null inner link"));
+            }
+            if (config.queue_frames == 0 || config.queue_frames > (size_t(1) << 30) || config.batch == 0) {
+                return Result<MpscSendLink, Error>::err(Error::invalid_argument("Invalid MPSC queue size"));
+            }
+            MpscSendLink link(std::move(inner), config);
+            if (config.drain == MpscDrain::Flusher) {
+                detail::MpscQueue *q = link.queue_.get();
+                Link *target = link.inner_.get();
+                q->flusher = std::thread([q, target]() {
+                    while (q->running.load(std::memory_order_acquire)) {
+                        if (q->drain(*target) == 0) {
+                            std::this_thread::sleep_for(std::chrono::nanoseconds(q->config.idle_sleep_ns));
+                        }
+                    }
+                    q->drain(*target);
+                });
+            }
+            WIREBIT_DEBUG("MpscSendLink on ", link.name().c_str(), ": ", link.queue_->capacity, " slots");
+            return Result<MpscSendLink, Error>::ok(std::move(link));
+        }
+
+        /// Destructor - stops the flusher and sends what the inner link still accepts
+        ~MpscSendLink() override { stop(); }
+
+        MpscSendLink(MpscSendLink &&) noexcept = default;
+
+        MpscSendLink &operator=(MpscSendLink &&other) noexcept {
+            if (this != &other) {
+                stop();
+                Link::operator=(std::move(other));
+                inner_ = std::move(other.inner_);
+                queue_ = std::move(other.queue_);
+            }
+            return *this;
+        }
+
+        MpscSendLink(const MpscSendLink &) = delete;
+        MpscSendLink &operator=(const MpscSendLink &) = delete;
+
+        /// Queue a frame (thread-safe)
+        /// @param frame Frame to send
+        /// @return Result indicating success, or timeout if the queue is full
+        Result<Unit, Error> send(const Frame &frame) override { return enqueue(make_view(frame)); }
+
+        /// Queue a borrowed frame (thread-safe; the spans are copied before returning)
+        /// @param view Frame view to send
+        /// @return Result indicating success, or timeout if the queue is full
+        Result<Unit, Error> send_view(const FrameView &view) override { return enqueue(view); }
+
+        Result<Frame, Error> recv() override { return inner_->recv(); }
+
+        Result<FrameView, Error> recv_view() override { return inner_->recv_view(); }
+
+        Result<size_t, Error> recv_batch(Vector<Frame> &frames, size_t max_frames) override {
+            return inner_->recv_batch(frames, max_frames);
+        }
+
+        /// Check for a free queue slot
+        bool can_send() const override { return queue_->has_room(); }
+
+        bool can_recv() const override { return inner_->can_recv(); }
+
+        String name() const override { return inner_->name(); }
+
+        int poll_fd() const override { return inner_->poll_fd(); }
+
+        bool prepare_wait() override { return inner_->prepare_wait(); }
+
+        void finish_wait() override { inner_->finish_wait(); }
+
+        uint64_t next_deadline() const override { return inner_->next_deadline(); }
+
+        /// Send queued frames now (thread-safe; returns at once if another thread is draining)
+        /// @return Number of frames sent by this call
+        inline size_t flush() { return queue_->drain(*inner_); }
+
+        /// Get the number of queued frames not yet sent
+        inline size_t pending() const { return queue_->pending(); }
+
+        /// Get the wrapped link
+        inline Link &inner() { return *inner_; }
+
+        /// Get a snapshot of the statistics
+        inline MpscSendStats stats() const { return queue_->snapshot(); }
+
+        /// Reset statistics
+        inline void reset_stats() { queue_->reset_counters(); }
+
+      private:
+        std::shared_ptr<Link> inner_;              ///< Single-producer link
+        std::unique_ptr<detail::MpscQueue> queue_; ///< Slots and drain state (stable address for producers)
+
+        MpscSendLink(std::shared_ptr<Link> inner, const MpscSendConfig &config)
+            : inner_(std::move(inner)), queue_(std::make_unique<detail::MpscQueue>(config)) {}
+
+        inline Result<Unit, Error> enqueue(const FrameView &view) {
+            if (!queue_->push(view)) {
+                // Full: make room ourselves if nobody else is draining, then try once more
+                if (queue_->config.drain != MpscDrain::Manual) {
+                    queue_->drain(*inner_);
+                }
+                if (!queue_->push(view)) {
+                    queue_->queue_full.fetch_add(1, std::memory_order_relaxed);
+                    return Result<Unit, Error>::err(Error::timeout("Send queue full"));
+                }
+            }
+            if (queue_->config.drain == MpscDrain::Combining) {
+                queue_->combine(*inner_);
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        inline void stop() {
+            if (!queue_) {
+                return;
+            }
+            if (queue_->flusher.joinable()) {
+                queue_->running.store(false, std::memory_order_release);
+                queue_->flusher.join();
+            } else {
+                queue_->drain(*inner_);
+            }
+        }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// What an RxQueue does with an item pushed while it is full
+    enum class RxOverflow : uint8_t {
+        DropOldest = 0, ///< Overwrite the oldest queued item (freshest data wins)
+        DropNewest = 1, ///< Reject the incoming item (queued data wins)
+    };
+
+    /// Fixed-capacity circular receive queue used by the endpoints
+    ///
+    /// Slots are allocated once up front, so push and pop are O(1) and never shift the
+    /// remaining items the way Vector::erase(begin()) does. Popping with pop_swap() trades the
+    /// slot with the caller's object, so heap-backed items (e.g. Bytes) keep their capacity and
+    /// a steady-state receive loop stops allocating.
+    ///
+    /// Example usage:
+    /// @code
+    /// RxQueue<Bytes> queue(100, RxOverflow::DropOldest);
+    /// queue.push(frame.payload);
+    /// Bytes out;
+    /// while (queue.pop_swap(out)) { handle(out); }
+    /// @endcode
+    template <typename T> class RxQueue {
+      public:
+        RxQueue() = default;
+
+        /// Create a queue
+        /// @param capacity Maximum number of queued items
+        /// @param overflow Policy when pushing into a full queue
+        inline explicit RxQueue(size_t capacity, RxOverflow overflow = RxOverflow::DropOldest)
+            : slots_(capacity), overflow_(overflow) {}
+
+        /// Push an item, applying the overflow policy if the queue is full
+        /// @param item Item to queue
+        /// @return false if the item was rejected (DropNewest, or zero capacity)
+        inline bool push(const T &item) {
+            if (!make_room()) {
+                return false;
+            }
+            slots_[index(count_)] = item;
+            ++count_;
+            return true;
+        }
+
+        /// Push an item (move), applying the overflow policy if the queue is full
+        /// @param item Item to queue
+        /// @return false if the item was rejected (DropNewest, or zero capacity)
+        inline bool push(T &&item) {
+            if (!make_room()) {
+                return false;
+            }
+            slots_[index(count_)] = std::move(item);
+            ++count_;
+            return true;
+        }
+
+        /// Claim the next slot for filling in place, applying the overflow policy if the queue is full
+        /// The slot still holds a previously popped item, so a heap-backed item can be refilled
+        /// (e.g. resize + memcpy) without allocating once it has grown large enough.
+        /// @return Slot to fill (now counted as queued), or nullptr if rejected (DropNewest, or zero capacity)
+        inline T *push_slot() {
+            if (!make_room()) {
+                return nullptr;
+            }
+            T *slot = &slots_[index(count_)];
+            ++count_;
+            return slot;
+        }
+
+        /// Push a run of items, applying the overflow policy item by item
+        /// @param data Items to queue
+        /// @param n Number of items
+        /// @return Number of items accepted
+        inline size_t push(const T *data, size_t n) {
+            if (overflow_ == RxOverflow::DropNewest) {
+                size_t accepted = std::min(n, free_space());
+                copy_in(data, accepted);
+                dropped_ += n - accepted;
+                return accepted;
+            }
+
+            // DropOldest: only the newest capacity() items can survive
+            if (n > slots_.size()) {
+                dropped_ += n - slots_.size();
+                data += n - slots_.size();
+                n = slots_.size();
+            }
+            size_t evict = n > free_space() ? n - free_space() : 0;
+            discard(evict);
+            dropped_ += evict;
+            copy_in(data, n);
+            return n;
+        }
+
+        /// Get the oldest item (queue must not be empty)
+        inline T &front() { return slots_[head_]; }
+
+        /// Get the oldest item (queue must not be empty)
+        inline const T &front() const { return slots_[head_]; }
+
+        /// Get the i-th oldest item (i < size())
+        inline const T &operator[](size_t i) const { return slots_[index(i)]; }
+
+        /// Remove the oldest item (no-op if empty)
+        inline void pop() { discard(1); }
+
+        /// Remove the oldest item by swapping it into out
+        /// out's previous contents stay in the slot and are reused by the next push.
+        /// @param out Receives the item
+        /// @return false if the queue is empty
+        inline bool pop_swap(T &out) {
+            if (count_ == 0) {
+                return false;
+            }
+            using std::swap;
+            swap(out, slots_[head_]);
+            discard(1);
+            return true;
+        }
+
+        /// Copy up to n of the oldest items out and remove them
+        /// @param out Destination buffer
+        /// @param n Maximum number of items
+        /// @return Number of items copied
+        inline size_t pop(T *out, size_t n) {
+            n = std::min(n, count_);
+            size_t first = std::min(n, slots_.size() - head_);
+            copy_range(out, slots_.data() + head_, first);
+            copy_range(out + first, slots_.data(), n - first);
+            discard(n);
+            return n;
+        }
+
+        /// Remove the n oldest items
+        inline void discard(size_t n) {
+            n = std::min(n, count_);
+            head_ = slots_.empty() ? 0 : (head_ + n) % slots_.size();
+            count_ -= n;
+        }
+
+        /// Remove all items (slots stay allocated)
+        inline void clear() {
+            head_ = 0;
+            count_ = 0;
+        }
+
+        /// Get number of queued items
+        inline size_t size() const { return count_; }
+
+        /// Check if the queue is empty
+        inline bool empty() const { return count_ == 0; }
+
+        /// Check if the queue is full
+        inline bool full() const { return count_ == slots_.size(); }
+
+        /// Get the maximum number of queued items
+        inline size_t capacity() const { return slots_.size(); }
+
+        /// Get number of free slots
+        inline size_t free_space() const { return slots_.size() - count_; }
+
+        /// Get the overflow policy
+        inline RxOverflow overflow() const { return overflow_; }
+
+        /// Get number of items lost to the overflow policy
+        inline uint64_t dropped() const { return dropped_; }
+
+      private:
+        Vector<T> slots_;                              ///< Preallocated ring storage
+        size_t head_ = 0;                              ///< Slot of the oldest item
+        size_t count_ = 0;                             ///< Number of queued items
+        RxOverflow overflow_ = RxOverflow::DropOldest; ///< Policy when full
+        uint64_t dropped_ = 0;                         ///< Items lost to overflow
+
+        /// Helper: Map a logical position (0 = oldest) to a slot
+        inline size_t index(size_t i) const { return (head_ + i) % slots_.size(); }
+
+        /// Helper: Free one slot for a push according to the overflow policy
+        inline bool make_room() {
+            if (count_ < slots_.size()) {
+                return true;
+            }
+            ++dropped_;
+            if (overflow_ == RxOverflow::DropNewest || slots_.empty()) {
+                return false;
+            }
+            discard(1);
+            return true;
+        }
+
+        /// Helper: Append n items that are known to fit
+        inline void copy_in(const T *data, size_t n) {
+            size_t tail = slots_.empty() ? 0 : index(count_);
+            size_t first = std::min(n, slots_.size() - tail);
+            copy_range(slots_.data() + tail, data, first);
+            copy_range(slots_.data(), data + first, n - first);
+            count_ += n;
+        }
+
+        /// Helper: Copy a contiguous run (memcpy for trivially copyable items)
+        static inline void copy_range(T *dst, const T *src, size_t n) {
+            if (n == 0) {
+                return;
+            }
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                std::memcpy(dst, src, n * sizeof(T));
+            } else {
+                std::copy(src, src + n, dst);
+            }
+        }
+    };
+
+} // namespace wirebit
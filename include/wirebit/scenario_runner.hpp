@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/virtual_time.hpp>
+
+namespace wirebit {
+
+    /// Configuration for ScenarioRunner
+    struct ScenarioRunnerConfig {
+        size_t threads = 0;                               ///< Worker threads (0 = one per hardware thread)
+        uint64_t base_seed = 0;                           ///< Scenario i gets seed base_seed + i
+        TimeNs start_ns = VirtualClock::DEFAULT_START_NS; ///< Virtual start time of every scenario
+    };
+
+    /// Statistics of the last ScenarioRunner::run()
+    struct ScenarioRunnerStats {
+        uint64_t scenarios = 0; ///< Scenarios run
+        uint64_t threads = 0;   ///< Workers used (including the calling thread)
+        uint64_t steals = 0;    ///< Index ranges taken over from a busier worker
+        uint64_t wall_ns = 0;   ///< Wall time of the run
+
+        inline void reset() {
+            scenarios = 0;
+            threads = 0;
+            steals = 0;
+            wall_ns = 0;
+        }
+    };
+
+    /// What a scenario runs with: its index and seed, plus a fresh clock and loop for its topology
+    /// The clock is installed on the worker thread (ScopedThreadClock) while the scenario runs, so
+    /// now_ns() in links and endpoints follows the scenario's own virtual time.
+    struct ScenarioContext {
+        size_t index;          ///< Scenario index (0 .. count-1)
+        uint64_t seed;         ///< ScenarioRunnerConfig::base_seed + index
+        VirtualClock &clock;   ///< Scenario clock, starting at ScenarioRunnerConfig::start_ns
+        VirtualTimeLoop &loop; ///< Loop on the scenario clock
+        size_t worker;         ///< Worker running the scenario (results must not depend on it)
+    };
+
+    namespace detail {
+        /// Scenario indices [begin, end) still owned by a worker, packed into one word so the owner
+        /// (taking from the front) and thieves (splitting off the back) each need a single CAS
+        struct alignas(64) ScenarioRange {
+            std::atomic<uint64_t> bounds{0};
+
+            static inline uint64_t pack(uint64_t begin, uint64_t end) { return begin << 32 | end; }
+            static inline uint64_t begin_of(uint64_t bounds) { return bounds >> 32; }
+            static inline uint64_t end_of(uint64_t bounds) { return bounds & 0xFFFFFFFFu; }
+        };
+    } // namespace detail
+
+    /// Runs many independent simulations in parallel on a work-stealing thread pool
+    ///
+    /// Each scenario builds its own in-process topology (e.g. ShmLink::create_pair() links with
+    /// seeded LinkModels, endpoints on them) and drives it with the VirtualTimeLoop it is given, so
+    /// it advances as fast as the CPU allows. Scenarios share nothing, and every one starts from
+    /// the same virtual time with a seed derived from its index only. Its result therefore does
+    /// not depend on the thread count or on which worker ran it.
+    ///
+    /// Scheduling: the indices are split into one contiguous range per worker. A worker runs its
+    /// range front to back, and once it is empty steals the back half of the largest range left,
+    /// so a few slow scenarios do not leave the other cores idle.
+    ///
+    /// Scenarios report failures through their result: exceptions are not caught, and a thrown
+    /// exception ends the process.
+    ///
+    /// Example usage:
+    /// @code
+    /// ScenarioRunner runner;
+    /// auto lost = runner.run(10000, [](ScenarioContext &ctx) {
+    ///     LinkModel model(ms_to_ns(1), 0, 0.01, 0.0, 0.0, 0, ctx.seed);
+    ///     auto links = std::move(ShmLink::create_pair("bus", 1 << 16, &model).value());
+    ///     ... // add endpoints to ctx.loop, schedule traffic
+    ///     ctx.loop.run_for(s_to_ns(60));
+    ///     return links.first.stats().frames_dropped;
+    /// }).value(); // lost[i] belongs to scenario i
+    /// @endcode
+    class ScenarioRunner {
+      public:
+        /// Create a runner
+        /// @param config Thread count, seeds and start time
+        explicit ScenarioRunner(const ScenarioRunnerConfig &config = ScenarioRunnerConfig{}) : config_(config) {}
+
+        /// Run scenarios 0 .. count-1 and collect their results in index order
+        /// The calling thread works as one of the workers; the call returns once all scenarios ran.
+        /// @param count Number of scenarios (at most UINT32_MAX)
+        /// @param scenario Callable taking ScenarioContext& and returning the scenario's result; called
+        ///                 concurrently from several threads
+        /// @return Result containing one result per scenario, or invalid_argument for a bad count
+        template <typename Fn>
+        auto run(size_t count, Fn &&scenario) -> Result<Vector<std::invoke_result_t<Fn &, ScenarioContext &>>, Error> {
+            using R = std::invoke_result_t<Fn &, ScenarioContext &>;
+            using RunResult = Result<Vector<R>, Error>;
+            if (count > UINT32_MAX) {
+                return RunResult::err(Error::invalid_argument("Too many scenarios"));
+            }
+
+            stats_.reset();
+            uint64_t start = static_cast<uint64_t>(wall_ns());
+            size_t workers = std::max<size_t>(1, std::min(threads(), count));
+            Vector<std::optional<R>> slots(count);
+            std::unique_ptr<detail::ScenarioRange[]> ranges(new detail::ScenarioRange[workers]);
+            for (size_t w = 0; w < workers; ++w) {
+                ranges[w].bounds.store(detail::ScenarioRange::pack(count * w / workers, count * (w + 1) / workers),
+                                       std::memory_order_relaxed);
+            }
+            std::atomic<uint64_t> steals{0};
+
+            auto work = [&](size_t self) {
+                size_t index = 0;
+                while (take(ranges.get(), self, index) || steal(ranges.get(), workers, self, steals, index)) {
+                    VirtualClock clock(config_.start_ns);
+                    ScopedThreadClock use(clock);
+                    VirtualTimeLoop loop(clock);
+                    ScenarioContext context{index, config_.base_seed + index, clock, loop, self};
+                    slots[index].emplace(scenario(context));
+                }
+            };
+
+            Vector<std::thread> threads;
+            for (size_t w = 1; w < workers; ++w) {
+                threads.push_back(std::thread(work, w));
+            }
+            work(0);
+            for (auto &thread : threads) {
+                thread.join();
+            }
+
+            Vector<R> results;
+            results.reserve(count);
+            for (auto &slot : slots) {
+                results.push_back(std::move(*slot));
+            }
+            stats_.scenarios = count;
+            stats_.threads = workers;
+            stats_.steals = steals.load(std::memory_order_relaxed);
+            stats_.wall_ns = static_cast<uint64_t>(wall_ns()) - start;
+            WIREBIT_DEBUG("ScenarioRunner: ", count, " scenarios on ", workers, " threads (", stats_.steals,
+                          " steals)");
+            return RunResult::ok(std::move(results));
+        }
+
+        /// Get the number of worker threads a run uses at most
+        inline size_t threads() const {
+            if (config_.threads != 0) {
+                return config_.threads;
+            }
+            return std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        /// Get the configuration
+        inline const ScenarioRunnerConfig &config() const { return config_; }
+
+        /// Get statistics of the last run
+        inline const ScenarioRunnerStats &stats() const { return stats_; }
+
+      private:
+        ScenarioRunnerConfig config_;
+        ScenarioRunnerStats stats_;
+
+        /// Helper: Take the next index from a worker's own range
+        static inline bool take(detail::ScenarioRange *ranges, size_t self, size_t &index) {
+            std::atomic<uint64_t> &bounds = ranges[self].bounds;
+            uint64_t current = bounds.load(std::memory_order_acquire);
+            while (detail::ScenarioRange::begin_of(current) < detail::ScenarioRange::end_of(current)) {
+                uint64_t begin = detail::ScenarioRange::begin_of(current);
+                uint64_t next = detail::ScenarioRange::pack(begin + 1, detail::ScenarioRange::end_of(current));
+                if (bounds.compare_exchange_weak(current, next, std::memory_order_acq_rel)) {
+                    index = static_cast<size_t>(begin);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Helper: Move the back half of the largest remaining range into the (empty) own range and
+        /// take its first index
+        /// Ranges only shrink or split, so once every range is empty no work can appear again.
+        static inline bool steal(detail::ScenarioRange *ranges, size_t workers, size_t self,
+                                 std::atomic<uint64_t> &steals, size_t &index) {
+            while (true) {
+                size_t victim = workers;
+                uint64_t victim_bounds = 0;
+                uint64_t most = 0;
+                for (size_t i = 1; i < workers; ++i) {
+                    size_t w = (self + i) % workers;
+                    uint64_t bounds = ranges[w].bounds.load(std::memory_order_acquire);
+                    uint64_t left = detail::ScenarioRange::end_of(bounds) - detail::ScenarioRange::begin_of(bounds);
+                    if (left > most) {
+                        most = left;
+                        victim = w;
+                        victim_bounds = bounds;
+                    }
+                }
+                if (victim == workers) {
+                    return false;
+                }
+
+                uint64_t begin = detail::ScenarioRange::begin_of(victim_bounds);
+                uint64_t end = detail::ScenarioRange::end_of(victim_bounds);
+                uint64_t split = end - (most + 1) / 2;
+                if (!ranges[victim].bounds.compare_exchange_strong(
+                        victim_bounds, detail::ScenarioRange::pack(begin, split), std::memory_order_acq_rel)) {
+                    continue; // The owner or another thief got there first
+                }
+                steals.fetch_add(1, std::memory_order_relaxed);
+                index = static_cast<size_t>(split);
+                ranges[self].bounds.store(detail::ScenarioRange::pack(split + 1, end), std::memory_order_release);
+                return true;
+            }
+        }
+    };
+
+} // namespace wirebit
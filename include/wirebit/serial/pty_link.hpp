@@ -8,17 +8,22 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <termios.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/pending_output.hpp>
 #include <wirebit/common/types.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/stream_decoder.hpp>
 
 namespace wirebit {
 
     /// Configuration for PTY link
     struct PtyConfig {
-        bool auto_destroy = true;        ///< Automatically close PTY on destructor
-        bool auto_flush_on_block = true; ///< Auto-flush output buffer when write would block
+        bool auto_destroy = true;         ///< Automatically close PTY on destructor
+        bool auto_flush_on_block = true;  ///< Discard unread output when the pending queue is full
+        size_t max_pending_bytes = 65536; ///< Output queued while the slave is not reading (see PendingOutput)
 
         /// When true, expose raw serial bytes on the slave PTY.
         ///
@@ -27,6 +32,24 @@ namespace wirebit {
         ///
         /// When false, the PTY transports wirebit frames using encode_frame()/decode_frame().
         bool raw_bytes = false;
+
+        /// Framed mode: append a CRC32C trailer to every frame sent (FRAME_FLAG_CHECKSUM).
+        /// Received frames that carry one are always verified, whatever this setting.
+        bool checksum = false;
+
+        /// Framed mode wire format. StreamFraming::Cobs and StreamFraming::Slip replace the 44-byte
+        /// FrameHeader with a delimited packet: a 4-byte message costs 8 bytes on the line instead of
+        /// 48, and the receiver resynchronizes at the next delimiter after corruption. Metadata and
+        /// header fields other than the type are not carried. Both ends must use the same setting.
+        StreamFraming framing = StreamFraming::Header;
+
+        /// Cobs/Slip: start each packet with the frame type and payload length (2+ bytes). Without
+        /// it packets are bare SERIAL payloads and both ends must agree on `checksum`.
+        bool compact_header = true;
+
+        /// StreamFraming::Header: header format sent. FRAME_HEADER_V2 encodes the fields as varints and
+        /// drops zero ones (about 20 bytes instead of 44); receivers accept both, so only senders opt in.
+        uint16_t header_version = FRAME_HEADER_V1;
     };
 
     /// Statistics for PtyLink
@@ -35,12 +58,16 @@ namespace wirebit {
         uint64_t frames_received = 0;
         uint64_t bytes_sent = 0;
         uint64_t bytes_received = 0;
+        uint64_t bytes_queued = 0;   ///< Bytes the PTY did not take at once and that were queued
+        uint64_t output_flushes = 0; ///< Times unread output was discarded (auto_flush_on_block)
 
         inline void reset() {
             frames_sent = 0;
             frames_received = 0;
             bytes_sent = 0;
             bytes_received = 0;
+            bytes_queued = 0;
+            output_flushes = 0;
         }
     };
 
@@ -56,7 +83,7 @@ namespace wirebit {
         /// @param config PTY configuration
         /// @return Result containing PtyLink or error
         static inline Result<PtyLink, Error> create(const PtyConfig &config = {}) {
-            echo::trace("Creating PtyLink...");
+            WIREBIT_TRACE("Creating PtyLink...");
 
             // Open master PTY
             int master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
@@ -88,7 +115,7 @@ namespace wirebit {
             }
 
             String slave_path(slave_path_cstr);
-            echo::trace("PtyLink created: master_fd=", master_fd, " slave=", slave_path.c_str()).green();
+            WIREBIT_TRACE("PtyLink created: master_fd=", master_fd, " slave=", slave_path.c_str()).green();
 
             return Result<PtyLink, Error>::ok(PtyLink(master_fd, slave_path, config));
         }
@@ -96,7 +123,7 @@ namespace wirebit {
         /// Destructor - closes PTY if auto_destroy is enabled
         inline ~PtyLink() {
             if (config_.auto_destroy && master_fd_ >= 0) {
-                echo::debug("Closing PTY master fd: ", master_fd_);
+                WIREBIT_DEBUG("Closing PTY master fd: ", master_fd_);
                 close(master_fd_);
                 master_fd_ = -1;
             }
@@ -105,7 +132,8 @@ namespace wirebit {
         /// Move constructor
         inline PtyLink(PtyLink &&other) noexcept
             : master_fd_(other.master_fd_), slave_path_(std::move(other.slave_path_)), config_(other.config_),
-              stats_(other.stats_), rx_buffer_(std::move(other.rx_buffer_)) {
+              stats_(other.stats_), decoder_(std::move(other.decoder_)), rx_scratch_(std::move(other.rx_scratch_)),
+              tx_scratch_(std::move(other.tx_scratch_)), pending_(std::move(other.pending_)) {
             other.master_fd_ = -1;
         }
 
@@ -119,7 +147,10 @@ namespace wirebit {
                 slave_path_ = std::move(other.slave_path_);
                 config_ = other.config_;
                 stats_ = other.stats_;
-                rx_buffer_ = std::move(other.rx_buffer_);
+                decoder_ = std::move(other.decoder_);
+                rx_scratch_ = std::move(other.rx_scratch_);
+                tx_scratch_ = std::move(other.tx_scratch_);
+                pending_ = std::move(other.pending_);
                 other.master_fd_ = -1;
             }
             return *this;
@@ -132,7 +163,12 @@ namespace wirebit {
         /// Send a frame through the PTY
         /// @param frame Frame to send
         /// @return Result indicating success or error
-        inline Result<Unit, Error> send(const Frame &frame) override {
+        inline Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Send a borrowed frame through the PTY
+        /// @param frame Frame view to send
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send_view(const FrameView &frame) override {
             if (master_fd_ < 0) {
                 return Result<Unit, Error>::err(Error::io_error("PTY not open"));
             }
@@ -144,149 +180,114 @@ namespace wirebit {
                 if (frame.payload.empty()) {
                     return Result<Unit, Error>::ok(Unit{});
                 }
-                echo::trace("PtyLink::send(raw): ", frame.payload.size(), " bytes");
-                ssize_t written = write(master_fd_, frame.payload.data(), frame.payload.size());
-                if (written < 0) {
-                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                        if (config_.auto_flush_on_block) {
-                            echo::trace("PTY buffer full, flushing...");
-                            tcflush(master_fd_, TCOFLUSH);
-                            written = write(master_fd_, frame.payload.data(), frame.payload.size());
-                            if (written < 0) {
-                                echo::warn("PTY write failed after flush").yellow();
-                                return Result<Unit, Error>::err(Error::timeout("PTY write would block"));
-                            }
-                        } else {
-                            echo::warn("PTY write would block").yellow();
-                            return Result<Unit, Error>::err(Error::timeout("PTY write would block"));
-                        }
-                    } else {
-                        echo::error("PTY write failed: ", strerror(errno)).red();
-                        return Result<Unit, Error>::err(Error::io_error("PTY write failed"));
-                    }
-                }
-                if (static_cast<size_t>(written) != frame.payload.size()) {
-                    echo::warn("PTY partial write: ", written, " of ", frame.payload.size(), " bytes").yellow();
-                }
-                stats_.frames_sent++;
-                stats_.bytes_sent += written;
-                echo::debug("PtyLink sent(raw): ", written, " bytes");
-                return Result<Unit, Error>::ok(Unit{});
+                WIREBIT_TRACE("PtyLink::send(raw): ", frame.payload.size(), " bytes");
+                struct iovec iov = {const_cast<Byte *>(frame.payload.data()), frame.payload.size()};
+                return write_record(&iov, 1, frame.payload.size());
             }
 
-            // Framed mode: encode wirebit frame to bytes
-            Bytes encoded = encode_frame(frame);
-
-            echo::trace("PtyLink::send(framed): ", encoded.size(), " bytes");
-
-            // Write to master PTY
-            ssize_t written = write(master_fd_, encoded.data(), encoded.size());
-            if (written < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    if (config_.auto_flush_on_block) {
-                        // Flush output buffer and retry once
-                        echo::trace("PTY buffer full, flushing...");
-                        tcflush(master_fd_, TCOFLUSH);
-                        written = write(master_fd_, encoded.data(), encoded.size());
-                        if (written < 0) {
-                            echo::warn("PTY write failed after flush").yellow();
-                            return Result<Unit, Error>::err(Error::timeout("PTY write would block"));
-                        }
-                    } else {
-                        echo::warn("PTY write would block").yellow();
-                        return Result<Unit, Error>::err(Error::timeout("PTY write would block"));
-                    }
-                } else {
-                    echo::error("PTY write failed: ", strerror(errno)).red();
-                    return Result<Unit, Error>::err(Error::io_error("PTY write failed"));
-                }
+            if (config_.framing != StreamFraming::Header) {
+                tx_scratch_.resize(max_packet_size(config_.framing, frame.payload.size()));
+                size_t total = encode_packet(frame, config_.framing, config_.compact_header, config_.checksum,
+                                             tx_scratch_.data());
+                WIREBIT_TRACE("PtyLink::send(packet): ", total, " bytes");
+                struct iovec iov = {tx_scratch_.data(), total};
+                return write_record(&iov, 1, total);
             }
 
-            if (static_cast<size_t>(written) != encoded.size()) {
-                echo::warn("PTY partial write: ", written, " of ", encoded.size(), " bytes").yellow();
+            // Framed mode: gather header, payload and meta straight from the view
+            FrameHeader header = frame.header;
+            header.payload_len = static_cast<uint32_t>(frame.payload.size());
+            header.meta_len = static_cast<uint32_t>(frame.meta.size());
+            uint32_t crc = 0;
+            bool add_crc = config_.checksum && !(header.flags & FRAME_FLAG_CHECKSUM);
+            if (add_crc) {
+                crc = frame_checksum(frame.payload, frame.meta);
+                header.flags |= FRAME_FLAG_CHECKSUM;
+                header.meta_len += FRAME_CHECKSUM_LEN;
             }
+            Byte compact[FRAME_HEADER_V2_MAX];
+            struct iovec iov[4] = {
+                {&header, sizeof(FrameHeader)},
+                {const_cast<Byte *>(frame.payload.data()), frame.payload.size()},
+                {const_cast<Byte *>(frame.meta.data()), frame.meta.size()},
+                {&crc, add_crc ? FRAME_CHECKSUM_LEN : 0},
+            };
+            header.version = FRAME_HEADER_V1;
+            if (config_.header_version == FRAME_HEADER_V2) {
+                iov[0] = {compact, encode_frame_header(header, 0, compact)};
+            }
+            size_t total = iov[0].iov_len + header.payload_len + header.meta_len;
 
-            stats_.frames_sent++;
-            stats_.bytes_sent += written;
-
-            echo::debug("PtyLink sent(framed): ", written, " bytes");
-            return Result<Unit, Error>::ok(Unit{});
+            WIREBIT_TRACE("PtyLink::send(framed): ", total, " bytes");
+            return write_record(iov, add_crc ? 4 : (frame.meta.empty() ? 2 : 3), total);
         }
 
         /// Receive a frame from the PTY (non-blocking)
         /// @return Result containing frame if available, or error
         inline Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive a frame from the PTY without allocating (non-blocking)
+        /// The view points into the link's receive buffer and stays valid until the next recv call
+        /// @return Result containing frame view if available, or error
+        inline Result<FrameView, Error> recv_view() override {
             if (master_fd_ < 0) {
-                return Result<Frame, Error>::err(Error::io_error("PTY not open"));
+                return Result<FrameView, Error>::err(Error::io_error("PTY not open"));
             }
 
             if (config_.raw_bytes) {
-                uint8_t temp_buf[4096];
-                ssize_t bytes_read = read(master_fd_, temp_buf, sizeof(temp_buf));
+                ssize_t bytes_read = read(master_fd_, rx_scratch_.data(), rx_scratch_.size());
 
                 if (bytes_read < 0) {
                     if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                        return Result<Frame, Error>::err(Error::timeout("No data available"));
+                        return Result<FrameView, Error>::err(Error::timeout("No data available"));
                     }
                     echo::error("PTY read failed: ", strerror(errno)).red();
-                    return Result<Frame, Error>::err(Error::io_error("PTY read failed"));
+                    return Result<FrameView, Error>::err(Error::io_error("PTY read failed"));
                 }
 
                 if (bytes_read == 0) {
-                    return Result<Frame, Error>::err(Error::timeout("No data available"));
+                    return Result<FrameView, Error>::err(Error::timeout("No data available"));
                 }
 
                 stats_.bytes_received += bytes_read;
                 stats_.frames_received++;
+                stats_export_.received(bytes_read);
+
+                FrameView frame = make_view(FrameType::SERIAL,
+                                            std::span<const Byte>(rx_scratch_.data(), static_cast<size_t>(bytes_read)));
+                return Result<FrameView, Error>::ok(frame);
+            }
 
-                Bytes payload(temp_buf, temp_buf + bytes_read);
-                Frame frame = make_frame(FrameType::SERIAL, std::move(payload), 0, 0);
-                return Result<Frame, Error>::ok(std::move(frame));
+            // Frames left over from the last read go out before reading again
+            FrameView frame;
+            if (decoder_.next(frame)) {
+                return received(frame);
             }
 
-            // Read available data into buffer
-            uint8_t temp_buf[4096];
-            ssize_t bytes_read = read(master_fd_, temp_buf, sizeof(temp_buf));
+            // Read straight into the decoder's buffer
+            std::span<Byte> space = decoder_.write_space(rx_scratch_.size());
+            ssize_t bytes_read = read(master_fd_, space.data(), space.size());
 
             if (bytes_read > 0) {
-                rx_buffer_.insert(rx_buffer_.end(), temp_buf, temp_buf + bytes_read);
+                decoder_.commit(static_cast<size_t>(bytes_read));
                 stats_.bytes_received += bytes_read;
-                echo::trace("PtyLink::recv: read ", bytes_read, " bytes, buffer now ", rx_buffer_.size());
+                stats_export_.add(LinkCounter::BytesReceived, bytes_read);
+                WIREBIT_TRACE("PtyLink::recv: read ", bytes_read, " bytes, buffer now ", decoder_.buffered());
             } else if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
                 echo::error("PTY read failed: ", strerror(errno)).red();
-                return Result<Frame, Error>::err(Error::io_error("PTY read failed"));
+                return Result<FrameView, Error>::err(Error::io_error("PTY read failed"));
             }
 
-            // Try to decode a frame from buffer
-            if (rx_buffer_.size() >= sizeof(FrameHeader)) {
-                // Peek at header to get payload size
-                FrameHeader header;
-                std::memcpy(&header, rx_buffer_.data(), sizeof(FrameHeader));
-
-                // Validate magic
-                if (header.magic != 0x57424954) {
-                    // Invalid magic - skip one byte and try again
-                    echo::warn("Invalid frame magic, skipping byte").yellow();
-                    rx_buffer_.erase(rx_buffer_.begin());
-                    return Result<Frame, Error>::err(Error::timeout("No valid frame"));
-                }
-
-                size_t total_size = sizeof(FrameHeader) + header.payload_len + header.meta_len;
-                if (rx_buffer_.size() >= total_size) {
-                    // Full frame available - decode it
-                    Bytes frame_data(rx_buffer_.begin(), rx_buffer_.begin() + total_size);
-                    rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + total_size);
-
-                    auto result = decode_frame(frame_data);
-                    if (result.is_ok()) {
-                        stats_.frames_received++;
-                        echo::debug("PtyLink received frame: ", total_size, " bytes");
-                    }
-                    return result;
-                }
+            if (decoder_.next(frame)) {
+                return received(frame);
             }
-
-            return Result<Frame, Error>::err(Error::timeout("No frames available"));
+            return Result<FrameView, Error>::err(Error::timeout("No frames available"));
         }
 
         /// Check if link is ready for sending
@@ -313,6 +314,43 @@ namespace wirebit {
         /// @return Master PTY file descriptor
         inline int master_fd() const { return master_fd_; }
 
+        /// Get file descriptor for readiness polling (see Link::poll_fd())
+        /// @return File descriptor
+        inline int poll_fd() const override { return master_fd_; }
+
+        /// Write output queued by earlier sends
+        /// Call when master_fd() polls writable (POLLOUT) while has_pending_output(); send and
+        /// prepare_wait() also flush opportunistically.
+        /// @param timeout_ns How long to wait for the PTY to accept data (0 = don't wait)
+        /// @return Result containing bytes written, or io_error
+        inline Result<size_t, Error> flush_pending(uint64_t timeout_ns = 0) {
+            if (master_fd_ < 0) {
+                return Result<size_t, Error>::err(Error::io_error("PTY not open"));
+            }
+            uint64_t before = pending_.bytes_written();
+            auto result = pending_.flush(master_fd_, timeout_ns);
+            uint64_t drained = pending_.bytes_written() - before;
+            stats_.bytes_sent += drained;
+            stats_export_.add(LinkCounter::BytesSent, drained);
+            stats_export_.set(LinkCounter::TxQueuedBytes, pending_.size());
+            stats_export_.set(LinkCounter::TxCapacityBytes, pending_.max_bytes());
+            return result;
+        }
+
+        /// Check if earlier sends left output queued
+        inline bool has_pending_output() const { return !pending_.empty(); }
+
+        /// Get number of queued output bytes
+        inline size_t pending_output() const { return pending_.size(); }
+
+        /// Flush queued output before the caller blocks (see Link::prepare_wait())
+        inline bool prepare_wait() override {
+            if (!pending_.empty()) {
+                flush_pending();
+            }
+            return true;
+        }
+
         /// Get link statistics
         /// @return Statistics reference
         inline const PtyLinkStats &stats() const { return stats_; }
@@ -322,18 +360,24 @@ namespace wirebit {
 
         /// Get receive buffer size (pending bytes)
         /// @return Number of bytes in receive buffer
-        inline size_t rx_buffer_size() const { return rx_buffer_.size(); }
+        inline size_t rx_buffer_size() const { return decoder_.buffered(); }
 
         /// Clear receive buffer
-        inline void clear_rx_buffer() { rx_buffer_.clear(); }
+        inline void clear_rx_buffer() { decoder_.clear(); }
+
+        /// Get framed-mode decoder statistics (resyncs, skipped noise)
+        /// @return Decoder statistics reference
+        inline const StreamDecoderStats &decoder_stats() const { return decoder_.stats(); }
 
-        /// Flush (discard) pending output data in kernel buffer
-        /// Call this periodically if the slave side may not be reading
+        /// Flush (discard) pending output data in kernel buffer and the pending-output queue
+        /// Call this periodically if the slave side may not be reading. The rest of a record that has
+        /// partly been written stays queued (see PendingOutput::discard()).
         /// @return true if flush succeeded, false otherwise
         inline bool flush_output() {
             if (master_fd_ < 0) {
                 return false;
             }
+            pending_.discard();
             // TCOFLUSH discards data written but not transmitted (output queue)
             return tcflush(master_fd_, TCOFLUSH) == 0;
         }
@@ -348,26 +392,75 @@ namespace wirebit {
             return tcflush(master_fd_, TCIFLUSH) == 0;
         }
 
-        /// Flush (discard) both input and output kernel buffers
+        /// Flush (discard) both input and output kernel buffers and the pending-output queue
+        /// The rest of a record that has partly been written stays queued.
         /// @return true if flush succeeded, false otherwise
         inline bool flush() {
             if (master_fd_ < 0) {
                 return false;
             }
+            pending_.discard();
             // TCIOFLUSH discards both input and output queues
             return tcflush(master_fd_, TCIOFLUSH) == 0;
         }
 
       private:
-        int master_fd_;      ///< Master PTY file descriptor
-        String slave_path_;  ///< Slave PTY path (e.g., "/dev/pts/3")
-        PtyConfig config_;   ///< Configuration
-        PtyLinkStats stats_; ///< Statistics
-        Bytes rx_buffer_;    ///< Receive buffer for partial frames
+        int master_fd_;          ///< Master PTY file descriptor
+        String slave_path_;      ///< Slave PTY path (e.g., "/dev/pts/3")
+        PtyConfig config_;       ///< Configuration
+        PtyLinkStats stats_;     ///< Statistics
+        StreamDecoder decoder_;  ///< Framed-mode receive buffer and frame decoder
+        Bytes rx_scratch_;       ///< Read buffer (raw mode frames point into it)
+        Bytes tx_scratch_;       ///< COBS/SLIP packet being written
+        PendingOutput pending_;  ///< Output the PTY has not accepted yet
 
         /// Private constructor
         inline PtyLink(int master_fd, const String &slave_path, const PtyConfig &config)
-            : master_fd_(master_fd), slave_path_(slave_path), config_(config) {}
+            : master_fd_(master_fd), slave_path_(slave_path), config_(config),
+              decoder_(1 << 20, config.framing, config.compact_header, config.checksum), rx_scratch_(4096),
+              pending_(config.max_pending_bytes) {}
+
+        /// Helper: Write one record (a raw chunk or an encoded frame) through the pending queue
+        /// If the queue is full and auto_flush_on_block is set, unread output is discarded (the
+        /// slave is assumed not to be reading) and the write is retried once.
+        inline Result<Unit, Error> write_record(const struct iovec *iov, int iovcnt, size_t total) {
+            const auto queue_full = Error::timeout("").code;
+            uint64_t before = pending_.bytes_written();
+            auto result = pending_.write(master_fd_, iov, iovcnt);
+            if (!result.is_ok() && result.error().code == queue_full && config_.auto_flush_on_block) {
+                WIREBIT_TRACE("PTY output queue full, discarding unread output");
+                tcflush(master_fd_, TCOFLUSH);
+                pending_.discard();
+                stats_.output_flushes++;
+                result = pending_.write(master_fd_, iov, iovcnt);
+            }
+            uint64_t drained = pending_.bytes_written() - before;
+            stats_.bytes_sent += drained;
+            stats_export_.add(LinkCounter::BytesSent, drained);
+            stats_export_.set(LinkCounter::TxQueuedBytes, pending_.size());
+            stats_export_.set(LinkCounter::TxCapacityBytes, pending_.max_bytes());
+            if (!result.is_ok()) {
+                if (result.error().code == queue_full) {
+                    echo::warn("PTY write would block").yellow();
+                }
+                return Result<Unit, Error>::err(result.error());
+            }
+
+            stats_.frames_sent++;
+            stats_export_.add(LinkCounter::FramesSent);
+            stats_.bytes_queued += total - result.value();
+            WIREBIT_DEBUG("PtyLink sent: ", result.value(), " of ", total, " bytes (", pending_.size(), " queued)");
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Account for a decoded frame and hand it out
+        inline Result<FrameView, Error> received(const FrameView &frame) {
+            stats_.frames_received++;
+            stats_export_.add(LinkCounter::FramesReceived);
+            WIREBIT_DEBUG("PtyLink received frame: ", sizeof(FrameHeader) + frame.payload.size() + frame.meta.size(),
+                          " bytes");
+            return Result<FrameView, Error>::ok(frame);
+        }
     };
 
 } // namespace wirebit
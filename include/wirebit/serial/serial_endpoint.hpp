@@ -1,22 +1,38 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <echo/echo.hpp>
 #include <memory>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/time.hpp>
 #include <wirebit/common/types.hpp>
+#include <wirebit/delay_line.hpp>
 #include <wirebit/endpoint.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/rx_queue.hpp>
+#include <wirebit/typed_frame.hpp>
 
 namespace wirebit {
 
+    /// Length of the metadata carried by coalesced serial frames (byte period, uint64_t nanoseconds)
+    constexpr size_t SERIAL_RUN_META_LEN = sizeof(uint64_t);
+
+    /// Serial chunk of up to N bytes carried inline (no heap payload)
+    template <size_t N> using SerialChunk = TypedFrame<FrameType::SERIAL, N>;
+
     /// Serial port configuration
     struct SerialConfig {
-        uint32_t baud = 115200;      ///< Baud rate (bits per second)
-        uint8_t data_bits = 8;       ///< Data bits (5-8)
-        uint8_t stop_bits = 1;       ///< Stop bits (1 or 2)
-        char parity = 'N';           ///< Parity: 'N' (none), 'E' (even), 'O' (odd)
-        size_t max_chunk_read = 256; ///< Maximum bytes to read in one recv() call
+        uint32_t baud = 115200;                          ///< Baud rate (bits per second)
+        uint8_t data_bits = 8;                           ///< Data bits (5-8)
+        uint8_t stop_bits = 1;                           ///< Stop bits (1 or 2)
+        char parity = 'N';                               ///< Parity: 'N' (none), 'E' (even), 'O' (odd)
+        size_t max_chunk_read = 256;                     ///< Maximum bytes to read in one recv() call
+        bool enforce_timing = false;                     ///< Hold received bytes until their deliver_at_ns
+        size_t rx_buffer_size = 65536;                   ///< Receive buffer capacity in bytes
+        RxOverflow rx_overflow = RxOverflow::DropNewest; ///< What a full receive buffer drops (UART overrun)
+        size_t coalesce_max = 0;                         ///< Bytes packed per frame (0/1 = one frame per byte)
     };
 
     /// Serial endpoint for byte-stream communication
@@ -28,13 +44,16 @@ namespace wirebit {
         /// @param config Serial port configuration
         /// @param endpoint_id Unique endpoint identifier
         inline SerialEndpoint(std::shared_ptr<Link> link, const SerialConfig &config, uint32_t endpoint_id)
-            : link_(link), config_(config), endpoint_id_(endpoint_id) {
-            echo::trace("SerialEndpoint created: id=", endpoint_id_, " baud=", config_.baud,
-                        " data=", (int)config_.data_bits, " stop=", (int)config_.stop_bits, " parity=", config_.parity);
+            : link_(link), config_(config), rx_buffer_(config.rx_buffer_size, config.rx_overflow),
+              endpoint_id_(endpoint_id) {
+            WIREBIT_TRACE("SerialEndpoint created: id=", endpoint_id_, " baud=", config_.baud, " data=",
+                          (int)config_.data_bits, " stop=", (int)config_.stop_bits, " parity=", config_.parity);
         }
 
         /// Send data through the serial endpoint
-        /// Converts bytes to frames with proper baud rate pacing
+        /// Converts bytes to frames with proper baud rate pacing. With coalesce_max > 1, runs of up to
+        /// coalesce_max bytes share one frame: deliver_at_ns is the first byte's delivery time and the meta
+        /// carries the byte period, so a receiver with enforce_timing still releases the bytes one by one.
         /// @param data Bytes to send
         /// @return Result indicating success or error
         inline Result<Unit, Error> send(const Bytes &data) override {
@@ -43,7 +62,7 @@ namespace wirebit {
                 return Result<Unit, Error>::ok(Unit{});
             }
 
-            echo::trace("Serial send: ", data.size(), " bytes at ", config_.baud, " baud");
+            WIREBIT_TRACE("Serial send: ", data.size(), " bytes at ", config_.baud, " baud");
 
             // Calculate byte transmission time based on baud rate
             uint32_t bits_per_byte = 1 + config_.data_bits + config_.stop_bits; // Start + data + stop
@@ -52,66 +71,65 @@ namespace wirebit {
             }
             uint64_t byte_time_ns = (bits_per_byte * 1000000000ULL) / config_.baud;
 
-            echo::debug("Byte time: ", byte_time_ns, "ns (", bits_per_byte, " bits/byte)");
+            WIREBIT_DEBUG("Byte time: ", byte_time_ns, "ns (", bits_per_byte, " bits/byte)");
 
             uint64_t now = now_ns();
 
+            if (config_.coalesce_max > 1) {
+                return send_coalesced(data, byte_time_ns, now);
+            }
+
             // Send each byte as a separate frame with proper timing
             for (size_t i = 0; i < data.size(); ++i) {
                 Byte byte = data[i];
-                echo::trace("Sending byte[", i, "]: 0x", std::hex, (int)byte, std::dec);
+                WIREBIT_TRACE("Sending byte[", i, "]: 0x", std::hex, (int)byte, std::dec);
 
-                // Create frame with single byte payload
-                Bytes payload(1);
-                payload[0] = byte;
-                Frame frame = make_frame(FrameType::SERIAL, payload, endpoint_id_, 0);
+                // Single-byte frame stored inline
+                SerialChunk<1> frame = SerialChunk<1>::of(byte, endpoint_id_);
 
                 // Pace bytes according to baud rate
                 // Each byte is sent after the previous one completes
                 last_tx_deliver_at_ns_ = std::max(now, last_tx_deliver_at_ns_) + byte_time_ns;
                 frame.header.deliver_at_ns = last_tx_deliver_at_ns_;
 
-                echo::trace("Frame deliver_at: ", frame.header.deliver_at_ns, "ns");
+                WIREBIT_TRACE("Frame deliver_at: ", frame.header.deliver_at_ns, "ns");
 
                 // Send frame through link
-                auto result = link_->send(frame);
+                auto result = link_->send_view(frame.view());
                 if (!result.is_ok()) {
                     echo::error("Failed to send frame: ", result.error().message.c_str()).red();
                     return result;
                 }
             }
 
-            echo::trace("Serial send complete: ", data.size(), " bytes");
+            WIREBIT_TRACE("Serial send complete: ", data.size(), " bytes");
             return Result<Unit, Error>::ok(Unit{});
         }
 
         /// Receive data from the serial endpoint (non-blocking)
         /// @return Result containing received bytes or error
         inline Result<Bytes, Error> recv() override {
-            echo::trace("SerialEndpoint::recv called");
+            WIREBIT_TRACE("SerialEndpoint::recv called");
 
             // Process incoming frames first
             auto process_result = process();
             if (!process_result.is_ok()) {
                 // Process errors are non-fatal, just means no frames available
-                echo::trace("Process returned: ", process_result.error().message.c_str());
+                WIREBIT_TRACE("Process returned: ", process_result.error().message.c_str());
             }
 
             // Return buffered data if available
             if (!rx_buffer_.empty()) {
                 size_t to_copy = std::min(rx_buffer_.size(), config_.max_chunk_read);
                 Bytes data(to_copy);
-                for (size_t i = 0; i < to_copy; ++i) {
-                    data[i] = rx_buffer_[i];
-                }
-                rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + to_copy);
+                rx_buffer_.pop(data.data(), to_copy);
 
-                echo::debug("Serial recv: ", data.size(), " bytes (", rx_buffer_.size(), " remaining in buffer)");
+                WIREBIT_DEBUG("Serial recv: ", data.size(), " bytes (", rx_buffer_.size(), " remaining in buffer)");
                 return Result<Bytes, Error>::ok(std::move(data));
             }
 
             // No data available
-            echo::trace("Serial recv: no data available");
+            WIREBIT_TRACE("Serial recv: no data available");
             return Result<Bytes, Error>::err(Error::timeout("No data available"));
         }
 
@@ -119,20 +137,18 @@ namespace wirebit {
         /// Converts frames to bytes and buffers them
         /// @return Result indicating success or error
         inline Result<Unit, Error> process() override {
-            echo::trace("SerialEndpoint::process");
+            WIREBIT_TRACE("SerialEndpoint::process");
 
             // Try to receive frames from the link
             while (true) {
                 auto frame_result = link_->recv();
                 if (!frame_result.is_ok()) {
                     // No more frames available
-                    if (rx_buffer_.empty()) {
-                        return Result<Unit, Error>::err(Error::timeout("No frames available"));
-                    }
-                    return Result<Unit, Error>::ok(Unit{});
+                    break;
                 }
 
                 Frame frame = std::move(frame_result.value());
+                record_rx(frame.header);
 
                 // Verify frame type
                 if (frame.type() != FrameType::SERIAL) {
@@ -140,24 +156,27 @@ namespace wirebit {
                     continue;
                 }
 
-                // Enforce delivery timing (simulate serial port timing)
-                uint64_t now = now_ns();
-                if (frame.header.deliver_at_ns > 0 && now < frame.header.deliver_at_ns) {
-                    uint64_t delay_ns = frame.header.deliver_at_ns - now;
-                    echo::trace("Delaying frame delivery by ", delay_ns, "ns");
-                    // In a real implementation, we might want to queue this frame
-                    // For now, we just note that it arrived early
+                // Enforce delivery timing (simulate serial port timing): hold bytes until they are due
+                if (config_.enforce_timing) {
+                    uint64_t byte_time_ns = 0;
+                    if (frame.meta.size() == SERIAL_RUN_META_LEN) {
+                        std::memcpy(&byte_time_ns, frame.meta.data(), SERIAL_RUN_META_LEN);
+                    }
+                    rx_delay_.push(frame.header.deliver_at_ns, Run{std::move(frame.payload), 0, byte_time_ns});
+                    continue;
                 }
 
                 // Add frame payload to receive buffer
-                echo::trace("Processing frame: ", frame.payload.size(), " bytes");
-                for (size_t i = 0; i < frame.payload.size(); ++i) {
-                    rx_buffer_.push_back(frame.payload[i]);
-                }
-
-                echo::debug("RX buffer size: ", rx_buffer_.size(), " bytes");
+                WIREBIT_TRACE("Processing frame: ", frame.payload.size(), " bytes");
+                append_rx(frame.payload);
             }
 
+            // Release held bytes that are due
+            release_due(now_ns());
+
+            if (rx_buffer_.empty()) {
+                return Result<Unit, Error>::err(Error::timeout("No frames available"));
+            }
             return Result<Unit, Error>::ok(Unit{});
         }
 
@@ -185,18 +204,101 @@ namespace wirebit {
         /// @return Number of buffered bytes
         inline size_t rx_buffer_size() const { return rx_buffer_.size(); }
 
-        /// Clear receive buffer
+        /// Get number of bytes lost because the receive buffer was full
+        /// @return Number of dropped bytes
+        inline uint64_t rx_dropped() const { return rx_buffer_.dropped(); }
+
+        /// Get number of received frames held until their delivery time (enforce_timing)
+        /// A coalesced frame counts once until its last byte is released.
+        /// @return Number of held frames
+        inline size_t delayed_count() const { return rx_delay_.size(); }
+
+        /// Get delivery time of the earliest held frame
+        /// @return Deadline in nanoseconds, or DelayLine<Run>::NO_DEADLINE if nothing is held
+        inline uint64_t next_deadline() const override { return rx_delay_.next_deadline(); }
+
+        /// Clear receive buffer (including bytes held for delayed delivery)
         inline void clear_rx_buffer() {
-            echo::debug("Clearing RX buffer: ", rx_buffer_.size(), " bytes discarded");
+            WIREBIT_DEBUG("Clearing RX buffer: ", rx_buffer_.size(), " bytes discarded");
             rx_buffer_.clear();
+            rx_delay_.clear();
         }
 
       private:
+        /// Received bytes waiting for their delivery time; byte i is due at deadline + i * byte_time_ns
+        struct Run {
+            Bytes data;            ///< Frame payload
+            size_t offset;         ///< Bytes already released
+            uint64_t byte_time_ns; ///< Byte period (0 = all bytes due together)
+        };
+
         std::shared_ptr<Link> link_;         ///< Underlying communication link
         SerialConfig config_;                ///< Serial port configuration
-        Vector<Byte> rx_buffer_;             ///< Receive buffer for incoming bytes
+        RxQueue<Byte> rx_buffer_;            ///< Receive buffer for incoming bytes
+        DelayLine<Run> rx_delay_;            ///< Payloads held until deliver_at_ns (enforce_timing)
         uint64_t last_tx_deliver_at_ns_ = 0; ///< Last transmission delivery time (for pacing)
         uint32_t endpoint_id_;               ///< Unique endpoint identifier
+
+        /// Helper: Send bytes as coalesced runs of up to coalesce_max bytes per frame
+        inline Result<Unit, Error> send_coalesced(const Bytes &data, uint64_t byte_time_ns, uint64_t now) {
+            // Runs are sent as views over the caller's bytes (no per-frame copy)
+            Byte meta[SERIAL_RUN_META_LEN];
+            std::memcpy(meta, &byte_time_ns, SERIAL_RUN_META_LEN);
+
+            for (size_t start = 0; start < data.size(); start += config_.coalesce_max) {
+                size_t n = std::min(config_.coalesce_max, data.size() - start);
+                FrameView frame =
+                    make_view(FrameType::SERIAL, std::span<const Byte>(data.data() + start, n), endpoint_id_, 0);
+                frame.meta = std::span<const Byte>(meta, SERIAL_RUN_META_LEN);
+                frame.header.meta_len = static_cast<uint32_t>(SERIAL_RUN_META_LEN);
+
+                // The first byte completes one byte time after the previous one; the rest follow back to back
+                uint64_t first_at = std::max(now, last_tx_deliver_at_ns_) + byte_time_ns;
+                frame.header.deliver_at_ns = first_at;
+                last_tx_deliver_at_ns_ = first_at + (n - 1) * byte_time_ns;
+
+                auto result = link_->send_view(frame);
+                if (!result.is_ok()) {
+                    echo::error("Failed to send frame: ", result.error().message.c_str()).red();
+                    return result;
+                }
+            }
+
+            WIREBIT_TRACE("Serial send complete: ", data.size(), " bytes (coalesced)");
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Move bytes whose delivery time has passed from rx_delay_ to the receive buffer
+        /// A run that is only partly due goes back into the delay line keyed by its next byte's deadline.
+        inline void release_due(uint64_t now) {
+            while (rx_delay_.ready(now)) {
+                uint64_t deadline = rx_delay_.next_deadline();
+                Run run = std::move(rx_delay_.pop_ready(now).value());
+                size_t remaining = run.data.size() - run.offset;
+                size_t due = remaining;
+                if (run.byte_time_ns > 0) {
+                    due = std::min<uint64_t>(remaining, (now - deadline) / run.byte_time_ns + 1);
+                }
+                append_rx(run.data.data() + run.offset, due);
+                run.offset += due;
+                if (run.offset < run.data.size()) {
+                    rx_delay_.push(deadline + due * run.byte_time_ns, std::move(run));
+                }
+            }
+        }
+
+        /// Helper: Append a frame payload to the receive buffer
+        inline void append_rx(const Bytes &payload) { append_rx(payload.data(), payload.size()); }
+
+        /// Helper: Append bytes to the receive buffer
+        inline void append_rx(const Byte *bytes, size_t n) {
+            uint64_t dropped = rx_buffer_.dropped();
+            rx_buffer_.push(bytes, n);
+            if (rx_buffer_.dropped() != dropped) {
+                echo::warn("RX buffer full, dropped ", rx_buffer_.dropped() - dropped, " bytes").yellow();
+            }
+            WIREBIT_DEBUG("RX buffer size: ", rx_buffer_.size(), " bytes");
+        }
     };
 
 } // namespace wirebit
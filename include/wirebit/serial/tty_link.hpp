@@ -2,26 +2,100 @@
 
 #ifndef NO_HARDWARE
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <echo/echo.hpp>
 #include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/pending_output.hpp>
 #include <wirebit/common/types.hpp>
 #include <wirebit/frame.hpp>
 #include <wirebit/link.hpp>
+#include <wirebit/stream_decoder.hpp>
 
 namespace wirebit {
 
+    namespace detail {
+        // termios2 from <asm/termbits.h>, which cannot be included next to <termios.h>. The layout
+        // (19 control characters) holds on the architectures listed; others keep the Bxxxx rates.
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || defined(__arm__) ||                        \
+    (defined(__riscv) && __riscv_xlen == 64)
+        inline constexpr bool CUSTOM_BAUD_SUPPORTED = true;
+#else
+        inline constexpr bool CUSTOM_BAUD_SUPPORTED = false;
+#endif
+
+        /// Kernel struct termios2 (baud rate as a number in c_ispeed/c_ospeed)
+        struct KernelTermios2 {
+            tcflag_t c_iflag;
+            tcflag_t c_oflag;
+            tcflag_t c_cflag;
+            tcflag_t c_lflag;
+            cc_t c_line;
+            cc_t c_cc[19];
+            speed_t c_ispeed;
+            speed_t c_ospeed;
+        };
+
+        inline constexpr unsigned long TTY_TCGETS2 = _IOR('T', 0x2A, KernelTermios2);
+        inline constexpr unsigned long TTY_TCSETS2 = _IOW('T', 0x2B, KernelTermios2);
+        inline constexpr tcflag_t TTY_CBAUD = 0010017; ///< Speed bits of c_cflag
+        inline constexpr tcflag_t TTY_BOTHER = 0010000; ///< "Speed in c_ispeed/c_ospeed"
+    } // namespace detail
+
     /// Configuration for TTY serial link
     struct TtyConfig {
-        String device = "/dev/ttyUSB0"; ///< TTY device path
-        uint32_t baud = 115200;         ///< Baud rate
-        uint8_t data_bits = 8;          ///< Data bits (5-8)
-        uint8_t stop_bits = 1;          ///< Stop bits (1 or 2)
-        char parity = 'N';              ///< Parity: 'N' (none), 'E' (even), 'O' (odd)
-        bool hardware_flow = false;     ///< Hardware flow control (RTS/CTS)
+        String device = "/dev/ttyUSB0";   ///< TTY device path
+        uint32_t baud = 115200;           ///< Baud rate
+        uint8_t data_bits = 8;            ///< Data bits (5-8)
+        uint8_t stop_bits = 1;            ///< Stop bits (1 or 2)
+        char parity = 'N';                ///< Parity: 'N' (none), 'E' (even), 'O' (odd)
+        bool hardware_flow = false;       ///< Hardware flow control (RTS/CTS)
+        size_t max_pending_bytes = 65536; ///< Output queued while the UART is busy (see PendingOutput)
+        size_t read_buffer_size = 1024;   ///< Bytes per read() (raise for multi-Mbaud lines)
+
+        /// Set ASYNC_LOW_LATENCY through TIOCSSERIAL. USB-serial drivers then hand over received bytes
+        /// at once instead of batching them (ftdi_sio drops its 16 ms latency timer to 1 ms). Ports
+        /// that do not support it (PTYs, CDC-ACM) log a warning and keep working.
+        bool low_latency = false;
+
+        /// Raw mode read coalescing (the VMIN/VTIME idea at microsecond resolution): once a read
+        /// returns data, keep reading until read_min_bytes have arrived or the line has been idle
+        /// for read_gap_us. Fewer, larger SERIAL frames for a little added latency.
+        /// 0 (default) returns whatever one read() got.
+        size_t read_min_bytes = 0;
+        uint32_t read_gap_us = 1000; ///< Inter-byte timeout ending a coalesced read
+
+        /// When true, carry whole wirebit frames ([FrameHeader][payload][meta]) over the line,
+        /// e.g. between two wirebit processes joined by a null-modem cable. The receiver
+        /// resynchronizes on the frame magic after line noise (see StreamDecoder).
+        /// When false (default), send()/recv() carry raw SERIAL payload bytes.
+        bool framed = false;
+
+        /// Framed mode: append a CRC32C trailer to every frame sent (FRAME_FLAG_CHECKSUM).
+        /// Received frames that carry one are always verified, whatever this setting.
+        bool checksum = false;
+
+        /// Framed mode wire format. StreamFraming::Cobs and StreamFraming::Slip replace the 44-byte
+        /// FrameHeader with a delimited packet: a 4-byte message costs 8 bytes on the line instead of
+        /// 48, and the receiver resynchronizes at the next delimiter after corruption. Metadata and
+        /// header fields other than the type are not carried. Both ends must use the same setting.
+        StreamFraming framing = StreamFraming::Header;
+
+        /// Cobs/Slip: start each packet with the frame type and payload length (2+ bytes). Without
+        /// it packets are bare SERIAL payloads and both ends must agree on `checksum`.
+        bool compact_header = true;
+
+        /// StreamFraming::Header: header format sent. FRAME_HEADER_V2 encodes the fields as varints and
+        /// drops zero ones (about 20 bytes instead of 44); receivers accept both, so only senders opt in.
+        uint16_t header_version = FRAME_HEADER_V1;
     };
 
     /// Statistics for TtyLink
@@ -32,6 +106,7 @@ namespace wirebit {
         uint64_t bytes_received = 0;
         uint64_t send_errors = 0;
         uint64_t recv_errors = 0;
+        uint64_t bytes_queued = 0; ///< Bytes the TTY did not take at once and that were queued
 
         inline void reset() {
             frames_sent = 0;
@@ -40,6 +115,7 @@ namespace wirebit {
             bytes_received = 0;
             send_errors = 0;
             recv_errors = 0;
+            bytes_queued = 0;
         }
     };
 
@@ -76,10 +152,16 @@ namespace wirebit {
                 return Result<TtyLink, Error>::err(Error::io_error("Failed to get TTY attributes"));
             }
 
-            // Set baud rate
+            // Set baud rate: a standard Bxxxx constant, or a placeholder the custom rate replaces below
             speed_t speed = baud_to_speed(config.baud);
-            cfsetispeed(&tty, speed);
-            cfsetospeed(&tty, speed);
+            bool custom_baud = speed == B0;
+            if (custom_baud && !detail::CUSTOM_BAUD_SUPPORTED) {
+                echo::category("wirebit.tty").warn("Unknown baud rate ", config.baud, ", using 115200");
+                speed = B115200;
+                custom_baud = false;
+            }
+            cfsetispeed(&tty, custom_baud ? B38400 : speed);
+            cfsetospeed(&tty, custom_baud ? B38400 : speed);
 
             // Control modes
             tty.c_cflag &= ~CSIZE; // Clear size bits
@@ -156,6 +238,18 @@ namespace wirebit {
                 return Result<TtyLink, Error>::err(Error::io_error("Failed to set TTY attributes"));
             }
 
+            if (custom_baud) {
+                auto baud = set_custom_baud(fd, config.baud);
+                if (!baud.is_ok()) {
+                    close(fd);
+                    return Result<TtyLink, Error>::err(baud.error());
+                }
+            }
+
+            if (config.low_latency) {
+                set_low_latency(fd, config.device);
+            }
+
             // Flush any pending data
             tcflush(fd, TCIOFLUSH);
 
@@ -169,7 +263,9 @@ namespace wirebit {
         /// Destructor - closes TTY
         inline ~TtyLink() {
             if (fd_ >= 0) {
-                echo::category("wirebit.tty").debug("Closing TTY fd: ", fd_);
+                if constexpr (WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_DEBUG)) {
+                    echo::category("wirebit.tty").debug("Closing TTY fd: ", fd_);
+                }
                 close(fd_);
                 fd_ = -1;
             }
@@ -178,7 +274,9 @@ namespace wirebit {
         /// Move constructor
         inline TtyLink(TtyLink &&other) noexcept
             : fd_(other.fd_), config_(std::move(other.config_)), stats_(other.stats_),
-              rx_buffer_(std::move(other.rx_buffer_)) {
+              rx_buffer_(std::move(other.rx_buffer_)), rx_scratch_(std::move(other.rx_scratch_)),
+              tx_scratch_(std::move(other.tx_scratch_)), pending_(std::move(other.pending_)),
+              decoder_(std::move(other.decoder_)) {
             other.fd_ = -1;
         }
 
@@ -192,6 +290,10 @@ namespace wirebit {
                 config_ = std::move(other.config_);
                 stats_ = other.stats_;
                 rx_buffer_ = std::move(other.rx_buffer_);
+                rx_scratch_ = std::move(other.rx_scratch_);
+                tx_scratch_ = std::move(other.tx_scratch_);
+                pending_ = std::move(other.pending_);
+                decoder_ = std::move(other.decoder_);
                 other.fd_ = -1;
             }
             return *this;
@@ -204,67 +306,111 @@ namespace wirebit {
         /// Send a frame through the TTY
         /// @param frame Frame to send (payload contains raw bytes)
         /// @return Result indicating success or error
-        inline Result<Unit, Error> send(const Frame &frame) override {
+        inline Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Send a borrowed frame through the TTY
+        /// Bytes the TTY cannot take yet are queued and written ahead of the next send (or by
+        /// flush_pending()); the send only fails with timeout once the queue is full.
+        /// @param frame Frame view to send (payload contains raw bytes)
+        /// @return Result indicating success or error
+        inline Result<Unit, Error> send_view(const FrameView &frame) override {
             if (fd_ < 0) {
                 return Result<Unit, Error>::err(Error::io_error("TTY not open"));
             }
 
-            if (frame.payload.empty()) {
+            if (frame.payload.empty() && !config_.framed) {
                 return Result<Unit, Error>::ok(Unit{});
             }
 
-            ssize_t written = write(fd_, frame.payload.data(), frame.payload.size());
-            if (written < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    return Result<Unit, Error>::err(Error::timeout("TTY write would block"));
-                }
-                echo::category("wirebit.tty").error("TTY write failed: ", strerror(errno));
-                stats_.send_errors++;
-                return Result<Unit, Error>::err(Error::io_error("TTY write failed"));
+            if (config_.framed && config_.framing != StreamFraming::Header) {
+                return send_packet(frame);
             }
 
-            stats_.frames_sent++;
-            stats_.bytes_sent += static_cast<uint64_t>(written);
-
-            echo::category("wirebit.tty").trace("TTY sent: ", written, " bytes");
-            return Result<Unit, Error>::ok(Unit{});
+            // Framed mode gathers header, payload and meta; raw mode writes the payload alone
+            FrameHeader header = frame.header;
+            header.payload_len = static_cast<uint32_t>(frame.payload.size());
+            header.meta_len = static_cast<uint32_t>(frame.meta.size());
+            uint32_t crc = 0;
+            bool add_crc = config_.framed && config_.checksum && !(header.flags & FRAME_FLAG_CHECKSUM);
+            if (add_crc) {
+                crc = frame_checksum(frame.payload, frame.meta);
+                header.flags |= FRAME_FLAG_CHECKSUM;
+                header.meta_len += FRAME_CHECKSUM_LEN;
+            }
+            Byte compact[FRAME_HEADER_V2_MAX];
+            struct iovec iov[4] = {
+                {&header, sizeof(FrameHeader)},
+                {const_cast<Byte *>(frame.payload.data()), frame.payload.size()},
+                {const_cast<Byte *>(frame.meta.data()), frame.meta.size()},
+                {&crc, add_crc ? FRAME_CHECKSUM_LEN : 0},
+            };
+            header.version = FRAME_HEADER_V1;
+            if (config_.framed && config_.header_version == FRAME_HEADER_V2) {
+                iov[0] = {compact, encode_frame_header(header, 0, compact)};
+            }
+            const struct iovec *pieces = config_.framed ? iov : iov + 1;
+            int count = config_.framed ? (add_crc ? 4 : (frame.meta.empty() ? 2 : 3)) : 1;
+            size_t total = config_.framed ? iov[0].iov_len + header.payload_len + header.meta_len
+                                          : frame.payload.size();
+            return write_record(pieces, count, total);
         }
 
         /// Receive a frame from the TTY (non-blocking)
         /// @return Result containing frame if data available, or error
         inline Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive a frame from the TTY without allocating (non-blocking)
+        /// The view points into the link's receive buffer and stays valid until the next recv call
+        /// @return Result containing frame view if available, or error
+        inline Result<FrameView, Error> recv_view() override {
             if (fd_ < 0) {
-                return Result<Frame, Error>::err(Error::io_error("TTY not open"));
+                return Result<FrameView, Error>::err(Error::io_error("TTY not open"));
+            }
+
+            if (config_.framed) {
+                return recv_framed();
             }
 
             // Read available data
-            uint8_t buf[1024];
-            ssize_t bytes_read = read(fd_, buf, sizeof(buf));
+            ssize_t bytes_read = read(fd_, rx_scratch_.data(), rx_scratch_.size());
 
             if (bytes_read < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    return Result<Frame, Error>::err(Error::timeout("No data available"));
+                    return Result<FrameView, Error>::err(Error::timeout("No data available"));
                 }
                 echo::category("wirebit.tty").error("TTY read failed: ", strerror(errno));
                 stats_.recv_errors++;
-                return Result<Frame, Error>::err(Error::io_error("TTY read failed"));
+                stats_export_.add(LinkCounter::RecvErrors);
+                return Result<FrameView, Error>::err(Error::io_error("TTY read failed"));
             }
 
             if (bytes_read == 0) {
-                return Result<Frame, Error>::err(Error::timeout("No data available"));
+                return Result<FrameView, Error>::err(Error::timeout("No data available"));
+            }
+
+            size_t min_bytes = std::min(config_.read_min_bytes, rx_scratch_.size());
+            if (static_cast<size_t>(bytes_read) < min_bytes) {
+                bytes_read = static_cast<ssize_t>(coalesce(static_cast<size_t>(bytes_read), min_bytes));
             }
 
             stats_.frames_received++;
             stats_.bytes_received += static_cast<uint64_t>(bytes_read);
+            stats_export_.received(static_cast<uint64_t>(bytes_read));
 
             // Wrap bytes in Frame
-            Bytes payload(static_cast<size_t>(bytes_read));
-            std::memcpy(payload.data(), buf, static_cast<size_t>(bytes_read));
-
-            Frame frame = make_frame(FrameType::SERIAL, std::move(payload), 0, 0);
+            FrameView frame = make_view(FrameType::SERIAL,
+                                        std::span<const Byte>(rx_scratch_.data(), static_cast<size_t>(bytes_read)));
 
-            echo::category("wirebit.tty").trace("TTY recv: ", bytes_read, " bytes");
-            return Result<Frame, Error>::ok(std::move(frame));
+            if constexpr (WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_TRACE)) {
+                echo::category("wirebit.tty").trace("TTY recv: ", bytes_read, " bytes");
+            }
+            return Result<FrameView, Error>::ok(frame);
         }
 
         /// Check if link is ready for sending
@@ -282,9 +428,52 @@ namespace wirebit {
         /// Get file descriptor
         inline int fd() const { return fd_; }
 
+        /// Get file descriptor for readiness polling (see Link::poll_fd())
+        inline int poll_fd() const override { return fd_; }
+
+        /// Write output queued by earlier sends
+        /// Call when fd() polls writable (POLLOUT) while has_pending_output(); send and
+        /// prepare_wait() also flush opportunistically.
+        /// @param timeout_ns How long to wait for the TTY to accept data (0 = don't wait)
+        /// @return Result containing bytes written, or io_error
+        inline Result<size_t, Error> flush_pending(uint64_t timeout_ns = 0) {
+            if (fd_ < 0) {
+                return Result<size_t, Error>::err(Error::io_error("TTY not open"));
+            }
+            uint64_t before = pending_.bytes_written();
+            auto result = pending_.flush(fd_, timeout_ns);
+            uint64_t drained = pending_.bytes_written() - before;
+            stats_.bytes_sent += drained;
+            stats_export_.add(LinkCounter::BytesSent, drained);
+            stats_export_.set(LinkCounter::TxQueuedBytes, pending_.size());
+            stats_export_.set(LinkCounter::TxCapacityBytes, pending_.max_bytes());
+            if (!result.is_ok()) {
+                stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
+            }
+            return result;
+        }
+
+        /// Check if earlier sends left output queued
+        inline bool has_pending_output() const { return !pending_.empty(); }
+
+        /// Get number of queued output bytes
+        inline size_t pending_output() const { return pending_.size(); }
+
+        /// Flush queued output before the caller blocks (see Link::prepare_wait())
+        inline bool prepare_wait() override {
+            if (!pending_.empty()) {
+                flush_pending();
+            }
+            return true;
+        }
+
         /// Get link statistics
         inline const TtyLinkStats &stats() const { return stats_; }
 
+        /// Get framed-mode decoder statistics (resyncs, skipped line noise)
+        inline const StreamDecoderStats &decoder_stats() const { return decoder_.stats(); }
+
         /// Reset statistics
         inline void reset_stats() { stats_.reset(); }
 
@@ -298,15 +487,19 @@ namespace wirebit {
             }
         }
 
-        /// Flush output buffer
+        /// Flush output buffer (discards the pending-output queue too, except the rest of a partly
+        /// written record; see PendingOutput::discard())
         inline void flush_output() {
+            pending_.discard();
             if (fd_ >= 0) {
                 tcflush(fd_, TCOFLUSH);
             }
         }
 
-        /// Flush both input and output buffers
+        /// Flush both input and output buffers (discards the pending-output queue too, except the rest
+        /// of a partly written record)
         inline void flush() {
+            pending_.discard();
             if (fd_ >= 0) {
                 tcflush(fd_, TCIOFLUSH);
             }
@@ -320,15 +513,153 @@ namespace wirebit {
         }
 
       private:
-        int fd_;             ///< TTY file descriptor
-        TtyConfig config_;   ///< Configuration
-        TtyLinkStats stats_; ///< Statistics
-        Bytes rx_buffer_;    ///< Receive buffer (for line buffering if needed)
+        int fd_;                ///< TTY file descriptor
+        TtyConfig config_;      ///< Configuration
+        TtyLinkStats stats_;    ///< Statistics
+        Bytes rx_buffer_;       ///< Receive buffer (for line buffering if needed)
+        Bytes rx_scratch_;      ///< Read buffer backing recv_view()
+        Bytes tx_scratch_;      ///< COBS/SLIP packet being written
+        PendingOutput pending_; ///< Output the TTY has not accepted yet
+        StreamDecoder decoder_; ///< Framed-mode receive buffer and frame decoder
 
         /// Private constructor
-        inline TtyLink(int fd, const TtyConfig &config) : fd_(fd), config_(config) {}
+        inline TtyLink(int fd, const TtyConfig &config)
+            : fd_(fd), config_(config), rx_scratch_(std::max<size_t>(config.read_buffer_size, 1)),
+              pending_(config.max_pending_bytes),
+              decoder_(1 << 20, config.framing, config.compact_header, config.checksum) {}
+
+        /// Helper: Send a frame as one COBS/SLIP packet
+        inline Result<Unit, Error> send_packet(const FrameView &frame) {
+            tx_scratch_.resize(max_packet_size(config_.framing, frame.payload.size()));
+            size_t total =
+                encode_packet(frame, config_.framing, config_.compact_header, config_.checksum, tx_scratch_.data());
+            struct iovec iov = {tx_scratch_.data(), total};
+            return write_record(&iov, 1, total);
+        }
+
+        /// Helper: Write one record (raw bytes, a frame or a packet) through the pending queue
+        inline Result<Unit, Error> write_record(const struct iovec *pieces, int count, size_t total) {
+            uint64_t before = pending_.bytes_written();
+            auto result = pending_.write(fd_, pieces, count);
+            uint64_t drained = pending_.bytes_written() - before;
+            stats_.bytes_sent += drained;
+            stats_export_.add(LinkCounter::BytesSent, drained);
+            stats_export_.set(LinkCounter::TxQueuedBytes, pending_.size());
+            stats_export_.set(LinkCounter::TxCapacityBytes, pending_.max_bytes());
+            if (!result.is_ok()) {
+                if (result.error().code == Error::timeout("").code) {
+                    return Result<Unit, Error>::err(Error::timeout("TTY write would block"));
+                }
+                echo::category("wirebit.tty").error("TTY write failed: ", result.error().message.c_str());
+                stats_.send_errors++;
+                stats_export_.add(LinkCounter::SendErrors);
+                return Result<Unit, Error>::err(Error::io_error("TTY write failed"));
+            }
+            size_t written = result.value();
+
+            stats_.frames_sent++;
+            stats_export_.add(LinkCounter::FramesSent);
+            stats_.bytes_queued += total - written;
+
+            if constexpr (WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_TRACE)) {
+                echo::category("wirebit.tty").trace("TTY sent: ", written, " bytes");
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Receive in framed mode (all frames from one read are handed out before reading again)
+        inline Result<FrameView, Error> recv_framed() {
+            FrameView frame;
+            if (!decoder_.next(frame)) {
+                std::span<Byte> space = decoder_.write_space(rx_scratch_.size());
+                ssize_t bytes_read = read(fd_, space.data(), space.size());
+                if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    echo::category("wirebit.tty").error("TTY read failed: ", strerror(errno));
+                    stats_.recv_errors++;
+                    stats_export_.add(LinkCounter::RecvErrors);
+                    return Result<FrameView, Error>::err(Error::io_error("TTY read failed"));
+                }
+                if (bytes_read > 0) {
+                    decoder_.commit(static_cast<size_t>(bytes_read));
+                    stats_.bytes_received += static_cast<uint64_t>(bytes_read);
+                    stats_export_.add(LinkCounter::BytesReceived, static_cast<uint64_t>(bytes_read));
+                }
+                if (!decoder_.next(frame)) {
+                    return Result<FrameView, Error>::err(Error::timeout("No frames available"));
+                }
+            }
+
+            stats_.frames_received++;
+            stats_export_.add(LinkCounter::FramesReceived);
+            if constexpr (WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_TRACE)) {
+                echo::category("wirebit.tty").trace("TTY recv frame: ", frame.payload.size(), " payload bytes");
+            }
+            return Result<FrameView, Error>::ok(frame);
+        }
+
+        /// Keep reading into rx_scratch_ until min_bytes are there or the line goes idle
+        /// @param have Bytes already read
+        /// @param min_bytes Bytes to gather
+        /// @return Bytes in rx_scratch_
+        inline size_t coalesce(size_t have, size_t min_bytes) {
+            const struct timespec gap = {static_cast<time_t>(config_.read_gap_us / 1000000),
+                                         static_cast<long>(config_.read_gap_us % 1000000) * 1000};
+            while (have < min_bytes) {
+                struct pollfd pfd = {fd_, POLLIN, 0};
+                if (ppoll(&pfd, 1, &gap, nullptr) <= 0) {
+                    break; // Line idle for the inter-byte gap
+                }
+                ssize_t n = read(fd_, rx_scratch_.data() + have, rx_scratch_.size() - have);
+                if (n <= 0) {
+                    break;
+                }
+                have += static_cast<size_t>(n);
+            }
+            return have;
+        }
+
+        /// Set a baud rate without a Bxxxx constant through termios2/BOTHER
+        /// @param fd TTY file descriptor
+        /// @param baud Baud rate
+        /// @return Result indicating success, or io_error if the driver refuses the rate
+        static inline Result<Unit, Error> set_custom_baud(int fd, uint32_t baud) {
+            detail::KernelTermios2 tio;
+            if (ioctl(fd, detail::TTY_TCGETS2, &tio) != 0) {
+                echo::category("wirebit.tty").error("TCGETS2 failed: ", strerror(errno));
+                return Result<Unit, Error>::err(Error::io_error("Failed to get TTY attributes"));
+            }
+            tio.c_cflag &= ~detail::TTY_CBAUD;
+            tio.c_cflag |= detail::TTY_BOTHER;
+            tio.c_ispeed = baud;
+            tio.c_ospeed = baud;
+            if (ioctl(fd, detail::TTY_TCSETS2, &tio) != 0 || ioctl(fd, detail::TTY_TCGETS2, &tio) != 0) {
+                echo::category("wirebit.tty").error("Failed to set ", baud, " baud: ", strerror(errno));
+                return Result<Unit, Error>::err(Error::io_error("Failed to set custom baud rate"));
+            }
+            if (tio.c_ospeed != baud) {
+                // The UART divisor only gets close: report what the line actually runs at
+                echo::category("wirebit.tty").warn("Requested ", baud, " baud, driver set ", tio.c_ospeed);
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Ask the driver to push received bytes to the TTY layer at once (ASYNC_LOW_LATENCY)
+        /// @param fd TTY file descriptor
+        /// @param device Device path (for the log)
+        static inline void set_low_latency(int fd, const String &device) {
+            struct serial_struct serial;
+            if (ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+                echo::category("wirebit.tty").warn(device.c_str(), ": low latency not supported: ", strerror(errno));
+                return;
+            }
+            serial.flags |= ASYNC_LOW_LATENCY;
+            if (ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+                echo::category("wirebit.tty").warn(device.c_str(), ": failed to set low latency: ", strerror(errno));
+            }
+        }
 
         /// Convert baud rate to termios speed constant
+        /// @return Speed constant, or B0 if the rate has none (set through termios2/BOTHER instead)
         static inline speed_t baud_to_speed(uint32_t baud) {
             switch (baud) {
             case 50:
@@ -392,8 +723,7 @@ namespace wirebit {
             case 4000000:
                 return B4000000;
             default:
-                echo::category("wirebit.tty").warn("Unknown baud rate ", baud, ", using 115200");
-                return B115200;
+                return B0;
             }
         }
     };
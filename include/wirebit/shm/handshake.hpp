@@ -6,26 +6,97 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <wirebit/common/log.hpp>
 #include <wirebit/common/types.hpp>
 
 namespace wirebit {
 
     /// Eventfd pair for bidirectional communication
+    /// The space eventfds let a sender block until the receiver has made room in the ring; they are
+    /// -1 when the peer only sent the data pair.
     struct EventfdPair {
-        int a2b; ///< Eventfd for A→B direction
-        int b2a; ///< Eventfd for B→A direction
+        int a2b;            ///< Eventfd for A→B direction
+        int b2a;            ///< Eventfd for B→A direction
+        int space_a2b = -1; ///< Signalled by B after freeing space in the A→B ring
+        int space_b2a = -1; ///< Signalled by A after freeing space in the B→A ring
 
         EventfdPair() : a2b(-1), b2a(-1) {}
         EventfdPair(int a, int b) : a2b(a), b2a(b) {}
+        EventfdPair(int a, int b, int space_a, int space_b) : a2b(a), b2a(b), space_a2b(space_a), space_b2a(space_b) {}
+
+        /// Close every valid eventfd
+        inline void close_all() const {
+            for (int fd : {a2b, b2a, space_a2b, space_b2a}) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+        }
     };
 
+    /// Number of eventfds exchanged per link (data and space eventfd per direction)
+    constexpr size_t EVENTFD_SET_SIZE = 4;
+
+    /// Create the eventfds of one link
+    /// @param flags Extra eventfd() flags (EFD_SEMAPHORE | EFD_NONBLOCK are always set)
+    /// @return Result containing all four eventfds, or error
+    inline Result<EventfdPair, Error> create_eventfds(int flags = 0) {
+        int fds[EVENTFD_SET_SIZE];
+        for (size_t i = 0; i < EVENTFD_SET_SIZE; ++i) {
+            fds[i] = ::eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | flags);
+            if (fds[i] < 0) {
+                echo::error("Failed to create eventfd: ", strerror(errno)).red();
+                for (size_t j = 0; j < i; ++j) {
+                    ::close(fds[j]);
+                }
+                return Result<EventfdPair, Error>::err(Error::io_error("eventfd() failed"));
+            }
+        }
+        return Result<EventfdPair, Error>::ok(EventfdPair{fds[0], fds[1], fds[2], fds[3]});
+    }
+
+    /// Read the eventfds carried by one SCM_RIGHTS message (the data pair, optionally the space pair)
+    /// Eventfds beyond the expected ones are closed.
+    /// @param msg Received message
+    /// @param fds Set to the received eventfds
+    /// @return true if at least the data pair was received
+    inline bool take_eventfds(struct msghdr &msg, EventfdPair &fds) {
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            return false;
+        }
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        int received[EVENTFD_SET_SIZE] = {-1, -1, -1, -1};
+        for (size_t i = 0; i < count; ++i) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (i < EVENTFD_SET_SIZE) {
+                received[i] = fd;
+            } else {
+                ::close(fd);
+            }
+        }
+        fds = EventfdPair{received[0], received[1], received[2], received[3]};
+        if (count < 2) {
+            fds.close_all();
+            fds = EventfdPair{};
+            return false;
+        }
+        return true;
+    }
+
+    /// Get the Unix socket path used to exchange eventfds for a link
+    /// @param name Link name
+    /// @return Socket path
+    inline String eventfd_socket_path(const String &name) { return "/tmp/wirebit_" + name + ".sock"; }
+
     /// Create eventfd pair and send via Unix socket
     /// @param name Link name (used for socket path)
     /// @return Result containing EventfdPair or error
     inline Result<EventfdPair, Error> create_and_send_eventfds(const String &name) {
-        echo::trace("Creating eventfds for: ", name.c_str());
+        WIREBIT_TRACE("Creating eventfds for: ", name.c_str());
 
-        String sock_path = "/tmp/wirebit_" + name + ".sock";
+        String sock_path = eventfd_socket_path(name);
 
         // Remove existing socket
         ::unlink(sock_path.c_str());
@@ -56,34 +127,25 @@ namespace wirebit {
         }
 
         // Create eventfds
-        int efd_a2b = ::eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK);
-        if (efd_a2b < 0) {
-            echo::error("Failed to create eventfd A→B: ", strerror(errno)).red();
+        auto created = create_eventfds();
+        if (!created.is_ok()) {
             ::close(sock_fd);
-            return Result<EventfdPair, Error>::err(Error::io_error("eventfd() failed"));
+            return Result<EventfdPair, Error>::err(created.error());
         }
+        EventfdPair efds = created.value();
 
-        int efd_b2a = ::eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK);
-        if (efd_b2a < 0) {
-            echo::error("Failed to create eventfd B→A: ", strerror(errno)).red();
-            ::close(efd_a2b);
-            ::close(sock_fd);
-            return Result<EventfdPair, Error>::err(Error::io_error("eventfd() failed"));
-        }
-
-        echo::debug("Waiting for client connection...");
+        WIREBIT_DEBUG("Waiting for client connection...");
 
         // Accept connection
         int client_fd = ::accept(sock_fd, nullptr, nullptr);
         if (client_fd < 0) {
             echo::error("Failed to accept: ", strerror(errno)).red();
-            ::close(efd_b2a);
-            ::close(efd_a2b);
+            efds.close_all();
             ::close(sock_fd);
             return Result<EventfdPair, Error>::err(Error::io_error("accept() failed"));
         }
 
-        echo::debug("Client connected, sending eventfds...");
+        WIREBIT_DEBUG("Client connected, sending eventfds...");
 
         // Send eventfds via SCM_RIGHTS
         struct msghdr msg = {};
@@ -92,23 +154,22 @@ namespace wirebit {
         msg.msg_iov = &iov;
         msg.msg_iovlen = 1;
 
-        char cmsg_buf[CMSG_SPACE(sizeof(int) * 2)];
+        char cmsg_buf[CMSG_SPACE(sizeof(int) * EVENTFD_SET_SIZE)];
         msg.msg_control = cmsg_buf;
         msg.msg_controllen = sizeof(cmsg_buf);
 
         struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
         cmsg->cmsg_level = SOL_SOCKET;
         cmsg->cmsg_type = SCM_RIGHTS;
-        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * 2);
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * EVENTFD_SET_SIZE);
 
-        int fds[2] = {efd_a2b, efd_b2a};
+        int fds[EVENTFD_SET_SIZE] = {efds.a2b, efds.b2a, efds.space_a2b, efds.space_b2a};
         memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
 
         if (::sendmsg(client_fd, &msg, 0) < 0) {
             echo::error("Failed to send eventfds: ", strerror(errno)).red();
             ::close(client_fd);
-            ::close(efd_b2a);
-            ::close(efd_a2b);
+            efds.close_all();
             ::close(sock_fd);
             return Result<EventfdPair, Error>::err(Error::io_error("sendmsg() failed"));
         }
@@ -117,18 +178,18 @@ namespace wirebit {
         ::close(sock_fd);
         ::unlink(sock_path.c_str());
 
-        echo::trace("Eventfds created and sent: A→B=", efd_a2b, ", B→A=", efd_b2a).green();
+        WIREBIT_TRACE("Eventfds created and sent: A→B=", efds.a2b, ", B→A=", efds.b2a).green();
 
-        return Result<EventfdPair, Error>::ok(EventfdPair{efd_a2b, efd_b2a});
+        return Result<EventfdPair, Error>::ok(efds);
     }
 
     /// Receive eventfd pair via Unix socket
     /// @param name Link name (used for socket path)
     /// @return Result containing EventfdPair or error
     inline Result<EventfdPair, Error> receive_eventfds(const String &name) {
-        echo::trace("Receiving eventfds for: ", name.c_str());
+        WIREBIT_TRACE("Receiving eventfds for: ", name.c_str());
 
-        String sock_path = "/tmp/wirebit_" + name + ".sock";
+        String sock_path = eventfd_socket_path(name);
 
         // Create Unix domain socket
         int sock_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
@@ -148,7 +209,7 @@ namespace wirebit {
             return Result<EventfdPair, Error>::err(Error::io_error("connect() failed"));
         }
 
-        echo::debug("Connected, receiving eventfds...");
+        WIREBIT_DEBUG("Connected, receiving eventfds...");
 
         // Receive eventfds via SCM_RIGHTS
         struct msghdr msg = {};
@@ -157,7 +218,7 @@ namespace wirebit {
         msg.msg_iov = &iov;
         msg.msg_iovlen = 1;
 
-        char cmsg_buf[CMSG_SPACE(sizeof(int) * 2)];
+        char cmsg_buf[CMSG_SPACE(sizeof(int) * EVENTFD_SET_SIZE)];
         msg.msg_control = cmsg_buf;
         msg.msg_controllen = sizeof(cmsg_buf);
 
@@ -168,27 +229,24 @@ namespace wirebit {
             return Result<EventfdPair, Error>::err(Error::io_error("recvmsg() failed"));
         }
 
-        // Extract eventfds
-        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
-        if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS) {
+        // Extract eventfds (peers that predate the space eventfds send only the data pair)
+        EventfdPair fds;
+        if (!take_eventfds(msg, fds)) {
             echo::error("No file descriptors received").red();
             ::close(sock_fd);
             return Result<EventfdPair, Error>::err(Error::io_error("No FDs received"));
         }
 
-        int fds[2];
-        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
-
         ::close(sock_fd);
 
-        echo::trace("Eventfds received: A→B=", fds[0], ", B→A=", fds[1]).green();
+        WIREBIT_TRACE("Eventfds received: A→B=", fds.a2b, ", B→A=", fds.b2a).green();
 
-        return Result<EventfdPair, Error>::ok(EventfdPair{fds[0], fds[1]});
+        return Result<EventfdPair, Error>::ok(fds);
     }
 
     /// Notify eventfd (write 1 to wake up waiting consumers)
     inline Result<Unit, Error> notify_eventfd(int eventfd) {
-        echo::trace("Notifying eventfd: ", eventfd);
+        WIREBIT_TRACE("Notifying eventfd: ", eventfd);
 
         uint64_t val = 1;
         ssize_t n = ::write(eventfd, &val, sizeof(val));
@@ -209,13 +267,13 @@ namespace wirebit {
     /// @param timeout_ms Timeout in milliseconds (-1 = infinite)
     /// @return Result indicating success or timeout/error
     inline Result<Unit, Error> wait_eventfd(int eventfd, int timeout_ms = -1) {
-        echo::trace("Waiting on eventfd: ", eventfd, " (timeout: ", timeout_ms, " ms)");
+        WIREBIT_TRACE("Waiting on eventfd: ", eventfd, " (timeout: ", timeout_ms, " ms)");
 
         struct pollfd pfd = {eventfd, POLLIN, 0};
         int ret = ::poll(&pfd, 1, timeout_ms);
 
         if (ret == 0) {
-            echo::trace("Eventfd wait timeout");
+            WIREBIT_TRACE("Eventfd wait timeout");
             return Result<Unit, Error>::err(Error::timeout("poll timeout"));
         }
 
@@ -236,7 +294,7 @@ namespace wirebit {
             return Result<Unit, Error>::err(Error::io_error("eventfd read failed"));
         }
 
-        echo::trace("Eventfd signaled, value: ", val);
+        WIREBIT_TRACE("Eventfd signaled, value: ", val);
         return Result<Unit, Error>::ok(Unit{});
     }
 
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Backing page size for a shared memory segment
+    enum class ShmHugePages : uint8_t {
+        None = 0,        ///< Regular pages from POSIX shm (/dev/shm)
+        Transparent = 1, ///< POSIX shm with madvise(MADV_HUGEPAGE) (needs shmem_enabled=advise or within_size)
+        Hugetlbfs = 2,   ///< File on a hugetlbfs mount, sized to whole huge pages
+    };
+
+    /// Placement options for a shared memory segment
+    /// Everything here is best effort: an option the host cannot honour (no hugetlbfs mount, no free
+    /// huge pages, RLIMIT_MEMLOCK too low, no NUMA support) is logged and skipped, and ShmMemoryInfo
+    /// reports what was actually applied.
+    struct ShmMemoryOptions {
+        ShmHugePages huge_pages = ShmHugePages::None; ///< Page size of the backing memory
+        String hugetlbfs_dir = "/dev/hugepages";      ///< hugetlbfs mount for ShmHugePages::Hugetlbfs
+        bool lock = false;                            ///< mlock() the mapping (faults it in, never swapped)
+        bool prefault = false;                        ///< Touch every page up front (implied by lock)
+        int numa_node = -1;                           ///< Preferred NUMA node (-1 = none, SHM_NUMA_LOCAL)
+    };
+
+    /// ShmMemoryOptions::numa_node value selecting the node of the calling thread
+    inline constexpr int SHM_NUMA_LOCAL = -2;
+
+    /// What was applied to a mapped segment
+    struct ShmMemoryInfo {
+        bool huge_pages = false; ///< Backed by hugetlbfs, or MADV_HUGEPAGE was accepted
+        bool hugetlbfs = false;  ///< Segment is a hugetlbfs file (unlinked with unlink(), not shm_unlink())
+        bool locked = false;     ///< mlock() succeeded
+        bool prefaulted = false; ///< All pages were faulted in at map time
+        int numa_node = -1;      ///< Node the memory policy prefers (-1 = default policy)
+        size_t page_size = 0;    ///< Backing page size in bytes
+    };
+
+    namespace detail {
+        constexpr int SHM_MPOL_PREFERRED = 1;          ///< MPOL_PREFERRED from linux/mempolicy.h
+        constexpr unsigned SHM_MPOL_MF_MOVE = 1u << 1; ///< MPOL_MF_MOVE from linux/mempolicy.h
+        constexpr size_t SHM_MAX_NUMA_NODES = 1024;    ///< Node mask size passed to mbind()
+
+        /// Get the path of a hugetlbfs-backed segment
+        /// @param dir hugetlbfs mount point
+        /// @param shm_name Segment name (leading '/' as for shm_open())
+        /// @return File path
+        inline String hugetlbfs_path(const String &dir, const String &shm_name) {
+            const char *base = shm_name.c_str();
+            while (*base == '/') {
+                ++base;
+            }
+            char buf[512];
+            snprintf(buf, sizeof(buf), "%s/%s", dir.c_str(), base);
+            return String(buf);
+        }
+
+        /// Get the page size of the file system holding fd (huge page size on hugetlbfs)
+        inline size_t fd_page_size(int fd) {
+            struct statfs fs;
+            if (::fstatfs(fd, &fs) == 0 && fs.f_bsize > 0) {
+                return static_cast<size_t>(fs.f_bsize);
+            }
+            return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        }
+
+        /// Open or create a segment file according to the options
+        /// Falls back to POSIX shm when hugetlbfs is requested but unusable.
+        /// @param shm_name Segment name
+        /// @param options Placement options
+        /// @param create True to create the segment (O_CREAT)
+        /// @param info Set to hugetlbfs/page_size of the opened file
+        /// @param exclusive Fail with EEXIST if the segment exists (O_EXCL, with create)
+        /// @return File descriptor, or -1 with errno set
+        inline int open_segment(const String &shm_name, const ShmMemoryOptions &options, bool create,
+                                ShmMemoryInfo &info, bool exclusive = false) {
+            int flags = O_RDWR | (create ? O_CREAT : 0) | (create && exclusive ? O_EXCL : 0);
+            if (options.huge_pages == ShmHugePages::Hugetlbfs) {
+                String path = hugetlbfs_path(options.hugetlbfs_dir, shm_name);
+                int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0666);
+                if (fd >= 0) {
+                    info.hugetlbfs = true;
+                    info.huge_pages = true;
+                    info.page_size = fd_page_size(fd);
+                    return fd;
+                }
+                if (errno == EEXIST) {
+                    return -1;
+                }
+                if (create) {
+                    echo::warn("hugetlbfs segment ", path.c_str(), " unavailable (", strerror(errno),
+                               "), using regular shared memory")
+                        .yellow();
+                }
+            }
+            int fd = shm_open(shm_name.c_str(), flags, 0666);
+            if (fd >= 0) {
+                info.page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            }
+            return fd;
+        }
+
+        /// Remove a segment created by open_segment()
+        inline void unlink_segment(const String &shm_name, const String &hugetlbfs_dir, bool hugetlbfs) {
+            if (hugetlbfs) {
+                ::unlink(hugetlbfs_path(hugetlbfs_dir, shm_name).c_str());
+            } else {
+                shm_unlink(shm_name.c_str());
+            }
+        }
+
+        /// Round a mapping size up to whole backing pages
+        inline size_t round_to_page(size_t size, size_t page_size) {
+            return page_size == 0 ? size : (size + page_size - 1) / page_size * page_size;
+        }
+
+        /// Get the NUMA node of the calling thread
+        /// @return Node number, or -1 if it cannot be determined
+        inline int current_numa_node() {
+#ifdef SYS_getcpu
+            unsigned cpu = 0;
+            unsigned node = 0;
+            if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+                return static_cast<int>(node);
+            }
+#endif
+            return -1;
+        }
+
+        /// Apply placement options to a fresh mapping: NUMA policy first, then huge page advice, then
+        /// locking or prefaulting, so the first touch already lands on the right node and page size
+        /// @param mem Mapping start (page aligned)
+        /// @param size Mapping size
+        /// @param options Placement options
+        /// @param creator True if the segment is new (pages are written to fault them in)
+        /// @param info Updated with what was applied
+        inline void place_segment(void *mem, size_t size, const ShmMemoryOptions &options, bool creator,
+                                  ShmMemoryInfo &info) {
+            int node = options.numa_node == SHM_NUMA_LOCAL ? current_numa_node() : options.numa_node;
+            if (node >= 0) {
+#ifdef SYS_mbind
+                constexpr size_t BITS = 8 * sizeof(unsigned long);
+                unsigned long mask[SHM_MAX_NUMA_NODES / BITS] = {};
+                if (static_cast<size_t>(node) < SHM_MAX_NUMA_NODES) {
+                    mask[static_cast<size_t>(node) / BITS] |= 1UL << (static_cast<size_t>(node) % BITS);
+                    long ret = ::syscall(SYS_mbind, mem, size, SHM_MPOL_PREFERRED, mask, SHM_MAX_NUMA_NODES,
+                                         SHM_MPOL_MF_MOVE);
+                    if (ret == 0) {
+                        info.numa_node = node;
+                    } else {
+                        echo::warn("mbind() to NUMA node ", node, " failed: ", strerror(errno)).yellow();
+                    }
+                }
+#endif
+            }
+
+            if (options.huge_pages == ShmHugePages::Transparent && !info.hugetlbfs) {
+#ifdef MADV_HUGEPAGE
+                if (::madvise(mem, size, MADV_HUGEPAGE) == 0) {
+                    info.huge_pages = true;
+                } else {
+                    echo::warn("madvise(MADV_HUGEPAGE) failed: ", strerror(errno)).yellow();
+                }
+#endif
+            }
+
+            if (options.lock) {
+                if (::mlock(mem, size) == 0) {
+                    info.locked = true;
+                    info.prefaulted = true;
+                } else {
+                    echo::warn("mlock() of ", size, " bytes failed: ", strerror(errno), " (check RLIMIT_MEMLOCK)")
+                        .yellow();
+                }
+            }
+
+            if ((options.prefault || options.lock) && !info.prefaulted) {
+#ifdef MADV_POPULATE_WRITE
+                info.prefaulted = ::madvise(mem, size, MADV_POPULATE_WRITE) == 0;
+#endif
+                if (!info.prefaulted) {
+                    // A new segment is still private to us and can be written; an attached one is
+                    // live, so its pages are only read
+                    auto *bytes = static_cast<volatile Byte *>(mem);
+                    size_t step = info.page_size != 0 ? info.page_size : 4096;
+                    for (size_t off = 0; off < size; off += step) {
+                        if (creator) {
+                            bytes[off] = 0;
+                        } else {
+                            (void)bytes[off];
+                        }
+                    }
+                    info.prefaulted = true;
+                }
+            }
+            WIREBIT_DEBUG("SHM segment placed: huge=", info.huge_pages, " locked=", info.locked,
+                          " node=", info.numa_node, " page=", info.page_size);
+        }
+    } // namespace detail
+
+} // namespace wirebit
@@ -1,177 +1,580 @@
 #pragma once
 
-#include <datapod/pods/lockfree/ring_buffer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <echo/echo.hpp>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
 #include <wirebit/frame.hpp>
+#include <wirebit/frame_pool.hpp>
+#include <wirebit/histogram.hpp>
+#include <wirebit/shm/memory.hpp>
 
 namespace wirebit {
 
-    /// Wrapper around datapod::RingBuffer for frame encoding/decoding
-    /// This class provides frame-level operations on top of the byte-level SPSC ring buffer
+    namespace detail {
+        constexpr uint64_t RING_MAGIC = 0x474E495254494257ULL; ///< 'WBITRING' (little endian)
+        constexpr size_t RING_CACHE_LINE = 64;                 ///< Cache line size for index separation
+        constexpr uint32_t RING_WRAP_MARKER = 0xFFFFFFFF;      ///< Record length marking a skipped ring tail
+
+        /// Control block placed at the start of every ring segment
+        /// Head and tail are monotonically increasing byte counters on separate cache lines,
+        /// so producer and consumer never write the same line.
+        struct RingControl {
+            uint64_t magic;                                      ///< RING_MAGIC once initialized
+            uint64_t capacity;                                   ///< Data region size in bytes
+            uint64_t time_base_ns;                               ///< Time base of v2 record headers
+            uint16_t header_version;                             ///< Record header format (0 = FRAME_HEADER_V1)
+            alignas(RING_CACHE_LINE) std::atomic<uint64_t> head; ///< Bytes written (owned by producer)
+            std::atomic<uint64_t> producer_wait_bytes;           ///< Free bytes a blocked producer waits for
+            alignas(RING_CACHE_LINE) std::atomic<uint64_t> tail; ///< Bytes read (owned by consumer)
+            std::atomic<uint32_t> consumer_waiting;              ///< Non-zero while the consumer is blocked
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring indices must be lock-free for SHM use");
+        static_assert(sizeof(RingControl) % RING_CACHE_LINE == 0, "Ring data must start on a cache line");
+    } // namespace detail
+
+    /// SPSC frame ring over a contiguous byte region (heap or shared memory)
+    /// Records are written in place and published with a single release store of the head index,
+    /// so the consumer never observes a partial record. Records are always contiguous in memory,
+    /// which allows zero-copy reserve()/commit() on the producer and peek()/consume() on the consumer.
     /// Frame format: [u32 record_len][serialized frame][padding to 8B alignment]
+    /// Capacity is rounded up to a multiple of 8 bytes.
+    ///
+    /// The creator picks the header format of the records it writes and stores it in the control
+    /// block, where an attaching process picks it up. Both formats are always accepted on read, so
+    /// reserve() writers may keep writing a FrameHeader into a FRAME_HEADER_V2 ring. With v2 a CAN
+    /// record shrinks from 64 to 40 bytes.
     class FrameRing {
       public:
         /// Create a new frame ring with specified capacity
         /// @param capacity_bytes Total capacity in bytes
-        static Result<FrameRing, Error> create(size_t capacity_bytes) {
-            echo::debug("Creating FrameRing with capacity: ", capacity_bytes, " bytes");
-            return Result<FrameRing, Error>::ok(FrameRing(capacity_bytes));
+        /// @param header_version Header format written by push_frame()/push_batch() (FRAME_HEADER_V1/V2)
+        static Result<FrameRing, Error> create(size_t capacity_bytes, uint16_t header_version = FRAME_HEADER_V1) {
+            WIREBIT_DEBUG("Creating FrameRing with capacity: ", capacity_bytes, " bytes");
+
+            if (capacity_bytes == 0) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Ring capacity must be non-zero"));
+            }
+            if (header_version != FRAME_HEADER_V1 && header_version != FRAME_HEADER_V2) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Unsupported frame header version"));
+            }
+            capacity_bytes = (capacity_bytes + 7) & ~size_t(7);
+
+            size_t map_size = segment_size(capacity_bytes);
+            void *mem = std::aligned_alloc(detail::RING_CACHE_LINE, map_size);
+            if (mem == nullptr) {
+                echo::error("Failed to allocate ring: ", map_size, " bytes").red();
+                return Result<FrameRing, Error>::err(Error::io_error("Failed to allocate ring memory"));
+            }
+
+            FrameRing ring(init_control(mem, capacity_bytes, header_version), map_size, String(), false, false);
+            return Result<FrameRing, Error>::ok(std::move(ring));
         }
 
         /// Create a new frame ring in shared memory
         /// @param shm_name Shared memory name (must start with '/')
         /// @param capacity_bytes Total capacity in bytes
-        static Result<FrameRing, Error> create_shm(const String &shm_name, size_t capacity_bytes) {
-            echo::debug("Creating FrameRing in SHM: ", shm_name.c_str(), " (capacity: ", capacity_bytes, " bytes)");
+        /// @param memory Backing memory placement (huge pages, locking, NUMA node); see memory_info()
+        /// @param header_version Header format of the records written to this ring, adopted by attach_shm()
+        static Result<FrameRing, Error> create_shm(const String &shm_name, size_t capacity_bytes,
+                                                   const ShmMemoryOptions &memory = ShmMemoryOptions{},
+                                                   uint16_t header_version = FRAME_HEADER_V1) {
+            WIREBIT_DEBUG("Creating FrameRing in SHM: ", shm_name.c_str(), " (capacity: ", capacity_bytes, " bytes)");
+
+            if (capacity_bytes == 0) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Ring capacity must be non-zero"));
+            }
+            if (header_version != FRAME_HEADER_V1 && header_version != FRAME_HEADER_V2) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Unsupported frame header version"));
+            }
+            capacity_bytes = (capacity_bytes + 7) & ~size_t(7);
 
-            auto ring_result = datapod::RingBuffer<datapod::SPSC, Byte>::create_shm(shm_name, capacity_bytes);
-            if (!ring_result.is_ok()) {
-                echo::error("Failed to create SHM ring: ", ring_result.error().message.c_str()).red();
-                return Result<FrameRing, Error>::err(ring_result.error());
+            ShmMemoryInfo info;
+            int fd = detail::open_segment(shm_name, memory, true, info);
+            if (fd < 0) {
+                echo::error("Failed to create SHM ring ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<FrameRing, Error>::err(Error::io_error("shm_open() failed"));
             }
 
-            echo::debug("FrameRing SHM created successfully").green();
-            return Result<FrameRing, Error>::ok(FrameRing(std::move(ring_result.value())));
+            // hugetlbfs only maps whole huge pages
+            size_t map_size = detail::round_to_page(segment_size(capacity_bytes), info.page_size);
+            if (ftruncate(fd, static_cast<off_t>(map_size)) < 0) {
+                echo::error("Failed to size SHM ring ", shm_name.c_str(), ": ", strerror(errno)).red();
+                close(fd);
+                detail::unlink_segment(shm_name, memory.hugetlbfs_dir, info.hugetlbfs);
+                return Result<FrameRing, Error>::err(Error::io_error("ftruncate() failed"));
+            }
+
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map SHM ring ", shm_name.c_str(), ": ", strerror(errno)).red();
+                detail::unlink_segment(shm_name, memory.hugetlbfs_dir, info.hugetlbfs);
+                return Result<FrameRing, Error>::err(Error::io_error("mmap() failed"));
+            }
+            detail::place_segment(mem, map_size, memory, true, info);
+
+            WIREBIT_DEBUG("FrameRing SHM created successfully").green();
+            FrameRing ring(init_control(mem, capacity_bytes, header_version), map_size, shm_name, true, true);
+            ring.memory_ = info;
+            ring.hugetlbfs_dir_ = memory.hugetlbfs_dir;
+            return Result<FrameRing, Error>::ok(std::move(ring));
         }
 
         /// Attach to an existing frame ring in shared memory
+        /// With ShmHugePages::Hugetlbfs the ring is looked up on the hugetlbfs mount first, then in
+        /// POSIX shm (where the creator falls back to). Locking, prefaulting and the NUMA node apply to
+        /// this process's mapping.
         /// @param shm_name Shared memory name (must start with '/')
-        static Result<FrameRing, Error> attach_shm(const String &shm_name) {
-            echo::debug("Attaching to FrameRing SHM: ", shm_name.c_str());
+        /// @param memory Backing memory placement
+        static Result<FrameRing, Error> attach_shm(const String &shm_name,
+                                                   const ShmMemoryOptions &memory = ShmMemoryOptions{}) {
+            WIREBIT_DEBUG("Attaching to FrameRing SHM: ", shm_name.c_str());
+
+            ShmMemoryInfo info;
+            int fd = detail::open_segment(shm_name, memory, false, info);
+            if (fd < 0) {
+                echo::error("Failed to attach to SHM ring ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<FrameRing, Error>::err(Error::not_found("SHM ring does not exist"));
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(detail::RingControl)) {
+                echo::error("SHM ring ", shm_name.c_str(), " has invalid size").red();
+                close(fd);
+                return Result<FrameRing, Error>::err(Error::io_error("SHM ring has invalid size"));
+            }
 
-            auto ring_result = datapod::RingBuffer<datapod::SPSC, Byte>::attach_shm(shm_name);
-            if (!ring_result.is_ok()) {
-                echo::error("Failed to attach to SHM ring: ", ring_result.error().message.c_str()).red();
-                return Result<FrameRing, Error>::err(ring_result.error());
+            size_t map_size = static_cast<size_t>(st.st_size);
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map SHM ring ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<FrameRing, Error>::err(Error::io_error("mmap() failed"));
             }
 
-            echo::debug("FrameRing SHM attached successfully").green();
-            return Result<FrameRing, Error>::ok(FrameRing(std::move(ring_result.value())));
+            auto *ctl = static_cast<detail::RingControl *>(mem);
+            if (ctl->magic != detail::RING_MAGIC || ctl->capacity == 0 || (ctl->capacity & 7) != 0 ||
+                segment_size(ctl->capacity) > map_size || ctl->header_version > FRAME_HEADER_V2) {
+                echo::error("SHM ring ", shm_name.c_str(), " is not an initialized FrameRing").red();
+                munmap(mem, map_size);
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Invalid SHM ring header"));
+            }
+            detail::place_segment(mem, map_size, memory, false, info);
+
+            WIREBIT_DEBUG("FrameRing SHM attached successfully").green();
+            FrameRing ring(ctl, map_size, shm_name, true, false);
+            ring.memory_ = info;
+            ring.hugetlbfs_dir_ = memory.hugetlbfs_dir;
+            return Result<FrameRing, Error>::ok(std::move(ring));
         }
 
-        /// Push a frame into the ring buffer
-        /// Frame format: [u32 record_len][serialized frame][padding to 8B alignment]
-        /// @param frame Frame to push
-        /// @return Result indicating success or error
-        Result<Unit, Error> push_frame(const Frame &frame) {
-            echo::trace("FrameRing::push_frame: payload_size=", frame.payload.size());
+        /// Create a new frame ring in memory owned by the caller (e.g. a ShmRegistry arena)
+        /// The ring uses all of the region: its capacity is the region minus the control block. The
+        /// memory must stay mapped for the lifetime of the ring and is not released by it.
+        /// @param mem Region start (cache-line aligned)
+        /// @param region_bytes Region size in bytes
+        /// @param header_version Header format of the records written to this ring, adopted by attach_at()
+        /// @param info Placement of the memory, reported by memory_info()
+        static Result<FrameRing, Error> create_at(void *mem, size_t region_bytes,
+                                                  uint16_t header_version = FRAME_HEADER_V1,
+                                                  const ShmMemoryInfo &info = ShmMemoryInfo{}) {
+            if (region_bytes < sizeof(detail::RingControl) + 64 ||
+                reinterpret_cast<uintptr_t>(mem) % detail::RING_CACHE_LINE != 0) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Invalid ring region"));
+            }
+            if (header_version != FRAME_HEADER_V1 && header_version != FRAME_HEADER_V2) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Unsupported frame header version"));
+            }
+            size_t capacity_bytes = (region_bytes - sizeof(detail::RingControl)) & ~size_t(7);
+
+            FrameRing ring(init_control(mem, capacity_bytes, header_version), region_bytes, String(), false, false);
+            ring.external_ = true;
+            ring.memory_ = info;
+            return Result<FrameRing, Error>::ok(std::move(ring));
+        }
+
+        /// Attach to a frame ring created with create_at() in memory owned by the caller
+        /// @param mem Region start
+        /// @param region_bytes Region size in bytes
+        /// @param info Placement of the memory, reported by memory_info()
+        static Result<FrameRing, Error> attach_at(void *mem, size_t region_bytes,
+                                                  const ShmMemoryInfo &info = ShmMemoryInfo{}) {
+            auto *ctl = static_cast<detail::RingControl *>(mem);
+            if (region_bytes < sizeof(detail::RingControl) || ctl->magic != detail::RING_MAGIC ||
+                ctl->capacity == 0 || (ctl->capacity & 7) != 0 || segment_size(ctl->capacity) > region_bytes ||
+                ctl->header_version > FRAME_HEADER_V2) {
+                return Result<FrameRing, Error>::err(Error::invalid_argument("Not an initialized FrameRing"));
+            }
+            FrameRing ring(ctl, region_bytes, String(), false, false);
+            ring.external_ = true;
+            ring.memory_ = info;
+            return Result<FrameRing, Error>::ok(std::move(ring));
+        }
 
-            // Serialize the frame first
-            Bytes serialized = encode_frame(frame);
-            size_t record_size = sizeof(uint32_t) + serialized.size();
-            size_t aligned_size = (record_size + 7) & ~7; // Align to 8 bytes
-            size_t padding = aligned_size - record_size;
+        /// Destructor - releases the mapping (and unlinks SHM if this ring created it)
+        ~FrameRing() { release(); }
+
+        /// Move constructor
+        FrameRing(FrameRing &&other) noexcept
+            : ctl_(other.ctl_), data_(other.data_), capacity_(other.capacity_), map_size_(other.map_size_),
+              shm_name_(std::move(other.shm_name_)), is_shm_(other.is_shm_), owner_(other.owner_),
+              pending_head_(other.pending_head_), peeked_tail_(other.peeked_tail_), memory_(other.memory_),
+              hugetlbfs_dir_(std::move(other.hugetlbfs_dir_)), usage_histogram_(other.usage_histogram_),
+              usage_warned_(other.usage_warned_), full_warned_(other.full_warned_),
+              header_version_(other.header_version_), time_base_ns_(other.time_base_ns_), external_(other.external_) {
+            other.ctl_ = nullptr;
+            other.data_ = nullptr;
+            other.owner_ = false;
+        }
+
+        /// Move assignment
+        FrameRing &operator=(FrameRing &&other) noexcept {
+            if (this != &other) {
+                release();
+                ctl_ = other.ctl_;
+                data_ = other.data_;
+                capacity_ = other.capacity_;
+                map_size_ = other.map_size_;
+                shm_name_ = std::move(other.shm_name_);
+                is_shm_ = other.is_shm_;
+                owner_ = other.owner_;
+                pending_head_ = other.pending_head_;
+                peeked_tail_ = other.peeked_tail_;
+                memory_ = other.memory_;
+                hugetlbfs_dir_ = std::move(other.hugetlbfs_dir_);
+                usage_histogram_ = other.usage_histogram_;
+                usage_warned_ = other.usage_warned_;
+                full_warned_ = other.full_warned_;
+                header_version_ = other.header_version_;
+                time_base_ns_ = other.time_base_ns_;
+                external_ = other.external_;
+                other.ctl_ = nullptr;
+                other.data_ = nullptr;
+                other.owner_ = false;
+            }
+            return *this;
+        }
 
-            echo::trace("Record size: ", record_size, " bytes, aligned: ", aligned_size, " bytes, padding: ", padding);
+        // Disable copy
+        FrameRing(const FrameRing &) = delete;
+        FrameRing &operator=(const FrameRing &) = delete;
+
+        /// Reserve space for one encoded frame directly in ring memory
+        /// The returned span covers [FrameHeader][payload][meta] of the record and stays writable until
+        /// commit(). Records never straddle the ring end: if the contiguous tail is too short, it is
+        /// skipped with a wrap marker. Successive reservations are laid out back to back and are all
+        /// published by the next commit().
+        /// @param frame_size Encoded frame size in bytes (sizeof(FrameHeader) + payload + meta)
+        /// @return Result containing writable span, or timeout if the ring is full
+        Result<std::span<Byte>, Error> reserve(size_t frame_size) {
+            size_t record_size = sizeof(uint32_t) + frame_size;
+            size_t aligned_size = (record_size + 7) & ~size_t(7); // Align to 8 bytes
+
+            if (aligned_size > capacity_ || aligned_size > UINT32_MAX) {
+                echo::error("Record of ", aligned_size, " bytes exceeds ring capacity ", capacity_).red();
+                return Result<std::span<Byte>, Error>::err(Error::invalid_argument("Record too large for ring"));
+            }
 
-            // Check if we have enough space
-            size_t available = capacity() - size();
-            if (available < aligned_size) {
-                echo::warn("FrameRing full: need ", aligned_size, " bytes, have ", available).yellow();
-                return Result<Unit, Error>::err(Error::timeout("Ring buffer full"));
+            uint64_t head = producer_head();
+            uint64_t tail = ctl_->tail.load(std::memory_order_acquire);
+            size_t used = static_cast<size_t>(head - tail);
+            size_t offset = static_cast<size_t>(head % capacity_);
+            size_t skip = record_space(aligned_size, head) - aligned_size;
+
+            // Check if we have enough space (including the skipped tail on wrap-around); a producer
+            // retrying against a full ring is only told once until a reservation succeeds again
+            size_t available = capacity_ - used;
+            if (available < skip + aligned_size) {
+                if (!full_warned_) {
+                    echo::warn("FrameRing full: need ", skip + aligned_size, " bytes, have ", available).yellow();
+                    full_warned_ = true;
+                }
+                return Result<std::span<Byte>, Error>::err(Error::timeout("Ring buffer full"));
             }
+            full_warned_ = false;
 
-            // Check if ring is >80% full
-            float usage_pct = static_cast<float>(size()) / static_cast<float>(capacity());
-            if (usage_pct > 0.8f) {
-                echo::warn("FrameRing usage: ", static_cast<int>(usage_pct * 100), "%").yellow();
+            // Warn once when the ring passes 80% full, again only after it has drained below 50%
+            size_t usage_pct = used * 100 / capacity_;
+            if (usage_histogram_ != nullptr) {
+                usage_histogram_->record(usage_pct);
+            }
+            if (usage_pct > 80 && !usage_warned_) {
+                echo::warn("FrameRing usage: ", usage_pct, "%").yellow();
+                usage_warned_ = true;
+            } else if (usage_pct < 50) {
+                usage_warned_ = false;
+            }
+
+            if (skip > 0) {
+                std::memcpy(data_ + offset, &detail::RING_WRAP_MARKER, sizeof(uint32_t));
+                offset = 0;
             }
 
-            // Write record length
             uint32_t record_len = static_cast<uint32_t>(aligned_size);
-            auto result = push_bytes(reinterpret_cast<const Byte *>(&record_len), sizeof(uint32_t));
-            if (!result.is_ok()) {
-                return result;
+            std::memcpy(data_ + offset, &record_len, sizeof(uint32_t));
+
+            pending_head_ = head + skip + aligned_size;
+            WIREBIT_TRACE("FrameRing::reserve: ", frame_size, " bytes at offset ", offset, " (skip ", skip, ")");
+            return Result<std::span<Byte>, Error>::ok(std::span<Byte>(data_ + offset + sizeof(uint32_t), frame_size));
+        }
+
+        /// Publish the records obtained from reserve() to the consumer (single index update)
+        /// @return Result indicating success, or error if nothing was reserved
+        Result<Unit, Error> commit() {
+            if (pending_head_ == 0) {
+                return Result<Unit, Error>::err(Error::invalid_argument("No reserved record to commit"));
             }
+            ctl_->head.store(pending_head_, std::memory_order_release);
+            pending_head_ = 0;
+            return Result<Unit, Error>::ok(Unit{});
+        }
 
-            // Write serialized frame
-            result = push_bytes(serialized.data(), serialized.size());
-            if (!result.is_ok()) {
-                echo::error("Failed to push frame data").red();
-                return result;
+        /// Drop the records obtained from reserve() since the last commit() (the consumer never sees them)
+        inline void cancel() { pending_head_ = 0; }
+
+        /// Reserve a record and copy a frame into it
+        /// The record is published by the next commit() together with any earlier reservations, or
+        /// dropped by cancel(). push_frame() is write_frame() followed by commit().
+        /// @param header Frame header (payload_len/meta_len are taken from the spans)
+        /// @param payload Payload bytes
+        /// @param meta Metadata bytes
+        /// @return Result indicating success, or timeout if the ring is full
+        Result<Unit, Error> write_frame(const FrameHeader &header, std::span<const Byte> payload,
+                                        std::span<const Byte> meta) {
+            FrameHeader hdr = header;
+            hdr.version = FRAME_HEADER_V1;
+            hdr.payload_len = static_cast<uint32_t>(payload.size());
+            hdr.meta_len = static_cast<uint32_t>(meta.size());
+            Byte compact[FRAME_HEADER_V2_MAX];
+            const Byte *head = reinterpret_cast<const Byte *>(&hdr);
+            size_t head_len = sizeof(FrameHeader);
+            if (header_version_ == FRAME_HEADER_V2) {
+                head = compact;
+                head_len = encode_frame_header(hdr, time_base_ns_, compact);
             }
 
-            // Write padding
-            for (size_t i = 0; i < padding; ++i) {
-                auto pad_result = ring_.push(static_cast<Byte>(0));
-                if (!pad_result.is_ok()) {
-                    echo::error("Failed to push padding").red();
-                    return Result<Unit, Error>::err(pad_result.error());
-                }
+            auto slot = reserve(head_len + payload.size() + meta.size());
+            if (!slot.is_ok()) {
+                return Result<Unit, Error>::err(slot.error());
             }
 
-            echo::trace("FrameRing::push_frame complete");
+            Byte *dst = slot.value().data();
+            std::memcpy(dst, head, head_len);
+            if (!payload.empty()) {
+                std::memcpy(dst + head_len, payload.data(), payload.size());
+            }
+            if (!meta.empty()) {
+                std::memcpy(dst + head_len + payload.size(), meta.data(), meta.size());
+            }
             return Result<Unit, Error>::ok(Unit{});
         }
 
-        /// Pop a frame from the ring buffer
-        /// @return Result containing frame if available, or error
-        Result<Frame, Error> pop_frame() {
-            echo::trace("FrameRing::pop_frame");
+        /// Get the ring space the next push of a frame takes: its record plus the tail skipped on wrap
+        /// The size follows the ring's header format, so it is exact for FRAME_HEADER_V2 records too.
+        /// @param header Frame header (payload_len/meta_len are taken from the arguments)
+        /// @param payload_len Payload size in bytes
+        /// @param meta_len Metadata size in bytes
+        /// @return Bytes of ring space (more than capacity() if the frame can never fit)
+        size_t space_needed(const FrameHeader &header, size_t payload_len, size_t meta_len) const {
+            size_t head_len = sizeof(FrameHeader);
+            if (header_version_ == FRAME_HEADER_V2) {
+                FrameHeader hdr = header;
+                hdr.payload_len = static_cast<uint32_t>(payload_len);
+                hdr.meta_len = static_cast<uint32_t>(meta_len);
+                Byte compact[FRAME_HEADER_V2_MAX];
+                head_len = encode_frame_header(hdr, time_base_ns_, compact);
+            }
+            size_t aligned_size = (sizeof(uint32_t) + head_len + payload_len + meta_len + 7) & ~size_t(7);
+            if (aligned_size > capacity_) {
+                return aligned_size;
+            }
+            return record_space(aligned_size, producer_head());
+        }
+
+        /// Check whether pushing a frame now would fail because the ring is full (producer side)
+        /// @return true if the consumer has to free space first, or if the frame can never fit
+        inline bool would_block(const FrameHeader &header, size_t payload_len, size_t meta_len) const {
+            size_t used = static_cast<size_t>(producer_head() - ctl_->tail.load(std::memory_order_acquire));
+            return space_needed(header, payload_len, meta_len) > capacity_ - used;
+        }
 
-            // Read record length
-            uint32_t record_len = 0;
-            auto result = pop_bytes(reinterpret_cast<Byte *>(&record_len), sizeof(uint32_t));
+        /// Push a frame into the ring buffer
+        /// Header, payload and metadata are copied straight into ring memory (no intermediate buffer)
+        /// @param header Frame header (payload_len/meta_len are taken from the spans)
+        /// @param payload Payload bytes
+        /// @param meta Metadata bytes
+        /// @return Result indicating success or error
+        Result<Unit, Error> push_frame(const FrameHeader &header, std::span<const Byte> payload,
+                                       std::span<const Byte> meta = {}) {
+            WIREBIT_TRACE("FrameRing::push_frame: payload_size=", payload.size());
+
+            auto result = write_frame(header, payload, meta);
             if (!result.is_ok()) {
-                return Result<Frame, Error>::err(result.error());
+                return result;
             }
 
-            echo::trace("Record length: ", record_len, " bytes");
+            WIREBIT_TRACE("FrameRing::push_frame complete");
+            return commit();
+        }
 
-            // Validate record length
-            if (record_len == 0) {
-                echo::error("Invalid record length: 0").red();
-                return Result<Frame, Error>::err(Error::invalid_argument("Invalid record length"));
+        /// Push a frame into the ring buffer
+        /// Frame format: [u32 record_len][serialized frame][padding to 8B alignment]
+        /// @param frame Frame to push
+        /// @return Result indicating success or error
+        Result<Unit, Error> push_frame(const Frame &frame) {
+            return push_frame(frame.header, std::span<const Byte>(frame.payload.data(), frame.payload.size()),
+                              std::span<const Byte>(frame.meta.data(), frame.meta.size()));
+        }
+
+        /// Push several frames with a single head publish
+        /// Frames are written in order until one does not fit; the ones written are committed together.
+        /// @param frames Frames to push
+        /// @return Result containing number of frames pushed, or error if none could be pushed
+        Result<size_t, Error> push_batch(std::span<const Frame> frames) {
+            size_t pushed = 0;
+            for (const Frame &frame : frames) {
+                auto result = write_frame(frame.header,
+                                          std::span<const Byte>(frame.payload.data(), frame.payload.size()),
+                                          std::span<const Byte>(frame.meta.data(), frame.meta.size()));
+                if (!result.is_ok()) {
+                    if (pushed == 0) {
+                        return Result<size_t, Error>::err(result.error());
+                    }
+                    break;
+                }
+                ++pushed;
             }
 
-            if (record_len > capacity()) {
-                echo::error("Record length ", record_len, " exceeds capacity ", capacity()).red();
-                return Result<Frame, Error>::err(Error::invalid_argument("Record too large"));
+            if (pushed > 0) {
+                commit();
             }
+            WIREBIT_TRACE("FrameRing::push_batch: ", pushed, " of ", frames.size(), " frames");
+            return Result<size_t, Error>::ok(pushed);
+        }
 
-            // Read serialized frame data
-            size_t frame_data_size = record_len - sizeof(uint32_t);
-            Bytes frame_data(frame_data_size);
-            result = pop_bytes(frame_data.data(), frame_data_size);
-            if (!result.is_ok()) {
-                echo::error("Failed to pop frame data").red();
-                return Result<Frame, Error>::err(result.error());
+        /// Peek at the frame at the front of the ring without copying it
+        /// The returned view points into ring memory and stays valid until consume().
+        /// @return Result containing frame view, or timeout if the ring is empty
+        Result<FrameView, Error> peek() {
+            return peek_at(ctl_->tail.load(std::memory_order_relaxed), ctl_->head.load(std::memory_order_acquire));
+        }
+
+        /// Release the record returned by the last peek() back to the producer
+        inline void consume() {
+            if (peeked_tail_ != 0) {
+                ctl_->tail.store(peeked_tail_, std::memory_order_release);
+                peeked_tail_ = 0;
             }
+        }
 
-            // Calculate and skip padding
-            size_t aligned_size = (record_len + 7) & ~7;
-            size_t padding = aligned_size - record_len;
+        /// Pop a frame from the ring buffer
+        /// @return Result containing frame if available, or error
+        Result<Frame, Error> pop_frame() {
+            WIREBIT_TRACE("FrameRing::pop_frame");
 
-            for (size_t i = 0; i < padding; ++i) {
-                auto pad_result = ring_.pop();
-                if (!pad_result.is_ok()) {
-                    echo::error("Failed to pop padding").red();
-                    return Result<Frame, Error>::err(pad_result.error());
-                }
+            auto view_result = peek();
+            if (!view_result.is_ok()) {
+                return Result<Frame, Error>::err(view_result.error());
             }
 
-            // Deserialize frame
-            auto frame_result = decode_frame(frame_data);
-            if (!frame_result.is_ok()) {
-                echo::error("Failed to deserialize frame").red();
-                return frame_result;
+            Frame frame = to_frame(view_result.value());
+            consume();
+
+            WIREBIT_TRACE("FrameRing::pop_frame complete: payload_size=", frame.payload.size());
+            return Result<Frame, Error>::ok(std::move(frame));
+        }
+
+        /// Pop up to max_frames frames with a single tail publish
+        /// @param frames Vector the frames are appended to
+        /// @param max_frames Maximum number of frames to pop
+        /// @param pool Pool for the payload/meta buffers (nullptr = allocate normally)
+        /// @return Result containing number of frames popped, or error if the ring is empty
+        Result<size_t, Error> pop_batch(Vector<Frame> &frames, size_t max_frames, FramePool *pool = nullptr) {
+            uint64_t tail = ctl_->tail.load(std::memory_order_relaxed);
+            uint64_t head = ctl_->head.load(std::memory_order_acquire);
+
+            size_t popped = 0;
+            while (popped < max_frames) {
+                auto view_result = peek_at(tail, head);
+                if (!view_result.is_ok()) {
+                    if (popped == 0) {
+                        return Result<size_t, Error>::err(view_result.error());
+                    }
+                    break;
+                }
+                frames.push_back(pool != nullptr ? pool->to_frame(view_result.value()) : to_frame(view_result.value()));
+                tail = peeked_tail_;
+                ++popped;
             }
 
-            echo::trace("FrameRing::pop_frame complete: payload_size=", frame_result.value().payload.size());
-            return frame_result;
+            consume();
+            WIREBIT_TRACE("FrameRing::pop_batch: ", popped, " frames");
+            return Result<size_t, Error>::ok(popped);
         }
 
         /// Check if ring buffer is empty
-        inline bool empty() const { return ring_.empty(); }
+        inline bool empty() const { return size() == 0; }
 
         /// Check if ring buffer is full
-        inline bool full() const { return ring_.full(); }
+        inline bool full() const { return size() >= capacity_; }
 
         /// Get capacity in bytes
-        inline size_t capacity() const { return ring_.capacity(); }
+        inline size_t capacity() const { return capacity_; }
+
+        /// Advertise whether the consumer is about to block waiting for data
+        /// Setting the flag is followed by a full fence, so a subsequent empty() check cannot miss a record
+        /// published by a producer that saw the flag clear.
+        /// @param waiting True before blocking, false after waking up
+        inline void set_consumer_waiting(bool waiting) {
+            ctl_->consumer_waiting.store(waiting ? 1 : 0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        /// Check whether the consumer advertised it is blocked (producer side, call after commit())
+        /// The full fence orders this load after the preceding head publish.
+        /// @return true if the producer should wake the consumer
+        inline bool consumer_waiting() const {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return ctl_->consumer_waiting.load(std::memory_order_relaxed) != 0;
+        }
+
+        /// Advertise that the producer is about to block until `bytes` of the ring are free
+        /// Followed by a full fence, so a subsequent would_block() check cannot miss space freed by a
+        /// consumer that saw no request.
+        /// @param bytes Free bytes required (0 = stop waiting)
+        inline void set_producer_waiting(size_t bytes) {
+            ctl_->producer_wait_bytes.store(bytes, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        /// Check whether a blocked producer now has the space it waits for (consumer side, after consume())
+        /// A satisfied request is cleared, so the producer is woken once per wait.
+        /// @return true if the consumer should wake the producer
+        inline bool producer_unblocked() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint64_t wanted = ctl_->producer_wait_bytes.load(std::memory_order_relaxed);
+            if (wanted == 0 || available() < wanted) {
+                return false;
+            }
+            return ctl_->producer_wait_bytes.compare_exchange_strong(wanted, 0, std::memory_order_relaxed);
+        }
 
         /// Get current size in bytes
-        inline size_t size() const { return ring_.size(); }
+        inline size_t size() const {
+            uint64_t tail = ctl_->tail.load(std::memory_order_acquire);
+            uint64_t head = ctl_->head.load(std::memory_order_acquire);
+            return static_cast<size_t>(head - tail);
+        }
 
         /// Get available space in bytes
         inline size_t available() const { return capacity() - size(); }
@@ -179,34 +582,142 @@ namespace wirebit {
         /// Get usage percentage (0.0 to 1.0)
         inline float usage() const { return static_cast<float>(size()) / static_cast<float>(capacity()); }
 
+        /// Get the placement applied to this ring's mapping (all defaults for heap rings)
+        inline const ShmMemoryInfo &memory_info() const { return memory_; }
+
+        /// Get the header format push_frame()/push_batch() write (chosen by the ring's creator)
+        inline uint16_t header_version() const { return header_version_; }
+
+        /// Record the fill level (in percent, before the write) at every reservation
+        /// @param histogram Histogram to record into (must outlive the ring), or nullptr to stop
+        inline void set_usage_histogram(Histogram *histogram) { usage_histogram_ = histogram; }
+
       private:
-        datapod::RingBuffer<datapod::SPSC, Byte> ring_;
+        detail::RingControl *ctl_ = nullptr;   ///< Control block (start of mapping)
+        Byte *data_ = nullptr;                 ///< Data region (follows control block)
+        size_t capacity_ = 0;                  ///< Data region size in bytes
+        size_t map_size_ = 0;                  ///< Total mapping size (control + data)
+        String shm_name_;                      ///< SHM segment name (empty for heap rings)
+        bool is_shm_ = false;                  ///< True if mapping is shared memory
+        bool owner_ = false;                   ///< True if this ring created the SHM segment
+        uint64_t pending_head_ = 0;            ///< Head after the uncommitted reservation (0 = none)
+        uint64_t peeked_tail_ = 0;             ///< Tail after the last peeked record (0 = none)
+        ShmMemoryInfo memory_;                 ///< Placement applied to the SHM mapping
+        String hugetlbfs_dir_;                 ///< hugetlbfs mount holding the segment (if memory_.hugetlbfs)
+        Histogram *usage_histogram_ = nullptr; ///< Fill level recorded at each reserve() (optional)
+        bool usage_warned_ = false;            ///< High-usage warning given and not yet re-armed
+        bool full_warned_ = false;             ///< Full warning given since the last successful reserve()
+        uint16_t header_version_ = 1;          ///< Record header format (from the control block)
+        uint64_t time_base_ns_ = 0;            ///< Time base of v2 record headers
+        bool external_ = false;                ///< Memory owned by the caller (create_at()/attach_at())
+
+        FrameRing(detail::RingControl *ctl, size_t map_size, const String &shm_name, bool is_shm, bool owner)
+            : ctl_(ctl), data_(reinterpret_cast<Byte *>(ctl) + sizeof(detail::RingControl)),
+              capacity_(static_cast<size_t>(ctl->capacity)), map_size_(map_size), shm_name_(shm_name),
+              is_shm_(is_shm), owner_(owner),
+              header_version_(ctl->header_version == FRAME_HEADER_V2 ? FRAME_HEADER_V2 : FRAME_HEADER_V1),
+              time_base_ns_(ctl->time_base_ns) {}
+
+        /// Helper: Head the next reservation starts at (after any uncommitted ones)
+        inline uint64_t producer_head() const {
+            return pending_head_ != 0 ? pending_head_ : ctl_->head.load(std::memory_order_relaxed);
+        }
 
-        explicit FrameRing(size_t capacity) : ring_(capacity) {}
+        /// Helper: Ring space a record of aligned_size bytes takes at head, including a skipped ring tail
+        inline size_t record_space(size_t aligned_size, uint64_t head) const {
+            size_t contiguous = capacity_ - static_cast<size_t>(head % capacity_);
+            return contiguous < aligned_size ? contiguous + aligned_size : aligned_size;
+        }
 
-        explicit FrameRing(datapod::RingBuffer<datapod::SPSC, Byte> &&ring) : ring_(std::move(ring)) {}
+        /// Helper: Parse the record at tail, skipping wrap markers
+        /// On success peeked_tail_ is set past the record; on a dropped record it is cleared.
+        Result<FrameView, Error> peek_at(uint64_t tail, uint64_t head) {
+            while (true) {
+                size_t used = static_cast<size_t>(head - tail);
+                if (used < sizeof(uint32_t)) {
+                    return Result<FrameView, Error>::err(Error::timeout("Ring buffer empty"));
+                }
 
-        /// Helper: Push multiple bytes to the ring buffer
-        inline Result<Unit, Error> push_bytes(const Byte *data, size_t len) {
-            for (size_t i = 0; i < len; ++i) {
-                auto result = ring_.push(data[i]);
-                if (!result.is_ok()) {
-                    return Result<Unit, Error>::err(result.error());
+                size_t offset = static_cast<size_t>(tail % capacity_);
+                uint32_t record_len = 0;
+                std::memcpy(&record_len, data_ + offset, sizeof(uint32_t));
+
+                // Skip the unused tail left by a wrapped record
+                if (record_len == detail::RING_WRAP_MARKER) {
+                    tail += capacity_ - offset;
+                    ctl_->tail.store(tail, std::memory_order_release);
+                    continue;
+                }
+
+                // Validate record length; a corrupt length leaves no way to find the next record,
+                // so the pending contents are discarded to resynchronize with the producer
+                if (record_len < sizeof(uint32_t) + FRAME_HEADER_V2_MIN || record_len > used ||
+                    record_len > capacity_ - offset || (record_len & 7) != 0) {
+                    echo::error("Invalid record length ", record_len, " (", used, " bytes pending), discarding").red();
+                    ctl_->tail.store(head, std::memory_order_release);
+                    peeked_tail_ = 0;
+                    return Result<FrameView, Error>::err(Error::invalid_argument("Invalid record length"));
                 }
+
+                const Byte *rec = data_ + offset + sizeof(uint32_t);
+                const size_t rec_size = record_len - sizeof(uint32_t);
+                FrameView view;
+                size_t header_len = 0;
+                auto parsed = detail::parse_frame_header(rec, rec_size, view.header, header_len, time_base_ns_);
+
+                size_t frame_size = header_len + static_cast<size_t>(view.header.payload_len) +
+                                    static_cast<size_t>(view.header.meta_len);
+                if (parsed != detail::HeaderParse::Ok || frame_size > rec_size) {
+                    // Record boundary is intact, so only this record is dropped
+                    echo::error("Invalid frame in ring record, skipping ", record_len, " bytes").red();
+                    ctl_->tail.store(tail + record_len, std::memory_order_release);
+                    peeked_tail_ = 0;
+                    return Result<FrameView, Error>::err(Error::invalid_argument("Invalid frame in ring record"));
+                }
+
+                view.payload = std::span<const Byte>(rec + header_len, view.header.payload_len);
+                view.meta = std::span<const Byte>(rec + header_len + view.header.payload_len, view.header.meta_len);
+                peeked_tail_ = tail + record_len;
+                return Result<FrameView, Error>::ok(view);
             }
-            return Result<Unit, Error>::ok(Unit{});
         }
 
-        /// Helper: Pop multiple bytes from the ring buffer
-        inline Result<Unit, Error> pop_bytes(Byte *data, size_t len) {
-            for (size_t i = 0; i < len; ++i) {
-                auto result = ring_.pop();
-                if (!result.is_ok()) {
-                    return Result<Unit, Error>::err(result.error());
+        /// Helper: Total segment size for a given data capacity
+        static inline size_t segment_size(size_t capacity_bytes) {
+            size_t total = sizeof(detail::RingControl) + capacity_bytes;
+            return (total + detail::RING_CACHE_LINE - 1) & ~(detail::RING_CACHE_LINE - 1);
+        }
+
+        /// Helper: Initialize a fresh control block at the start of a mapping
+        static inline detail::RingControl *init_control(void *mem, size_t capacity_bytes, uint16_t header_version) {
+            auto *ctl = new (mem) detail::RingControl();
+            ctl->capacity = capacity_bytes;
+            ctl->time_base_ns = static_cast<uint64_t>(now_ns());
+            ctl->header_version = header_version;
+            ctl->head.store(0, std::memory_order_relaxed);
+            ctl->tail.store(0, std::memory_order_relaxed);
+            ctl->consumer_waiting.store(0, std::memory_order_relaxed);
+            ctl->producer_wait_bytes.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            ctl->magic = detail::RING_MAGIC;
+            return ctl;
+        }
+
+        /// Helper: Release mapping / allocation (left alone for caller-owned memory)
+        inline void release() {
+            if (ctl_ == nullptr) {
+                return;
+            }
+            if (is_shm_) {
+                munmap(ctl_, map_size_);
+                if (owner_) {
+                    detail::unlink_segment(shm_name_, hugetlbfs_dir_, memory_.hugetlbfs);
                 }
-                data[i] = result.value();
+            } else if (!external_) {
+                std::free(ctl_);
             }
-            return Result<Unit, Error>::ok(Unit{});
+            ctl_ = nullptr;
+            data_ = nullptr;
         }
     };
 
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/link.hpp>
+#include <wirebit/shm/ring.hpp>
+#include <wirebit/shm/shm_link.hpp>
+
+namespace wirebit {
+
+    namespace detail {
+        constexpr uint64_t BUS_MAGIC = 0x5355425F54494257ULL; ///< 'WBIT_BUS' (little endian)
+
+        /// Control block placed at the start of every bus segment
+        struct BusControl {
+            uint64_t magic;                                           ///< BUS_MAGIC once initialized
+            uint64_t slot_count;                                      ///< Number of slots (power of two)
+            uint64_t slot_size;                                       ///< Largest encoded frame per slot
+            uint64_t slot_stride;                                     ///< Bytes between slot starts
+            alignas(RING_CACHE_LINE) std::atomic<uint64_t> write_seq; ///< Next sequence number to claim
+            alignas(RING_CACHE_LINE) std::atomic<uint32_t> next_node; ///< Next node ID handed to a handle
+        };
+
+        /// Header of one bus slot; the encoded frame follows it
+        /// seq is a seqlock stamp: 2 * pos + 1 while sequence number pos is being written,
+        /// 2 * pos + 2 once it is published (0 = never written).
+        struct BusSlot {
+            std::atomic<uint64_t> seq; ///< Seqlock stamp
+            uint32_t origin;           ///< Node ID of the writer
+            uint32_t len;              ///< Encoded frame length
+        };
+
+        static_assert(sizeof(BusControl) % RING_CACHE_LINE == 0, "Bus slots must start on a cache line");
+    } // namespace detail
+
+    /// Statistics for ShmBus
+    struct ShmBusStats {
+        uint64_t frames_sent = 0;     ///< Frames published to the bus
+        uint64_t frames_received = 0; ///< Frames from other nodes handed out
+        uint64_t frames_skipped = 0;  ///< Own frames passed over by the read cursor
+        uint64_t frames_overrun = 0;  ///< Frames overwritten before this node read them
+        uint64_t laps = 0;            ///< Times the read cursor was lapped and moved forward
+        uint64_t bytes_sent = 0;
+        uint64_t bytes_received = 0;
+
+        inline void reset() {
+            frames_sent = 0;
+            frames_received = 0;
+            frames_skipped = 0;
+            frames_overrun = 0;
+            laps = 0;
+            bytes_sent = 0;
+            bytes_received = 0;
+        }
+    };
+
+    /// Shared memory broadcast bus (CAN bus, Ethernet segment)
+    ///
+    /// One segment holds a ring of fixed-size, sequence-numbered slots. A writer claims the next
+    /// sequence number with a single fetch_add and publishes the slot with a seqlock stamp, so any
+    /// number of nodes can send concurrently and every frame is written exactly once no matter how
+    /// many nodes are attached. Each ShmBus handle is one node with its own read cursor; it reads
+    /// every slot published by the other nodes and passes over its own.
+    ///
+    /// Writers never wait for readers. A reader that falls more than slot_count frames behind finds
+    /// its slot reused (the stamp has moved on), counts the lost frames in frames_overrun and jumps
+    /// to the oldest slot still on the bus, so a slow node cannot stall the others.
+    ///
+    /// A frame is copied out of its slot on receive (the slot can be reused at any time), so views
+    /// from recv_view() point into handle-owned storage and stay valid until the next receive.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto bus = ShmBus::create("can0_bus", 1024);
+    /// auto node = ShmBus::attach("can0_bus");
+    /// CanEndpoint ecu(std::make_shared<ShmBus>(std::move(node.value())), config, 1);
+    /// @endcode
+    class ShmBus : public Link {
+      public:
+        /// Create a new bus segment and join it as the first node
+        /// @param name Bus name (the segment is "/<name>_bus")
+        /// @param slot_count Number of slots (rounded up to a power of two)
+        /// @param slot_size Largest encoded frame in bytes (sizeof(FrameHeader) + payload + meta)
+        /// @return Result containing ShmBus or error
+        static Result<ShmBus, Error> create(const String &name, size_t slot_count,
+                                            size_t slot_size = sizeof(FrameHeader) + 256) {
+            WIREBIT_DEBUG("Creating ShmBus: ", name.c_str(), " (", slot_count, " slots of ", slot_size, " bytes)");
+
+            if (slot_count == 0 || slot_size < sizeof(FrameHeader) || slot_size > UINT32_MAX) {
+                return Result<ShmBus, Error>::err(Error::invalid_argument("Invalid bus slot count or size"));
+            }
+            size_t slots = 1;
+            while (slots < slot_count) {
+                slots <<= 1;
+            }
+
+            String shm_name = segment_name(name);
+            int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0666);
+            if (fd < 0) {
+                echo::error("Failed to create SHM bus ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<ShmBus, Error>::err(Error::io_error("shm_open() failed"));
+            }
+
+            size_t stride = (sizeof(detail::BusSlot) + slot_size + detail::RING_CACHE_LINE - 1) &
+                            ~(detail::RING_CACHE_LINE - 1);
+            size_t map_size = sizeof(detail::BusControl) + slots * stride;
+            if (ftruncate(fd, static_cast<off_t>(map_size)) < 0) {
+                echo::error("Failed to size SHM bus ", shm_name.c_str(), ": ", strerror(errno)).red();
+                close(fd);
+                shm_unlink(shm_name.c_str());
+                return Result<ShmBus, Error>::err(Error::io_error("ftruncate() failed"));
+            }
+
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map SHM bus ", shm_name.c_str(), ": ", strerror(errno)).red();
+                shm_unlink(shm_name.c_str());
+                return Result<ShmBus, Error>::err(Error::io_error("mmap() failed"));
+            }
+
+            auto *ctl = new (mem) detail::BusControl();
+            ctl->slot_count = slots;
+            ctl->slot_size = slot_size;
+            ctl->slot_stride = stride;
+            ctl->write_seq.store(0, std::memory_order_relaxed);
+            ctl->next_node.store(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < slots; ++i) {
+                Byte *slot = static_cast<Byte *>(mem) + sizeof(detail::BusControl) + i * stride;
+                new (slot) detail::BusSlot{};
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            ctl->magic = detail::BUS_MAGIC;
+
+            WIREBIT_DEBUG("ShmBus created successfully: ", name.c_str()).green();
+            ShmBus bus(name, ctl, map_size, true);
+            return Result<ShmBus, Error>::ok(std::move(bus));
+        }
+
+        /// Join an existing bus as a new node
+        /// The read cursor starts at the current end of the bus, so only frames sent after
+        /// attaching are received.
+        /// @param name Bus name
+        /// @return Result containing ShmBus or error
+        static Result<ShmBus, Error> attach(const String &name) {
+            WIREBIT_DEBUG("Attaching to ShmBus: ", name.c_str());
+
+            String shm_name = segment_name(name);
+            int fd = shm_open(shm_name.c_str(), O_RDWR, 0666);
+            if (fd < 0) {
+                echo::error("Failed to attach to SHM bus ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<ShmBus, Error>::err(Error::not_found("SHM bus does not exist"));
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(detail::BusControl)) {
+                echo::error("SHM bus ", shm_name.c_str(), " has invalid size").red();
+                close(fd);
+                return Result<ShmBus, Error>::err(Error::io_error("SHM bus has invalid size"));
+            }
+
+            size_t map_size = static_cast<size_t>(st.st_size);
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map SHM bus ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<ShmBus, Error>::err(Error::io_error("mmap() failed"));
+            }
+
+            auto *ctl = static_cast<detail::BusControl *>(mem);
+            uint64_t slots = ctl->slot_count;
+            if (ctl->magic != detail::BUS_MAGIC || slots == 0 || (slots & (slots - 1)) != 0 ||
+                ctl->slot_stride < sizeof(detail::BusSlot) + ctl->slot_size ||
+                sizeof(detail::BusControl) + slots * ctl->slot_stride > map_size) {
+                echo::error("SHM bus ", shm_name.c_str(), " is not an initialized ShmBus").red();
+                munmap(mem, map_size);
+                return Result<ShmBus, Error>::err(Error::invalid_argument("Invalid SHM bus header"));
+            }
+
+            WIREBIT_DEBUG("ShmBus attached successfully: ", name.c_str()).green();
+            ShmBus bus(name, ctl, map_size, false);
+            return Result<ShmBus, Error>::ok(std::move(bus));
+        }
+
+        /// Destructor - releases the mapping (and unlinks the segment if this handle created it)
+        ~ShmBus() { release(); }
+
+        /// Move constructor
+        ShmBus(ShmBus &&other) noexcept
+            : name_(std::move(other.name_)), ctl_(other.ctl_), slots_(other.slots_), map_size_(other.map_size_),
+              owner_(other.owner_), node_id_(other.node_id_), cursor_(other.cursor_),
+              rx_buffer_(std::move(other.rx_buffer_)), stats_(other.stats_) {
+            other.ctl_ = nullptr;
+            other.slots_ = nullptr;
+            other.owner_ = false;
+        }
+
+        /// Move assignment
+        ShmBus &operator=(ShmBus &&other) noexcept {
+            if (this != &other) {
+                release();
+                name_ = std::move(other.name_);
+                ctl_ = other.ctl_;
+                slots_ = other.slots_;
+                map_size_ = other.map_size_;
+                owner_ = other.owner_;
+                node_id_ = other.node_id_;
+                cursor_ = other.cursor_;
+                rx_buffer_ = std::move(other.rx_buffer_);
+                stats_ = other.stats_;
+                other.ctl_ = nullptr;
+                other.slots_ = nullptr;
+                other.owner_ = false;
+            }
+            return *this;
+        }
+
+        // Disable copy
+        ShmBus(const ShmBus &) = delete;
+        ShmBus &operator=(const ShmBus &) = delete;
+
+        /// Broadcast a frame to every other node
+        Result<Unit, Error> send(const Frame &frame) override { return send_view(make_view(frame)); }
+
+        /// Broadcast a borrowed frame to every other node
+        /// Header and spans are written straight into the claimed slot.
+        /// @return Result indicating success, or invalid_argument if the frame exceeds slot_size()
+        Result<Unit, Error> send_view(const FrameView &frame) override {
+            size_t len = sizeof(FrameHeader) + frame.payload.size() + frame.meta.size();
+            if (len > slot_size()) {
+                echo::error("Frame of ", len, " bytes exceeds bus slot size ", slot_size()).red();
+                stats_export_.add(LinkCounter::SendErrors);
+                return Result<Unit, Error>::err(Error::invalid_argument("Frame too large for bus slot"));
+            }
+
+            uint64_t pos = ctl_->write_seq.fetch_add(1, std::memory_order_relaxed);
+            detail::BusSlot *slot = slot_at(pos);
+
+            // Wait for the previous lap's writer of this slot to publish (only contended when
+            // more than slot_count frames are in flight at once), then mark the slot busy
+            uint64_t slot_count = ctl_->slot_count;
+            uint64_t previous = pos >= slot_count ? 2 * (pos - slot_count) + 2 : 0;
+            uint64_t expected = previous;
+            while (!slot->seq.compare_exchange_weak(expected, 2 * pos + 1, std::memory_order_acquire,
+                                                    std::memory_order_relaxed)) {
+                expected = previous;
+                detail::cpu_relax();
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            FrameHeader header = frame.header;
+            header.payload_len = static_cast<uint32_t>(frame.payload.size());
+            header.meta_len = static_cast<uint32_t>(frame.meta.size());
+            Byte *dst = slot_data(slot);
+            std::memcpy(dst, &header, sizeof(FrameHeader));
+            if (!frame.payload.empty()) {
+                std::memcpy(dst + sizeof(FrameHeader), frame.payload.data(), frame.payload.size());
+            }
+            if (!frame.meta.empty()) {
+                std::memcpy(dst + sizeof(FrameHeader) + frame.payload.size(), frame.meta.data(), frame.meta.size());
+            }
+            slot->origin = node_id_;
+            slot->len = static_cast<uint32_t>(len);
+            slot->seq.store(2 * pos + 2, std::memory_order_release);
+
+            stats_.frames_sent++;
+            stats_.bytes_sent += len;
+            stats_export_.sent(len);
+            WIREBIT_TRACE("ShmBus::send: ", name_.c_str(), " node ", node_id_, " seq ", pos);
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Receive the next frame sent by another node
+        Result<Frame, Error> recv() override {
+            auto result = recv_view();
+            if (!result.is_ok()) {
+                return Result<Frame, Error>::err(result.error());
+            }
+            return Result<Frame, Error>::ok(owned_frame(result.value()));
+        }
+
+        /// Receive the next frame sent by another node
+        /// The view points into handle-owned storage and stays valid until the next recv()/recv_view().
+        /// @return Result containing frame view, or timeout if no newer frame has been published
+        Result<FrameView, Error> recv_view() override {
+            while (true) {
+                detail::BusSlot *slot = slot_at(cursor_);
+                uint64_t want = 2 * cursor_ + 2;
+                uint64_t stamp = slot->seq.load(std::memory_order_acquire);
+                if (stamp < want) {
+                    return Result<FrameView, Error>::err(Error::timeout("No frame on bus"));
+                }
+                if (stamp > want) {
+                    catch_up();
+                    continue;
+                }
+
+                uint32_t origin = slot->origin;
+                uint32_t len = slot->len;
+                bool own = origin == node_id_;
+                if (!own) {
+                    if (len > slot_size()) {
+                        len = 0; // Torn read; the stamp check below rejects it
+                    }
+                    if (rx_buffer_.size() < len) {
+                        rx_buffer_.resize(slot_size());
+                    }
+                    std::memcpy(rx_buffer_.data(), slot_data(slot), len);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot->seq.load(std::memory_order_relaxed) != stamp) {
+                    catch_up();
+                    continue;
+                }
+                cursor_++;
+
+                if (own) {
+                    stats_.frames_skipped++;
+                    continue;
+                }
+
+                FrameView view;
+                std::memcpy(&view.header, rx_buffer_.data(), sizeof(FrameHeader));
+                size_t frame_size = sizeof(FrameHeader) + static_cast<size_t>(view.header.payload_len) +
+                                    static_cast<size_t>(view.header.meta_len);
+                if (len < sizeof(FrameHeader) || view.header.magic != 0x57424954 || frame_size != len) {
+                    echo::error("Invalid frame in bus slot, skipping").red();
+                    stats_export_.add(LinkCounter::RecvErrors);
+                    return Result<FrameView, Error>::err(Error::invalid_argument("Invalid frame in bus slot"));
+                }
+                const Byte *body = rx_buffer_.data() + sizeof(FrameHeader);
+                view.payload = std::span<const Byte>(body, view.header.payload_len);
+                view.meta = std::span<const Byte>(body + view.header.payload_len, view.header.meta_len);
+
+                stats_.frames_received++;
+                stats_.bytes_received += len;
+                stats_export_.received(len);
+                record_rx(view.header);
+                if (stats_export_.active()) {
+                    stats_export_.queues(backlog() * slot_size(), ctl_->slot_count * slot_size(), 0, 0);
+                }
+                WIREBIT_TRACE("ShmBus::recv: ", name_.c_str(), " node ", node_id_, " from node ", origin);
+                return Result<FrameView, Error>::ok(view);
+            }
+        }
+
+        /// Sending never blocks: slow readers are lapped, not waited for
+        bool can_send() const override { return true; }
+
+        /// Check whether a frame is published at the read cursor (own frames included)
+        bool can_recv() const override {
+            return slot_at(cursor_)->seq.load(std::memory_order_acquire) >= 2 * cursor_ + 2;
+        }
+
+        /// Get bus name
+        String name() const override { return name_; }
+
+        /// Get this handle's node ID (unique per segment, written to every slot it sends)
+        inline uint32_t node_id() const { return node_id_; }
+
+        /// Get number of slots
+        inline size_t slot_count() const { return static_cast<size_t>(ctl_->slot_count); }
+
+        /// Get largest encoded frame a slot holds
+        inline size_t slot_size() const { return static_cast<size_t>(ctl_->slot_size); }
+
+        /// Get number of frames claimed on the bus so far (all nodes)
+        inline uint64_t write_seq() const { return ctl_->write_seq.load(std::memory_order_acquire); }
+
+        /// Get number of slots between the read cursor and the end of the bus
+        inline uint64_t backlog() const { return write_seq() - cursor_; }
+
+        /// Move the read cursor to the end of the bus, dropping everything unread
+        inline void skip_to_end() { cursor_ = write_seq(); }
+
+        /// Get bus statistics for this node
+        inline const ShmBusStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        String name_;
+        detail::BusControl *ctl_ = nullptr; ///< Control block (start of mapping)
+        Byte *slots_ = nullptr;             ///< First slot (follows control block)
+        size_t map_size_ = 0;               ///< Total mapping size
+        bool owner_ = false;                ///< True if this handle created the segment
+        uint32_t node_id_ = 0;              ///< Origin written to slots this node sends
+        uint64_t cursor_ = 0;               ///< Sequence number of the next slot to read
+        Bytes rx_buffer_;                   ///< Copy of the last received slot (backs recv_view())
+        ShmBusStats stats_;
+
+        ShmBus(const String &name, detail::BusControl *ctl, size_t map_size, bool owner)
+            : name_(name), ctl_(ctl), slots_(reinterpret_cast<Byte *>(ctl) + sizeof(detail::BusControl)),
+              map_size_(map_size), owner_(owner) {
+            node_id_ = ctl_->next_node.fetch_add(1, std::memory_order_relaxed);
+            cursor_ = ctl_->write_seq.load(std::memory_order_acquire);
+        }
+
+        /// Helper: Segment name for a bus name
+        static inline String segment_name(const String &name) {
+            char buf[256];
+            snprintf(buf, sizeof(buf), "/%s_bus", name.c_str());
+            return String(buf);
+        }
+
+        /// Helper: Slot holding sequence number pos
+        inline detail::BusSlot *slot_at(uint64_t pos) const {
+            size_t index = static_cast<size_t>(pos & (ctl_->slot_count - 1));
+            return reinterpret_cast<detail::BusSlot *>(slots_ + index * ctl_->slot_stride);
+        }
+
+        /// Helper: Encoded frame bytes of a slot
+        static inline Byte *slot_data(detail::BusSlot *slot) {
+            return reinterpret_cast<Byte *>(slot) + sizeof(detail::BusSlot);
+        }
+
+        /// Helper: The cursor's slot was reused; move to the oldest slot still on the bus
+        inline void catch_up() {
+            uint64_t head = ctl_->write_seq.load(std::memory_order_acquire);
+            uint64_t oldest = head > ctl_->slot_count ? head - ctl_->slot_count : 0;
+            if (oldest <= cursor_) {
+                // Only reached if a writer of the next lap already claimed the slot
+                oldest = cursor_ + 1;
+            }
+            stats_.laps++;
+            stats_.frames_overrun += oldest - cursor_;
+            stats_export_.add(LinkCounter::FramesDropped, oldest - cursor_);
+            echo::warn("ShmBus node ", node_id_, " lapped, lost ", oldest - cursor_, " frames").yellow();
+            cursor_ = oldest;
+        }
+
+        /// Helper: Release mapping
+        inline void release() {
+            if (ctl_ == nullptr) {
+                return;
+            }
+            munmap(ctl_, map_size_);
+            if (owner_) {
+                shm_unlink(segment_name(name_).c_str());
+            }
+            ctl_ = nullptr;
+            slots_ = nullptr;
+        }
+    };
+
+} // namespace wirebit
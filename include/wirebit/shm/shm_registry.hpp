@@ -0,0 +1,821 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/shm/handshake.hpp>
+#include <wirebit/shm/memory.hpp>
+#include <wirebit/shm/ring.hpp>
+#include <wirebit/shm/shm_link.hpp>
+
+namespace wirebit {
+
+    /// ShmRegistry configuration (applies when the registry segment is created; an existing one keeps its own)
+    struct ShmRegistryConfig {
+        size_t max_links = 1024;           ///< Directory entries
+        size_t arena_bytes = 256ULL << 20; ///< Ring memory shared by all links (sparse until used)
+        size_t block_size = 64 << 10;      ///< Allocation unit of the arena (multiple of 4096)
+        ShmMemoryOptions memory = {};      ///< Placement of the whole segment (huge pages, mlock/prefault, NUMA)
+        bool wakeups = true;               ///< Exchange wakeup eventfds when a peer attaches
+    };
+
+    /// One link in a ShmRegistry directory
+    struct ShmRegistryLinkInfo {
+        String name;             ///< Link name
+        size_t capacity = 0;     ///< Capacity of each ring in bytes
+        int creator_pid = 0;     ///< Process that created the link (0 = closed)
+        int attacher_pid = 0;    ///< Process attached to it (0 = none)
+        uint64_t created_ns = 0; ///< When the link was created (wall_ns())
+    };
+
+    namespace detail {
+        constexpr uint64_t SHM_REGISTRY_MAGIC = 0x5347455254494257ULL; ///< 'WBITREGS' (little endian)
+        constexpr uint32_t SHM_REGISTRY_VERSION = 1;
+        constexpr size_t SHM_REGISTRY_NAME_LEN = 64;
+
+        constexpr uint32_t SHM_REGISTRY_WAKEUPS = 1u << 0; ///< Header flag: attachers deliver eventfds
+
+        constexpr uint32_t SHM_ENTRY_FREE = 0; ///< Unused directory entry
+        constexpr uint32_t SHM_ENTRY_LIVE = 1; ///< Link with ring memory in the arena
+
+        constexpr uint32_t SHM_ENTRY_WAKEUPS_SENT = 1u << 0; ///< Entry flag: eventfds went to the creator
+
+        /// Header at the start of the registry segment
+        /// Everything below it is only changed under the segment lock.
+        struct ShmRegistryHeader {
+            std::atomic<uint64_t> magic;   ///< SHM_REGISTRY_MAGIC once initialized
+            uint32_t version;              ///< SHM_REGISTRY_VERSION
+            uint32_t max_links;            ///< Directory entries
+            uint64_t block_size;           ///< Arena allocation unit in bytes
+            uint64_t block_count;          ///< Arena blocks
+            uint64_t arena_offset;         ///< Arena start from the segment start (page aligned)
+            std::atomic<int32_t> lock_pid; ///< Process holding the segment lock (0 = unlocked)
+            uint32_t flags;                ///< SHM_REGISTRY_*
+            uint64_t next_generation;      ///< Generation of the next created link
+            uint8_t reserved[8];           ///< Pads the header to one cache line
+        };
+
+        /// Directory entry of one link; its two rings are block_count contiguous arena blocks
+        struct ShmRegistryEntry {
+            uint32_t state;                   ///< SHM_ENTRY_*
+            uint32_t flags;                   ///< SHM_ENTRY_WAKEUPS_SENT
+            int32_t creator_pid;              ///< Creating process (0 = closed)
+            int32_t attacher_pid;             ///< Attached process (0 = none)
+            uint32_t creator_mailbox;         ///< Mailbox of the creator's registry handle
+            uint32_t reserved0;               ///< Padding
+            uint64_t generation;              ///< Unique per created link (matches eventfd deliveries)
+            uint64_t first_block;             ///< First arena block
+            uint64_t block_count;             ///< Arena blocks (both rings)
+            uint64_t ring_bytes;              ///< Bytes per ring (control block and data)
+            uint64_t created_ns;              ///< wall_ns() at creation
+            char name[SHM_REGISTRY_NAME_LEN]; ///< Link name
+            uint8_t reserved[64];             ///< Pads the entry to three cache lines
+        };
+
+        static_assert(sizeof(ShmRegistryHeader) == 64, "Registry header must fill one cache line");
+        static_assert(sizeof(ShmRegistryEntry) % 64 == 0, "Registry entries must be cache-line sized");
+
+        /// Eventfd delivery sent by an attacher to the creator's mailbox (fds travel as SCM_RIGHTS)
+        struct ShmWakeupMessage {
+            uint64_t generation; ///< Link the eventfds belong to
+        };
+
+        inline bool shm_pid_alive(int32_t pid) { return pid > 0 && (::kill(pid, 0) == 0 || errno != ESRCH); }
+
+        inline uint32_t next_mailbox_id() {
+            static std::atomic<uint32_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Fill an abstract Unix socket address for a registry handle's mailbox
+        /// Abstract sockets are not files, so a crashed process leaves nothing behind.
+        inline socklen_t mailbox_address(const String &shm_name, int32_t pid, uint32_t mailbox, sockaddr_un &addr) {
+            addr = {};
+            addr.sun_family = AF_UNIX;
+            int n = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "wirebit%s.%d.%u", shm_name.c_str(),
+                             static_cast<int>(pid), mailbox);
+            size_t len = std::min(static_cast<size_t>(std::max(n, 0)), sizeof(addr.sun_path) - 2);
+            return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + len);
+        }
+
+        /// Process-local view of a registry segment, shared by the ShmRegistry handle and its links
+        struct ShmRegistryMapping {
+            Byte *mem = nullptr;
+            size_t map_size = 0;
+            String shm_name;
+            ShmMemoryInfo info;
+            int mailbox_fd = -1;  ///< Listening socket peers deliver eventfds to
+            uint32_t mailbox = 0; ///< Mailbox id (several handles may map the registry in one process)
+
+            std::mutex mutex;                                    ///< Guards delivered
+            std::unordered_map<uint64_t, EventfdPair> delivered; ///< Eventfds by link generation
+
+            ~ShmRegistryMapping() {
+                for (auto &[generation, fds] : delivered) {
+                    fds.close_all();
+                }
+                if (mailbox_fd >= 0) {
+                    ::close(mailbox_fd);
+                }
+                if (mem != nullptr) {
+                    munmap(mem, map_size);
+                }
+            }
+
+            inline ShmRegistryHeader *header() const { return reinterpret_cast<ShmRegistryHeader *>(mem); }
+
+            inline ShmRegistryEntry *entry(size_t i) const {
+                return reinterpret_cast<ShmRegistryEntry *>(mem + sizeof(ShmRegistryHeader)) + i;
+            }
+
+            inline uint64_t *bitmap() const {
+                return reinterpret_cast<uint64_t *>(mem + sizeof(ShmRegistryHeader) +
+                                                    header()->max_links * sizeof(ShmRegistryEntry));
+            }
+
+            inline Byte *block(uint64_t index) const {
+                return mem + header()->arena_offset + index * header()->block_size;
+            }
+
+            /// Take the segment lock; a lock held by a process that died is taken over
+            /// @return true if the lock was taken over (the directory may be half-updated)
+            inline bool lock() const {
+                std::atomic<int32_t> &owner = header()->lock_pid;
+                const int32_t self = static_cast<int32_t>(::getpid());
+                for (uint32_t spins = 0;; ++spins) {
+                    int32_t holder = 0;
+                    if (owner.compare_exchange_weak(holder, self, std::memory_order_acquire)) {
+                        return false;
+                    }
+                    if (holder != 0 && holder != self && !shm_pid_alive(holder) &&
+                        owner.compare_exchange_strong(holder, self, std::memory_order_acquire)) {
+                        echo::warn("ShmRegistry lock of dead process ", holder, " taken over").yellow();
+                        return true;
+                    }
+                    if (spins < 64) {
+                        cpu_relax();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            inline void unlock() const { header()->lock_pid.store(0, std::memory_order_release); }
+        };
+
+        /// Set or clear a run of arena blocks in the bitmap (caller holds the lock)
+        inline void shm_mark_blocks(const ShmRegistryMapping &map, uint64_t first, uint64_t count, bool used) {
+            uint64_t *bits = map.bitmap();
+            for (uint64_t b = first; b < first + count; ++b) {
+                if (used) {
+                    bits[b / 64] |= 1ULL << (b % 64);
+                } else {
+                    bits[b / 64] &= ~(1ULL << (b % 64));
+                }
+            }
+        }
+
+        /// Segment lock holder; repairs the block bitmap after taking over a dead holder's lock
+        class ShmRegistryLock {
+          public:
+            explicit ShmRegistryLock(const ShmRegistryMapping &map) : map_(map) {
+                if (map_.lock()) {
+                    rebuild_bitmap();
+                }
+            }
+            ~ShmRegistryLock() { map_.unlock(); }
+
+            ShmRegistryLock(const ShmRegistryLock &) = delete;
+            ShmRegistryLock &operator=(const ShmRegistryLock &) = delete;
+
+          private:
+            const ShmRegistryMapping &map_;
+
+            inline void rebuild_bitmap() {
+                ShmRegistryHeader *header = map_.header();
+                std::memset(map_.bitmap(), 0, (header->block_count + 63) / 64 * sizeof(uint64_t));
+                for (size_t i = 0; i < header->max_links; ++i) {
+                    const ShmRegistryEntry *e = map_.entry(i);
+                    if (e->state == SHM_ENTRY_LIVE) {
+                        shm_mark_blocks(map_, e->first_block, e->block_count, true);
+                    }
+                }
+            }
+        };
+
+        /// Lease on a registry link held by the ShmLink: keeps the arena mapped, gives the directory
+        /// entry back when the link is destroyed, and hands the creator the eventfds from its mailbox
+        class ShmRegistryLease : public ShmLinkBacking {
+          public:
+            ShmRegistryLease(std::shared_ptr<ShmRegistryMapping> map, size_t index, uint64_t generation, bool creator)
+                : map_(std::move(map)), index_(index), generation_(generation), creator_(creator) {}
+
+            ~ShmRegistryLease() override {
+                ShmRegistryLock lock(*map_);
+                ShmRegistryEntry *e = map_->entry(index_);
+                if (e->state != SHM_ENTRY_LIVE || e->generation != generation_) {
+                    return;
+                }
+                if (creator_) {
+                    e->creator_pid = 0;
+                } else {
+                    e->attacher_pid = 0;
+                }
+                if (!shm_pid_alive(e->creator_pid) && !shm_pid_alive(e->attacher_pid)) {
+                    free_entry(*map_, *e);
+                }
+            }
+
+            Result<EventfdPair, Error> wakeups(int timeout_ms) override {
+                if ((map_->header()->flags & SHM_REGISTRY_WAKEUPS) == 0) {
+                    return Result<EventfdPair, Error>::err(Error::invalid_argument("Registry has wakeups disabled"));
+                }
+                uint64_t give_up_at = static_cast<uint64_t>(wall_ns()) + static_cast<uint64_t>(ms_to_ns(timeout_ms));
+                while (true) {
+                    {
+                        std::lock_guard<std::mutex> guard(map_->mutex);
+                        drain_mailbox(*map_);
+                        auto it = map_->delivered.find(generation_);
+                        if (it != map_->delivered.end()) {
+                            EventfdPair fds = it->second;
+                            map_->delivered.erase(it);
+                            return Result<EventfdPair, Error>::ok(fds);
+                        }
+                    }
+                    uint64_t now = static_cast<uint64_t>(wall_ns());
+                    if (now >= give_up_at) {
+                        return Result<EventfdPair, Error>::err(Error::timeout("No wakeup eventfds from peer"));
+                    }
+                    struct pollfd pfd = {map_->mailbox_fd, POLLIN, 0};
+                    ::poll(&pfd, 1, static_cast<int>(std::min<uint64_t>((give_up_at - now + 999999) / 1000000, 10)));
+                }
+            }
+
+            /// Helper: Return an entry's blocks to the arena
+            static inline void free_entry(const ShmRegistryMapping &map, ShmRegistryEntry &e) {
+                shm_mark_blocks(map, e.first_block, e.block_count, false);
+                WIREBIT_DEBUG("ShmRegistry: freed ", e.name, " (", e.block_count, " blocks)");
+                e = ShmRegistryEntry{};
+            }
+
+            /// Helper: Accept every pending delivery (non-blocking; caller holds map.mutex)
+            static inline void drain_mailbox(ShmRegistryMapping &map) {
+                while (true) {
+                    int conn = ::accept4(map.mailbox_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (conn < 0) {
+                        return;
+                    }
+                    // The peer sends right after connecting; wait briefly in case we got here first
+                    struct pollfd pfd = {conn, POLLIN, 0};
+                    ::poll(&pfd, 1, 100);
+
+                    ShmWakeupMessage message = {};
+                    struct iovec iov = {&message, sizeof(message)};
+                    char cmsg_buf[CMSG_SPACE(sizeof(int) * EVENTFD_SET_SIZE)];
+                    struct msghdr msg = {};
+                    msg.msg_iov = &iov;
+                    msg.msg_iovlen = 1;
+                    msg.msg_control = cmsg_buf;
+                    msg.msg_controllen = sizeof(cmsg_buf);
+                    ssize_t n = ::recvmsg(conn, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+                    ::close(conn);
+
+                    EventfdPair fds;
+                    if (n < 0 || !take_eventfds(msg, fds) || n != sizeof(message)) {
+                        fds.close_all();
+                        echo::warn("ShmRegistry: malformed wakeup delivery ignored").yellow();
+                        continue;
+                    }
+                    auto [it, inserted] = map.delivered.emplace(message.generation, fds);
+                    if (!inserted) {
+                        fds.close_all();
+                    }
+                }
+            }
+
+          private:
+            std::shared_ptr<ShmRegistryMapping> map_;
+            size_t index_;
+            uint64_t generation_;
+            bool creator_;
+        };
+    } // namespace detail
+
+    /// Directory of ShmLinks carved from one pre-mapped shared memory arena
+    ///
+    /// ShmLink::create()/attach() open and map two segments per link and exchange wakeup eventfds
+    /// through a per-link socket whose creator blocks in accept(). A topology of hundreds of links
+    /// then spends its startup in shm_open()/mmap() and in serialized handshakes. A registry maps one
+    /// segment per process, once; creating or attaching a link is a directory update under a short
+    /// lock and takes ring memory from the already mapped arena, so it costs no system calls.
+    ///
+    /// Rendezvous does not block: links can be created and attached in any order and from any number
+    /// of processes, and open_link() creates a link or attaches to it, whichever side comes second.
+    /// The attaching side creates the wakeup eventfds and leaves them in the creator's mailbox (an
+    /// abstract Unix socket per registry handle), so its link has wakeups at once. The creator picks
+    /// them up in ShmLink::enable_wakeups(), which waits only if the peer has not attached yet.
+    ///
+    /// Links left by processes that died are reclaimed when their name or their memory is needed,
+    /// or by reap(). The registry segment itself persists like any POSIX shm segment; remove it with
+    /// unlink() once every process is done.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto registry = ShmRegistry::open().value();
+    /// Vector<ShmLink> links;
+    /// for (int i = 0; i < 500; ++i) {
+    ///     links.push_back(registry.open_link("ecu" + std::to_string(i), 64 * 1024).value());
+    /// }
+    /// @endcode
+    class ShmRegistry {
+      public:
+        /// Default segment name
+        static constexpr const char *DEFAULT_NAME = "/wirebit_links";
+
+        /// Open (or create) a registry
+        /// @param shm_name Shared memory name (must start with '/')
+        /// @param config Geometry and placement if the registry is created here (ignored when it exists)
+        /// @return Result containing ShmRegistry or error
+        static Result<ShmRegistry, Error> open(const String &shm_name = DEFAULT_NAME,
+                                               const ShmRegistryConfig &config = ShmRegistryConfig{}) {
+            if (config.max_links == 0 || config.max_links > UINT32_MAX || config.block_size == 0 ||
+                config.block_size % 4096 != 0 || config.arena_bytes < config.block_size) {
+                return Result<ShmRegistry, Error>::err(Error::invalid_argument("Invalid registry geometry"));
+            }
+
+            auto map = std::make_shared<detail::ShmRegistryMapping>();
+            map->shm_name = shm_name;
+
+            bool created = true;
+            int fd = detail::open_segment(shm_name, config.memory, true, map->info, true);
+            if (fd < 0 && errno == EEXIST) {
+                created = false;
+                fd = detail::open_segment(shm_name, config.memory, false, map->info);
+            }
+            if (fd < 0) {
+                echo::error("Failed to open link registry ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<ShmRegistry, Error>::err(Error::io_error("shm_open() failed"));
+            }
+
+            uint64_t block_count = config.arena_bytes / config.block_size;
+            size_t directory = sizeof(detail::ShmRegistryHeader) + config.max_links * sizeof(detail::ShmRegistryEntry) +
+                               (block_count + 63) / 64 * sizeof(uint64_t);
+            size_t page = std::max<size_t>(map->info.page_size, 4096);
+            size_t arena_offset = detail::round_to_page(directory, page);
+            size_t map_size = detail::round_to_page(arena_offset + block_count * config.block_size, page);
+
+            if (created) {
+                if (ftruncate(fd, static_cast<off_t>(map_size)) < 0) {
+                    echo::error("Failed to size link registry ", shm_name.c_str(), ": ", strerror(errno)).red();
+                    close(fd);
+                    detail::unlink_segment(shm_name, config.memory.hugetlbfs_dir, map->info.hugetlbfs);
+                    return Result<ShmRegistry, Error>::err(Error::io_error("ftruncate() failed"));
+                }
+            } else {
+                // The creator may still be sizing the segment
+                struct stat st;
+                for (int i = 0; i < 1000; ++i) {
+                    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(detail::ShmRegistryHeader)) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(detail::ShmRegistryHeader)) {
+                    close(fd);
+                    return Result<ShmRegistry, Error>::err(Error::io_error("Link registry has invalid size"));
+                }
+                map_size = static_cast<size_t>(st.st_size);
+            }
+
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map link registry ", shm_name.c_str(), ": ", strerror(errno)).red();
+                if (created) {
+                    detail::unlink_segment(shm_name, config.memory.hugetlbfs_dir, map->info.hugetlbfs);
+                }
+                return Result<ShmRegistry, Error>::err(Error::io_error("mmap() failed"));
+            }
+            map->mem = static_cast<Byte *>(mem);
+            map->map_size = map_size;
+            detail::place_segment(mem, map_size, config.memory, created, map->info);
+
+            detail::ShmRegistryHeader *header = map->header();
+            if (created) {
+                header->version = detail::SHM_REGISTRY_VERSION;
+                header->max_links = static_cast<uint32_t>(config.max_links);
+                header->block_size = config.block_size;
+                header->block_count = block_count;
+                header->arena_offset = arena_offset;
+                header->flags = config.wakeups ? detail::SHM_REGISTRY_WAKEUPS : 0;
+                header->next_generation = 1;
+                header->magic.store(detail::SHM_REGISTRY_MAGIC, std::memory_order_release);
+            } else {
+                for (int i = 0; i < 1000 && header->magic.load(std::memory_order_acquire) != detail::SHM_REGISTRY_MAGIC;
+                     ++i) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                if (header->magic.load(std::memory_order_acquire) != detail::SHM_REGISTRY_MAGIC ||
+                    header->version != detail::SHM_REGISTRY_VERSION || header->block_size == 0 ||
+                    header->arena_offset + header->block_count * header->block_size > map_size) {
+                    echo::error("Link registry ", shm_name.c_str(), " is not initialized or incompatible").red();
+                    return Result<ShmRegistry, Error>::err(Error::invalid_argument("Invalid link registry"));
+                }
+            }
+
+            auto mailbox = open_mailbox(*map);
+            if (!mailbox.is_ok()) {
+                return Result<ShmRegistry, Error>::err(mailbox.error());
+            }
+
+            ShmRegistry registry(std::move(map));
+            size_t reaped = registry.reap();
+            WIREBIT_DEBUG("ShmRegistry ", created ? "created: " : "opened: ", shm_name.c_str(), " (",
+                          registry.max_links(), " links, ", registry.arena_bytes(), " arena bytes, ", reaped,
+                          " stale links reaped)");
+            return Result<ShmRegistry, Error>::ok(std::move(registry));
+        }
+
+        /// Remove a registry segment (processes that have it open keep their mapping)
+        /// @param shm_name Shared memory name
+        /// @param memory Placement the registry was created with (for hugetlbfs segments)
+        static inline void unlink(const String &shm_name = DEFAULT_NAME, const ShmMemoryOptions &memory = {}) {
+            detail::unlink_segment(shm_name, memory.hugetlbfs_dir, memory.huge_pages == ShmHugePages::Hugetlbfs);
+            shm_unlink(shm_name.c_str());
+        }
+
+        ShmRegistry(ShmRegistry &&) noexcept = default;
+        ShmRegistry &operator=(ShmRegistry &&) noexcept = default;
+        ShmRegistry(const ShmRegistry &) = delete;
+        ShmRegistry &operator=(const ShmRegistry &) = delete;
+
+        /// Create a link (server side, like ShmLink::create())
+        /// @param name Link name (up to 63 characters)
+        /// @param capacity_bytes Capacity of each ring (rounded up to fill whole arena blocks)
+        /// @param model Optional link model for simulation (nullptr = no simulation)
+        /// @param header_version Record header format of both rings
+        /// @return Result containing ShmLink, invalid_argument if the name is taken by a live link, or
+        ///         timeout if the directory or the arena is full
+        Result<ShmLink, Error> create(const String &name, size_t capacity_bytes, const LinkModel *model = nullptr,
+                                      uint16_t header_version = FRAME_HEADER_V1) {
+            if (name.size() == 0 || name.size() >= detail::SHM_REGISTRY_NAME_LEN || capacity_bytes == 0) {
+                return Result<ShmLink, Error>::err(Error::invalid_argument("Invalid registry link name or capacity"));
+            }
+            if (header_version != FRAME_HEADER_V1 && header_version != FRAME_HEADER_V2) {
+                return Result<ShmLink, Error>::err(Error::invalid_argument("Unsupported frame header version"));
+            }
+
+            detail::ShmRegistryMapping &map = *map_;
+            detail::ShmRegistryHeader *header = map.header();
+            uint64_t ring_bytes = sizeof(detail::RingControl) + ((capacity_bytes + 7) & ~size_t(7));
+            ring_bytes = (ring_bytes + header->block_size - 1) / header->block_size * header->block_size;
+            uint64_t blocks = 2 * ring_bytes / header->block_size;
+
+            size_t index = 0;
+            uint64_t generation = 0;
+            Result<FrameRing, Error> a_ring = Result<FrameRing, Error>::err(Error::io_error("unset"));
+            Result<FrameRing, Error> b_ring = Result<FrameRing, Error>::err(Error::io_error("unset"));
+            {
+                detail::ShmRegistryLock lock(map);
+                detail::ShmRegistryEntry *existing = find(name);
+                if (existing != nullptr) {
+                    if (!stale(*existing)) {
+                        return Result<ShmLink, Error>::err(Error::invalid_argument("Registry link already exists"));
+                    }
+                    detail::ShmRegistryLease::free_entry(map, *existing);
+                }
+
+                auto slot = allocate(blocks);
+                if (!slot.is_ok() && reap_locked() > 0) {
+                    slot = allocate(blocks);
+                }
+                if (!slot.is_ok()) {
+                    echo::warn("Link registry full, cannot create ", name.c_str()).yellow();
+                    return Result<ShmLink, Error>::err(slot.error());
+                }
+                index = slot.value().first;
+                detail::ShmRegistryEntry &e = *map.entry(index);
+                e.state = detail::SHM_ENTRY_LIVE;
+                e.flags = 0;
+                e.creator_pid = static_cast<int32_t>(::getpid());
+                e.attacher_pid = 0;
+                e.creator_mailbox = map.mailbox;
+                e.generation = header->next_generation++;
+                e.first_block = slot.value().second;
+                e.block_count = blocks;
+                e.ring_bytes = ring_bytes;
+                e.created_ns = static_cast<uint64_t>(wall_ns());
+                std::memset(e.name, 0, sizeof(e.name));
+                std::memcpy(e.name, name.c_str(), name.size());
+                generation = e.generation;
+
+                // Initialized under the lock, so an attacher never sees the previous owner's rings
+                Byte *mem = map.block(e.first_block);
+                a_ring = FrameRing::create_at(mem, ring_bytes, header_version, map.info);
+                b_ring = FrameRing::create_at(mem + ring_bytes, ring_bytes, header_version, map.info);
+            }
+
+            // A is creator -> attacher, B the way back (ShmLink::create() names them _tx and _rx)
+            auto lease = std::make_unique<detail::ShmRegistryLease>(map_, index, generation, true);
+            ShmLink link(name, std::move(a_ring.value()), std::move(b_ring.value()));
+            link.backing_ = std::move(lease);
+            link.creator_ = true;
+            if (model != nullptr) {
+                link.set_model(*model);
+            }
+            WIREBIT_DEBUG("ShmRegistry: created ", name.c_str(), " in slot ", index).green();
+            return Result<ShmLink, Error>::ok(std::move(link));
+        }
+
+        /// Attach to a link (client side, like ShmLink::attach())
+        /// Returns at once: not_found if the link has not been created (yet), so callers may retry.
+        /// With wakeups configured, the link's eventfds are created here and left for the creator.
+        /// @param name Link name
+        /// @param model Optional link model for simulation (nullptr = no simulation)
+        /// @return Result containing ShmLink, not_found, or invalid_argument if another process is attached
+        Result<ShmLink, Error> attach(const String &name, const LinkModel *model = nullptr) {
+            detail::ShmRegistryMapping &map = *map_;
+            detail::ShmRegistryEntry snapshot;
+            size_t index = 0;
+            bool deliver = false;
+            Result<FrameRing, Error> a_ring = Result<FrameRing, Error>::err(Error::io_error("unset"));
+            Result<FrameRing, Error> b_ring = Result<FrameRing, Error>::err(Error::io_error("unset"));
+            {
+                detail::ShmRegistryLock lock(map);
+                detail::ShmRegistryEntry *e = find(name);
+                if (e == nullptr || !detail::shm_pid_alive(e->creator_pid)) {
+                    return Result<ShmLink, Error>::err(Error::not_found("Registry link does not exist"));
+                }
+                if (detail::shm_pid_alive(e->attacher_pid)) {
+                    return Result<ShmLink, Error>::err(Error::invalid_argument("Registry link already attached"));
+                }
+
+                Byte *mem = map.block(e->first_block);
+                a_ring = FrameRing::attach_at(mem, e->ring_bytes, map.info);
+                b_ring = FrameRing::attach_at(mem + e->ring_bytes, e->ring_bytes, map.info);
+                if (!a_ring.is_ok() || !b_ring.is_ok()) {
+                    return Result<ShmLink, Error>::err(Error::invalid_argument("Registry link rings are corrupt"));
+                }
+
+                e->attacher_pid = static_cast<int32_t>(::getpid());
+                deliver = (map.header()->flags & detail::SHM_REGISTRY_WAKEUPS) != 0 &&
+                          (e->flags & detail::SHM_ENTRY_WAKEUPS_SENT) == 0;
+                e->flags |= detail::SHM_ENTRY_WAKEUPS_SENT;
+                index = static_cast<size_t>(e - map.entry(0));
+                snapshot = *e;
+            }
+
+            auto lease = std::make_unique<detail::ShmRegistryLease>(map_, index, snapshot.generation, false);
+            ShmLink link(name, std::move(b_ring.value()), std::move(a_ring.value()));
+            link.backing_ = std::move(lease);
+            if (model != nullptr) {
+                link.set_model(*model);
+            }
+            if (deliver) {
+                auto fds = deliver_wakeups(snapshot);
+                if (fds.is_ok()) {
+                    link.wakeup_.adopt(fds.value(), false);
+                }
+            } else if ((map.header()->flags & detail::SHM_REGISTRY_WAKEUPS) != 0) {
+                echo::warn("Registry link ", name.c_str(), " re-attached without wakeups (recreate it for them)")
+                    .yellow();
+            }
+            WIREBIT_DEBUG("ShmRegistry: attached ", name.c_str(), " in slot ", index).green();
+            return Result<ShmLink, Error>::ok(std::move(link));
+        }
+
+        /// Create a link, or attach to it if another process created it first
+        /// Both peers can call this in any order; neither waits for the other.
+        /// @param name Link name
+        /// @param capacity_bytes Ring capacity if the link is created here
+        /// @param model Optional link model for simulation (nullptr = no simulation)
+        /// @return Result containing ShmLink or error
+        Result<ShmLink, Error> open_link(const String &name, size_t capacity_bytes, const LinkModel *model = nullptr) {
+            for (int attempt = 0; attempt < 2; ++attempt) {
+                auto attached = attach(name, model);
+                if (attached.is_ok() || attached.error().code != Error::not_found("").code) {
+                    return attached;
+                }
+                auto created = create(name, capacity_bytes, model);
+                if (created.is_ok() || created.error().code != Error::invalid_argument("").code) {
+                    return created;
+                }
+                // Lost the race to create it: attach to the winner's link
+            }
+            return attach(name, model);
+        }
+
+        /// Free the links of processes that have exited
+        /// @return Number of links reclaimed
+        inline size_t reap() {
+            detail::ShmRegistryLock lock(*map_);
+            return reap_locked();
+        }
+
+        /// List the links in the directory
+        Vector<ShmRegistryLinkInfo> links() const {
+            Vector<ShmRegistryLinkInfo> result;
+            detail::ShmRegistryLock lock(*map_);
+            for (size_t i = 0; i < max_links(); ++i) {
+                const detail::ShmRegistryEntry *e = map_->entry(i);
+                if (e->state != detail::SHM_ENTRY_LIVE) {
+                    continue;
+                }
+                ShmRegistryLinkInfo info;
+                info.name = String(std::string(e->name, strnlen(e->name, sizeof(e->name))).c_str());
+                info.capacity = static_cast<size_t>((e->ring_bytes - sizeof(detail::RingControl)) & ~uint64_t(7));
+                info.creator_pid = e->creator_pid;
+                info.attacher_pid = e->attacher_pid;
+                info.created_ns = e->created_ns;
+                result.push_back(std::move(info));
+            }
+            return result;
+        }
+
+        /// Get number of links in the directory
+        inline size_t link_count() const {
+            detail::ShmRegistryLock lock(*map_);
+            size_t count = 0;
+            for (size_t i = 0; i < max_links(); ++i) {
+                count += map_->entry(i)->state == detail::SHM_ENTRY_LIVE ? 1 : 0;
+            }
+            return count;
+        }
+
+        /// Get arena bytes not allocated to any link
+        inline size_t free_bytes() const {
+            detail::ShmRegistryLock lock(*map_);
+            const detail::ShmRegistryHeader *header = map_->header();
+            const uint64_t *bits = map_->bitmap();
+            uint64_t used = 0;
+            for (uint64_t w = 0; w < (header->block_count + 63) / 64; ++w) {
+                used += static_cast<uint64_t>(__builtin_popcountll(bits[w]));
+            }
+            return static_cast<size_t>((header->block_count - used) * header->block_size);
+        }
+
+        /// Get capacity of the directory
+        inline size_t max_links() const { return map_->header()->max_links; }
+
+        /// Get size of the ring arena in bytes
+        inline size_t arena_bytes() const {
+            return static_cast<size_t>(map_->header()->block_count * map_->header()->block_size);
+        }
+
+        /// Get the placement applied to the registry mapping
+        inline const ShmMemoryInfo &memory_info() const { return map_->info; }
+
+        /// Get the shared memory name
+        inline const String &shm_name() const { return map_->shm_name; }
+
+      private:
+        std::shared_ptr<detail::ShmRegistryMapping> map_; ///< Shared with the leases of open links
+
+        explicit ShmRegistry(std::shared_ptr<detail::ShmRegistryMapping> map) : map_(std::move(map)) {}
+
+        /// Helper: Bind this handle's mailbox socket
+        static inline Result<Unit, Error> open_mailbox(detail::ShmRegistryMapping &map) {
+            map.mailbox = detail::next_mailbox_id();
+            map.mailbox_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (map.mailbox_fd < 0) {
+                echo::error("Failed to create registry mailbox: ", strerror(errno)).red();
+                return Result<Unit, Error>::err(Error::io_error("socket() failed"));
+            }
+            sockaddr_un addr;
+            socklen_t len = detail::mailbox_address(map.shm_name, static_cast<int32_t>(::getpid()), map.mailbox, addr);
+            if (::bind(map.mailbox_fd, reinterpret_cast<sockaddr *>(&addr), len) < 0 ||
+                ::listen(map.mailbox_fd, SOMAXCONN) < 0) {
+                echo::error("Failed to bind registry mailbox: ", strerror(errno)).red();
+                return Result<Unit, Error>::err(Error::io_error("bind() failed"));
+            }
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        /// Helper: Create a link's eventfds and leave them in the creator's mailbox
+        /// The connection is queued in the creator's listen backlog, so this never waits for it.
+        Result<EventfdPair, Error> deliver_wakeups(const detail::ShmRegistryEntry &e) const {
+            auto created = create_eventfds(EFD_CLOEXEC);
+            EventfdPair efds = created.is_ok() ? created.value() : EventfdPair{};
+            int sock_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            bool sent = created.is_ok() && sock_fd >= 0;
+
+            if (sent) {
+                sockaddr_un addr;
+                socklen_t len = detail::mailbox_address(map_->shm_name, e.creator_pid, e.creator_mailbox, addr);
+                sent = ::connect(sock_fd, reinterpret_cast<sockaddr *>(&addr), len) == 0;
+            }
+            if (sent) {
+                detail::ShmWakeupMessage message = {e.generation};
+                struct iovec iov = {&message, sizeof(message)};
+                char cmsg_buf[CMSG_SPACE(sizeof(int) * EVENTFD_SET_SIZE)] = {};
+                struct msghdr msg = {};
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = cmsg_buf;
+                msg.msg_controllen = sizeof(cmsg_buf);
+                struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = SOL_SOCKET;
+                cmsg->cmsg_type = SCM_RIGHTS;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(int) * EVENTFD_SET_SIZE);
+                int fds[EVENTFD_SET_SIZE] = {efds.a2b, efds.b2a, efds.space_a2b, efds.space_b2a};
+                std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+                sent = ::sendmsg(sock_fd, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(message));
+            }
+            int error = errno;
+            if (sock_fd >= 0) {
+                ::close(sock_fd);
+            }
+            if (!sent) {
+                echo::warn("Registry link ", e.name, ": wakeup delivery failed (", strerror(error),
+                           "), link is polled")
+                    .yellow();
+                efds.close_all();
+                return Result<EventfdPair, Error>::err(Error::io_error("Wakeup delivery failed"));
+            }
+            return Result<EventfdPair, Error>::ok(efds);
+        }
+
+        /// Helper: Find the live entry of a name (caller holds the lock)
+        inline detail::ShmRegistryEntry *find(const String &name) const {
+            for (size_t i = 0; i < max_links(); ++i) {
+                detail::ShmRegistryEntry *e = map_->entry(i);
+                if (e->state == detail::SHM_ENTRY_LIVE && std::strncmp(e->name, name.c_str(), sizeof(e->name)) == 0) {
+                    return e;
+                }
+            }
+            return nullptr;
+        }
+
+        /// Helper: Check whether both ends of a link are gone
+        static inline bool stale(const detail::ShmRegistryEntry &e) {
+            return !detail::shm_pid_alive(e.creator_pid) && !detail::shm_pid_alive(e.attacher_pid);
+        }
+
+        /// Helper: Free stale entries (caller holds the lock)
+        inline size_t reap_locked() {
+            size_t reaped = 0;
+            for (size_t i = 0; i < max_links(); ++i) {
+                detail::ShmRegistryEntry *e = map_->entry(i);
+                if (e->state == detail::SHM_ENTRY_LIVE && stale(*e)) {
+                    detail::ShmRegistryLease::free_entry(*map_, *e);
+                    ++reaped;
+                }
+            }
+            return reaped;
+        }
+
+        /// Helper: Find a free entry and a run of free blocks (caller holds the lock)
+        /// @return (entry index, first block), or timeout if either is exhausted
+        Result<std::pair<size_t, uint64_t>, Error> allocate(uint64_t blocks) {
+            using Slot = std::pair<size_t, uint64_t>;
+            size_t index = max_links();
+            for (size_t i = 0; i < max_links(); ++i) {
+                if (map_->entry(i)->state == detail::SHM_ENTRY_FREE) {
+                    index = i;
+                    break;
+                }
+            }
+            if (index == max_links()) {
+                return Result<Slot, Error>::err(Error::timeout("Link registry directory full"));
+            }
+
+            // First fit over the block bitmap
+            const uint64_t *bits = map_->bitmap();
+            uint64_t total = map_->header()->block_count;
+            uint64_t run = 0;
+            for (uint64_t b = 0; b < total; ++b) {
+                if ((bits[b / 64] >> (b % 64)) & 1) {
+                    run = 0;
+                    continue;
+                }
+                if (++run == blocks) {
+                    uint64_t first = b + 1 - blocks;
+                    detail::shm_mark_blocks(*map_, first, blocks, true);
+                    return Result<Slot, Error>::ok(Slot{index, first});
+                }
+            }
+            return Result<Slot, Error>::err(Error::timeout("Link registry arena full"));
+        }
+    };
+
+} // namespace wirebit
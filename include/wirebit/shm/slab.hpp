@@ -0,0 +1,333 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <new>
+#include <span>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/shm/memory.hpp>
+
+namespace wirebit {
+
+    /// Large-payload slab of a ShmLink (see ShmLink::enable_slab())
+    struct ShmSlabConfig {
+        size_t slab_bytes = 64 << 20; ///< Slab size per direction in bytes
+        size_t block_size = 64 << 10; ///< Allocation unit in bytes (multiple of 64)
+        size_t threshold = 16 << 10;  ///< Payloads of at least this many bytes are sent through the slab
+        ShmMemoryOptions memory;      ///< Placement of the slab mappings
+    };
+
+    /// Location of a payload in a ShmSlab; travels through the ring in place of the payload
+    struct ShmSlabHandle {
+        uint32_t first_block = 0; ///< First block of the run
+        uint32_t block_count = 0; ///< Blocks in the run
+        uint64_t length = 0;      ///< Payload bytes
+    };
+
+    static_assert(sizeof(ShmSlabHandle) == 16, "Slab handles are sent as 16-byte ring payloads");
+
+    namespace detail {
+        constexpr uint64_t SLAB_MAGIC = 0x42414C5354494257ULL; ///< 'WBITSLAB' (little endian)
+
+        /// Control block at the start of every slab segment, followed by one state word per block
+        struct SlabControl {
+            uint64_t magic;       ///< SLAB_MAGIC once initialized
+            uint64_t block_size;  ///< Allocation unit in bytes
+            uint64_t block_count; ///< Number of blocks
+            uint64_t data_offset; ///< Offset of block 0 from the segment start (page aligned)
+            uint8_t reserved[32]; ///< Pads the control block to one cache line
+        };
+
+        static_assert(sizeof(SlabControl) == 64, "Slab control block must fill one cache line");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "Slab block states must be lock-free for SHM use");
+    } // namespace detail
+
+    /// SPSC block allocator in shared memory, for payloads too large to copy through a FrameRing
+    /// The producer allocates runs of contiguous blocks, next fit from where the last run ended, so
+    /// blocks cycle in the same order as the ring records carrying their handles. The consumer reads
+    /// the payload in place and releases the run once done. Every block has a state word: only the
+    /// producer marks free blocks used, only the consumer (or the producer for a run it never
+    /// published) marks them free again, with release/acquire ordering between the two.
+    class ShmSlab {
+      public:
+        /// Create a new slab in shared memory
+        /// @param shm_name Shared memory name (must start with '/')
+        /// @param slab_bytes Data size in bytes (rounded down to whole blocks)
+        /// @param block_size Allocation unit in bytes (multiple of 64)
+        /// @param memory Backing memory placement (huge pages, locking, NUMA node)
+        static Result<ShmSlab, Error> create_shm(const String &shm_name, size_t slab_bytes, size_t block_size,
+                                                 const ShmMemoryOptions &memory = ShmMemoryOptions{}) {
+            WIREBIT_DEBUG("Creating ShmSlab: ", shm_name.c_str(), " (", slab_bytes, " bytes)");
+
+            if (block_size == 0 || block_size % 64 != 0 || slab_bytes < block_size ||
+                slab_bytes / block_size > UINT32_MAX) {
+                return Result<ShmSlab, Error>::err(Error::invalid_argument("Invalid slab or block size"));
+            }
+            size_t block_count = slab_bytes / block_size;
+
+            ShmMemoryInfo info;
+            int fd = detail::open_segment(shm_name, memory, true, info);
+            if (fd < 0) {
+                echo::error("Failed to create slab ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<ShmSlab, Error>::err(Error::io_error("shm_open() failed"));
+            }
+
+            size_t states = sizeof(detail::SlabControl) + block_count * sizeof(std::atomic<uint32_t>);
+            size_t data_offset = detail::round_to_page(states, info.page_size);
+            size_t map_size = detail::round_to_page(data_offset + block_count * block_size, info.page_size);
+            if (ftruncate(fd, static_cast<off_t>(map_size)) < 0) {
+                echo::error("Failed to size slab ", shm_name.c_str(), ": ", strerror(errno)).red();
+                close(fd);
+                detail::unlink_segment(shm_name, memory.hugetlbfs_dir, info.hugetlbfs);
+                return Result<ShmSlab, Error>::err(Error::io_error("ftruncate() failed"));
+            }
+
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map slab ", shm_name.c_str(), ": ", strerror(errno)).red();
+                detail::unlink_segment(shm_name, memory.hugetlbfs_dir, info.hugetlbfs);
+                return Result<ShmSlab, Error>::err(Error::io_error("mmap() failed"));
+            }
+            detail::place_segment(mem, map_size, memory, true, info);
+
+            auto *ctl = new (mem) detail::SlabControl();
+            ctl->block_size = block_size;
+            ctl->block_count = block_count;
+            ctl->data_offset = data_offset;
+            auto *state = reinterpret_cast<std::atomic<uint32_t> *>(ctl + 1);
+            for (size_t i = 0; i < block_count; ++i) {
+                new (&state[i]) std::atomic<uint32_t>(0);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            ctl->magic = detail::SLAB_MAGIC;
+
+            ShmSlab slab(ctl, map_size, shm_name, true);
+            slab.memory_ = info;
+            slab.hugetlbfs_dir_ = memory.hugetlbfs_dir;
+            return Result<ShmSlab, Error>::ok(std::move(slab));
+        }
+
+        /// Attach to an existing slab in shared memory
+        /// @param shm_name Shared memory name (must start with '/')
+        /// @param memory Mapping options for this process (hugetlbfs_dir if the creator used hugetlbfs)
+        static Result<ShmSlab, Error> attach_shm(const String &shm_name,
+                                                 const ShmMemoryOptions &memory = ShmMemoryOptions{}) {
+            WIREBIT_DEBUG("Attaching to ShmSlab: ", shm_name.c_str());
+
+            ShmMemoryInfo info;
+            int fd = detail::open_segment(shm_name, memory, false, info);
+            if (fd < 0) {
+                return Result<ShmSlab, Error>::err(Error::not_found("Slab does not exist"));
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(detail::SlabControl)) {
+                echo::error("Slab ", shm_name.c_str(), " has invalid size").red();
+                close(fd);
+                return Result<ShmSlab, Error>::err(Error::io_error("Slab has invalid size"));
+            }
+
+            size_t map_size = static_cast<size_t>(st.st_size);
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map slab ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<ShmSlab, Error>::err(Error::io_error("mmap() failed"));
+            }
+
+            auto *ctl = static_cast<detail::SlabControl *>(mem);
+            if (ctl->magic != detail::SLAB_MAGIC || ctl->block_size == 0 || ctl->block_count == 0 ||
+                ctl->data_offset < sizeof(detail::SlabControl) + ctl->block_count * sizeof(std::atomic<uint32_t>) ||
+                ctl->data_offset + ctl->block_count * ctl->block_size > map_size) {
+                echo::error("Slab ", shm_name.c_str(), " is not an initialized ShmSlab").red();
+                munmap(mem, map_size);
+                return Result<ShmSlab, Error>::err(Error::invalid_argument("Invalid slab header"));
+            }
+            detail::place_segment(mem, map_size, memory, false, info);
+
+            ShmSlab slab(ctl, map_size, shm_name, false);
+            slab.memory_ = info;
+            slab.hugetlbfs_dir_ = memory.hugetlbfs_dir;
+            return Result<ShmSlab, Error>::ok(std::move(slab));
+        }
+
+        /// Destructor - unmaps the slab (and unlinks it if this side created it)
+        ~ShmSlab() { release_mapping(); }
+
+        ShmSlab(ShmSlab &&other) noexcept
+            : ctl_(other.ctl_), state_(other.state_), data_(other.data_), map_size_(other.map_size_),
+              shm_name_(std::move(other.shm_name_)), owner_(other.owner_), cursor_(other.cursor_),
+              memory_(other.memory_), hugetlbfs_dir_(std::move(other.hugetlbfs_dir_)) {
+            other.ctl_ = nullptr;
+            other.owner_ = false;
+        }
+
+        ShmSlab &operator=(ShmSlab &&other) noexcept {
+            if (this != &other) {
+                release_mapping();
+                ctl_ = other.ctl_;
+                state_ = other.state_;
+                data_ = other.data_;
+                map_size_ = other.map_size_;
+                shm_name_ = std::move(other.shm_name_);
+                owner_ = other.owner_;
+                cursor_ = other.cursor_;
+                memory_ = other.memory_;
+                hugetlbfs_dir_ = std::move(other.hugetlbfs_dir_);
+                other.ctl_ = nullptr;
+                other.owner_ = false;
+            }
+            return *this;
+        }
+
+        ShmSlab(const ShmSlab &) = delete;
+        ShmSlab &operator=(const ShmSlab &) = delete;
+
+        /// Allocate a run of blocks for a payload (producer side)
+        /// Since runs are released in allocation order, the free blocks always follow the cursor, so
+        /// only the run starting there (or at block 0 after the slab end) is checked. Once the latest
+        /// run has been released the slab is empty and allocation restarts at block 0, which keeps a
+        /// consumer that keeps up on the same cache-warm blocks.
+        /// @param length Payload size in bytes
+        /// @return Result containing the handle, timeout if the slab is full, or invalid_argument if
+        ///         the payload is larger than the slab
+        Result<ShmSlabHandle, Error> alloc(size_t length) {
+            size_t blocks = (length + block_size() - 1) / block_size();
+            if (length == 0 || blocks > block_count()) {
+                return Result<ShmSlabHandle, Error>::err(Error::invalid_argument("Payload does not fit the slab"));
+            }
+            size_t first = start_block(blocks);
+            for (size_t i = first; i < first + blocks; ++i) {
+                if (state_[i].load(std::memory_order_acquire) != 0) {
+                    return Result<ShmSlabHandle, Error>::err(Error::timeout("Slab full"));
+                }
+            }
+            for (size_t i = first; i < first + blocks; ++i) {
+                state_[i].store(1, std::memory_order_relaxed);
+            }
+            cursor_ = (first + blocks) % block_count();
+            ShmSlabHandle handle;
+            handle.first_block = static_cast<uint32_t>(first);
+            handle.block_count = static_cast<uint32_t>(blocks);
+            handle.length = length;
+            return Result<ShmSlabHandle, Error>::ok(handle);
+        }
+
+        /// Check whether alloc() of a payload would fail because the slab is full (producer side)
+        inline bool would_block(size_t length) const {
+            size_t blocks = (length + block_size() - 1) / block_size();
+            if (blocks > block_count()) {
+                return true;
+            }
+            size_t first = start_block(blocks);
+            for (size_t i = first; i < first + blocks; ++i) {
+                if (state_[i].load(std::memory_order_acquire) != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Get the writable payload memory of an allocated run (producer side)
+        inline std::span<Byte> data(const ShmSlabHandle &handle) {
+            return std::span<Byte>(data_ + static_cast<size_t>(handle.first_block) * block_size(),
+                                   static_cast<size_t>(handle.length));
+        }
+
+        /// Get the payload of a handle received through the ring (consumer side)
+        /// @return Result containing the payload view, or invalid_argument for a handle outside the slab
+        Result<std::span<const Byte>, Error> view(const ShmSlabHandle &handle) const {
+            uint64_t end = static_cast<uint64_t>(handle.first_block) + handle.block_count;
+            if (handle.block_count == 0 || end > block_count() ||
+                handle.length > static_cast<uint64_t>(handle.block_count) * block_size()) {
+                return Result<std::span<const Byte>, Error>::err(Error::invalid_argument("Invalid slab handle"));
+            }
+            return Result<std::span<const Byte>, Error>::ok(std::span<const Byte>(
+                data_ + static_cast<size_t>(handle.first_block) * block_size(), static_cast<size_t>(handle.length)));
+        }
+
+        /// Return a run to the producer
+        /// Called by the consumer once the payload has been read, or by the producer for a run it
+        /// allocated but never published.
+        inline void release(const ShmSlabHandle &handle) {
+            size_t end = std::min<size_t>(static_cast<size_t>(handle.first_block) + handle.block_count, block_count());
+            for (size_t i = handle.first_block; i < end; ++i) {
+                state_[i].store(0, std::memory_order_release);
+            }
+        }
+
+        /// Take back the latest allocation before it was published (producer side)
+        /// Releases the run and moves the cursor back to its start; call for newest runs first.
+        inline void unwind(const ShmSlabHandle &handle) {
+            release(handle);
+            cursor_ = handle.first_block;
+        }
+
+        /// Get the allocation unit in bytes
+        inline size_t block_size() const { return static_cast<size_t>(ctl_->block_size); }
+
+        /// Get the number of blocks
+        inline size_t block_count() const { return static_cast<size_t>(ctl_->block_count); }
+
+        /// Get the data size in bytes
+        inline size_t capacity() const { return block_size() * block_count(); }
+
+        /// Get the number of free blocks (scans all state words)
+        inline size_t free_blocks() const {
+            size_t free = 0;
+            for (size_t i = 0; i < block_count(); ++i) {
+                free += state_[i].load(std::memory_order_relaxed) == 0 ? 1 : 0;
+            }
+            return free;
+        }
+
+        /// Get the placement applied to this slab's mapping
+        inline const ShmMemoryInfo &memory_info() const { return memory_; }
+
+      private:
+        detail::SlabControl *ctl_ = nullptr;     ///< Control block (start of mapping)
+        std::atomic<uint32_t> *state_ = nullptr; ///< Block states (0 = free), after the control block
+        Byte *data_ = nullptr;                   ///< Block 0
+        size_t map_size_ = 0;                    ///< Total mapping size
+        String shm_name_;                        ///< SHM segment name
+        bool owner_ = false;                     ///< True if this side created the segment
+        size_t cursor_ = 0;                      ///< Block the next allocation starts at (producer side)
+        ShmMemoryInfo memory_;                   ///< Placement applied to the mapping
+        String hugetlbfs_dir_;                   ///< hugetlbfs mount holding the segment (if memory_.hugetlbfs)
+
+        ShmSlab(detail::SlabControl *ctl, size_t map_size, const String &shm_name, bool owner)
+            : ctl_(ctl), state_(reinterpret_cast<std::atomic<uint32_t> *>(ctl + 1)),
+              data_(reinterpret_cast<Byte *>(ctl) + ctl->data_offset), map_size_(map_size), shm_name_(shm_name),
+              owner_(owner) {}
+
+        /// Helper: Block the next run of `blocks` starts at (0 if the slab is empty or the tail too short)
+        inline size_t start_block(size_t blocks) const {
+            size_t cursor = cursor_;
+            if (cursor != 0 && state_[cursor - 1].load(std::memory_order_acquire) == 0) {
+                cursor = 0; // The latest run was released, so every run was
+            }
+            return cursor + blocks > block_count() ? 0 : cursor;
+        }
+
+        /// Helper: Unmap (and unlink the segment if this side created it)
+        inline void release_mapping() {
+            if (ctl_ == nullptr) {
+                return;
+            }
+            munmap(ctl_, map_size_);
+            if (owner_) {
+                detail::unlink_segment(shm_name_, hugetlbfs_dir_, memory_.hugetlbfs);
+            }
+            ctl_ = nullptr;
+        }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,412 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+
+namespace wirebit {
+
+    /// Counters every exported link publishes
+    /// The first group are monotonic counters, the *_QUEUED/*_CAPACITY ones are gauges sampled on
+    /// the data path (ring occupancy for ShmLink, pending output for PTY/TTY).
+    enum class LinkCounter : uint8_t {
+        FramesSent = 0,
+        FramesReceived,
+        BytesSent,
+        BytesReceived,
+        SendErrors,
+        RecvErrors,
+        FramesDropped,
+        RxQueuedBytes,
+        RxCapacityBytes,
+        TxQueuedBytes,
+        TxCapacityBytes,
+        Count
+    };
+
+    /// Number of LinkCounter values
+    inline constexpr size_t LINK_COUNTER_COUNT = static_cast<size_t>(LinkCounter::Count);
+
+    /// Get the name of a counter (as printed by scrapers)
+    inline constexpr const char *link_counter_name(LinkCounter counter) {
+        constexpr const char *NAMES[] = {"frames_sent",       "frames_received",   "bytes_sent",
+                                         "bytes_received",    "send_errors",       "recv_errors",
+                                         "frames_dropped",    "rx_queued_bytes",   "rx_capacity_bytes",
+                                         "tx_queued_bytes",   "tx_capacity_bytes"};
+        return static_cast<size_t>(counter) < LINK_COUNTER_COUNT ? NAMES[static_cast<size_t>(counter)] : "?";
+    }
+
+    namespace detail {
+        constexpr uint64_t STATS_MAGIC = 0x5354415354494257ULL; ///< 'WBITSTAT' (little endian)
+        constexpr uint32_t STATS_VERSION = 1;
+        constexpr size_t STATS_NAME_LEN = 64;
+        constexpr size_t STATS_KIND_LEN = 16;
+        constexpr size_t STATS_COUNTER_SLOTS = 16; ///< Counter room per slot (>= LINK_COUNTER_COUNT)
+
+        constexpr uint32_t STATS_SLOT_FREE = 0;    ///< Unused
+        constexpr uint32_t STATS_SLOT_CLAIMED = 1; ///< Being (re)initialized by its new owner
+        constexpr uint32_t STATS_SLOT_LIVE = 2;    ///< Owned by a running link
+
+        static_assert(LINK_COUNTER_COUNT <= STATS_COUNTER_SLOTS, "Stats slot too small for LinkCounter");
+
+        /// Header at the start of the stats segment
+        struct StatsHeader {
+            std::atomic<uint64_t> magic; ///< STATS_MAGIC once initialized
+            uint32_t version;            ///< STATS_VERSION
+            uint32_t slot_count;         ///< Number of StatsSlotData entries
+            uint8_t reserved[48];
+        };
+
+        /// One exported link; counters sit on their own cache lines, written by the owner only
+        struct StatsSlotData {
+            std::atomic<uint32_t> state; ///< STATS_SLOT_*
+            int32_t pid;                 ///< Owning process
+            uint64_t started_ns;         ///< When the slot was claimed (wall_ns())
+            char kind[STATS_KIND_LEN];   ///< Link type ("shm", "socketcan", ...)
+            char name[STATS_NAME_LEN];   ///< Link name
+            uint8_t reserved[96];
+            std::atomic<uint64_t> counters[STATS_COUNTER_SLOTS]; ///< Indexed by LinkCounter
+        };
+
+        static_assert(sizeof(StatsHeader) == 64, "Stats header must fill one cache line");
+        static_assert(sizeof(StatsSlotData) % 64 == 0, "Stats slots must be cache-line sized");
+        static_assert(offsetof(StatsSlotData, counters) % 64 == 0, "Counters must start on a cache line");
+    } // namespace detail
+
+    /// Copy of one exported link's counters
+    struct LinkStatsSnapshot {
+        String name;                                          ///< Link name
+        String kind;                                          ///< Link type
+        int pid = 0;                                          ///< Owning process
+        uint64_t started_ns = 0;                              ///< When the link started exporting
+        std::array<uint64_t, LINK_COUNTER_COUNT> counters{}; ///< Indexed by LinkCounter
+
+        /// Get one counter
+        inline uint64_t get(LinkCounter counter) const { return counters[static_cast<size_t>(counter)]; }
+    };
+
+    /// Writer handle for one link's slot in a StatsRegistry (move-only)
+    /// A default-constructed handle is inactive and every update is a no-op, so links carry one
+    /// unconditionally. Updates are relaxed load/store pairs on the owner's cache lines: no locked
+    /// instructions, no syscalls.
+    class StatsSlot {
+      public:
+        StatsSlot() = default;
+
+        ~StatsSlot() { release(); }
+
+        StatsSlot(StatsSlot &&other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+
+        StatsSlot &operator=(StatsSlot &&other) noexcept {
+            if (this != &other) {
+                release();
+                slot_ = other.slot_;
+                other.slot_ = nullptr;
+            }
+            return *this;
+        }
+
+        StatsSlot(const StatsSlot &) = delete;
+        StatsSlot &operator=(const StatsSlot &) = delete;
+
+        /// Check whether updates reach a registry
+        inline bool active() const { return slot_ != nullptr; }
+
+        /// Add to a counter
+        inline void add(LinkCounter counter, uint64_t n = 1) {
+            if (slot_ != nullptr) {
+                std::atomic<uint64_t> &value = slot_->counters[static_cast<size_t>(counter)];
+                value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+        }
+
+        /// Set a gauge
+        inline void set(LinkCounter counter, uint64_t value) {
+            if (slot_ != nullptr) {
+                slot_->counters[static_cast<size_t>(counter)].store(value, std::memory_order_relaxed);
+            }
+        }
+
+        /// Count one sent frame
+        inline void sent(uint64_t bytes) {
+            add(LinkCounter::FramesSent);
+            add(LinkCounter::BytesSent, bytes);
+        }
+
+        /// Count one received frame
+        inline void received(uint64_t bytes) {
+            add(LinkCounter::FramesReceived);
+            add(LinkCounter::BytesReceived, bytes);
+        }
+
+        /// Publish queue occupancy gauges
+        inline void queues(uint64_t rx_queued, uint64_t rx_capacity, uint64_t tx_queued, uint64_t tx_capacity) {
+            set(LinkCounter::RxQueuedBytes, rx_queued);
+            set(LinkCounter::RxCapacityBytes, rx_capacity);
+            set(LinkCounter::TxQueuedBytes, tx_queued);
+            set(LinkCounter::TxCapacityBytes, tx_capacity);
+        }
+
+        /// Give the slot back to the registry
+        inline void release() {
+            if (slot_ != nullptr) {
+                slot_->state.store(detail::STATS_SLOT_FREE, std::memory_order_release);
+                slot_ = nullptr;
+            }
+        }
+
+      private:
+        friend class StatsRegistry;
+        detail::StatsSlotData *slot_ = nullptr;
+
+        explicit StatsSlot(detail::StatsSlotData *slot) : slot_(slot) {}
+    };
+
+    /// Host-wide table of exported link counters in a named shared memory segment
+    ///
+    /// Any process can open the registry; the first one creates and initializes it. A link opts in
+    /// with Link::export_stats(), which claims a slot and from then on updates its counters in place.
+    /// Monitors open the same registry and call snapshot() to read every live link on the host,
+    /// without any cooperation from the processes being watched. Slots left behind by processes
+    /// that died are reclaimed when a new link needs one.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto registry = StatsRegistry::open().value();
+    /// link->export_stats(registry);
+    /// // in a monitor process:
+    /// for (const auto &s : StatsRegistry::open().value().snapshot()) {
+    ///     echo::info(s.name.c_str(), ": ", s.get(LinkCounter::FramesSent), " frames sent");
+    /// }
+    /// @endcode
+    class StatsRegistry {
+      public:
+        /// Default segment name
+        static constexpr const char *DEFAULT_NAME = "/wirebit_stats";
+
+        /// Open (or create) a registry
+        /// @param shm_name Shared memory name (must start with '/')
+        /// @param slot_count Number of slots if the registry is created here (ignored when it exists)
+        /// @return Result containing StatsRegistry or error
+        static Result<StatsRegistry, Error> open(const String &shm_name = DEFAULT_NAME, size_t slot_count = 1024) {
+            if (slot_count == 0 || slot_count > UINT32_MAX) {
+                return Result<StatsRegistry, Error>::err(Error::invalid_argument("Invalid stats slot count"));
+            }
+
+            bool created = true;
+            int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+            if (fd < 0 && errno == EEXIST) {
+                created = false;
+                fd = shm_open(shm_name.c_str(), O_RDWR, 0666);
+            }
+            if (fd < 0) {
+                echo::error("Failed to open stats registry ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<StatsRegistry, Error>::err(Error::io_error("shm_open() failed"));
+            }
+
+            size_t map_size = sizeof(detail::StatsHeader) + slot_count * sizeof(detail::StatsSlotData);
+            if (created) {
+                if (ftruncate(fd, static_cast<off_t>(map_size)) < 0) {
+                    echo::error("Failed to size stats registry ", shm_name.c_str(), ": ", strerror(errno)).red();
+                    close(fd);
+                    shm_unlink(shm_name.c_str());
+                    return Result<StatsRegistry, Error>::err(Error::io_error("ftruncate() failed"));
+                }
+            } else {
+                // The creator may still be sizing the segment
+                struct stat st;
+                for (int i = 0; i < 1000; ++i) {
+                    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(detail::StatsHeader)) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(detail::StatsHeader)) {
+                    close(fd);
+                    return Result<StatsRegistry, Error>::err(Error::io_error("Stats registry has invalid size"));
+                }
+                map_size = static_cast<size_t>(st.st_size);
+            }
+
+            void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem == MAP_FAILED) {
+                echo::error("Failed to map stats registry ", shm_name.c_str(), ": ", strerror(errno)).red();
+                return Result<StatsRegistry, Error>::err(Error::io_error("mmap() failed"));
+            }
+
+            auto *header = static_cast<detail::StatsHeader *>(mem);
+            if (created) {
+                header->version = detail::STATS_VERSION;
+                header->slot_count = static_cast<uint32_t>(slot_count);
+                header->magic.store(detail::STATS_MAGIC, std::memory_order_release);
+            } else {
+                for (int i = 0; i < 1000 && header->magic.load(std::memory_order_acquire) != detail::STATS_MAGIC; ++i) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                if (header->magic.load(std::memory_order_acquire) != detail::STATS_MAGIC ||
+                    header->version != detail::STATS_VERSION ||
+                    sizeof(detail::StatsHeader) + header->slot_count * sizeof(detail::StatsSlotData) > map_size) {
+                    echo::error("Stats registry ", shm_name.c_str(), " is not initialized or incompatible").red();
+                    munmap(mem, map_size);
+                    return Result<StatsRegistry, Error>::err(Error::invalid_argument("Invalid stats registry"));
+                }
+            }
+
+            WIREBIT_DEBUG("StatsRegistry ", created ? "created: " : "opened: ", shm_name.c_str(), " (",
+                          header->slot_count, " slots)");
+            return Result<StatsRegistry, Error>::ok(StatsRegistry(header, map_size));
+        }
+
+        /// Remove a registry segment (processes that have it open keep their mapping)
+        /// @param shm_name Shared memory name
+        static inline void unlink(const String &shm_name = DEFAULT_NAME) { shm_unlink(shm_name.c_str()); }
+
+        /// Destructor - unmaps the registry (slots must have been released)
+        ~StatsRegistry() {
+            if (header_ != nullptr) {
+                munmap(header_, map_size_);
+            }
+        }
+
+        /// Move constructor
+        StatsRegistry(StatsRegistry &&other) noexcept : header_(other.header_), map_size_(other.map_size_) {
+            other.header_ = nullptr;
+        }
+
+        /// Move assignment
+        StatsRegistry &operator=(StatsRegistry &&other) noexcept {
+            if (this != &other) {
+                if (header_ != nullptr) {
+                    munmap(header_, map_size_);
+                }
+                header_ = other.header_;
+                map_size_ = other.map_size_;
+                other.header_ = nullptr;
+            }
+            return *this;
+        }
+
+        // Disable copy
+        StatsRegistry(const StatsRegistry &) = delete;
+        StatsRegistry &operator=(const StatsRegistry &) = delete;
+
+        /// Claim a slot for a link
+        /// The slot stays valid while this registry object is alive.
+        /// @param name Link name (truncated to 63 characters)
+        /// @param kind Link type (truncated to 15 characters)
+        /// @return Result containing the writer handle, or timeout if every slot is taken
+        Result<StatsSlot, Error> claim(const String &name, const char *kind) {
+            int32_t pid = static_cast<int32_t>(::getpid());
+            for (size_t i = 0; i < slot_count(); ++i) {
+                detail::StatsSlotData *slot = slot_at(i);
+                uint32_t state = slot->state.load(std::memory_order_acquire);
+                if (state == detail::STATS_SLOT_LIVE && !owner_alive(slot->pid)) {
+                    // Left behind by a process that exited without releasing it
+                    if (!slot->state.compare_exchange_strong(state, detail::STATS_SLOT_FREE)) {
+                        continue;
+                    }
+                    state = detail::STATS_SLOT_FREE;
+                }
+                if (state != detail::STATS_SLOT_FREE ||
+                    !slot->state.compare_exchange_strong(state, detail::STATS_SLOT_CLAIMED,
+                                                         std::memory_order_acquire)) {
+                    continue;
+                }
+
+                slot->pid = pid;
+                slot->started_ns = wall_ns();
+                copy_string(slot->kind, sizeof(slot->kind), kind);
+                copy_string(slot->name, sizeof(slot->name), name.c_str());
+                for (auto &counter : slot->counters) {
+                    counter.store(0, std::memory_order_relaxed);
+                }
+                slot->state.store(detail::STATS_SLOT_LIVE, std::memory_order_release);
+                WIREBIT_DEBUG("StatsRegistry: ", name.c_str(), " exported in slot ", i);
+                return Result<StatsSlot, Error>::ok(StatsSlot(slot));
+            }
+            echo::warn("Stats registry full, ", name.c_str(), " not exported").yellow();
+            return Result<StatsSlot, Error>::err(Error::timeout("Stats registry full"));
+        }
+
+        /// Read every live link on the host
+        /// Counters are read individually (relaxed), so a snapshot is not one atomic cut across them.
+        /// @return Snapshots in slot order
+        Vector<LinkStatsSnapshot> snapshot() const {
+            Vector<LinkStatsSnapshot> result;
+            for (size_t i = 0; i < slot_count(); ++i) {
+                const detail::StatsSlotData *slot = slot_at(i);
+                if (slot->state.load(std::memory_order_acquire) != detail::STATS_SLOT_LIVE) {
+                    continue;
+                }
+                LinkStatsSnapshot snap;
+                snap.name = bounded_string(slot->name, sizeof(slot->name));
+                snap.kind = bounded_string(slot->kind, sizeof(slot->kind));
+                snap.pid = slot->pid;
+                snap.started_ns = slot->started_ns;
+                for (size_t c = 0; c < LINK_COUNTER_COUNT; ++c) {
+                    snap.counters[c] = slot->counters[c].load(std::memory_order_relaxed);
+                }
+                // A slot released or re-claimed while we copied it is skipped
+                if (slot->state.load(std::memory_order_acquire) != detail::STATS_SLOT_LIVE || !owner_alive(snap.pid)) {
+                    continue;
+                }
+                result.push_back(std::move(snap));
+            }
+            return result;
+        }
+
+        /// Get number of slots
+        inline size_t slot_count() const { return header_->slot_count; }
+
+        /// Get number of live slots
+        inline size_t live_count() const {
+            size_t live = 0;
+            for (size_t i = 0; i < slot_count(); ++i) {
+                live += slot_at(i)->state.load(std::memory_order_relaxed) == detail::STATS_SLOT_LIVE ? 1 : 0;
+            }
+            return live;
+        }
+
+      private:
+        detail::StatsHeader *header_ = nullptr;
+        size_t map_size_ = 0;
+
+        StatsRegistry(detail::StatsHeader *header, size_t map_size) : header_(header), map_size_(map_size) {}
+
+        inline detail::StatsSlotData *slot_at(size_t i) const {
+            return reinterpret_cast<detail::StatsSlotData *>(reinterpret_cast<Byte *>(header_) +
+                                                             sizeof(detail::StatsHeader)) +
+                   i;
+        }
+
+        static inline bool owner_alive(int32_t pid) { return pid > 0 && (::kill(pid, 0) == 0 || errno != ESRCH); }
+
+        static inline void copy_string(char *dst, size_t cap, const char *src) {
+            size_t n = src != nullptr ? std::min(std::strlen(src), cap - 1) : 0;
+            std::memcpy(dst, src, n);
+            std::memset(dst + n, 0, cap - n);
+        }
+
+        static inline String bounded_string(const char *src, size_t cap) {
+            size_t n = 0;
+            while (n < cap && src[n] != '\0') {
+                ++n;
+            }
+            return String(std::string(src, n).c_str());
+        }
+    };
+
+} // namespace wirebit
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <echo/echo.hpp>
+#include <span>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+#include <wirebit/stream_framing.hpp>
+
+namespace wirebit {
+
+    /// Statistics for StreamDecoder
+    struct StreamDecoderStats {
+        uint64_t frames = 0;        ///< Frames decoded
+        uint64_t bytes_in = 0;      ///< Bytes fed into the decoder
+        uint64_t bytes_skipped = 0; ///< Garbage bytes discarded while searching for a frame
+        uint64_t resyncs = 0;       ///< Times the stream lost and re-found frame alignment
+        uint64_t bad_headers = 0;   ///< Magic matches (or COBS/SLIP packets) rejected as malformed
+        uint64_t bad_checksums = 0; ///< Complete frames rejected by their FRAME_FLAG_CHECKSUM trailer
+
+        inline void reset() {
+            frames = 0;
+            bytes_in = 0;
+            bytes_skipped = 0;
+            resyncs = 0;
+            bad_headers = 0;
+            bad_checksums = 0;
+        }
+    };
+
+    /// Incremental decoder for wirebit frames carried over a byte stream (PTY, TTY)
+    ///
+    /// Bytes are read straight into the decoder's buffer (write_space() + commit()) or copied in
+    /// with feed(); next() then hands out every complete [FrameHeader][payload][meta] record as a
+    /// FrameView into that buffer. Compact FRAME_HEADER_V2 headers (absolute timestamps, time base 0)
+    /// are accepted alongside the fixed one. Consumed bytes are released by moving a read offset, and the
+    /// live tail is only moved to the front when the free space at the end runs short, so the
+    /// cost per byte is O(1) amortized instead of one erase() per frame.
+    ///
+    /// After line noise the decoder jumps to the next magic with memchr() (vectorized in libc)
+    /// rather than stepping one byte per call, and a magic whose version or lengths are implausible
+    /// is treated as noise too. Frames carrying FRAME_FLAG_CHECKSUM are verified and stripped of
+    /// their trailer; a mismatch is treated like noise as well.
+    ///
+    /// With StreamFraming::Cobs or StreamFraming::Slip the stream is a sequence of delimited
+    /// packets (see encode_packet()) instead: each is decoded in place when its delimiter arrives,
+    /// and a corrupt packet costs exactly that packet, decoding resumes after its delimiter.
+    ///
+    /// Example usage:
+    /// @code
+    /// StreamDecoder decoder;
+    /// auto space = decoder.write_space(4096);
+    /// decoder.commit(read(fd, space.data(), space.size()));
+    /// FrameView frame;
+    /// while (decoder.next(frame)) { handle(frame); }
+    /// @endcode
+    class StreamDecoder {
+      public:
+        /// Magic that starts every frame (FrameHeader::magic, 'WBIT')
+        static constexpr uint32_t MAGIC = FRAME_MAGIC;
+
+        /// Create a decoder
+        /// @param max_frame_bytes Largest payload_len + meta_len accepted (larger lengths count as noise)
+        /// @param framing Wire format
+        /// @param compact_header Cobs/Slip: packets start with a compact header (see encode_packet())
+        /// @param checksum Cobs/Slip without compact header: packets end with a CRC32C
+        inline explicit StreamDecoder(size_t max_frame_bytes = 1 << 20, StreamFraming framing = StreamFraming::Header,
+                                      bool compact_header = true, bool checksum = false)
+            : max_frame_bytes_(max_frame_bytes), framing_(framing), compact_header_(compact_header),
+              checksum_(checksum) {}
+
+        /// Get a writable region at the end of the buffer
+        /// Invalidates views returned by next().
+        /// @param min_bytes Minimum size of the region
+        /// @return Region to read into; pass the number of bytes stored to commit()
+        inline std::span<Byte> write_space(size_t min_bytes) {
+            if (head_ == tail_) {
+                head_ = 0;
+                tail_ = 0;
+            }
+            if (buffer_.size() - tail_ < min_bytes) {
+                compact();
+                if (buffer_.size() - tail_ < min_bytes) {
+                    buffer_.resize(tail_ + min_bytes);
+                }
+            }
+            return std::span<Byte>(buffer_.data() + tail_, buffer_.size() - tail_);
+        }
+
+        /// Account for bytes stored into the region from write_space()
+        /// @param n Number of bytes written
+        inline void commit(size_t n) {
+            tail_ += n;
+            stats_.bytes_in += n;
+        }
+
+        /// Copy bytes into the decoder
+        /// Invalidates views returned by next().
+        /// @param data Bytes received
+        /// @param n Number of bytes
+        inline void feed(const Byte *data, size_t n) {
+            if (n == 0) {
+                return;
+            }
+            std::span<Byte> space = write_space(n);
+            std::memcpy(space.data(), data, n);
+            commit(n);
+        }
+
+        /// Decode the next complete frame
+        /// The view points into the decoder's buffer and stays valid until the next
+        /// write_space()/feed()/clear(); successive next() calls do not invalidate earlier views.
+        /// @param frame Output frame view
+        /// @return true if a frame was decoded, false if more bytes are needed
+        inline bool next(FrameView &frame) {
+            if (framing_ != StreamFraming::Header) {
+                return next_packet(frame);
+            }
+            while (tail_ - head_ >= sizeof(uint32_t)) {
+                if (!align_to_magic()) {
+                    return false;
+                }
+
+                FrameHeader header;
+                size_t header_len = 0;
+                auto parsed = detail::parse_frame_header(buffer_.data() + head_, tail_ - head_, header, header_len, 0);
+                if (parsed == detail::HeaderParse::Short) {
+                    return false;
+                }
+                uint64_t body = static_cast<uint64_t>(header.payload_len) + header.meta_len;
+                if (parsed != detail::HeaderParse::Ok || body > max_frame_bytes_) {
+                    // Magic inside noise (or a corrupt header): step past it and search again
+                    stats_.bad_headers++;
+                    skip(1);
+                    continue;
+                }
+
+                size_t total = header_len + static_cast<size_t>(body);
+                if (tail_ - head_ < total) {
+                    return false;
+                }
+
+                const Byte *data = buffer_.data() + head_ + header_len;
+                frame.header = header;
+                frame.payload = std::span<const Byte>(data, header.payload_len);
+                frame.meta = std::span<const Byte>(data + header.payload_len, header.meta_len);
+                if (!verify_frame_checksum(frame)) {
+                    stats_.bad_checksums++;
+                    skip(1);
+                    continue;
+                }
+                head_ += total;
+                in_sync_ = true;
+                stats_.frames++;
+                return true;
+            }
+            return false;
+        }
+
+        /// Drop all buffered bytes (storage is kept)
+        inline void clear() {
+            head_ = 0;
+            tail_ = 0;
+        }
+
+        /// Get number of buffered bytes not yet decoded
+        inline size_t buffered() const { return tail_ - head_; }
+
+        /// Get the largest payload_len + meta_len accepted
+        inline size_t max_frame_bytes() const { return max_frame_bytes_; }
+
+        /// Get the wire format
+        inline StreamFraming framing() const { return framing_; }
+
+        /// Get decoder statistics
+        inline const StreamDecoderStats &stats() const { return stats_; }
+
+        /// Reset statistics
+        inline void reset_stats() { stats_.reset(); }
+
+      private:
+        Bytes buffer_;             ///< Storage; live bytes are [head_, tail_)
+        size_t head_ = 0;          ///< Offset of the first undecoded byte
+        size_t tail_ = 0;          ///< Offset one past the last received byte
+        size_t max_frame_bytes_;   ///< Length sanity limit
+        StreamFraming framing_;    ///< Wire format
+        bool compact_header_;      ///< Cobs/Slip: packets carry a compact header
+        bool checksum_;            ///< Cobs/Slip without compact header: packets carry a CRC32C
+        bool in_sync_ = true;      ///< Whether the last decoded record ended where the next begins
+        StreamDecoderStats stats_; ///< Decoder statistics
+
+        /// Helper: Decode the next delimited COBS/SLIP packet
+        inline bool next_packet(FrameView &frame) {
+            const Byte delimiter = framing_ == StreamFraming::Slip ? SLIP_END : COBS_DELIMITER;
+            while (head_ < tail_) {
+                Byte *begin = buffer_.data() + head_;
+                size_t left = tail_ - head_;
+                auto *end = static_cast<Byte *>(std::memchr(begin, delimiter, left));
+                if (end == nullptr) {
+                    if (left > max_packet_size(framing_, max_frame_bytes_)) {
+                        skip(left); // No delimiter in sight: noise, or a runaway packet
+                    }
+                    return false;
+                }
+                size_t len = static_cast<size_t>(end - begin);
+                if (len == 0) {
+                    head_++; // Empty packet (back-to-back delimiters, or one sent to flush the line)
+                    continue;
+                }
+
+                size_t decoded = 0;
+                std::span<const Byte> encoded(begin, len);
+                bool ok = framing_ == StreamFraming::Slip ? slip_decode(encoded, begin, decoded)
+                                                          : cobs_decode(encoded, begin, decoded);
+                bool bad_checksum = false;
+                if (ok) {
+                    ok = detail::parse_packet(std::span<const Byte>(begin, decoded), compact_header_, checksum_, frame,
+                                              bad_checksum);
+                }
+                if (!ok) {
+                    if (bad_checksum) {
+                        stats_.bad_checksums++;
+                    } else {
+                        stats_.bad_headers++;
+                    }
+                    skip(len + 1);
+                    continue;
+                }
+                head_ += len + 1;
+                in_sync_ = true;
+                stats_.frames++;
+                return true;
+            }
+            return false;
+        }
+
+        /// Helper: Move head_ to the next magic, discarding what precedes it
+        /// @return false if no magic is buffered (a possible partial magic at the end is kept)
+        inline bool align_to_magic() {
+            // The header is stored in host byte order, so search for MAGIC as it sits in memory
+            Byte magic_bytes[sizeof(uint32_t)];
+            uint32_t magic = MAGIC;
+            std::memcpy(magic_bytes, &magic, sizeof(magic));
+
+            const Byte *begin = buffer_.data() + head_;
+            const Byte *end = buffer_.data() + tail_;
+            const Byte *p = begin;
+            while (p < end) {
+                size_t left = static_cast<size_t>(end - p);
+                const Byte *hit = static_cast<const Byte *>(std::memchr(p, magic_bytes[0], left));
+                if (hit == nullptr) {
+                    p = end;
+                    break;
+                }
+                size_t avail = std::min(static_cast<size_t>(end - hit), sizeof(magic_bytes));
+                if (std::memcmp(hit, magic_bytes, avail) == 0) {
+                    // Full magic, or a prefix of one at the very end of the buffer
+                    p = hit;
+                    break;
+                }
+                p = hit + 1;
+            }
+
+            skip(static_cast<size_t>(p - begin));
+            return tail_ - head_ >= sizeof(uint32_t);
+        }
+
+        /// Helper: Discard n undecoded bytes as noise
+        inline void skip(size_t n) {
+            if (n == 0) {
+                return;
+            }
+            if (in_sync_) {
+                in_sync_ = false;
+                stats_.resyncs++;
+                WIREBIT_DEBUG("StreamDecoder lost frame alignment, resyncing");
+            }
+            head_ += n;
+            stats_.bytes_skipped += n;
+        }
+
+        /// Helper: Move the live bytes to the front of the buffer
+        inline void compact() {
+            if (head_ == 0) {
+                return;
+            }
+            size_t live = tail_ - head_;
+            if (live > 0) {
+                std::memmove(buffer_.data(), buffer_.data() + head_, live);
+            }
+            head_ = 0;
+            tail_ = live;
+        }
+    };
+
+} // namespace wirebit
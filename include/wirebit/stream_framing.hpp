@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <wirebit/common/crc.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+
+namespace wirebit {
+
+    /// How framed byte-stream links (PtyLink, TtyLink) delimit frames on the wire
+    enum class StreamFraming : uint8_t {
+        Header, ///< [FrameHeader][payload][meta], resynchronized on the header magic
+        Cobs,   ///< COBS-encoded packets, each terminated by 0x00
+        Slip,   ///< SLIP (RFC 1055) packets, each terminated by 0xC0
+    };
+
+    /// COBS packet delimiter
+    constexpr Byte COBS_DELIMITER = 0x00;
+
+    /// SLIP special bytes (RFC 1055)
+    constexpr Byte SLIP_END = 0xC0;
+    constexpr Byte SLIP_ESC = 0xDB;
+    constexpr Byte SLIP_ESC_END = 0xDC;
+    constexpr Byte SLIP_ESC_ESC = 0xDD;
+
+    /// Compact header type byte flag: the packet ends with a CRC32C of everything before it
+    constexpr Byte COMPACT_FLAG_CHECKSUM = 0x80;
+
+    /// Largest compact header: type byte + payload length as a 5-byte varint
+    constexpr size_t COMPACT_HEADER_MAX = 6;
+
+    /// Get the worst-case COBS encoding size (one code byte per 254 data bytes)
+    /// @param n Input size
+    /// @return Encoded size, without the delimiter
+    inline constexpr size_t cobs_max_encoded_size(size_t n) { return n + n / 254 + 1; }
+
+    /// Get the worst-case SLIP encoding size (every byte escaped)
+    /// @param n Input size
+    /// @return Encoded size, without the delimiter
+    inline constexpr size_t slip_max_encoded_size(size_t n) { return 2 * n; }
+
+    /// COBS-encode the concatenation of several buffers
+    /// @param parts Input buffers
+    /// @param out Output, at least cobs_max_encoded_size() of the total input
+    /// @return Encoded size (no delimiter appended)
+    inline size_t cobs_encode(std::initializer_list<std::span<const Byte>> parts, Byte *out) {
+        Byte *code_at = out;
+        Byte *w = out + 1;
+        Byte code = 1;
+        for (std::span<const Byte> part : parts) {
+            for (Byte b : part) {
+                if (b == 0) {
+                    *code_at = code;
+                    code_at = w++;
+                    code = 1;
+                    continue;
+                }
+                *w++ = b;
+                if (++code == 0xFF) {
+                    *code_at = code;
+                    code_at = w++;
+                    code = 1;
+                }
+            }
+        }
+        *code_at = code;
+        return static_cast<size_t>(w - out);
+    }
+
+    /// COBS-encode a buffer
+    /// @param in Input
+    /// @param out Output, at least cobs_max_encoded_size(in.size())
+    /// @return Encoded size (no delimiter appended)
+    inline size_t cobs_encode(std::span<const Byte> in, Byte *out) { return cobs_encode({in}, out); }
+
+    /// Decode one COBS packet (without its delimiter)
+    /// @param in Encoded bytes
+    /// @param out Output, at least in.size() bytes; may be in.data() to decode in place
+    /// @param out_len Decoded size
+    /// @return false if the packet is malformed (a zero byte, or a code running past the end)
+    inline bool cobs_decode(std::span<const Byte> in, Byte *out, size_t &out_len) {
+        size_t r = 0;
+        size_t w = 0;
+        const size_t n = in.size();
+        while (r < n) {
+            Byte code = in[r++];
+            size_t len = static_cast<size_t>(code) - 1;
+            if (code == 0 || len > n - r || std::memchr(in.data() + r, 0, len) != nullptr) {
+                return false;
+            }
+            std::memmove(out + w, in.data() + r, len);
+            w += len;
+            r += len;
+            if (code != 0xFF && r < n) {
+                out[w++] = 0;
+            }
+        }
+        out_len = w;
+        return true;
+    }
+
+    /// SLIP-escape the concatenation of several buffers
+    /// @param parts Input buffers
+    /// @param out Output, at least slip_max_encoded_size() of the total input
+    /// @return Encoded size (no END appended)
+    inline size_t slip_encode(std::initializer_list<std::span<const Byte>> parts, Byte *out) {
+        Byte *w = out;
+        for (std::span<const Byte> part : parts) {
+            for (Byte b : part) {
+                if (b == SLIP_END) {
+                    *w++ = SLIP_ESC;
+                    *w++ = SLIP_ESC_END;
+                } else if (b == SLIP_ESC) {
+                    *w++ = SLIP_ESC;
+                    *w++ = SLIP_ESC_ESC;
+                } else {
+                    *w++ = b;
+                }
+            }
+        }
+        return static_cast<size_t>(w - out);
+    }
+
+    /// SLIP-escape a buffer
+    /// @param in Input
+    /// @param out Output, at least slip_max_encoded_size(in.size())
+    /// @return Encoded size (no END appended)
+    inline size_t slip_encode(std::span<const Byte> in, Byte *out) { return slip_encode({in}, out); }
+
+    /// Decode one SLIP packet (without its END)
+    /// @param in Escaped bytes
+    /// @param out Output, at least in.size() bytes; may be in.data() to decode in place
+    /// @param out_len Decoded size
+    /// @return false if the packet is malformed (END inside, or ESC not followed by ESC_END/ESC_ESC)
+    inline bool slip_decode(std::span<const Byte> in, Byte *out, size_t &out_len) {
+        size_t w = 0;
+        const size_t n = in.size();
+        for (size_t r = 0; r < n; ++r) {
+            Byte b = in[r];
+            if (b == SLIP_ESC) {
+                if (++r == n) {
+                    return false;
+                }
+                if (in[r] == SLIP_ESC_END) {
+                    b = SLIP_END;
+                } else if (in[r] == SLIP_ESC_ESC) {
+                    b = SLIP_ESC;
+                } else {
+                    return false;
+                }
+            } else if (b == SLIP_END) {
+                return false;
+            }
+            out[w++] = b;
+        }
+        out_len = w;
+        return true;
+    }
+
+    /// Get the worst-case size of a packet from encode_packet()
+    /// @param framing StreamFraming::Cobs or StreamFraming::Slip
+    /// @param payload_size Payload size
+    /// @return Size including header, checksum and delimiter
+    inline constexpr size_t max_packet_size(StreamFraming framing, size_t payload_size) {
+        size_t plain = COMPACT_HEADER_MAX + payload_size + FRAME_CHECKSUM_LEN;
+        return (framing == StreamFraming::Slip ? slip_max_encoded_size(plain) : cobs_max_encoded_size(plain)) + 1;
+    }
+
+    /// Encode a frame as one COBS or SLIP packet, delimiter included
+    ///
+    /// The packet carries [compact header][payload][CRC32C], each part optional: the compact header
+    /// is the frame type (COMPACT_FLAG_CHECKSUM set when a CRC follows) and the payload length as a
+    /// varint. Metadata and the other header fields are not sent; the receiver stamps the frame on
+    /// arrival. Without the compact header the packet is the bare payload and both ends must agree
+    /// on the checksum setting.
+    ///
+    /// @param frame Frame to encode
+    /// @param framing StreamFraming::Cobs or StreamFraming::Slip
+    /// @param compact_header Prefix the compact header
+    /// @param checksum Append a CRC32C over header and payload
+    /// @param out Buffer, at least max_packet_size(framing, payload size) bytes
+    /// @return Packet size
+    inline size_t encode_packet(const FrameView &frame, StreamFraming framing, bool compact_header, bool checksum,
+                                Byte *out) {
+        Byte head[COMPACT_HEADER_MAX];
+        size_t head_len = 0;
+        if (compact_header) {
+            head[0] = static_cast<Byte>(static_cast<uint8_t>(frame.type()) & 0x7F) |
+                      (checksum ? COMPACT_FLAG_CHECKSUM : Byte{0});
+            head_len = static_cast<size_t>(detail::put_varint(head + 1, frame.payload.size()) - head);
+        }
+        uint32_t crc = 0;
+        if (checksum) {
+            crc = crc32c(frame.payload, crc32c(head, head_len));
+        }
+
+        std::span<const Byte> head_span(head, head_len);
+        std::span<const Byte> crc_span(reinterpret_cast<const Byte *>(&crc), checksum ? FRAME_CHECKSUM_LEN : 0);
+        size_t n = 0;
+        if (framing == StreamFraming::Slip) {
+            n = slip_encode({head_span, frame.payload, crc_span}, out);
+            out[n++] = SLIP_END;
+        } else {
+            n = cobs_encode({head_span, frame.payload, crc_span}, out);
+            out[n++] = COBS_DELIMITER;
+        }
+        return n;
+    }
+
+    namespace detail {
+        /// Parse decoded packet bytes into a frame view (see encode_packet())
+        /// @param packet Decoded packet, without the delimiter
+        /// @param compact_header Packet starts with a compact header
+        /// @param checksum Without compact header: the packet ends with a CRC32C
+        /// @param frame Output view into packet
+        /// @param bad_checksum Set when the packet was rejected by its CRC
+        /// @return false if the header, length or checksum does not check out
+        inline bool parse_packet(std::span<const Byte> packet, bool compact_header, bool checksum, FrameView &frame,
+                                 bool &bad_checksum) {
+            bad_checksum = false;
+            FrameType type = FrameType::SERIAL;
+            size_t head_len = 0;
+            uint64_t payload_len = 0;
+            if (compact_header) {
+                if (packet.empty()) {
+                    return false;
+                }
+                Byte type_byte = packet[0];
+                type = static_cast<FrameType>(type_byte & 0x7F);
+                checksum = (type_byte & COMPACT_FLAG_CHECKSUM) != 0;
+                const Byte *end = packet.data() + packet.size();
+                const Byte *body = detail::get_varint(packet.data() + 1, end, payload_len, 32);
+                if (body == nullptr) {
+                    return false;
+                }
+                head_len = static_cast<size_t>(body - packet.data());
+            }
+
+            size_t trailer = checksum ? FRAME_CHECKSUM_LEN : 0;
+            if (packet.size() < head_len + trailer) {
+                return false;
+            }
+            size_t body = packet.size() - head_len - trailer;
+            if (compact_header && payload_len != body) {
+                return false;
+            }
+            if (checksum) {
+                uint32_t stored;
+                std::memcpy(&stored, packet.data() + head_len + body, FRAME_CHECKSUM_LEN);
+                if (stored != crc32c(packet.data(), head_len + body)) {
+                    bad_checksum = true;
+                    return false;
+                }
+            }
+            frame = make_view(type, packet.subspan(head_len, body));
+            return true;
+        }
+    } // namespace detail
+
+} // namespace wirebit
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <wirebit/common/time.hpp>
+#include <wirebit/common/types.hpp>
+#include <wirebit/frame.hpp>
+
+namespace wirebit {
+
+    /// Frame of a fixed type with up to N payload bytes stored inline
+    ///
+    /// For protocols whose payload is a fixed-size struct (a can_frame, a serial chunk) this avoids
+    /// the heap Bytes inside Frame: the payload lives in the object, the frame type is a template
+    /// parameter, and the size checks for of()/get() happen at compile time. view() borrows the
+    /// frame for Link::send_view(), so nothing is allocated or copied on the way to the link.
+    ///
+    /// Example usage:
+    /// @code
+    /// auto frame = TypedFrame<FrameType::CAN, sizeof(can_frame)>::of(cf, endpoint_id);
+    /// link->send_view(frame.view());
+    /// @endcode
+    template <FrameType Type, size_t N> class TypedFrame {
+      public:
+        static_assert(N > 0, "TypedFrame needs room for a payload");
+
+        static constexpr FrameType TYPE = Type; ///< Frame type of every instance
+        static constexpr size_t CAPACITY = N;   ///< Inline payload capacity
+
+        FrameHeader header; ///< Frame header (frame_type fixed to TYPE, payload_len <= CAPACITY)
+
+        /// Create a frame with an N-byte zeroed payload
+        inline TypedFrame() {
+            header.frame_type = static_cast<uint16_t>(Type);
+            header.payload_len = static_cast<uint32_t>(N);
+        }
+
+        /// Create a frame holding a trivially copyable value, stamped with the current time
+        /// @param value Payload (sizeof(T) must not exceed N, checked at compile time)
+        /// @param src_id Source endpoint ID
+        /// @param dst_id Destination endpoint ID (0 = broadcast)
+        /// @return Frame with payload_len == sizeof(T)
+        template <typename T> static inline TypedFrame of(const T &value, uint32_t src_id = 0, uint32_t dst_id = 0) {
+            static_assert(std::is_trivially_copyable_v<T>, "TypedFrame payloads are copied bytewise");
+            static_assert(sizeof(T) <= N, "Payload type does not fit in this TypedFrame");
+            TypedFrame frame;
+            std::memcpy(frame.data_.data(), &value, sizeof(T));
+            frame.header.payload_len = static_cast<uint32_t>(sizeof(T));
+            frame.header.src_endpoint_id = src_id;
+            frame.header.dst_endpoint_id = dst_id;
+            frame.header.tx_timestamp_ns = now_ns();
+            return frame;
+        }
+
+        /// Copy a received frame view (the one runtime check: type and payload size)
+        /// @param view Frame view
+        /// @return Result containing the frame, or invalid_argument if the type or size does not match
+        static inline Result<TypedFrame, Error> from_view(const FrameView &view) {
+            if (view.header.frame_type != static_cast<uint16_t>(Type)) {
+                return Result<TypedFrame, Error>::err(Error::invalid_argument("Wrong frame type"));
+            }
+            if (view.payload.size() > N) {
+                return Result<TypedFrame, Error>::err(Error::invalid_argument("Payload too large for TypedFrame"));
+            }
+            TypedFrame frame;
+            frame.header = view.header;
+            frame.header.payload_len = static_cast<uint32_t>(view.payload.size());
+            frame.header.meta_len = 0;
+            if (!view.payload.empty()) {
+                std::memcpy(frame.data_.data(), view.payload.data(), view.payload.size());
+            }
+            return Result<TypedFrame, Error>::ok(frame);
+        }
+
+        /// Read the payload back as a trivially copyable value
+        /// @return Value copied from the first sizeof(T) payload bytes (sizeof(T) <= N, checked at compile time)
+        template <typename T> inline T get() const {
+            static_assert(std::is_trivially_copyable_v<T>, "TypedFrame payloads are copied bytewise");
+            static_assert(sizeof(T) <= N, "Payload type does not fit in this TypedFrame");
+            T value;
+            std::memcpy(&value, data_.data(), sizeof(T));
+            return value;
+        }
+
+        /// Replace the payload
+        /// @param bytes New payload (at most N bytes; longer input is truncated)
+        /// @return Number of bytes stored
+        inline size_t assign(std::span<const Byte> bytes) {
+            size_t n = bytes.size() < N ? bytes.size() : N;
+            if (n > 0) {
+                std::memcpy(data_.data(), bytes.data(), n);
+            }
+            header.payload_len = static_cast<uint32_t>(n);
+            return n;
+        }
+
+        /// Get the payload bytes
+        inline std::span<const Byte> payload() const { return std::span<const Byte>(data_.data(), size()); }
+
+        /// Get writable inline storage (all N bytes; set the length with resize())
+        inline std::span<Byte> storage() { return std::span<Byte>(data_.data(), N); }
+
+        /// Set the payload length
+        /// @param n New length (clamped to N)
+        inline void resize(size_t n) { header.payload_len = static_cast<uint32_t>(n < N ? n : N); }
+
+        /// Get the payload length
+        inline size_t size() const { return header.payload_len; }
+
+        /// Borrow the frame (valid while this object is alive and unchanged)
+        inline FrameView view() const {
+            FrameView v;
+            v.header = header;
+            v.header.meta_len = 0;
+            v.payload = payload();
+            return v;
+        }
+
+        /// Copy into an owning Frame
+        inline Frame to_frame() const { return wirebit::to_frame(view()); }
+
+      private:
+        std::array<Byte, N> data_{}; ///< Inline payload storage
+    };
+
+} // namespace wirebit
@@ -3,37 +3,75 @@
 // Main wirebit header - includes all components
 
 // Common types and utilities
+#include <wirebit/common/crc.hpp>
+#include <wirebit/common/io_uring.hpp>
+#include <wirebit/common/log.hpp>
+#include <wirebit/common/pending_output.hpp>
 #include <wirebit/common/time.hpp>
+#include <wirebit/common/timestamping.hpp>
 #include <wirebit/common/types.hpp>
 
 // Core abstractions
+#include <wirebit/delay_line.hpp>
 #include <wirebit/endpoint.hpp>
 #include <wirebit/frame.hpp>
+#include <wirebit/frame_pool.hpp>
+#include <wirebit/histogram.hpp>
 #include <wirebit/link.hpp>
 #include <wirebit/model.hpp>
+#include <wirebit/rx_queue.hpp>
+#include <wirebit/stats_registry.hpp>
+#include <wirebit/stream_decoder.hpp>
+#include <wirebit/stream_framing.hpp>
+#include <wirebit/typed_frame.hpp>
 
 // Shared memory implementation
 #include <wirebit/shm/handshake.hpp>
+#include <wirebit/shm/memory.hpp>
 #include <wirebit/shm/ring.hpp>
+#include <wirebit/shm/shm_bus.hpp>
 #include <wirebit/shm/shm_link.hpp>
+#include <wirebit/shm/shm_registry.hpp>
+#include <wirebit/shm/slab.hpp>
+
+// Traffic capture and replay
+#include <wirebit/capture/observer_queue.hpp>
+#include <wirebit/capture/pcapng.hpp>
+#include <wirebit/capture/recording_link.hpp>
+#include <wirebit/capture/replay_link.hpp>
+#include <wirebit/capture/tee_link.hpp>
 
 // Hardware interface links (enabled by default, use NO_HARDWARE to disable)
 // IMPORTANT: Include these BEFORE eth_endpoint.hpp so system headers
 // are included first, then eth_endpoint.hpp can #undef conflicting macros
 #ifndef NO_HARDWARE
 #include <wirebit/can/socketcan_link.hpp>
+#include <wirebit/eth/packet_link.hpp>
 #include <wirebit/eth/tap_link.hpp>
 #include <wirebit/eth/tun_link.hpp>
 #include <wirebit/serial/pty_link.hpp>
 #include <wirebit/serial/tty_link.hpp>
 #endif // NO_HARDWARE
+#include <wirebit/eth/vnet_hdr.hpp>
 
 // Protocol endpoints
 // eth_endpoint.hpp must come after hardware headers to #undef system macros
+#include <wirebit/can/bus_hub.hpp>
 #include <wirebit/can/can_endpoint.hpp>
+#include <wirebit/can/can_signals.hpp>
 #include <wirebit/eth/eth_endpoint.hpp>
+#include <wirebit/eth/eth_switch.hpp>
 #include <wirebit/serial/serial_endpoint.hpp>
 
+// Event loop
+#include <wirebit/async.hpp>
+#include <wirebit/bridge.hpp>
+#include <wirebit/link_queue_set.hpp>
+#include <wirebit/link_reactor.hpp>
+#include <wirebit/mpsc_send_link.hpp>
+#include <wirebit/scenario_runner.hpp>
+#include <wirebit/virtual_time.hpp>
+
 namespace wirebit {
 
     // Library version
@@ -0,0 +1,239 @@
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    Task<int> add_later(int a, int b) { co_return a + b; }
+
+    Task<int> sum_of_three(int a, int b, int c) {
+        int ab = co_await add_later(a, b);
+        co_return co_await add_later(ab, c);
+    }
+
+    Frame numbered(uint32_t seq, size_t size = 8) {
+        Bytes payload(size, 0);
+        std::memcpy(payload.data(), &seq, sizeof(seq));
+        return make_frame(FrameType::SERIAL, payload);
+    }
+
+    uint32_t number_of(const Frame &frame) {
+        uint32_t seq;
+        std::memcpy(&seq, frame.payload.data(), sizeof(seq));
+        return seq;
+    }
+
+    /// Drive the loop until every task finished or the time runs out
+    void run_for(AsyncLoop &loop, uint64_t limit_ns) {
+        uint64_t deadline = static_cast<uint64_t>(now_ns()) + limit_ns;
+        while (loop.tasks() > 0 && static_cast<uint64_t>(now_ns()) < deadline) {
+            REQUIRE(loop.run_once(ms_to_ns(10)).is_ok());
+        }
+    }
+
+} // namespace
+
+TEST_CASE("Task chains values without a loop round") {
+    auto loop = std::move(AsyncLoop::create().value());
+    int result = 0;
+    auto task = [&]() -> Task<> { result = co_await sum_of_three(1, 2, 3); };
+    loop.spawn(task());
+    CHECK(loop.tasks() == 1);
+    CHECK(result == 0); // Spawned tasks start on the next round
+
+    REQUIRE(loop.run_once(0).is_ok());
+    CHECK(result == 6);
+    CHECK(loop.tasks() == 0);
+    CHECK(loop.stats().tasks_spawned == 1);
+    CHECK(loop.stats().tasks_completed == 1);
+    CHECK(loop.stats().resumes == 1);
+}
+
+TEST_CASE("AsyncLoop ping-pong over ShmLink") {
+    auto loop = std::move(AsyncLoop::create().value());
+    auto server = std::move(ShmLink::create(String("async_pingpong"), 8192).value());
+    auto client = std::move(ShmLink::attach(String("async_pingpong")).value());
+
+    const uint32_t rounds = 50;
+    uint32_t pongs = 0;
+    bool ok = true;
+
+    auto ponger = [&]() -> Task<> {
+        for (uint32_t i = 0; i < rounds; ++i) {
+            auto frame = co_await loop.recv_async(client);
+            if (!frame.is_ok()) {
+                ok = false;
+                co_return;
+            }
+            co_await loop.send_async(client, numbered(number_of(frame.value()) + 1000));
+        }
+    };
+    auto pinger = [&]() -> Task<> {
+        for (uint32_t i = 0; i < rounds; ++i) {
+            co_await loop.send_async(server, numbered(i));
+            auto frame = co_await loop.recv_async(server);
+            if (!frame.is_ok() || number_of(frame.value()) != i + 1000) {
+                ok = false;
+                co_return;
+            }
+            ++pongs;
+        }
+    };
+
+    loop.spawn(ponger());
+    loop.spawn(pinger());
+    REQUIRE(loop.run().is_ok());
+    CHECK(ok);
+    CHECK(pongs == rounds);
+    CHECK(loop.tasks() == 0);
+    CHECK(loop.stats().recv_parks > 0);
+    CHECK(loop.reactor().size() == 0); // Links are only watched while tasks wait on them
+}
+
+TEST_CASE("AsyncLoop send_async suspends under backpressure") {
+    AsyncLoopConfig config;
+    config.send_retry_ns = 20000;
+    auto loop = std::move(AsyncLoop::create(config).value());
+    auto server = std::move(ShmLink::create(String("async_backpressure"), 4096).value());
+    auto client = std::move(ShmLink::attach(String("async_backpressure")).value());
+
+    // Far more than the ring holds: the producer must park until the consumer makes room
+    const uint32_t count = 200;
+    bool ok = true;
+    Vector<uint32_t> received;
+
+    auto producer = [&]() -> Task<> {
+        for (uint32_t i = 0; i < count; ++i) {
+            auto sent = co_await loop.send_async(server, numbered(i, 200));
+            if (!sent.is_ok()) {
+                ok = false;
+                co_return;
+            }
+        }
+    };
+    auto consumer = [&]() -> Task<> {
+        while (received.size() < count) {
+            auto frame = co_await loop.recv_async(client);
+            if (!frame.is_ok()) {
+                ok = false;
+                co_return;
+            }
+            received.push_back(number_of(frame.value()));
+            if (received.size() % 16 == 0) {
+                co_await loop.sleep_for(us_to_ns(200)); // Slow reader
+            }
+        }
+    };
+
+    loop.spawn(producer());
+    loop.spawn(consumer());
+    run_for(loop, s_to_ns(5.0));
+    CHECK(ok);
+    REQUIRE(received.size() == count);
+    for (uint32_t i = 0; i < count; ++i) {
+        CHECK(received[i] == i);
+    }
+    CHECK(loop.stats().send_parks > 0);
+}
+
+TEST_CASE("AsyncLoop runs many sleeping tasks") {
+    VirtualClock clock;
+    ScopedClock use(clock);
+    auto loop = std::move(AsyncLoop::create().value());
+    TimeNs start = clock.now();
+
+    const int tasks = 2000;
+    Vector<int> wakeups(tasks, 0);
+    auto ecu = [&](int id) -> Task<> {
+        for (int cycle = 0; cycle < 5; ++cycle) {
+            co_await loop.sleep_for(ms_to_ns(1 + id % 10));
+            wakeups[id]++;
+        }
+    };
+    for (int i = 0; i < tasks; ++i) {
+        loop.spawn(ecu(i));
+    }
+
+    REQUIRE(loop.run_once(0).is_ok());
+    CHECK(loop.next_deadline() == static_cast<uint64_t>(clock.now() + ms_to_ns(1)));
+    while (loop.tasks() > 0) {
+        clock.advance_to(static_cast<TimeNs>(loop.next_deadline()));
+        REQUIRE(loop.run_once(0).is_ok());
+    }
+    for (int i = 0; i < tasks; ++i) {
+        CHECK(wakeups[i] == 5);
+    }
+    CHECK(clock.now() - start == ms_to_ns(50)); // The slowest tasks sleep 10 ms five times
+    CHECK(loop.stats().timer_parks == static_cast<uint64_t>(tasks) * 5);
+}
+
+TEST_CASE("AsyncLoop with CAN endpoints") {
+    auto loop = std::move(AsyncLoop::create().value());
+    auto server = std::make_shared<ShmLink>(std::move(ShmLink::create(String("async_can"), 8192).value()));
+    auto client = std::make_shared<ShmLink>(std::move(ShmLink::attach(String("async_can")).value()));
+    CanConfig config;
+    CanEndpoint tester(server, config, 1);
+    CanEndpoint ecu(client, config, 2);
+
+    // The ECU answers each request with ID + 8 and the same data
+    auto responder = [&]() -> Task<> {
+        for (int i = 0; i < 10; ++i) {
+            auto request = co_await loop.recv_can_async(ecu);
+            if (!request.is_ok()) {
+                co_return;
+            }
+            can_frame reply = request.value();
+            reply.can_id += 8;
+            co_await loop.send_can_async(ecu, reply);
+        }
+    };
+    int answered = 0;
+    auto requester = [&]() -> Task<> {
+        for (uint8_t i = 0; i < 10; ++i) {
+            uint8_t data[] = {i};
+            co_await loop.send_can_async(tester, CanEndpoint::make_std_frame(0x7E0, data, 1));
+            auto reply = co_await loop.recv_can_async(tester);
+            if (reply.is_ok() && reply.value().can_id == 0x7E8 && reply.value().data[0] == i) {
+                ++answered;
+            }
+        }
+    };
+
+    loop.spawn(responder());
+    loop.spawn(requester());
+    run_for(loop, s_to_ns(5.0));
+    CHECK(answered == 10);
+    CHECK(loop.tasks() == 0);
+}
+
+TEST_CASE("AsyncLoop destroys unfinished tasks") {
+    auto server = std::move(ShmLink::create(String("async_unfinished"), 4096).value());
+    auto client = std::move(ShmLink::attach(String("async_unfinished")).value());
+    auto guard = std::make_shared<int>(0);
+    {
+        auto loop = std::move(AsyncLoop::create().value());
+        auto waiter = [&](std::shared_ptr<int> held) -> Task<> {
+            auto frame = co_await loop.recv_async(client);
+            *held = frame.is_ok() ? 1 : 2;
+        };
+        loop.spawn(waiter(guard));
+        REQUIRE(loop.run_once(0).is_ok());
+        CHECK(loop.tasks() == 1);
+        CHECK(loop.reactor().size() == 1);
+        CHECK(guard.use_count() == 2);
+
+        SUBCASE("stop() ends run() from another thread") {
+            std::thread stopper([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                loop.stop();
+            });
+            REQUIRE(loop.run().is_ok());
+            stopper.join();
+            CHECK(loop.tasks() == 1);
+        }
+    }
+    CHECK(guard.use_count() == 1); // The parked coroutine frame was freed with the loop
+    CHECK(*guard == 0);
+}
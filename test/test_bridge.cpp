@@ -0,0 +1,229 @@
+#include <atomic>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <memory>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    /// Both ends of a ShmLink: the bridge gets `server`, the test talks through `client`
+    struct ShmPair {
+        std::shared_ptr<ShmLink> server;
+        std::shared_ptr<ShmLink> client;
+    };
+
+    ShmPair make_pair(const char *name, size_t capacity = 1 << 20) {
+        auto server = ShmLink::create(name, capacity);
+        REQUIRE(server.is_ok());
+        auto client = ShmLink::attach(name);
+        REQUIRE(client.is_ok());
+        return {std::make_shared<ShmLink>(std::move(server.value())),
+                std::make_shared<ShmLink>(std::move(client.value()))};
+    }
+
+    Frame numbered(FrameType type, uint32_t seq, size_t size = 16) {
+        Bytes payload(size, 0);
+        std::memcpy(payload.data(), &seq, sizeof(seq));
+        return make_frame(type, payload);
+    }
+
+    uint32_t number_of(const FrameView &view) {
+        uint32_t seq;
+        std::memcpy(&seq, view.payload.data(), sizeof(seq));
+        return seq;
+    }
+} // namespace
+
+TEST_CASE("Bridge forwards both directions") {
+    auto a = make_pair("test_bridge_fwd_a");
+    auto b = make_pair("test_bridge_fwd_b");
+    auto created = Bridge::create(a.server, b.server, {.a_to_b_types = frame_type_bit(FrameType::CAN)});
+    REQUIRE(created.is_ok());
+    auto &bridge = created.value();
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        REQUIRE(a.client->send(numbered(FrameType::CAN, i)).is_ok());
+    }
+    REQUIRE(a.client->send(numbered(FrameType::SERIAL, 99)).is_ok());
+    REQUIRE(b.client->send(numbered(FrameType::SERIAL, 7)).is_ok());
+
+    CHECK(bridge.pump() == 11);
+    for (uint32_t i = 0; i < 10; ++i) {
+        auto frame = b.client->recv_view();
+        REQUIRE(frame.is_ok());
+        CHECK(number_of(frame.value()) == i);
+    }
+    CHECK(b.client->recv_view().is_err()); // SERIAL is not forwarded from A to B
+    auto back = a.client->recv_view();
+    REQUIRE(back.is_ok());
+    CHECK(back.value().type() == FrameType::SERIAL);
+
+    auto stats = bridge.stats();
+    CHECK(stats.a_to_b.frames_forwarded == 10);
+    CHECK(stats.a_to_b.frames_filtered == 1);
+    CHECK(stats.b_to_a.frames_forwarded == 1);
+    CHECK(stats.a_to_b.bytes_forwarded == 10 * make_view(numbered(FrameType::CAN, 0)).total_size());
+    bridge.reset_stats();
+    CHECK(bridge.stats().a_to_b.frames_forwarded == 0);
+
+    CHECK(Bridge::create(a.server, nullptr).is_err());
+    CHECK(Bridge::create(a.server, a.server).is_err());
+    CHECK(Bridge::create(a.server, b.server, {.batch = 0}).is_err());
+}
+
+TEST_CASE("Bridge backpressure keeps every frame in order") {
+    auto a = make_pair("test_bridge_bp_a");
+    auto b = make_pair("test_bridge_bp_b", 4096);
+    auto created = Bridge::create(a.server, b.server, {.batch = 16});
+    REQUIRE(created.is_ok());
+    auto &bridge = created.value();
+
+    constexpr uint32_t COUNT = 500;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        REQUIRE(a.client->send(numbered(FrameType::ETHERNET, i, 64)).is_ok());
+    }
+
+    // B's ring holds only a few dozen frames: the bridge stalls instead of dropping
+    for (int i = 0; i < 50; ++i) {
+        bridge.pump();
+    }
+    CHECK(bridge.stats().a_to_b.backpressure > 0);
+    CHECK(bridge.held(BridgeDirection::AToB) == 1); // The refused view, still in A's ring
+    CHECK(bridge.next_deadline() != UINT64_MAX);
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    for (int round = 0; round < 10000 && expected < COUNT; ++round) {
+        bridge.pump();
+        while (true) {
+            auto frame = b.client->recv_view();
+            if (!frame.is_ok()) {
+                break;
+            }
+            ordered = ordered && number_of(frame.value()) == expected;
+            ++expected;
+        }
+    }
+    CHECK(ordered);
+    CHECK(expected == COUNT);
+    CHECK(bridge.stats().a_to_b.frames_forwarded == COUNT);
+    CHECK(bridge.stats().a_to_b.send_errors == 0);
+    CHECK(bridge.held(BridgeDirection::AToB) == 0);
+}
+
+TEST_CASE("Bridge applies the link model once") {
+    VirtualClock clock;
+    ScopedClock use(clock);
+    auto a = make_pair("test_bridge_model_a");
+    auto b = make_pair("test_bridge_model_b");
+
+    SUBCASE("Latency holds frames until due") {
+        LinkModel model(ms_to_ns(5));
+        auto created = Bridge::create(a.server, b.server, {}, &model);
+        REQUIRE(created.is_ok());
+        auto &bridge = created.value();
+
+        TimeNs sent_at = clock.now();
+        for (uint32_t i = 0; i < 4; ++i) {
+            REQUIRE(a.client->send(numbered(FrameType::CAN, i)).is_ok());
+        }
+        CHECK(bridge.pump() == 0);
+        CHECK(bridge.held(BridgeDirection::AToB) == 4);
+        CHECK(bridge.next_deadline() == static_cast<uint64_t>(sent_at) + ms_to_ns(5));
+        CHECK(b.client->recv_view().is_err());
+
+        clock.advance_by(ms_to_ns(5));
+        CHECK(bridge.pump() == 4);
+        for (uint32_t i = 0; i < 4; ++i) {
+            auto frame = b.client->recv_view();
+            REQUIRE(frame.is_ok());
+            CHECK(number_of(frame.value()) == i);
+            CHECK(frame.value().header.deliver_at_ns == static_cast<uint64_t>(sent_at) + ms_to_ns(5));
+        }
+        CHECK(bridge.held(BridgeDirection::AToB) == 0);
+        CHECK(bridge.next_deadline() == UINT64_MAX);
+    }
+
+    SUBCASE("Drop and duplicate are rolled per frame") {
+        LinkModel drop_all(0, 0, 1.0);
+        auto dropping = Bridge::create(a.server, b.server, {}, &drop_all);
+        REQUIRE(dropping.is_ok());
+        for (uint32_t i = 0; i < 5; ++i) {
+            REQUIRE(a.client->send(numbered(FrameType::CAN, i)).is_ok());
+        }
+        CHECK(dropping.value().pump() == 0);
+        CHECK(dropping.value().stats().a_to_b.frames_dropped == 5);
+        CHECK(b.client->recv_view().is_err());
+
+        LinkModel dup_all(0, 0, 0.0, 1.0);
+        auto duplicating = Bridge::create(b.server, a.server, {}, &dup_all);
+        REQUIRE(duplicating.is_ok());
+        REQUIRE(b.client->send(numbered(FrameType::CAN, 42)).is_ok());
+        CHECK(duplicating.value().pump() == 2);
+        CHECK(duplicating.value().stats().a_to_b.frames_duplicated == 1);
+        CHECK(a.client->recv().is_ok());
+        CHECK(a.client->recv().is_ok());
+        CHECK(a.client->recv().is_err());
+    }
+}
+
+TEST_CASE("Bridge on its own thread and on a reactor") {
+    auto a = make_pair("test_bridge_run_a");
+    auto b = make_pair("test_bridge_run_b");
+    auto created = Bridge::create(a.server, b.server);
+    REQUIRE(created.is_ok());
+    auto &bridge = created.value();
+    constexpr uint32_t COUNT = 2000;
+
+    SUBCASE("Thread") {
+        REQUIRE(bridge.start().is_ok());
+        CHECK(bridge.running());
+        CHECK(bridge.start().is_err());
+
+        std::thread sender([&]() {
+            for (uint32_t i = 0; i < COUNT;) {
+                if (a.client->send(numbered(FrameType::CAN, i)).is_ok()) {
+                    ++i;
+                }
+            }
+        });
+        uint32_t expected = 0;
+        while (expected < COUNT) {
+            auto frame = b.client->recv_view();
+            if (!frame.is_ok()) {
+                std::this_thread::yield();
+                continue;
+            }
+            CHECK(number_of(frame.value()) == expected);
+            ++expected;
+        }
+        sender.join();
+        bridge.stop();
+        CHECK_FALSE(bridge.running());
+        CHECK(bridge.stats().a_to_b.frames_forwarded == COUNT);
+    }
+
+    SUBCASE("Reactor") {
+        auto reactor = LinkReactor::create();
+        REQUIRE(reactor.is_ok());
+        REQUIRE(bridge.attach(reactor.value()).is_ok());
+        CHECK(reactor.value().size() == 2);
+        CHECK(bridge.start().is_err());
+
+        for (uint32_t i = 0; i < 100; ++i) {
+            REQUIRE(a.client->send(numbered(FrameType::CAN, i)).is_ok());
+            REQUIRE(b.client->send(numbered(FrameType::CAN, i)).is_ok());
+        }
+        for (int round = 0; round < 20; ++round) {
+            reactor.value().run_once(0);
+        }
+        auto stats = bridge.stats();
+        CHECK(stats.a_to_b.frames_forwarded == 100);
+        CHECK(stats.b_to_a.frames_forwarded == 100);
+
+        bridge.detach();
+        CHECK(reactor.value().size() == 0);
+    }
+}
@@ -0,0 +1,191 @@
+#include <chrono>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    /// Hub-side links of one bus and the node-side ends attached to them
+    struct TestBus {
+        Vector<std::shared_ptr<ShmLink>> hub_side;
+        Vector<ShmLink> nodes;
+    };
+
+    TestBus make_bus(BusHub &hub, size_t bus, const char *prefix, size_t count) {
+        TestBus tb;
+        for (size_t i = 0; i < count; ++i) {
+            char name[64];
+            snprintf(name, sizeof(name), "%s_%zu", prefix, i);
+            auto created = ShmLink::create(name, 16384);
+            REQUIRE(created.is_ok());
+            auto link = std::make_shared<ShmLink>(std::move(created.value()));
+            auto attached = ShmLink::attach(name);
+            REQUIRE(attached.is_ok());
+            REQUIRE(hub.add_node(bus, link).is_ok());
+            tb.hub_side.push_back(link);
+            tb.nodes.push_back(std::move(attached.value()));
+        }
+        return tb;
+    }
+
+    Frame can_wire_frame(uint32_t can_id, uint8_t tag, uint32_t src) {
+        can_frame cf = {};
+        cf.can_id = can_id;
+        cf.can_dlc = 1;
+        cf.data[0] = tag;
+        Bytes payload(sizeof(can_frame));
+        std::memcpy(payload.data(), &cf, sizeof(cf));
+        return make_frame(FrameType::CAN, payload, src, 0);
+    }
+
+    can_frame unwrap(const Frame &frame) {
+        can_frame cf = {};
+        std::memcpy(&cf, frame.payload.data(), sizeof(cf));
+        return cf;
+    }
+} // namespace
+
+TEST_CASE("CAN arbitration key") {
+    CHECK(can_arbitration_key(0x100) < can_arbitration_key(0x101));
+    CHECK(can_arbitration_key(0x7FF) > can_arbitration_key(0x000));
+    // Data frame beats remote frame with the same ID
+    CHECK(can_arbitration_key(0x123) < can_arbitration_key(0x123 | CAN_RTR_FLAG));
+    // Standard frame beats extended frame with the same base ID
+    uint32_t ext = (0x123u << 18) | CAN_EFF_FLAG;
+    CHECK(can_arbitration_key(0x123) < can_arbitration_key(ext));
+    // ...but a lower base ID always wins
+    CHECK(can_arbitration_key((0x122u << 18) | 0x3FFFF | CAN_EFF_FLAG) < can_arbitration_key(0x123));
+    CHECK(can_arbitration_key(ext) < can_arbitration_key(ext | 1));
+}
+
+TEST_CASE("BusHub forwarding") {
+    SUBCASE("Frame reaches every node except the sender") {
+        auto hub = BusHub::create().value();
+        size_t bus = hub.add_bus("fwd").value();
+        TestBus tb = make_bus(hub, bus, "test_hub_fwd", 3);
+        CHECK(hub.node_count(bus) == 3);
+
+        REQUIRE(tb.nodes[0].send(can_wire_frame(0x123, 7, 1)).is_ok());
+        CHECK(hub.run_once(0) == 1);
+
+        for (size_t i = 1; i < 3; ++i) {
+            auto result = tb.nodes[i].recv();
+            REQUIRE(result.is_ok());
+            CHECK(unwrap(result.value()).can_id == 0x123);
+            CHECK(unwrap(result.value()).data[0] == 7);
+        }
+        CHECK_FALSE(tb.nodes[0].recv().is_ok());
+
+        const BusHubStats &stats = hub.stats(bus);
+        CHECK(stats.frames_received == 1);
+        CHECK(stats.frames_forwarded == 1);
+        CHECK(stats.deliveries == 2);
+    }
+
+    SUBCASE("Lowest ID wins and each frame holds the bus for its frame time") {
+        CanConfig config;
+        config.bitrate = 125000;
+        auto hub = BusHub::create().value();
+        size_t bus = hub.add_bus("arb", config).value();
+        TestBus tb = make_bus(hub, bus, "test_hub_arb", 4);
+
+        REQUIRE(tb.nodes[0].send(can_wire_frame(0x300, 1, 1)).is_ok());
+        REQUIRE(tb.nodes[1].send(can_wire_frame(0x100, 2, 2)).is_ok());
+        REQUIRE(tb.nodes[2].send(can_wire_frame(0x200, 3, 3)).is_ok());
+
+        // One frame per bus slot
+        CHECK(hub.run_once(0) == 1);
+        CHECK(hub.pending(bus) == 2);
+        size_t forwarded = 1;
+        for (int i = 0; i < 100 && forwarded < 3; ++i) {
+            forwarded += hub.run_once(ms_to_ns(10));
+        }
+        REQUIRE(forwarded == 3);
+
+        Vector<Frame> seen;
+        while (true) {
+            auto result = tb.nodes[3].recv();
+            if (!result.is_ok()) {
+                break;
+            }
+            seen.push_back(std::move(result.value()));
+        }
+        REQUIRE(seen.size() == 3);
+        CHECK(unwrap(seen[0]).can_id == 0x100);
+        CHECK(unwrap(seen[1]).can_id == 0x200);
+        CHECK(unwrap(seen[2]).can_id == 0x300);
+
+        // Back-to-back slots: deliveries are exactly one frame time apart
+        uint64_t slot = can_frame_time_ns(unwrap(seen[1]), config.bitrate);
+        CHECK(seen[2].header.deliver_at_ns - seen[1].header.deliver_at_ns == slot);
+        CHECK(hub.stats(bus).arbitration_losses == 3); // 2 lost the first round, 1 the second
+        CHECK(hub.stats(bus).busy_ns == 3 * slot);
+    }
+
+    SUBCASE("Non-CAN frames are ignored") {
+        auto hub = BusHub::create().value();
+        size_t bus = hub.add_bus("ign").value();
+        TestBus tb = make_bus(hub, bus, "test_hub_ign", 2);
+
+        Bytes payload = {1, 2, 3};
+        REQUIRE(tb.nodes[0].send(make_frame(FrameType::SERIAL, payload, 1, 0)).is_ok());
+        CHECK(hub.run_once(0) == 0);
+        CHECK(hub.stats(bus).frames_ignored == 1);
+        CHECK_FALSE(tb.nodes[1].recv().is_ok());
+    }
+
+    SUBCASE("Configuration errors") {
+        auto hub = BusHub::create().value();
+        CHECK_FALSE(hub.start().is_ok());
+        CHECK_FALSE(hub.add_node(0, nullptr).is_ok());
+    }
+}
+
+TEST_CASE("BusHub sharded workers") {
+    constexpr size_t BUSES = 4;
+    constexpr size_t NODES = 3;
+
+    BusHubConfig config;
+    config.workers = 2;
+    auto hub = BusHub::create(config).value();
+
+    Vector<TestBus> buses;
+    for (size_t b = 0; b < BUSES; ++b) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "test_hub_shard%zu", b);
+        size_t id = hub.add_bus(prefix).value();
+        buses.push_back(make_bus(hub, id, prefix, NODES));
+    }
+    REQUIRE(hub.start().is_ok());
+    CHECK(hub.running());
+    CHECK_FALSE(hub.add_bus("late").is_ok());
+
+    for (size_t b = 0; b < BUSES; ++b) {
+        REQUIRE(buses[b].nodes[0].send(can_wire_frame(0x10 + static_cast<uint32_t>(b), 0, 1)).is_ok());
+    }
+
+    // Every other node of every bus gets its bus's frame and nothing from the other buses
+    for (size_t b = 0; b < BUSES; ++b) {
+        for (size_t n = 1; n < NODES; ++n) {
+            Result<Frame, Error> result = Result<Frame, Error>::err(Error::timeout("not yet"));
+            for (int i = 0; i < 200 && !result.is_ok(); ++i) {
+                result = buses[b].nodes[n].recv();
+                if (!result.is_ok()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            REQUIRE(result.is_ok());
+            CHECK(unwrap(result.value()).can_id == 0x10 + b);
+            CHECK_FALSE(buses[b].nodes[n].recv().is_ok());
+        }
+    }
+
+    hub.stop();
+    CHECK_FALSE(hub.running());
+    for (size_t b = 0; b < BUSES; ++b) {
+        CHECK(hub.stats(b).frames_forwarded == 1);
+        CHECK(hub.stats(b).deliveries == NODES - 1);
+    }
+}
@@ -252,3 +252,190 @@ TEST_CASE("CanEndpoint basic operations") {
         CHECK(send_result.is_ok());
     }
 }
+
+TEST_CASE("CanEndpoint CAN FD") {
+    auto server_result = wirebit::ShmLink::create(wirebit::String("can_fd"), 16384);
+    REQUIRE(server_result.is_ok());
+    auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+
+    auto client_result = wirebit::ShmLink::attach(wirebit::String("can_fd"));
+    REQUIRE(client_result.is_ok());
+    auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+    wirebit::CanConfig config;
+    wirebit::CanEndpoint tx(server_link, config, 1);
+    wirebit::CanEndpoint rx(client_link, config, 2);
+
+    uint8_t data[64];
+    for (int i = 0; i < 64; ++i) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+
+    SUBCASE("Send and receive 64-byte frame") {
+        auto frame = wirebit::CanEndpoint::make_fd_frame(0x123, data, 64);
+        CHECK(frame.len == 64);
+        CHECK(frame.flags == (CANFD_FDF | CANFD_BRS));
+        REQUIRE(tx.send_canfd(frame).is_ok());
+
+        wirebit::canfd_frame received;
+        REQUIRE(rx.recv_canfd(received).is_ok());
+        CHECK(received.can_id == 0x123);
+        CHECK(received.len == 64);
+        CHECK((received.flags & CANFD_BRS) != 0);
+        CHECK(std::memcmp(received.data, data, 64) == 0);
+    }
+
+    SUBCASE("Lengths round up to valid FD sizes") {
+        CHECK(wirebit::CanEndpoint::make_fd_frame(0x1, data, 9).len == 12);
+        CHECK(wirebit::CanEndpoint::make_fd_frame(0x1, data, 33).len == 48);
+        CHECK(wirebit::CanEndpoint::make_fd_frame(0x1, data, 100).len == 64);
+        CHECK(wirebit::CanEndpoint::make_fd_frame(0x1, data, 9).data[9] == 0);
+    }
+
+    SUBCASE("Invalid FD length") {
+        wirebit::canfd_frame frame = {};
+        frame.can_id = 0x123;
+        frame.len = 13;
+        auto result = tx.send_canfd(frame);
+        CHECK_FALSE(result.is_ok());
+    }
+
+    SUBCASE("Classic and FD frames share the receive path") {
+        REQUIRE(tx.send_can(wirebit::CanEndpoint::make_std_frame(0x10, data, 8)).is_ok());
+        REQUIRE(tx.send_canfd(wirebit::CanEndpoint::make_fd_frame(0x20, data, 16)).is_ok());
+        REQUIRE(tx.send_can(wirebit::CanEndpoint::make_std_frame(0x30, data, 8)).is_ok());
+
+        // recv() returns each frame in its own wire size
+        auto first = rx.recv();
+        REQUIRE(first.is_ok());
+        CHECK(first.value().size() == sizeof(wirebit::can_frame));
+        auto second = rx.recv();
+        REQUIRE(second.is_ok());
+        CHECK(second.value().size() == sizeof(wirebit::canfd_frame));
+
+        // recv_can() drops FD frames it cannot represent
+        REQUIRE(tx.send_canfd(wirebit::CanEndpoint::make_fd_frame(0x40, data, 16)).is_ok());
+        REQUIRE(tx.send_can(wirebit::CanEndpoint::make_std_frame(0x50, data, 1)).is_ok());
+        wirebit::can_frame classic;
+        REQUIRE(rx.recv_can(classic).is_ok());
+        CHECK(classic.can_id == 0x30);
+        REQUIRE(rx.recv_can(classic).is_ok());
+        CHECK(classic.can_id == 0x50);
+        CHECK(classic.can_dlc == 1);
+    }
+
+    SUBCASE("Frame time with bit rate switch") {
+        auto brs = wirebit::CanEndpoint::make_fd_frame(0x123, data, 64, true);
+        auto no_brs = wirebit::CanEndpoint::make_fd_frame(0x123, data, 64, false);
+
+        // 64 bytes at 500 kbps nominal / 2 Mbps data
+        uint64_t brs_ns = tx.frame_time_ns(brs);
+        uint64_t no_brs_ns = tx.frame_time_ns(no_brs);
+        CHECK(brs_ns < no_brs_ns);
+        CHECK(no_brs_ns > 1000000); // > 1 ms entirely at 500 kbps
+        CHECK(brs_ns < 400000);     // data phase dominates at 4x the rate
+
+        // Classic 8-byte standard frame: (47 + 64) * 1.2 = 133 bits at 500 kbps
+        auto classic = wirebit::CanEndpoint::make_std_frame(0x123, data, 8);
+        CHECK(tx.frame_time_ns(classic) == 266000);
+    }
+}
+
+TEST_CASE("CanAcceptanceFilter") {
+    SUBCASE("Empty filter list accepts everything") {
+        wirebit::CanAcceptanceFilter filter;
+        CHECK(filter.accepts_all());
+        CHECK(filter.accept(0x123));
+        CHECK(filter.accept(0x1ABCDEF | CAN_EFF_FLAG));
+    }
+
+    SUBCASE("Standard ID mask") {
+        wirebit::CanAcceptanceFilter filter({{0x100, 0x7F0}});
+        CHECK(filter.accept(0x100));
+        CHECK(filter.accept(0x10F));
+        CHECK(filter.accept(0x10F | CAN_RTR_FLAG));
+        CHECK_FALSE(filter.accept(0x110));
+        // Mask without CAN_EFF_FLAG also matches extended frames on the masked bits
+        CHECK(filter.accept(0x105 | CAN_EFF_FLAG));
+        CHECK_FALSE(filter.accept(0x1205 | CAN_EFF_FLAG));
+    }
+
+    SUBCASE("Frame format and RTR bits in the mask") {
+        wirebit::CanAcceptanceFilter filter({{0x123, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG}});
+        CHECK(filter.accept(0x123));
+        CHECK_FALSE(filter.accept(0x123 | CAN_RTR_FLAG));
+        CHECK_FALSE(filter.accept(0x123 | CAN_EFF_FLAG));
+    }
+
+    SUBCASE("Extended exact IDs, ranges and inverted filters") {
+        wirebit::CanAcceptanceFilter filter({
+            {0x18FEF100 | CAN_EFF_FLAG, CAN_EFF_MASK | CAN_EFF_FLAG}, // One J1939 PGN from one source
+            {0x0CF00400 | CAN_EFF_FLAG, 0x1FFFFF00 | CAN_EFF_FLAG},   // Range 0x0CF00400-0x0CF004FF
+        });
+        CHECK(filter.accept(0x18FEF100 | CAN_EFF_FLAG));
+        CHECK_FALSE(filter.accept(0x18FEF101 | CAN_EFF_FLAG));
+        CHECK(filter.accept(0x0CF004AB | CAN_EFF_FLAG));
+        CHECK_FALSE(filter.accept(0x0CF005AB | CAN_EFF_FLAG));
+        CHECK_FALSE(filter.accept(0x123));
+        CHECK(filter.accept(CAN_ERR_FLAG | 0x4)); // Error frames always pass
+
+        // Inverted: everything except standard ID 0x7DF (extended frames never match the inner test)
+        wirebit::CanAcceptanceFilter inverted({{0x7DF | CAN_INV_FILTER, CAN_SFF_MASK | CAN_EFF_FLAG}});
+        CHECK(inverted.accept(0x123));
+        CHECK_FALSE(inverted.accept(0x7DF));
+        CHECK(inverted.accept(0x7DF | CAN_EFF_FLAG));
+    }
+
+    SUBCASE("Compiled lookup agrees with kernel semantics") {
+        wirebit::Vector<wirebit::can_filter> filters = {
+            {0x100, 0x700},
+            {0x555, 0x555 | CAN_RTR_FLAG},
+            {0x12345 | CAN_EFF_FLAG, 0x1F0F0 | CAN_EFF_FLAG},
+            {0x20 | CAN_INV_FILTER, 0x7FF},
+            {0x1000000 | CAN_EFF_FLAG, 0x1F000000 | CAN_EFF_FLAG},
+        };
+        wirebit::CanAcceptanceFilter filter(filters);
+
+        uint32_t state = 12345;
+        for (int i = 0; i < 20000; ++i) {
+            state = state * 1103515245 + 12345;
+            uint32_t id = (state & 1) ? ((state >> 3) & CAN_EFF_MASK) | CAN_EFF_FLAG : (state >> 3) & CAN_SFF_MASK;
+            if (state & 2) {
+                id |= CAN_RTR_FLAG;
+            }
+            bool expected = false;
+            for (const auto &f : filters) {
+                expected = expected || wirebit::CanAcceptanceFilter::matches(f, id);
+            }
+            REQUIRE(filter.accept(id) == expected);
+        }
+    }
+
+    SUBCASE("Endpoint drops filtered frames before buffering") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("can_filter"), 8192);
+        REQUIRE(server_result.is_ok());
+        auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("can_filter"));
+        REQUIRE(client_result.is_ok());
+        auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+        wirebit::CanConfig tx_config;
+        wirebit::CanConfig rx_config;
+        rx_config.filters = {{0x200, 0x7F0}};
+        wirebit::CanEndpoint tx(server_link, tx_config, 1);
+        wirebit::CanEndpoint rx(client_link, rx_config, 2);
+
+        for (uint32_t id : {0x100U, 0x201U, 0x300U, 0x20FU}) {
+            REQUIRE(tx.send_can(wirebit::CanEndpoint::make_std_frame(id, nullptr, 0)).is_ok());
+        }
+
+        rx.process();
+        CHECK(rx.rx_buffer_size() == 2);
+        CHECK(rx.filtered_count() == 2);
+        wirebit::can_frame cf;
+        REQUIRE(rx.recv_can(cf).is_ok());
+        CHECK(cf.can_id == 0x201);
+        REQUIRE(rx.recv_can(cf).is_ok());
+        CHECK(cf.can_id == 0x20F);
+    }
+}
@@ -0,0 +1,228 @@
+#include <cmath>
+#include <doctest/doctest.h>
+#include <memory>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    const char *ENGINE_DBC = R"(VERSION ""
+
+BU_: ECU GW
+
+BO_ 256 Engine: 8 ECU
+ SG_ Speed : 8|16@1+ (0.25,-10) [-10|16373.75] "rpm" GW
+ SG_ Temp : 24|8@1- (1,0) [-128|127] "degC" GW
+ SG_ Pressure : 35|12@0+ (0.5,0) [0|2047.5] "kPa" GW
+ SG_ Flag : 48|1@1+ (1,0) [0|1] "" GW
+
+BO_ 512 Diag: 8 ECU
+ SG_ Page M : 0|8@1+ (1,0) [0|255] "" GW
+ SG_ Voltage m0 : 8|16@1+ (0.001,0) [0|65.535] "V" GW
+ SG_ Current m1 : 8|16@1- (0.01,0) [-327.68|327.67] "A" GW
+ SG_ Counter : 56|8@1+ (1,0) [0|255] "" GW
+
+BO_ 2566844926 J1939: 8 ECU
+ SG_ Level : 7|16@0+ (1,0) [0|65535] "" GW
+
+CM_ SG_ 256 Speed "Engine speed";
+BA_DEF_ "BusType" STRING ;
+)";
+
+    can_frame engine_frame() {
+        uint8_t data[8] = {0x00, 0x34, 0x12, 0xFE, 0x0A, 0xBC, 0x01, 0x00};
+        return CanEndpoint::make_std_frame(0x100, data, 8);
+    }
+
+    double value_of(const CanSignalDb &db, const CanSignalCache &cache, const char *name) {
+        return cache.value(db.find(name).value());
+    }
+
+} // namespace
+
+TEST_CASE("CanSignalDb decodes DBC signals") {
+    auto parsed = CanSignalDb::parse_dbc(String(ENGINE_DBC));
+    REQUIRE(parsed.is_ok());
+    const CanSignalDb &db = parsed.value();
+    CHECK(db.size() == 9);
+    CHECK(db.message_count() == 3);
+    CHECK(db.has_message(0x100));
+    CHECK_FALSE(db.has_message(0x101));
+    CHECK(db.find("Missing").error().code == Error::not_found("").code);
+
+    const CanSignal &speed = db.signal(db.find("Speed").value());
+    CHECK(speed.can_id == 0x100);
+    CHECK(speed.factor == 0.25);
+    CHECK(speed.unit == String("rpm"));
+    CHECK(db.signal(db.find("Temp").value()).is_signed);
+    CHECK(db.signal(db.find("Pressure").value()).byte_order == CanByteOrder::Motorola);
+    CHECK(db.signal(db.find("Page").value()).multiplexor);
+    CHECK(db.signal(db.find("Current").value()).mux_value == 1);
+
+    CanSignalCache cache(db.size());
+    CHECK_FALSE(cache.has_value(db.find("Speed").value()));
+
+    SUBCASE("Intel, Motorola, signed and scaled signals") {
+        can_frame cf = engine_frame();
+        CHECK(db.decode(cf, cache, 1000) == 4);
+        CHECK(value_of(db, cache, "Speed") == 0x1234 * 0.25 - 10);
+        CHECK(value_of(db, cache, "Temp") == -2);
+        CHECK(value_of(db, cache, "Pressure") == 0xABC * 0.5);
+        CHECK(value_of(db, cache, "Flag") == 1);
+        size_t speed_index = db.find("Speed").value();
+        CHECK(cache.has_value(speed_index));
+        CHECK(cache.updated_ns(speed_index) == 1000);
+        CHECK(cache.update_count(speed_index) == 1);
+
+        // Signals past the frame's DLC keep their previous value
+        cf.can_dlc = 4;
+        cf.data[1] = 0;
+        cf.data[2] = 0;
+        CHECK(db.decode(cf, cache, 2000) == 2);
+        CHECK(value_of(db, cache, "Speed") == -10);
+        CHECK(cache.updated_ns(db.find("Flag").value()) == 1000);
+
+        // RTR frames carry no data
+        cf.can_id |= CAN_RTR_FLAG;
+        CHECK(db.decode(cf, cache, 3000) == 0);
+    }
+
+    SUBCASE("Multiplexed signals follow the multiplexor") {
+        uint8_t page0[8] = {0, 0x10, 0x27, 0, 0, 0, 0, 7};
+        uint8_t page1[8] = {1, 0x9C, 0xFF, 0, 0, 0, 0, 8};
+        CHECK(db.decode(CanEndpoint::make_std_frame(0x200, page0, 8), cache, 1) == 3);
+        CHECK(std::abs(value_of(db, cache, "Voltage") - 10.0) < 1e-9);
+        CHECK_FALSE(cache.has_value(db.find("Current").value()));
+        CHECK(db.decode(CanEndpoint::make_std_frame(0x200, page1, 8), cache, 2) == 3);
+        CHECK(std::abs(value_of(db, cache, "Current") + 1.0) < 1e-9);
+        CHECK(cache.update_count(db.find("Voltage").value()) == 1);
+        CHECK(value_of(db, cache, "Counter") == 8);
+    }
+
+    SUBCASE("Extended IDs") {
+        uint8_t data[8] = {0xAB, 0xCD, 0, 0, 0, 0, 0, 0};
+        CHECK(db.decode(CanEndpoint::make_ext_frame(0x18FEF1FE, data, 8), cache, 1) == 1);
+        CHECK(value_of(db, cache, "Level") == 0xABCD);
+        CHECK(db.decode(CanEndpoint::make_std_frame(0x7FE, data, 8), cache, 1) == 0);
+    }
+
+    SUBCASE("Batch decoding") {
+        Vector<can_frame> frames;
+        for (uint8_t i = 0; i < 10; ++i) {
+            can_frame cf = engine_frame();
+            cf.data[1] = i;
+            frames.push_back(cf);
+        }
+        frames.push_back(CanEndpoint::make_std_frame(0x555, nullptr, 0));
+        CHECK(db.decode_batch(std::span<const can_frame>(frames), cache, 5) == 40);
+        CHECK(value_of(db, cache, "Speed") == (0x1200 + 9) * 0.25 - 10);
+        CHECK(cache.update_count(db.find("Speed").value()) == 10);
+    }
+}
+
+TEST_CASE("CanSignalDb compiles CAN FD and rejects bad layouts") {
+    Vector<CanSignal> signals;
+    CanSignal tail;
+    tail.name = String("Tail");
+    tail.can_id = 0x300;
+    tail.start_bit = 480; // Bytes 60-63
+    tail.length = 32;
+    signals.push_back(tail);
+    CanSignal full;
+    full.name = String("Full");
+    full.can_id = 0x300;
+    full.start_bit = 64;
+    full.length = 64;
+    full.is_signed = true;
+    signals.push_back(full);
+
+    auto compiled = CanSignalDb::compile(signals);
+    REQUIRE(compiled.is_ok());
+    const CanSignalDb &db = compiled.value();
+    CanSignalCache cache(db.size());
+
+    canfd_frame fd = {};
+    fd.can_id = 0x300;
+    fd.len = 64;
+    fd.flags = CANFD_FDF;
+    for (int i = 8; i < 16; ++i) {
+        fd.data[i] = 0xFF;
+    }
+    fd.data[60] = 0x78;
+    fd.data[61] = 0x56;
+    fd.data[62] = 0x34;
+    fd.data[63] = 0x12;
+    CHECK(db.decode(fd, cache, 1) == 2);
+    CHECK(cache.value(0) == 0x12345678);
+    CHECK(cache.value(1) == -1);
+
+    fd.len = 32; // Tail not carried
+    CHECK(db.decode(fd, cache, 2) == 1);
+    CHECK(cache.updated_ns(0) == 1);
+
+    SUBCASE("Bad layouts") {
+        CanSignal bad;
+        bad.name = String("Bad");
+        bad.length = 0;
+        CHECK(CanSignalDb::compile(Vector<CanSignal>{bad}).error().code == Error::invalid_argument("").code);
+        bad.length = 64;
+        bad.byte_order = CanByteOrder::Motorola; // MSB at bit 0 spans 9 bytes
+        CHECK(CanSignalDb::compile(Vector<CanSignal>{bad}).is_err());
+        bad.byte_order = CanByteOrder::Intel;
+        bad.start_bit = 510; // Ends past byte 63
+        CHECK(CanSignalDb::compile(Vector<CanSignal>{bad}).is_err());
+        bad.start_bit = 0;
+        bad.length = 8;
+        bad.mux_value = 2; // No multiplexor in the message
+        CHECK(CanSignalDb::compile(Vector<CanSignal>{bad}).is_err());
+    }
+
+    SUBCASE("Malformed DBC") {
+        CHECK(CanSignalDb::parse_dbc(String("BO_ 1 M: 8 ECU\n SG_ S : 0|8@2+ (1,0) [0|0] \"\" GW\n")).is_err());
+        CHECK(CanSignalDb::parse_dbc(String(" SG_ S : 0|8@1+ (1,0) [0|0] \"\" GW\n")).is_err()); // No BO_
+        CHECK(CanSignalDb::parse_dbc(String("BO_ 1 M: 8 ECU\n SG_ S : 0|8@1+ (1,0)\n")).is_err());
+    }
+}
+
+TEST_CASE("CanEndpoint keeps a signal cache") {
+    auto created = ShmLink::create_pair("can_signals", 16 << 10);
+    REQUIRE(created.is_ok());
+    auto links = std::move(created.value());
+    CanConfig config;
+    CanEndpoint tx(std::make_shared<ShmLink>(std::move(links.first)), config, 1);
+    CanEndpoint rx(std::make_shared<ShmLink>(std::move(links.second)), config, 2);
+
+    auto db = std::make_shared<const CanSignalDb>(std::move(CanSignalDb::parse_dbc(String(ENGINE_DBC)).value()));
+    rx.set_signal_db(db, false);
+    REQUIRE(rx.signal_db() == db.get());
+    CHECK(rx.signals().size() == db->size());
+
+    REQUIRE(tx.send_can(engine_frame()).is_ok());
+    REQUIRE(tx.send_can(CanEndpoint::make_std_frame(0x42, nullptr, 0)).is_ok());
+    rx.process();
+    CHECK(value_of(*db, rx.signals(), "Speed") == 0x1234 * 0.25 - 10);
+    CHECK(value_of(*db, rx.signals(), "Pressure") == 0xABC * 0.5);
+
+    // Only the frame without signals was buffered
+    can_frame out = {};
+    REQUIRE(rx.recv_can(out).is_ok());
+    CHECK(out.can_id == 0x42);
+    CHECK(rx.recv_can(out).is_err());
+
+    SUBCASE("Decoded frames can stay buffered") {
+        rx.set_signal_db(db);
+        CHECK_FALSE(rx.signals().has_value(0));
+        REQUIRE(tx.send_can(engine_frame()).is_ok());
+        REQUIRE(rx.recv_can(out).is_ok());
+        CHECK(out.can_id == 0x100);
+        CHECK(value_of(*db, rx.signals(), "Temp") == -2);
+    }
+
+    SUBCASE("Decoding stops without a database") {
+        rx.set_signal_db(nullptr);
+        REQUIRE(tx.send_can(engine_frame()).is_ok());
+        REQUIRE(rx.recv_can(out).is_ok());
+        CHECK(rx.signals().size() == 0);
+    }
+}
@@ -0,0 +1,330 @@
+#include <cstdio>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <memory>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    Bytes read_file(const String &path) {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        return Bytes(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t u32_at(const Bytes &data, size_t offset) {
+        uint32_t v;
+        std::memcpy(&v, data.data() + offset, sizeof(v));
+        return v;
+    }
+
+    /// Link types of the interface description blocks, in file order
+    Vector<uint16_t> linktypes(const Bytes &data) {
+        Vector<uint16_t> types;
+        for (size_t off = 0; off + 12 <= data.size(); off += u32_at(data, off + 4)) {
+            if (u32_at(data, off) == PCAPNG_INTERFACE_DESCRIPTION) {
+                types.push_back(static_cast<uint16_t>(u32_at(data, off + 8)));
+            }
+        }
+        return types;
+    }
+
+    Bytes can_payload(uint32_t id, Byte data) {
+        Bytes payload(16, 0);
+        std::memcpy(payload.data(), &id, sizeof(id));
+        payload[4] = 1;
+        payload[8] = data;
+        return payload;
+    }
+} // namespace
+
+TEST_CASE("PcapngWriter and PcapngReader") {
+    const String path = "/tmp/wirebit_test_pcapng.pcapng";
+
+    SUBCASE("Standard blocks for CAN, Ethernet and IP; custom block for serial") {
+        {
+            auto writer = PcapngWriter::create(path, 4096);
+            REQUIRE(writer.is_ok());
+            Frame can = make_frame(FrameType::CAN, can_payload(0x123, 0xAB), 7, 9);
+            can.header.tx_timestamp_ns = 1000;
+            can.header.deliver_at_ns = 1500;
+            can.meta = Bytes{'m', 'e', 't', 'a'};
+            REQUIRE(writer.value().write(make_view(can), 2000, CaptureDirection::Outbound).is_ok());
+            Frame eth = make_frame(FrameType::ETHERNET, Bytes(60, 0x11));
+            REQUIRE(writer.value().write(make_view(eth), 3000, CaptureDirection::Inbound).is_ok());
+            Frame serial = make_frame(FrameType::SERIAL, Bytes{'h', 'i', '\n'});
+            REQUIRE(writer.value().write(make_view(serial), 4000, CaptureDirection::Inbound).is_ok());
+            Frame ip = make_frame(FrameType::IP, Bytes(20, 0x45));
+            REQUIRE(writer.value().write(make_view(ip), 5000, CaptureDirection::Inbound).is_ok());
+            Frame can2 = make_frame(FrameType::CAN, can_payload(0x124, 0xCD));
+            REQUIRE(writer.value().write(make_view(can2), 6000, CaptureDirection::Inbound).is_ok());
+        }
+
+        Bytes data = read_file(path);
+        REQUIRE(data.size() > 28);
+        CHECK(data.size() % 4 == 0);
+        CHECK(u32_at(data, 0) == PCAPNG_SECTION_HEADER);
+        CHECK(u32_at(data, 8) == PCAPNG_BYTE_ORDER_MAGIC);
+        // One interface per link type, written on first use; serial has none
+        CHECK(linktypes(data) ==
+              Vector<uint16_t>{PCAP_LINKTYPE_CAN_SOCKETCAN, PCAP_LINKTYPE_ETHERNET, PCAP_LINKTYPE_RAW});
+        // SocketCAN captures carry the CAN ID big-endian (first EPB follows SHB and IDB)
+        size_t epb = 28 + 32;
+        REQUIRE(u32_at(data, epb) == PCAPNG_ENHANCED_PACKET);
+        CHECK(data[epb + 28] == 0x00);
+        CHECK(data[epb + 30] == 0x01);
+        CHECK(data[epb + 31] == 0x23);
+
+        auto reader = PcapngReader::create(path);
+        REQUIRE(reader.is_ok());
+        PcapngRecord record;
+
+        REQUIRE(reader.value().next(record));
+        CHECK(record.wirebit_header);
+        CHECK(record.capture_ns == 2000);
+        CHECK(record.direction == CaptureDirection::Outbound);
+        CHECK(record.frame.type() == FrameType::CAN);
+        CHECK(record.frame.header.src_endpoint_id == 7);
+        CHECK(record.frame.header.dst_endpoint_id == 9);
+        CHECK(record.frame.header.tx_timestamp_ns == 1000);
+        CHECK(record.frame.header.deliver_at_ns == 1500);
+        CHECK(Bytes(record.frame.payload.begin(), record.frame.payload.end()) == can_payload(0x123, 0xAB));
+        CHECK(Bytes(record.frame.meta.begin(), record.frame.meta.end()) == Bytes{'m', 'e', 't', 'a'});
+
+        REQUIRE(reader.value().next(record));
+        CHECK(record.frame.type() == FrameType::ETHERNET);
+        CHECK(record.frame.payload.size() == 60);
+        CHECK(record.direction == CaptureDirection::Inbound);
+
+        REQUIRE(reader.value().next(record));
+        CHECK(record.frame.type() == FrameType::SERIAL);
+        CHECK(record.capture_ns == 4000);
+        CHECK(Bytes(record.frame.payload.begin(), record.frame.payload.end()) == Bytes{'h', 'i', '\n'});
+
+        REQUIRE(reader.value().next(record));
+        CHECK(record.frame.type() == FrameType::IP);
+
+        REQUIRE(reader.value().next(record));
+        CHECK(Bytes(record.frame.payload.begin(), record.frame.payload.end()) == can_payload(0x124, 0xCD));
+        CHECK_FALSE(reader.value().next(record));
+
+        reader.value().rewind();
+        REQUIRE(reader.value().next(record));
+        CHECK(record.capture_ns == 2000);
+    }
+
+    SUBCASE("Foreign packets get a minimal header, unknown blocks are skipped") {
+        Bytes data(28, 0);
+        std::memcpy(data.data(), &PCAPNG_SECTION_HEADER, 4);
+        data[4] = 28;
+        std::memcpy(data.data() + 8, &PCAPNG_BYTE_ORDER_MAGIC, 4);
+        data[12] = 1;
+        data[24] = 28;
+        // Interface without options: microsecond timestamps
+        Bytes idb{1, 0, 0, 0, 20, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0};
+        // Name resolution block
+        Bytes nrb{4, 0, 0, 0, 16, 0, 0, 0, 0, 0, 0, 0, 16, 0, 0, 0};
+        // EPB at 1234 us with a 4-byte packet and no options
+        Bytes epb{6, 0, 0, 0, 36, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xD2, 0x04, 0, 0,
+                  4, 0, 0, 0, 4, 0, 0, 0, 0xDE, 0xAD, 0xBE, 0xEF, 36, 0, 0, 0};
+        data.insert(data.end(), idb.begin(), idb.end());
+        data.insert(data.end(), nrb.begin(), nrb.end());
+        data.insert(data.end(), epb.begin(), epb.end());
+        data.resize(data.size() + 64, 0); // Unfinished capture: zero tail
+        {
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        }
+
+        auto reader = PcapngReader::create(path);
+        REQUIRE(reader.is_ok());
+        PcapngRecord record;
+        REQUIRE(reader.value().next(record));
+        CHECK_FALSE(record.wirebit_header);
+        CHECK(record.frame.type() == FrameType::ETHERNET);
+        CHECK(record.capture_ns == 1234000);
+        CHECK(record.frame.header.tx_timestamp_ns == 1234000);
+        CHECK(record.frame.payload.size() == 4);
+        CHECK_FALSE(reader.value().next(record));
+        CHECK(reader.value().skipped() == 1);
+    }
+
+    SUBCASE("Rejects files that are not pcapng") {
+        {
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out << "this is not a capture file at all";
+        }
+        auto reader = PcapngReader::create(path);
+        CHECK(reader.is_err());
+        CHECK(PcapngReader::create("/tmp/wirebit_test_no_such_capture.pcapng").is_err());
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("RecordingLink") {
+    const String path = "/tmp/wirebit_test_recording.pcapng";
+    auto server = ShmLink::create("test_capture_link", 64 * 1024);
+    REQUIRE(server.is_ok());
+    auto client = ShmLink::attach("test_capture_link");
+    REQUIRE(client.is_ok());
+    auto inner = std::make_shared<ShmLink>(std::move(server.value()));
+
+    SUBCASE("Records both directions and passes traffic through") {
+        auto link = RecordingLink::create(inner, RecordingConfig{.path = path});
+        REQUIRE(link.is_ok());
+        auto &rec = link.value();
+
+        REQUIRE(rec.send(make_frame(FrameType::CAN, can_payload(0x10, 1))).is_ok());
+        REQUIRE(rec.send_view(make_view(FrameType::SERIAL, Bytes{1, 2, 3})).is_ok());
+        REQUIRE(client.value().send(make_frame(FrameType::ETHERNET, Bytes(64, 0x22))).is_ok());
+        auto received = rec.recv();
+        REQUIRE(received.is_ok());
+        CHECK(received.value().payload.size() == 64);
+        CHECK(client.value().recv().is_ok());
+        CHECK(client.value().recv().is_ok());
+
+        rec.flush();
+        CHECK(rec.stats().frames_recorded == 3);
+        rec.close();
+        CHECK_FALSE(rec.recording());
+        REQUIRE(rec.send(make_frame(FrameType::CAN, can_payload(0x11, 2))).is_ok()); // Not recorded
+        CHECK(rec.stats().frames_recorded == 3);
+        CHECK(rec.stats().bytes_written == read_file(path).size());
+
+        auto reader = PcapngReader::create(path);
+        REQUIRE(reader.is_ok());
+        PcapngRecord record;
+        Vector<FrameType> types;
+        Vector<CaptureDirection> directions;
+        TimeNs last = 0;
+        while (reader.value().next(record)) {
+            types.push_back(record.frame.type());
+            directions.push_back(record.direction);
+            CHECK(record.capture_ns >= last); // Merged in capture order
+            last = record.capture_ns;
+        }
+        CHECK(types == Vector<FrameType>{FrameType::CAN, FrameType::SERIAL, FrameType::ETHERNET});
+        CHECK(directions == Vector<CaptureDirection>{CaptureDirection::Outbound, CaptureDirection::Outbound,
+                                                    CaptureDirection::Inbound});
+    }
+
+    SUBCASE("A full queue drops the recording, not the frame") {
+        RecordingConfig config{.path = path, .queue_bytes = 256, .idle_sleep_ns = 50000000};
+        auto link = RecordingLink::create(inner, config);
+        REQUIRE(link.is_ok());
+        auto &rec = link.value();
+        size_t sent = 0;
+        for (int i = 0; i < 20; ++i) {
+            if (rec.send(make_frame(FrameType::SERIAL, Bytes(40, static_cast<Byte>(i)))).is_ok()) {
+                ++sent;
+            }
+        }
+        CHECK(sent == 20);
+        rec.close();
+        auto stats = rec.stats();
+        CHECK(stats.frames_dropped > 0);
+        CHECK(stats.frames_recorded + stats.frames_dropped == 20);
+    }
+
+    SUBCASE("Direction selection") {
+        RecordingConfig config{.path = path, .record_tx = false};
+        auto link = RecordingLink::create(inner, config);
+        REQUIRE(link.is_ok());
+        REQUIRE(link.value().send(make_frame(FrameType::SERIAL, Bytes{1})).is_ok());
+        link.value().close();
+        CHECK(link.value().stats().frames_recorded == 0);
+    }
+
+    CHECK(RecordingLink::create(nullptr, RecordingConfig{.path = path}).is_err());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ReplayLink") {
+    const String path = "/tmp/wirebit_test_replay.pcapng";
+    {
+        auto writer = PcapngWriter::create(path, 4096).value();
+        const TimeNs base = s_to_ns(1000);
+        for (int i = 0; i < 5; ++i) {
+            Frame frame = make_frame(FrameType::CAN, can_payload(0x200 + i, static_cast<Byte>(i)));
+            frame.header.tx_timestamp_ns = static_cast<uint64_t>(base + ms_to_ns(10) * i);
+            REQUIRE(writer.write(make_view(frame), base + ms_to_ns(10) * i, CaptureDirection::Inbound).is_ok());
+        }
+        Frame sent = make_frame(FrameType::SERIAL, Bytes{'t', 'x'});
+        REQUIRE(writer.write(make_view(sent), base + ms_to_ns(45), CaptureDirection::Outbound).is_ok());
+    }
+
+    SUBCASE("Flat out") {
+        auto link = ReplayLink::create(ReplayConfig{.path = path, .speed = 0.0});
+        REQUIRE(link.is_ok());
+        auto &replay = link.value();
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(replay.can_recv());
+            auto frame = replay.recv();
+            REQUIRE(frame.is_ok());
+            uint32_t id;
+            std::memcpy(&id, frame.value().payload.data(), sizeof(id));
+            CHECK(id == static_cast<uint32_t>(0x200 + i)); // Host order again
+        }
+        CHECK(replay.finished());
+        CHECK(replay.stats().frames_replayed == 5);
+        CHECK(replay.stats().frames_filtered == 1);
+        auto end = replay.recv();
+        REQUIRE(end.is_err());
+        CHECK(end.error().code == Error::timeout("").code);
+
+        REQUIRE(replay.send(make_frame(FrameType::CAN, Bytes(16, 0))).is_ok());
+        CHECK(replay.stats().frames_discarded == 1);
+
+        replay.restart();
+        CHECK(replay.recv().is_ok());
+    }
+
+    SUBCASE("Original and scaled timing under virtual time") {
+        for (double speed : {1.0, 2.0}) {
+            VirtualClock clock(s_to_ns(5));
+            ScopedClock use(clock);
+            auto link = ReplayLink::create(ReplayConfig{.path = path, .speed = speed});
+            REQUIRE(link.is_ok());
+            auto &replay = link.value();
+
+            VirtualTimeLoop loop(clock);
+            Vector<TimeNs> arrivals;
+            Vector<uint64_t> stamps;
+            loop.add_link(replay, [&]() {
+                auto frame = replay.recv_view();
+                if (frame.is_ok()) {
+                    arrivals.push_back(now_ns() - s_to_ns(5));
+                    stamps.push_back(frame.value().header.tx_timestamp_ns);
+                }
+                return frame.is_ok();
+            });
+            loop.run_until_idle();
+
+            REQUIRE(arrivals.size() == 5);
+            for (size_t i = 0; i < arrivals.size(); ++i) {
+                TimeNs expected = static_cast<TimeNs>(static_cast<double>(ms_to_ns(10) * i) / speed);
+                CHECK(arrivals[i] == expected);
+                CHECK(stamps[i] == static_cast<uint64_t>(s_to_ns(5) + expected)); // Restamped
+            }
+        }
+    }
+
+    SUBCASE("Outbound only, original headers, looping") {
+        ReplayConfig config{.path = path, .speed = 0.0, .inbound = false, .outbound = true, .restamp = false,
+                            .loop = true};
+        auto link = ReplayLink::create(config);
+        REQUIRE(link.is_ok());
+        for (int pass = 0; pass < 3; ++pass) {
+            auto frame = link.value().recv();
+            REQUIRE(frame.is_ok());
+            CHECK(frame.value().payload == Bytes{'t', 'x'});
+        }
+        CHECK(link.value().stats().loops == 3); // The look-ahead already started the fourth pass
+        CHECK_FALSE(link.value().finished());
+    }
+
+    CHECK(ReplayLink::create(ReplayConfig{.path = path, .speed = -1.0}).is_err());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,112 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+#include <random>
+
+using namespace wirebit;
+
+namespace {
+    const Byte *check_input() { return reinterpret_cast<const Byte *>("123456789"); }
+} // namespace
+
+TEST_CASE("CRC32 and CRC32C") {
+    SUBCASE("Standard check values") {
+        CHECK(crc32(check_input(), 9) == 0xCBF43926);
+        CHECK(crc32c(check_input(), 9) == 0xE3069283);
+        CHECK(crc32(check_input(), 0) == 0);
+        CHECK(crc32c(check_input(), 0) == 0);
+    }
+
+    SUBCASE("Selected engine matches the tables for every length and alignment") {
+        std::mt19937 rng(7);
+        Bytes data(1100);
+        for (auto &b : data) {
+            b = static_cast<Byte>(rng());
+        }
+
+        for (size_t n = 0; n <= 1024; n += (n < 160 ? 1 : 37)) {
+            for (size_t offset = 0; offset < 4; ++offset) {
+                const Byte *p = data.data() + offset;
+                CHECK(crc32(p, n) == ~detail::crc_slice8(detail::CRC32_TABLES, ~0u, p, n));
+                CHECK(crc32c(p, n) == ~detail::crc_slice8(detail::CRC32C_TABLES, ~0u, p, n));
+            }
+        }
+    }
+
+    SUBCASE("Continuing a CRC equals one pass") {
+        Bytes data(300);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<Byte>(i * 31);
+        }
+        std::span<const Byte> all(data.data(), data.size());
+        for (size_t split : {0, 1, 64, 100, 299, 300}) {
+            CHECK(crc32(all.subspan(split), crc32(all.first(split))) == crc32(all));
+            CHECK(crc32c(all.subspan(split), crc32c(all.first(split))) == crc32c(all));
+        }
+    }
+}
+
+TEST_CASE("CAN CRC-15") {
+    SUBCASE("Check value") {
+        uint16_t crc = 0;
+        for (size_t i = 0; i < 9; ++i) {
+            crc = can_crc15_update(crc, check_input()[i], 8);
+        }
+        CHECK(crc == 0x059E);
+    }
+
+    SUBCASE("Frame CRC matches a bit-by-bit reference") {
+        auto reference = [](const Vector<int> &bits) {
+            uint16_t crc = 0;
+            for (int bit : bits) {
+                crc = can_crc15_update(crc, static_cast<uint64_t>(bit), 1);
+            }
+            return crc;
+        };
+        auto push = [](Vector<int> &bits, uint32_t value, int n) {
+            for (int i = n - 1; i >= 0; --i) {
+                bits.push_back((value >> i) & 1);
+            }
+        };
+
+        can_frame cf{};
+        cf.can_id = 0x123;
+        cf.can_dlc = 3;
+        cf.data[0] = 0xDE;
+        cf.data[1] = 0xAD;
+        cf.data[2] = 0x01;
+
+        Vector<int> bits;
+        push(bits, 0, 1);      // SOF
+        push(bits, 0x123, 11); // ID
+        push(bits, 0, 3);      // RTR, IDE, r0
+        push(bits, 3, 4);      // DLC
+        for (int i = 0; i < 3; ++i) {
+            push(bits, cf.data[i], 8);
+        }
+        uint16_t crc = can_crc15(cf);
+        CHECK(crc == reference(bits));
+        CHECK(can_crc15_update(crc, crc, 15) == 0); // the receiver's remainder over data + CRC
+
+        cf.can_id = 0x18DAF110 | CAN_EFF_FLAG;
+        bits.clear();
+        push(bits, 0, 1);
+        push(bits, 0x18DAF110 >> 18, 11);
+        push(bits, 3, 2); // SRR, IDE
+        push(bits, 0x18DAF110 & 0x3FFFF, 18);
+        push(bits, 0, 3); // RTR, r1, r0
+        push(bits, 3, 4);
+        for (int i = 0; i < 3; ++i) {
+            push(bits, cf.data[i], 8);
+        }
+        CHECK(can_crc15(cf) == reference(bits));
+
+        cf.can_id = 0x123 | CAN_RTR_FLAG; // remote frames carry no data
+        bits.clear();
+        push(bits, 0, 1);
+        push(bits, 0x123, 11);
+        push(bits, 4, 3); // RTR=1, IDE, r0
+        push(bits, 3, 4);
+        CHECK(can_crc15(cf) == reference(bits));
+    }
+}
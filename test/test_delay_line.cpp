@@ -0,0 +1,89 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+TEST_CASE("DelayLine ordering") {
+    SUBCASE("Empty line") {
+        wirebit::DelayLine<int> line;
+        CHECK(line.empty());
+        CHECK(line.size() == 0);
+        CHECK(line.next_deadline() == wirebit::DelayLine<int>::NO_DEADLINE);
+        CHECK_FALSE(line.ready(UINT64_MAX - 1));
+        CHECK(line.pop_ready(1000).is_err());
+    }
+
+    SUBCASE("Items are held until due") {
+        wirebit::DelayLine<int> line;
+        line.push(100, 1);
+        line.push(200, 2);
+
+        CHECK(line.size() == 2);
+        CHECK(line.next_deadline() == 100);
+        CHECK_FALSE(line.ready(99));
+        CHECK(line.pop_ready(99).is_err());
+
+        auto first = line.pop_ready(150);
+        REQUIRE(first.is_ok());
+        CHECK(first.value() == 1);
+        CHECK(line.pop_ready(150).is_err());
+        CHECK(line.next_deadline() == 200);
+
+        auto second = line.pop_ready(200);
+        REQUIRE(second.is_ok());
+        CHECK(second.value() == 2);
+        CHECK(line.empty());
+    }
+
+    SUBCASE("Out-of-order deadlines come out sorted") {
+        wirebit::DelayLine<int> line;
+        line.push(500, 5);
+        line.push(100, 1);
+        line.push(700, 7);
+        line.push(300, 3);
+        line.push(0, 0);
+
+        CHECK(line.next_deadline() == 0);
+
+        wirebit::Vector<int> order;
+        size_t delivered = line.drain_ready(1000, [&](int &&item) { order.push_back(item); });
+        CHECK(delivered == 5);
+        REQUIRE(order.size() == 5);
+        CHECK(order[0] == 0);
+        CHECK(order[1] == 1);
+        CHECK(order[2] == 3);
+        CHECK(order[3] == 5);
+        CHECK(order[4] == 7);
+    }
+
+    SUBCASE("Equal deadlines keep insertion order") {
+        wirebit::DelayLine<int> line;
+        line.push(200, 1);
+        line.push(100, 2);
+        line.push(100, 3);
+        line.push(200, 4);
+
+        wirebit::Vector<int> order;
+        line.drain_ready(200, [&](int &&item) { order.push_back(item); });
+        REQUIRE(order.size() == 4);
+        CHECK(order[0] == 2);
+        CHECK(order[1] == 3);
+        CHECK(order[2] == 1);
+        CHECK(order[3] == 4);
+    }
+
+    SUBCASE("Partial drain leaves later items") {
+        wirebit::DelayLine<wirebit::Frame> line;
+        for (uint64_t i = 0; i < 10; ++i) {
+            wirebit::Bytes payload = {static_cast<wirebit::Byte>(i)};
+            line.push(i * 10, wirebit::make_frame(wirebit::FrameType::SERIAL, payload));
+        }
+
+        size_t delivered = line.drain_ready(45, [](wirebit::Frame &&) {});
+        CHECK(delivered == 5);
+        CHECK(line.size() == 5);
+        CHECK(line.next_deadline() == 50);
+
+        line.clear();
+        CHECK(line.empty());
+        CHECK(line.next_deadline() == wirebit::DelayLine<wirebit::Frame>::NO_DEADLINE);
+    }
+}
@@ -0,0 +1,299 @@
+#include <cstring>
+#include <doctest/doctest.h>
+#include <memory>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    /// One switch port: the switch gets `server`, the node behind the port talks through `client`
+    struct Node {
+        std::shared_ptr<ShmLink> server;
+        std::shared_ptr<ShmLink> client;
+        MacAddr mac;
+    };
+
+    Node make_node(const String &name, uint8_t id) {
+        auto server = ShmLink::create(name, 1 << 18);
+        REQUIRE(server.is_ok());
+        auto client = ShmLink::attach(name);
+        REQUIRE(client.is_ok());
+        return {std::make_shared<ShmLink>(std::move(server.value())),
+                std::make_shared<ShmLink>(std::move(client.value())), MacAddr{0x02, 0, 0, 0, 0, id}};
+    }
+
+    void send_eth(Node &node, const MacAddr &dst, uint8_t tag = 0) {
+        Bytes payload(46, tag);
+        REQUIRE(node.client->send(make_frame(FrameType::ETHERNET, make_eth_frame(dst, node.mac, ETH_P_IP, payload)))
+                    .is_ok());
+    }
+
+    /// Count the frames waiting at a node
+    size_t drain(Node &node) {
+        size_t count = 0;
+        while (node.client->recv_view().is_ok()) {
+            ++count;
+        }
+        return count;
+    }
+} // namespace
+
+TEST_CASE("MacTable learns, moves, ages and removes") {
+    MacTable table(100, 1000);
+    CHECK(table.max_entries() >= 100);
+    MacAddr a = {0x02, 0, 0, 0, 0, 1};
+
+    CHECK(table.lookup(a, 0, 0) == MAC_TABLE_MISS);
+    CHECK(table.learn(a, 0, 3, 0) == MacLearn::Learned);
+    CHECK(table.learn(a, 0, 3, 10) == MacLearn::Refreshed);
+    CHECK(table.learn(a, 0, 5, 20) == MacLearn::Moved);
+    CHECK(table.lookup(a, 0, 20) == 5);
+    CHECK(table.lookup(a, 7, 20) == MAC_TABLE_MISS); // Same MAC, other VLAN
+
+    CHECK(table.lookup(a, 0, 1020) == 5);
+    CHECK(table.lookup(a, 0, 1021) == MAC_TABLE_MISS);
+    CHECK(table.size() == 1);
+    CHECK(table.age(1021) == 1);
+    CHECK(table.size() == 0);
+
+    // Fill to capacity, then remove every other entry: the rest must still be found
+    size_t max = table.max_entries();
+    for (size_t i = 0; i < max; ++i) {
+        MacAddr mac = {0x02, 0, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i), 0x10};
+        CHECK(table.learn(mac, 0, static_cast<uint32_t>(i), 0) == MacLearn::Learned);
+    }
+    CHECK(table.learn(a, 0, 1, 0) == MacLearn::Full);
+    for (size_t i = 0; i < max; i += 2) {
+        MacAddr mac = {0x02, 0, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i), 0x10};
+        CHECK(table.remove(mac, 0));
+    }
+    bool found = true;
+    for (size_t i = 1; i < max; i += 2) {
+        MacAddr mac = {0x02, 0, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i), 0x10};
+        found = found && table.lookup(mac, 0, 0) == i;
+    }
+    CHECK(found);
+    CHECK(table.remove_port(1) == 1);
+    CHECK(table.size() == max / 2 - 1);
+    table.clear();
+    CHECK(table.size() == 0);
+}
+
+TEST_CASE("EthSwitch forwards unicast to the learned port only") {
+    VirtualClock clock;
+    ScopedClock use(clock);
+    Node a = make_node("test_eth_switch_uc_a", 1);
+    Node b = make_node("test_eth_switch_uc_b", 2);
+    Node c = make_node("test_eth_switch_uc_c", 3);
+    auto created = EthSwitch::create({.aging_ns = ms_to_ns(100)});
+    REQUIRE(created.is_ok());
+    auto &sw = created.value();
+    for (Node *node : {&a, &b, &c}) {
+        REQUIRE(sw.add_port(node->server, {.bandwidth_bps = 0}).is_ok());
+    }
+
+    // A's broadcast floods and teaches the switch where A is
+    send_eth(a, MAC_BROADCAST);
+    CHECK(sw.pump() == 2);
+    CHECK(drain(a) == 0);
+    CHECK(drain(b) == 1);
+    CHECK(drain(c) == 1);
+    REQUIRE(sw.learned_port(a.mac).is_ok());
+    CHECK(sw.learned_port(a.mac).value() == 0);
+
+    // B answers A: only A sees it
+    send_eth(b, a.mac);
+    CHECK(sw.pump() == 1);
+    CHECK(drain(a) == 1);
+    CHECK(drain(c) == 0);
+
+    // C's destination is unknown: flooded
+    MacAddr unknown = {0x02, 0, 0, 0, 0, 9};
+    send_eth(c, unknown);
+    CHECK(sw.pump() == 2);
+    CHECK(drain(a) == 1);
+    CHECK(drain(b) == 1);
+
+    // B was learned from its answer
+    send_eth(c, b.mac);
+    CHECK(sw.pump() == 1);
+    CHECK(drain(a) == 0);
+    CHECK(drain(b) == 1);
+
+    auto stats = sw.stats();
+    CHECK(stats.flooded == 2);
+    CHECK(stats.unicast == 2);
+    CHECK(stats.mac_learned == 3);
+    CHECK(sw.port_stats(0).frames_received == 1);
+
+    // Aging: a silent station is forgotten and its frames flood again
+    clock.advance_by(ms_to_ns(150));
+    CHECK(sw.learned_port(a.mac).is_err());
+    sw.pump();
+    CHECK(sw.stats().mac_aged == 3);
+    CHECK(sw.mac_table().size() == 0);
+
+    sw.reset_stats();
+    CHECK(sw.stats().frames_received == 0);
+    CHECK(sw.port_stats(0).frames_received == 0);
+    CHECK(sw.add_port(nullptr).is_err());
+    CHECK(EthSwitch::create({.batch = 0}).is_err());
+}
+
+TEST_CASE("EthSwitch filters frames for a station on the ingress port") {
+    Node a = make_node("test_eth_switch_filter_a", 1);
+    Node b = make_node("test_eth_switch_filter_b", 2);
+    auto created = EthSwitch::create();
+    REQUIRE(created.is_ok());
+    auto &sw = created.value();
+    REQUIRE(sw.add_port(a.server, {.bandwidth_bps = 0}).is_ok());
+    REQUIRE(sw.add_port(b.server, {.bandwidth_bps = 0}).is_ok());
+
+    MacAddr neighbour = {0x02, 0, 0, 0, 0, 7}; // Another station behind port 0
+    Bytes payload(46, 0);
+    REQUIRE(a.client->send(make_frame(FrameType::ETHERNET, make_eth_frame(MAC_BROADCAST, neighbour, ETH_P_IP, payload)))
+                .is_ok());
+    sw.pump();
+    CHECK(drain(b) == 1);
+
+    send_eth(a, neighbour);
+    CHECK(sw.pump() == 0);
+    CHECK(drain(b) == 0);
+    CHECK(sw.stats().filtered == 1);
+
+    REQUIRE(a.client->send(make_frame(FrameType::CAN, Bytes(16, 0))).is_ok());
+    sw.pump();
+    CHECK(sw.port_stats(0).frames_ignored == 1);
+}
+
+TEST_CASE("EthSwitch shapes egress at the port bandwidth") {
+    VirtualClock clock;
+    ScopedClock use(clock);
+    Node a = make_node("test_eth_switch_shape_a", 1);
+    Node b = make_node("test_eth_switch_shape_b", 2);
+    auto created = EthSwitch::create();
+    REQUIRE(created.is_ok());
+    auto &sw = created.value();
+    REQUIRE(sw.add_port(a.server).is_ok());
+    REQUIRE(sw.add_port(b.server, {.bandwidth_bps = 100000000, .queue_frames = 4}).is_ok());
+
+    // Teach the switch where B is, then send A -> B faster than B's line
+    send_eth(b, MAC_BROADCAST);
+    sw.pump();
+    drain(a);
+    for (uint8_t i = 0; i < 6; ++i) {
+        send_eth(a, b.mac, i);
+    }
+    uint64_t start = static_cast<uint64_t>(clock.now());
+    uint64_t frame_time = eth_frame_time_ns(ETH_ZLEN, 100000000);
+    CHECK(frame_time == 6400); // (60 + 20) bytes at 100 Mbps
+
+    CHECK(sw.pump() == 1);
+    CHECK(sw.queued(1) == 3);
+    CHECK(sw.port_stats(1).queue_drops == 2);
+    CHECK(sw.next_deadline() == start + frame_time);
+
+    for (uint64_t n = 1; n <= 4; ++n) {
+        auto frame = b.client->recv_view();
+        REQUIRE(frame.is_ok());
+        CHECK(frame.value().header.deliver_at_ns == start + n * frame_time);
+        CHECK(frame.value().payload[ETH_HLEN] == n - 1);
+        clock.advance_to(static_cast<TimeNs>(sw.next_deadline() == UINT64_MAX ? clock.now() : sw.next_deadline()));
+        sw.pump();
+    }
+    CHECK(sw.queued(1) == 0);
+    CHECK(sw.port_stats(1).frames_sent == 4);
+    CHECK(sw.next_deadline() == UINT64_MAX);
+}
+
+TEST_CASE("EthSwitch separates VLANs") {
+    Node p10 = make_node("test_eth_switch_vlan_a", 1);
+    Node p20 = make_node("test_eth_switch_vlan_b", 2);
+    Node trunk = make_node("test_eth_switch_vlan_t", 3);
+    auto created = EthSwitch::create({.vlans = true});
+    REQUIRE(created.is_ok());
+    auto &sw = created.value();
+    REQUIRE(sw.add_port(p10.server, {.bandwidth_bps = 0, .pvid = 10}).is_ok());
+    REQUIRE(sw.add_port(p20.server, {.bandwidth_bps = 0, .pvid = 20}).is_ok());
+    REQUIRE(sw.add_port(trunk.server, {.bandwidth_bps = 0, .pvid = 0, .tagged_vlans = {10, 20}}).is_ok());
+    CHECK(sw.add_port(p10.server, {.pvid = 4095}).is_err());
+    CHECK(sw.add_port(p10.server, {.pvid = 1, .tagged_vlans = {1}}).is_err());
+
+    // Untagged on VLAN 10: reaches the trunk tagged, never VLAN 20
+    send_eth(p10, MAC_BROADCAST, 0xAB);
+    CHECK(sw.pump() == 1);
+    CHECK(drain(p20) == 0);
+    auto tagged = trunk.client->recv();
+    REQUIRE(tagged.is_ok());
+    EthHeaderView hdr(tagged.value().payload);
+    CHECK(hdr.ethertype() == ETH_P_8021Q);
+    CHECK(tagged.value().payload.size() == ETH_ZLEN + 4);
+    CHECK(((tagged.value().payload[14] << 8 | tagged.value().payload[15]) & 0x0FFF) == 10);
+    CHECK(tagged.value().payload[16] == (ETH_P_IP >> 8));
+    CHECK(tagged.value().payload[18] == 0xAB);
+
+    // Tagged VLAN 20 from the trunk: leaves the VLAN 20 port untagged, learned per VLAN
+    Bytes frame = make_eth_frame(MAC_BROADCAST, trunk.mac, ETH_P_IP, Bytes(46, 0xCD));
+    Bytes tag = {0x81, 0x00, 0x00, 20};
+    frame.insert(frame.begin() + 12, tag.begin(), tag.end());
+    REQUIRE(trunk.client->send(make_frame(FrameType::ETHERNET, frame)).is_ok());
+    CHECK(sw.pump() == 1);
+    CHECK(drain(p10) == 0);
+    auto untagged = p20.client->recv();
+    REQUIRE(untagged.is_ok());
+    CHECK(EthHeaderView(untagged.value().payload).ethertype() == ETH_P_IP);
+    CHECK(untagged.value().payload.size() == ETH_ZLEN);
+    CHECK(untagged.value().payload[14] == 0xCD);
+    CHECK(sw.learned_port(trunk.mac, 20).is_ok());
+    CHECK(sw.learned_port(trunk.mac, 10).is_err());
+
+    // VLAN 30 is not carried by the trunk
+    frame[15] = 30;
+    REQUIRE(trunk.client->send(make_frame(FrameType::ETHERNET, frame)).is_ok());
+    CHECK(sw.pump() == 0);
+    CHECK(sw.port_stats(2).vlan_filtered == 1);
+}
+
+TEST_CASE("EthSwitch on a reactor and on its own thread") {
+    Node a = make_node("test_eth_switch_run_a", 1);
+    Node b = make_node("test_eth_switch_run_b", 2);
+    auto created = EthSwitch::create();
+    REQUIRE(created.is_ok());
+    auto &sw = created.value();
+    REQUIRE(sw.add_port(a.server, {.bandwidth_bps = 0}).is_ok());
+    REQUIRE(sw.add_port(b.server, {.bandwidth_bps = 0}).is_ok());
+
+    SUBCASE("Reactor") {
+        auto reactor = LinkReactor::create();
+        REQUIRE(reactor.is_ok());
+        REQUIRE(sw.attach(reactor.value()).is_ok());
+        CHECK(reactor.value().size() == 2);
+        CHECK(sw.start().is_err());
+        CHECK(sw.add_port(a.server).is_err());
+        for (int i = 0; i < 50; ++i) {
+            send_eth(a, MAC_BROADCAST);
+        }
+        for (int round = 0; round < 10; ++round) {
+            reactor.value().run_once(0);
+        }
+        CHECK(drain(b) == 50);
+        sw.detach();
+        CHECK(reactor.value().size() == 0);
+    }
+
+    SUBCASE("Thread") {
+        REQUIRE(sw.start().is_ok());
+        CHECK(sw.running());
+        for (int i = 0; i < 50; ++i) {
+            send_eth(a, MAC_BROADCAST);
+        }
+        size_t received = 0;
+        uint64_t deadline = static_cast<uint64_t>(wall_ns()) + 2000000000ULL;
+        while (received < 50 && static_cast<uint64_t>(wall_ns()) < deadline) {
+            received += drain(b);
+        }
+        sw.stop();
+        CHECK_FALSE(sw.running());
+        CHECK(received == 50);
+    }
+}
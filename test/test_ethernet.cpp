@@ -85,6 +85,14 @@ TEST_CASE("EthEndpoint basic operations") {
         CHECK(payload.size() == 4);
         CHECK(payload[0] == 0x01);
         CHECK(payload[3] == 0x04);
+
+        // A truncated frame fails and clears the outputs
+        wirebit::Bytes runt(frame.begin(), frame.begin() + 10);
+        CHECK(wirebit::parse_eth_frame(runt, dst_mac, src_mac, ethertype, payload).is_err());
+        CHECK(dst_mac == wirebit::MacAddr{});
+        CHECK(src_mac == wirebit::MacAddr{});
+        CHECK(ethertype == 0);
+        CHECK(payload.empty());
     }
 
     SUBCASE("Send and receive Ethernet frame") {
@@ -317,3 +325,192 @@ TEST_CASE("EthEndpoint basic operations") {
         CHECK(src_mac == mac1);
     }
 }
+
+TEST_CASE("Ethernet header view and MAC accept table") {
+    wirebit::MacAddr mac1 = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    wirebit::MacAddr mac2 = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+    wirebit::MacAddr mac3 = {0x02, 0x00, 0x00, 0x00, 0x00, 0x03};
+    wirebit::MacAddr mcast = {0x01, 0x00, 0x5E, 0x00, 0x00, 0xFB}; // mDNS
+
+    SUBCASE("Header view reads fields in place") {
+        wirebit::Bytes payload = {0xAA, 0xBB, 0xCC};
+        wirebit::Bytes frame = wirebit::make_eth_frame(mcast, mac1, wirebit::ETH_P_IPV6, payload);
+
+        wirebit::EthHeaderView hdr(frame);
+        REQUIRE(hdr.valid());
+        CHECK(hdr.dst_mac() == mcast);
+        CHECK(hdr.src_mac() == mac1);
+        CHECK(hdr.ethertype() == wirebit::ETH_P_IPV6);
+        CHECK(hdr.dst_is_multicast());
+        CHECK(hdr.payload().size() == wirebit::ETH_ZLEN - wirebit::ETH_HLEN);
+        CHECK(hdr.payload().data() == frame.data() + wirebit::ETH_HLEN);
+        CHECK(hdr.payload()[0] == 0xAA);
+
+        CHECK_FALSE(wirebit::EthHeaderView(frame.data(), wirebit::ETH_HLEN - 1).valid());
+        CHECK(wirebit::EthHeaderView(frame.data(), wirebit::ETH_HLEN - 1).payload().empty());
+        CHECK(wirebit::is_multicast_mac(wirebit::MAC_BROADCAST));
+        CHECK_FALSE(wirebit::is_multicast_mac(mac1));
+    }
+
+    SUBCASE("make_eth_frame_into reuses the buffer") {
+        wirebit::Bytes frame;
+        frame.reserve(wirebit::ETH_FRAME_LEN);
+        const wirebit::Byte *storage = frame.data();
+
+        wirebit::Bytes big(1000);
+        wirebit::make_eth_frame_into(frame, mac2, mac1, wirebit::ETH_P_IP,
+                                     std::span<const wirebit::Byte>(big.data(), big.size()));
+        CHECK(frame.size() == wirebit::ETH_HLEN + 1000);
+        CHECK(frame.data() == storage);
+
+        wirebit::Bytes small = {0x01};
+        wirebit::make_eth_frame_into(frame, mac2, mac1, wirebit::ETH_P_ARP,
+                                     std::span<const wirebit::Byte>(small.data(), small.size()));
+        CHECK(frame.size() == wirebit::ETH_ZLEN);
+        CHECK(frame.data() == storage);
+        CHECK(frame[wirebit::ETH_HLEN + 1] == 0x00); // padding cleared
+        CHECK(frame == wirebit::make_eth_frame(mac2, mac1, wirebit::ETH_P_ARP, small));
+    }
+
+    SUBCASE("Accept table drops foreign frames before buffering") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("eth_accept"), 16384);
+        REQUIRE(server_result.is_ok());
+        auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("eth_accept"));
+        REQUIRE(client_result.is_ok());
+        auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+        wirebit::EthConfig config;
+        config.accept_macs.push_back(mac3);
+        wirebit::EthEndpoint tx(server_link, config, 1, mac1);
+        wirebit::EthEndpoint rx(client_link, config, 2, mac2);
+
+        CHECK(rx.accepts_mac(mac2));
+        CHECK(rx.accepts_mac(wirebit::MAC_BROADCAST));
+        CHECK(rx.accepts_mac(mac3));
+        CHECK_FALSE(rx.accepts_mac(mcast));
+        CHECK_FALSE(rx.accepts_mac(mac1));
+
+        wirebit::Bytes payload = {0x01, 0x02};
+        auto send_to = [&](const wirebit::MacAddr &dst) {
+            REQUIRE(tx.send_eth(wirebit::make_eth_frame(dst, mac1, wirebit::ETH_P_IP, payload)).is_ok());
+            return rx.process().is_ok();
+        };
+
+        CHECK(send_to(mac3));        // configured unicast
+        CHECK_FALSE(send_to(mcast)); // multicast not joined
+        rx.add_accept_mac(mcast);
+        CHECK(send_to(mcast)); // joined
+        CHECK(rx.remove_accept_mac(mcast));
+        CHECK_FALSE(send_to(mcast));
+        CHECK_FALSE(rx.remove_accept_mac(mac2)); // own MAC is permanent
+        CHECK_FALSE(rx.remove_accept_mac(wirebit::MAC_BROADCAST));
+
+        CHECK(rx.rx_buffer_size() == 2);
+        CHECK(rx.filtered_count() == 2);
+
+        wirebit::Bytes out;
+        REQUIRE(rx.recv_eth_into(out).is_ok());
+        CHECK(wirebit::EthHeaderView(out).dst_mac() == mac3);
+        REQUIRE(rx.recv_eth_into(out).is_ok());
+        CHECK(wirebit::EthHeaderView(out).dst_mac() == mcast);
+    }
+
+    SUBCASE("FCS is appended on send and checked on receive") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("eth_fcs"), 16384);
+        REQUIRE(server_result.is_ok());
+        auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("eth_fcs"));
+        REQUIRE(client_result.is_ok());
+        auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+        wirebit::EthConfig config;
+        config.calculate_fcs = true;
+        wirebit::EthEndpoint tx(server_link, config, 1, mac1);
+        wirebit::EthEndpoint rx(client_link, config, 2, mac2);
+
+        wirebit::Bytes payload = {0x11, 0x22, 0x33};
+        wirebit::Bytes frame = wirebit::make_eth_frame(mac2, mac1, wirebit::ETH_P_IP, payload);
+        REQUIRE(tx.send_eth(frame).is_ok());
+        REQUIRE(rx.process().is_ok());
+        wirebit::Bytes out;
+        REQUIRE(rx.recv_eth_into(out).is_ok());
+        CHECK(out == frame); // FCS stripped
+
+        // send() builds the frame in the endpoint's own buffer, which the FCS then grows
+        for (size_t size : {3, 46, 1500}) {
+            wirebit::Bytes data(size, 0x5A);
+            REQUIRE(tx.send(data).is_ok());
+            REQUIRE(rx.process().is_ok());
+            REQUIRE(rx.recv_eth_into(out).is_ok());
+            CHECK(out == wirebit::make_eth_frame(wirebit::MAC_BROADCAST, mac1, wirebit::ETH_P_IP, data));
+        }
+
+        // A raw sender that corrupts the frame after its FCS was computed
+        wirebit::Bytes bad = frame;
+        wirebit::append_eth_fcs(bad);
+        CHECK(wirebit::eth_fcs_valid(bad));
+        bad[20] ^= 0x01;
+        CHECK_FALSE(wirebit::eth_fcs_valid(bad));
+        wirebit::EthConfig plain;
+        wirebit::EthEndpoint raw_tx(server_link, plain, 3, mac1);
+        REQUIRE(raw_tx.send_eth(bad).is_ok());
+        CHECK(rx.process().is_err());
+        CHECK(rx.fcs_error_count() == 1);
+        CHECK(rx.rx_buffer_size() == 0);
+    }
+
+    SUBCASE("all_multicast accepts any group address") {
+        auto link_result = wirebit::ShmLink::create(wirebit::String("eth_allmulti"), 4096);
+        REQUIRE(link_result.is_ok());
+        auto link = std::make_shared<wirebit::ShmLink>(std::move(link_result.value()));
+
+        wirebit::EthConfig config;
+        config.all_multicast = true;
+        wirebit::EthEndpoint endpoint(link, config, 1, mac1);
+
+        CHECK(endpoint.accepts_mac(mcast));
+        CHECK_FALSE(endpoint.accepts_mac(mac3));
+    }
+}
+
+TEST_CASE("Vnet header metadata") {
+    wirebit::VnetHeader hdr;
+    hdr.flags = wirebit::VNET_HDR_F_NEEDS_CSUM;
+    hdr.gso_type = wirebit::VNET_HDR_GSO_TCPV4;
+    hdr.hdr_len = 54;
+    hdr.gso_size = 1448;
+    hdr.csum_start = 34;
+    hdr.csum_offset = 16;
+
+    SUBCASE("Round trip through frame metadata") {
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::ETHERNET, wirebit::Bytes(64));
+        frame.set_meta(wirebit::vnet_meta(hdr));
+        CHECK(frame.header.meta_len == wirebit::VNET_HDR_LEN);
+
+        auto decoded = wirebit::vnet_header(std::span<const wirebit::Byte>(frame.meta.data(), frame.meta.size()));
+        REQUIRE(decoded.is_ok());
+        CHECK(decoded.value().gso_type == wirebit::VNET_HDR_GSO_TCPV4);
+        CHECK(decoded.value().gso_size == 1448);
+        CHECK(decoded.value().csum_offset == 16);
+        CHECK(wirebit::vnet_is_gso(decoded.value()));
+    }
+
+    SUBCASE("Frames without metadata get a no-offload header") {
+        auto prefix = wirebit::vnet_prefix({});
+        REQUIRE(prefix.size() == wirebit::VNET_HDR_LEN);
+        for (auto b : prefix) {
+            CHECK(b == 0);
+        }
+        CHECK_FALSE(wirebit::vnet_header({}).is_ok());
+        CHECK_FALSE(wirebit::vnet_is_gso(wirebit::VnetHeader{}));
+    }
+
+    SUBCASE("ECN bit alone is not GSO") {
+        wirebit::VnetHeader ecn;
+        ecn.gso_type = wirebit::VNET_HDR_GSO_ECN;
+        CHECK_FALSE(wirebit::vnet_is_gso(ecn));
+    }
+}
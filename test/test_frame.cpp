@@ -67,6 +67,63 @@ TEST_CASE("Frame creation and serialization") {
 
         CHECK(frame.type() == wirebit::FrameType::ETHERNET);
     }
+
+    SUBCASE("Frame view round trip") {
+        wirebit::Bytes payload = {0x10, 0x20, 0x30};
+        wirebit::Frame original = wirebit::make_frame(wirebit::FrameType::CAN, payload, 5, 6);
+        original.set_meta(wirebit::Bytes{0x7F});
+
+        wirebit::FrameView view = wirebit::make_view(original);
+        CHECK(view.type() == wirebit::FrameType::CAN);
+        CHECK(view.payload.data() == original.payload.data()); // Borrowed, not copied
+        CHECK(view.total_size() == original.total_size());
+
+        wirebit::Frame copy = wirebit::to_frame(view);
+        CHECK(copy.payload == original.payload);
+        CHECK(copy.meta == original.meta);
+        uint32_t meta_len = copy.header.meta_len;
+        CHECK(meta_len == 1);
+        uint32_t dst_id = copy.header.dst_endpoint_id;
+        CHECK(dst_id == 6);
+    }
+}
+
+TEST_CASE("Frame checksum") {
+    wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{1, 2, 3, 4}, 5, 0);
+    frame.set_meta(wirebit::Bytes{0x77});
+
+    wirebit::add_frame_checksum(frame);
+    uint32_t flags = frame.header.flags;
+    CHECK((flags & wirebit::FRAME_FLAG_CHECKSUM) != 0);
+    CHECK(frame.meta.size() == 1 + wirebit::FRAME_CHECKSUM_LEN);
+    wirebit::add_frame_checksum(frame); // idempotent
+    CHECK(frame.meta.size() == 1 + wirebit::FRAME_CHECKSUM_LEN);
+
+    SUBCASE("decode_frame verifies and strips the trailer") {
+        auto decoded = wirebit::decode_frame(wirebit::encode_frame(frame));
+        REQUIRE(decoded.is_ok());
+        CHECK(decoded.value().payload == wirebit::Bytes{1, 2, 3, 4});
+        CHECK(decoded.value().meta == wirebit::Bytes{0x77});
+        uint32_t meta_len = decoded.value().header.meta_len;
+        CHECK(meta_len == 1);
+        uint32_t decoded_flags = decoded.value().header.flags;
+        CHECK(decoded_flags == 0);
+    }
+
+    SUBCASE("decode_frame rejects a corrupted payload") {
+        wirebit::Bytes encoded = wirebit::encode_frame(frame);
+        encoded[sizeof(wirebit::FrameHeader) + 2] ^= 0x10;
+        auto decoded = wirebit::decode_frame(encoded);
+        REQUIRE(decoded.is_err());
+        CHECK(decoded.error().code == wirebit::Error::invalid_argument("").code);
+    }
+
+    SUBCASE("Frames without the flag are not checked") {
+        wirebit::Frame plain = wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{9});
+        wirebit::FrameView view = wirebit::make_view(plain);
+        CHECK(wirebit::verify_frame_checksum(view));
+        CHECK(view.payload.size() == 1);
+    }
 }
 
 TEST_CASE("Time utilities") {
@@ -110,3 +167,74 @@ TEST_CASE("LinkModel") {
         CHECK(delay == 8000000);
     }
 }
+
+TEST_CASE("Frame header v2") {
+    wirebit::Frame frame = wirebit::make_frame_with_timestamps(wirebit::FrameType::CAN, wirebit::Bytes(16, 0xAB),
+                                                               1000000123, 1000500000, 7, 0);
+    frame.set_meta(wirebit::Bytes{1, 2, 3});
+
+    SUBCASE("Round trip keeps every field") {
+        for (uint64_t time_base : {uint64_t(0), uint64_t(1000000000), uint64_t(2000000000)}) {
+            wirebit::Bytes encoded = wirebit::encode_frame(frame, wirebit::FRAME_HEADER_V2, time_base);
+            CHECK(wirebit::validate_frame_header(encoded).is_ok());
+            auto decoded = wirebit::decode_frame(encoded, time_base);
+            REQUIRE(decoded.is_ok());
+            const wirebit::FrameHeader &h = decoded.value().header;
+            uint16_t version = h.version;
+            uint64_t tx = h.tx_timestamp_ns;
+            uint64_t deliver = h.deliver_at_ns;
+            uint32_t src = h.src_endpoint_id;
+            uint32_t dst = h.dst_endpoint_id;
+            CHECK(version == wirebit::FRAME_HEADER_V1); // Decoded headers are always the fixed form
+            CHECK(decoded.value().type() == wirebit::FrameType::CAN);
+            CHECK(tx == 1000000123);
+            CHECK(deliver == 1000500000);
+            CHECK(src == 7);
+            CHECK(dst == 0);
+            CHECK(decoded.value().payload == frame.payload);
+            CHECK(decoded.value().meta == frame.meta);
+        }
+    }
+
+    SUBCASE("Zero fields are omitted") {
+        wirebit::Frame can = wirebit::make_frame_with_timestamps(wirebit::FrameType::CAN, wirebit::Bytes(16, 0),
+                                                                 5000000000, 0, 3, 0);
+        wirebit::Byte head[wirebit::FRAME_HEADER_V2_MAX];
+        // magic, version, presence, type, length, 5-byte timestamp delta, source
+        CHECK(wirebit::encode_frame_header(can.header, 4000000000, head) == 15);
+        CHECK(wirebit::encode_frame(can, wirebit::FRAME_HEADER_V2, 4000000000).size() == 15 + 16);
+
+        wirebit::Frame bare;
+        bare.header.frame_type = static_cast<uint16_t>(wirebit::FrameType::SERIAL);
+        CHECK(wirebit::encode_frame_header(bare.header, 0, head) == wirebit::FRAME_HEADER_V2_MIN);
+    }
+
+    SUBCASE("Checksums work with both versions") {
+        wirebit::add_frame_checksum(frame);
+        auto decoded = wirebit::decode_frame(wirebit::encode_frame(frame, wirebit::FRAME_HEADER_V2));
+        REQUIRE(decoded.is_ok());
+        CHECK(decoded.value().meta == wirebit::Bytes{1, 2, 3});
+
+        wirebit::Bytes corrupted = wirebit::encode_frame(frame, wirebit::FRAME_HEADER_V2);
+        corrupted[corrupted.size() - 10] ^= 0x01;
+        CHECK(wirebit::decode_frame(corrupted).is_err());
+    }
+
+    SUBCASE("Malformed headers are rejected") {
+        wirebit::Bytes encoded = wirebit::encode_frame(frame, wirebit::FRAME_HEADER_V2);
+        auto peeked = wirebit::peek_frame_type(encoded);
+        REQUIRE(peeked.is_ok());
+        CHECK(peeked.value() == wirebit::FrameType::CAN);
+
+        CHECK(wirebit::decode_frame(wirebit::Bytes(encoded.begin(), encoded.begin() + 8)).is_err());
+        CHECK(wirebit::decode_frame(wirebit::Bytes(encoded.begin(), encoded.end() - 1)).is_err());
+
+        wirebit::Bytes bad_version = encoded;
+        bad_version[4] = 3;
+        CHECK(wirebit::validate_frame_header(bad_version).is_err());
+
+        wirebit::Bytes bad_presence = encoded;
+        bad_presence[6] |= 0x80;
+        CHECK(wirebit::decode_frame(bad_presence).is_err());
+    }
+}
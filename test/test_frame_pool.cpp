@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+TEST_CASE("FramePool") {
+    FramePool pool(4);
+
+    SUBCASE("Buffers are sized by class and recycled") {
+        Bytes can = pool.acquire(16);
+        CHECK(can.size() == 16);
+        CHECK(can.capacity() >= 16);
+        Bytes eth = pool.acquire(1514);
+        CHECK(eth.capacity() >= 2048);
+        CHECK(pool.stats().misses == 2);
+
+        const Byte *storage = eth.data();
+        pool.release(eth);
+        CHECK(eth.empty());
+        CHECK(pool.cached(3) == 1);
+
+        Bytes again = pool.acquire(600); // 512 < 600 <= 2048
+        CHECK(again.data() == storage);
+        CHECK(again.size() == 600);
+        CHECK(pool.stats().hits == 1);
+        CHECK(pool.cached(3) == 0);
+    }
+
+    SUBCASE("Oversize and tiny buffers are not cached") {
+        Bytes huge = pool.acquire(64 * 1024);
+        CHECK(huge.size() == 64 * 1024);
+        pool.release(huge);
+        Bytes tiny(3);
+        pool.release(tiny);
+        for (size_t cls = 0; cls < FramePool::SIZE_CLASSES.size(); ++cls) {
+            CHECK(pool.cached(cls) == 0);
+        }
+        CHECK(pool.stats().discarded >= 1);
+    }
+
+    SUBCASE("Free lists are bounded") {
+        Vector<Bytes> buffers;
+        for (int i = 0; i < 6; ++i) {
+            buffers.push_back(pool.acquire(100));
+        }
+        for (Bytes &b : buffers) {
+            pool.release(b);
+        }
+        CHECK(pool.cached(1) == 4);
+        CHECK(pool.stats().recycled == 4);
+        CHECK(pool.stats().discarded == 2);
+        pool.trim();
+        CHECK(pool.cached(1) == 0);
+    }
+
+    SUBCASE("PooledFrame returns its buffers") {
+        Bytes payload = {1, 2, 3, 4, 5, 6, 7, 8};
+        {
+            PooledFrame frame(pool.make_frame(FrameType::CAN, std::span<const Byte>(payload.data(), payload.size()), 1),
+                              pool);
+            CHECK(frame->payload == payload);
+            CHECK(frame->type() == FrameType::CAN);
+            PooledFrame moved(std::move(frame));
+            CHECK(pool.cached(0) == 0);
+        }
+        CHECK(pool.cached(0) == 1);
+
+        PooledFrame kept(pool.make_frame(FrameType::CAN, std::span<const Byte>(payload.data(), payload.size())), pool);
+        Frame owned = kept.take();
+        CHECK(owned.payload == payload);
+        CHECK(pool.cached(0) == 0); // the cached buffer went into the frame and was not returned
+    }
+
+    SUBCASE("PooledFrame from the local pool is released on the destroying thread") {
+        FramePool &local = FramePool::local();
+        local.trim();
+        Bytes payload = {1, 2, 3, 4};
+        PooledFrame frame(local.make_frame(FrameType::CAN, std::span<const Byte>(payload.data(), payload.size())),
+                          local);
+        size_t cached_there = 0;
+        const FramePool *pool_there = nullptr;
+        std::thread worker([&] {
+            FramePool::local().trim();
+            { PooledFrame moved(std::move(frame)); }
+            pool_there = &FramePool::local();
+            cached_there = FramePool::local().cached(0);
+        });
+        worker.join();
+        CHECK(pool_there != &local);
+        CHECK(cached_there == 1);
+        CHECK(local.cached(0) == 0);
+
+        // The one-argument form uses the local pool too
+        { PooledFrame own(local.make_frame(FrameType::CAN, std::span<const Byte>(payload.data(), payload.size()))); }
+        CHECK(local.cached(0) == 1);
+        local.trim();
+    }
+
+    SUBCASE("to_frame copies header, payload and meta") {
+        Frame original = make_frame(FrameType::SERIAL, Bytes{0x41, 0x42}, 7, 9);
+        original.set_meta(Bytes{0x01});
+        Frame copy = pool.to_frame(make_view(original));
+        CHECK(copy.payload == original.payload);
+        CHECK(copy.meta == original.meta);
+        uint32_t src = copy.header.src_endpoint_id;
+        CHECK(src == 7);
+        CHECK(copy.total_size() == original.total_size());
+    }
+}
+
+TEST_CASE("Links fill received frames from a FramePool") {
+    auto server_result = ShmLink::create(String("frame_pool_link"), 16384);
+    REQUIRE(server_result.is_ok());
+    auto server = std::make_shared<ShmLink>(std::move(server_result.value()));
+    auto client_result = ShmLink::attach(String("frame_pool_link"));
+    REQUIRE(client_result.is_ok());
+    auto client = std::make_shared<ShmLink>(std::move(client_result.value()));
+
+    FramePool pool;
+    client->set_frame_pool(&pool);
+    CHECK(client->frame_pool() == &pool);
+
+    SUBCASE("recv() reuses released buffers") {
+        for (int i = 0; i < 50; ++i) {
+            REQUIRE(server->send(make_frame(FrameType::SERIAL, Bytes(100, static_cast<Byte>(i)))).is_ok());
+            auto result = client->recv();
+            REQUIRE(result.is_ok());
+            PooledFrame frame(std::move(result.value()), pool);
+            CHECK(frame->payload.size() == 100);
+            CHECK(frame->payload[0] == static_cast<Byte>(i));
+        }
+        CHECK(pool.stats().misses == 1);
+        CHECK(pool.stats().hits == 49);
+    }
+
+    SUBCASE("CanEndpoint hands batch buffers back") {
+        CanConfig config;
+        CanEndpoint tx(server, config, 1);
+        CanEndpoint rx(client, config, 2);
+
+        uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        for (int round = 0; round < 10; ++round) {
+            for (uint32_t id = 0; id < 5; ++id) {
+                REQUIRE(tx.send_can(CanEndpoint::make_std_frame(0x100 + id, data, 8)).is_ok());
+            }
+            REQUIRE(rx.process().is_ok());
+            can_frame cf;
+            while (rx.recv_can(cf).is_ok()) {
+                CHECK(cf.data[7] == 8);
+            }
+        }
+        CHECK(pool.stats().hits >= 40);
+        CHECK(pool.stats().misses <= 10);
+    }
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+TEST_CASE("Histogram buckets") {
+    // Exact below 64, then 32 buckets per power of two
+    CHECK(Histogram::bucket_index(0) == 0);
+    CHECK(Histogram::bucket_index(63) == 63);
+    CHECK(Histogram::bucket_index(64) == 64);
+    CHECK(Histogram::bucket_index(65) == 64);
+    CHECK(Histogram::bucket_index(66) == 65);
+    CHECK(Histogram::bucket_index(UINT64_MAX) == Histogram::BUCKET_COUNT - 1);
+
+    // Buckets tile the range with no gaps and bounded relative width
+    for (size_t i = 1; i + 1 < Histogram::BUCKET_COUNT; ++i) {
+        CHECK(Histogram::bucket_lowest(i) == Histogram::bucket_highest(i - 1) + 1);
+        uint64_t lo = Histogram::bucket_lowest(i);
+        CHECK(Histogram::bucket_index(lo) == i);
+        CHECK(Histogram::bucket_index(Histogram::bucket_highest(i)) == i);
+        CHECK((Histogram::bucket_highest(i) - lo) * 32 <= lo);
+    }
+}
+
+TEST_CASE("Histogram percentiles") {
+    Histogram h;
+    CHECK(h.count() == 0);
+    CHECK(h.percentile(99) == 0);
+
+    for (uint64_t v = 1; v <= 10000; ++v) {
+        h.record(v * 1000); // 1 us .. 10 ms
+    }
+    CHECK(h.count() == 10000);
+    CHECK(h.min() == 1000);
+    CHECK(h.max() == 10000000);
+    CHECK(std::abs(h.mean() - 5000500.0) < 1.0);
+
+    auto within = [](uint64_t got, double want) { return std::abs(static_cast<double>(got) - want) <= want / 32; };
+    CHECK(within(h.percentile(50), 5000000.0));
+    CHECK(within(h.percentile(99), 9900000.0));
+    CHECK(within(h.percentile(99.9), 9990000.0));
+    CHECK(h.percentile(100) == h.max());
+    CHECK(h.percentile(0) == h.min());
+
+    SUBCASE("Merge adds counts") {
+        Histogram other;
+        other.record(50000000, 10000); // A slow tail twice as large as the body
+        other.merge(h);
+        CHECK(other.count() == 20000);
+        CHECK(other.max() == 50000000);
+        CHECK(within(other.percentile(40), 8000000.0));
+        CHECK(within(other.percentile(99), 50000000.0));
+    }
+
+    SUBCASE("Compact encoding round-trips") {
+        Bytes encoded = h.encode();
+        CHECK(encoded.size() < 2048);
+        auto decoded = Histogram::decode(std::span<const Byte>(encoded.data(), encoded.size()));
+        REQUIRE(decoded.is_ok());
+        CHECK(decoded.value().count() == h.count());
+        CHECK(decoded.value().min() == h.min());
+        CHECK(decoded.value().max() == h.max());
+        CHECK(decoded.value().percentile(99.9) == h.percentile(99.9));
+
+        encoded.pop_back();
+        CHECK_FALSE(Histogram::decode(std::span<const Byte>(encoded.data(), encoded.size())).is_ok());
+    }
+
+    SUBCASE("Reset") {
+        h.reset();
+        CHECK(h.count() == 0);
+        CHECK(h.max() == 0);
+    }
+}
+
+TEST_CASE("Link histograms") {
+    auto server = ShmLink::create("test_hist_shm", 64 * 1024);
+    REQUIRE(server.is_ok());
+    auto client = ShmLink::attach("test_hist_shm");
+    REQUIRE(client.is_ok());
+
+    LinkHistograms tx_hist;
+    LinkHistograms rx_hist;
+    server.value().set_histograms(&tx_hist);
+    client.value().set_histograms(&rx_hist);
+    CHECK(client.value().histograms() == &rx_hist);
+
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(server.value().send(make_frame(FrameType::SERIAL, Bytes(100, 0xAB), 1, 2)).is_ok());
+    }
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(client.value().recv().is_ok());
+    }
+
+    // Sender side: ring fill at each push, growing from empty
+    CHECK(tx_hist.ring_usage_pct.count() == 10);
+    CHECK(tx_hist.ring_usage_pct.min() == 0);
+    CHECK(tx_hist.latency_ns.count() == 0);
+
+    // Receiver side: one latency sample per frame, no model so no modelled delay
+    CHECK(rx_hist.latency_ns.count() == 10);
+    CHECK(rx_hist.latency_ns.max() < static_cast<uint64_t>(s_to_ns(1)));
+    CHECK(rx_hist.model_delay_ns.count() == 0);
+
+    SUBCASE("Endpoint records what it pulls from the link") {
+        LinkHistograms ep_hist;
+        SerialConfig config;
+        SerialEndpoint endpoint(std::make_shared<ShmLink>(std::move(client.value())), config, 2);
+        endpoint.set_histograms(&ep_hist);
+        REQUIRE(server.value().send(make_frame(FrameType::SERIAL, Bytes{1}, 1, 2)).is_ok());
+        endpoint.process();
+        CHECK(ep_hist.latency_ns.count() == 1);
+    }
+}
+
+TEST_CASE("Model delay versus actual delay") {
+    LinkModel model;
+    model.base_latency_ns = ms_to_ns(2);
+    auto server = ShmLink::create("test_hist_model", 64 * 1024, &model);
+    REQUIRE(server.is_ok());
+    auto client = ShmLink::attach("test_hist_model", &model);
+    REQUIRE(client.is_ok());
+
+    LinkHistograms hist;
+    client.value().set_histograms(&hist);
+    REQUIRE(server.value().send(make_frame(FrameType::SERIAL, Bytes{1, 2, 3}, 1, 2)).is_ok());
+
+    for (int i = 0; i < 100 && hist.latency_ns.count() == 0; ++i) {
+        client.value().recv();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(hist.latency_ns.count() == 1);
+    CHECK(hist.model_delay_ns.count() == 1);
+    CHECK(hist.model_delay_ns.min() >= static_cast<uint64_t>(ms_to_ns(2)));
+    CHECK(hist.latency_ns.max() >= hist.model_delay_ns.min());
+    CHECK(hist.lateness_ns.count() == 1);
+}
@@ -0,0 +1,153 @@
+#include <atomic>
+#include <chrono>
+#include <doctest/doctest.h>
+#include <string>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    /// Build a queue set of ShmLink servers and return the matching clients
+    Vector<std::unique_ptr<ShmLink>> make_queues(LinkQueueSet &set, const char *prefix, int n, int cpu = -1) {
+        Vector<std::unique_ptr<ShmLink>> clients;
+        for (int i = 0; i < n; ++i) {
+            String name = String(prefix) + String(std::to_string(i).c_str());
+            auto server = ShmLink::create(name, 4096);
+            REQUIRE(server.is_ok());
+            REQUIRE(set.add(std::make_unique<ShmLink>(std::move(server.value())), cpu).is_ok());
+            auto client = ShmLink::attach(name);
+            REQUIRE(client.is_ok());
+            clients.push_back(std::make_unique<ShmLink>(std::move(client.value())));
+        }
+        return clients;
+    }
+
+} // namespace
+
+TEST_CASE("LinkQueueSet serves each queue on its own worker") {
+    LinkQueueSet set;
+    auto clients = make_queues(set, "qset_workers_", 3);
+    REQUIRE(set.size() == 3);
+
+    std::atomic<int> received[3] = {0, 0, 0};
+    auto started = set.start([&received](Link &link, size_t queue, const std::atomic<bool> &running) {
+        while (running.load()) {
+            if (link.recv().is_ok()) {
+                received[queue]++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    REQUIRE(started.is_ok());
+    REQUIRE(set.running());
+    CHECK(set.stats().workers_started == 3);
+
+    for (size_t q = 0; q < clients.size(); ++q) {
+        for (size_t i = 0; i <= q; ++i) {
+            Bytes payload = {static_cast<Byte>(i)};
+            REQUIRE(clients[q]->send(make_frame(FrameType::ETHERNET, payload)).is_ok());
+        }
+    }
+
+    for (int attempts = 0; attempts < 2000; ++attempts) {
+        if (received[0] == 1 && received[1] == 2 && received[2] == 3) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    set.stop();
+    CHECK_FALSE(set.running());
+    CHECK(received[0] == 1);
+    CHECK(received[1] == 2);
+    CHECK(received[2] == 3);
+}
+
+TEST_CASE("LinkQueueSet CPU affinity") {
+    LinkQueueSet set;
+    auto clients = make_queues(set, "qset_affinity_", 2, 0);
+    CHECK(set.cpu(0) == 0);
+
+    std::atomic<int> on_cpu0{0};
+    auto started = set.start([&on_cpu0](Link &, size_t, const std::atomic<bool> &running) {
+        bool counted = false;
+        while (running.load()) {
+            if (!counted && sched_getcpu() == 0) {
+                on_cpu0++;
+                counted = true;
+            }
+            std::this_thread::yield();
+        }
+    });
+    REQUIRE(started.is_ok());
+    for (int attempts = 0; attempts < 2000 && on_cpu0 < 2; ++attempts) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    set.stop();
+
+    CHECK(set.stats().pinned + set.stats().pin_failures == 2);
+    if (set.stats().pinned == 2) {
+        CHECK(on_cpu0 == 2);
+    }
+}
+
+TEST_CASE("LinkQueueSet flow sharding and misuse") {
+    LinkQueueSet set;
+
+    SUBCASE("Empty set cannot start") {
+        auto result = set.start([](Link &, size_t, const std::atomic<bool> &) {});
+        REQUIRE_FALSE(result.is_ok());
+        CHECK(result.error().code == 1); // invalid_argument error code
+    }
+
+    SUBCASE("Same flow always maps to the same queue") {
+        auto clients = make_queues(set, "qset_shard_", 4);
+        for (uint64_t hash = 0; hash < 16; ++hash) {
+            CHECK(&set.queue_for(hash) == &set.queue(hash % 4));
+        }
+    }
+
+    SUBCASE("Queues cannot be added while running") {
+        auto clients = make_queues(set, "qset_running_", 1);
+        auto started = set.start([](Link &, size_t, const std::atomic<bool> &running) {
+            while (running.load()) {
+                std::this_thread::yield();
+            }
+        });
+        REQUIRE(started.is_ok());
+        auto extra = ShmLink::create(String("qset_running_extra"), 4096);
+        REQUIRE(extra.is_ok());
+        CHECK_FALSE(set.add(std::make_unique<ShmLink>(std::move(extra.value()))).is_ok());
+        CHECK_FALSE(set.start([](Link &, size_t, const std::atomic<bool> &) {}).is_ok());
+        set.stop();
+    }
+
+    SUBCASE("Running workers move with the set") {
+        auto clients = make_queues(set, "qset_move_", 2);
+        std::atomic<int> exited{0};
+        auto started = set.start([&exited](Link &, size_t, const std::atomic<bool> &running) {
+            while (running.load()) {
+                std::this_thread::yield();
+            }
+            exited++;
+        });
+        REQUIRE(started.is_ok());
+
+        LinkQueueSet moved(std::move(set));
+        CHECK(moved.running());
+        CHECK_FALSE(set.running());
+        CHECK(moved.size() == 2);
+
+        LinkQueueSet assigned;
+        assigned = std::move(moved);
+        CHECK(assigned.running());
+        CHECK_FALSE(moved.running());
+        CHECK(exited.load() == 0);
+
+        assigned.stop();
+        CHECK_FALSE(assigned.running());
+        CHECK(exited.load() == 2);
+    }
+}
@@ -0,0 +1,174 @@
+#include <chrono>
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+#ifndef NO_HARDWARE
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+using namespace wirebit;
+
+namespace {
+
+    /// Handler that drains one frame per call and counts it
+    LinkReactor::Handler counting_handler(Link &link, int &count) {
+        return [&link, &count]() {
+            if (!link.recv().is_ok()) {
+                return false;
+            }
+            ++count;
+            return true;
+        };
+    }
+
+    void send_frames(ShmLink &link, int n) {
+        for (int i = 0; i < n; ++i) {
+            Bytes payload = {static_cast<Byte>(i)};
+            REQUIRE(link.send(make_frame(FrameType::SERIAL, payload)).is_ok());
+        }
+    }
+
+} // namespace
+
+TEST_CASE("LinkReactor with polled ShmLink") {
+    auto reactor_result = LinkReactor::create();
+    REQUIRE(reactor_result.is_ok());
+    auto reactor = std::move(reactor_result.value());
+
+    auto server = std::move(ShmLink::create(String("reactor_polled"), 4096).value());
+    auto client = std::move(ShmLink::attach(String("reactor_polled")).value());
+    CHECK(client.poll_fd() == -1);
+
+    int received = 0;
+    REQUIRE(reactor.add(client, counting_handler(client, received)).is_ok());
+    CHECK(reactor.size() == 1);
+    CHECK(reactor.add(client, counting_handler(client, received)).is_err());
+
+    send_frames(server, 3);
+    auto result = reactor.run_once(ms_to_ns(10));
+    REQUIRE(result.is_ok());
+    CHECK(received == 3);
+
+    // Nothing pending: polled links cap the wait at poll_interval_ns
+    uint64_t start = now_ns();
+    REQUIRE(reactor.run_once(s_to_ns(1.0)).is_ok());
+    CHECK(static_cast<uint64_t>(now_ns()) - start < static_cast<uint64_t>(ms_to_ns(500)));
+
+    REQUIRE(reactor.remove(client).is_ok());
+    CHECK(reactor.remove(client).is_err());
+    CHECK(reactor.size() == 0);
+}
+
+TEST_CASE("LinkReactor wakes on ShmLink eventfd") {
+    auto reactor = std::move(LinkReactor::create().value());
+
+    auto server = std::move(ShmLink::create(String("reactor_efd"), 4096).value());
+    auto client = std::move(ShmLink::attach(String("reactor_efd")).value());
+
+    std::thread handshake([&]() { CHECK(server.enable_wakeups().is_ok()); });
+    REQUIRE(client.enable_wakeups().is_ok());
+    handshake.join();
+    CHECK(client.poll_fd() >= 0);
+
+    int received = 0;
+    REQUIRE(reactor.add(client, counting_handler(client, received)).is_ok());
+
+    // First round drains whatever was there at registration (nothing)
+    REQUIRE(reactor.run_once(0).is_ok());
+    CHECK(received == 0);
+
+    std::thread sender([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Bytes payload = {0x11};
+        server.send(make_frame(FrameType::SERIAL, payload));
+    });
+
+    uint64_t start = now_ns();
+    auto result = reactor.run_once(s_to_ns(2.0));
+    uint64_t elapsed = static_cast<uint64_t>(now_ns()) - start;
+    sender.join();
+
+    REQUIRE(result.is_ok());
+    CHECK(received == 1);
+    CHECK(elapsed < static_cast<uint64_t>(s_to_ns(1.0)));
+    CHECK(reactor.stats().wakeups >= 1);
+    CHECK(server.stats().wakeups_sent == 1);
+}
+
+TEST_CASE("LinkReactor fairness budget") {
+    LinkReactorConfig config;
+    config.default_budget = 10;
+    auto reactor = std::move(LinkReactor::create(config).value());
+
+    auto busy_tx = std::move(ShmLink::create(String("reactor_busy"), 16384).value());
+    auto busy_rx = std::move(ShmLink::attach(String("reactor_busy")).value());
+    auto quiet_tx = std::move(ShmLink::create(String("reactor_quiet"), 4096).value());
+    auto quiet_rx = std::move(ShmLink::attach(String("reactor_quiet")).value());
+
+    int busy = 0;
+    int quiet = 0;
+    REQUIRE(reactor.add(busy_rx, counting_handler(busy_rx, busy)).is_ok());
+    REQUIRE(reactor.add(quiet_rx, counting_handler(quiet_rx, quiet)).is_ok());
+
+    send_frames(busy_tx, 25);
+    send_frames(quiet_tx, 1);
+
+    REQUIRE(reactor.run_once(ms_to_ns(10)).is_ok());
+    CHECK(busy == 10);
+    CHECK(quiet == 1);
+    CHECK(reactor.stats().budget_exhausted == 1);
+
+    REQUIRE(reactor.run_once(ms_to_ns(10)).is_ok());
+    REQUIRE(reactor.run_once(ms_to_ns(10)).is_ok());
+    CHECK(busy == 25);
+}
+
+TEST_CASE("LinkReactor drives endpoints") {
+    auto reactor = std::move(LinkReactor::create().value());
+
+    auto server = std::make_shared<ShmLink>(std::move(ShmLink::create(String("reactor_can"), 8192).value()));
+    auto client = std::make_shared<ShmLink>(std::move(ShmLink::attach(String("reactor_can")).value()));
+
+    CanConfig config;
+    CanEndpoint tx(server, config, 1);
+    CanEndpoint rx(client, config, 2);
+    REQUIRE(reactor.add_endpoint(rx).is_ok());
+
+    uint8_t data[2] = {0xDE, 0xAD};
+    REQUIRE(tx.send_can(CanEndpoint::make_std_frame(0x123, data, 2)).is_ok());
+
+    REQUIRE(reactor.run_once(ms_to_ns(10)).is_ok());
+    CHECK(rx.rx_buffer_size() == 1);
+}
+
+#ifndef NO_HARDWARE
+TEST_CASE("LinkReactor with PtyLink") {
+    auto reactor = std::move(LinkReactor::create().value());
+    auto pty = std::move(PtyLink::create().value());
+    CHECK(pty.poll_fd() == pty.master_fd());
+
+    int slave_fd = open(pty.slave_path().c_str(), O_RDWR | O_NONBLOCK);
+    REQUIRE(slave_fd >= 0);
+    struct termios tio; // raw, so ONLCR does not rewrite 0x0A bytes of the frame
+    tcgetattr(slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave_fd, TCSANOW, &tio);
+
+    int received = 0;
+    REQUIRE(reactor.add(pty, counting_handler(pty, received)).is_ok());
+    REQUIRE(reactor.run_once(0).is_ok());
+    CHECK(received == 0);
+
+    Bytes payload = {0xAA, 0xBB};
+    Bytes encoded = encode_frame(make_frame(FrameType::SERIAL, payload, 1, 2));
+    REQUIRE(write(slave_fd, encoded.data(), encoded.size()) == static_cast<ssize_t>(encoded.size()));
+
+    REQUIRE(reactor.run_once(s_to_ns(1.0)).is_ok());
+    CHECK(received == 1);
+
+    close(slave_fd);
+}
+#endif // NO_HARDWARE
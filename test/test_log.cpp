@@ -0,0 +1,48 @@
+// Everything below debug is compiled out in this translation unit, whatever the build's WIREBIT_LOG_LEVEL
+#undef WIREBIT_LOG_LEVEL
+#define WIREBIT_LOG_LEVEL WIREBIT_LOG_LEVEL_INFO
+
+#include <doctest/doctest.h>
+#include <sstream>
+#include <wirebit/wirebit.hpp>
+
+namespace {
+    int evaluations = 0;
+
+    int counted() { return ++evaluations; }
+} // namespace
+
+TEST_CASE("Compile-time log threshold") {
+    SUBCASE("Calls below the threshold do not evaluate their arguments") {
+        evaluations = 0;
+        WIREBIT_TRACE("value=", counted());
+        WIREBIT_DEBUG("value=", counted()).green();
+        CHECK(evaluations == 0);
+        CHECK_FALSE(WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_DEBUG));
+        CHECK(WIREBIT_LOG_ENABLED(WIREBIT_LOG_LEVEL_INFO));
+    }
+
+    SUBCASE("Macros are safe in an unbraced if/else") {
+        bool took_else = false;
+        if (evaluations > 0)
+            WIREBIT_TRACE("unreachable");
+        else
+            took_else = true;
+        CHECK(took_else);
+    }
+}
+
+TEST_CASE("HexFormat") {
+    std::ostringstream os;
+    wirebit::Byte data[] = {0x00, 0x0A, 0xFF};
+    os << wirebit::HexFormat{std::span<const wirebit::Byte>(data, 3)};
+    CHECK(os.str() == "00 0a ff");
+
+    std::ostringstream empty;
+    empty << wirebit::HexFormat{};
+    CHECK(empty.str().empty());
+
+    std::ostringstream mac;
+    mac << wirebit::MacFormat{{0x02, 0x42, 0xAC, 0x11, 0x00, 0x02}};
+    CHECK(mac.str() == "02:42:ac:11:00:02");
+}
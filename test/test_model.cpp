@@ -472,3 +472,158 @@ TEST_CASE("LinkModel realistic scenarios") {
         CHECK(drop == 0.05);
     }
 }
+
+TEST_CASE("DeterministicRNG bounded") {
+    wirebit::DeterministicRNG rng(2024);
+    int buckets[10] = {};
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t val = rng.bounded(10);
+        REQUIRE(val < 10);
+        buckets[val]++;
+    }
+    for (int count : buckets) {
+        CHECK(count > 850);
+        CHECK(count < 1150);
+    }
+    CHECK(rng.bounded(0) == 0);
+    CHECK(rng.bounded(1) == 0);
+    CHECK(rng.bounded(UINT64_MAX) < UINT64_MAX);
+}
+
+TEST_CASE("FrameActionSampler") {
+    SUBCASE("PerFrame reproduces determine_frame_action") {
+        wirebit::LinkModel model(0, 0, 0.3, 0.2, 0.1, 0, 7);
+        wirebit::DeterministicRNG rng1(7);
+        wirebit::DeterministicRNG rng2(7);
+        wirebit::FrameActionSampler sampler;
+        sampler.reset(model, rng1);
+        for (int i = 0; i < 1000; ++i) {
+            CHECK(sampler.next(rng1) == wirebit::determine_frame_action(model, rng2));
+        }
+        CHECK(rng1.state() == rng2.state());
+    }
+
+    SUBCASE("EventSkip follows the model's probabilities") {
+        wirebit::LinkModel model(0, 0, 0.1, 0.05, 0.02, 0, 99);
+        model.sampling = wirebit::ModelSampling::EventSkip;
+        wirebit::DeterministicRNG rng(99);
+        wirebit::FrameActionSampler sampler;
+        sampler.reset(model, rng);
+
+        int counts[4] = {};
+        const int trials = 100000;
+        for (int i = 0; i < trials; ++i) {
+            counts[static_cast<int>(sampler.next(rng))]++;
+        }
+        // Dup is rolled on frames that were not dropped, corrupt on frames neither dropped nor duplicated
+        double drop = static_cast<double>(counts[static_cast<int>(wirebit::FrameAction::DROP)]) / trials;
+        double dup = static_cast<double>(counts[static_cast<int>(wirebit::FrameAction::DUPLICATE)]) / trials;
+        double corrupt = static_cast<double>(counts[static_cast<int>(wirebit::FrameAction::CORRUPT)]) / trials;
+        CHECK(drop > 0.095);
+        CHECK(drop < 0.105);
+        CHECK(dup > 0.9 * 0.05 * 0.93);
+        CHECK(dup < 0.9 * 0.05 * 1.07);
+        CHECK(corrupt > 0.9 * 0.95 * 0.02 * 0.9);
+        CHECK(corrupt < 0.9 * 0.95 * 0.02 * 1.1);
+    }
+
+    SUBCASE("EventSkip takes no draws on clean frames") {
+        wirebit::LinkModel model(0, 0, 1e-9, 0.0, 1e-9, 0, 5);
+        model.sampling = wirebit::ModelSampling::EventSkip;
+        wirebit::DeterministicRNG rng(5);
+        wirebit::FrameActionSampler sampler;
+        sampler.reset(model, rng);
+        uint64_t state = rng.state();
+        for (int i = 0; i < 10000; ++i) {
+            CHECK(sampler.next(rng) == wirebit::FrameAction::DELIVER);
+        }
+        CHECK(rng.state() == state);
+        CHECK(sampler.frames_until_event() > 1000);
+
+        wirebit::LinkModel always(0, 0, 1.0, 0.0, 0.0, 0, 5);
+        always.sampling = wirebit::ModelSampling::EventSkip;
+        sampler.reset(always, rng);
+        for (int i = 0; i < 10; ++i) {
+            CHECK(sampler.next(rng) == wirebit::FrameAction::DROP);
+        }
+    }
+
+    SUBCASE("Batches match single draws and the same seed") {
+        for (wirebit::ModelSampling sampling : {wirebit::ModelSampling::PerFrame, wirebit::ModelSampling::EventSkip}) {
+            wirebit::LinkModel model(0, 0, 0.01, 0.005, 0.002, 0, 31);
+            model.sampling = sampling;
+            wirebit::DeterministicRNG rng1(31);
+            wirebit::DeterministicRNG rng2(31);
+            wirebit::FrameActionSampler single;
+            wirebit::FrameActionSampler batched;
+            single.reset(model, rng1);
+            batched.reset(model, rng2);
+
+            wirebit::Vector<wirebit::FrameAction> actions(5000);
+            size_t events = batched.next_batch(rng2, std::span<wirebit::FrameAction>(actions));
+            size_t expected_events = 0;
+            bool same = true;
+            for (wirebit::FrameAction action : actions) {
+                wirebit::FrameAction expected = single.next(rng1);
+                same = same && action == expected;
+                expected_events += expected != wirebit::FrameAction::DELIVER ? 1 : 0;
+            }
+            CHECK(same);
+            CHECK(events == expected_events);
+            CHECK(events > 50);
+            CHECK(rng1.state() == rng2.state());
+        }
+    }
+}
+
+TEST_CASE("EventSkip jitter and corruption") {
+    wirebit::LinkModel model(1000, 500, 0.0, 0.0, 0.0, 0, 42);
+    model.sampling = wirebit::ModelSampling::EventSkip;
+    wirebit::DeterministicRNG rng1(42);
+    wirebit::DeterministicRNG rng2(42);
+    uint64_t next_send1 = 0;
+    uint64_t next_send2 = 0;
+    bool varies = false;
+    for (int i = 0; i < 100; ++i) {
+        uint64_t deliver1 = wirebit::compute_deliver_at_ns(model, 0, 100, next_send1, rng1);
+        uint64_t deliver2 = wirebit::compute_deliver_at_ns(model, 0, 100, next_send2, rng2);
+        CHECK(deliver1 == deliver2);
+        CHECK(deliver1 >= 1000);
+        CHECK(deliver1 < 1500);
+        varies = varies || deliver1 != 1000;
+    }
+    CHECK(varies);
+
+    wirebit::Bytes original = {0x00, 0x11, 0x22, 0x33};
+    int changed = 0;
+    for (int trial = 0; trial < 50; ++trial) {
+        wirebit::Bytes payload = original;
+        wirebit::corrupt_payload(payload, rng1, wirebit::ModelSampling::EventSkip);
+        int flipped = 0;
+        for (size_t i = 0; i < payload.size(); ++i) {
+            flipped += __builtin_popcount(payload[i] ^ original[i]);
+        }
+        CHECK(flipped <= 3); // The same bit may be drawn twice
+        changed += flipped > 0 ? 1 : 0;
+    }
+    CHECK(changed > 40);
+}
+
+TEST_CASE("ShmLink with an EventSkip model") {
+    wirebit::LinkModel model(0, 0, 0.2, 0.0, 0.0, 0, 11);
+    model.sampling = wirebit::ModelSampling::EventSkip;
+    auto created = wirebit::ShmLink::create_pair("event_skip", 64 << 10, &model, &model);
+    REQUIRE(created.is_ok());
+    auto links = std::move(created.value());
+    for (uint8_t i = 0; i < 200; ++i) {
+        REQUIRE(links.first.send(wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{i})).is_ok());
+    }
+    uint64_t dropped = links.first.stats().frames_dropped;
+    CHECK(dropped > 20);
+    CHECK(dropped < 60);
+    uint64_t received = 0;
+    while (links.second.recv().is_ok()) {
+        received++;
+    }
+    CHECK(received == 200 - dropped);
+}
@@ -0,0 +1,136 @@
+#include <atomic>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <memory>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    constexpr int PRODUCERS = 8;
+    constexpr uint32_t FRAMES_PER_PRODUCER = 2000;
+
+    /// Run PRODUCERS threads through one MpscSendLink while the peer receives, and check per-producer order
+    void check_ordered_fan_in(const char *name, MpscDrain drain) {
+        auto server = ShmLink::create(name, 1 << 20);
+        REQUIRE(server.is_ok());
+        auto client = ShmLink::attach(name);
+        REQUIRE(client.is_ok());
+        auto inner = std::make_shared<ShmLink>(std::move(server.value()));
+        auto link = MpscSendLink::create(inner, {.queue_frames = 256, .drain = drain});
+        REQUIRE(link.is_ok());
+        auto &mpsc = link.value();
+
+        std::atomic<uint64_t> rejected{0};
+        Vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.push_back(std::thread([&mpsc, &rejected, p]() {
+                Bytes payload(8, 0);
+                for (uint32_t seq = 0; seq < FRAMES_PER_PRODUCER;) {
+                    std::memcpy(payload.data(), &seq, sizeof(seq));
+                    payload[4] = static_cast<Byte>(p);
+                    if (mpsc.send_view(make_view(FrameType::CAN, payload)).is_ok()) {
+                        ++seq;
+                    } else {
+                        rejected.fetch_add(1);
+                        std::this_thread::yield();
+                    }
+                }
+            }));
+        }
+
+        uint32_t next[PRODUCERS] = {};
+        size_t received = 0;
+        bool ordered = true;
+        while (received < PRODUCERS * FRAMES_PER_PRODUCER) {
+            auto frame = client.value().recv_view();
+            if (!frame.is_ok()) {
+                if (drain == MpscDrain::Manual) {
+                    mpsc.flush();
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t seq;
+            std::memcpy(&seq, frame.value().payload.data(), sizeof(seq));
+            int p = frame.value().payload[4];
+            ordered = ordered && seq == next[p];
+            next[p] = seq + 1;
+            ++received;
+        }
+        for (auto &thread : producers) {
+            thread.join();
+        }
+
+        CHECK(ordered);
+        CHECK(received == PRODUCERS * FRAMES_PER_PRODUCER);
+        for (int p = 0; p < PRODUCERS; ++p) {
+            CHECK(next[p] == FRAMES_PER_PRODUCER);
+        }
+        auto stats = mpsc.stats();
+        CHECK(stats.frames_sent == PRODUCERS * FRAMES_PER_PRODUCER);
+        CHECK(stats.queue_full == rejected.load());
+        CHECK(mpsc.pending() == 0);
+        CHECK(inner->stats().frames_sent == PRODUCERS * FRAMES_PER_PRODUCER);
+    }
+} // namespace
+
+TEST_CASE("MpscSendLink keeps per-producer order") {
+    SUBCASE("Combining") { check_ordered_fan_in("test_mpsc_combining", MpscDrain::Combining); }
+    SUBCASE("Flusher thread") { check_ordered_fan_in("test_mpsc_flusher", MpscDrain::Flusher); }
+    SUBCASE("Manual flush") { check_ordered_fan_in("test_mpsc_manual", MpscDrain::Manual); }
+}
+
+TEST_CASE("MpscSendLink backpressure") {
+    auto server = ShmLink::create("test_mpsc_backpressure", 4096);
+    REQUIRE(server.is_ok());
+    auto client = ShmLink::attach("test_mpsc_backpressure");
+    REQUIRE(client.is_ok());
+    auto inner = std::make_shared<ShmLink>(std::move(server.value()));
+    auto link = MpscSendLink::create(inner, {.queue_frames = 8});
+    REQUIRE(link.is_ok());
+    auto &mpsc = link.value();
+
+    // The inner ring fills first; refused frames stay queued in order, then the queue itself fills
+    size_t accepted = 0;
+    for (uint32_t i = 0; i < 60; ++i) {
+        Bytes payload(64, 0);
+        std::memcpy(payload.data(), &i, sizeof(i));
+        if (mpsc.send(make_frame(FrameType::ETHERNET, payload)).is_ok()) {
+            ++accepted;
+        }
+    }
+    CHECK(accepted < 60);
+    CHECK(mpsc.pending() == 8);
+    CHECK_FALSE(mpsc.can_send());
+    auto stats = mpsc.stats();
+    CHECK(stats.backpressure > 0);
+    CHECK(stats.queue_full == 60 - accepted);
+    CHECK(stats.frames_sent + mpsc.pending() == accepted);
+
+    // Draining the peer lets the queued frames through, still in order
+    uint32_t expected = 0;
+    bool ordered = true;
+    for (int round = 0; round < 10 && expected < accepted; ++round) {
+        while (true) {
+            auto frame = client.value().recv();
+            if (!frame.is_ok()) {
+                break;
+            }
+            uint32_t seq;
+            std::memcpy(&seq, frame.value().payload.data(), sizeof(seq));
+            ordered = ordered && seq == expected;
+            ++expected;
+        }
+        mpsc.flush();
+    }
+    CHECK(ordered);
+    CHECK(expected == accepted);
+    CHECK(mpsc.pending() == 0);
+
+    mpsc.reset_stats();
+    CHECK(mpsc.stats().frames_sent == 0);
+    CHECK(MpscSendLink::create(nullptr).is_err());
+    CHECK(MpscSendLink::create(inner, {.queue_frames = 0}).is_err());
+}
@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+
+#ifndef NO_HARDWARE
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    /// Non-blocking pipe shrunk to one page so it fills quickly
+    struct SmallPipe {
+        int fds[2] = {-1, -1};
+
+        SmallPipe() {
+            REQUIRE(pipe2(fds, O_NONBLOCK) == 0);
+            fcntl(fds[1], F_SETPIPE_SZ, 4096);
+        }
+        ~SmallPipe() {
+            close(fds[0]);
+            close(fds[1]);
+        }
+
+        Bytes drain() {
+            Bytes out;
+            Byte buf[4096];
+            ssize_t n;
+            while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+                out.insert(out.end(), buf, buf + n);
+            }
+            return out;
+        }
+    };
+
+    Bytes pattern(size_t n, Byte seed) {
+        Bytes data;
+        for (size_t i = 0; i < n; ++i) {
+            data.push_back(static_cast<Byte>(seed + i));
+        }
+        return data;
+    }
+} // namespace
+
+TEST_CASE("PendingOutput") {
+    SmallPipe pipe;
+    int capacity = fcntl(pipe.fds[1], F_GETPIPE_SZ);
+    REQUIRE(capacity > 0);
+
+    SUBCASE("Gathers iovecs in one write") {
+        PendingOutput out(65536);
+        Bytes a = {0x01, 0x02};
+        Bytes b = {0x03, 0x04, 0x05};
+        struct iovec iov[2] = {{a.data(), a.size()}, {b.data(), b.size()}};
+        auto result = out.write(pipe.fds[1], iov, 2);
+        REQUIRE(result.is_ok());
+        CHECK(result.value() == 5);
+        CHECK(out.empty());
+        CHECK(pipe.drain() == Bytes{0x01, 0x02, 0x03, 0x04, 0x05});
+    }
+
+    SUBCASE("Queues what the fd does not take and keeps the order") {
+        PendingOutput out(65536);
+        Bytes first = pattern(static_cast<size_t>(capacity) + 1000, 0);
+        Bytes second = pattern(500, 7);
+
+        struct iovec iov1 = {first.data(), first.size()};
+        auto r1 = out.write(pipe.fds[1], &iov1, 1);
+        REQUIRE(r1.is_ok());
+        CHECK(r1.value() < first.size());
+        CHECK(out.size() == first.size() - r1.value());
+
+        // Pipe still full: the second record is queued behind the first
+        struct iovec iov2 = {second.data(), second.size()};
+        auto r2 = out.write(pipe.fds[1], &iov2, 1);
+        REQUIRE(r2.is_ok());
+        CHECK(r2.value() == 0);
+
+        Bytes received;
+        while (!out.empty()) {
+            Bytes chunk = pipe.drain();
+            received.insert(received.end(), chunk.begin(), chunk.end());
+            REQUIRE(out.flush(pipe.fds[1]).is_ok());
+        }
+        Bytes tail = pipe.drain();
+        received.insert(received.end(), tail.begin(), tail.end());
+
+        Bytes expected = first;
+        expected.insert(expected.end(), second.begin(), second.end());
+        CHECK(received == expected);
+        CHECK(out.bytes_written() == expected.size());
+    }
+
+    SUBCASE("Rejects whole records once the queue is full") {
+        PendingOutput out(1024);
+        Bytes fill = pattern(static_cast<size_t>(capacity) + 1000, 0);
+        struct iovec iov = {fill.data(), fill.size()};
+        REQUIRE(out.write(pipe.fds[1], &iov, 1).is_ok());
+        size_t queued = out.size();
+        CHECK(queued == 1000); // remainder of a started record is always kept
+
+        Bytes extra = pattern(100, 1);
+        struct iovec iov2 = {extra.data(), extra.size()};
+        auto rejected = out.write(pipe.fds[1], &iov2, 1);
+        REQUIRE(rejected.is_err());
+        CHECK(rejected.error().code == 6); // Timeout error code
+        CHECK(out.size() == queued);
+    }
+
+    SUBCASE("Discard keeps the tail of a started record") {
+        PendingOutput out(65536);
+        Bytes first = pattern(static_cast<size_t>(capacity) + 1000, 0);
+        Bytes second = pattern(500, 7);
+        struct iovec iov1 = {first.data(), first.size()};
+        struct iovec iov2 = {second.data(), second.size()};
+        REQUIRE(out.write(pipe.fds[1], &iov1, 1).is_ok());
+        REQUIRE(out.write(pipe.fds[1], &iov2, 1).is_ok());
+        CHECK(out.size() == 1500);
+
+        CHECK(out.discard() == 500); // Only the record that has not started
+        CHECK(out.size() == 1000);
+        CHECK(out.discard() == 0);
+
+        Bytes received = pipe.drain();
+        REQUIRE(out.flush(pipe.fds[1]).is_ok());
+        CHECK(out.empty());
+        Bytes tail = pipe.drain();
+        received.insert(received.end(), tail.begin(), tail.end());
+        CHECK(received == first);
+
+        // With nothing of it written, a whole queued record is dropped
+        Bytes fill = pattern(static_cast<size_t>(capacity), 0);
+        struct iovec iov3 = {fill.data(), fill.size()};
+        REQUIRE(out.write(pipe.fds[1], &iov3, 1).is_ok());
+        REQUIRE(out.empty());
+        REQUIRE(out.write(pipe.fds[1], &iov2, 1).is_ok());
+        CHECK(out.size() == 500);
+        CHECK(out.discard() == 500);
+        CHECK(out.empty());
+    }
+
+    SUBCASE("Flush waits for the fd to become writable") {
+        PendingOutput out(65536);
+        Bytes data = pattern(static_cast<size_t>(capacity) + 100, 0);
+        struct iovec iov = {data.data(), data.size()};
+        REQUIRE(out.write(pipe.fds[1], &iov, 1).is_ok());
+        REQUIRE(!out.empty());
+
+        CHECK(out.flush(pipe.fds[1], ms_to_ns(5)).value() == 0); // nobody reads
+        CHECK(pipe.drain().size() == static_cast<size_t>(capacity));
+        CHECK(out.flush(pipe.fds[1], ms_to_ns(5)).value() == 100);
+        CHECK(out.empty());
+    }
+}
+
+#endif // NO_HARDWARE
@@ -4,12 +4,26 @@
 
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <termios.h>
 #include <thread>
 #include <unistd.h>
 #include <wirebit/wirebit.hpp>
 
 using namespace wirebit;
 
+/// Open the slave side in raw mode so the line discipline passes frame bytes through untouched
+/// (by default ONLCR turns any 0x0A in a header or timestamp into 0x0D 0x0A)
+static int open_raw_slave(const PtyLink &pty) {
+    int fd = open(pty.slave_path().c_str(), O_RDWR | O_NONBLOCK);
+    if (fd >= 0) {
+        struct termios tio;
+        tcgetattr(fd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
 TEST_CASE("PtyLink creation") {
     auto result = PtyLink::create();
     REQUIRE(result.is_ok());
@@ -67,7 +81,7 @@ TEST_CASE("PtyLink receive from slave") {
     auto &pty = result.value();
 
     // Open slave side to write data
-    int slave_fd = open(pty.slave_path().c_str(), O_RDWR | O_NONBLOCK);
+    int slave_fd = open_raw_slave(pty);
     REQUIRE(slave_fd >= 0);
 
     // Create a test frame
@@ -141,7 +155,7 @@ TEST_CASE("PtyLink partial frame handling") {
 
     auto &pty = result.value();
 
-    int slave_fd = open(pty.slave_path().c_str(), O_RDWR | O_NONBLOCK);
+    int slave_fd = open_raw_slave(pty);
     REQUIRE(slave_fd >= 0);
 
     // Create a frame and send it in two parts
@@ -180,6 +194,97 @@ TEST_CASE("PtyLink partial frame handling") {
     close(slave_fd);
 }
 
+TEST_CASE("PtyLink recv_view") {
+    auto result = PtyLink::create();
+    REQUIRE(result.is_ok());
+
+    auto &pty = result.value();
+
+    int slave_fd = open_raw_slave(pty);
+    REQUIRE(slave_fd >= 0);
+
+    // Two frames written back-to-back are handed out one view at a time
+    Bytes encoded;
+    for (Byte i = 1; i <= 2; ++i) {
+        Bytes e = encode_frame(make_frame(FrameType::SERIAL, Bytes{i, i, i}, i, 0));
+        encoded.insert(encoded.end(), e.begin(), e.end());
+    }
+    ssize_t w = write(slave_fd, encoded.data(), encoded.size());
+    (void)w; // Suppress unused result warning
+    usleep(5000);
+
+    auto first = pty.recv_view();
+    REQUIRE(first.is_ok());
+    CHECK(first.value().payload.size() == 3);
+    CHECK(first.value().payload[0] == 1);
+
+    auto second = pty.recv_view();
+    REQUIRE(second.is_ok());
+    CHECK(second.value().payload[0] == 2);
+    uint32_t src = second.value().header.src_endpoint_id;
+    CHECK(src == 2);
+
+    CHECK(pty.recv_view().is_err());
+    CHECK(pty.rx_buffer_size() == 0);
+    CHECK(pty.stats().frames_received == 2);
+
+    close(slave_fd);
+}
+
+TEST_CASE("PtyLink queues output the slave has not read yet") {
+    PtyConfig config;
+    config.auto_flush_on_block = false;
+    config.max_pending_bytes = 1 << 20;
+    auto result = PtyLink::create(config);
+    REQUIRE(result.is_ok());
+
+    auto &pty = result.value();
+
+    int slave_fd = open_raw_slave(pty);
+    REQUIRE(slave_fd >= 0);
+
+    // Far more than the PTY buffers: every send is accepted, the overflow waits in the queue
+    constexpr int frames = 200;
+    for (int i = 0; i < frames; ++i) {
+        Bytes payload(1000);
+        for (size_t j = 0; j < payload.size(); ++j) {
+            payload[j] = static_cast<Byte>(i + j);
+        }
+        REQUIRE(pty.send(make_frame(FrameType::SERIAL, payload, static_cast<uint32_t>(i), 0)).is_ok());
+    }
+    CHECK(pty.has_pending_output());
+    CHECK(pty.stats().frames_sent == frames);
+    CHECK(pty.stats().bytes_queued > 0);
+
+    // Read the slave side while flushing; the stream must decode frame by frame, in order
+    Bytes stream;
+    Byte buf[4096];
+    for (int round = 0; round < 10000 && (pty.has_pending_output() || stream.empty()); ++round) {
+        ssize_t n = read(slave_fd, buf, sizeof(buf));
+        if (n > 0) {
+            stream.insert(stream.end(), buf, buf + n);
+        }
+        REQUIRE(pty.flush_pending().is_ok());
+    }
+    usleep(5000);
+    ssize_t n;
+    while ((n = read(slave_fd, buf, sizeof(buf))) > 0) {
+        stream.insert(stream.end(), buf, buf + n);
+    }
+
+    size_t frame_size = sizeof(FrameHeader) + 1000;
+    REQUIRE(stream.size() == frames * frame_size);
+    for (int i = 0; i < frames; ++i) {
+        auto decoded = decode_frame(Bytes(stream.data() + i * frame_size, stream.data() + (i + 1) * frame_size));
+        REQUIRE(decoded.is_ok());
+        CHECK(decoded.value().header.src_endpoint_id == static_cast<uint32_t>(i));
+        CHECK(decoded.value().payload[0] == static_cast<Byte>(i));
+    }
+    CHECK(pty.stats().bytes_sent == frames * frame_size);
+
+    close(slave_fd);
+}
+
 #else // NO_HARDWARE
 
 TEST_CASE("PtyLink requires hardware support") {
@@ -224,4 +224,360 @@ TEST_CASE("FrameRing stress test") {
 
         CHECK(ring.empty());
     }
+
+    SUBCASE("Records wrapping around the ring end") {
+        auto ring_result = wirebit::FrameRing::create(1000); // Deliberately not a multiple of record size
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        for (int i = 0; i < 200; ++i) {
+            wirebit::Bytes payload(37 + (i % 50), static_cast<wirebit::Byte>(i));
+            wirebit::Frame frame = wirebit::make_frame_with_timestamps(wirebit::FrameType::SERIAL, payload, i, 0, i, 0);
+            REQUIRE(ring.push_frame(frame).is_ok());
+
+            auto result = ring.pop_frame();
+            REQUIRE(result.is_ok());
+            auto popped = std::move(result.value());
+            CHECK(popped.payload.size() == payload.size());
+            CHECK(popped.payload.front() == static_cast<wirebit::Byte>(i));
+            CHECK(popped.payload.back() == static_cast<wirebit::Byte>(i));
+            uint32_t src = popped.header.src_endpoint_id;
+            CHECK(src == static_cast<uint32_t>(i));
+        }
+
+        CHECK(ring.empty());
+    }
+}
+
+TEST_CASE("FrameRing shared memory visibility") {
+    SUBCASE("Frames pushed by creator are visible to attacher") {
+        wirebit::String shm_name = "/wirebit_test_ring_attach";
+        auto creator_result = wirebit::FrameRing::create_shm(shm_name, 4096);
+        REQUIRE(creator_result.is_ok());
+        auto creator = std::move(creator_result.value());
+
+        auto attacher_result = wirebit::FrameRing::attach_shm(shm_name);
+        REQUIRE(attacher_result.is_ok());
+        auto attacher = std::move(attacher_result.value());
+        CHECK(attacher.capacity() == 4096);
+
+        wirebit::Bytes payload(1500, 0x5A);
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::ETHERNET, payload);
+        REQUIRE(creator.push_frame(frame).is_ok());
+        CHECK(attacher.size() == creator.size());
+
+        auto result = attacher.pop_frame();
+        REQUIRE(result.is_ok());
+        CHECK(result.value().payload.size() == 1500);
+        CHECK(creator.empty());
+    }
+}
+
+TEST_CASE("FrameRing zero-copy API") {
+    SUBCASE("Reserve and commit in place") {
+        auto ring_result = wirebit::FrameRing::create(4096);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        wirebit::Bytes payload = {0x11, 0x22, 0x33};
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::CAN, payload, 7, 8);
+        size_t frame_size = sizeof(wirebit::FrameHeader) + payload.size();
+
+        auto slot = ring.reserve(frame_size);
+        REQUIRE(slot.is_ok());
+        CHECK(slot.value().size() == frame_size);
+        std::memcpy(slot.value().data(), &frame.header, sizeof(wirebit::FrameHeader));
+        std::memcpy(slot.value().data() + sizeof(wirebit::FrameHeader), payload.data(), payload.size());
+
+        // Nothing is visible until commit
+        CHECK(ring.empty());
+        REQUIRE(ring.commit().is_ok());
+        CHECK_FALSE(ring.empty());
+        CHECK(ring.commit().is_err());
+
+        auto popped = ring.pop_frame();
+        REQUIRE(popped.is_ok());
+        CHECK(popped.value().payload.size() == 3);
+        CHECK(popped.value().payload[2] == 0x33);
+    }
+
+    SUBCASE("Peek does not consume") {
+        auto ring_result = wirebit::FrameRing::create(4096);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        wirebit::Bytes payload(64, 0x42);
+        wirebit::Bytes meta = {0x01, 0x02};
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::ETHERNET, payload, 1, 2);
+        frame.meta = meta;
+        frame.header.meta_len = static_cast<uint32_t>(meta.size());
+        REQUIRE(ring.push_frame(frame).is_ok());
+
+        auto first = ring.peek();
+        REQUIRE(first.is_ok());
+        auto second = ring.peek();
+        REQUIRE(second.is_ok());
+        CHECK(first.value().payload.data() == second.value().payload.data());
+        CHECK(second.value().type() == wirebit::FrameType::ETHERNET);
+        CHECK(second.value().payload.size() == 64);
+        CHECK(second.value().meta.size() == 2);
+        CHECK(second.value().meta[1] == 0x02);
+
+        ring.consume();
+        CHECK(ring.empty());
+        CHECK(ring.peek().is_err());
+    }
+
+    SUBCASE("Capacity is rounded to record alignment") {
+        auto ring_result = wirebit::FrameRing::create(1001);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+        CHECK(ring.capacity() == 1008);
+
+        // Wrap repeatedly with peek/consume
+        for (int i = 0; i < 100; ++i) {
+            wirebit::Bytes payload(100 + (i % 7), static_cast<wirebit::Byte>(i));
+            REQUIRE(ring.push_frame(wirebit::make_frame(wirebit::FrameType::SERIAL, payload)).is_ok());
+            auto view = ring.peek();
+            REQUIRE(view.is_ok());
+            CHECK(view.value().payload.size() == payload.size());
+            CHECK(view.value().payload.back() == static_cast<wirebit::Byte>(i));
+            ring.consume();
+        }
+        CHECK(ring.empty());
+    }
+
+    SUBCASE("Oversized record is rejected") {
+        auto ring_result = wirebit::FrameRing::create(256);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        auto slot = ring.reserve(512);
+        CHECK(slot.is_err());
+        CHECK(ring.empty());
+    }
+}
+
+TEST_CASE("FrameRing batch operations") {
+    SUBCASE("Push and pop a batch") {
+        auto ring_result = wirebit::FrameRing::create(4096);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        wirebit::Vector<wirebit::Frame> frames;
+        for (int i = 0; i < 8; ++i) {
+            frames.push_back(
+                wirebit::make_frame(wirebit::FrameType::CAN, wirebit::Bytes(16, static_cast<wirebit::Byte>(i)), i, 0));
+        }
+
+        auto push_result = ring.push_batch(std::span<const wirebit::Frame>(frames.data(), frames.size()));
+        REQUIRE(push_result.is_ok());
+        CHECK(push_result.value() == 8);
+
+        wirebit::Vector<wirebit::Frame> out;
+        auto pop_result = ring.pop_batch(out, 5);
+        REQUIRE(pop_result.is_ok());
+        CHECK(pop_result.value() == 5);
+        CHECK(out.size() == 5);
+
+        pop_result = ring.pop_batch(out, 100);
+        REQUIRE(pop_result.is_ok());
+        CHECK(pop_result.value() == 3);
+        REQUIRE(out.size() == 8);
+        for (int i = 0; i < 8; ++i) {
+            uint32_t src = out[i].header.src_endpoint_id;
+            CHECK(src == static_cast<uint32_t>(i));
+            CHECK(out[i].payload[0] == static_cast<wirebit::Byte>(i));
+        }
+
+        CHECK(ring.empty());
+        CHECK(ring.pop_batch(out, 1).is_err());
+    }
+
+    SUBCASE("Partial batch when ring fills up") {
+        auto ring_result = wirebit::FrameRing::create(512);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        wirebit::Vector<wirebit::Frame> frames;
+        for (int i = 0; i < 10; ++i) {
+            frames.push_back(wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes(50, 0x11)));
+        }
+
+        auto push_result = ring.push_batch(std::span<const wirebit::Frame>(frames.data(), frames.size()));
+        REQUIRE(push_result.is_ok());
+        CHECK(push_result.value() == 4); // 104-byte records in 512 bytes
+        CHECK(ring.push_batch(std::span<const wirebit::Frame>(frames.data(), 1)).is_err());
+    }
+
+    SUBCASE("Batches across the ring end") {
+        auto ring_result = wirebit::FrameRing::create(1000);
+        REQUIRE(ring_result.is_ok());
+        auto ring = std::move(ring_result.value());
+
+        int next_push = 0, next_pop = 0;
+        wirebit::Vector<wirebit::Frame> out;
+        for (int round = 0; round < 50; ++round) {
+            wirebit::Vector<wirebit::Frame> frames;
+            for (int i = 0; i < 3; ++i, ++next_push) {
+                frames.push_back(wirebit::make_frame_with_timestamps(
+                    wirebit::FrameType::SERIAL, wirebit::Bytes(20 + (next_push % 13), 0x22), next_push));
+            }
+            auto push_result = ring.push_batch(std::span<const wirebit::Frame>(frames.data(), frames.size()));
+            REQUIRE(push_result.is_ok());
+            REQUIRE(push_result.value() == 3);
+
+            out.clear();
+            auto pop_result = ring.pop_batch(out, 3);
+            REQUIRE(pop_result.is_ok());
+            REQUIRE(pop_result.value() == 3);
+            for (const auto &frame : out) {
+                uint64_t ts = frame.header.tx_timestamp_ns;
+                CHECK(ts == static_cast<uint64_t>(next_pop));
+                ++next_pop;
+            }
+        }
+        CHECK(ring.empty());
+    }
+}
+
+TEST_CASE("FrameRing compact headers") {
+    auto fill = [](wirebit::FrameRing &ring) {
+        size_t pushed = 0;
+        wirebit::Bytes can(16, 0x5A);
+        while (ring.push_frame(wirebit::make_frame(wirebit::FrameType::CAN, can, 1)).is_ok()) {
+            ++pushed;
+        }
+        return pushed;
+    };
+
+    SUBCASE("A v2 ring holds more CAN frames") {
+        auto v1 = wirebit::FrameRing::create(64000);
+        auto v2 = wirebit::FrameRing::create(64000, wirebit::FRAME_HEADER_V2);
+        REQUIRE(v1.is_ok());
+        REQUIRE(v2.is_ok());
+        CHECK(v1.value().header_version() == wirebit::FRAME_HEADER_V1);
+        CHECK(v2.value().header_version() == wirebit::FRAME_HEADER_V2);
+        CHECK(fill(v1.value()) == 1000); // 4 + 44 + 16 bytes
+        CHECK(fill(v2.value()) == 1600); // 4 + ~15 + 16 bytes, padded to 40
+
+        auto popped = v2.value().pop_frame();
+        REQUIRE(popped.is_ok());
+        uint16_t version = popped.value().header.version;
+        uint32_t src = popped.value().header.src_endpoint_id;
+        CHECK(version == wirebit::FRAME_HEADER_V1);
+        CHECK(src == 1);
+        CHECK(popped.value().payload == wirebit::Bytes(16, 0x5A));
+    }
+
+    SUBCASE("Fixed headers written through reserve() are still read") {
+        auto ring = std::move(wirebit::FrameRing::create(4096, wirebit::FRAME_HEADER_V2).value());
+        wirebit::Frame frame = wirebit::make_frame_with_timestamps(wirebit::FrameType::SERIAL, wirebit::Bytes{1, 2},
+                                                                   123, 456, 9, 8);
+        REQUIRE(ring.push_frame(frame).is_ok());
+        auto slot = ring.reserve(sizeof(wirebit::FrameHeader) + 2);
+        REQUIRE(slot.is_ok());
+        std::memcpy(slot.value().data(), &frame.header, sizeof(wirebit::FrameHeader));
+        std::memcpy(slot.value().data() + sizeof(wirebit::FrameHeader), frame.payload.data(), 2);
+        REQUIRE(ring.commit().is_ok());
+
+        for (int i = 0; i < 2; ++i) {
+            auto popped = ring.pop_frame();
+            REQUIRE(popped.is_ok());
+            uint64_t tx = popped.value().header.tx_timestamp_ns;
+            uint64_t deliver = popped.value().header.deliver_at_ns;
+            uint32_t dst = popped.value().header.dst_endpoint_id;
+            CHECK(tx == 123);
+            CHECK(deliver == 456);
+            CHECK(dst == 8);
+            CHECK(popped.value().payload == wirebit::Bytes{1, 2});
+        }
+    }
+
+    SUBCASE("Attaching adopts the creator's format") {
+        wirebit::String shm_name = "/wirebit_test_ring_v2";
+        auto created = wirebit::FrameRing::create_shm(shm_name, 4096, wirebit::ShmMemoryOptions{},
+                                                      wirebit::FRAME_HEADER_V2);
+        REQUIRE(created.is_ok());
+        auto attached = wirebit::FrameRing::attach_shm(shm_name);
+        REQUIRE(attached.is_ok());
+        CHECK(attached.value().header_version() == wirebit::FRAME_HEADER_V2);
+
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::CAN, wirebit::Bytes{7}, 3);
+        REQUIRE(attached.value().push_frame(frame).is_ok());
+        auto popped = created.value().pop_frame();
+        REQUIRE(popped.is_ok());
+        uint64_t sent_ts = frame.header.tx_timestamp_ns;
+        uint64_t ts = popped.value().header.tx_timestamp_ns;
+        CHECK(ts == sent_ts);
+    }
+
+    SUBCASE("Unknown versions are rejected") {
+        auto ring = wirebit::FrameRing::create(4096, 3);
+        REQUIRE(ring.is_err());
+        CHECK(ring.error().code == wirebit::Error::invalid_argument("").code);
+    }
+}
+
+TEST_CASE("FrameRing space accounting") {
+    SUBCASE("space_needed matches what a push takes") {
+        for (uint16_t version : {wirebit::FRAME_HEADER_V1, wirebit::FRAME_HEADER_V2}) {
+            auto ring = std::move(wirebit::FrameRing::create(1024, version).value());
+            wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::CAN, wirebit::Bytes(13, 0xAB), 1, 2);
+            // Enough pushes to wrap, so the skipped ring tail is counted as well
+            for (int i = 0; i < 40; ++i) {
+                size_t needed = ring.space_needed(frame.header, frame.payload.size(), frame.meta.size());
+                size_t before = ring.size();
+                CHECK(ring.would_block(frame.header, frame.payload.size(), frame.meta.size()) ==
+                      (needed > ring.available()));
+                if (needed > ring.available()) {
+                    CHECK(ring.push_frame(frame).is_err());
+                    REQUIRE(ring.pop_frame().is_ok());
+                    continue;
+                }
+                REQUIRE(ring.push_frame(frame).is_ok());
+                CHECK(ring.size() - before == needed);
+            }
+        }
+    }
+
+    SUBCASE("Frames larger than the ring always block") {
+        auto ring = std::move(wirebit::FrameRing::create(256).value());
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::ETHERNET, wirebit::Bytes(512, 0));
+        CHECK(ring.space_needed(frame.header, frame.payload.size(), 0) > ring.capacity());
+        CHECK(ring.would_block(frame.header, frame.payload.size(), 0));
+    }
+
+    SUBCASE("cancel drops uncommitted records") {
+        auto ring = std::move(wirebit::FrameRing::create(1024).value());
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{1, 2, 3});
+        REQUIRE(ring.write_frame(frame.header, frame.payload, frame.meta).is_ok());
+        REQUIRE(ring.write_frame(frame.header, frame.payload, frame.meta).is_ok());
+        CHECK(ring.empty());
+        ring.cancel();
+        CHECK(ring.commit().is_err());
+        CHECK(ring.empty());
+
+        REQUIRE(ring.write_frame(frame.header, frame.payload, frame.meta).is_ok());
+        REQUIRE(ring.commit().is_ok());
+        CHECK(ring.pop_frame().is_ok());
+        CHECK(ring.pop_frame().is_err());
+    }
+
+    SUBCASE("Producer wait requests are granted once") {
+        auto ring = std::move(wirebit::FrameRing::create(1024).value());
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes(100, 0));
+        while (ring.push_frame(frame).is_ok()) {
+        }
+        CHECK_FALSE(ring.producer_unblocked()); // Nobody waits
+
+        ring.set_producer_waiting(600);
+        REQUIRE(ring.pop_frame().is_ok());
+        CHECK_FALSE(ring.producer_unblocked()); // Not enough space yet
+        while (ring.available() < 600) {
+            REQUIRE(ring.pop_frame().is_ok());
+        }
+        CHECK(ring.producer_unblocked());
+        CHECK_FALSE(ring.producer_unblocked()); // Request cleared by the first grant
+    }
 }
@@ -0,0 +1,136 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+TEST_CASE("RxQueue FIFO order across wrap-around") {
+    RxQueue<int> queue(4);
+    CHECK(queue.capacity() == 4);
+    CHECK(queue.empty());
+
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(queue.push(round * 10 + i));
+        }
+        CHECK(queue.size() == 3);
+        CHECK(queue[2] == round * 10 + 2);
+        for (int i = 0; i < 3; ++i) {
+            CHECK(queue.front() == round * 10 + i);
+            queue.pop();
+        }
+    }
+    CHECK(queue.empty());
+    CHECK(queue.dropped() == 0);
+}
+
+TEST_CASE("RxQueue overflow policies") {
+    SUBCASE("Drop oldest keeps the newest items") {
+        RxQueue<int> queue(3, RxOverflow::DropOldest);
+        for (int i = 0; i < 5; ++i) {
+            CHECK(queue.push(i));
+        }
+        CHECK(queue.full());
+        CHECK(queue.dropped() == 2);
+        CHECK(queue[0] == 2);
+        CHECK(queue[2] == 4);
+    }
+
+    SUBCASE("Drop newest rejects incoming items") {
+        RxQueue<int> queue(3, RxOverflow::DropNewest);
+        for (int i = 0; i < 3; ++i) {
+            CHECK(queue.push(i));
+        }
+        CHECK_FALSE(queue.push(3));
+        CHECK(queue.dropped() == 1);
+        CHECK(queue[0] == 0);
+        CHECK(queue[2] == 2);
+    }
+
+    SUBCASE("Zero capacity drops everything") {
+        RxQueue<int> queue;
+        CHECK_FALSE(queue.push(1));
+        CHECK(queue.dropped() == 1);
+    }
+}
+
+TEST_CASE("RxQueue bulk push and pop") {
+    Byte data[10];
+    for (int i = 0; i < 10; ++i) {
+        data[i] = static_cast<Byte>(i);
+    }
+
+    SUBCASE("Runs wrap around the end of the ring") {
+        RxQueue<Byte> queue(8);
+        CHECK(queue.push(data, 6) == 6);
+        Byte out[8];
+        CHECK(queue.pop(out, 4) == 4);
+        CHECK(queue.push(data, 5) == 5); // Wraps
+        CHECK(queue.size() == 7);
+        CHECK(queue.pop(out, 8) == 7);
+        CHECK(out[0] == 4);
+        CHECK(out[1] == 5);
+        CHECK(out[2] == 0);
+        CHECK(out[6] == 4);
+    }
+
+    SUBCASE("Drop oldest keeps the tail of an oversized run") {
+        RxQueue<Byte> queue(4, RxOverflow::DropOldest);
+        CHECK(queue.push(data, 2) == 2);
+        CHECK(queue.push(data, 10) == 4);
+        CHECK(queue.dropped() == 8);
+        Byte out[4];
+        CHECK(queue.pop(out, 4) == 4);
+        CHECK(out[0] == 6);
+        CHECK(out[3] == 9);
+    }
+
+    SUBCASE("Drop newest truncates a run") {
+        RxQueue<Byte> queue(4, RxOverflow::DropNewest);
+        CHECK(queue.push(data, 3) == 3);
+        CHECK(queue.push(data, 3) == 1);
+        CHECK(queue.dropped() == 2);
+        Byte out[4];
+        CHECK(queue.pop(out, 4) == 4);
+        CHECK(out[3] == 0);
+    }
+}
+
+TEST_CASE("RxQueue pop_swap recycles slot storage") {
+    RxQueue<Bytes> queue(2);
+    Bytes frame(64);
+    std::fill(frame.begin(), frame.end(), 0xAB);
+    REQUIRE(queue.push(frame));
+
+    Bytes out;
+    REQUIRE(queue.pop_swap(out));
+    CHECK(out.size() == 64);
+    CHECK(out[0] == 0xAB);
+    CHECK_FALSE(queue.pop_swap(out));
+    CHECK(out.size() == 64); // Untouched when empty
+}
+
+TEST_CASE("Endpoint receive buffers honour the overflow policy") {
+    auto server_result = ShmLink::create(String("rxq_serial"), 16384);
+    REQUIRE(server_result.is_ok());
+    auto server = std::make_shared<ShmLink>(std::move(server_result.value()));
+    auto client_result = ShmLink::attach(String("rxq_serial"));
+    REQUIRE(client_result.is_ok());
+    auto client = std::make_shared<ShmLink>(std::move(client_result.value()));
+
+    SerialConfig config;
+    config.baud = 1000000;
+    config.rx_buffer_size = 8;
+    SerialEndpoint tx(server, config, 1);
+    SerialEndpoint rx(client, config, 2);
+
+    Bytes data = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    REQUIRE(tx.send(data).is_ok());
+
+    // UART overrun: the bytes that did not fit are lost, the buffered ones are kept
+    auto result = rx.recv();
+    REQUIRE(result.is_ok());
+    CHECK(result.value().size() == 8);
+    CHECK(result.value()[0] == '0');
+    CHECK(result.value()[7] == '7');
+    CHECK(rx.rx_dropped() == 2);
+}
@@ -0,0 +1,149 @@
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    /// Outcome of one lossy-link scenario
+    struct LossyOutcome {
+        uint64_t received = 0;
+        uint64_t digest = 0; ///< FNV-1a over arrival times and sequence numbers
+        TimeNs end_ns = 0;
+    };
+
+    /// One sender on a link with latency, jitter, loss and corruption, 200 frames 1 ms apart
+    LossyOutcome run_lossy_link(ScenarioContext &ctx) {
+        LinkModel model(ms_to_ns(2), us_to_ns(500), 0.05, 0.02, 0.02, 0, ctx.seed);
+        auto created = ShmLink::create_pair("lossy", 16 << 10, &model);
+        if (!created.is_ok()) {
+            return LossyOutcome{};
+        }
+        auto links = std::move(created.value());
+        ShmLink &rx = links.second;
+        rx.set_model(LinkModel{}); // Hold frames until their deliver_at_ns
+
+        LossyOutcome outcome;
+        outcome.digest = 1469598103934665603ULL;
+        ctx.loop.add_link(rx, [&]() {
+            auto frame = rx.recv();
+            if (!frame.is_ok()) {
+                return false;
+            }
+            uint64_t values[] = {static_cast<uint64_t>(now_ns()), frame.value().payload[0]};
+            for (uint64_t value : values) {
+                outcome.digest = (outcome.digest ^ value) * 1099511628211ULL;
+            }
+            outcome.received++;
+            return true;
+        });
+
+        uint8_t seq = 0;
+        ctx.loop.schedule_every(ms_to_ns(1), [&]() {
+            links.first.send(make_frame(FrameType::CAN, Bytes{seq, 0, 0, 0, 0, 0, 0, 0}));
+            return ++seq < 200;
+        });
+        ctx.loop.run_until_idle(ctx.clock.now() + s_to_ns(10.0));
+        outcome.end_ns = now_ns();
+        return outcome;
+    }
+
+} // namespace
+
+TEST_CASE("ScenarioRunner results do not depend on the thread count") {
+    ScenarioRunnerConfig config;
+    config.base_seed = 42;
+    config.threads = 1;
+    ScenarioRunner serial(config);
+    config.threads = 4;
+    ScenarioRunner parallel(config);
+
+    auto first = serial.run(24, run_lossy_link);
+    auto second = parallel.run(24, run_lossy_link);
+    REQUIRE(first.is_ok());
+    REQUIRE(second.is_ok());
+    REQUIRE(first.value().size() == 24);
+    REQUIRE(second.value().size() == 24);
+    CHECK(serial.stats().threads == 1);
+    CHECK(parallel.stats().threads == 4);
+    CHECK(parallel.stats().scenarios == 24);
+
+    bool identical = true;
+    bool seeds_differ = false;
+    for (size_t i = 0; i < 24; ++i) {
+        const LossyOutcome &a = first.value()[i];
+        const LossyOutcome &b = second.value()[i];
+        identical = identical && a.received == b.received && a.digest == b.digest && a.end_ns == b.end_ns;
+        seeds_differ = seeds_differ || a.digest != first.value()[0].digest;
+        CHECK(a.received > 150); // 200 sent, about 5% dropped and 2% duplicated
+        CHECK(a.received < 230);
+    }
+    CHECK(identical);
+    CHECK(seeds_differ);
+    CHECK(clock_source() == nullptr); // Worker clocks are gone with their scenarios
+}
+
+TEST_CASE("ScenarioRunner scenarios see their own clock and index") {
+    ScenarioRunnerConfig config;
+    config.threads = 3;
+    config.base_seed = 100;
+    config.start_ns = s_to_ns(5.0);
+    ScenarioRunner runner(config);
+
+    auto result = runner.run(30, [](ScenarioContext &ctx) {
+        bool own_clock = now_ns() == s_to_ns(5.0);
+        ctx.clock.advance_by(ms_to_ns(static_cast<int64_t>(ctx.index)));
+        std::this_thread::yield(); // Let the other workers advance their clocks meanwhile
+        own_clock = own_clock && now_ns() == s_to_ns(5.0) + ms_to_ns(static_cast<int64_t>(ctx.index));
+        return own_clock && ctx.seed == 100 + ctx.index ? ctx.index : SIZE_MAX;
+    });
+    REQUIRE(result.is_ok());
+    for (size_t i = 0; i < 30; ++i) {
+        CHECK(result.value()[i] == i);
+    }
+
+    SUBCASE("No scenarios") {
+        auto none = runner.run(0, [](ScenarioContext &ctx) { return ctx.index; });
+        REQUIRE(none.is_ok());
+        CHECK(none.value().empty());
+        CHECK(runner.stats().threads == 1);
+    }
+
+    SUBCASE("A process clock stays in place for other threads") {
+        VirtualClock process(s_to_ns(1.0));
+        ScopedClock use(process);
+        auto inside = runner.run(4, [](ScenarioContext &) { return now_ns(); });
+        REQUIRE(inside.is_ok());
+        CHECK(inside.value()[3] == s_to_ns(5.0));
+        CHECK(now_ns() == s_to_ns(1.0));
+    }
+}
+
+TEST_CASE("ScenarioRunner steals from workers with slow scenarios") {
+    ScenarioRunnerConfig config;
+    config.threads = 4;
+    ScenarioRunner runner(config);
+
+    // Worker 0 starts with scenarios 0..15, which are the only slow ones
+    Vector<std::atomic<int>> runs(64);
+    auto result = runner.run(64, [&](ScenarioContext &ctx) {
+        if (ctx.index < 16) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        runs[ctx.index].fetch_add(1);
+        return ctx.worker;
+    });
+    REQUIRE(result.is_ok());
+    bool once = true;
+    for (auto &count : runs) {
+        once = once && count.load() == 1;
+    }
+    CHECK(once);
+    CHECK(runner.stats().steals > 0);
+    size_t by_others = 0;
+    for (size_t i = 0; i < 16; ++i) {
+        by_others += result.value()[i] != 0 ? 1 : 0;
+    }
+    CHECK(by_others > 0);
+}
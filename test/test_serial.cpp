@@ -1,5 +1,6 @@
 #include <doctest/doctest.h>
 #include <memory>
+#include <thread>
 #include <wirebit/wirebit.hpp>
 
 TEST_CASE("SerialEndpoint basic operations") {
@@ -96,6 +97,116 @@ TEST_CASE("SerialEndpoint basic operations") {
         CHECK(frame_count == 10);
     }
 
+    SUBCASE("Enforced delivery timing") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("ser_timing"), 8192);
+        REQUIRE(server_result.is_ok());
+        auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("ser_timing"));
+        REQUIRE(client_result.is_ok());
+        auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+        wirebit::SerialConfig config;
+        config.baud = 9600; // ~1ms per byte
+        config.enforce_timing = true;
+
+        wirebit::SerialEndpoint tx_endpoint(server_link, config, 1);
+        wirebit::SerialEndpoint rx_endpoint(client_link, config, 2);
+
+        wirebit::Bytes data = {0x48, 0x65, 0x6C, 0x6C, 0x6F};
+        REQUIRE(tx_endpoint.send(data).is_ok());
+
+        // Bytes are still "on the wire": held, not delivered and not lost
+        CHECK(rx_endpoint.process().is_err());
+        CHECK(rx_endpoint.rx_buffer_size() == 0);
+        CHECK(rx_endpoint.delayed_count() == 5);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        CHECK(rx_endpoint.process().is_ok());
+        CHECK(rx_endpoint.delayed_count() == 0);
+        auto recv_result = rx_endpoint.recv();
+        REQUIRE(recv_result.is_ok());
+        CHECK(recv_result.value() == data);
+    }
+
+    SUBCASE("Coalesced frames keep per-byte timing") {
+        wirebit::VirtualClock clock;
+        wirebit::ScopedThreadClock use(clock);
+
+        auto server_result = wirebit::ShmLink::create(wirebit::String("ser_coalesce"), 8192);
+        REQUIRE(server_result.is_ok());
+        auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("ser_coalesce"));
+        REQUIRE(client_result.is_ok());
+        auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+        wirebit::SerialConfig config;
+        config.baud = 1000; // 10ms per byte
+        config.enforce_timing = true;
+        config.coalesce_max = 64;
+
+        wirebit::SerialEndpoint tx_endpoint(server_link, config, 1);
+        wirebit::SerialEndpoint rx_endpoint(client_link, config, 2);
+
+        wirebit::Bytes data(100);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<wirebit::Byte>(i);
+        }
+        REQUIRE(tx_endpoint.send(data).is_ok());
+        CHECK(server_link->stats().frames_sent == 2); // 64 + 36 bytes
+
+        // Nothing is due before the first byte time
+        CHECK(rx_endpoint.process().is_err());
+        CHECK(rx_endpoint.delayed_count() == 2);
+
+        // After 3.5 byte times only the first three bytes have arrived
+        clock.advance_by(wirebit::ms_to_ns(35));
+        CHECK(rx_endpoint.process().is_ok());
+        CHECK(rx_endpoint.rx_buffer_size() == 3);
+        CHECK(rx_endpoint.delayed_count() == 2);
+
+        // One more byte per byte time
+        clock.advance_by(wirebit::ms_to_ns(10));
+        CHECK(rx_endpoint.process().is_ok());
+        CHECK(rx_endpoint.rx_buffer_size() == 4);
+
+        auto recv_result = rx_endpoint.recv();
+        REQUIRE(recv_result.is_ok());
+        CHECK(recv_result.value()[0] == 0);
+        CHECK(recv_result.value()[1] == 1);
+    }
+
+    SUBCASE("Coalesced frames without enforced timing") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("ser_coalesce_fast"), 8192);
+        REQUIRE(server_result.is_ok());
+        auto server_link = std::make_shared<wirebit::ShmLink>(std::move(server_result.value()));
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("ser_coalesce_fast"));
+        REQUIRE(client_result.is_ok());
+        auto client_link = std::make_shared<wirebit::ShmLink>(std::move(client_result.value()));
+
+        wirebit::SerialConfig config;
+        config.baud = 921600;
+        config.coalesce_max = 256;
+        config.max_chunk_read = 4096;
+
+        wirebit::SerialEndpoint tx_endpoint(server_link, config, 1);
+        wirebit::SerialEndpoint rx_endpoint(client_link, config, 2);
+
+        wirebit::Bytes data(1000);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<wirebit::Byte>(i * 7);
+        }
+        REQUIRE(tx_endpoint.send(data).is_ok());
+        CHECK(server_link->stats().frames_sent == 4);
+
+        auto recv_result = rx_endpoint.recv();
+        REQUIRE(recv_result.is_ok());
+        CHECK(recv_result.value() == data);
+    }
+
     SUBCASE("Empty send") {
         auto link_result = wirebit::ShmLink::create(wirebit::String("ser_empty"), 4096);
         REQUIRE(link_result.is_ok());
@@ -0,0 +1,203 @@
+#include <atomic>
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    Frame bus_frame(uint32_t src, uint32_t seq) {
+        Bytes payload(8, 0);
+        std::memcpy(payload.data(), &src, sizeof(src));
+        std::memcpy(payload.data() + 4, &seq, sizeof(seq));
+        return make_frame(FrameType::CAN, payload, src, 0);
+    }
+
+    uint32_t frame_seq(const Frame &frame) {
+        uint32_t seq = 0;
+        std::memcpy(&seq, frame.payload.data() + 4, sizeof(seq));
+        return seq;
+    }
+} // namespace
+
+TEST_CASE("ShmBus broadcast") {
+    SUBCASE("Create and attach") {
+        auto bus = ShmBus::create("test_bus_basic", 100);
+        REQUIRE(bus.is_ok());
+        CHECK(bus.value().slot_count() == 128);
+        CHECK(bus.value().can_send());
+        CHECK_FALSE(bus.value().can_recv());
+
+        auto node = ShmBus::attach("test_bus_basic");
+        REQUIRE(node.is_ok());
+        CHECK(node.value().slot_count() == 128);
+        CHECK(node.value().node_id() != bus.value().node_id());
+
+        CHECK_FALSE(ShmBus::attach("test_bus_missing").is_ok());
+        CHECK_FALSE(ShmBus::create("test_bus_bad", 0).is_ok());
+    }
+
+    SUBCASE("Every other node receives each frame once") {
+        auto a = ShmBus::create("test_bus_fanout", 64);
+        REQUIRE(a.is_ok());
+        auto b = ShmBus::attach("test_bus_fanout");
+        auto c = ShmBus::attach("test_bus_fanout");
+        REQUIRE(b.is_ok());
+        REQUIRE(c.is_ok());
+
+        REQUIRE(a.value().send(bus_frame(1, 10)).is_ok());
+        REQUIRE(b.value().send(bus_frame(2, 20)).is_ok());
+        CHECK(a.value().write_seq() == 2);
+
+        // a skips its own frame and gets b's
+        auto ra = a.value().recv();
+        REQUIRE(ra.is_ok());
+        CHECK(frame_seq(ra.value()) == 20);
+        CHECK_FALSE(a.value().recv().is_ok());
+        CHECK(a.value().stats().frames_skipped == 1);
+
+        auto rb = b.value().recv();
+        REQUIRE(rb.is_ok());
+        CHECK(frame_seq(rb.value()) == 10);
+        CHECK_FALSE(b.value().recv().is_ok());
+
+        // c sees both, in bus order
+        auto rc1 = c.value().recv_view();
+        REQUIRE(rc1.is_ok());
+        CHECK(rc1.value().header.src_endpoint_id == 1);
+        auto rc2 = c.value().recv();
+        REQUIRE(rc2.is_ok());
+        CHECK(frame_seq(rc2.value()) == 20);
+        CHECK(c.value().stats().frames_received == 2);
+        CHECK(c.value().backlog() == 0);
+    }
+
+    SUBCASE("Late attach starts at the end of the bus") {
+        auto a = ShmBus::create("test_bus_late", 16);
+        REQUIRE(a.is_ok());
+        REQUIRE(a.value().send(bus_frame(1, 1)).is_ok());
+
+        auto b = ShmBus::attach("test_bus_late");
+        REQUIRE(b.is_ok());
+        CHECK_FALSE(b.value().recv().is_ok());
+
+        REQUIRE(a.value().send(bus_frame(1, 2)).is_ok());
+        auto rb = b.value().recv();
+        REQUIRE(rb.is_ok());
+        CHECK(frame_seq(rb.value()) == 2);
+    }
+
+    SUBCASE("Slow reader is lapped instead of blocking the writer") {
+        auto a = ShmBus::create("test_bus_lap", 4);
+        REQUIRE(a.is_ok());
+        auto b = ShmBus::attach("test_bus_lap");
+        REQUIRE(b.is_ok());
+
+        for (uint32_t i = 0; i < 10; ++i) {
+            REQUIRE(a.value().send(bus_frame(1, i)).is_ok());
+        }
+
+        Vector<uint32_t> seen;
+        while (true) {
+            auto result = b.value().recv();
+            if (!result.is_ok()) {
+                break;
+            }
+            seen.push_back(frame_seq(result.value()));
+        }
+
+        REQUIRE(seen.size() == 4);
+        CHECK(seen.front() == 6);
+        CHECK(seen.back() == 9);
+        CHECK(b.value().stats().laps == 1);
+        CHECK(b.value().stats().frames_overrun == 6);
+    }
+
+    SUBCASE("Oversized frame is rejected") {
+        auto a = ShmBus::create("test_bus_big", 4, sizeof(FrameHeader) + 16);
+        REQUIRE(a.is_ok());
+        Bytes payload(17, 0);
+        auto result = a.value().send(make_frame(FrameType::ETHERNET, payload, 1, 0));
+        CHECK_FALSE(result.is_ok());
+        CHECK(a.value().write_seq() == 0);
+    }
+}
+
+TEST_CASE("ShmBus concurrent writers") {
+    constexpr uint32_t WRITERS = 3;
+    constexpr uint32_t FRAMES = 2000;
+
+    auto reader = ShmBus::create("test_bus_mpsc", WRITERS * FRAMES);
+    REQUIRE(reader.is_ok());
+
+    Vector<std::thread> threads;
+    std::atomic<uint32_t> failures{0};
+    for (uint32_t w = 0; w < WRITERS; ++w) {
+        threads.emplace_back([w, &failures] {
+            auto node = ShmBus::attach("test_bus_mpsc");
+            if (!node.is_ok()) {
+                failures++;
+                return;
+            }
+            for (uint32_t i = 0; i < FRAMES; ++i) {
+                if (!node.value().send(bus_frame(w + 1, i)).is_ok()) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    REQUIRE(failures.load() == 0);
+
+    // Per writer, frames arrive complete and in order
+    uint32_t next[WRITERS] = {0, 0, 0};
+    uint32_t total = 0;
+    while (true) {
+        auto result = reader.value().recv();
+        if (!result.is_ok()) {
+            break;
+        }
+        uint32_t src = result.value().header.src_endpoint_id;
+        REQUIRE(src >= 1);
+        REQUIRE(src <= WRITERS);
+        CHECK(frame_seq(result.value()) == next[src - 1]);
+        next[src - 1] = frame_seq(result.value()) + 1;
+        ++total;
+    }
+    CHECK(total == WRITERS * FRAMES);
+    CHECK(reader.value().stats().frames_overrun == 0);
+}
+
+TEST_CASE("CanEndpoint over ShmBus") {
+    auto hub = ShmBus::create("test_bus_can", 256);
+    REQUIRE(hub.is_ok());
+
+    CanConfig config;
+    config.bitrate = 1000000;
+    Vector<std::unique_ptr<CanEndpoint>> nodes;
+    for (uint32_t id = 1; id <= 3; ++id) {
+        auto link = ShmBus::attach("test_bus_can");
+        REQUIRE(link.is_ok());
+        nodes.push_back(std::make_unique<CanEndpoint>(std::make_shared<ShmBus>(std::move(link.value())), config, id));
+    }
+
+    can_frame cf = {};
+    cf.can_id = 0x123;
+    cf.can_dlc = 2;
+    cf.data[0] = 0xCA;
+    cf.data[1] = 0xFE;
+    REQUIRE(nodes[0]->send_can(cf).is_ok());
+
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        can_frame out = {};
+        REQUIRE(nodes[i]->recv_can(out).is_ok());
+        CHECK(out.can_id == 0x123);
+        CHECK(out.can_dlc == 2);
+        CHECK(out.data[1] == 0xFE);
+    }
+
+    can_frame none = {};
+    CHECK_FALSE(nodes[0]->recv_can(none).is_ok());
+}
@@ -0,0 +1,90 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    bool roundtrip(ShmLink &a, ShmLink &b) {
+        Bytes payload = {1, 2, 3, 4};
+        if (!a.send(make_frame(FrameType::SERIAL, payload, 1, 2)).is_ok()) {
+            return false;
+        }
+        auto result = b.recv();
+        return result.is_ok() && result.value().payload == payload;
+    }
+} // namespace
+
+TEST_CASE("SHM segment placement") {
+    SUBCASE("Defaults leave the mapping alone") {
+        auto ring = FrameRing::create_shm("/test_mem_default", 4096);
+        REQUIRE(ring.is_ok());
+        const ShmMemoryInfo &info = ring.value().memory_info();
+        CHECK_FALSE(info.huge_pages);
+        CHECK_FALSE(info.hugetlbfs);
+        CHECK_FALSE(info.locked);
+        CHECK_FALSE(info.prefaulted);
+        CHECK(info.numa_node == -1);
+        CHECK(info.page_size == static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+    }
+
+    SUBCASE("Prefault and lock") {
+        ShmMemoryOptions memory;
+        memory.prefault = true;
+        memory.lock = true; // May exceed RLIMIT_MEMLOCK here; prefaulting must still happen
+        auto ring = FrameRing::create_shm("/test_mem_lock", 64 * 1024, memory);
+        REQUIRE(ring.is_ok());
+        CHECK(ring.value().memory_info().prefaulted);
+
+        REQUIRE(ring.value().push_frame(make_frame(FrameType::CAN, Bytes{9}, 1, 0)).is_ok());
+        auto attached = FrameRing::attach_shm("/test_mem_lock", memory);
+        REQUIRE(attached.is_ok());
+        CHECK(attached.value().memory_info().prefaulted);
+        auto frame = attached.value().pop_frame();
+        REQUIRE(frame.is_ok());
+        CHECK(frame.value().payload[0] == 9);
+    }
+
+    SUBCASE("Missing hugetlbfs mount falls back to POSIX shm on both sides") {
+        ShmLinkMemory memory;
+        memory.huge_pages = ShmHugePages::Hugetlbfs;
+        memory.hugetlbfs_dir = "/nonexistent_hugetlbfs";
+        auto server = ShmLink::create("test_mem_huge", 8192, nullptr, memory);
+        REQUIRE(server.is_ok());
+        CHECK_FALSE(server.value().rx_memory().hugetlbfs);
+        CHECK_FALSE(server.value().tx_memory().hugetlbfs);
+
+        auto client = ShmLink::attach("test_mem_huge", nullptr, memory);
+        REQUIRE(client.is_ok());
+        CHECK(roundtrip(server.value(), client.value()));
+        CHECK(roundtrip(client.value(), server.value()));
+    }
+
+    SUBCASE("Transparent huge pages and NUMA node of the consumer") {
+        ShmLinkMemory memory;
+        memory.huge_pages = ShmHugePages::Transparent;
+        memory.numa_node = SHM_NUMA_LOCAL;
+        memory.peer_numa_node = 0;
+        memory.prefault = true;
+        auto server = ShmLink::create("test_mem_numa", 8192, nullptr, memory);
+        REQUIRE(server.is_ok());
+
+        // Placement depends on the kernel (CONFIG_NUMA, shmem THP); it must never break the link
+        const ShmMemoryInfo &rx = server.value().rx_memory();
+        const ShmMemoryInfo &tx = server.value().tx_memory();
+        CHECK(rx.prefaulted);
+        CHECK((rx.numa_node == -1 || rx.numa_node == detail::current_numa_node()));
+        CHECK((tx.numa_node == -1 || tx.numa_node == 0));
+
+        auto client = ShmLink::attach("test_mem_numa");
+        REQUIRE(client.is_ok());
+        CHECK(roundtrip(server.value(), client.value()));
+    }
+}
+
+TEST_CASE("SHM placement helpers") {
+    CHECK(detail::round_to_page(1, 4096) == 4096);
+    CHECK(detail::round_to_page(4096, 4096) == 4096);
+    CHECK(detail::round_to_page(4097, 2 * 1024 * 1024) == 2 * 1024 * 1024);
+    CHECK(detail::hugetlbfs_path("/dev/hugepages", "/wb_ring_tx") == String("/dev/hugepages/wb_ring_tx"));
+    CHECK(detail::current_numa_node() >= 0);
+}
@@ -0,0 +1,188 @@
+#include <doctest/doctest.h>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    ShmRegistryConfig small_config() {
+        ShmRegistryConfig config;
+        config.max_links = 64;
+        config.arena_bytes = 4 << 20;
+        config.block_size = 16 << 10;
+        return config;
+    }
+
+    /// Fresh registry segment per test case
+    ShmRegistry fresh_registry(const char *name, const ShmRegistryConfig &config = small_config()) {
+        ShmRegistry::unlink(name);
+        auto registry = ShmRegistry::open(name, config);
+        REQUIRE(registry.is_ok());
+        return std::move(registry.value());
+    }
+
+    Frame serial_frame(Byte value) { return make_frame(FrameType::SERIAL, Bytes{value, 2, 3}); }
+
+} // namespace
+
+TEST_CASE("ShmRegistry creates and attaches links from one arena") {
+    auto registry = fresh_registry("/test_registry_basic");
+    CHECK(registry.max_links() == 64);
+    CHECK(registry.arena_bytes() == 4 << 20);
+    CHECK(registry.free_bytes() == 4 << 20);
+    CHECK(registry.link_count() == 0);
+
+    auto server = registry.create("ecu", 8192);
+    REQUIRE(server.is_ok());
+    CHECK(server.value().name() == "ecu");
+    CHECK(server.value().tx_capacity() >= 8192);
+    CHECK(registry.free_bytes() == (4 << 20) - 2 * (16 << 10));
+    CHECK(registry.create("ecu", 8192).is_err()); // Name taken by a live link
+
+    auto client = registry.attach("ecu");
+    REQUIRE(client.is_ok());
+    CHECK(registry.attach("ecu").is_err()); // Already attached
+    CHECK(registry.attach("missing").error().code == Error::not_found("").code);
+
+    REQUIRE(server.value().send(serial_frame(1)).is_ok());
+    REQUIRE(client.value().send(serial_frame(2)).is_ok());
+    auto at_client = client.value().recv();
+    auto at_server = server.value().recv();
+    REQUIRE(at_client.is_ok());
+    REQUIRE(at_server.is_ok());
+    CHECK(at_client.value().payload[0] == 1);
+    CHECK(at_server.value().payload[0] == 2);
+
+    auto links = registry.links();
+    REQUIRE(links.size() == 1);
+    CHECK(links[0].name == "ecu");
+    CHECK(links[0].creator_pid == getpid());
+    CHECK(links[0].attacher_pid == getpid());
+    CHECK(links[0].capacity == server.value().rx_capacity());
+
+    SUBCASE("Links outlive the registry handle") {
+        registry = fresh_registry("/test_registry_other");
+        REQUIRE(server.value().send(serial_frame(3)).is_ok());
+        CHECK(client.value().recv().is_ok());
+    }
+
+    SUBCASE("Memory returns to the arena when both ends are gone") {
+        { auto gone = std::move(client.value()); }
+        CHECK(registry.link_count() == 1);
+        { auto gone = std::move(server.value()); }
+        CHECK(registry.link_count() == 0);
+        CHECK(registry.free_bytes() == 4 << 20);
+        CHECK(registry.create("ecu", 8192).is_ok());
+    }
+    ShmRegistry::unlink("/test_registry_basic");
+    ShmRegistry::unlink("/test_registry_other");
+}
+
+TEST_CASE("ShmRegistry open_link rendezvous in any order") {
+    auto registry = fresh_registry("/test_registry_open");
+
+    auto first = registry.open_link("bus", 4096);
+    auto second = registry.open_link("bus", 4096);
+    REQUIRE(first.is_ok());
+    REQUIRE(second.is_ok());
+    REQUIRE(first.value().send(serial_frame(7)).is_ok());
+    auto frame = second.value().recv();
+    REQUIRE(frame.is_ok());
+    CHECK(frame.value().payload[0] == 7);
+
+    SUBCASE("Many links start without handshakes") {
+        Vector<ShmLink> creators;
+        Vector<ShmLink> attachers;
+        for (int i = 0; i < 50; ++i) {
+            auto link = registry.create(("node" + std::to_string(i)).c_str(), 4096);
+            REQUIRE(link.is_ok());
+            creators.push_back(std::move(link.value()));
+        }
+        for (int i = 0; i < 50; ++i) {
+            auto link = registry.attach(("node" + std::to_string(i)).c_str());
+            REQUIRE(link.is_ok());
+            CHECK(link.value().wakeups_enabled()); // Eventfds created on attach
+            attachers.push_back(std::move(link.value()));
+        }
+        // The creators collect them from their mailbox without waiting
+        for (auto &link : creators) {
+            REQUIRE(link.enable_wakeups(0).is_ok());
+            CHECK(link.poll_fd() >= 0);
+        }
+        CHECK(registry.link_count() == 51);
+    }
+    ShmRegistry::unlink("/test_registry_open");
+}
+
+TEST_CASE("ShmRegistry wakeups across threads") {
+    auto registry = fresh_registry("/test_registry_wakeups");
+    auto server = std::move(registry.create("wake", 4096).value());
+
+    // enable_wakeups() on the creator waits until the peer attaches
+    std::thread peer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto client = registry.attach("wake");
+        REQUIRE(client.is_ok());
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(client.value().send(serial_frame(9)).is_ok());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    });
+    REQUIRE(server.enable_wakeups(2000).is_ok());
+    server.set_spin_budget_ns(0);
+    auto frame = server.recv_wait(ms_to_ns(1000));
+    peer.join();
+    REQUIRE(frame.is_ok());
+    CHECK(frame.value().payload[0] == 9);
+    CHECK(server.stats().recv_waits >= 1);
+
+    SUBCASE("Times out without a peer") {
+        auto lonely = std::move(registry.create("lonely", 4096).value());
+        CHECK(lonely.enable_wakeups(10).error().code == Error::timeout("").code);
+    }
+    ShmRegistry::unlink("/test_registry_wakeups");
+}
+
+TEST_CASE("ShmRegistry limits and stale links") {
+    ShmRegistryConfig config = small_config();
+    config.max_links = 4;
+    config.arena_bytes = 8 * config.block_size;
+    auto registry = fresh_registry("/test_registry_limits", config);
+
+    CHECK(registry.create("", 4096).is_err());
+    CHECK(registry.create(String(std::string(80, 'x').c_str()), 4096).is_err());
+    CHECK(registry.create("huge", 1 << 20).error().code == Error::timeout("").code); // Arena too small
+
+    SUBCASE("Directory full") {
+        Vector<ShmLink> links;
+        for (int i = 0; i < 4; ++i) {
+            links.push_back(std::move(registry.create(("l" + std::to_string(i)).c_str(), 1024).value()));
+        }
+        CHECK(registry.create("l4", 1024).error().code == Error::timeout("").code);
+    }
+
+    SUBCASE("Links of a dead process are reclaimed") {
+        pid_t child = fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            auto r = ShmRegistry::open("/test_registry_limits");
+            auto a = r.value().create("orphan_a", 4096);
+            auto b = r.value().create("orphan_b", 4096);
+            _exit(a.is_ok() && b.is_ok() ? 0 : 1); // Exits without closing its links
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        REQUIRE(WEXITSTATUS(status) == 0);
+
+        CHECK(registry.link_count() == 2);
+        CHECK(registry.attach("orphan_a").is_err()); // Creator is gone
+        auto reused = registry.create("orphan_a", 4096); // Name of a dead link is free again
+        CHECK(reused.is_ok());
+        CHECK(registry.reap() == 1);
+        CHECK(registry.link_count() == 1);
+    }
+    ShmRegistry::unlink("/test_registry_limits");
+}
@@ -0,0 +1,233 @@
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    /// Payload whose bytes encode their position and a per-frame seed
+    Bytes pattern(size_t size, uint8_t seed) {
+        Bytes payload(size);
+        for (size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<Byte>((i * 31 + seed) & 0xFF);
+        }
+        return payload;
+    }
+
+    bool has_pattern(std::span<const Byte> payload, size_t size, uint8_t seed) {
+        if (payload.size() != size) {
+            return false;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            if (payload[i] != static_cast<Byte>((i * 31 + seed) & 0xFF)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ShmSlabConfig small_slab() {
+        ShmSlabConfig config;
+        config.slab_bytes = 256 << 10;
+        config.block_size = 16 << 10;
+        config.threshold = 4096;
+        return config;
+    }
+
+} // namespace
+
+TEST_CASE("ShmSlab allocates runs in order") {
+    auto created = ShmSlab::create_shm("/test_slab_alloc", 8 * 4096, 4096);
+    REQUIRE(created.is_ok());
+    auto slab = std::move(created.value());
+    auto peer = std::move(ShmSlab::attach_shm("/test_slab_alloc").value());
+    CHECK(slab.block_count() == 8);
+    CHECK(slab.capacity() == 8 * 4096);
+    CHECK(slab.free_blocks() == 8);
+
+    auto a = slab.alloc(5000); // Two blocks
+    auto b = slab.alloc(4096); // One block
+    REQUIRE(a.is_ok());
+    REQUIRE(b.is_ok());
+    CHECK(a.value().first_block == 0);
+    CHECK(a.value().block_count == 2);
+    CHECK(b.value().first_block == 2);
+    CHECK(slab.free_blocks() == 5);
+
+    // The peer sees what the producer wrote
+    Bytes data = pattern(5000, 7);
+    std::memcpy(slab.data(a.value()).data(), data.data(), data.size());
+    auto seen = peer.view(a.value());
+    REQUIRE(seen.is_ok());
+    CHECK(has_pattern(seen.value(), 5000, 7));
+
+    CHECK(slab.alloc(0).error().code == Error::invalid_argument("").code);
+    CHECK(slab.alloc(9 * 4096).error().code == Error::invalid_argument("").code);
+    CHECK(slab.alloc(6 * 4096).error().code == Error::timeout("").code);
+    CHECK(slab.would_block(6 * 4096));
+
+    SUBCASE("A run that does not fit the tail wraps to block 0") {
+        auto c = slab.alloc(4 * 4096);
+        REQUIRE(c.is_ok());
+        CHECK(c.value().first_block == 3);
+        peer.release(a.value());
+        CHECK(slab.alloc(3 * 4096).error().code == Error::timeout("").code); // Blocks 0-1 only
+        peer.release(b.value());
+        auto d = slab.alloc(3 * 4096);
+        REQUIRE(d.is_ok());
+        CHECK(d.value().first_block == 0);
+    }
+
+    SUBCASE("Invalid handles are rejected") {
+        ShmSlabHandle bad;
+        bad.first_block = 7;
+        bad.block_count = 2;
+        bad.length = 4096;
+        CHECK(peer.view(bad).is_err());
+        bad.block_count = 1;
+        bad.length = 4097;
+        CHECK(peer.view(bad).is_err());
+    }
+
+    SUBCASE("Unwinding an unpublished run reuses its blocks") {
+        auto c = slab.alloc(4096);
+        REQUIRE(c.is_ok());
+        slab.unwind(c.value());
+        CHECK(slab.alloc(4096).value().first_block == c.value().first_block);
+    }
+
+    CHECK(ShmSlab::create_shm("/test_slab_bad", 4096, 100).is_err()); // Block size not a multiple of 64
+    CHECK(ShmSlab::attach_shm("/test_slab_missing").error().code == Error::not_found("").code);
+}
+
+TEST_CASE("ShmLink sends large payloads through the slab") {
+    auto server = std::move(ShmLink::create(String("test_slab_link"), 8192).value());
+    auto client = std::move(ShmLink::attach(String("test_slab_link")).value());
+    REQUIRE(server.enable_slab(small_slab()).is_ok());
+    CHECK(server.slab_enabled());
+    CHECK(server.enable_slab(small_slab()).is_err());
+    CHECK(client.rx_slab() == nullptr);
+
+    SUBCASE("Frames larger than the ring") {
+        Frame jumbo = make_frame(FrameType::ETHERNET, pattern(64 << 10, 1), 1, 2);
+        REQUIRE(server.send(jumbo).is_ok());
+        CHECK(server.tx_usage() < 0.05f); // Only the handle record is in the ring
+
+        auto received = client.recv();
+        REQUIRE(received.is_ok());
+        CHECK(received.value().type() == FrameType::ETHERNET);
+        CHECK(received.value().header.src_endpoint_id == 1);
+        CHECK(received.value().header.payload_len == 64 << 10);
+        CHECK(received.value().header.flags == 0);
+        CHECK(has_pattern(std::span<const Byte>(received.value().payload), 64 << 10, 1));
+        CHECK(server.stats().slab_frames_sent == 1);
+        CHECK(client.stats().slab_frames_received == 1);
+        REQUIRE(client.rx_slab() != nullptr);
+        CHECK(client.rx_slab()->free_blocks() == client.rx_slab()->block_count());
+
+        // Without the slab the frame can never fit
+        CHECK(client.send(jumbo).is_err());
+    }
+
+    SUBCASE("Small and large frames stay in order") {
+        for (uint8_t i = 0; i < 6; ++i) {
+            size_t size = i % 2 == 0 ? 100 : 20000;
+            REQUIRE(server.send(make_frame(FrameType::SERIAL, pattern(size, i))).is_ok());
+        }
+        for (uint8_t i = 0; i < 6; ++i) {
+            auto received = client.recv();
+            REQUIRE(received.is_ok());
+            CHECK(has_pattern(std::span<const Byte>(received.value().payload), i % 2 == 0 ? 100 : 20000, i));
+        }
+        CHECK(server.stats().slab_frames_sent == 3);
+    }
+
+    SUBCASE("recv_view reads in place until release_view") {
+        REQUIRE(server.send(make_frame(FrameType::SERIAL, pattern(40000, 3))).is_ok());
+        auto view = client.recv_view();
+        REQUIRE(view.is_ok());
+        CHECK(has_pattern(view.value().payload, 40000, 3));
+        const ShmSlab *slab = client.rx_slab();
+        REQUIRE(slab != nullptr);
+        const Byte *base = slab->view(ShmSlabHandle{0, static_cast<uint32_t>(slab->block_count()), 1}).value().data();
+        CHECK(view.value().payload.data() >= base);
+        CHECK(view.value().payload.data() < base + slab->capacity());
+        CHECK(slab->free_blocks() == slab->block_count() - 3);
+        client.release_view();
+        CHECK(slab->free_blocks() == slab->block_count());
+    }
+
+    SUBCASE("A full slab rejects sends until the peer releases") {
+        Frame big = make_frame(FrameType::SERIAL, pattern(100 << 10, 4)); // 7 of 16 blocks
+        REQUIRE(server.send(big).is_ok());
+        REQUIRE(server.send(big).is_ok());
+        CHECK(server.send_would_block(big));
+        CHECK(server.send(big).error().code == Error::timeout("").code);
+        CHECK(server.stats().slab_full == 1);
+        CHECK(server.send_wait(big, ms_to_ns(5)).error().code == Error::timeout("").code);
+
+        std::thread reader([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            CHECK(client.recv().is_ok());
+        });
+        CHECK(server.send_wait(big, ms_to_ns(2000)).is_ok());
+        reader.join();
+        CHECK(client.recv().is_ok());
+        CHECK(client.recv().is_ok());
+    }
+
+    SUBCASE("Batches and link models") {
+        Vector<Frame> frames;
+        for (uint8_t i = 0; i < 4; ++i) {
+            frames.push_back(make_frame(FrameType::SERIAL, pattern(i % 2 == 0 ? 64 : 30000, i)));
+        }
+        auto sent = server.send_batch(std::span<const Frame>(frames));
+        REQUIRE(sent.is_ok());
+        CHECK(sent.value() == 4);
+
+        Vector<Frame> received;
+        REQUIRE(client.recv_batch(received, 16).is_ok());
+        REQUIRE(received.size() == 4);
+        for (uint8_t i = 0; i < 4; ++i) {
+            CHECK(has_pattern(std::span<const Byte>(received[i].payload), i % 2 == 0 ? 64 : 30000, i));
+        }
+
+        LinkModel model;
+        model.dup_prob = 1.0;
+        server.set_model(model);
+        client.set_model(LinkModel{});
+        REQUIRE(server.send(make_frame(FrameType::SERIAL, pattern(30000, 9))).is_ok());
+        for (int i = 0; i < 2; ++i) {
+            auto copy = client.recv();
+            REQUIRE(copy.is_ok());
+            CHECK(has_pattern(std::span<const Byte>(copy.value().payload), 30000, 9));
+        }
+        CHECK(client.rx_slab()->free_blocks() == client.rx_slab()->block_count());
+    }
+}
+
+#ifdef BIG_TRANSFER
+TEST_CASE("ShmLink bulk transfer through the slab") {
+    auto server = std::move(ShmLink::create(String("test_slab_bulk"), 64 << 10).value());
+    auto client = std::move(ShmLink::attach(String("test_slab_bulk")).value());
+    REQUIRE(server.enable_slab().is_ok());
+
+    // 128 MiB in 4 MiB frames, with a reader thread keeping up
+    const size_t chunk = 4 << 20;
+    const int chunks = 32;
+    bool ok = true;
+    std::thread reader([&]() {
+        for (int i = 0; i < chunks; ++i) {
+            auto frame = client.recv_wait(s_to_ns(10.0));
+            ok = ok && frame.is_ok() && has_pattern(std::span<const Byte>(frame.value().payload), chunk, i);
+        }
+    });
+    for (int i = 0; i < chunks; ++i) {
+        REQUIRE(server.send_wait(make_frame(FrameType::SERIAL, pattern(chunk, i)), s_to_ns(10.0)).is_ok());
+    }
+    reader.join();
+    CHECK(ok);
+    CHECK(server.stats().slab_frames_sent == chunks);
+}
+#endif
@@ -246,6 +246,83 @@ TEST_CASE("ShmLink with LinkModel") {
     }
 }
 
+TEST_CASE("ShmLink delayed delivery") {
+    const char *link_name = "test_link_delayed";
+
+    // 20ms latency, no other impairments
+    wirebit::LinkModel delayed(20000000, 0, 0.0, 0.0, 0.0, 0, 42);
+
+    auto server_result = wirebit::ShmLink::create(wirebit::String(link_name), 4096, &delayed);
+    REQUIRE(server_result.is_ok());
+    auto server = std::move(server_result.value());
+
+    auto client_result = wirebit::ShmLink::attach(wirebit::String(link_name), &delayed);
+    REQUIRE(client_result.is_ok());
+    auto client = std::move(client_result.value());
+
+    for (int i = 0; i < 3; ++i) {
+        wirebit::Bytes payload = {static_cast<wirebit::Byte>(i)};
+        REQUIRE(server.send(wirebit::make_frame(wirebit::FrameType::SERIAL, payload)).is_ok());
+    }
+
+    // Early frames are held by the link, not dropped
+    CHECK(client.recv().is_err());
+    CHECK(client.delayed_count() == 3);
+    CHECK(client.next_deadline() > static_cast<uint64_t>(wirebit::now_ns()));
+    CHECK(client.rx_usage() == 0.0f);
+    CHECK(client.stats().frames_received == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    for (int i = 0; i < 3; ++i) {
+        auto result = client.recv();
+        REQUIRE(result.is_ok());
+        REQUIRE(result.value().payload.size() == 1);
+        CHECK(result.value().payload[0] == static_cast<wirebit::Byte>(i));
+    }
+    CHECK(client.recv().is_err());
+    CHECK(client.delayed_count() == 0);
+    CHECK(client.next_deadline() == wirebit::DelayLine<wirebit::Frame>::NO_DEADLINE);
+    CHECK(client.stats().frames_received == 3);
+}
+
+TEST_CASE("ShmLink delay line is bounded") {
+    wirebit::VirtualClock clock;
+    wirebit::ScopedThreadClock use(clock);
+    wirebit::LinkModel delayed(20000000, 0, 0.0, 0.0, 0.0, 0, 42);
+
+    auto server_result = wirebit::ShmLink::create(wirebit::String("test_link_delay_cap"), 4096, &delayed);
+    REQUIRE(server_result.is_ok());
+    auto server = std::move(server_result.value());
+    auto client_result = wirebit::ShmLink::attach(wirebit::String("test_link_delay_cap"), &delayed);
+    REQUIRE(client_result.is_ok());
+    auto client = std::move(client_result.value());
+    client.set_max_delayed(2);
+    CHECK(client.max_delayed() == 2);
+
+    for (int i = 0; i < 5; ++i) {
+        wirebit::Bytes payload = {static_cast<wirebit::Byte>(i)};
+        REQUIRE(server.send(wirebit::make_frame(wirebit::FrameType::SERIAL, payload)).is_ok());
+    }
+
+    // Only two frames leave the ring; the rest keep occupying it
+    CHECK(client.recv().is_err());
+    CHECK(client.delayed_count() == 2);
+    CHECK(client.rx_usage() > 0.0f);
+    CHECK_FALSE(client.can_recv());
+
+    clock.advance_by(wirebit::ms_to_ns(20));
+    CHECK(client.can_recv());
+    for (int i = 0; i < 5; ++i) {
+        auto result = client.recv();
+        REQUIRE(result.is_ok());
+        CHECK(result.value().payload[0] == static_cast<wirebit::Byte>(i));
+        CHECK(client.delayed_count() <= 2);
+    }
+    CHECK(client.recv().is_err());
+    CHECK(client.rx_usage() == 0.0f);
+}
+
 TEST_CASE("ShmLink statistics") {
     SUBCASE("Track sent/received frames") {
         const char *link_name = "test_link_stats";
@@ -322,6 +399,28 @@ TEST_CASE("ShmLink ring usage") {
         CHECK(server.tx_usage() == 0.0f);
         CHECK(server.rx_usage() == 0.0f);
     }
+
+    SUBCASE("Compact record headers") {
+        const char *link_name = "test_link_v2";
+
+        auto server_result = wirebit::ShmLink::create(wirebit::String(link_name), 4096, nullptr,
+                                                      wirebit::ShmLinkMemory{}, wirebit::FRAME_HEADER_V2);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+        auto client_result = wirebit::ShmLink::attach(wirebit::String(link_name));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+        CHECK(client.header_version() == wirebit::FRAME_HEADER_V2);
+
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::CAN, wirebit::Bytes(16, 0x11), 2, 3);
+        REQUIRE(client.send(frame).is_ok());
+        CHECK(server.rx_usage() * 4096 == 40.0f);
+        auto received = server.recv();
+        REQUIRE(received.is_ok());
+        uint32_t dst = received.value().header.dst_endpoint_id;
+        CHECK(dst == 3);
+        CHECK(received.value().payload == frame.payload);
+    }
 }
 
 TEST_CASE("ShmLink model enable/disable") {
@@ -344,3 +443,375 @@ TEST_CASE("ShmLink model enable/disable") {
         CHECK_FALSE(server.has_model());
     }
 }
+
+TEST_CASE("ShmLink zero-copy views") {
+    SUBCASE("send_view and recv_view") {
+        const char *link_name = "test_link_view";
+
+        auto server_result = wirebit::ShmLink::create(wirebit::String(link_name), 4096);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String(link_name));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        wirebit::Byte buf[6] = {9, 8, 7, 6, 5, 4};
+        auto view = wirebit::make_view(wirebit::FrameType::SERIAL, std::span<const wirebit::Byte>(buf, 6), 1, 2);
+        REQUIRE(server.send_view(view).is_ok());
+        REQUIRE(server.send_view(view).is_ok());
+
+        auto first = client.recv_view();
+        REQUIRE(first.is_ok());
+        CHECK(first.value().type() == wirebit::FrameType::SERIAL);
+        CHECK(first.value().payload.size() == 6);
+        CHECK(first.value().payload[0] == 9);
+        CHECK(first.value().payload.data() != buf); // Points into shared memory
+        uint32_t src = first.value().header.src_endpoint_id;
+        CHECK(src == 1);
+
+        // Record is held until the next recv call
+        CHECK(server.tx_usage() > 0.0f);
+        auto second = client.recv();
+        REQUIRE(second.is_ok());
+        CHECK(second.value().payload[5] == 4);
+        CHECK(server.tx_usage() == 0.0f);
+        CHECK(client.recv_view().is_err());
+
+        uint64_t received = client.stats().frames_received;
+        CHECK(received == 2);
+    }
+
+    SUBCASE("release_view frees ring space") {
+        const char *link_name = "test_link_view_release";
+
+        auto server_result = wirebit::ShmLink::create(wirebit::String(link_name), 4096);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String(link_name));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::CAN, wirebit::Bytes(16, 0x33));
+        REQUIRE(server.send(frame).is_ok());
+
+        auto view = client.recv_view();
+        REQUIRE(view.is_ok());
+        CHECK(client.rx_usage() > 0.0f);
+        client.release_view();
+        CHECK(client.rx_usage() == 0.0f);
+    }
+}
+
+TEST_CASE("ShmLink batch operations") {
+    SUBCASE("send_batch and recv_batch") {
+        const char *link_name = "test_link_batch";
+
+        auto server_result = wirebit::ShmLink::create(wirebit::String(link_name), 8192);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String(link_name));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        wirebit::Vector<wirebit::Frame> frames;
+        for (int i = 0; i < 10; ++i) {
+            wirebit::Bytes payload = {static_cast<wirebit::Byte>(i)};
+            frames.push_back(wirebit::make_frame(wirebit::FrameType::CAN, payload));
+        }
+
+        auto send_result = server.send_batch(std::span<const wirebit::Frame>(frames.data(), frames.size()));
+        REQUIRE(send_result.is_ok());
+        CHECK(send_result.value() == 10);
+        uint64_t sent = server.stats().frames_sent;
+        CHECK(sent == 10);
+
+        wirebit::Vector<wirebit::Frame> received;
+        auto recv_result = client.recv_batch(received, 32);
+        REQUIRE(recv_result.is_ok());
+        CHECK(recv_result.value() == 10);
+        REQUIRE(received.size() == 10);
+        CHECK(received[9].payload[0] == 9);
+        uint64_t count = client.stats().frames_received;
+        CHECK(count == 10);
+
+        CHECK(client.recv_batch(received, 32).is_err());
+    }
+
+    SUBCASE("Batch through link model") {
+        const char *link_name = "test_link_batch_model";
+
+        wirebit::LinkModel model(0, 0, 0.0, 0.0, 0.0, 0, 7);
+        auto server_result = wirebit::ShmLink::create(wirebit::String(link_name), 8192, &model);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String(link_name));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        wirebit::Bytes payload = {1, 2};
+        wirebit::Vector<wirebit::Frame> frames(4, wirebit::make_frame(wirebit::FrameType::SERIAL, payload));
+        auto send_result = server.send_batch(std::span<const wirebit::Frame>(frames.data(), frames.size()));
+        REQUIRE(send_result.is_ok());
+        CHECK(send_result.value() == 4);
+
+        wirebit::Vector<wirebit::Frame> received;
+        auto recv_result = client.recv_batch(received, 8);
+        REQUIRE(recv_result.is_ok());
+        CHECK(recv_result.value() == 4);
+    }
+}
+
+TEST_CASE("ShmLink blocking receive") {
+    SUBCASE("recv_wait without wakeups polls until timeout") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("test_link_wait_poll"), 4096);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("test_link_wait_poll"));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        CHECK_FALSE(client.wakeups_enabled());
+
+        uint64_t start = wirebit::now_ns();
+        CHECK(client.recv_wait(wirebit::ms_to_ns(5)).is_err());
+        CHECK(static_cast<uint64_t>(wirebit::now_ns()) - start >= static_cast<uint64_t>(wirebit::ms_to_ns(5)));
+
+        wirebit::Bytes payload = {0x42};
+        REQUIRE(server.send(wirebit::make_frame(wirebit::FrameType::SERIAL, payload)).is_ok());
+        auto result = client.recv_wait(wirebit::ms_to_ns(5));
+        REQUIRE(result.is_ok());
+        CHECK(result.value().payload[0] == 0x42);
+    }
+
+    SUBCASE("recv_wait blocks on eventfd and is woken by send") {
+        auto server_result = wirebit::ShmLink::create(wirebit::String("test_link_wait_efd"), 4096);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("test_link_wait_efd"));
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        // Creator side blocks in accept() until the attaching side connects
+        std::thread handshake([&]() { CHECK(server.enable_wakeups().is_ok()); });
+        REQUIRE(client.enable_wakeups().is_ok());
+        handshake.join();
+        CHECK(server.wakeups_enabled());
+        CHECK(client.wakeups_enabled());
+
+        // Nobody is waiting: send must not signal
+        wirebit::Bytes first = {0x01};
+        REQUIRE(server.send(wirebit::make_frame(wirebit::FrameType::SERIAL, first)).is_ok());
+        CHECK(server.stats().wakeups_sent == 0);
+        REQUIRE(client.recv_wait(wirebit::ms_to_ns(100)).is_ok());
+
+        client.set_spin_budget_ns(0);
+        std::thread sender([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            wirebit::Bytes second = {0x02};
+            server.send(wirebit::make_frame(wirebit::FrameType::SERIAL, second));
+        });
+
+        uint64_t start = wirebit::now_ns();
+        auto result = client.recv_wait(wirebit::s_to_ns(2.0));
+        uint64_t elapsed = static_cast<uint64_t>(wirebit::now_ns()) - start;
+        sender.join();
+
+        REQUIRE(result.is_ok());
+        CHECK(result.value().payload[0] == 0x02);
+        CHECK(elapsed < static_cast<uint64_t>(wirebit::s_to_ns(1.0)));
+        CHECK(client.stats().recv_waits >= 1);
+        CHECK(server.stats().wakeups_sent == 1);
+    }
+
+    SUBCASE("recv_wait wakes for frames held by the link model") {
+        wirebit::LinkModel delayed(wirebit::ms_to_ns(20), 0, 0.0, 0.0, 0.0, 0, 42);
+
+        auto server_result = wirebit::ShmLink::create(wirebit::String("test_link_wait_model"), 4096, &delayed);
+        REQUIRE(server_result.is_ok());
+        auto server = std::move(server_result.value());
+
+        auto client_result = wirebit::ShmLink::attach(wirebit::String("test_link_wait_model"), &delayed);
+        REQUIRE(client_result.is_ok());
+        auto client = std::move(client_result.value());
+
+        wirebit::Bytes payload = {0x07};
+        REQUIRE(server.send(wirebit::make_frame(wirebit::FrameType::SERIAL, payload)).is_ok());
+
+        auto result = client.recv_wait(wirebit::s_to_ns(1.0));
+        REQUIRE(result.is_ok());
+        CHECK(result.value().payload[0] == 0x07);
+        CHECK(static_cast<uint64_t>(wirebit::now_ns()) >= result.value().header.deliver_at_ns);
+    }
+}
+
+TEST_CASE("ShmLink flow control") {
+    wirebit::Frame frame = wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes(200, 0x5A));
+
+    SUBCASE("send_would_block predicts a full ring exactly") {
+        auto server = std::move(wirebit::ShmLink::create(wirebit::String("test_link_would_block"), 4096).value());
+        auto client = std::move(wirebit::ShmLink::attach(wirebit::String("test_link_would_block")).value());
+        for (int round = 0; round < 3; ++round) {
+            int sent = 0;
+            while (!server.send_would_block(frame)) {
+                REQUIRE(server.send(frame).is_ok());
+                ++sent;
+            }
+            CHECK(sent > 0);
+            auto full = server.send(frame);
+            REQUIRE(full.is_err());
+            CHECK(full.error().code == wirebit::Error::timeout("").code);
+            // Free a little; the next round starts at a different ring offset
+            REQUIRE(client.recv().is_ok());
+            REQUIRE(client.recv().is_ok());
+        }
+    }
+
+    SUBCASE("Watermark callbacks fire once per excursion") {
+        auto server = std::move(wirebit::ShmLink::create(wirebit::String("test_link_watermarks"), 4096).value());
+        auto client = std::move(wirebit::ShmLink::attach(wirebit::String("test_link_watermarks")).value());
+
+        int highs = 0;
+        int lows = 0;
+        wirebit::ShmFlowControl flow;
+        flow.high_watermark = 0.75f;
+        flow.low_watermark = 0.25f;
+        flow.on_high = [&](float usage) {
+            CHECK(usage >= 0.75f);
+            ++highs;
+        };
+        flow.on_low = [&](float usage) {
+            CHECK(usage < 0.25f);
+            ++lows;
+        };
+        REQUIRE(server.set_flow_control(flow).is_ok());
+
+        while (server.send(frame).is_ok()) {
+        }
+        server.send(frame); // Still full: no second callback
+        CHECK(highs == 1);
+        CHECK(server.above_high_watermark());
+        CHECK(server.stats().high_watermarks == 1);
+
+        // Draining to the middle band keeps the state; below the low watermark it re-arms
+        while (server.tx_usage() >= 0.5f) {
+            REQUIRE(client.recv().is_ok());
+        }
+        server.check_watermarks();
+        CHECK(lows == 0);
+        while (client.recv().is_ok()) {
+        }
+        server.check_watermarks();
+        CHECK(lows == 1);
+        CHECK_FALSE(server.above_high_watermark());
+
+        wirebit::ShmFlowControl inverted;
+        inverted.high_watermark = 0.2f;
+        inverted.low_watermark = 0.6f;
+        CHECK(server.set_flow_control(inverted).is_err());
+    }
+
+    SUBCASE("send_wait blocks until the receiver makes room") {
+        auto server = std::move(wirebit::ShmLink::create(wirebit::String("test_link_send_wait"), 4096).value());
+        auto client = std::move(wirebit::ShmLink::attach(wirebit::String("test_link_send_wait")).value());
+        std::thread handshake([&]() { CHECK(server.enable_wakeups().is_ok()); });
+        REQUIRE(client.enable_wakeups().is_ok());
+        handshake.join();
+
+        while (!server.send_would_block(frame)) {
+            REQUIRE(server.send(frame).is_ok());
+        }
+        server.set_spin_budget_ns(0);
+
+        auto timed_out = server.send_wait(frame, wirebit::ms_to_ns(20));
+        REQUIRE(timed_out.is_err());
+        CHECK(timed_out.error().code == wirebit::Error::timeout("").code);
+
+        std::thread receiver([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            CHECK(client.recv().is_ok());
+        });
+        uint64_t start = wirebit::wall_ns();
+        auto result = server.send_wait(frame, wirebit::s_to_ns(2.0));
+        uint64_t elapsed = static_cast<uint64_t>(wirebit::wall_ns()) - start;
+        receiver.join();
+
+        REQUIRE(result.is_ok());
+        CHECK(elapsed < static_cast<uint64_t>(wirebit::s_to_ns(1.0)));
+        CHECK(server.stats().send_waits >= 2);
+        CHECK(client.stats().space_wakeups_sent == 1);
+
+        SUBCASE("wait_low_watermark sleeps until the ring drained") {
+            wirebit::ShmFlowControl flow;
+            flow.low_watermark = 0.3f;
+            REQUIRE(server.set_flow_control(flow).is_ok());
+            CHECK(server.above_high_watermark());
+            std::thread drainer([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                while (client.recv().is_ok()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            });
+            REQUIRE(server.wait_low_watermark(wirebit::s_to_ns(2.0)).is_ok());
+            CHECK(server.tx_usage() < 0.3f);
+            CHECK_FALSE(server.above_high_watermark());
+            drainer.join();
+        }
+    }
+
+    SUBCASE("A duplicated frame is sent whole or not at all") {
+        wirebit::LinkModel duplicating(0, 0, 0.0, 1.0, 0.0, 0, 7);
+        auto server = std::move(
+            wirebit::ShmLink::create(wirebit::String("test_link_dup_full"), 4096, &duplicating).value());
+        auto client = std::move(wirebit::ShmLink::attach(wirebit::String("test_link_dup_full")).value());
+
+        // Fill until a send fails: the last attempt finds room for the original only
+        int sent = 0;
+        while (!server.send_would_block(frame)) {
+            if (!server.send(frame).is_ok()) {
+                break;
+            }
+            sent += 2;
+        }
+        CHECK(sent > 0);
+        size_t pending = 0;
+        while (client.recv().is_ok()) {
+            ++pending;
+        }
+        CHECK(pending % 2 == 0); // Never an original without its duplicate
+        CHECK(static_cast<int>(pending) == sent);
+    }
+}
+
+TEST_CASE("ShmLink create_pair links in process memory") {
+    auto created = wirebit::ShmLink::create_pair(wirebit::String("test_link_pair"), 4096);
+    REQUIRE(created.is_ok());
+    auto links = std::move(created.value());
+    CHECK(links.first.tx_capacity() >= 4096);
+    CHECK(links.second.rx_capacity() == links.first.tx_capacity());
+
+    REQUIRE(links.first.send(wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{1})).is_ok());
+    REQUIRE(links.second.send(wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{2})).is_ok());
+    auto at_second = links.second.recv();
+    auto at_first = links.first.recv();
+    REQUIRE(at_second.is_ok());
+    REQUIRE(at_first.is_ok());
+    CHECK(at_second.value().payload[0] == 1);
+    CHECK(at_first.value().payload[0] == 2);
+
+    // No segment was created under the link's name, and blocking waits need eventfds
+    CHECK(wirebit::ShmLink::attach(wirebit::String("test_link_pair")).is_err());
+    CHECK(links.first.enable_wakeups(0).is_err());
+
+    // Either end may go first; the ring memory lives until both are gone
+    { auto gone = std::move(links.first); }
+    CHECK_FALSE(links.second.can_recv());
+    CHECK(links.second.send(wirebit::make_frame(wirebit::FrameType::SERIAL, wirebit::Bytes{3})).is_ok());
+
+    CHECK(wirebit::ShmLink::create_pair(wirebit::String("test_link_pair"), 0).is_err());
+}
@@ -288,6 +288,197 @@ TEST_CASE("SocketCanLink reject non-CAN frame") {
     REQUIRE(send_result.error().code == 1); // invalid_argument error code
 }
 
+TEST_CASE("SocketCanLink batch send and recv") {
+    String iface = make_test_interface();
+    SocketCanConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+    };
+
+    auto result1 = SocketCanLink::create(config);
+    REQUIRE(result1.is_ok());
+    auto result2 = SocketCanLink::attach(iface);
+    REQUIRE(result2.is_ok());
+
+    auto &sender = result1.value();
+    auto &receiver = result2.value();
+
+    // More frames than one sendmmsg/recvmmsg chunk
+    Vector<Frame> frames;
+    for (uint32_t i = 0; i < 40; ++i) {
+        can_frame cf = {};
+        cf.can_id = 0x100 + i;
+        cf.can_dlc = 1;
+        cf.data[0] = static_cast<uint8_t>(i);
+        Bytes payload(sizeof(can_frame));
+        std::memcpy(payload.data(), &cf, sizeof(can_frame));
+        frames.push_back(make_frame(FrameType::CAN, std::move(payload), 1, 0));
+    }
+
+    auto send_result = sender.send_batch(std::span<const Frame>(frames.data(), frames.size()));
+    REQUIRE(send_result.is_ok());
+    REQUIRE(send_result.value() == 40);
+    REQUIRE(sender.stats().frames_sent == 40);
+
+    usleep(5000);
+
+    Vector<Frame> received;
+    auto recv_result = receiver.recv_batch(received, 64);
+    REQUIRE(recv_result.is_ok());
+    REQUIRE(recv_result.value() == 40);
+    REQUIRE(received.size() == 40);
+
+    can_frame last;
+    std::memcpy(&last, received.back().payload.data(), sizeof(can_frame));
+    REQUIRE(last.can_id == 0x100 + 39);
+    REQUIRE(receiver.stats().frames_received == 40);
+
+    // Drained socket reports timeout
+    auto empty_result = receiver.recv_batch(received, 64);
+    REQUIRE(!empty_result.is_ok());
+    REQUIRE(empty_result.error().code == 6);
+}
+
+TEST_CASE("SocketCanLink CAN FD frames") {
+    String iface = make_test_interface();
+    SocketCanConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+        .fd_frames = true,
+    };
+
+    auto result1 = SocketCanLink::create(config);
+    REQUIRE(result1.is_ok());
+    auto result2 = SocketCanLink::create({.interface_name = iface, .create_if_missing = false, .fd_frames = true});
+    REQUIRE(result2.is_ok());
+
+    auto &sender = result1.value();
+    auto &receiver = result2.value();
+
+    uint8_t data[48];
+    for (int i = 0; i < 48; ++i) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+    canfd_frame cf = CanEndpoint::make_fd_frame(0x321, data, 48);
+    Bytes payload(sizeof(canfd_frame));
+    std::memcpy(payload.data(), &cf, sizeof(canfd_frame));
+    REQUIRE(sender.send(make_frame(FrameType::CAN, std::move(payload), 1, 0)).is_ok());
+
+    // Classic frames still pass on an FD socket
+    can_frame classic = CanEndpoint::make_std_frame(0x10, data, 2);
+    Bytes classic_payload(sizeof(can_frame));
+    std::memcpy(classic_payload.data(), &classic, sizeof(can_frame));
+    REQUIRE(sender.send(make_frame(FrameType::CAN, std::move(classic_payload), 1, 0)).is_ok());
+
+    usleep(5000);
+
+    auto fd_result = receiver.recv();
+    REQUIRE(fd_result.is_ok());
+    REQUIRE(fd_result.value().payload.size() == sizeof(canfd_frame));
+    canfd_frame received;
+    std::memcpy(&received, fd_result.value().payload.data(), sizeof(canfd_frame));
+    CHECK(received.can_id == 0x321);
+    CHECK(received.len == 48);
+    CHECK(received.data[47] == 47);
+
+    auto classic_result = receiver.recv();
+    REQUIRE(classic_result.is_ok());
+    CHECK(classic_result.value().payload.size() == sizeof(can_frame));
+
+    SUBCASE("Classic socket rejects FD payloads") {
+        auto classic_link = SocketCanLink::attach(iface);
+        REQUIRE(classic_link.is_ok());
+        Bytes fd_payload(sizeof(canfd_frame));
+        std::memcpy(fd_payload.data(), &cf, sizeof(canfd_frame));
+        auto send_result = classic_link.value().send(make_frame(FrameType::CAN, std::move(fd_payload), 1, 0));
+        REQUIRE(!send_result.is_ok());
+        CHECK(send_result.error().code == 1);
+    }
+}
+
+TEST_CASE("SocketCanLink kernel acceptance filters") {
+    String iface = make_test_interface();
+    SocketCanConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+    };
+
+    auto result1 = SocketCanLink::create(config);
+    REQUIRE(result1.is_ok());
+    Vector<can_filter> filters = {{0x100, 0x7F0}};
+    auto result2 = SocketCanLink::create({.interface_name = iface, .create_if_missing = false, .filters = filters});
+    REQUIRE(result2.is_ok());
+
+    auto &sender = result1.value();
+    auto &receiver = result2.value();
+
+    for (uint32_t id : {0x100U, 0x200U, 0x10FU, 0x110U}) {
+        can_frame cf = CanEndpoint::make_std_frame(id, nullptr, 0);
+        Bytes payload(sizeof(can_frame));
+        std::memcpy(payload.data(), &cf, sizeof(can_frame));
+        REQUIRE(sender.send(make_frame(FrameType::CAN, std::move(payload), 1, 0)).is_ok());
+    }
+
+    usleep(5000);
+
+    // Only 0x100-0x10F match
+    Vector<Frame> received;
+    auto recv_result = receiver.recv_batch(received, 16);
+    REQUIRE(recv_result.is_ok());
+    REQUIRE(received.size() == 2);
+    can_frame first;
+    can_frame second;
+    std::memcpy(&first, received[0].payload.data(), sizeof(can_frame));
+    std::memcpy(&second, received[1].payload.data(), sizeof(can_frame));
+    CHECK(first.can_id == 0x100);
+    CHECK(second.can_id == 0x10F);
+}
+
+TEST_CASE("SocketCanLink kernel RX timestamps") {
+    String iface = make_test_interface();
+    SocketCanConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+    };
+
+    auto result1 = SocketCanLink::create(config);
+    REQUIRE(result1.is_ok());
+    auto result2 =
+        SocketCanLink::create({.interface_name = iface, .create_if_missing = false, .kernel_timestamps = true});
+    REQUIRE(result2.is_ok());
+
+    auto &sender = result1.value();
+    auto &receiver = result2.value();
+    CHECK(sender.timestamp_source() == TimestampSource::None);
+    CHECK(receiver.timestamp_source() != TimestampSource::None);
+
+    uint64_t before = now_ns();
+    for (uint32_t id : {0x1U, 0x2U, 0x3U}) {
+        can_frame cf = CanEndpoint::make_std_frame(id, nullptr, 0);
+        Bytes payload(sizeof(can_frame));
+        std::memcpy(payload.data(), &cf, sizeof(can_frame));
+        REQUIRE(sender.send(make_frame(FrameType::CAN, std::move(payload), 1, 0)).is_ok());
+    }
+    usleep(5000);
+
+    // Stamped on arrival in the kernel, not when recv() ran
+    auto single = receiver.recv();
+    REQUIRE(single.is_ok());
+    uint64_t after_recv = now_ns();
+    CHECK(single.value().header.tx_timestamp_ns >= before);
+    CHECK(single.value().header.tx_timestamp_ns + 4000000 < after_recv);
+
+    Vector<Frame> batch;
+    REQUIRE(receiver.recv_batch(batch, 8).is_ok());
+    REQUIRE(batch.size() == 2);
+    CHECK(batch[0].header.tx_timestamp_ns >= single.value().header.tx_timestamp_ns);
+    CHECK(receiver.stats().sw_timestamps + receiver.stats().hw_timestamps == 3);
+}
+
 #else // NO_HARDWARE
 
 TEST_CASE("SocketCanLink requires hardware support") {
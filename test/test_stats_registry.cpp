@@ -0,0 +1,126 @@
+#include <doctest/doctest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    const LinkStatsSnapshot *find(const Vector<LinkStatsSnapshot> &links, const char *name) {
+        for (const auto &s : links) {
+            if (s.name == String(name)) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+} // namespace
+
+TEST_CASE("StatsRegistry slots") {
+    StatsRegistry::unlink("/test_stats_slots");
+    auto registry = StatsRegistry::open("/test_stats_slots", 2);
+    REQUIRE(registry.is_ok());
+    CHECK(registry.value().slot_count() == 2);
+    CHECK(registry.value().live_count() == 0);
+
+    SUBCASE("Writer updates are visible through a second mapping") {
+        auto slot = registry.value().claim("counter_link", "test");
+        REQUIRE(slot.is_ok());
+        slot.value().sent(100);
+        slot.value().sent(20);
+        slot.value().add(LinkCounter::FramesDropped, 3);
+        slot.value().queues(10, 4096, 0, 0);
+
+        auto reader = StatsRegistry::open("/test_stats_slots");
+        REQUIRE(reader.is_ok());
+        auto links = reader.value().snapshot();
+        REQUIRE(links.size() == 1);
+        CHECK(links[0].name == String("counter_link"));
+        CHECK(links[0].kind == String("test"));
+        CHECK(links[0].pid == static_cast<int>(getpid()));
+        CHECK(links[0].get(LinkCounter::FramesSent) == 2);
+        CHECK(links[0].get(LinkCounter::BytesSent) == 120);
+        CHECK(links[0].get(LinkCounter::FramesDropped) == 3);
+        CHECK(links[0].get(LinkCounter::RxQueuedBytes) == 10);
+        CHECK(links[0].get(LinkCounter::RxCapacityBytes) == 4096);
+
+        slot.value().release();
+        CHECK_FALSE(slot.value().active());
+        CHECK(reader.value().snapshot().empty());
+    }
+
+    SUBCASE("Full registry and inactive handles") {
+        auto a = registry.value().claim("a", "test");
+        auto b = registry.value().claim("b", "test");
+        REQUIRE(a.is_ok());
+        REQUIRE(b.is_ok());
+        CHECK_FALSE(registry.value().claim("c", "test").is_ok());
+
+        StatsSlot inactive;
+        inactive.sent(1); // No-op
+        CHECK_FALSE(inactive.active());
+    }
+
+    SUBCASE("Slots of exited processes are reclaimed") {
+        pid_t child = fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            auto r = StatsRegistry::open("/test_stats_slots");
+            auto slot = r.value().claim("orphan", "test");
+            slot.value().sent(1);
+            _exit(0); // Exits without releasing the slot
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        CHECK(registry.value().live_count() == 1); // Still marked live...
+        CHECK(registry.value().snapshot().empty()); // ...but hidden from monitors
+        auto a = registry.value().claim("a", "test");
+        auto b = registry.value().claim("b", "test");
+        CHECK(a.is_ok());
+        CHECK(b.is_ok());
+    }
+
+    StatsRegistry::unlink("/test_stats_slots");
+}
+
+TEST_CASE("Link stats export") {
+    StatsRegistry::unlink("/test_stats_links");
+    auto registry = StatsRegistry::open("/test_stats_links", 16);
+    REQUIRE(registry.is_ok());
+
+    auto server = ShmLink::create("test_stats_shm", 8192);
+    REQUIRE(server.is_ok());
+    auto client = ShmLink::attach("test_stats_shm");
+    REQUIRE(client.is_ok());
+    CHECK_FALSE(server.value().stats_exported());
+    REQUIRE(server.value().export_stats(registry.value(), "shm").is_ok());
+    REQUIRE(client.value().export_stats(registry.value(), "shm").is_ok());
+    CHECK(server.value().stats_exported());
+
+    Frame frame = make_frame(FrameType::SERIAL, Bytes{1, 2, 3, 4}, 1, 2);
+    REQUIRE(server.value().send(frame).is_ok());
+    REQUIRE(server.value().send(frame).is_ok());
+    REQUIRE(client.value().recv().is_ok());
+
+    auto links = registry.value().snapshot();
+    REQUIRE(links.size() == 2);
+    const LinkStatsSnapshot *tx = find(links, "test_stats_shm");
+    REQUIRE(tx != nullptr);
+    // Both ends are named after the link; the sender is the one that sent
+    const LinkStatsSnapshot &sender = links[0].get(LinkCounter::FramesSent) == 2 ? links[0] : links[1];
+    const LinkStatsSnapshot &receiver = &sender == &links[0] ? links[1] : links[0];
+    CHECK(sender.kind == String("shm"));
+    CHECK(sender.get(LinkCounter::FramesSent) == server.value().stats().frames_sent);
+    CHECK(sender.get(LinkCounter::BytesSent) == server.value().stats().bytes_sent);
+    CHECK(receiver.get(LinkCounter::FramesReceived) == 1);
+    CHECK(receiver.get(LinkCounter::BytesReceived) == frame.total_size());
+    // One frame still in flight from the receiver's point of view
+    CHECK(receiver.get(LinkCounter::RxQueuedBytes) > 0);
+    CHECK(receiver.get(LinkCounter::RxCapacityBytes) >= 8192);
+
+    client.value().stop_export_stats();
+    CHECK(registry.value().snapshot().size() == 1);
+
+    StatsRegistry::unlink("/test_stats_links");
+}
@@ -0,0 +1,439 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+#ifndef NO_HARDWARE
+#include <unistd.h>
+#endif
+
+using namespace wirebit;
+
+namespace {
+    Bytes encoded(uint32_t src, Bytes payload, Bytes meta = {}) {
+        Frame frame = make_frame(FrameType::SERIAL, payload, src, 0);
+        frame.meta = meta;
+        frame.header.meta_len = static_cast<uint32_t>(meta.size());
+        return encode_frame(frame);
+    }
+
+    void append(Bytes &out, const Bytes &data) { out.insert(out.end(), data.begin(), data.end()); }
+} // namespace
+
+TEST_CASE("StreamDecoder") {
+    StreamDecoder decoder;
+    FrameView frame;
+
+    SUBCASE("Emits every complete frame from one feed") {
+        Bytes stream;
+        for (uint32_t i = 1; i <= 5; ++i) {
+            append(stream, encoded(i, Bytes{static_cast<Byte>(i), 0x55}, Bytes{0xEE}));
+        }
+        decoder.feed(stream.data(), stream.size());
+
+        for (uint32_t i = 1; i <= 5; ++i) {
+            REQUIRE(decoder.next(frame));
+            uint32_t src = frame.header.src_endpoint_id;
+            CHECK(src == i);
+            REQUIRE(frame.payload.size() == 2);
+            CHECK(frame.payload[0] == static_cast<Byte>(i));
+            REQUIRE(frame.meta.size() == 1);
+            CHECK(frame.meta[0] == 0xEE);
+        }
+        CHECK_FALSE(decoder.next(frame));
+        CHECK(decoder.buffered() == 0);
+        CHECK(decoder.stats().frames == 5);
+        CHECK(decoder.stats().resyncs == 0);
+    }
+
+    SUBCASE("Reassembles frames split across reads") {
+        Bytes stream = encoded(7, Bytes{1, 2, 3, 4, 5, 6, 7, 8});
+        for (size_t i = 0; i + 1 < stream.size(); ++i) {
+            decoder.feed(stream.data() + i, 1);
+            CHECK_FALSE(decoder.next(frame));
+        }
+        decoder.feed(stream.data() + stream.size() - 1, 1);
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.payload.size() == 8);
+        CHECK(decoder.stats().bytes_skipped == 0);
+    }
+
+    SUBCASE("Resyncs past line noise in one call") {
+        Bytes stream;
+        for (int i = 0; i < 1000; ++i) {
+            stream.push_back(static_cast<Byte>(i * 7)); // includes 'T' (0x54) bytes that are not a magic
+        }
+        stream.push_back(0x54); // partial magic
+        stream.push_back(0x49);
+        append(stream, encoded(1, Bytes{0xAB}));
+        size_t noise = stream.size() - sizeof(FrameHeader) - 1;
+
+        decoder.feed(stream.data(), stream.size());
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.payload[0] == 0xAB);
+        CHECK(decoder.stats().bytes_skipped == noise);
+        CHECK(decoder.stats().resyncs == 1);
+    }
+
+    SUBCASE("Keeps a partial magic at the end of the buffer") {
+        Bytes stream = encoded(2, Bytes{0x42});
+        Bytes noise = {0x00, 0x11, 0x22};
+        decoder.feed(noise.data(), noise.size());
+        decoder.feed(stream.data(), 3);
+        CHECK_FALSE(decoder.next(frame));
+        CHECK(decoder.buffered() == 3); // noise dropped, "TIB" kept
+        decoder.feed(stream.data() + 3, stream.size() - 3);
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.payload[0] == 0x42);
+    }
+
+    SUBCASE("Treats a magic with implausible lengths as noise") {
+        StreamDecoder small(64);
+        Bytes bogus = encoded(3, Bytes(100));
+        Bytes good = encoded(4, Bytes{0x01});
+        Bytes stream = bogus;
+        stream.resize(sizeof(FrameHeader)); // header claims 100 bytes, then the stream moves on
+        append(stream, good);
+
+        small.feed(stream.data(), stream.size());
+        REQUIRE(small.next(frame));
+        uint32_t src = frame.header.src_endpoint_id;
+        CHECK(src == 4);
+        CHECK(small.stats().bad_headers == 1);
+    }
+
+    SUBCASE("Verifies frame checksums") {
+        Frame good = make_frame(FrameType::SERIAL, Bytes{0x01, 0x02}, 1, 0);
+        add_frame_checksum(good);
+        Bytes corrupt = encode_frame(good);
+        corrupt[sizeof(FrameHeader)] ^= 0xFF;
+
+        Bytes stream = corrupt;
+        append(stream, encode_frame(good));
+        decoder.feed(stream.data(), stream.size());
+
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.payload[0] == 0x01);
+        CHECK(frame.meta.empty()); // trailer removed
+        CHECK_FALSE(decoder.next(frame));
+        CHECK(decoder.stats().bad_checksums == 1);
+        CHECK(decoder.stats().frames == 1);
+    }
+
+    SUBCASE("Views from one read stay valid across next()") {
+        Bytes stream;
+        append(stream, encoded(1, Bytes{0x10}));
+        append(stream, encoded(2, Bytes{0x20}));
+        decoder.feed(stream.data(), stream.size());
+
+        FrameView first, second;
+        REQUIRE(decoder.next(first));
+        REQUIRE(decoder.next(second));
+        CHECK(first.payload[0] == 0x10);
+        CHECK(second.payload[0] == 0x20);
+    }
+
+    SUBCASE("Reuses its buffer in a steady stream") {
+        Bytes one = encoded(1, Bytes(200));
+        for (int i = 0; i < 1000; ++i) {
+            auto space = decoder.write_space(one.size());
+            std::memcpy(space.data(), one.data(), one.size());
+            decoder.commit(one.size());
+            REQUIRE(decoder.next(frame));
+        }
+        CHECK(decoder.buffered() == 0);
+        CHECK(decoder.stats().frames == 1000);
+    }
+
+    SUBCASE("Accepts compact v2 headers") {
+        Frame compact = make_frame(FrameType::CAN, Bytes{0x31, 0x32}, 5, 6);
+        compact.set_meta(Bytes{0x77});
+        Bytes v2 = encode_frame(compact, FRAME_HEADER_V2);
+        Bytes noise = {0x54, 0x49, 0x42, 0x57, 0x02, 0x00, 0xFF}; // v2 magic with bad presence bits
+
+        Bytes stream = encoded(1, Bytes{0x10});
+        append(stream, noise);
+        append(stream, v2);
+        size_t split = stream.size() - v2.size() + 8; // Inside the v2 header
+        append(stream, encoded(2, Bytes{0x20}));
+
+        decoder.feed(stream.data(), split);
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.payload[0] == 0x10);
+        CHECK_FALSE(decoder.next(frame)); // A partial v2 header waits for more input
+        decoder.feed(stream.data() + split, stream.size() - split);
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.type() == FrameType::CAN);
+        uint64_t ts = frame.header.tx_timestamp_ns;
+        uint64_t sent_ts = compact.header.tx_timestamp_ns;
+        uint32_t dst = frame.header.dst_endpoint_id;
+        CHECK(ts == sent_ts);
+        CHECK(dst == 6);
+        CHECK(frame.payload.size() == 2);
+        CHECK(frame.meta.size() == 1);
+        REQUIRE(decoder.next(frame));
+        CHECK(frame.payload[0] == 0x20);
+        CHECK(decoder.stats().bad_headers == 1);
+    }
+}
+
+TEST_CASE("COBS and SLIP codecs") {
+    auto cobs_round_trip = [](const Bytes &in) {
+        Bytes out(cobs_max_encoded_size(in.size()));
+        size_t n = cobs_encode(in, out.data());
+        out.resize(n);
+        bool no_zeros = std::find(out.begin(), out.end(), Byte{0}) == out.end();
+        size_t len = 0;
+        bool ok = cobs_decode(out, out.data(), len); // in place
+        out.resize(len);
+        return no_zeros && ok && out == in;
+    };
+
+    SUBCASE("COBS reference vectors") {
+        Bytes out(16);
+        Bytes in = {0x11, 0x22, 0x00, 0x33};
+        REQUIRE(cobs_encode(in, out.data()) == 5);
+        out.resize(5);
+        CHECK(out == Bytes{0x03, 0x11, 0x22, 0x02, 0x33});
+        out.resize(16);
+        REQUIRE(cobs_encode(Bytes{0x00}, out.data()) == 2);
+        CHECK(out[0] == 0x01);
+        CHECK(out[1] == 0x01);
+    }
+
+    SUBCASE("COBS round trips") {
+        CHECK(cobs_round_trip(Bytes{}));
+        CHECK(cobs_round_trip(Bytes{0, 0, 0}));
+        for (size_t n : {253, 254, 255, 508, 1000}) {
+            Bytes in(n);
+            for (size_t i = 0; i < n; ++i) {
+                in[i] = static_cast<Byte>(1 + i % 255);
+            }
+            CHECK(cobs_round_trip(in));
+            in[n / 2] = 0;
+            CHECK(cobs_round_trip(in));
+        }
+    }
+
+    SUBCASE("COBS rejects malformed packets") {
+        size_t len = 0;
+        Byte out[8];
+        CHECK_FALSE(cobs_decode(Bytes{0x05, 0x11, 0x22}, out, len)); // code runs past the end
+        CHECK_FALSE(cobs_decode(Bytes{0x03, 0x11, 0x00}, out, len)); // zero inside
+    }
+
+    SUBCASE("SLIP escapes its special bytes") {
+        Bytes in = {0x01, SLIP_END, 0x02, SLIP_ESC, 0x03};
+        Bytes out(slip_max_encoded_size(in.size()));
+        size_t n = slip_encode(in, out.data());
+        out.resize(n);
+        CHECK(out == Bytes{0x01, SLIP_ESC, SLIP_ESC_END, 0x02, SLIP_ESC, SLIP_ESC_ESC, 0x03});
+        size_t len = 0;
+        REQUIRE(slip_decode(out, out.data(), len));
+        out.resize(len);
+        CHECK(out == in);
+        CHECK_FALSE(slip_decode(Bytes{0x01, SLIP_ESC, 0x02}, out.data(), len));
+    }
+}
+
+TEST_CASE("StreamDecoder with COBS/SLIP packets") {
+    auto packet = [](StreamFraming framing, FrameType type, const Bytes &payload, bool compact, bool checksum) {
+        Bytes out(max_packet_size(framing, payload.size()));
+        out.resize(encode_packet(make_view(type, payload), framing, compact, checksum, out.data()));
+        return out;
+    };
+    FrameView frame;
+
+    SUBCASE("A small message costs a few bytes") {
+        Bytes cobs = packet(StreamFraming::Cobs, FrameType::SERIAL, Bytes{1, 2, 3, 4}, true, false);
+        CHECK(cobs.size() == 8); // code + type + length + 4 bytes + delimiter
+        CHECK(cobs.back() == COBS_DELIMITER);
+        Bytes bare = packet(StreamFraming::Slip, FrameType::SERIAL, Bytes{1, 2, 3, 4}, false, false);
+        CHECK(bare.size() == 5);
+        CHECK(sizeof(FrameHeader) + 4 == 48);
+    }
+
+    for (StreamFraming framing : {StreamFraming::Cobs, StreamFraming::Slip}) {
+        // Type and payload, fed one byte at a time
+        StreamDecoder decoder(1 << 20, framing);
+        Bytes stream = packet(framing, FrameType::CAN, Bytes{0x00, 0xC0, 0xDB, 0x7F}, true, true);
+        append(stream, packet(framing, FrameType::SERIAL, Bytes(300, 0x00), true, false));
+        Vector<Frame> frames;
+        for (Byte b : stream) {
+            decoder.feed(&b, 1);
+            if (decoder.next(frame)) {
+                frames.push_back(to_frame(frame));
+            }
+        }
+        REQUIRE(frames.size() == 2);
+        CHECK(frames[0].type() == FrameType::CAN);
+        CHECK(frames[0].payload == Bytes{0x00, 0xC0, 0xDB, 0x7F});
+        CHECK(frames[1].type() == FrameType::SERIAL);
+        CHECK(frames[1].payload == Bytes(300, 0x00));
+        CHECK(decoder.buffered() == 0);
+
+        // Corruption costs one packet: decoding resumes after the next delimiter
+        StreamDecoder resync(1 << 20, framing);
+        Bytes first = packet(framing, FrameType::SERIAL, Bytes{1, 2, 3}, true, true);
+        Bytes second = packet(framing, FrameType::SERIAL, Bytes{4, 5, 6}, true, true);
+        first[2] ^= 0x40;
+        stream = {0x11, 0x22}; // line noise before the delimiter of a lost packet
+        stream.push_back(framing == StreamFraming::Slip ? SLIP_END : COBS_DELIMITER);
+        append(stream, first);
+        append(stream, second);
+        resync.feed(stream.data(), stream.size());
+        REQUIRE(resync.next(frame));
+        CHECK(frame.payload[0] == 4);
+        CHECK_FALSE(resync.next(frame));
+        CHECK(resync.stats().frames == 1);
+        CHECK(resync.stats().bad_headers + resync.stats().bad_checksums == 2);
+        CHECK(resync.stats().bytes_skipped == 3 + first.size());
+
+        // Bare payload packets with a configured checksum
+        StreamDecoder bare(1 << 20, framing, false, true);
+        stream = packet(framing, FrameType::SERIAL, Bytes{9, 8, 7}, false, true);
+        bare.feed(stream.data(), stream.size());
+        REQUIRE(bare.next(frame));
+        CHECK(frame.type() == FrameType::SERIAL);
+        CHECK(frame.payload.size() == 3);
+    }
+}
+
+#ifndef NO_HARDWARE
+TEST_CASE("TtyLink framed mode over a PTY") {
+    PtyLink pty = PtyLink::create().value();
+
+    TtyConfig config;
+    config.device = pty.slave_path();
+    config.framed = true;
+    auto tty_result = TtyLink::create(config);
+    REQUIRE(tty_result.is_ok());
+    auto &tty = tty_result.value();
+
+    // PTY -> TTY, with noise on the line between the frames
+    REQUIRE(pty.send(make_frame(FrameType::SERIAL, Bytes{0x01, 0x02}, 1, 0)).is_ok());
+    Bytes noise = {0x54, 0x00, 0x54, 0x49, 0xFF};
+    ssize_t w = write(pty.master_fd(), noise.data(), noise.size());
+    (void)w;
+    REQUIRE(pty.send(make_frame(FrameType::SERIAL, Bytes{0x03}, 2, 0)).is_ok());
+    usleep(5000);
+
+    auto first = tty.recv_view();
+    REQUIRE(first.is_ok());
+    CHECK(first.value().payload.size() == 2);
+    auto second = tty.recv_view();
+    REQUIRE(second.is_ok());
+    CHECK(second.value().payload[0] == 0x03);
+    CHECK(tty.decoder_stats().bytes_skipped == noise.size());
+
+    // TTY -> PTY
+    REQUIRE(tty.send(make_frame(FrameType::SERIAL, Bytes{0x0A, 0x0D, 0x0A}, 3, 0)).is_ok());
+    usleep(5000);
+    auto back = pty.recv();
+    REQUIRE(back.is_ok());
+    CHECK(back.value().payload == Bytes{0x0A, 0x0D, 0x0A});
+}
+
+TEST_CASE("Checksummed frames between TtyLink and PtyLink") {
+    PtyConfig pty_config;
+    pty_config.checksum = true;
+    PtyLink pty = PtyLink::create(pty_config).value();
+
+    TtyConfig config;
+    config.device = pty.slave_path();
+    config.framed = true;
+    config.checksum = true;
+    auto tty_result = TtyLink::create(config);
+    REQUIRE(tty_result.is_ok());
+    auto &tty = tty_result.value();
+
+    Frame frame = make_frame(FrameType::SERIAL, Bytes{0x10, 0x20}, 1, 0);
+    frame.set_meta(Bytes{0x99});
+    REQUIRE(pty.send(frame).is_ok());
+    REQUIRE(tty.send(frame).is_ok());
+    usleep(5000);
+
+    auto at_tty = tty.recv_view();
+    REQUIRE(at_tty.is_ok());
+    CHECK(at_tty.value().payload.size() == 2);
+    REQUIRE(at_tty.value().meta.size() == 1); // trailer verified and removed
+    CHECK(at_tty.value().meta[0] == 0x99);
+
+    auto at_pty = pty.recv_view();
+    REQUIRE(at_pty.is_ok());
+    REQUIRE(at_pty.value().meta.size() == 1);
+    CHECK(pty.decoder_stats().bad_checksums == 0);
+}
+
+TEST_CASE("Compact v2 headers between TtyLink and PtyLink") {
+    PtyConfig pty_config;
+    pty_config.header_version = FRAME_HEADER_V2;
+    pty_config.checksum = true;
+    PtyLink pty = PtyLink::create(pty_config).value();
+
+    TtyConfig config;
+    config.device = pty.slave_path();
+    config.framed = true;
+    config.header_version = FRAME_HEADER_V2;
+    auto tty_result = TtyLink::create(config);
+    REQUIRE(tty_result.is_ok());
+    auto &tty = tty_result.value();
+
+    Frame frame = make_frame(FrameType::CAN, Bytes(16, 0x42), 9, 0);
+    REQUIRE(pty.send(frame).is_ok());
+    REQUIRE(tty.send(frame).is_ok());
+    usleep(5000);
+
+    auto at_tty = tty.recv_view();
+    REQUIRE(at_tty.is_ok());
+    CHECK(at_tty.value().type() == FrameType::CAN);
+    CHECK(at_tty.value().payload.size() == 16);
+    CHECK(at_tty.value().meta.empty()); // checksum verified and removed
+    uint32_t src = at_tty.value().header.src_endpoint_id;
+    CHECK(src == 9);
+    // 9 fixed bytes, 9-byte absolute timestamp, source, flags and meta_len (the checksum trailer)
+    CHECK(tty.stats().bytes_received == 21 + 16 + FRAME_CHECKSUM_LEN);
+
+    auto at_pty = pty.recv_view();
+    REQUIRE(at_pty.is_ok());
+    uint64_t ts = at_pty.value().header.tx_timestamp_ns;
+    uint64_t sent_ts = frame.header.tx_timestamp_ns;
+    CHECK(ts == sent_ts);
+}
+
+TEST_CASE("COBS and SLIP framing between TtyLink and PtyLink") {
+    for (StreamFraming framing : {StreamFraming::Cobs, StreamFraming::Slip}) {
+        PtyConfig pty_config;
+        pty_config.framing = framing;
+        pty_config.checksum = true;
+        PtyLink pty = PtyLink::create(pty_config).value();
+
+        TtyConfig config;
+        config.device = pty.slave_path();
+        config.framed = true;
+        config.framing = framing;
+        auto tty_result = TtyLink::create(config);
+        REQUIRE(tty_result.is_ok());
+        auto &tty = tty_result.value();
+
+        REQUIRE(pty.send(make_frame(FrameType::SERIAL, Bytes{0x00, 0xC0, 0x01})).is_ok());
+        Bytes noise = {0x00, 0xC0, 0x55, 0xDB, framing == StreamFraming::Slip ? SLIP_END : COBS_DELIMITER};
+        ssize_t w = write(pty.master_fd(), noise.data(), noise.size());
+        (void)w;
+        REQUIRE(pty.send(make_frame(FrameType::SERIAL, Bytes{0x02})).is_ok());
+        usleep(5000);
+
+        auto first = tty.recv();
+        REQUIRE(first.is_ok());
+        CHECK(first.value().payload == Bytes{0x00, 0xC0, 0x01});
+        auto second = tty.recv();
+        REQUIRE(second.is_ok());
+        CHECK(second.value().payload == Bytes{0x02});
+        CHECK(tty.stats().bytes_received < 2 * sizeof(FrameHeader));
+
+        REQUIRE(tty.send(make_frame(FrameType::SERIAL, Bytes{0xDB, 0xDC})).is_ok());
+        usleep(5000);
+        auto back = pty.recv();
+        REQUIRE(back.is_ok());
+        CHECK(back.value().payload == Bytes{0xDB, 0xDC});
+    }
+}
+#endif
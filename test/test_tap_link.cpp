@@ -94,6 +94,102 @@ TEST_CASE("TapLink send and recv loopback") {
     REQUIRE(link.stats().bytes_sent >= eth_frame.size());
 }
 
+TEST_CASE("TapLink with io_uring backend") {
+    String iface = make_tap_test_interface();
+    TapConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+        .set_up_on_create = true,
+        .use_io_uring = true,
+        .io_uring_entries = 32,
+    };
+
+    auto result = TapLink::create(config);
+    REQUIRE(result.is_ok());
+
+    auto &link = result.value();
+    if (!link.io_uring_enabled()) {
+        MESSAGE("io_uring unavailable, TapLink fell back to read/write");
+    }
+
+    MacAddr src_mac = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    Bytes eth_frame = make_eth_frame(MAC_BROADCAST, src_mac, ETH_P_IP, Bytes{0x01, 0x02, 0x03, 0x04});
+
+    Vector<Frame> frames;
+    for (int i = 0; i < 4; ++i) {
+        frames.push_back(make_frame(FrameType::ETHERNET, eth_frame, 1, 0));
+    }
+    auto sent = link.send_batch(std::span<const Frame>(frames.data(), frames.size()));
+    REQUIRE(sent.is_ok());
+    REQUIRE(sent.value() == 4);
+    REQUIRE(link.stats().frames_sent == 4);
+    REQUIRE(link.flush().is_ok());
+    if (link.io_uring_enabled()) {
+        REQUIRE(link.io_uring_stats().tx_submitted == 4);
+    }
+}
+
+TEST_CASE("TapLink multi-queue interface") {
+    String iface = make_tap_test_interface();
+    TapConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+        .set_up_on_create = true,
+        .queues = 4,
+    };
+
+    auto result = TapLink::create_queues(config);
+    REQUIRE(result.is_ok());
+
+    auto &queues = result.value();
+    REQUIRE(queues.size() == 4);
+
+    // Every queue is its own fd on the same interface
+    for (size_t q = 0; q < queues.size(); ++q) {
+        auto &link = static_cast<TapLink &>(queues.queue(q));
+        REQUIRE(link.tap_fd() >= 0);
+        REQUIRE(link.interface_name() == iface);
+    }
+    REQUIRE(static_cast<TapLink &>(queues.queue(0)).tap_fd() != static_cast<TapLink &>(queues.queue(1)).tap_fd());
+
+    MacAddr src_mac = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    Frame frame = make_frame(FrameType::ETHERNET, make_eth_frame(MAC_BROADCAST, src_mac, ETH_P_IP, Bytes{0x01}), 1, 0);
+    REQUIRE(queues.queue_for(7).send(frame).is_ok());
+
+    CHECK_FALSE(TapLink::create_queues({.interface_name = iface, .queues = 0}).is_ok());
+}
+
+TEST_CASE("TapLink vnet header mode") {
+    String iface = make_tap_test_interface();
+    TapConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+        .set_up_on_create = true,
+        .vnet_hdr = true,
+    };
+
+    auto result = TapLink::create(config);
+    REQUIRE(result.is_ok());
+
+    auto &link = result.value();
+
+    // Offload metadata travels in Frame::meta; bytes_sent counts only the L2 frame
+    MacAddr src_mac = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    Bytes eth_frame = make_eth_frame(MAC_BROADCAST, src_mac, ETH_P_IP, Bytes(46));
+    Frame frame = make_frame(FrameType::ETHERNET, eth_frame, 1, 0);
+    frame.set_meta(vnet_meta(VnetHeader{}));
+    REQUIRE(link.send(frame).is_ok());
+    REQUIRE(link.stats().bytes_sent == eth_frame.size());
+
+    // Frames without metadata are written with a no-offload header
+    Frame plain = make_frame(FrameType::ETHERNET, eth_frame, 1, 0);
+    REQUIRE(link.send(plain).is_ok());
+    REQUIRE(link.stats().frames_sent == 2);
+}
+
 TEST_CASE("TapLink recv with no data") {
     String iface = make_tap_test_interface();
     TapConfig config{
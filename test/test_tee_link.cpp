@@ -0,0 +1,141 @@
+#include <atomic>
+#include <doctest/doctest.h>
+#include <memory>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+TEST_CASE("ObserverQueue") {
+    auto queue = ObserverQueue::create({.name = "test", .queue_bytes = 4096});
+    REQUIRE(queue.is_ok());
+    auto &q = queue.value();
+
+    SUBCASE("Merges both directions in capture order") {
+        Frame sent = make_frame(FrameType::CAN, Bytes{1, 2, 3}, 4, 5);
+        sent.meta = Bytes{9, 9};
+        CHECK(q.push(make_view(make_frame(FrameType::SERIAL, Bytes{'a'})), CaptureDirection::Inbound, 100));
+        CHECK(q.push(make_view(sent), CaptureDirection::Outbound, 50));
+        CHECK(q.push(make_view(make_frame(FrameType::SERIAL, Bytes{'b'})), CaptureDirection::Inbound, 200));
+
+        Vector<TimeNs> times;
+        Vector<CaptureDirection> directions;
+        size_t taken = q.drain([&](const ObservedFrame &frame) {
+            times.push_back(frame.capture_ns);
+            directions.push_back(frame.direction);
+            if (frame.direction == CaptureDirection::Outbound) {
+                CHECK(frame.frame.header.src_endpoint_id == 4);
+                CHECK(frame.frame.header.meta_len == 2);
+                CHECK(Bytes(frame.frame.meta.begin(), frame.frame.meta.end()) == Bytes{9, 9});
+                CHECK(Bytes(frame.frame.payload.begin(), frame.frame.payload.end()) == Bytes{1, 2, 3});
+            }
+        });
+        CHECK(taken == 3);
+        CHECK(times == Vector<TimeNs>{50, 100, 200});
+        CHECK(directions == Vector<CaptureDirection>{CaptureDirection::Outbound, CaptureDirection::Inbound,
+                                                    CaptureDirection::Inbound});
+        CHECK(q.empty());
+        CHECK(q.peek().is_err());
+        CHECK(q.stats().frames_queued == 3);
+    }
+
+    SUBCASE("Drops when full and after close") {
+        Frame frame = make_frame(FrameType::SERIAL, Bytes(100, 0x55));
+        size_t queued = 0;
+        for (int i = 0; i < 100; ++i) {
+            queued += q.push(make_view(frame), CaptureDirection::Outbound, i) ? 1 : 0;
+        }
+        CHECK(queued > 0);
+        CHECK(queued < 100);
+        CHECK(q.stats().frames_queued == queued);
+        CHECK(q.stats().frames_dropped == 100 - queued);
+
+        q.close();
+        CHECK_FALSE(q.push(make_view(frame), CaptureDirection::Inbound, 1000));
+        CHECK(q.drain([](const ObservedFrame &) {}) == queued); // Queued frames stay readable
+        q.reset_stats();
+        CHECK(q.stats().frames_dropped == 0);
+    }
+}
+
+TEST_CASE("TeeLink") {
+    auto server = ShmLink::create("test_tee_link", 64 * 1024);
+    REQUIRE(server.is_ok());
+    auto client = ShmLink::attach("test_tee_link");
+    REQUIRE(client.is_ok());
+    auto tee = TeeLink::create(std::make_shared<ShmLink>(std::move(server.value())));
+    REQUIRE(tee.is_ok());
+    auto &link = tee.value();
+
+    SUBCASE("Fans out to every observer by direction") {
+        auto all = link.add_observer({.name = "all"});
+        auto rx_only = link.add_observer({.name = "rx", .tx = false});
+        REQUIRE(all.is_ok());
+        REQUIRE(rx_only.is_ok());
+        CHECK(link.observer_count() == 2);
+
+        REQUIRE(link.send(make_frame(FrameType::CAN, Bytes(16, 1))).is_ok());
+        REQUIRE(link.send_view(make_view(FrameType::CAN, Bytes(16, 2))).is_ok());
+        REQUIRE(client.value().send(make_frame(FrameType::CAN, Bytes(16, 3))).is_ok());
+        auto received = link.recv_view();
+        REQUIRE(received.is_ok());
+        CHECK(received.value().payload[0] == 3);
+
+        CHECK(all.value()->stats().frames_queued == 3);
+        CHECK(rx_only.value()->stats().frames_queued == 1);
+        Bytes first_bytes;
+        all.value()->drain([&](const ObservedFrame &frame) { first_bytes.push_back(frame.frame.payload[0]); });
+        CHECK(first_bytes == Bytes{1, 2, 3});
+        auto inbound = rx_only.value()->peek();
+        REQUIRE(inbound.is_ok());
+        CHECK(inbound.value().direction == CaptureDirection::Inbound);
+    }
+
+    SUBCASE("A stalled observer never blocks the link") {
+        auto slow = link.add_observer({.name = "slow", .queue_bytes = 512});
+        auto fast = link.add_observer({.name = "fast"});
+        REQUIRE(slow.is_ok());
+        REQUIRE(fast.is_ok());
+
+        std::atomic<bool> done{false};
+        std::atomic<size_t> seen{0};
+        std::thread reader([&]() {
+            while (!done.load() || !fast.value()->empty()) {
+                seen += fast.value()->drain([](const ObservedFrame &) {});
+                std::this_thread::yield();
+            }
+        });
+
+        size_t sent = 0;
+        for (int i = 0; i < 200; ++i) {
+            if (link.send(make_frame(FrameType::SERIAL, Bytes(32, static_cast<Byte>(i)))).is_ok()) {
+                ++sent;
+            }
+            while (client.value().recv().is_ok()) {
+            }
+        }
+        done = true;
+        reader.join();
+
+        CHECK(sent == 200);
+        CHECK(slow.value()->stats().frames_dropped > 0);
+        CHECK(seen.load() + fast.value()->stats().frames_dropped == 200);
+        CHECK(link.frames_dropped() ==
+              slow.value()->stats().frames_dropped + fast.value()->stats().frames_dropped);
+    }
+
+    SUBCASE("Closed observers stop receiving; slots are bounded") {
+        auto observer = link.add_observer();
+        REQUIRE(observer.is_ok());
+        observer.value()->close();
+        REQUIRE(link.send(make_frame(FrameType::SERIAL, Bytes{1})).is_ok());
+        CHECK(observer.value()->stats().frames_queued == 0);
+
+        while (link.observer_count() < TeeLink::MAX_OBSERVERS) {
+            REQUIRE(link.add_observer({.queue_bytes = 256}).is_ok());
+        }
+        CHECK(link.add_observer().is_err());
+    }
+
+    CHECK(TeeLink::create(nullptr).is_err());
+}
@@ -0,0 +1,95 @@
+#include <doctest/doctest.h>
+
+#ifndef NO_HARDWARE
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+
+    /// Bind a UDP socket to an ephemeral loopback port
+    int bind_loopback(struct sockaddr_in &addr) {
+        int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+            ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+} // namespace
+
+TEST_CASE("Kernel RX timestamps from recvmsg control data") {
+    struct sockaddr_in addr;
+    int fd = bind_loopback(addr);
+    if (fd < 0) {
+        MESSAGE("No loopback UDP socket available");
+        return;
+    }
+
+    auto enabled = detail::enable_timestamping(fd, "lo", false);
+    REQUIRE(enabled.is_ok());
+    CHECK(enabled.value() == TimestampSource::Software);
+
+    uint64_t before = now_ns();
+    const char ping[] = "ping";
+    REQUIRE(::sendto(fd, ping, sizeof(ping), 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) ==
+            static_cast<ssize_t>(sizeof(ping)));
+    usleep(1000);
+
+    char data[16];
+    struct iovec iov = {data, sizeof(data)};
+    alignas(struct cmsghdr) char control[detail::TIMESTAMP_CONTROL_LEN];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    REQUIRE(::recvmsg(fd, &msg, MSG_DONTWAIT) == static_cast<ssize_t>(sizeof(ping)));
+    uint64_t after = now_ns();
+
+    // The kernel stamp is taken on arrival, before the read and within the test window
+    KernelTimestamp stamp = detail::cmsg_timestamp(msg);
+    CHECK(stamp.source == TimestampSource::Software);
+    CHECK(stamp.ns >= before);
+    CHECK(stamp.ns <= after);
+    ::close(fd);
+}
+
+TEST_CASE("Messages without control data carry no timestamp") {
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    KernelTimestamp stamp = detail::cmsg_timestamp(msg);
+    CHECK(stamp.ns == 0);
+    CHECK(stamp.source == TimestampSource::None);
+}
+
+TEST_CASE("Frame views can carry an explicit timestamp") {
+    Bytes payload = {1, 2, 3};
+    FrameView view = make_view_with_timestamp(FrameType::CAN, std::span<const Byte>(payload.data(), payload.size()),
+                                              123456789ULL, 4, 5);
+    CHECK(view.header.tx_timestamp_ns == 123456789ULL);
+    CHECK(view.header.src_endpoint_id == 4);
+    CHECK(view.header.dst_endpoint_id == 5);
+    CHECK(view.payload.size() == 3);
+}
+
+#else // NO_HARDWARE
+
+TEST_CASE("Kernel timestamps require hardware support") { REQUIRE(true); }
+
+#endif // NO_HARDWARE
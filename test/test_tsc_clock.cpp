@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include <thread>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+TEST_CASE("TscClock") {
+    TscClock *clock = TscClock::global();
+    if (clock == nullptr) {
+        MESSAGE("No invariant cycle counter, now_ns() uses clock_gettime()");
+        CHECK(now_ns() > 0);
+        return;
+    }
+
+    SUBCASE("Tracks the wall clock") {
+        CHECK(clock->frequency_hz() > 1e7);
+        for (int i = 0; i < 10; ++i) {
+            TimeNs wall = wall_ns();
+            TimeNs tsc = clock->now();
+            CHECK(tsc - wall < ms_to_ns(2));
+            CHECK(wall - tsc < ms_to_ns(2));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    SUBCASE("Never goes backwards") {
+        TimeNs last = clock->now();
+        bool monotonic = true;
+        for (int i = 0; i < 1000000; ++i) {
+            TimeNs t = clock->now();
+            monotonic = monotonic && t >= last;
+            last = t;
+        }
+        CHECK(monotonic);
+    }
+
+    SUBCASE("Resync keeps the offset small") {
+        uint64_t before = clock->resyncs();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        clock->resync();
+        CHECK(clock->resyncs() > before);
+        CHECK(clock->last_offset_ns() < ms_to_ns(1));
+        CHECK(clock->last_offset_ns() > -ms_to_ns(1));
+    }
+
+    SUBCASE("Backs now_ns()") {
+#ifndef WIREBIT_NO_TSC_CLOCK
+        TimeNs a = clock->now();
+        TimeNs b = now_ns();
+        TimeNs c = clock->now();
+        CHECK(a <= b);
+        CHECK(b <= c);
+#endif
+    }
+}
+
+TEST_CASE("TscClock instances resync independently") {
+    TscClock clock(ms_to_ns(20));
+    if (!clock.valid()) {
+        return;
+    }
+    TimeNs last = clock.now();
+    TimeNs end = wall_ns() + ms_to_ns(100);
+    bool monotonic = true;
+    while (wall_ns() < end) {
+        TimeNs t = clock.now();
+        monotonic = monotonic && t >= last;
+        last = t;
+    }
+    CHECK(monotonic);
+    CHECK(clock.resyncs() >= 2);
+    CHECK(clock.steps() == 0);
+    TimeNs offset = wall_ns() - clock.now();
+    CHECK(offset < ms_to_ns(1));
+    CHECK(offset > -ms_to_ns(1));
+}
@@ -0,0 +1,110 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+#ifndef NO_HARDWARE
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace wirebit;
+
+namespace {
+    void write_master(PtyLink &pty, const Bytes &data) {
+        ssize_t w = write(pty.master_fd(), data.data(), data.size());
+        REQUIRE(w == static_cast<ssize_t>(data.size()));
+    }
+} // namespace
+
+TEST_CASE("TtyLink baud rates") {
+    PtyLink pty = PtyLink::create().value();
+
+    SUBCASE("Standard rate") {
+        TtyConfig config;
+        config.device = pty.slave_path();
+        config.baud = 921600;
+        auto tty = TtyLink::create(config);
+        REQUIRE(tty.is_ok());
+        struct termios tio;
+        REQUIRE(tcgetattr(tty.value().fd(), &tio) == 0);
+        CHECK(cfgetospeed(&tio) == B921600);
+    }
+
+    SUBCASE("Arbitrary rate through termios2/BOTHER") {
+        if (!detail::CUSTOM_BAUD_SUPPORTED) {
+            return;
+        }
+        TtyConfig config;
+        config.device = pty.slave_path();
+        config.baud = 12000000;
+        auto tty = TtyLink::create(config);
+        REQUIRE(tty.is_ok());
+        detail::KernelTermios2 tio;
+        REQUIRE(ioctl(tty.value().fd(), detail::TTY_TCGETS2, &tio) == 0);
+        CHECK((tio.c_cflag & detail::TTY_CBAUD) == detail::TTY_BOTHER);
+        CHECK(tio.c_ospeed == 12000000);
+        CHECK(tio.c_ispeed == 12000000);
+    }
+
+    SUBCASE("Low latency is best effort") {
+        TtyConfig config;
+        config.device = pty.slave_path();
+        config.low_latency = true; // PTYs have no serial_struct: warns, still opens
+        CHECK(TtyLink::create(config).is_ok());
+    }
+}
+
+TEST_CASE("TtyLink read coalescing") {
+    PtyLink pty = PtyLink::create().value();
+    TtyConfig config;
+    config.device = pty.slave_path();
+
+    SUBCASE("Off by default: one read per recv") {
+        auto tty = TtyLink::create(config).value();
+        write_master(pty, Bytes{1, 2, 3, 4});
+        usleep(5000);
+        auto frame = tty.recv();
+        REQUIRE(frame.is_ok());
+        CHECK(frame.value().payload.size() == 4);
+    }
+
+    SUBCASE("Gathers bytes arriving within the gap") {
+        config.read_min_bytes = 8;
+        config.read_gap_us = 200000;
+        auto tty = TtyLink::create(config).value();
+        write_master(pty, Bytes{1, 2, 3, 4});
+        usleep(5000);
+        std::thread late([&]() {
+            usleep(10000);
+            write_master(pty, Bytes{5, 6, 7, 8});
+        });
+        auto frame = tty.recv();
+        late.join();
+        REQUIRE(frame.is_ok());
+        CHECK(frame.value().payload == Bytes{1, 2, 3, 4, 5, 6, 7, 8});
+        CHECK(tty.stats().frames_received == 1);
+    }
+
+    SUBCASE("Returns early when the line goes idle") {
+        config.read_min_bytes = 8;
+        config.read_gap_us = 2000;
+        auto tty = TtyLink::create(config).value();
+        write_master(pty, Bytes{1, 2, 3, 4});
+        usleep(5000);
+        TimeNs start = wall_ns();
+        auto frame = tty.recv();
+        REQUIRE(frame.is_ok());
+        CHECK(frame.value().payload.size() == 4);
+        CHECK(wall_ns() - start < ms_to_ns(100));
+    }
+
+    SUBCASE("Read size follows read_buffer_size") {
+        config.read_buffer_size = 16;
+        auto tty = TtyLink::create(config).value();
+        write_master(pty, Bytes(40, 0xAA));
+        usleep(5000);
+        auto frame = tty.recv();
+        REQUIRE(frame.is_ok());
+        CHECK(frame.value().payload.size() == 16);
+    }
+}
+#endif
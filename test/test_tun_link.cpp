@@ -143,6 +143,35 @@ TEST_CASE("TunLink recv with no data") {
     REQUIRE(recv_result.error().code == 6); // Timeout error code
 }
 
+TEST_CASE("TunLink multi-queue interface") {
+    String iface = make_tun_test_interface();
+    TunConfig config{
+        .interface_name = iface,
+        .create_if_missing = true,
+        .destroy_on_close = true,
+        .set_up_on_create = false,
+        .ip_address = "",
+        .queues = 2,
+        .queue_cpus = {0, -1},
+    };
+
+    auto result = TunLink::create_queues(config);
+    REQUIRE(result.is_ok());
+
+    auto &queues = result.value();
+    REQUIRE(queues.size() == 2);
+    REQUIRE(queues.cpu(0) == 0);
+    REQUIRE(queues.cpu(1) == -1);
+    REQUIRE(static_cast<TunLink &>(queues.queue(0)).tun_fd() != static_cast<TunLink &>(queues.queue(1)).tun_fd());
+
+    // Interface is down, so no queue receives anything
+    for (size_t q = 0; q < queues.size(); ++q) {
+        auto recv_result = queues.queue(q).recv();
+        REQUIRE(!recv_result.is_ok());
+        REQUIRE(recv_result.error().code == 6); // Timeout error code
+    }
+}
+
 TEST_CASE("TunLink minimum packet size validation") {
     String iface = make_tun_test_interface();
     TunConfig config{
@@ -0,0 +1,135 @@
+#include <doctest/doctest.h>
+#include <wirebit/wirebit.hpp>
+
+using namespace wirebit;
+
+namespace {
+    /// Link that records what it is given and refuses owning-frame sends
+    class ViewOnlyLink : public Link {
+      public:
+        Result<Unit, Error> send(const Frame &) override {
+            owned_sends++;
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        Result<Unit, Error> send_view(const FrameView &view) override {
+            frames.push_back(to_frame(view));
+            return Result<Unit, Error>::ok(Unit{});
+        }
+
+        Result<Frame, Error> recv() override {
+            if (frames.empty()) {
+                return Result<Frame, Error>::err(Error::timeout("empty"));
+            }
+            Frame frame = std::move(frames.front());
+            frames.erase(frames.begin());
+            return Result<Frame, Error>::ok(std::move(frame));
+        }
+
+        bool can_send() const override { return true; }
+        bool can_recv() const override { return !frames.empty(); }
+        String name() const override { return String("view_only"); }
+
+        Vector<Frame> frames;
+        int owned_sends = 0;
+    };
+} // namespace
+
+TEST_CASE("TypedFrame") {
+    SUBCASE("Holds a struct inline") {
+        can_frame cf{};
+        cf.can_id = 0x321;
+        cf.can_dlc = 2;
+        cf.data[0] = 0xCA;
+        cf.data[1] = 0xFE;
+
+        CanTypedFrame frame = CanTypedFrame::of(cf, 4, 5);
+        static_assert(CanTypedFrame::CAPACITY == sizeof(can_frame));
+        static_assert(CanTypedFrame::TYPE == FrameType::CAN);
+        CHECK(frame.size() == sizeof(can_frame));
+        uint16_t type = frame.header.frame_type;
+        CHECK(type == static_cast<uint16_t>(FrameType::CAN));
+        uint32_t src = frame.header.src_endpoint_id;
+        CHECK(src == 4);
+        uint64_t ts = frame.header.tx_timestamp_ns;
+        CHECK(ts > 0);
+
+        can_frame back = frame.get<can_frame>();
+        CHECK(back.can_id == 0x321);
+        CHECK(back.data[1] == 0xFE);
+    }
+
+    SUBCASE("Converts to and from Frame and FrameView") {
+        uint32_t word = 0xA1B2C3D4;
+        TypedFrame<FrameType::SERIAL, 8> frame = TypedFrame<FrameType::SERIAL, 8>::of(word);
+        CHECK(frame.size() == sizeof(word));
+
+        FrameView view = frame.view();
+        CHECK(view.payload.data() == frame.payload().data()); // borrowed, not copied
+        CHECK(view.payload.size() == 4);
+        CHECK(view.type() == FrameType::SERIAL);
+
+        Frame owned = frame.to_frame();
+        CHECK(owned.payload.size() == 4);
+        auto decoded = decode_frame(encode_frame(owned));
+        REQUIRE(decoded.is_ok());
+
+        auto again = TypedFrame<FrameType::SERIAL, 8>::from_view(make_view(decoded.value()));
+        REQUIRE(again.is_ok());
+        CHECK(again.value().get<uint32_t>() == word);
+
+        auto wrong_type = CanTypedFrame::from_view(view);
+        CHECK(wrong_type.is_err());
+        Frame big = make_frame(FrameType::SERIAL, Bytes(9));
+        CHECK(TypedFrame<FrameType::SERIAL, 8>::from_view(make_view(big)).is_err());
+    }
+
+    SUBCASE("Variable-length chunks") {
+        SerialChunk<4> chunk;
+        CHECK(chunk.size() == 4);
+        Bytes data = {1, 2, 3, 4, 5, 6};
+        CHECK(chunk.assign(std::span<const Byte>(data.data(), data.size())) == 4);
+        CHECK(chunk.payload()[3] == 4);
+        chunk.resize(2);
+        CHECK(chunk.view().payload.size() == 2);
+        chunk.storage()[0] = 9;
+        CHECK(chunk.payload()[0] == 9);
+    }
+}
+
+TEST_CASE("Endpoints send fixed-size frames as views") {
+    auto link = std::make_shared<ViewOnlyLink>();
+
+    SUBCASE("CAN") {
+        CanConfig config;
+        CanEndpoint endpoint(link, config, 3);
+        uint8_t data[3] = {1, 2, 3};
+        REQUIRE(endpoint.send_can(CanEndpoint::make_std_frame(0x42, data, 3)).is_ok());
+        REQUIRE(endpoint.send_canfd(CanEndpoint::make_fd_frame(0x43, data, 3)).is_ok());
+
+        CHECK(link->owned_sends == 0);
+        REQUIRE(link->frames.size() == 2);
+        CHECK(link->frames[0].payload.size() == sizeof(can_frame));
+        CHECK(link->frames[1].payload.size() == sizeof(canfd_frame));
+        uint32_t src = link->frames[0].header.src_endpoint_id;
+        CHECK(src == 3);
+        uint64_t deliver_at = link->frames[0].header.deliver_at_ns;
+        CHECK(deliver_at > 0);
+    }
+
+    SUBCASE("Serial") {
+        SerialConfig config;
+        SerialEndpoint per_byte(link, config, 1);
+        REQUIRE(per_byte.send(Bytes{0x10, 0x20}).is_ok());
+        config.coalesce_max = 16;
+        SerialEndpoint coalesced(link, config, 2);
+        REQUIRE(coalesced.send(Bytes(20, 0x30)).is_ok());
+
+        CHECK(link->owned_sends == 0);
+        REQUIRE(link->frames.size() == 4);
+        CHECK(link->frames[1].payload == Bytes{0x20});
+        CHECK(link->frames[2].payload.size() == 16);
+        CHECK(link->frames[2].meta.size() == SERIAL_RUN_META_LEN);
+        CHECK(link->frames[3].payload.size() == 4);
+    }
+}